@@ -0,0 +1,66 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "AlbumArtCache.hxx"
+
+#include <algorithm>
+
+const AlbumArtCache::Item *
+AlbumArtCache::Get(const char *directory) noexcept
+{
+	for (auto i = items.begin(); i != items.end(); ++i) {
+		if (i->directory == directory) {
+			/* move to the front of the LRU list */
+			items.splice(items.begin(), items, i);
+			return &items.front();
+		}
+	}
+
+	return nullptr;
+}
+
+void
+AlbumArtCache::Remove(const char *directory) noexcept
+{
+	for (auto i = items.begin(); i != items.end(); ++i) {
+		if (i->directory == directory) {
+			total_size -= i->data.size();
+			items.erase(i);
+			return;
+		}
+	}
+}
+
+void
+AlbumArtCache::Put(Item &&item) noexcept
+{
+	Remove(item.directory.c_str());
+
+	if (item.data.size() > max_size)
+		/* this item alone would overflow the cache */
+		return;
+
+	while (!items.empty() && total_size + item.data.size() > max_size) {
+		total_size -= items.back().data.size();
+		items.pop_back();
+	}
+
+	total_size += item.data.size();
+	items.push_front(std::move(item));
+}
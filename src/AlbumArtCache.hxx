@@ -0,0 +1,98 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_ALBUM_ART_CACHE_HXX
+#define MPD_ALBUM_ART_CACHE_HXX
+
+#include <chrono>
+#include <list>
+#include <string>
+
+/**
+ * A memory-bounded cache for album art files, so a client
+ * transferring a cover in many small "albumart" windows does not
+ * re-open and re-read the file for every window.
+ *
+ * It is not thread-safe; it may only be used from the main thread.
+ */
+class AlbumArtCache {
+public:
+	struct Item {
+		/**
+		 * The cache key: UTF-8 URI of the directory the art
+		 * file was found in.
+		 */
+		std::string directory;
+
+		/**
+		 * The UTF-8 URI of the art file itself, for
+		 * revalidation.
+		 */
+		std::string uri;
+
+		/**
+		 * The modification time of the art file;
+		 * time_point::min() if unknown (e.g. a remote
+		 * stream).
+		 */
+		std::chrono::system_clock::time_point mtime;
+
+		/**
+		 * The raw file contents.
+		 */
+		std::string data;
+	};
+
+private:
+	const size_t max_size;
+
+	size_t total_size = 0;
+
+	/**
+	 * The most recently used item comes first.
+	 */
+	std::list<Item> items;
+
+public:
+	explicit AlbumArtCache(size_t _max_size) noexcept
+		:max_size(_max_size) {}
+
+	/**
+	 * Looks up the given directory and marks the item as
+	 * recently used.  Returns nullptr on miss.  The returned
+	 * pointer is invalidated by the next Put() or Remove()
+	 * call.
+	 */
+	const Item *Get(const char *directory) noexcept;
+
+	/**
+	 * Removes a stale item, e.g. after its modification time
+	 * was found to have changed.
+	 */
+	void Remove(const char *directory) noexcept;
+
+	/**
+	 * Adds an item, evicting the least recently used ones if
+	 * the total size exceeds the limit.  Items larger than the
+	 * whole cache are ignored.
+	 */
+	void Put(Item &&item) noexcept;
+};
+
+#endif
@@ -0,0 +1,260 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "Fingerprint.hxx"
+#include "AudioFormat.hxx"
+#include "tag/Chromaprint.hxx"
+#include "pcm/PcmConvert.hxx"
+#include "decoder/DecoderList.hxx"
+#include "decoder/DecoderPlugin.hxx"
+#include "decoder/Client.hxx"
+#include "input/InputStream.hxx"
+#include "input/LocalOpen.hxx"
+#include "fs/Path.hxx"
+#include "util/MimeType.hxx"
+#include "util/UriUtil.hxx"
+
+#include <stdexcept>
+
+#include <assert.h>
+
+/**
+ * A #DecoderClient implementation which feeds the decoded PCM data
+ * (at most the first two minutes) into libchromaprint.
+ */
+class FingerprintDecoderClient final : public DecoderClient {
+	bool ready = false;
+
+	bool need_convert = false;
+
+	PcmConvert convert;
+
+	Chromaprint::Context chromaprint;
+
+	uint64_t remaining_bytes;
+
+public:
+	Mutex mutex;
+
+	~FingerprintDecoderClient() noexcept {
+		if (need_convert)
+			convert.Close();
+	}
+
+	/**
+	 * Flush everything and return the fingerprint.
+	 *
+	 * Throws on error.
+	 */
+	std::string Finish();
+
+	/* virtual methods from DecoderClient */
+	void Ready(AudioFormat audio_format,
+		   bool seekable, SignedSongTime duration) override;
+
+	DecoderCommand GetCommand() noexcept override {
+		return remaining_bytes > 0
+			? DecoderCommand::NONE
+			: DecoderCommand::STOP;
+	}
+
+	void CommandFinished() override {}
+
+	SongTime GetSeekTime() noexcept override {
+		return SongTime::zero();
+	}
+
+	uint64_t GetSeekFrame() noexcept override {
+		return 0;
+	}
+
+	void SeekError() override {}
+
+	InputStreamPtr OpenUri(const char *) override {
+		throw std::runtime_error("Not implemented");
+	}
+
+	size_t Read(InputStream &is, void *buffer, size_t length) override {
+		return is.LockRead(buffer, length);
+	}
+
+	void SubmitTimestamp(FloatDuration) override {}
+	DecoderCommand SubmitData(InputStream *is,
+				  const void *data, size_t length,
+				  uint16_t kbit_rate) override;
+
+	DecoderCommand SubmitTag(InputStream *, Tag &&) override {
+		return GetCommand();
+	}
+
+	void SubmitReplayGain(const ReplayGainInfo *) {}
+	void SubmitMixRamp(MixRampInfo &&) {}
+};
+
+std::string
+FingerprintDecoderClient::Finish()
+{
+	if (!ready)
+		throw std::runtime_error("Decoding failed");
+
+	if (need_convert) {
+		auto flushed = convert.Flush();
+		auto data = ConstBuffer<int16_t>::FromVoid(flushed);
+		chromaprint.Feed(data.data, data.size);
+	}
+
+	chromaprint.Finish();
+
+	return chromaprint.GetFingerprint();
+}
+
+void
+FingerprintDecoderClient::Ready(AudioFormat audio_format,
+				bool, SignedSongTime)
+{
+	/* feed the first two minutes into libchromaprint */
+	remaining_bytes = audio_format.TimeToSize(std::chrono::minutes(2));
+
+	if (audio_format.format != SampleFormat::S16) {
+		const AudioFormat src_audio_format = audio_format;
+		audio_format.format = SampleFormat::S16;
+
+		convert.Open(src_audio_format, audio_format);
+		need_convert = true;
+	}
+
+	chromaprint.Start(audio_format.sample_rate, audio_format.channels);
+
+	ready = true;
+}
+
+DecoderCommand
+FingerprintDecoderClient::SubmitData(InputStream *,
+				     const void *_data, size_t length,
+				     uint16_t)
+{
+	if (length > remaining_bytes)
+		remaining_bytes = 0;
+	else
+		remaining_bytes -= length;
+
+	ConstBuffer<void> src{_data, length};
+	ConstBuffer<int16_t> data;
+
+	if (need_convert) {
+		auto result = convert.Convert(src);
+		data = ConstBuffer<int16_t>::FromVoid(result);
+	} else
+		data = ConstBuffer<int16_t>::FromVoid(src);
+
+	chromaprint.Feed(data.data, data.size);
+
+	return GetCommand();
+}
+
+std::string
+FingerprintFile(Path path_fs)
+{
+	assert(!path_fs.IsNull());
+
+	const auto *suffix = path_fs.GetSuffix();
+	if (suffix == nullptr)
+		throw std::runtime_error("Unrecognized file suffix");
+
+	const auto suffix_utf8 = Path::FromFS(suffix).ToUTF8();
+
+	FingerprintDecoderClient client;
+	InputStreamPtr is;
+
+	bool decoded = decoder_plugins_try([&](const DecoderPlugin &plugin){
+			if (!plugin.SupportsSuffix(suffix_utf8.c_str()) ||
+			    !decoder_plugin_ensure_initialized(plugin))
+				return false;
+
+			if (plugin.file_decode != nullptr) {
+				plugin.FileDecode(client, path_fs);
+				return true;
+			}
+
+			if (plugin.stream_decode != nullptr) {
+				/* open the InputStream (if not
+				   already open) */
+				if (is == nullptr)
+					is = OpenLocalInputStream(path_fs,
+								  client.mutex);
+				else {
+					try {
+						is->LockRewind();
+					} catch (...) {
+					}
+				}
+
+				plugin.StreamDecode(client, *is);
+				return true;
+			}
+
+			return false;
+		});
+
+	if (!decoded)
+		throw std::runtime_error("No matching decoder plugin");
+
+	return client.Finish();
+}
+
+std::string
+FingerprintStream(const char *uri)
+{
+	FingerprintDecoderClient client;
+
+	auto is = InputStream::OpenReady(uri, client.mutex);
+
+	UriSuffixBuffer suffix_buffer;
+	const char *const suffix = uri_get_suffix(uri, suffix_buffer);
+
+	const char *mime = is->GetMimeType();
+	std::string mime_base;
+	if (mime != nullptr)
+		mime = (mime_base = GetMimeTypeBase(mime)).c_str();
+
+	bool decoded = decoder_plugins_try([&](const DecoderPlugin &plugin){
+			if (plugin.stream_decode == nullptr)
+				return false;
+
+			if (!((mime != nullptr && plugin.SupportsMimeType(mime)) ||
+			      (suffix != nullptr && plugin.SupportsSuffix(suffix))))
+				return false;
+
+			if (!decoder_plugin_ensure_initialized(plugin))
+				return false;
+
+			try {
+				is->LockRewind();
+			} catch (...) {
+			}
+
+			plugin.StreamDecode(client, *is);
+			return true;
+		});
+
+	if (!decoded)
+		throw std::runtime_error("No matching decoder plugin");
+
+	return client.Finish();
+}
@@ -230,7 +230,8 @@ IcyMetaDataParser::ParseInPlace(void *data, size_t length) noexcept
 	while (length > 0) {
 		size_t chunk = Data(length);
 		if (chunk > 0) {
-			memmove(dest, src, chunk);
+			if (dest != src)
+				memmove(dest, src, chunk);
 			dest += chunk;
 			src += chunk;
 			length -= chunk;
@@ -70,6 +70,9 @@ static constexpr unsigned IDLE_MOUNT = 0x1000;
 /** the partition list has changed */
 static constexpr unsigned IDLE_PARTITION = 0x2000;
 
+/** the number of idle flags */
+static constexpr unsigned IDLE_NR_FLAGS = 14;
+
 /**
  * Get idle names
  */
@@ -22,6 +22,7 @@
 #include "Partition.hxx"
 #include "Idle.hxx"
 #include "Stats.hxx"
+#include "AlbumArtCache.hxx"
 
 #ifdef ENABLE_CURL
 #include "RemoteTagCache.hxx"
@@ -51,6 +52,16 @@ Instance::Instance()
 {
 }
 
+AlbumArtCache &
+Instance::GetAlbumArtCache() noexcept
+{
+	if (!album_art_cache)
+		album_art_cache =
+			std::make_unique<AlbumArtCache>(album_art_cache_size);
+
+	return *album_art_cache;
+}
+
 Instance::~Instance() noexcept
 {
 #ifdef ENABLE_DATABASE
@@ -95,11 +106,27 @@ Instance::OnDatabaseModified()
 	/* propagate the change to all subsystems */
 
 	stats_invalidate();
+	database_list_cache.Flush();
 
 	for (auto &partition : partitions)
 		partition.DatabaseModified(*database);
 }
 
+void
+Instance::OnDatabaseSongsChanged(std::vector<std::string> &&uris)
+{
+	assert(database != nullptr);
+
+	/* the set of modified songs is known: invalidate the caches,
+	   but refresh only the affected play queue entries */
+
+	stats_invalidate();
+	database_list_cache.Flush();
+
+	for (auto &partition : partitions)
+		partition.DatabaseSongsChanged(*database, uris);
+}
+
 void
 Instance::OnDatabaseSongRemoved(const char *uri)
 {
@@ -149,7 +176,8 @@ Instance::LookupRemoteTag(const char *uri) noexcept
 
 	if (!remote_tag_cache)
 		remote_tag_cache = std::make_unique<RemoteTagCache>(event_loop,
-								    *this);
+								    *this,
+								    remote_tag_cache_size);
 
 	remote_tag_cache->Lookup(uri);
 }
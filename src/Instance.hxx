@@ -23,6 +23,7 @@
 #include "config.h"
 #include "event/Loop.hxx"
 #include "event/Thread.hxx"
+#include "event/ThreadPool.hxx"
 #include "event/MaskMonitor.hxx"
 #include "util/Compiler.h"
 
@@ -41,6 +42,7 @@ class NeighborGlue;
 
 #ifdef ENABLE_DATABASE
 #include "db/DatabaseListener.hxx"
+#include "db/ListCache.hxx"
 #include "db/Ptr.hxx"
 class Storage;
 class UpdateService;
@@ -53,6 +55,7 @@ class ClientList;
 struct Partition;
 class StateFile;
 class RemoteTagCache;
+class AlbumArtCache;
 
 /**
  * A utility class which, when used as the first base class, ensures
@@ -81,9 +84,13 @@ struct Instance final
 #endif
 {
 	/**
-	 * A thread running an #EventLoop for non-blocking (bulk) I/O.
+	 * A pool of threads, each running an #EventLoop for
+	 * non-blocking (bulk) I/O.  New backends (curl, NFS, mounted
+	 * storages, ...) are distributed over the pool in round-robin
+	 * order, so one busy callback cannot stall all network
+	 * streams; see #EventThreadPool.
 	 */
-	EventThread io_thread;
+	EventThreadPool io_thread;
 
 	/**
 	 * Another thread running an #EventLoop for non-blocking
@@ -113,12 +120,37 @@ struct Instance final
 	Storage *storage = nullptr;
 
 	UpdateService *update = nullptr;
+
+	/**
+	 * Cached "list" query results, flushed by
+	 * OnDatabaseModified().
+	 */
+	DatabaseListCache database_list_cache;
 #endif
 
 #ifdef ENABLE_CURL
+	/**
+	 * The maximum number of entries in #remote_tag_cache,
+	 * configured with "remote_tag_cache_size".
+	 */
+	unsigned remote_tag_cache_size = 4096;
+
 	std::unique_ptr<RemoteTagCache> remote_tag_cache;
 #endif
 
+	/**
+	 * The maximum total size of #album_art_cache in bytes,
+	 * configured with "album_art_cache_size".
+	 */
+	size_t album_art_cache_size = 16 * 1024 * 1024;
+
+	std::unique_ptr<AlbumArtCache> album_art_cache;
+
+	/**
+	 * Returns the #album_art_cache, creating it on demand.
+	 */
+	AlbumArtCache &GetAlbumArtCache() noexcept;
+
 	ClientList *client_list;
 
 	std::list<Partition> partitions;
@@ -179,6 +211,7 @@ struct Instance final
 private:
 #ifdef ENABLE_DATABASE
 	void OnDatabaseModified() override;
+	void OnDatabaseSongsChanged(std::vector<std::string> &&uris) override;
 	void OnDatabaseSongRemoved(const char *uri) override;
 #endif
 
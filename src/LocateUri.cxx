@@ -36,8 +36,6 @@ LocateFileUri(const char *uri, const Client *client
 #endif
 	      )
 {
-	auto path = AllocatedPath::FromUTF8Throw(uri);
-
 #ifdef ENABLE_DATABASE
 	if (storage != nullptr) {
 		const char *suffix = storage->MapToRelativeUTF8(uri);
@@ -48,6 +46,11 @@ LocateFileUri(const char *uri, const Client *client
 	}
 #endif
 
+	/* convert to a filesystem path only after the music
+	   directory check failed; the common case needs no
+	   conversion (and no allocation) */
+	auto path = AllocatedPath::FromUTF8Throw(uri);
+
 	if (client != nullptr)
 		client->AllowFile(path);
 
@@ -21,8 +21,15 @@
 #include "Log.hxx"
 #include "util/Domain.hxx"
 #include "util/StringStrip.hxx"
+#include "thread/Mutex.hxx"
+#include "thread/Cond.hxx"
+#include "thread/Thread.hxx"
+#include "thread/Name.hxx"
 #include "config.h"
 
+#include <list>
+#include <string>
+
 #include <assert.h>
 #include <stdio.h>
 #include <string.h>
@@ -173,6 +180,167 @@ FileLog(const Domain &domain, const char *message) noexcept
 #endif
 }
 
+static constexpr Domain log_backend_domain("log");
+
+/**
+ * A bounded queue of log messages drained by a dedicated writer
+ * thread, so a slow console or a blocked syslog socket never stalls
+ * the thread which logs (e.g. the player or an output thread).  When
+ * the queue is full, messages are dropped and counted instead of
+ * blocking the producer.
+ */
+static class AsyncLogWriter {
+	struct Entry {
+		const Domain *domain;
+		LogLevel level;
+		std::string message;
+	};
+
+	/**
+	 * Hard limit for the queue length; this bounds both the
+	 * memory usage and the amount of stale output after the
+	 * writer catches up.
+	 */
+	static constexpr size_t MAX_SIZE = 256;
+
+	Mutex mutex;
+	Cond cond;
+
+	Thread thread{BIND_THIS_METHOD(Run)};
+
+	std::list<Entry> queue;
+
+	size_t n = 0;
+
+	/**
+	 * Number of messages dropped since the last report, because
+	 * the queue was full (or out of memory).
+	 */
+	unsigned n_dropped = 0;
+
+	/**
+	 * Toggled only while the process is still (or again)
+	 * single-threaded, therefore read without the mutex by
+	 * producers.
+	 */
+	bool enabled = false;
+
+	bool stop = false;
+
+public:
+	bool IsEnabled() const noexcept {
+		return enabled;
+	}
+
+	void Enable() {
+		assert(!enabled);
+
+		stop = false;
+		thread.Start();
+		enabled = true;
+	}
+
+	void Disable() noexcept {
+		if (!enabled)
+			return;
+
+		{
+			const std::lock_guard<Mutex> protect(mutex);
+			stop = true;
+			cond.signal();
+		}
+
+		thread.Join();
+		enabled = false;
+	}
+
+	void Push(const Domain &domain, LogLevel level,
+		  const char *msg) noexcept {
+		const std::lock_guard<Mutex> protect(mutex);
+
+		if (n >= MAX_SIZE) {
+			++n_dropped;
+			return;
+		}
+
+		try {
+			queue.push_back({&domain, level, msg});
+		} catch (...) {
+			/* allocation failure */
+			++n_dropped;
+			return;
+		}
+
+		++n;
+		cond.signal();
+	}
+
+private:
+	/**
+	 * Write one message with the configured synchronous backend.
+	 *
+	 * Caller must not hold the mutex.
+	 */
+	void Write(const Domain &domain, LogLevel level,
+		   const char *msg) noexcept {
+#ifdef HAVE_SYSLOG
+		if (enable_syslog) {
+			SysLog(domain, level, msg);
+			return;
+		}
+#endif
+		(void)level;
+		FileLog(domain, msg);
+	}
+
+	void Run() noexcept {
+		SetThreadName("log");
+
+		const std::lock_guard<Mutex> protect(mutex);
+
+		while (true) {
+			while (!queue.empty()) {
+				const auto entry = std::move(queue.front());
+				queue.pop_front();
+				--n;
+
+				const ScopeUnlock unlock(mutex);
+				Write(*entry.domain, entry.level,
+				      entry.message.c_str());
+			}
+
+			if (n_dropped > 0) {
+				char buffer[64];
+				snprintf(buffer, sizeof(buffer),
+					 "dropped %u log messages",
+					 n_dropped);
+				n_dropped = 0;
+
+				const ScopeUnlock unlock(mutex);
+				Write(log_backend_domain,
+				      LogLevel::WARNING, buffer);
+			}
+
+			if (stop)
+				break;
+
+			cond.wait(mutex);
+		}
+	}
+} async_log_writer;
+
+void
+EnableAsyncLog()
+{
+	async_log_writer.Enable();
+}
+
+void
+DisableAsyncLog() noexcept
+{
+	async_log_writer.Disable();
+}
+
 #endif /* !ANDROID */
 
 void
@@ -189,6 +357,11 @@ Log(const Domain &domain, LogLevel level, const char *msg) noexcept
 	if (level < log_threshold)
 		return;
 
+	if (async_log_writer.IsEnabled()) {
+		async_log_writer.Push(domain, level, msg);
+		return;
+	}
+
 #ifdef HAVE_SYSLOG
 	if (enable_syslog) {
 		SysLog(domain, level, msg);
@@ -34,4 +34,23 @@ LogInitSysLog() noexcept;
 void
 LogFinishSysLog() noexcept;
 
+/**
+ * Route log messages through a bounded queue drained by a dedicated
+ * writer thread, so logging never performs I/O in the calling
+ * thread.  Messages are dropped (and the drops counted) when the
+ * queue is full.  Call this while the process is still
+ * single-threaded.
+ *
+ * Throws on error.
+ */
+void
+EnableAsyncLog();
+
+/**
+ * Stop the writer thread after flushing the queue and return to
+ * synchronous logging.
+ */
+void
+DisableAsyncLog() noexcept;
+
 #endif /* LOG_H */
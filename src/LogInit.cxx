@@ -53,6 +53,13 @@ static constexpr Domain log_domain("log");
 static int out_fd = -1;
 static AllocatedPath out_path = nullptr;
 
+/**
+ * Was "log_async" enabled in the configuration?  The writer thread
+ * is only started by setup_log_output(), after the daemonization
+ * fork.
+ */
+static bool use_async_log;
+
 static void redirect_logs(int fd)
 {
 	assert(fd >= 0);
@@ -136,6 +143,8 @@ log_init(const ConfigData &config, bool verbose, bool use_stdout)
 		SetLogThreshold(parse_log_level(param->value.c_str(),
 						param->line));
 
+	use_async_log = config.GetBool(ConfigOption::LOG_ASYNC, false);
+
 	if (use_stdout) {
 		out_fd = STDOUT_FILENO;
 	} else {
@@ -184,6 +193,7 @@ void
 log_deinit() noexcept
 {
 #ifndef ANDROID
+	DisableAsyncLog();
 	close_log_files();
 	out_path = nullptr;
 #endif
@@ -213,6 +223,15 @@ void setup_log_output()
 #endif
 }
 
+void
+start_log_thread()
+{
+#ifndef ANDROID
+	if (use_async_log)
+		EnableAsyncLog();
+#endif
+}
+
 int
 cycle_log_files() noexcept
 {
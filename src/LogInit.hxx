@@ -45,6 +45,16 @@ log_deinit() noexcept;
 void
 setup_log_output();
 
+/**
+ * Start the asynchronous log writer thread, if "log_async" is
+ * enabled in the configuration.  Must be called after the
+ * daemonization fork (threads do not survive fork()).
+ *
+ * Throws on error.
+ */
+void
+start_log_thread();
+
 int
 cycle_log_files() noexcept;
 
@@ -48,6 +48,7 @@
 #include "pcm/PcmConvert.hxx"
 #include "unix/SignalHandlers.hxx"
 #include "thread/Slack.hxx"
+#include "thread/Util.hxx"
 #include "net/Init.hxx"
 #include "lib/icu/Init.hxx"
 #include "config/File.hxx"
@@ -74,6 +75,7 @@
 #include "storage/CompositeStorage.hxx"
 #ifdef ENABLE_INOTIFY
 #include "db/update/InotifyUpdate.hxx"
+#include "db/update/FanotifyUpdate.hxx"
 #endif
 #endif
 
@@ -85,6 +87,8 @@
 #include "sticker/StickerDatabase.hxx"
 #endif
 
+#include "MixRampCache.hxx"
+
 #ifdef ENABLE_ARCHIVE
 #include "archive/ArchiveList.hxx"
 #endif
@@ -107,6 +111,10 @@
 #include <systemd/sd-daemon.h>
 #endif
 
+#ifdef ENABLE_DATABASE
+#include <future>
+#endif
+
 #include <stdlib.h>
 
 #ifdef HAVE_LOCALE_H
@@ -254,6 +262,19 @@ glue_sticker_init(const ConfigData &config)
 #endif
 }
 
+/**
+ * Configure and initialize the MixRamp cache.
+ */
+static void
+glue_mixramp_cache_init(const ConfigData &config)
+{
+	auto path = config.GetPath(ConfigOption::MIXRAMP_CACHE_FILE);
+	if (path.IsNull())
+		return;
+
+	mixramp_cache_init(std::move(path));
+}
+
 static void
 glue_state_file_init(const ConfigData &raw_config)
 {
@@ -302,10 +323,19 @@ initialize_decoder_and_player(const ConfigData &config,
 		throw FormatRuntimeError("buffer size \"%lu\" is too big",
 					 (unsigned long)buffer_size);
 
+	MusicChunk::max_duration = std::chrono::milliseconds(
+		config.GetPositive(ConfigOption::AUDIO_CHUNK_DURATION, 20));
+
 	const unsigned max_length =
 		config.GetPositive(ConfigOption::MAX_PLAYLIST_LENGTH,
 				   DEFAULT_PLAYLIST_MAX_LENGTH);
 
+	const unsigned decoder_wakeup_percent =
+		config.GetPositive(ConfigOption::DECODER_WAKEUP_PERCENT, 25);
+	if (decoder_wakeup_percent >= 100)
+		throw FormatRuntimeError("decoder_wakeup_percent \"%u\" is out of range",
+					 decoder_wakeup_percent);
+
 	AudioFormat configured_audio_format = AudioFormat::Undefined();
 	param = config.GetParam(ConfigOption::AUDIO_OUTPUT_FORMAT);
 	if (param != nullptr) {
@@ -318,12 +348,25 @@ initialize_decoder_and_player(const ConfigData &config,
 		}
 	}
 
+	uint64_t thread_affinity = 0;
+	param = config.GetParam(ConfigOption::PLAYER_THREAD_AFFINITY);
+	if (param != nullptr) {
+		try {
+			thread_affinity = ParseCpuAffinity(param->value.c_str());
+		} catch (...) {
+			std::throw_with_nested(FormatRuntimeError("error parsing line %i",
+								  param->line));
+		}
+	}
+
 	instance->partitions.emplace_back(*instance,
 					  "default",
 					  max_length,
 					  buffered_chunks,
+					  decoder_wakeup_percent,
 					  configured_audio_format,
-					  replay_gain_config);
+					  replay_gain_config,
+					  thread_affinity);
 	auto &partition = instance->partitions.back();
 
 	try {
@@ -342,6 +385,7 @@ Instance::BeginShutdownUpdate() noexcept
 {
 #ifdef ENABLE_DATABASE
 #ifdef ENABLE_INOTIFY
+	mpd_fanotify_finish();
 	mpd_inotify_finish();
 #endif
 
@@ -447,6 +491,11 @@ MainOrThrow(int argc, char *argv[])
 		instance = nullptr;
 	};
 
+	/* must be configured before anybody asks the pool for an
+	   EventLoop */
+	instance->io_thread.SetThreadCount(raw_config.GetPositive(ConfigOption::IO_THREADS,
+								  1));
+
 #ifdef ENABLE_NEIGHBOR_PLUGINS
 	instance->neighbors = new NeighborGlue();
 	instance->neighbors->Init(raw_config,
@@ -461,7 +510,18 @@ MainOrThrow(int argc, char *argv[])
 
 	const unsigned max_clients =
 		raw_config.GetPositive(ConfigOption::MAX_CONN, 10);
-	instance->client_list = new ClientList(max_clients);
+	instance->client_list = new ClientList(instance->event_loop,
+					       max_clients);
+
+#ifdef ENABLE_CURL
+	instance->remote_tag_cache_size =
+		raw_config.GetPositive(ConfigOption::REMOTE_TAG_CACHE_SIZE,
+				       instance->remote_tag_cache_size);
+#endif
+
+	instance->album_art_cache_size =
+		raw_config.GetPositive(ConfigOption::ALBUM_ART_CACHE_SIZE,
+				       instance->album_art_cache_size);
 
 	initialize_decoder_and_player(raw_config, config.replay_gain);
 
@@ -510,10 +570,18 @@ mpd_main_after_fork(const ConfigData &raw_config, const Config &config)
 	const ScopeDecoderPluginsInit decoder_plugins_init(raw_config);
 
 #ifdef ENABLE_DATABASE
-	const bool create_db = InitDatabaseAndStorage(raw_config);
+	/* load the database on a worker thread; everything
+	   initialized below (stickers, outputs, clients, input and
+	   playlist plugins) is independent of it, so startup time is
+	   bounded by the slowest of these components instead of
+	   their sum */
+	auto database_future = std::async(std::launch::async,
+					  InitDatabaseAndStorage,
+					  std::cref(raw_config));
 #endif
 
 	glue_sticker_init(raw_config);
+	glue_mixramp_cache_init(raw_config);
 
 	command_init();
 
@@ -530,12 +598,19 @@ mpd_main_after_fork(const ConfigData &raw_config, const Config &config)
 						       instance->io_thread.GetEventLoop());
 	const ScopePlaylistPluginsInit playlist_plugins_init(raw_config);
 
+#ifdef ENABLE_DATABASE
+	/* wait for the database load started above; errors are
+	   rethrown here */
+	const bool create_db = database_future.get();
+#endif
+
 #ifdef ENABLE_DAEMON
 	daemonize_commit();
 #endif
 
 #ifndef ANDROID
 	setup_log_output();
+	start_log_thread();
 
 	const ScopeSignalHandlersInit signal_handlers_init(instance->event_loop);
 #endif
@@ -548,7 +623,10 @@ mpd_main_after_fork(const ConfigData &raw_config, const Config &config)
 		instance->neighbors->Open();
 #endif
 
-	ZeroconfInit(raw_config, instance->event_loop);
+	/* run zeroconf on the io_thread, next to the neighbor plugins,
+	   so Avahi/dbus hiccups cannot stall the main loop's client
+	   accept path */
+	ZeroconfInit(raw_config, instance->io_thread.GetEventLoop());
 
 #ifdef ENABLE_DATABASE
 	if (create_db) {
@@ -563,8 +641,14 @@ mpd_main_after_fork(const ConfigData &raw_config, const Config &config)
 #ifdef ENABLE_DATABASE
 	if (raw_config.GetBool(ConfigOption::AUTO_UPDATE, false)) {
 #ifdef ENABLE_INOTIFY
+		/* prefer fanotify (one kernel mark for the whole
+		   file system); fall back to recursive inotify
+		   watches if it is unavailable */
 		if (instance->storage != nullptr &&
-		    instance->update != nullptr)
+		    instance->update != nullptr &&
+		    !mpd_fanotify_init(instance->event_loop,
+				       *instance->storage,
+				       *instance->update))
 			mpd_inotify_init(instance->event_loop,
 					 *instance->storage,
 					 *instance->update,
@@ -629,6 +713,8 @@ mpd_main_after_fork(const ConfigData &raw_config, const Config &config)
 	sticker_global_finish();
 #endif
 
+	mixramp_cache_finish();
+
 	return EXIT_SUCCESS;
 }
 
@@ -69,15 +69,10 @@ map_uri_fs(const char *uri) noexcept
 	if (instance->storage == nullptr)
 		return nullptr;
 
-	const auto music_dir_fs = instance->storage->MapFS("");
-	if (music_dir_fs.IsNull())
-		return nullptr;
-
-	const auto uri_fs = AllocatedPath::FromUTF8(uri);
-	if (uri_fs.IsNull())
-		return nullptr;
-
-	return music_dir_fs / uri_fs;
+	/* let the storage do the mapping in one step; this saves a
+	   temporary copy of the music directory path, and resolves
+	   mount points properly */
+	return instance->storage->MapFS(uri);
 }
 
 std::string
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "Metrics.hxx"
+#include "MusicBuffer.hxx"
+#include "client/Response.hxx"
+#include "input/BufferedInputStream.hxx"
+#include "tag/Pool.hxx"
+#include "util/PeakBuffer.hxx"
+
+#include <inttypes.h>
+
+Metrics global_metrics;
+
+static void
+histogram_print(Response &r, const char *name, const LatencyHistogram &h)
+{
+	for (unsigned i = 0; i < LatencyHistogram::N_BUCKETS - 1; ++i)
+		r.Format("%s_lt_%ums: %" PRIu64 "\n",
+			 name, 1u << i, h.Get(i));
+
+	r.Format("%s_ge_%ums: %" PRIu64 "\n",
+		 name, 1u << (LatencyHistogram::N_BUCKETS - 2),
+		 h.Get(LatencyHistogram::N_BUCKETS - 1));
+}
+
+void
+metrics_print(Response &r)
+{
+	const auto &m = global_metrics;
+
+	r.Format("decoded_chunks: %" PRIu64 "\n"
+		 "decoded_bytes: %" PRIu64 "\n"
+		 "buffer_full: %" PRIu64 "\n"
+		 "decoder_slow: %" PRIu64 "\n",
+		 m.decoded_chunks.load(std::memory_order_relaxed),
+		 m.decoded_bytes.load(std::memory_order_relaxed),
+		 m.buffer_full.load(std::memory_order_relaxed),
+		 m.decoder_slow.load(std::memory_order_relaxed));
+
+	histogram_print(r, "output_play_latency", m.output_play_latency);
+	histogram_print(r, "event_dispatch_latency", m.event_dispatch_latency);
+}
+
+void
+metrics_print_memory(Response &r)
+{
+	r.Format("client_output_bytes: %zu\n"
+		 "tag_pool_bytes: %zu\n"
+		 "music_buffer_bytes: %zu\n"
+		 "buffered_input_bytes: %zu\n",
+		 peak_buffer_get_memory_usage(),
+		 tag_pool_get_memory_usage(),
+		 music_buffer_get_memory_usage(),
+		 buffered_input_stream_get_memory_usage());
+}
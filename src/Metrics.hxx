@@ -0,0 +1,112 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_METRICS_HXX
+#define MPD_METRICS_HXX
+
+#include <atomic>
+#include <chrono>
+
+#include <stdint.h>
+
+class Response;
+
+/**
+ * A histogram of durations with power-of-two millisecond buckets:
+ * bucket #i counts samples shorter than 2^i milliseconds, the last
+ * bucket counts everything else.  All operations use relaxed atomics,
+ * so recording a sample is wait-free and cheap enough for hot paths.
+ */
+class LatencyHistogram {
+public:
+	static constexpr unsigned N_BUCKETS = 8;
+
+private:
+	std::atomic<uint64_t> buckets[N_BUCKETS];
+
+public:
+	void Measure(std::chrono::steady_clock::duration d) noexcept {
+		const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(d).count();
+
+		unsigned i = 0;
+		while (i < N_BUCKETS - 1 && ms >= (int64_t(1) << i))
+			++i;
+
+		buckets[i].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	uint64_t Get(unsigned i) const noexcept {
+		return buckets[i].load(std::memory_order_relaxed);
+	}
+};
+
+/**
+ * Always-on counters describing the health of MPD's real-time paths.
+ * They are incremented from the decoder, player, output and I/O event
+ * threads without any lock; readers (the "stats detail" protocol
+ * command) may see slightly stale values, which is fine for
+ * monitoring.
+ */
+struct Metrics {
+	/**
+	 * Chunks/bytes the decoder has submitted to the #MusicPipe.
+	 */
+	std::atomic<uint64_t> decoded_chunks{0}, decoded_bytes{0};
+
+	/**
+	 * How often the decoder had to wait because the #MusicBuffer
+	 * was full (the outputs were not consuming fast enough).
+	 */
+	std::atomic<uint64_t> buffer_full{0};
+
+	/**
+	 * How often the player ran out of chunks while outputs were
+	 * open, i.e. the decoder was too slow and an underrun was
+	 * imminent.
+	 */
+	std::atomic<uint64_t> decoder_slow{0};
+
+	/**
+	 * Duration of AudioOutput::Play() calls in the output thread.
+	 */
+	LatencyHistogram output_play_latency;
+
+	/**
+	 * Duration of one EventLoop iteration's dispatch phase (I/O
+	 * thread responsiveness).
+	 */
+	LatencyHistogram event_dispatch_latency;
+};
+
+extern Metrics global_metrics;
+
+/**
+ * Print all metrics to the client (the "stats detail" response).
+ */
+void
+metrics_print(Response &r);
+
+/**
+ * Print the per-subsystem memory accounting counters (the "stats
+ * memory" response).
+ */
+void
+metrics_print_memory(Response &r);
+
+#endif
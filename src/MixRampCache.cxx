@@ -0,0 +1,179 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "MixRampCache.hxx"
+#include "MixRampInfo.hxx"
+#include "fs/AllocatedPath.hxx"
+#include "fs/FileSystem.hxx"
+#include "fs/io/TextFile.hxx"
+#include "fs/io/FileOutputStream.hxx"
+#include "fs/io/BufferedOutputStream.hxx"
+#include "thread/Mutex.hxx"
+#include "util/Domain.hxx"
+#include "util/StringCompare.hxx"
+#include "Log.hxx"
+
+#include <map>
+#include <string>
+
+#include <assert.h>
+
+static constexpr Domain mixramp_cache_domain("mixramp_cache");
+
+static Mutex mixramp_cache_mutex;
+static AllocatedPath mixramp_cache_path = nullptr;
+static std::map<std::string, MixRampInfo> mixramp_cache_map;
+static bool mixramp_cache_modified = false;
+
+static void
+mixramp_cache_read(Path path)
+{
+	if (!PathExists(path))
+		/* no cache file yet - that's ok */
+		return;
+
+	TextFile file(path);
+
+	std::string uri;
+	MixRampInfo info;
+
+	const char *line;
+	while ((line = file.ReadLine()) != nullptr) {
+		const char *value;
+
+		if ((value = StringAfterPrefix(line, "song: ")) != nullptr) {
+			if (!uri.empty() && info.IsDefined())
+				mixramp_cache_map[std::move(uri)] = std::move(info);
+
+			uri = value;
+			info.Clear();
+		} else if ((value = StringAfterPrefix(line, "start: ")) != nullptr)
+			info.SetStart(value);
+		else if ((value = StringAfterPrefix(line, "end: ")) != nullptr)
+			info.SetEnd(value);
+	}
+
+	if (!uri.empty() && info.IsDefined())
+		mixramp_cache_map[std::move(uri)] = std::move(info);
+}
+
+void
+mixramp_cache_init(AllocatedPath &&path)
+{
+	assert(!path.IsNull());
+	assert(mixramp_cache_path.IsNull());
+
+	mixramp_cache_read(path);
+	mixramp_cache_path = std::move(path);
+}
+
+static void
+mixramp_cache_write(Path path)
+{
+	FileOutputStream fos(path);
+
+	{
+		BufferedOutputStream os(fos);
+
+		for (const auto &i : mixramp_cache_map) {
+			os.Format("song: %s\n", i.first.c_str());
+
+			const char *start = i.second.GetStart();
+			if (start != nullptr)
+				os.Format("start: %s\n", start);
+
+			const char *end = i.second.GetEnd();
+			if (end != nullptr)
+				os.Format("end: %s\n", end);
+		}
+
+		os.Flush();
+	}
+
+	fos.Commit();
+}
+
+void
+mixramp_cache_save() noexcept
+{
+	const std::lock_guard<Mutex> protect(mixramp_cache_mutex);
+
+	if (mixramp_cache_path.IsNull() || !mixramp_cache_modified)
+		return;
+
+	try {
+		mixramp_cache_write(mixramp_cache_path);
+		mixramp_cache_modified = false;
+	} catch (...) {
+		LogError(std::current_exception(),
+			 "Failed to save MixRamp cache");
+	}
+}
+
+void
+mixramp_cache_finish() noexcept
+{
+	mixramp_cache_save();
+
+	const std::lock_guard<Mutex> protect(mixramp_cache_mutex);
+	mixramp_cache_map.clear();
+	mixramp_cache_path = nullptr;
+}
+
+bool
+mixramp_cache_enabled() noexcept
+{
+	const std::lock_guard<Mutex> protect(mixramp_cache_mutex);
+
+	return !mixramp_cache_path.IsNull();
+}
+
+MixRampInfo
+mixramp_cache_get(const char *uri) noexcept
+{
+	const std::lock_guard<Mutex> protect(mixramp_cache_mutex);
+
+	auto i = mixramp_cache_map.find(uri);
+	return i != mixramp_cache_map.end()
+		? i->second
+		: MixRampInfo();
+}
+
+bool
+mixramp_cache_contains(const char *uri) noexcept
+{
+	const std::lock_guard<Mutex> protect(mixramp_cache_mutex);
+
+	return mixramp_cache_map.find(uri) != mixramp_cache_map.end();
+}
+
+void
+mixramp_cache_put(const char *uri, const MixRampInfo &info) noexcept
+{
+	if (!info.IsDefined())
+		return;
+
+	const std::lock_guard<Mutex> protect(mixramp_cache_mutex);
+
+	if (mixramp_cache_path.IsNull())
+		return;
+
+	mixramp_cache_map[uri] = info;
+	mixramp_cache_modified = true;
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * A persistent cache of MixRamp data, keyed by song URI.
+ *
+ * Crossfading with MixRamp normally depends on "mixramp_start" and
+ * "mixramp_end" tags in the song files; this cache stores such data
+ * (parsed from tags by the decoder, or computed by the analyzer in
+ * the update thread, see UpdateWalk::RunMixRampScan()) in a sidecar
+ * file, so the player thread can obtain it without decoding.
+ *
+ * All functions are thread-safe; the cache is shared by the player,
+ * decoder and update threads.
+ */
+
+#ifndef MPD_MIXRAMP_CACHE_HXX
+#define MPD_MIXRAMP_CACHE_HXX
+
+#include "util/Compiler.h"
+
+class AllocatedPath;
+class MixRampInfo;
+
+/**
+ * Opens the MixRamp cache and loads its contents.
+ *
+ * Throws std::runtime_error on error.
+ */
+void
+mixramp_cache_init(AllocatedPath &&path);
+
+/**
+ * Saves (if modified) and closes the MixRamp cache.
+ */
+void
+mixramp_cache_finish() noexcept;
+
+/**
+ * Returns true if the MixRamp cache is configured and available.
+ */
+gcc_pure
+bool
+mixramp_cache_enabled() noexcept;
+
+/**
+ * Looks up a song in the cache.  Returns an undefined #MixRampInfo
+ * if the song has no cached data.
+ */
+gcc_pure
+MixRampInfo
+mixramp_cache_get(const char *uri) noexcept;
+
+/**
+ * Returns true if the cache has an entry for the given song.
+ */
+gcc_pure
+bool
+mixramp_cache_contains(const char *uri) noexcept;
+
+/**
+ * Adds or replaces a song's cache entry.  The cache file is not
+ * written until mixramp_cache_save() or mixramp_cache_finish() is
+ * called.
+ */
+void
+mixramp_cache_put(const char *uri, const MixRampInfo &info) noexcept;
+
+/**
+ * Writes the cache file if the cache was modified.  Errors are
+ * logged.
+ */
+void
+mixramp_cache_save() noexcept;
+
+#endif
@@ -19,18 +19,47 @@
 
 #include "MusicBuffer.hxx"
 #include "MusicChunk.hxx"
+#include "Probes.hxx"
+
+#include <atomic>
 
 #include <assert.h>
 
+/**
+ * The total size of all #MusicBuffer arenas in this process.
+ */
+static std::atomic<size_t> music_buffer_bytes;
+
+size_t
+music_buffer_get_memory_usage() noexcept
+{
+	return music_buffer_bytes.load(std::memory_order_relaxed);
+}
+
 MusicBuffer::MusicBuffer(unsigned num_chunks)
 	:buffer(num_chunks) {
+	music_buffer_bytes.fetch_add(size_t(num_chunks) * sizeof(MusicChunk),
+				     std::memory_order_relaxed);
+}
+
+MusicBuffer::~MusicBuffer() noexcept
+{
+	music_buffer_bytes.fetch_sub(size_t(GetSize()) * sizeof(MusicChunk),
+				     std::memory_order_relaxed);
 }
 
 MusicChunkPtr
 MusicBuffer::Allocate() noexcept
 {
-	const std::lock_guard<Mutex> protect(mutex);
-	return MusicChunkPtr(buffer.Allocate(), MusicChunkDeleter(*this));
+	MusicChunk *chunk;
+
+	{
+		const std::lock_guard<Mutex> protect(allocate_mutex);
+		chunk = buffer.Allocate();
+	}
+
+	MPD_PROBE1(music_chunk_allocate, chunk);
+	return MusicChunkPtr(chunk, MusicChunkDeleter(*this));
 }
 
 void
@@ -38,14 +67,11 @@ MusicBuffer::Return(MusicChunk *chunk) noexcept
 {
 	assert(chunk != nullptr);
 
-	/* these attributes need to be cleared before locking the
-	   mutex, because they might recursively call this method,
-	   causing a deadlock */
+	/* these attributes need to be cleared up front, because they
+	   might recursively call this method */
 	chunk->next.reset();
 	chunk->other.reset();
 
-	const std::lock_guard<Mutex> protect(mutex);
-
 	assert(!chunk->other || !chunk->other->other);
 
 	buffer.Free(chunk);
@@ -24,15 +24,31 @@
 #include "util/SliceBuffer.hxx"
 #include "thread/Mutex.hxx"
 
+/**
+ * The total size of all #MusicBuffer chunk arenas in this process,
+ * for memory accounting.
+ */
+gcc_pure
+size_t
+music_buffer_get_memory_usage() noexcept;
+
 /**
  * An allocator for #MusicChunk objects.
+ *
+ * The #SliceBuffer free list is lock-free, but allows only one
+ * allocating thread at a time.  Since both the decoder thread and
+ * the player thread (when it restores the seek window) allocate
+ * chunks, Allocate() serializes them with a mutex; returning chunks
+ * remains lock-free and may happen on any thread.
  */
 class MusicBuffer {
-	/** a mutex which protects #buffer */
-	mutable Mutex mutex;
-
 	SliceBuffer<MusicChunk> buffer;
 
+	/**
+	 * Serializes Allocate() calls; see the class description.
+	 */
+	Mutex allocate_mutex;
+
 public:
 	/**
 	 * Creates a new #MusicBuffer object.
@@ -42,11 +58,12 @@ public:
 	 */
 	explicit MusicBuffer(unsigned num_chunks);
 
+	~MusicBuffer() noexcept;
+
 #ifndef NDEBUG
 	/**
-	 * Check whether the buffer is empty.  This call is not
-	 * protected with the mutex, and may only be used while this
-	 * object is inaccessible to other threads.
+	 * Check whether the buffer is empty.  This call may only be
+	 * used while this object is inaccessible to other threads.
 	 */
 	bool IsEmptyUnsafe() const {
 		return buffer.empty();
@@ -54,7 +71,6 @@ public:
 #endif
 
 	bool IsFull() const noexcept {
-		const std::lock_guard<Mutex> protect(mutex);
 		return buffer.IsFull();
 	}
 
@@ -19,13 +19,30 @@
 
 #include "MusicChunk.hxx"
 #include "AudioFormat.hxx"
+#include "pcm/Silence.hxx"
 #include "tag/Tag.hxx"
+#include "util/ConstBuffer.hxx"
+
+#include <algorithm>
 
 #include <assert.h>
 
 MusicChunkInfo::MusicChunkInfo() noexcept = default;
 MusicChunkInfo::~MusicChunkInfo() noexcept = default;
 
+std::chrono::milliseconds MusicChunk::max_duration{20};
+
+inline size_t
+MusicChunk::GetMaxLength(const AudioFormat af) const noexcept
+{
+	const size_t duration_size = af.TimeToSize(max_duration);
+	if (duration_size >= sizeof(data))
+		return sizeof(data);
+
+	/* at least one frame must fit */
+	return std::max(duration_size, size_t(af.GetFrameSize()));
+}
+
 #ifndef NDEBUG
 bool
 MusicChunkInfo::CheckFormat(const AudioFormat other_format) const noexcept
@@ -55,8 +72,13 @@ MusicChunk::Write(const AudioFormat af,
 #endif
 	}
 
+	const size_t max_length = GetMaxLength(af);
+	if (length >= max_length)
+		/* the duration limit has been reached */
+		return { data + length, size_t(0) };
+
 	const size_t frame_size = af.GetFrameSize();
-	size_t num_frames = (sizeof(data) - length) / frame_size;
+	size_t num_frames = (max_length - length) / frame_size;
 	return { data + length, num_frames * frame_size };
 }
 
@@ -68,7 +90,11 @@ MusicChunk::Expand(const AudioFormat af, size_t _length) noexcept
 	assert(length + _length <= sizeof(data));
 	assert(audio_format == af);
 
+	if (silence &&
+	    !PcmCheckSilence({data + length, _length}, af.format))
+		silence = false;
+
 	length += _length;
 
-	return length + frame_size > sizeof(data);
+	return length + frame_size > GetMaxLength(af);
 }
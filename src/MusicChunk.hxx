@@ -23,18 +23,28 @@
 #include "MusicChunkPtr.hxx"
 #include "Chrono.hxx"
 #include "ReplayGainInfo.hxx"
+#include "thread/Mutex.hxx"
 #include "util/WritableBuffer.hxx"
 
 #ifndef NDEBUG
 #include "AudioFormat.hxx"
 #endif
 
+#include <chrono>
 #include <memory>
+#include <vector>
 
 #include <stdint.h>
 #include <stddef.h>
 
-static constexpr size_t CHUNK_SIZE = 4096;
+/**
+ * The total size of one allocated #MusicChunk, including the
+ * #MusicChunkInfo header.  It is large enough to hold several
+ * milliseconds of high-resolution audio; how much of it is actually
+ * used is limited by MusicChunk::max_duration, so low sample rates
+ * do not get overly coarse chunks.
+ */
+static constexpr size_t CHUNK_SIZE = 16384;
 
 struct AudioFormat;
 struct Tag;
@@ -68,6 +78,15 @@ struct MusicChunkInfo {
 	/** number of bytes stored in this chunk */
 	uint16_t length = 0;
 
+	/**
+	 * Does this chunk contain only the format-specific silence
+	 * pattern?  Updated cheaply by Expand() while the decoder
+	 * fills the chunk; an empty chunk counts as silent.  Allows
+	 * consumers to skip expensive per-chunk processing (see
+	 * AudioOutputSource::FilterChunk()).
+	 */
+	bool silence = true;
+
 	/** current bit rate of the source file */
 	uint16_t bit_rate;
 
@@ -87,6 +106,28 @@ struct MusicChunkInfo {
 	 */
 	unsigned replay_gain_serial;
 
+	/**
+	 * Protects #filtered_signature and #filtered_data against
+	 * concurrent access by multiple output threads.
+	 */
+	mutable Mutex filtered_mutex;
+
+	/**
+	 * The signature of the filter chain which produced
+	 * #filtered_data; 0 means the cache is empty.  Once set, the
+	 * cache is never replaced, so readers may keep pointers into
+	 * #filtered_data without holding the lock.  See
+	 * AudioOutputSource::FilterChunk().
+	 */
+	mutable uint64_t filtered_signature = 0;
+
+	/**
+	 * Filtered PCM data shared by outputs whose filter chains
+	 * are equivalent, produced once by the first output which
+	 * processes this chunk.
+	 */
+	mutable std::vector<uint8_t> filtered_data;
+
 #ifndef NDEBUG
 	AudioFormat audio_format;
 #endif
@@ -116,6 +157,17 @@ struct MusicChunkInfo {
  * MusicPipe::Push() caller.
  */
 struct MusicChunk : MusicChunkInfo {
+	/**
+	 * The maximum duration of audio data one chunk may hold
+	 * ("audio_chunk_duration" setting).  Write() and Expand()
+	 * limit the usable capacity accordingly: without this limit,
+	 * low sample rates would fill the whole chunk (~90ms at
+	 * 44.1kHz/16/2), making cross-fade steps and decoder/player
+	 * handoff granularity much coarser.  High-resolution formats
+	 * are limited by the chunk capacity instead.
+	 */
+	static std::chrono::milliseconds max_duration;
+
 	/** the data (probably PCM) */
 	uint8_t data[CHUNK_SIZE - sizeof(MusicChunkInfo)];
 
@@ -144,6 +196,14 @@ struct MusicChunk : MusicChunkInfo {
 	 * @return true if the chunk is full
 	 */
 	bool Expand(AudioFormat af, size_t length) noexcept;
+
+private:
+	/**
+	 * The usable portion of #data for the given audio format,
+	 * limited by #max_duration.
+	 */
+	gcc_pure
+	size_t GetMaxLength(AudioFormat af) const noexcept;
 };
 
 static_assert(sizeof(MusicChunk) == CHUNK_SIZE, "Wrong size");
@@ -19,6 +19,8 @@
 
 #include "MusicPipe.hxx"
 #include "MusicChunk.hxx"
+#include "Metrics.hxx"
+#include "Probes.hxx"
 
 #ifndef NDEBUG
 
@@ -45,8 +47,12 @@ MusicPipe::Shift() noexcept
 	if (chunk != nullptr) {
 		assert(!chunk->IsEmpty());
 
+		MPD_PROBE2(music_chunk_shift, chunk.get(),
+			   chunk->time.ToMS());
+
 		head = std::move(chunk->next);
-		--size;
+		head_ptr.store(head.get(), std::memory_order_release);
+		size.fetch_sub(1, std::memory_order_relaxed);
 
 		if (head == nullptr) {
 			assert(size == 0);
@@ -90,9 +96,44 @@ MusicPipe::Push(MusicChunkPtr chunk) noexcept
 		audio_format = chunk->audio_format;
 #endif
 
+	global_metrics.decoded_chunks.fetch_add(1, std::memory_order_relaxed);
+	global_metrics.decoded_bytes.fetch_add(chunk->length,
+					       std::memory_order_relaxed);
+
+	MPD_PROBE2(music_chunk_push, chunk.get(), chunk->time.ToMS());
+
 	chunk->next.reset();
 	*tail_r = std::move(chunk);
 	tail_r = &(*tail_r)->next;
 
-	++size;
+	/* publish the new head (if the pipe was empty) with release
+	   ordering, so lock-free readers see the chunk's contents */
+	head_ptr.store(head.get(), std::memory_order_release);
+	size.fetch_add(1, std::memory_order_relaxed);
+}
+
+void
+MusicPipe::Unshift(MusicChunkPtr chunk) noexcept
+{
+	assert(!chunk->IsEmpty());
+	assert(chunk->length == 0 || chunk->audio_format.IsValid());
+
+	const std::lock_guard<Mutex> protect(mutex);
+
+	assert(size > 0 || !audio_format.IsDefined());
+	assert(!audio_format.IsDefined() ||
+	       chunk->CheckFormat(audio_format));
+
+#ifndef NDEBUG
+	if (!audio_format.IsDefined() && chunk->length > 0)
+		audio_format = chunk->audio_format;
+#endif
+
+	chunk->next = std::move(head);
+	head = std::move(chunk);
+	if (head->next == nullptr)
+		tail_r = &head->next;
+
+	head_ptr.store(head.get(), std::memory_order_release);
+	size.fetch_add(1, std::memory_order_relaxed);
 }
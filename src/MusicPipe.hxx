@@ -28,23 +28,39 @@
 #include "AudioFormat.hxx"
 #endif
 
+#include <atomic>
+
 #include <assert.h>
 
 /**
  * A queue of #MusicChunk objects.  One party appends chunks at the
  * tail, and the other consumes them from the head.
+ *
+ * The mutators (Push(), Shift(), Unshift()) are serialized by a
+ * mutex, but the read-only accessors (Peek(), GetSize(), IsEmpty())
+ * are lock-free: they run per chunk in the realtime output threads
+ * and in the decoder's throttling check, and must never block on a
+ * mutex held by another thread.
  */
 class MusicPipe {
 	/** the first chunk */
 	MusicChunkPtr head;
 
+	/**
+	 * A lock-free mirror of #head for Peek().  It is updated with
+	 * release ordering whenever #head changes, so a reader which
+	 * loads it with acquire ordering sees fully initialized chunk
+	 * contents.
+	 */
+	std::atomic<const MusicChunk *> head_ptr{nullptr};
+
 	/** a pointer to the tail of the chunk */
 	MusicChunkPtr *tail_r = &head;
 
 	/** the current number of chunks */
-	unsigned size = 0;
+	std::atomic<unsigned> size{0};
 
-	/** a mutex which protects #head and #tail_r */
+	/** a mutex which serializes the mutators */
 	mutable Mutex mutex;
 
 #ifndef NDEBUG
@@ -77,11 +93,15 @@ public:
 	/**
 	 * Returns the first #MusicChunk from the pipe.  Returns
 	 * nullptr if the pipe is empty.
+	 *
+	 * This method is lock-free; the caller's protocol must
+	 * guarantee that the returned chunk is not freed while it is
+	 * being used (the outputs hold their position in
+	 * #SharedPipeConsumer, and the player shifts a chunk only
+	 * after all outputs have consumed it).
 	 */
-	gcc_pure
 	const MusicChunk *Peek() const noexcept {
-		const std::lock_guard<Mutex> protect(mutex);
-		return head.get();
+		return head_ptr.load(std::memory_order_acquire);
 	}
 
 	/**
@@ -99,13 +119,22 @@ public:
 	 */
 	void Push(MusicChunkPtr chunk) noexcept;
 
+	/**
+	 * Pushes a chunk back to the head of the pipe.  Used by the
+	 * player to re-insert retained chunks while serving a seek
+	 * from the decoded window.
+	 */
+	void Unshift(MusicChunkPtr chunk) noexcept;
+
 	/**
 	 * Returns the number of chunks currently in this pipe.
+	 *
+	 * This method is lock-free; the result may be stale by the
+	 * time the caller uses it, which is fine for the throttling
+	 * and buffering heuristics it feeds.
 	 */
-	gcc_pure
 	unsigned GetSize() const noexcept {
-		const std::lock_guard<Mutex> protect(mutex);
-		return size;
+		return size.load(std::memory_order_relaxed);
 	}
 
 	gcc_pure
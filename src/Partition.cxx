@@ -29,16 +29,18 @@ Partition::Partition(Instance &_instance,
 		     const char *_name,
 		     unsigned max_length,
 		     unsigned buffer_chunks,
+		     unsigned decoder_wakeup_percent,
 		     AudioFormat configured_audio_format,
-		     const ReplayGainConfig &replay_gain_config)
+		     const ReplayGainConfig &replay_gain_config,
+		     uint64_t thread_affinity)
 	:instance(_instance),
 	 name(_name),
 	 listener(new ClientListener(instance.event_loop, *this)),
 	 global_events(instance.event_loop, BIND_THIS_METHOD(OnGlobalEvent)),
 	 playlist(max_length, *this),
 	 outputs(*this),
-	 pc(*this, outputs, buffer_chunks,
-	    configured_audio_format, replay_gain_config)
+	 pc(*this, outputs, buffer_chunks, decoder_wakeup_percent,
+	    configured_audio_format, replay_gain_config, thread_affinity)
 {
 	UpdateEffectiveReplayGainMode();
 }
@@ -86,6 +88,14 @@ Partition::DatabaseModified(const Database &db)
 	EmitIdle(IDLE_DATABASE);
 }
 
+void
+Partition::DatabaseSongsChanged(const Database &db,
+				const std::vector<std::string> &uris)
+{
+	playlist.DatabaseSongsChanged(db, uris);
+	EmitIdle(IDLE_DATABASE);
+}
+
 #endif
 
 void
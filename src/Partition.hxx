@@ -70,8 +70,10 @@ struct Partition final : QueueListener, PlayerListener, MixerListener {
 		  const char *_name,
 		  unsigned max_length,
 		  unsigned buffer_chunks,
+		  unsigned decoder_wakeup_percent,
 		  AudioFormat configured_audio_format,
-		  const ReplayGainConfig &replay_gain_config);
+		  const ReplayGainConfig &replay_gain_config,
+		  uint64_t thread_affinity);
 
 	~Partition() noexcept;
 
@@ -220,6 +222,14 @@ struct Partition final : QueueListener, PlayerListener, MixerListener {
 	 * all subsystems.
 	 */
 	void DatabaseModified(const Database &db);
+
+	/**
+	 * Like DatabaseModified(), but the given song URIs are known
+	 * to cover all modifications; only matching play queue
+	 * entries are refreshed.
+	 */
+	void DatabaseSongsChanged(const Database &db,
+				  const std::vector<std::string> &uris);
 #endif
 
 	/**
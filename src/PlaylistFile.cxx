@@ -174,23 +174,41 @@ ListPlaylistFiles()
 	return list;
 }
 
-static void
-SavePlaylistFile(const PlaylistFileContents &contents, const char *utf8path)
+/**
+ * Map one line of a playlist file to a song URI, the same way
+ * LoadPlaylistFile() does.
+ *
+ * @return the UTF-8 song URI, or an empty string if the line is a
+ * comment or cannot be mapped
+ */
+static std::string
+ParsePlaylistFileLine(const char *s)
 {
-	assert(utf8path != nullptr);
-
-	const auto path_fs = spl_map_to_fs(utf8path);
-	assert(!path_fs.IsNull());
-
-	FileOutputStream fos(path_fs);
-	BufferedOutputStream bos(fos);
-
-	for (const auto &uri_utf8 : contents)
-		playlist_print_uri(bos, uri_utf8.c_str());
+	if (*s == 0 || *s == PLAYLIST_COMMENT)
+		return {};
 
-	bos.Flush();
+#ifdef _UNICODE
+	/* on Windows, playlists always contain UTF-8, because its
+	   "narrow" charset (i.e. CP_ACP) is incapable of storing all
+	   Unicode paths */
+	const auto path = AllocatedPath::FromUTF8(s);
+	if (path.IsNull())
+		return {};
+#else
+	const Path path = Path::FromFS(s);
+#endif
 
-	fos.Commit();
+	if (!uri_has_scheme(s)) {
+#ifdef ENABLE_DATABASE
+		auto uri_utf8 = map_fs_to_utf8(path);
+		if (uri_utf8.empty() && path.IsAbsolute())
+			uri_utf8 = path.ToUTF8();
+		return uri_utf8;
+#else
+		return {};
+#endif
+	} else
+		return path.ToUTF8();
 }
 
 PlaylistFileContents
@@ -205,42 +223,10 @@ try {
 
 	char *s;
 	while ((s = file.ReadLine()) != nullptr) {
-		if (*s == 0 || *s == PLAYLIST_COMMENT)
+		auto uri_utf8 = ParsePlaylistFileLine(s);
+		if (uri_utf8.empty())
 			continue;
 
-#ifdef _UNICODE
-		/* on Windows, playlists always contain UTF-8, because
-		   its "narrow" charset (i.e. CP_ACP) is incapable of
-		   storing all Unicode paths */
-		const auto path = AllocatedPath::FromUTF8(s);
-		if (path.IsNull())
-			continue;
-#else
-		const Path path = Path::FromFS(s);
-#endif
-
-		std::string uri_utf8;
-
-		if (!uri_has_scheme(s)) {
-#ifdef ENABLE_DATABASE
-			uri_utf8 = map_fs_to_utf8(path);
-			if (uri_utf8.empty()) {
-				if (path.IsAbsolute()) {
-					uri_utf8 = path.ToUTF8();
-					if (uri_utf8.empty())
-						continue;
-				} else
-					continue;
-			}
-#else
-			continue;
-#endif
-		} else {
-			uri_utf8 = path.ToUTF8();
-			if (uri_utf8.empty())
-				continue;
-		}
-
 		contents.emplace_back(std::move(uri_utf8));
 		if (contents.size() >= playlist_max_length)
 			break;
@@ -253,6 +239,69 @@ try {
 	throw;
 }
 
+/**
+ * Load the raw lines of a playlist file, including comments and
+ * lines which cannot be mapped to songs.  Used for editing the file:
+ * a rewrite shall not convert or drop lines which were not touched by
+ * the edit.
+ */
+static std::vector<std::string>
+LoadPlaylistFileRaw(Path path_fs)
+try {
+	std::vector<std::string> lines;
+
+	TextFile file(path_fs);
+
+	char *s;
+	while ((s = file.ReadLine()) != nullptr)
+		lines.emplace_back(s);
+
+	return lines;
+} catch (const std::system_error &e) {
+	if (IsFileNotFound(e))
+		throw PlaylistError::NoSuchList();
+	throw;
+}
+
+static void
+SavePlaylistFileRaw(const std::vector<std::string> &lines, Path path_fs)
+{
+	FileOutputStream fos(path_fs);
+	BufferedOutputStream bos(fos);
+
+	for (const auto &line : lines)
+		bos.Format("%s\n", line.c_str());
+
+	bos.Flush();
+
+	fos.Commit();
+}
+
+/**
+ * Find the raw line containing the n'th song of the playlist, as
+ * counted by LoadPlaylistFile().
+ *
+ * @return the line index, or lines.size() if there is no such song
+ */
+static size_t
+FindPlaylistEntry(const std::vector<std::string> &lines, unsigned n)
+{
+	unsigned i = 0;
+
+	for (size_t k = 0; k < lines.size(); ++k) {
+		if (ParsePlaylistFileLine(lines[k].c_str()).empty())
+			continue;
+
+		if (i == n)
+			return k;
+
+		if (++i >= playlist_max_length)
+			break;
+	}
+
+	return lines.size();
+}
+
 void
 spl_move_index(const char *utf8path, unsigned src, unsigned dest)
 {
@@ -261,19 +310,26 @@ spl_move_index(const char *utf8path, unsigned src, unsigned dest)
 		   what the hell.. */
 		return;
 
-	auto contents = LoadPlaylistFile(utf8path);
+	const auto path_fs = spl_map_to_fs(utf8path);
+	assert(!path_fs.IsNull());
 
-	if (src >= contents.size() || dest >= contents.size())
+	auto lines = LoadPlaylistFileRaw(path_fs);
+
+	const size_t src_i = FindPlaylistEntry(lines, src);
+	if (src_i == lines.size() ||
+	    FindPlaylistEntry(lines, dest) == lines.size())
 		throw PlaylistError(PlaylistResult::BAD_RANGE, "Bad range");
 
-	const auto src_i = std::next(contents.begin(), src);
-	auto value = std::move(*src_i);
-	contents.erase(src_i);
+	const auto src_it = std::next(lines.begin(), src_i);
+	auto value = std::move(*src_it);
+	lines.erase(src_it);
 
-	const auto dest_i = std::next(contents.begin(), dest);
-	contents.insert(dest_i, std::move(value));
+	/* find the insertion point in the modified list; if the
+	   destination song is now the last one, append at the end */
+	const size_t dest_i = FindPlaylistEntry(lines, dest);
+	lines.insert(std::next(lines.begin(), dest_i), std::move(value));
 
-	SavePlaylistFile(contents, utf8path);
+	SavePlaylistFileRaw(lines, path_fs);
 
 	idle_add(IDLE_STORED_PLAYLIST);
 }
@@ -319,14 +375,18 @@ spl_delete(const char *name_utf8)
 void
 spl_remove_index(const char *utf8path, unsigned pos)
 {
-	auto contents = LoadPlaylistFile(utf8path);
+	const auto path_fs = spl_map_to_fs(utf8path);
+	assert(!path_fs.IsNull());
+
+	auto lines = LoadPlaylistFileRaw(path_fs);
 
-	if (pos >= contents.size())
+	const size_t i = FindPlaylistEntry(lines, pos);
+	if (i == lines.size())
 		throw PlaylistError(PlaylistResult::BAD_RANGE, "Bad range");
 
-	contents.erase(std::next(contents.begin(), pos));
+	lines.erase(std::next(lines.begin(), i));
 
-	SavePlaylistFile(contents, utf8path);
+	SavePlaylistFileRaw(lines, path_fs);
 	idle_add(IDLE_STORED_PLAYLIST);
 }
 
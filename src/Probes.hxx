@@ -0,0 +1,52 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_PROBES_HXX
+#define MPD_PROBES_HXX
+
+#include "config.h"
+
+/*
+ * USDT (static tracepoint) wrappers.  When <sys/sdt.h> is available
+ * at build time, these expand to nop-sized probe sites under the
+ * provider name "mpd" which bpftrace/systemtap/perf can attach to on
+ * a live daemon; without it, they compile to nothing.
+ *
+ * The music pipeline fires one probe per #MusicChunk lifecycle edge
+ * (allocation, pipe push/shift, output consumption, play
+ * completion), each carrying the chunk address and its audio
+ * timestamp [ms], so per-chunk end-to-end latency distributions can
+ * be reconstructed without a rebuild.
+ */
+
+#ifdef HAVE_SYS_SDT_H
+
+#include <sys/sdt.h>
+
+#define MPD_PROBE1(name, a) DTRACE_PROBE1(mpd, name, a)
+#define MPD_PROBE2(name, a, b) DTRACE_PROBE2(mpd, name, a, b)
+
+#else
+
+#define MPD_PROBE1(name, a)
+#define MPD_PROBE2(name, a, b)
+
+#endif
+
+#endif
@@ -22,10 +22,86 @@
 #include "input/ScanTags.hxx"
 #include "util/DeleteDisposer.hxx"
 #include "Log.hxx"
+#include "config.h"
+
+#ifdef ENABLE_SQLITE
+#include "sticker/StickerDatabase.hxx"
+#include "tag/Builder.hxx"
+#include "tag/ParseName.hxx"
+#include "util/NumberParser.hxx"
+#include "util/StringStrip.hxx"
+
+#include <stdio.h>
+#include <string.h>
+#endif
+
+#ifdef ENABLE_SQLITE
+
+static constexpr char remote_tag_sticker_type[] = "remote_tag";
+
+/**
+ * Serialize a #Tag into a single sticker value, using the same "NAME:
+ * VALUE" lines as the database file.
+ */
+static std::string
+TagToStickerValue(const Tag &tag) noexcept
+{
+	std::string result;
+
+	if (!tag.duration.IsNegative()) {
+		char buffer[64];
+		snprintf(buffer, sizeof(buffer), "Time: %f\n",
+			 tag.duration.ToDoubleS());
+		result += buffer;
+	}
+
+	for (const auto &item : tag) {
+		if (strchr(item.value, '\n') != nullptr)
+			/* the newline is our line separator; skip
+			   values which would break the format */
+			continue;
+
+		result += tag_item_names[item.type];
+		result += ": ";
+		result += item.value;
+		result += '\n';
+	}
+
+	return result;
+}
+
+static Tag
+TagFromStickerValue(const char *s) noexcept
+{
+	TagBuilder tag;
+
+	const char *eol;
+	for (; (eol = strchr(s, '\n')) != nullptr; s = eol + 1) {
+		const std::string line(s, eol);
+
+		const auto colon = line.find(':');
+		if (colon == line.npos || colon == 0)
+			continue;
+
+		const std::string name = line.substr(0, colon);
+		const char *value = StripLeft(line.c_str() + colon + 1);
+
+		const TagType type = tag_name_parse(name.c_str());
+		if (type != TAG_NUM_OF_ITEM_TYPES)
+			tag.AddItem(type, value);
+		else if (name == "Time")
+			tag.SetDuration(SignedSongTime::FromS(ParseDouble(value)));
+	}
+
+	return tag.Commit();
+}
+
+#endif
 
 RemoteTagCache::RemoteTagCache(EventLoop &event_loop,
-			       RemoteTagCacheHandler &_handler) noexcept
-	:handler(_handler),
+			       RemoteTagCacheHandler &_handler,
+			       size_t _max_size) noexcept
+	:handler(_handler), max_size(_max_size),
 	 defer_invoke_handler(event_loop, BIND_THIS_METHOD(InvokeHandlers)),
 	 map(typename KeyMap::bucket_traits(&buckets.front(), buckets.size()))
 {
@@ -49,6 +125,27 @@ RemoteTagCache::Lookup(const std::string &uri) noexcept
 		waiting_list.push_back(*item);
 		lock.unlock();
 
+#ifdef ENABLE_SQLITE
+		if (sticker_enabled()) {
+			/* consult the sticker database before
+			   starting an expensive network scan */
+			try {
+				const auto value =
+					sticker_load_value(remote_tag_sticker_type,
+							   uri.c_str(), "tag");
+				if (!value.empty()) {
+					item->tag = TagFromStickerValue(value.c_str());
+
+					lock.lock();
+					ItemResolved(*item);
+					return;
+				}
+			} catch (...) {
+				LogError(std::current_exception());
+			}
+		}
+#endif
+
 		try {
 			item->scanner = InputScanTags(uri.c_str(), *item);
 			if (!item->scanner) {
@@ -105,10 +202,27 @@ RemoteTagCache::InvokeHandlers() noexcept
 
 		const ScopeUnlock unlock(mutex);
 		handler.OnRemoteTag(item.uri.c_str(), item.tag);
+
+#ifdef ENABLE_SQLITE
+		if (item.dirty) {
+			item.dirty = false;
+
+			if (sticker_enabled() && item.tag.IsDefined()) {
+				try {
+					sticker_store_value(remote_tag_sticker_type,
+							    item.uri.c_str(),
+							    "tag",
+							    TagToStickerValue(item.tag).c_str());
+				} catch (...) {
+					LogError(std::current_exception());
+				}
+			}
+		}
+#endif
 	}
 
 	/* evict items if there are too many */
-	while (map.size() > MAX_SIZE && !idle_list.empty()) {
+	while (map.size() > max_size && !idle_list.empty()) {
 		auto *item = &idle_list.front();
 		idle_list.pop_front();
 		map.erase(map.iterator_to(*item));
@@ -120,6 +234,7 @@ void
 RemoteTagCache::Item::OnRemoteTag(Tag &&_tag) noexcept
 {
 	tag = std::move(_tag);
+	dirty = true;
 
 	scanner.reset();
 
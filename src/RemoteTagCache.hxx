@@ -36,10 +36,13 @@ class RemoteTagCacheHandler;
  * A cache for tags received via #RemoteTagScanner.
  */
 class RemoteTagCache final {
-	static constexpr size_t MAX_SIZE = 4096;
-
 	RemoteTagCacheHandler &handler;
 
+	/**
+	 * The maximum number of cached URIs.
+	 */
+	const size_t max_size;
+
 	DeferEvent defer_invoke_handler;
 
 	Mutex mutex;
@@ -57,6 +60,13 @@ class RemoteTagCache final {
 
 		Tag tag;
 
+		/**
+		 * Shall this item be written to the sticker
+		 * database?  Set after a successful scan, cleared
+		 * once the tag has been stored.
+		 */
+		bool dirty = false;
+
 		template<typename U>
 		Item(RemoteTagCache &_parent, U &&_uri) noexcept
 			:parent(_parent), uri(std::forward<U>(_uri)) {}
@@ -125,7 +135,8 @@ class RemoteTagCache final {
 
 public:
 	RemoteTagCache(EventLoop &event_loop,
-		       RemoteTagCacheHandler &_handler) noexcept;
+		       RemoteTagCacheHandler &_handler,
+		       size_t _max_size) noexcept;
 	~RemoteTagCache() noexcept;
 
 	void Lookup(const std::string &uri) noexcept;
@@ -27,11 +27,131 @@
 #include "TagPrint.hxx"
 #include "client/Response.hxx"
 #include "fs/Traits.hxx"
+#include "tag/Tag.hxx"
+#include "tag/Mask.hxx"
 #include "util/ChronoUtil.hxx"
 #include "util/UriUtil.hxx"
 
+#include <string>
+
+#include <stdint.h>
+#include <string.h>
+
 #define SONG_FILE "file: "
 
+/* field ids of the binary song record emitted when the client has
+   enabled the "binarymode" command; each field is the one byte id
+   followed by a 32 bit little-endian payload length and the raw
+   payload */
+static constexpr uint8_t SONG_FIELD_URI = 0x00;
+static constexpr uint8_t SONG_FIELD_MTIME = 0x01;
+static constexpr uint8_t SONG_FIELD_START_MS = 0x02;
+static constexpr uint8_t SONG_FIELD_END_MS = 0x03;
+static constexpr uint8_t SONG_FIELD_DURATION_MS = 0x04;
+static constexpr uint8_t SONG_FIELD_FORMAT = 0x05;
+
+/**
+ * Tag values are serialized as #SONG_FIELD_TAG_BASE plus the #TagType
+ * value.
+ */
+static constexpr uint8_t SONG_FIELD_TAG_BASE = 0x10;
+
+static void
+AppendLE32(std::string &b, uint32_t value) noexcept
+{
+	const uint8_t raw[4] = {
+		uint8_t(value),
+		uint8_t(value >> 8),
+		uint8_t(value >> 16),
+		uint8_t(value >> 24),
+	};
+
+	b.append((const char *)raw, sizeof(raw));
+}
+
+static void
+AppendStringField(std::string &b, uint8_t id, const char *value) noexcept
+{
+	const size_t length = strlen(value);
+
+	b.push_back((char)id);
+	AppendLE32(b, length);
+	b.append(value, length);
+}
+
+static void
+AppendNumberField(std::string &b, uint8_t id, uint32_t value) noexcept
+{
+	b.push_back((char)id);
+	AppendLE32(b, sizeof(value));
+	AppendLE32(b, value);
+}
+
+/**
+ * Serialize one song as a length-prefixed binary record, using the
+ * same "binary" chunk framing as the albumart command.  This skips
+ * all printf-style formatting, which dominates the server CPU usage
+ * of bulk responses like listallinfo.
+ */
+static void
+song_print_info_binary(Response &r, const LightSong &song,
+		       bool base) noexcept
+{
+	std::string record;
+
+	if (!base && song.directory != nullptr) {
+		std::string uri(song.directory);
+		uri.push_back('/');
+		uri += song.uri;
+
+		AppendStringField(record, SONG_FIELD_URI, uri.c_str());
+	} else {
+		const char *uri = song.uri;
+		std::string allocated;
+
+		if (base) {
+			uri = PathTraitsUTF8::GetBase(uri);
+		} else {
+			allocated = uri_remove_auth(uri);
+			if (!allocated.empty())
+				uri = allocated.c_str();
+		}
+
+		AppendStringField(record, SONG_FIELD_URI, uri);
+	}
+
+	if (!IsNegative(song.mtime))
+		AppendNumberField(record, SONG_FIELD_MTIME,
+				  std::chrono::system_clock::to_time_t(song.mtime));
+
+	if (song.start_time.ToMS() > 0)
+		AppendNumberField(record, SONG_FIELD_START_MS,
+				  song.start_time.ToMS());
+
+	if (song.end_time.ToMS() > 0)
+		AppendNumberField(record, SONG_FIELD_END_MS,
+				  song.end_time.ToMS());
+
+	if (song.audio_format.IsDefined())
+		AppendStringField(record, SONG_FIELD_FORMAT,
+				  ToString(song.audio_format).c_str());
+
+	if (!song.tag.duration.IsNegative())
+		AppendNumberField(record, SONG_FIELD_DURATION_MS,
+				  song.tag.duration.ToMS());
+
+	const auto tag_mask = r.GetTagMask();
+	for (const auto &item : song.tag)
+		if (tag_mask.Test(item.type))
+			AppendStringField(record,
+					  uint8_t(SONG_FIELD_TAG_BASE + item.type),
+					  item.value);
+
+	r.WritePair("binary", unsigned(record.size()));
+	r.Write(record.data(), record.size());
+	r.Write("\n");
+}
+
 static void
 song_print_uri(Response &r, const char *uri, bool base) noexcept
 {
@@ -45,15 +165,19 @@ song_print_uri(Response &r, const char *uri, bool base) noexcept
 			uri = allocated.c_str();
 	}
 
-	r.Format(SONG_FILE "%s\n", uri);
+	r.WritePair("file", uri);
 }
 
 void
 song_print_uri(Response &r, const LightSong &song, bool base) noexcept
 {
-	if (!base && song.directory != nullptr)
-		r.Format(SONG_FILE "%s/%s\n", song.directory, song.uri);
-	else
+	if (!base && song.directory != nullptr) {
+		r.Write(SONG_FILE);
+		r.Write(song.directory);
+		r.Write("/");
+		r.Write(song.uri);
+		r.Write("\n");
+	} else
 		song_print_uri(r, song.uri, base);
 }
 
@@ -84,6 +208,11 @@ PrintRange(Response &r, SongTime start_time, SongTime end_time) noexcept
 void
 song_print_info(Response &r, const LightSong &song, bool base) noexcept
 {
+	if (r.IsBinarySongOutput()) {
+		song_print_info_binary(r, song, base);
+		return;
+	}
+
 	song_print_uri(r, song, base);
 
 	PrintRange(r, song.start_time, song.end_time);
@@ -92,7 +221,7 @@ song_print_info(Response &r, const LightSong &song, bool base) noexcept
 		time_print(r, "Last-Modified", song.mtime);
 
 	if (song.audio_format.IsDefined())
-		r.Format("Format: %s\n", ToString(song.audio_format).c_str());
+		r.WritePair("Format", ToString(song.audio_format).c_str());
 
 	tag_print(r, song.tag);
 }
@@ -100,6 +229,12 @@ song_print_info(Response &r, const LightSong &song, bool base) noexcept
 void
 song_print_info(Response &r, const DetachedSong &song, bool base) noexcept
 {
+	if (r.IsBinarySongOutput()) {
+		song_print_info_binary(r, static_cast<LightSong>(song),
+				       base);
+		return;
+	}
+
 	song_print_uri(r, song, base);
 
 	PrintRange(r, song.GetStartTime(), song.GetEndTime());
@@ -110,9 +245,8 @@ song_print_info(Response &r, const DetachedSong &song, bool base) noexcept
 	tag_print_values(r, song.GetTag());
 
 	const auto duration = song.GetDuration();
-	if (!duration.IsNegative())
-		r.Format("Time: %i\n"
-			 "duration: %1.3f\n",
-			 duration.RoundS(),
-			 duration.ToDoubleS());
+	if (!duration.IsNegative()) {
+		r.WritePair("Time", int(duration.RoundS()));
+		r.WritePairMilli("duration", duration.ToMS());
+	}
 }
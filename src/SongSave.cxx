@@ -22,7 +22,7 @@
 #include "db/plugins/simple/Song.hxx"
 #include "song/DetachedSong.hxx"
 #include "TagSave.hxx"
-#include "fs/io/TextFile.hxx"
+#include "fs/io/LineReader.hxx"
 #include "fs/io/BufferedOutputStream.hxx"
 #include "tag/ParseName.hxx"
 #include "tag/Tag.hxx"
@@ -54,6 +54,9 @@ song_save(BufferedOutputStream &os, const Song &song)
 {
 	os.Format(SONG_BEGIN "%s\n", song.uri);
 
+	if (!song.target.empty())
+		os.Format("Target: %s\n", song.target.c_str());
+
 	range_save(os, song.start_time.ToMS(), song.end_time.ToMS());
 
 	tag_save(os, song.tag);
@@ -83,7 +86,7 @@ song_save(BufferedOutputStream &os, const DetachedSong &song)
 }
 
 std::unique_ptr<DetachedSong>
-song_load(TextFile &file, const char *uri,
+song_load(LineReader &file, const char *uri,
 	  AudioFormat *audio_format_r)
 {
 	auto song = std::make_unique<DetachedSong>(uri);
@@ -115,6 +118,8 @@ song_load(TextFile &file, const char *uri,
 					/* ignore parser errors */
 				}
 			}
+		} else if (strcmp(line, "Target") == 0) {
+			song->SetRealURI(value);
 		} else if (strcmp(line, "Playlist") == 0) {
 			tag.SetHasPlaylist(strcmp(value, "yes") == 0);
 		} else if (strcmp(line, SONG_MTIME) == 0) {
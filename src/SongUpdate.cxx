@@ -157,7 +157,7 @@ DetachedSong::LoadFile(Path path) noexcept
 		return false;
 
 	mtime = fi.GetModificationTime();
-	tag_builder.Commit(tag);
+	SetTag(tag_builder.Commit());
 	return true;
 }
 
@@ -177,7 +177,7 @@ DetachedSong::Update() noexcept
 			return false;
 
 		mtime = std::chrono::system_clock::time_point::min();
-		tag_builder.Commit(tag);
+		SetTag(tag_builder.Commit());
 		return true;
 	} else
 		// TODO: implement
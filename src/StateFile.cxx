@@ -21,6 +21,9 @@
 #include "StateFile.hxx"
 #include "output/State.hxx"
 #include "queue/PlaylistState.hxx"
+#include "queue/QueueSave.hxx"
+#include "fs/FileSystem.hxx"
+#include "fs/Traits.hxx"
 #include "fs/io/TextFile.hxx"
 #include "fs/io/FileOutputStream.hxx"
 #include "fs/io/BufferedOutputStream.hxx"
@@ -38,9 +41,18 @@
 
 static constexpr Domain state_file_domain("state_file");
 
+static AllocatedPath
+MakeQueuePath(Path state_path) noexcept
+{
+	auto s = PathTraitsFS::string(state_path.c_str());
+	s += PATH_LITERAL(".queue");
+	return AllocatedPath::FromFS(std::move(s));
+}
+
 StateFile::StateFile(StateFileConfig &&_config,
 		     Partition &_partition, EventLoop &_loop)
 	:config(std::move(_config)), path_utf8(config.path.ToUTF8()),
+	 queue_path(MakeQueuePath(config.path)),
 	 timer_event(_loop, BIND_THIS_METHOD(OnTimeout)),
 	 partition(_partition)
 {
@@ -53,6 +65,7 @@ StateFile::RememberVersions() noexcept
 	prev_output_version = audio_output_state_get_version();
 	prev_playlist_version = playlist_state_get_hash(partition.playlist,
 							partition.pc);
+	prev_queue_version = partition.playlist.queue.version;
 #ifdef ENABLE_DATABASE
 	prev_storage_version = storage_state_get_hash(partition.instance);
 #endif
@@ -81,7 +94,8 @@ StateFile::Write(BufferedOutputStream &os)
 	storage_state_save(os, partition.instance);
 #endif
 
-	playlist_state_save(os, partition.playlist, partition.pc);
+	/* the queue lives in a separate file, see WriteQueue() */
+	playlist_state_save(os, partition.playlist, partition.pc, false);
 }
 
 inline void
@@ -92,12 +106,38 @@ StateFile::Write(OutputStream &os)
 	bos.Flush();
 }
 
+void
+StateFile::WriteQueue()
+{
+	FileOutputStream fos(queue_path);
+
+	{
+		BufferedOutputStream bos(fos);
+		queue_save(bos, partition.playlist.queue);
+		bos.Flush();
+	}
+
+	fos.Commit();
+}
+
 void
 StateFile::Write()
 {
 	FormatDebug(state_file_domain,
 		    "Saving state file %s", path_utf8.c_str());
 
+	if (prev_queue_version != partition.playlist.queue.version) {
+		/* only rewrite the (potentially huge) queue file
+		   when the queue itself was modified; a mere
+		   position/volume change only touches the small main
+		   file below */
+		try {
+			WriteQueue();
+		} catch (...) {
+			LogError(std::current_exception());
+		}
+	}
+
 	try {
 		FileOutputStream fos(config.path);
 		Write(fos);
@@ -125,6 +165,22 @@ try {
 	const SongLoader song_loader(nullptr, nullptr);
 #endif
 
+	/* load the queue from its separate file before the main
+	   state file, whose "current"/"time" attributes refer to it;
+	   state files written by older versions contain the queue
+	   inline instead, which playlist_state_restore() still
+	   handles */
+	if (PathExists(queue_path)) {
+		TextFile queue_file(queue_path);
+
+		const char *queue_line;
+		while ((queue_line = queue_file.ReadLine()) != nullptr)
+			queue_load_song(queue_file, song_loader, queue_line,
+					partition.playlist.queue);
+
+		partition.playlist.queue.IncrementVersion();
+	}
+
 	const char *line;
 	while ((line = file.ReadLine()) != nullptr) {
 		success = read_sw_volume_state(line, partition.outputs) ||
@@ -38,6 +38,15 @@ class StateFile final {
 
 	const std::string path_utf8;
 
+	/**
+	 * The file holding the queue contents (the state file path
+	 * with ".queue" appended).  It is only rewritten when the
+	 * queue was actually modified, so the periodic saves of the
+	 * frequently changing attributes (elapsed time, volume, ...)
+	 * don't rewrite a potentially huge queue every time.
+	 */
+	const AllocatedPath queue_path;
+
 	TimerEvent timer_event;
 
 	Partition &partition;
@@ -47,7 +56,7 @@ class StateFile final {
 	 * file.  If nothing has changed, we won't let the hard drive spin up.
 	 */
 	unsigned prev_volume_version = 0, prev_output_version = 0,
-		prev_playlist_version = 0;
+		prev_playlist_version = 0, prev_queue_version = 0;
 
 #ifdef ENABLE_DATABASE
 	unsigned prev_storage_version = 0;
@@ -69,6 +78,13 @@ private:
 	void Write(OutputStream &os);
 	void Write(BufferedOutputStream &os);
 
+	/**
+	 * Write the queue contents to #queue_path.
+	 *
+	 * Throws on error.
+	 */
+	void WriteQueue();
+
 	/**
 	 * Save the current state versions for use with IsModified().
 	 */
@@ -75,8 +75,19 @@ public:
 
 	bool Scan(const DecoderPlugin &plugin) noexcept {
 		return plugin.SupportsSuffix(suffix) &&
+			decoder_plugin_ensure_initialized(plugin) &&
 			(ScanFile(plugin) || ScanStream(plugin));
 	}
+
+	/**
+	 * Surrender the #InputStream which may have been opened for
+	 * ScanStream(), so the caller can reuse it instead of opening
+	 * the file a second time.  May return nullptr if no plugin
+	 * needed a stream.
+	 */
+	InputStreamPtr TakeInputStream() noexcept {
+		return std::move(is);
+	}
 };
 
 bool
@@ -102,13 +113,37 @@ bool
 ScanFileTagsWithGeneric(Path path, TagBuilder &builder,
 			AudioFormat *audio_format) noexcept
 {
+	assert(!path.IsNull());
+
+	const auto *suffix = path.GetSuffix();
+	if (suffix == nullptr)
+		return false;
+
+	const auto suffix_utf8 = Path::FromFS(suffix).ToUTF8();
+
 	FullTagHandler h(builder, audio_format);
 
-	if (!ScanFileTagsNoGeneric(path, h))
+	TagFileScan tfs(path, suffix_utf8.c_str(), h);
+	if (!decoder_plugins_try([&](const DecoderPlugin &plugin){
+			return tfs.Scan(plugin);
+		}))
 		return false;
 
-	if (builder.empty())
-		ScanGenericTags(path, h);
+	if (builder.empty()) {
+		/* the decoder plugin found no tags; fall back to the
+		   generic scanners, reusing the InputStream the scan
+		   may have opened already instead of opening the file
+		   again */
+		auto is = tfs.TakeInputStream();
+		if (is != nullptr) {
+			try {
+				is->LockRewind();
+				ScanGenericTags(*is, h);
+			} catch (...) {
+			}
+		} else
+			ScanGenericTags(path, h);
+	}
 
 	return true;
 }
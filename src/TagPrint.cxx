@@ -28,13 +28,13 @@ tag_print_types(Response &r) noexcept
 	const auto tag_mask = global_tag_mask & r.GetTagMask();
 	for (unsigned i = 0; i < TAG_NUM_OF_ITEM_TYPES; i++)
 		if (tag_mask.Test(TagType(i)))
-			r.Format("tagtype: %s\n", tag_item_names[i]);
+			r.WritePair("tagtype", tag_item_names[i]);
 }
 
 void
 tag_print(Response &r, TagType type, const char *value) noexcept
 {
-	r.Format("%s: %s\n", tag_item_names[type], value);
+	r.WritePair(tag_item_names[type], value);
 }
 
 void
@@ -49,11 +49,10 @@ tag_print_values(Response &r, const Tag &tag) noexcept
 void
 tag_print(Response &r, const Tag &tag) noexcept
 {
-	if (!tag.duration.IsNegative())
-		r.Format("Time: %i\n"
-			 "duration: %1.3f\n",
-			 tag.duration.RoundS(),
-			 tag.duration.ToDoubleS());
+	if (!tag.duration.IsNegative()) {
+		r.WritePair("Time", int(tag.duration.RoundS()));
+		r.WritePairMilli("duration", tag.duration.ToMS());
+	}
 
 	tag_print_values(r, tag);
 }
@@ -68,6 +68,7 @@ tag_stream_scan(InputStream &is, TagHandler &handler) noexcept
 			}
 
 			return CheckDecoderPlugin(plugin, suffix, mime) &&
+				decoder_plugin_ensure_initialized(plugin) &&
 				plugin.ScanStream(is, handler);
 		});
 }
@@ -0,0 +1,138 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "ArchiveCache.hxx"
+#include "ArchiveFile.hxx"
+#include "ArchivePlugin.hxx"
+#include "fs/AllocatedPath.hxx"
+#include "fs/FileInfo.hxx"
+#include "thread/Mutex.hxx"
+
+#include <chrono>
+#include <list>
+
+#include <assert.h>
+
+struct ArchiveCacheEntry {
+	AllocatedPath path;
+
+	/**
+	 * The modification time of the archive file when it was
+	 * parsed; a mismatch invalidates the entry.
+	 */
+	std::chrono::system_clock::time_point mtime;
+
+	std::shared_ptr<ArchiveFile> file;
+
+	ArchiveCacheEntry(Path _path,
+			  std::chrono::system_clock::time_point _mtime,
+			  std::shared_ptr<ArchiveFile> _file) noexcept
+		:path(_path), mtime(_mtime), file(std::move(_file)) {}
+};
+
+/**
+ * How many parsed archive handles may be kept around.  An idle
+ * handle costs only the parsed directory index plus one file
+ * descriptor, so a small number is enough to cover the archives
+ * being played and scanned at any given time.
+ */
+static constexpr size_t MAX_CACHED_ARCHIVES = 16;
+
+static Mutex archive_cache_mutex;
+
+/**
+ * All cached archives, most recently used first.  Protected by
+ * #archive_cache_mutex.
+ */
+static std::list<ArchiveCacheEntry> archive_cache;
+
+std::shared_ptr<ArchiveFile>
+archive_cache_open(const ArchivePlugin &plugin, Path path)
+{
+	assert(plugin.open != nullptr);
+	assert(!path.IsNull());
+
+	const FileInfo info(path);
+	const auto mtime = info.GetModificationTime();
+	const AllocatedPath key(path);
+
+	{
+		const std::lock_guard<Mutex> protect(archive_cache_mutex);
+
+		for (auto i = archive_cache.begin();
+		     i != archive_cache.end(); ++i) {
+			if (!(i->path == key))
+				continue;
+
+			if (i->mtime != mtime) {
+				/* the archive has been modified:
+				   discard the stale index */
+				archive_cache.erase(i);
+				break;
+			}
+
+			/* references are added only while holding
+			   the mutex, so a use_count() of 1 means
+			   nobody else is using this handle right
+			   now */
+			if (i->file.use_count() > 1)
+				/* busy - open a second handle
+				   instead of sharing this one */
+				break;
+
+			/* move to the front of the LRU list */
+			archive_cache.splice(archive_cache.begin(),
+					     archive_cache, i);
+			return archive_cache.front().file;
+		}
+	}
+
+	/* the expensive part (parsing the archive's directory) runs
+	   without the lock held */
+	std::shared_ptr<ArchiveFile> file(plugin.open(path));
+
+	const std::lock_guard<Mutex> protect(archive_cache_mutex);
+
+	if (archive_cache.size() >= MAX_CACHED_ARCHIVES)
+		/* evict the least recently used idle entry; if all
+		   are busy, the cache exceeds its limit until their
+		   users are done */
+		for (auto i = std::prev(archive_cache.end());;--i) {
+			if (i->file.use_count() == 1) {
+				archive_cache.erase(i);
+				break;
+			}
+
+			if (i == archive_cache.begin())
+				break;
+		}
+
+	archive_cache.emplace_front(path, mtime, file);
+	return file;
+}
+
+void
+archive_cache_flush() noexcept
+{
+	const std::lock_guard<Mutex> protect(archive_cache_mutex);
+
+	/* handles still referenced by an #InputStream are closed by
+	   their last shared_ptr, not here */
+	archive_cache.clear();
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_ARCHIVE_CACHE_HXX
+#define MPD_ARCHIVE_CACHE_HXX
+
+#include <memory>
+
+struct ArchivePlugin;
+class ArchiveFile;
+class Path;
+
+/**
+ * Opens an archive file like archive_file_open(), but reuses a
+ * recently parsed #ArchiveFile handle if one is available.  Parsing
+ * an archive's directory is O(archive size); with the cache, opening
+ * many songs inside the same archive pays that cost only once.
+ *
+ * Entries are keyed by path and modification time; a modified
+ * archive is re-parsed.  A handle which is still busy (an
+ * #InputStream is reading from it) is never handed out a second
+ * time, because the archive plugins do not support concurrent
+ * access to one handle.
+ *
+ * Throws std::runtime_error on error.
+ */
+std::shared_ptr<ArchiveFile>
+archive_cache_open(const ArchivePlugin &plugin, Path path);
+
+/**
+ * Drops all cached archive handles.  Handles which are still in use
+ * are closed as soon as their last user is done with them.
+ */
+void
+archive_cache_flush() noexcept;
+
+#endif
@@ -19,12 +19,45 @@
 
 #include "ArchiveLookup.hxx"
 #include "ArchiveDomain.hxx"
+#include "thread/Mutex.hxx"
 #include "Log.hxx"
 
+#include <list>
+#include <string>
+
 #include <string.h>
 #include <sys/stat.h>
 #include <errno.h>
 
+struct LookupCacheEntry {
+	/**
+	 * A path which has been verified to be a regular file (the
+	 * archive).
+	 */
+	std::string path;
+
+	/**
+	 * Its modification time at verification; a mismatch
+	 * invalidates the entry.
+	 */
+	time_t mtime;
+
+	LookupCacheEntry(const char *_path, size_t length, time_t _mtime)
+		:path(_path, length), mtime(_mtime) {}
+};
+
+static constexpr size_t MAX_LOOKUP_CACHE = 32;
+
+static Mutex lookup_cache_mutex;
+
+/**
+ * Memoized archive prefixes, most recently used first.  Playing
+ * through an archived album looks up many paths inside the same
+ * archive; a cache hit replaces the whole chop-and-stat sequence with
+ * a single validating stat.  Protected by #lookup_cache_mutex.
+ */
+static std::list<LookupCacheEntry> lookup_cache;
+
 gcc_pure
 static char *
 FindSlash(char *p, size_t i) noexcept
@@ -48,10 +81,68 @@ FindSuffix(const char *p, const char *i) noexcept
 	return nullptr;
 }
 
+/**
+ * Check whether a memoized archive prefix matches the given path; on
+ * a hit, validate the prefix with a single stat and split the path
+ * just like archive_lookup() would.
+ */
+static bool
+LookupCacheFind(char *pathname, const char **archive,
+		const char **inpath, const char **suffix) noexcept
+{
+	const std::lock_guard<Mutex> protect(lookup_cache_mutex);
+
+	for (auto i = lookup_cache.begin(); i != lookup_cache.end(); ++i) {
+		const size_t length = i->path.length();
+		if (strncmp(pathname, i->path.c_str(), length) != 0 ||
+		    pathname[length] != '/')
+			continue;
+
+		char *slash = pathname + length;
+		*slash = 0;
+
+		struct stat st_info;
+		if (stat(pathname, &st_info) == 0 &&
+		    S_ISREG(st_info.st_mode) &&
+		    st_info.st_mtime == i->mtime) {
+			*archive = pathname;
+			*inpath = slash + 1;
+			*suffix = FindSuffix(pathname, slash - 1);
+
+			/* move to the front of the MRU list */
+			lookup_cache.splice(lookup_cache.begin(),
+					    lookup_cache, i);
+			return true;
+		}
+
+		/* the archive is gone or has been modified; forget it
+		   and fall back to the full lookup */
+		*slash = '/';
+		lookup_cache.erase(i);
+		break;
+	}
+
+	return false;
+}
+
+static void
+LookupCacheAdd(const char *archive, size_t length, time_t mtime) noexcept
+{
+	const std::lock_guard<Mutex> protect(lookup_cache_mutex);
+
+	if (lookup_cache.size() >= MAX_LOOKUP_CACHE)
+		lookup_cache.pop_back();
+
+	lookup_cache.emplace_front(archive, length, mtime);
+}
+
 bool
 archive_lookup(char *pathname, const char **archive,
 	       const char **inpath, const char **suffix)
 {
+	if (LookupCacheFind(pathname, archive, inpath, suffix))
+		return true;
+
 	size_t idx = strlen(pathname);
 
 	char *slash = nullptr;
@@ -78,6 +169,10 @@ archive_lookup(char *pathname, const char **archive,
 
 				//try to get suffix
 				*suffix = FindSuffix(pathname, slash - 1);
+
+				//remember the verified prefix
+				LookupCacheAdd(pathname, idx,
+					       st_info.st_mtime);
 				return true;
 			} else {
 				FormatError(archive_domain,
@@ -31,6 +31,7 @@
 
 #include <bzlib.h>
 
+#include <algorithm>
 #include <stdexcept>
 
 class Bzip2ArchiveFile final : public ArchiveFile {
@@ -73,6 +74,7 @@ public:
 	/* virtual methods from InputStream */
 	bool IsEOF() noexcept override;
 	size_t Read(void *ptr, size_t size) override;
+	void Seek(offset_type offset) override;
 
 private:
 	void Open();
@@ -95,6 +97,10 @@ Bzip2InputStream::Open()
 	if (ret != BZ_OK)
 		throw std::runtime_error("BZ2_bzDecompressInit() has failed");
 
+	/* emulated seeking: forward seeks decompress into a scratch
+	   buffer, backward seeks restart decompression */
+	seekable = input->IsSeekable();
+
 	SetReady();
 }
 
@@ -181,6 +187,43 @@ Bzip2InputStream::Read(void *ptr, size_t length)
 	return nbytes;
 }
 
+void
+Bzip2InputStream::Seek(offset_type new_offset)
+{
+	if (new_offset == offset)
+		return;
+
+	if (new_offset < offset) {
+		/* a bzip2 stream has no random access; restart
+		   decompression from the beginning */
+		BZ2_bzDecompressEnd(&bzstream);
+
+		{
+			const ScopeUnlock unlock(mutex);
+			input->LockSeek(0);
+		}
+
+		bzstream.next_in = (char *)buffer;
+		bzstream.avail_in = 0;
+
+		if (BZ2_bzDecompressInit(&bzstream, 0, 0) != BZ_OK)
+			throw std::runtime_error("BZ2_bzDecompressInit() has failed");
+
+		eof = false;
+		offset = 0;
+	}
+
+	/* skip forward by decompressing into a scratch buffer */
+
+	while (offset < new_offset) {
+		char discard[8192];
+		size_t nbytes = std::min<offset_type>(sizeof(discard),
+						      new_offset - offset);
+		if (Read(discard, nbytes) == 0)
+			throw std::runtime_error("Premature end of bzip2 stream");
+	}
+}
+
 bool
 Bzip2InputStream::IsEOF() noexcept
 {
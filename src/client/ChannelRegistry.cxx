@@ -0,0 +1,76 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "ChannelRegistry.hxx"
+
+#include <algorithm>
+
+#include <assert.h>
+
+void
+ChannelRegistry::Add(const char *channel, Client &client) noexcept
+{
+	auto &subscribers = channels[channel];
+
+	assert(std::find(subscribers.begin(), subscribers.end(),
+			 &client) == subscribers.end());
+
+	subscribers.push_back(&client);
+}
+
+void
+ChannelRegistry::Remove(const char *channel, Client &client) noexcept
+{
+	auto i = channels.find(channel);
+	if (i == channels.end())
+		return;
+
+	auto &subscribers = i->second;
+	auto j = std::find(subscribers.begin(), subscribers.end(), &client);
+	if (j == subscribers.end())
+		return;
+
+	subscribers.erase(j);
+	if (subscribers.empty())
+		channels.erase(i);
+}
+
+void
+ChannelRegistry::RemoveClient(Client &client) noexcept
+{
+	for (auto i = channels.begin(); i != channels.end();) {
+		auto &subscribers = i->second;
+		auto j = std::find(subscribers.begin(), subscribers.end(),
+				   &client);
+		if (j != subscribers.end())
+			subscribers.erase(j);
+
+		if (subscribers.empty())
+			i = channels.erase(i);
+		else
+			++i;
+	}
+}
+
+const std::vector<Client *> *
+ChannelRegistry::Find(const char *channel) const noexcept
+{
+	auto i = channels.find(channel);
+	return i != channels.end() ? &i->second : nullptr;
+}
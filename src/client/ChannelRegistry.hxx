@@ -0,0 +1,81 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_CHANNEL_REGISTRY_HXX
+#define MPD_CHANNEL_REGISTRY_HXX
+
+#include "util/Compiler.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+class Client;
+
+/**
+ * Maps channel names to the list of subscribed clients, so
+ * "sendmessage" can deliver to subscribers only instead of probing
+ * every connected client.
+ *
+ * Each #Client still keeps its own subscription set for the
+ * per-client limit and the "channels" listing of its own
+ * subscriptions; this registry is the inverted index.
+ */
+class ChannelRegistry {
+	std::map<std::string, std::vector<Client *>> channels;
+
+public:
+	/**
+	 * Register a subscription.  The caller has already verified
+	 * that the client is not yet subscribed to this channel.
+	 */
+	void Add(const char *channel, Client &client) noexcept;
+
+	/**
+	 * Remove one subscription.  No-op if the client is not
+	 * subscribed.
+	 */
+	void Remove(const char *channel, Client &client) noexcept;
+
+	/**
+	 * Remove all subscriptions of the given client, e.g. because
+	 * it has disconnected.
+	 */
+	void RemoveClient(Client &client) noexcept;
+
+	void Clear() noexcept {
+		channels.clear();
+	}
+
+	/**
+	 * Look up the subscribers of a channel.  Returns nullptr if
+	 * nobody is subscribed.
+	 */
+	gcc_pure
+	const std::vector<Client *> *Find(const char *channel) const noexcept;
+
+	/**
+	 * All channels with at least one subscriber, sorted by name.
+	 */
+	const std::map<std::string, std::vector<Client *>> &GetMap() const noexcept {
+		return channels;
+	}
+};
+
+#endif
@@ -21,6 +21,7 @@
 #define MPD_CLIENT_H
 
 #include "ClientMessage.hxx"
+#include "IdleFlags.hxx"
 #include "command/CommandListBuilder.hxx"
 #include "tag/Mask.hxx"
 #include "event/FullyBufferedSocket.hxx"
@@ -35,6 +36,7 @@
 #include <list>
 
 #include <stddef.h>
+#include <stdint.h>
 
 struct ConfigData;
 class SocketAddress;
@@ -68,18 +70,32 @@ public:
 	/** is this client waiting for an "idle" response? */
 	bool idle_waiting = false;
 
-	/** idle flags pending on this client, to be sent as soon as
-	    the client enters "idle" */
+	/** idle flags raised directly on this client (e.g.
+	    IDLE_MESSAGE), to be sent as soon as the client enters
+	    "idle"; global events are tracked via #idle_seen
+	    instead */
 	unsigned idle_flags = 0;
 
 	/** idle flags that the client wants to receive */
-	unsigned idle_subscriptions;
+	unsigned idle_subscriptions = 0;
+
+	/** snapshot of the #ClientList per-flag event counters; a
+	    global event is pending on this client as long as its
+	    counter differs from this snapshot */
+	uint64_t idle_seen[IDLE_NR_FLAGS];
 
 	/**
 	 * The tags this client is interested in.
 	 */
 	TagMask tag_mask = TagMask::All();
 
+	/**
+	 * Shall song records in bulk responses be serialized as
+	 * length-prefixed binary fields instead of "key: value" text
+	 * lines?  Set by the "binarymode" command.
+	 */
+	bool binary_song_output = false;
+
 	/**
 	 * A list of channel names this client is subscribed to.
 	 */
@@ -156,6 +172,12 @@ public:
 	void IdleAdd(unsigned flags) noexcept;
 	bool IdleWait(unsigned flags) noexcept;
 
+	/**
+	 * Leave "idle" mode without sending a response, e.g. because
+	 * the client has sent "noidle".
+	 */
+	void CancelIdleWait() noexcept;
+
 	enum class SubscribeResult {
 		/** success */
 		OK,
@@ -18,8 +18,11 @@
  */
 
 #include "ClientInternal.hxx"
+#include "ClientList.hxx"
 #include "Response.hxx"
 #include "Idle.hxx"
+#include "Partition.hxx"
+#include "Instance.hxx"
 
 #include <assert.h>
 
@@ -39,11 +42,16 @@ void
 Client::IdleNotify() noexcept
 {
 	assert(idle_waiting);
-	assert(idle_flags != 0);
 
-	unsigned flags = std::exchange(idle_flags, 0) & idle_subscriptions;
 	idle_waiting = false;
 
+	auto &client_list = *partition->instance.client_list;
+	client_list.RemoveIdleWaiter(*this);
+
+	const unsigned flags = (std::exchange(idle_flags, 0) |
+				client_list.TakeIdleEvents(*this)) &
+		idle_subscriptions;
+
 	Response r(*this, 0);
 	WriteIdleResponse(r, flags);
 
@@ -69,12 +77,26 @@ Client::IdleWait(unsigned flags) noexcept
 	idle_waiting = true;
 	idle_subscriptions = flags;
 
-	if (idle_flags & idle_subscriptions) {
+	auto &client_list = *partition->instance.client_list;
+
+	if ((idle_flags | client_list.GetIdleEvents(*this)) &
+	    idle_subscriptions) {
 		IdleNotify();
 		return true;
 	} else {
 		/* disable timeouts while in "idle" */
 		timeout_event.Cancel();
+
+		client_list.AddIdleWaiter(*this);
 		return false;
 	}
 }
+
+void
+Client::CancelIdleWait() noexcept
+{
+	assert(idle_waiting);
+
+	idle_waiting = false;
+	partition->instance.client_list->RemoveIdleWaiter(*this);
+}
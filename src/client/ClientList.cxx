@@ -19,21 +19,51 @@
 
 #include "ClientList.hxx"
 #include "ClientInternal.hxx"
+#include "Idle.hxx"
 #include "util/DeleteDisposer.hxx"
 
+#include <algorithm>
+
 #include <assert.h>
 
+void
+ClientList::Add(Client &client)
+{
+	/* events which happened before this client connected are not
+	   for it: start with a current snapshot */
+	std::copy_n(idle_counters, IDLE_NR_FLAGS, client.idle_seen);
+
+	list.push_front(client);
+}
+
 void
 ClientList::Remove(Client &client)
 {
 	assert(!list.empty());
 
+	channel_registry.RemoveClient(client);
+
+	if (client.idle_waiting)
+		RemoveIdleWaiter(client);
+
+	auto i = std::find(message_notify.begin(), message_notify.end(),
+			   &client);
+	if (i != message_notify.end())
+		message_notify.erase(i);
+
 	list.erase(list.iterator_to(client));
 }
 
 void
 ClientList::CloseAll()
 {
+	channel_registry.Clear();
+	message_notify.clear();
+	deferred_message_notify.Cancel();
+
+	for (auto &waiters : idle_waiters)
+		waiters.clear();
+
 	list.clear_and_dispose(DeleteDisposer());
 }
 
@@ -42,6 +72,83 @@ ClientList::IdleAdd(unsigned flags)
 {
 	assert(flags != 0);
 
-	for (auto &client : list)
-		client.IdleAdd(flags);
+	for (unsigned i = 0; i < IDLE_NR_FLAGS; ++i) {
+		if (!(flags & (1u << i)))
+			continue;
+
+		++idle_counters[i];
+
+		if (idle_waiters[i].empty())
+			continue;
+
+		/* move the vector away, because IdleNotify()
+		   unregisters the client from all waiter lists */
+		const auto waiters = std::move(idle_waiters[i]);
+		idle_waiters[i].clear();
+
+		for (auto *client : waiters)
+			/* skip clients already notified via another
+			   flag in this pass */
+			if (client->idle_waiting)
+				client->IdleNotify();
+	}
+}
+
+void
+ClientList::AddIdleWaiter(Client &client) noexcept
+{
+	assert(client.idle_waiting);
+
+	for (unsigned i = 0; i < IDLE_NR_FLAGS; ++i)
+		if (client.idle_subscriptions & (1u << i))
+			idle_waiters[i].push_back(&client);
+}
+
+void
+ClientList::RemoveIdleWaiter(Client &client) noexcept
+{
+	for (unsigned i = 0; i < IDLE_NR_FLAGS; ++i) {
+		if (!(client.idle_subscriptions & (1u << i)))
+			continue;
+
+		auto &waiters = idle_waiters[i];
+		auto j = std::find(waiters.begin(), waiters.end(), &client);
+		if (j != waiters.end())
+			waiters.erase(j);
+	}
+}
+
+unsigned
+ClientList::GetIdleEvents(const Client &client) const noexcept
+{
+	unsigned flags = 0;
+	for (unsigned i = 0; i < IDLE_NR_FLAGS; ++i)
+		if (idle_counters[i] != client.idle_seen[i])
+			flags |= 1u << i;
+
+	return flags;
+}
+
+unsigned
+ClientList::TakeIdleEvents(Client &client) noexcept
+{
+	const unsigned flags = GetIdleEvents(client);
+	std::copy_n(idle_counters, IDLE_NR_FLAGS, client.idle_seen);
+	return flags;
+}
+
+void
+ClientList::ScheduleMessageNotify(Client &client) noexcept
+{
+	message_notify.push_back(&client);
+	deferred_message_notify.Schedule();
+}
+
+void
+ClientList::OnDeferredMessageNotify() noexcept
+{
+	for (auto *client : message_notify)
+		client->IdleAdd(IDLE_MESSAGE);
+
+	message_notify.clear();
 }
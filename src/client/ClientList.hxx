@@ -21,24 +21,77 @@
 #define MPD_CLIENT_LIST_HXX
 
 #include "Client.hxx"
+#include "ChannelRegistry.hxx"
+#include "event/DeferEvent.hxx"
+#include "util/PeakBufferPool.hxx"
 
 #include <boost/intrusive/list.hpp>
 
+#include <vector>
+
 class ClientList {
 	typedef boost::intrusive::list<Client,
 				       boost::intrusive::constant_time_size<true>> List;
 
 	const unsigned max_size;
 
+	/**
+	 * Recycles output buffers across clients; bursty responses
+	 * (e.g. big playlists) reuse warmed buffers instead of
+	 * hitting the allocator each time.  Must be declared before
+	 * #list so it outlives all clients.
+	 */
+	PeakBufferPool output_buffer_pool;
+
 	List list;
 
+	/**
+	 * Maps channel names to subscribed clients, so message
+	 * delivery only touches subscribers.
+	 */
+	ChannelRegistry channel_registry;
+
+	/**
+	 * Clients which have received a client-to-client message
+	 * since the last event loop iteration; their IDLE_MESSAGE
+	 * wakeups are batched in OnDeferredMessageNotify().
+	 */
+	std::vector<Client *> message_notify;
+
+	/**
+	 * Monotonic per-flag event counters.  Each client keeps a
+	 * snapshot (Client::idle_seen); comparing the two yields the
+	 * events the client has not seen yet.  This makes raising an
+	 * event O(1) instead of a walk over all clients.
+	 */
+	uint64_t idle_counters[IDLE_NR_FLAGS] = {};
+
+	/**
+	 * For each idle flag, the clients currently waiting in
+	 * "idle" with that flag subscribed; an event wakes only
+	 * these.
+	 */
+	std::vector<Client *> idle_waiters[IDLE_NR_FLAGS];
+
+	DeferEvent deferred_message_notify;
+
 public:
-	ClientList(unsigned _max_size)
-		:max_size(_max_size) {}
+	ClientList(EventLoop &loop, unsigned _max_size)
+		:max_size(_max_size),
+		 deferred_message_notify(loop,
+					 BIND_THIS_METHOD(OnDeferredMessageNotify)) {}
 	~ClientList() {
 		CloseAll();
 	}
 
+	PeakBufferPool &GetOutputBufferPool() noexcept {
+		return output_buffer_pool;
+	}
+
+	ChannelRegistry &GetChannelRegistry() noexcept {
+		return channel_registry;
+	}
+
 	List::iterator begin() {
 		return list.begin();
 	}
@@ -51,15 +104,47 @@ public:
 		return list.size() >= max_size;
 	}
 
-	void Add(Client &client) {
-		list.push_front(client);
-	}
+	void Add(Client &client);
 
 	void Remove(Client &client);
 
 	void CloseAll();
 
 	void IdleAdd(unsigned flags);
+
+	/**
+	 * Register the given client in the waiter lists of all idle
+	 * flags it has subscribed to.  The client must be in "idle"
+	 * mode.
+	 */
+	void AddIdleWaiter(Client &client) noexcept;
+
+	/**
+	 * Undo AddIdleWaiter().
+	 */
+	void RemoveIdleWaiter(Client &client) noexcept;
+
+	/**
+	 * Which global events has this client not seen yet?
+	 */
+	gcc_pure
+	unsigned GetIdleEvents(const Client &client) const noexcept;
+
+	/**
+	 * Like GetIdleEvents(), but also advance the client's
+	 * snapshot, marking all events as seen.
+	 */
+	unsigned TakeIdleEvents(Client &client) noexcept;
+
+	/**
+	 * Schedule an IDLE_MESSAGE wakeup for the given client; the
+	 * wakeups of all recipients are flushed together at the end
+	 * of the current event loop iteration.
+	 */
+	void ScheduleMessageNotify(Client &client) noexcept;
+
+private:
+	void OnDeferredMessageNotify() noexcept;
 };
 
 #endif
@@ -42,7 +42,8 @@ Client::Client(EventLoop &_loop, Partition &_partition,
 	       int _uid, unsigned _permission,
 	       int _num) noexcept
 	:FullyBufferedSocket(_fd.Release(), _loop,
-			     16384, client_max_output_buffer_size),
+			     16384, client_max_output_buffer_size,
+			     &_partition.instance.client_list->GetOutputBufferPool()),
 	 timeout_event(_loop, BIND_THIS_METHOD(OnTimeout)),
 	 partition(&_partition),
 	 permission(_permission),
@@ -68,6 +69,14 @@ client_new(EventLoop &loop, Partition &partition,
 		return;
 	}
 
+#ifdef __linux__
+	/* disable Nagle's algorithm: responses to single-line
+	   commands (e.g. "status" polls) are small and must not wait
+	   for a delayed ACK; this fails harmlessly on local
+	   sockets */
+	fd.SetNoDelay();
+#endif
+
 	(void)fd.Write(GREETING, sizeof(GREETING) - 1);
 
 	Client *client = new Client(loop, partition, std::move(fd), uid,
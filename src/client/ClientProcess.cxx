@@ -20,6 +20,7 @@
 #include "ClientInternal.hxx"
 #include "protocol/Result.hxx"
 #include "command/AllCommands.hxx"
+#include "BulkEdit.hxx"
 #include "Log.hxx"
 #include "util/StringAPI.hxx"
 #include "util/CharUtil.hxx"
@@ -35,6 +36,12 @@ client_process_command_list(Client &client, bool list_ok,
 	CommandResult ret = CommandResult::OK;
 	unsigned num = 0;
 
+	/* coalesce queue version bumps and queued-song updates over
+	   the whole list; this makes a list of 10000 "addid" commands
+	   bump the queue version once instead of 10000 times (idle
+	   events are already deferred and merged by #MaskMonitor) */
+	const ScopeBulkEdit bulk_edit(client.GetPartition());
+
 	for (auto &&i : list) {
 		char *cmd = &*i.begin();
 
@@ -58,7 +65,7 @@ client_process_line(Client &client, char *line)
 	if (StringIsEqual(line, "noidle")) {
 		if (client.idle_waiting) {
 			/* send empty idle response and leave idle mode */
-			client.idle_waiting = false;
+			client.CancelIdleWait();
 			command_success(client);
 		}
 
@@ -43,11 +43,24 @@ Client::OnSocketInput(void *data, size_t length) noexcept
 	/* terminate the string at the end of the line */
 	*end = 0;
 
+#ifdef __linux__
+	/* with TCP_NODELAY enabled, each write would leave the
+	   socket as a (possibly runt) packet of its own; hold
+	   TCP_CORK across the response's writes and release it at
+	   command completion, so the response leaves in full packets
+	   and the final partial packet is flushed immediately */
+	const bool corked = GetSocket().SetCork(true);
+#endif
+
 	CommandResult result = client_process_line(*this, p);
 	switch (result) {
 	case CommandResult::OK:
 	case CommandResult::IDLE:
 	case CommandResult::ERROR:
+#ifdef __linux__
+		if (corked)
+			GetSocket().SetCork(false);
+#endif
 		break;
 
 	case CommandResult::KILL:
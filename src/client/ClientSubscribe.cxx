@@ -18,7 +18,9 @@
  */
 
 #include "ClientInternal.hxx"
+#include "ClientList.hxx"
 #include "Partition.hxx"
+#include "Instance.hxx"
 #include "Idle.hxx"
 
 #include <assert.h>
@@ -40,6 +42,9 @@ Client::Subscribe(const char *channel) noexcept
 
 	++num_subscriptions;
 
+	partition->instance.client_list->GetChannelRegistry()
+		.Add(channel, *this);
+
 	partition->EmitIdle(IDLE_SUBSCRIPTION);
 
 	return Client::SubscribeResult::OK;
@@ -57,6 +62,9 @@ Client::Unsubscribe(const char *channel) noexcept
 	subscriptions.erase(i);
 	--num_subscriptions;
 
+	partition->instance.client_list->GetChannelRegistry()
+		.Remove(channel, *this);
+
 	partition->EmitIdle(IDLE_SUBSCRIPTION);
 
 	assert((num_subscriptions == 0) ==
@@ -68,6 +76,9 @@ Client::Unsubscribe(const char *channel) noexcept
 void
 Client::UnsubscribeAll() noexcept
 {
+	partition->instance.client_list->GetChannelRegistry()
+		.RemoveClient(*this);
+
 	subscriptions.clear();
 	num_subscriptions = 0;
 }
@@ -80,7 +91,10 @@ Client::PushMessage(const ClientMessage &msg) noexcept
 		return false;
 
 	if (messages.empty())
-		IdleAdd(IDLE_MESSAGE);
+		/* defer the IDLE_MESSAGE wakeup so a burst of
+		   messages wakes up each recipient only once per
+		   event loop iteration */
+		partition->instance.client_list->ScheduleMessageNotify(*this);
 
 	messages.push_back(msg);
 	return true;
@@ -22,12 +22,20 @@
 #include "util/FormatString.hxx"
 #include "util/AllocatedString.hxx"
 
+#include <string.h>
+
 TagMask
 Response::GetTagMask() const noexcept
 {
 	return GetClient().tag_mask;
 }
 
+bool
+Response::IsBinarySongOutput() const noexcept
+{
+	return GetClient().binary_song_output;
+}
+
 bool
 Response::Write(const void *data, size_t length)
 {
@@ -40,6 +48,96 @@ Response::Write(const char *data)
 	return client.Write(data);
 }
 
+/**
+ * Format an unsigned integer backwards, ending at the given position;
+ * returns a pointer to the first digit.
+ */
+static char *
+FormatUnsignedR(char *end, uint64_t value) noexcept
+{
+	char *p = end;
+
+	do {
+		*--p = '0' + unsigned(value % 10);
+		value /= 10;
+	} while (value != 0);
+
+	return p;
+}
+
+inline bool
+Response::WritePairRaw(const char *key,
+		       const char *value, size_t value_length)
+{
+	const size_t key_length = strlen(key);
+
+	char buffer[256];
+	if (key_length + value_length + 3 <= sizeof(buffer)) {
+		char *p = buffer;
+		memcpy(p, key, key_length);
+		p += key_length;
+		*p++ = ':';
+		*p++ = ' ';
+		memcpy(p, value, value_length);
+		p += value_length;
+		*p++ = '\n';
+		return Write(buffer, p - buffer);
+	}
+
+	/* the line does not fit into the stack buffer: write it in
+	   pieces */
+	return Write(key, key_length) && Write(": ", 2) &&
+		Write(value, value_length) && Write("\n", 1);
+}
+
+bool
+Response::WritePair(const char *key, const char *value)
+{
+	return WritePairRaw(key, value, strlen(value));
+}
+
+bool
+Response::WritePair(const char *key, unsigned value)
+{
+	char digits[32];
+	char *const end = digits + sizeof(digits);
+	char *p = FormatUnsignedR(end, value);
+
+	return WritePairRaw(key, p, end - p);
+}
+
+bool
+Response::WritePair(const char *key, int value)
+{
+	const uint64_t u = value >= 0
+		? uint64_t(value)
+		: uint64_t(-int64_t(value));
+
+	char digits[32];
+	char *const end = digits + sizeof(digits);
+	char *p = FormatUnsignedR(end, u);
+	if (value < 0)
+		*--p = '-';
+
+	return WritePairRaw(key, p, end - p);
+}
+
+bool
+Response::WritePairMilli(const char *key, uint64_t ms)
+{
+	char digits[48];
+	char *const end = digits + sizeof(digits);
+
+	char *p = end;
+	*--p = '0' + unsigned(ms % 10); ms /= 10;
+	*--p = '0' + unsigned(ms % 10); ms /= 10;
+	*--p = '0' + unsigned(ms % 10); ms /= 10;
+	*--p = '.';
+	p = FormatUnsignedR(p, ms);
+
+	return WritePairRaw(key, p, end - p);
+}
+
 bool
 Response::FormatV(const char *fmt, va_list args)
 {
@@ -25,6 +25,7 @@
 
 #include <stddef.h>
 #include <stdarg.h>
+#include <stdint.h>
 
 class Client;
 class TagMask;
@@ -67,6 +68,13 @@ public:
 	gcc_pure
 	TagMask GetTagMask() const noexcept;
 
+	/**
+	 * Accessor for Client::binary_song_output.  Can be used if
+	 * caller wants to avoid including Client.hxx.
+	 */
+	gcc_pure
+	bool IsBinarySongOutput() const noexcept;
+
 	void SetCommand(const char *_command) {
 		command = _command;
 	}
@@ -76,8 +84,28 @@ public:
 	bool FormatV(const char *fmt, va_list args);
 	bool Format(const char *fmt, ...);
 
+	/**
+	 * Write a "KEY: VALUE" line.  Unlike Format(), there is no
+	 * format string to be parsed at run time: the overload
+	 * resolution happens at compile time, and integers are
+	 * serialized directly into a stack buffer.  Preferred in hot
+	 * printing paths (song/tag/queue dumps).
+	 */
+	bool WritePair(const char *key, const char *value);
+	bool WritePair(const char *key, int value);
+	bool WritePair(const char *key, unsigned value);
+
+	/**
+	 * Write "KEY: S.mmm" for a duration given in milliseconds.
+	 */
+	bool WritePairMilli(const char *key, uint64_t ms);
+
 	void Error(enum ack code, const char *msg);
 	void FormatError(enum ack code, const char *fmt, ...);
+
+private:
+	bool WritePairRaw(const char *key,
+			  const char *value, size_t value_length);
 };
 
 #endif
@@ -48,6 +48,10 @@
 #include "sticker/StickerDatabase.hxx"
 #endif
 
+#ifdef ENABLE_CHROMAPRINT
+#include "FingerprintCommands.hxx"
+#endif
+
 #include <assert.h>
 #include <string.h>
 
@@ -85,12 +89,16 @@ static constexpr struct command commands[] = {
 	{ "addid", PERMISSION_ADD, 1, 2, handle_addid },
 	{ "addtagid", PERMISSION_ADD, 3, 3, handle_addtagid },
 	{ "albumart", PERMISSION_READ, 2, 2, handle_album_art },
+	{ "binarymode", PERMISSION_READ, 1, 1, handle_binarymode },
 	{ "channels", PERMISSION_READ, 0, 0, handle_channels },
 	{ "clear", PERMISSION_CONTROL, 0, 0, handle_clear },
 	{ "clearerror", PERMISSION_CONTROL, 0, 0, handle_clearerror },
 	{ "cleartagid", PERMISSION_ADD, 1, 2, handle_cleartagid },
 	{ "close", PERMISSION_NONE, -1, -1, handle_close },
 	{ "commands", PERMISSION_NONE, 0, 0, handle_commands },
+#ifdef ENABLE_DATABASE
+	{ "compact", PERMISSION_ADMIN, 0, 0, handle_compact },
+#endif
 	{ "config", PERMISSION_ADMIN, 0, 0, handle_config },
 	{ "consume", PERMISSION_CONTROL, 1, 1, handle_consume },
 #ifdef ENABLE_DATABASE
@@ -106,6 +114,9 @@ static constexpr struct command commands[] = {
 #ifdef ENABLE_DATABASE
 	{ "find", PERMISSION_READ, 1, -1, handle_find },
 	{ "findadd", PERMISSION_ADD, 1, -1, handle_findadd},
+#endif
+#ifdef ENABLE_CHROMAPRINT
+	{ "getfingerprint", PERMISSION_READ, 1, 1, handle_getfingerprint },
 #endif
 	{ "idle", PERMISSION_READ, 0, -1, handle_idle },
 	{ "kill", PERMISSION_ADMIN, -1, -1, handle_kill },
@@ -184,7 +195,7 @@ static constexpr struct command commands[] = {
 	{ "setvol", PERMISSION_CONTROL, 1, 1, handle_setvol },
 	{ "shuffle", PERMISSION_CONTROL, 0, 1, handle_shuffle },
 	{ "single", PERMISSION_CONTROL, 1, 1, handle_single },
-	{ "stats", PERMISSION_READ, 0, 0, handle_stats },
+	{ "stats", PERMISSION_READ, 0, 1, handle_stats },
 	{ "status", PERMISSION_READ, 0, 0, handle_status },
 #ifdef ENABLE_SQLITE
 	{ "sticker", PERMISSION_ADMIN, 3, -1, handle_sticker },
@@ -279,29 +290,75 @@ void
 command_init()
 {
 #ifndef NDEBUG
-	/* ensure that the command list is sorted */
-	for (unsigned i = 0; i < num_commands - 1; ++i)
-		assert(strcmp(commands[i].cmd, commands[i + 1].cmd) < 0);
+	/* ensure that the command list is sorted, and that all
+	   command names begin with a lower case letter (which the
+	   dispatch table relies on) */
+	for (unsigned i = 0; i < num_commands; ++i) {
+		assert(commands[i].cmd[0] >= 'a' &&
+		       commands[i].cmd[0] <= 'z');
+
+		if (i > 0)
+			assert(strcmp(commands[i - 1].cmd,
+				      commands[i].cmd) < 0);
+	}
 #endif
 }
 
+/**
+ * For each possible first command character ('a'..'z'), the index of
+ * the first #commands element starting with it; one extra element
+ * terminates the last range.  Restricts the binary search in
+ * command_lookup() to commands sharing the first character.
+ */
+struct CommandDispatchTable {
+	unsigned char begin['z' - 'a' + 2];
+};
+
+static constexpr CommandDispatchTable
+BuildCommandDispatchTable() noexcept
+{
+	static_assert(num_commands < 256, "Dispatch index overflows");
+
+	CommandDispatchTable t{};
+	unsigned i = 0;
+	for (unsigned c = 0; c <= 'z' - 'a'; ++c) {
+		t.begin[c] = (unsigned char)i;
+		while (i < num_commands &&
+		       commands[i].cmd[0] == char('a' + c))
+			++i;
+	}
+
+	t.begin['z' - 'a' + 1] = (unsigned char)num_commands;
+	return t;
+}
+
+static constexpr CommandDispatchTable command_dispatch =
+	BuildCommandDispatchTable();
+
 static const struct command *
 command_lookup(const char *name)
 {
-	unsigned a = 0, b = num_commands, i;
+	const char first = *name;
+	if (first < 'a' || first > 'z')
+		return nullptr;
 
-	/* binary search */
-	do {
-		i = (a + b) / 2;
+	/* binary search among the commands sharing the first
+	   character; the first character itself was already matched
+	   by the dispatch table and can be skipped */
+	unsigned a = command_dispatch.begin[first - 'a'];
+	unsigned b = command_dispatch.begin[first - 'a' + 1];
 
-		const auto cmp = strcmp(name, commands[i].cmd);
+	while (a < b) {
+		const unsigned i = (a + b) / 2;
+
+		const auto cmp = strcmp(name + 1, commands[i].cmd + 1);
 		if (cmp == 0)
 			return &commands[i];
 		else if (cmp < 0)
 			b = i;
-		else if (cmp > 0)
+		else
 			a = i + 1;
-	} while (a < b);
+	}
 
 	return nullptr;
 }
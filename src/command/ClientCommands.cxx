@@ -40,6 +40,13 @@ handle_ping(gcc_unused Client &client, gcc_unused Request args,
 	return CommandResult::OK;
 }
 
+CommandResult
+handle_binarymode(Client &client, Request args, gcc_unused Response &r)
+{
+	client.binary_song_output = args.ParseBool(0);
+	return CommandResult::OK;
+}
+
 CommandResult
 handle_password(Client &client, Request args, Response &r)
 {
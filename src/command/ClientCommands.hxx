@@ -26,6 +26,9 @@ class Client;
 class Request;
 class Response;
 
+CommandResult
+handle_binarymode(Client &client, Request request, Response &response);
+
 CommandResult
 handle_close(Client &client, Request request, Response &response);
 
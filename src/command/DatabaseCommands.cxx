@@ -24,6 +24,9 @@
 #include "db/DatabasePrint.hxx"
 #include "db/Count.hxx"
 #include "db/Selection.hxx"
+#include "db/plugins/simple/SimpleDatabasePlugin.hxx"
+#include "db/update/Service.hxx"
+#include "Instance.hxx"
 #include "CommandError.hxx"
 #include "protocol/RangeArg.hxx"
 #include "client/Client.hxx"
@@ -328,3 +331,27 @@ handle_listallinfo(Client &client, Request args, Response &r)
 			   true, false);
 	return CommandResult::OK;
 }
+
+CommandResult
+handle_compact(Client &client, gcc_unused Request args, Response &r)
+{
+	auto &instance = client.GetInstance();
+
+	auto *db = dynamic_cast<SimpleDatabase *>(instance.GetDatabase());
+	if (db == nullptr) {
+		r.Error(ACK_ERROR_NO_EXIST, "No simple database");
+		return CommandResult::ERROR;
+	}
+
+	if (instance.update != nullptr && instance.update->GetId() != 0) {
+		/* the update thread keeps pointers into the tree
+		   while the database is unlocked; the tree must not
+		   be swapped under it */
+		r.Error(ACK_ERROR_UPDATE_ALREADY,
+			"Database update in progress");
+		return CommandResult::ERROR;
+	}
+
+	db->Compact();
+	return CommandResult::OK;
+}
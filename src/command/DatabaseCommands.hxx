@@ -59,4 +59,7 @@ handle_list(Client &client, Request request, Response &response);
 CommandResult
 handle_listallinfo(Client &client, Request request, Response &response);
 
+CommandResult
+handle_compact(Client &client, Request request, Response &response);
+
 #endif
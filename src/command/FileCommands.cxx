@@ -40,6 +40,8 @@
 #include "input/Error.hxx"
 #include "LocateUri.hxx"
 #include "TimePrint.hxx"
+#include "AlbumArtCache.hxx"
+#include "Instance.hxx"
 #include "thread/Mutex.hxx"
 #include "Log.hxx"
 
@@ -267,11 +269,69 @@ find_stream_art(const char *directory, Mutex &mutex)
 	return nullptr;
 }
 
+/**
+ * Determine the modification time of the given art file for cache
+ * revalidation; returns time_point::min() if it cannot be obtained
+ * cheaply (e.g. a remote stream).
+ */
+gcc_pure
+static std::chrono::system_clock::time_point
+art_file_mtime(const char *uri) noexcept
+{
+	if (uri_has_scheme(uri))
+		return std::chrono::system_clock::time_point::min();
+
+	try {
+		const FileInfo fi(AllocatedPath::FromUTF8Throw(uri));
+		return fi.GetModificationTime();
+	} catch (...) {
+		return std::chrono::system_clock::time_point::min();
+	}
+}
+
+/**
+ * Send one "albumart" window from the given buffer.
+ */
 static CommandResult
-read_stream_art(Response &r, const char *uri, size_t offset)
+write_art_window(Response &r, const std::string &data, size_t offset)
+{
+	constexpr size_t CHUNK_SIZE = 8192;
+
+	const size_t read_size = offset < data.size()
+		? std::min(CHUNK_SIZE, data.size() - offset)
+		: 0;
+
+	r.Format("size: %" PRIoffset "\n"
+			 "binary: %u\n",
+			 (offset_type)data.size(),
+			 unsigned(read_size)
+			 );
+
+	r.Write(data.data() + offset, read_size);
+	r.Write("\n");
+
+	return CommandResult::OK;
+}
+
+static CommandResult
+read_stream_art(Client &client, Response &r, const char *uri, size_t offset)
 {
 	std::string art_directory = PathTraitsUTF8::GetParent(uri);
 
+	auto &cache = client.GetInstance().GetAlbumArtCache();
+
+	const auto *item = cache.Get(art_directory.c_str());
+	if (item != nullptr &&
+	    item->mtime != std::chrono::system_clock::time_point::min() &&
+	    art_file_mtime(item->uri.c_str()) != item->mtime) {
+		/* the art file has been modified meanwhile */
+		cache.Remove(art_directory.c_str());
+		item = nullptr;
+	}
+
+	if (item != nullptr)
+		return write_art_window(r, item->data, offset);
+
 	Mutex mutex;
 
 	InputStreamPtr is = find_stream_art(art_directory.c_str(), mutex);
@@ -285,28 +345,37 @@ read_stream_art(Response &r, const char *uri, size_t offset)
 		return CommandResult::ERROR;
 	}
 
-	const offset_type art_file_size = is->GetSize();
+	/* read the whole file once; all further windows of this
+	   transfer (and of other clients) are served from the
+	   cache */
 
-	constexpr size_t CHUNK_SIZE = 8192;
-	uint8_t buffer[CHUNK_SIZE];
-	size_t read_size;
+	AlbumArtCache::Item new_item;
+	new_item.uri = is->GetURI();
+	new_item.mtime = art_file_mtime(new_item.uri.c_str());
+	new_item.data.resize(is->GetSize());
 
 	{
 		const std::lock_guard<Mutex> protect(mutex);
-		is->Seek(offset);
-		read_size = is->Read(&buffer, CHUNK_SIZE);
+
+		size_t nbytes = 0;
+		while (nbytes < new_item.data.size()) {
+			size_t n = is->Read(&new_item.data[nbytes],
+					    new_item.data.size() - nbytes);
+			if (n == 0)
+				break;
+
+			nbytes += n;
+		}
+
+		new_item.data.resize(nbytes);
 	}
 
-	r.Format("size: %" PRIoffset "\n"
-			 "binary: %u\n",
-			 art_file_size,
-			 read_size
-			 );
+	const auto result = write_art_window(r, new_item.data, offset);
 
-	r.Write(buffer, read_size);
-	r.Write("\n");
+	new_item.directory = std::move(art_directory);
+	cache.Put(std::move(new_item));
 
-	return CommandResult::OK;
+	return result;
 }
 
 #ifdef ENABLE_DATABASE
@@ -319,7 +388,7 @@ read_db_art(Client &client, Response &r, const char *uri, const uint64_t offset)
 		return CommandResult::ERROR;
 	}
 	std::string uri2 = storage->MapUTF8(uri);
-	return read_stream_art(r, uri2.c_str(), offset);
+	return read_stream_art(client, r, uri2.c_str(), offset);
 }
 #endif
 
@@ -340,7 +409,7 @@ handle_album_art(Client &client, Request args, Response &r)
 	switch (located_uri.type) {
 	case LocatedUri::Type::ABSOLUTE:
 	case LocatedUri::Type::PATH:
-		return read_stream_art(r, located_uri.canonical_uri, offset);
+		return read_stream_art(client, r, located_uri.canonical_uri, offset);
 	case LocatedUri::Type::RELATIVE:
 #ifdef ENABLE_DATABASE
 		return read_db_art(client, r, located_uri.canonical_uri, offset);
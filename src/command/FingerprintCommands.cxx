@@ -0,0 +1,215 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+#include "FingerprintCommands.hxx"
+#include "Request.hxx"
+#include "Fingerprint.hxx"
+#include "LocateUri.hxx"
+#include "client/Client.hxx"
+#include "client/Response.hxx"
+#include "fs/FileInfo.hxx"
+#include "util/UriUtil.hxx"
+
+#ifdef ENABLE_DATABASE
+#include "storage/StorageInterface.hxx"
+#include "fs/AllocatedPath.hxx"
+#endif
+
+#ifdef ENABLE_SQLITE
+#include "sticker/StickerDatabase.hxx"
+#endif
+
+#include <chrono>
+
+#include <assert.h>
+#include <stdlib.h>
+
+#ifdef ENABLE_SQLITE
+
+static constexpr char FINGERPRINT_STICKER_TYPE[] = "fingerprint";
+static constexpr char FINGERPRINT_STICKER_NAME[] = "chromaprint";
+
+/**
+ * Look up a cached fingerprint in the sticker database.  The sticker
+ * value has the form "MTIME:FINGERPRINT"; a cached entry whose mtime
+ * does not match the file's current mtime is considered stale.
+ *
+ * Returns an empty string on cache miss (or any sticker error, which
+ * is not fatal here).
+ */
+static std::string
+LoadCachedFingerprint(const char *uri, time_t mtime) noexcept
+try {
+	if (!sticker_enabled())
+		return {};
+
+	const auto value = sticker_load_value(FINGERPRINT_STICKER_TYPE,
+					      uri, FINGERPRINT_STICKER_NAME);
+	if (value.empty())
+		return {};
+
+	char *endptr;
+	const auto cached_mtime = strtoull(value.c_str(), &endptr, 10);
+	if (*endptr != ':' || (time_t)cached_mtime != mtime)
+		/* malformed or stale */
+		return {};
+
+	return endptr + 1;
+} catch (...) {
+	return {};
+}
+
+static void
+StoreCachedFingerprint(const char *uri, time_t mtime,
+		       const char *fingerprint) noexcept
+try {
+	if (!sticker_enabled())
+		return;
+
+	std::string value = std::to_string(mtime);
+	value.push_back(':');
+	value += fingerprint;
+
+	sticker_store_value(FINGERPRINT_STICKER_TYPE,
+			    uri, FINGERPRINT_STICKER_NAME,
+			    value.c_str());
+} catch (...) {
+}
+
+#endif
+
+/**
+ * Determine the modification time of the given local file for cache
+ * revalidation; returns 0 if it cannot be obtained.
+ */
+gcc_pure
+static time_t
+fingerprint_file_mtime(Path path_fs) noexcept
+{
+	try {
+		const FileInfo fi(path_fs);
+		return std::chrono::system_clock::to_time_t(fi.GetModificationTime());
+	} catch (...) {
+		return 0;
+	}
+}
+
+/**
+ * @param cache_uri the key for the sticker cache (the URI as the
+ * client sees it)
+ */
+static CommandResult
+fingerprint_file(Response &r, const char *cache_uri, Path path_fs)
+{
+	const time_t mtime = fingerprint_file_mtime(path_fs);
+
+#ifdef ENABLE_SQLITE
+	if (mtime != 0) {
+		const auto cached = LoadCachedFingerprint(cache_uri, mtime);
+		if (!cached.empty()) {
+			r.Format("chromaprint: %s\n", cached.c_str());
+			return CommandResult::OK;
+		}
+	}
+#else
+	(void)cache_uri;
+	(void)mtime;
+#endif
+
+	const auto fingerprint = FingerprintFile(path_fs);
+
+#ifdef ENABLE_SQLITE
+	if (mtime != 0)
+		StoreCachedFingerprint(cache_uri, mtime,
+				       fingerprint.c_str());
+#endif
+
+	r.Format("chromaprint: %s\n", fingerprint.c_str());
+	return CommandResult::OK;
+}
+
+static CommandResult
+fingerprint_stream(Response &r, const char *uri)
+{
+	/* no mtime available - don't cache remote streams */
+	const auto fingerprint = FingerprintStream(uri);
+
+	r.Format("chromaprint: %s\n", fingerprint.c_str());
+	return CommandResult::OK;
+}
+
+static CommandResult
+fingerprint_db(Client &client, Response &r, const char *uri)
+{
+#ifdef ENABLE_DATABASE
+	const Storage *storage = client.GetStorage();
+	if (storage == nullptr) {
+#else
+		(void)client;
+		(void)uri;
+#endif
+		r.Error(ACK_ERROR_NO_EXIST, "No database");
+		return CommandResult::ERROR;
+#ifdef ENABLE_DATABASE
+	}
+
+	{
+		AllocatedPath path_fs = storage->MapFS(uri);
+		if (!path_fs.IsNull())
+			return fingerprint_file(r, uri, path_fs);
+	}
+
+	{
+		const std::string uri2 = storage->MapUTF8(uri);
+		if (uri_has_scheme(uri2.c_str()))
+			return fingerprint_stream(r, uri2.c_str());
+	}
+
+	r.Error(ACK_ERROR_NO_EXIST, "No such file");
+	return CommandResult::ERROR;
+#endif
+}
+
+CommandResult
+handle_getfingerprint(Client &client, Request args, Response &r)
+{
+	assert(args.size == 1);
+
+	const char *const uri = args.front();
+
+	const auto located_uri = LocateUri(uri, &client
+#ifdef ENABLE_DATABASE
+					   , nullptr
+#endif
+					   );
+	switch (located_uri.type) {
+	case LocatedUri::Type::ABSOLUTE:
+		return fingerprint_stream(r, located_uri.canonical_uri);
+
+	case LocatedUri::Type::RELATIVE:
+		return fingerprint_db(client, r, located_uri.canonical_uri);
+
+	case LocatedUri::Type::PATH:
+		return fingerprint_file(r, located_uri.canonical_uri,
+					located_uri.path);
+	}
+
+	gcc_unreachable();
+}
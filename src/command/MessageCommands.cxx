@@ -25,9 +25,6 @@
 #include "Instance.hxx"
 #include "util/ConstBuffer.hxx"
 
-#include <set>
-#include <string>
-
 #include <assert.h>
 
 CommandResult
@@ -77,13 +74,10 @@ handle_channels(Client &client, gcc_unused Request args, Response &r)
 {
 	assert(args.empty());
 
-	std::set<std::string> channels;
-	for (const auto &c : *client.GetInstance().client_list)
-		channels.insert(c.subscriptions.begin(),
-				c.subscriptions.end());
-
-	for (const auto &channel : channels)
-		r.Format("channel: %s\n", channel.c_str());
+	const auto &registry =
+		client.GetInstance().client_list->GetChannelRegistry();
+	for (const auto &i : registry.GetMap())
+		r.Format("channel: %s\n", i.first.c_str());
 
 	return CommandResult::OK;
 }
@@ -120,9 +114,13 @@ handle_send_message(Client &client, Request args, Response &r)
 
 	bool sent = false;
 	const ClientMessage msg(channel_name, message_text);
-	for (auto &c : *client.GetInstance().client_list)
-		if (c.PushMessage(msg))
-			sent = true;
+
+	const auto *subscribers = client.GetInstance().client_list
+		->GetChannelRegistry().Find(channel_name);
+	if (subscribers != nullptr)
+		for (auto *c : *subscribers)
+			if (c->PushMessage(msg))
+				sent = true;
 
 	if (sent)
 		return CommandResult::OK;
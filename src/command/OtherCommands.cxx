@@ -40,6 +40,7 @@
 #include "util/StringAPI.hxx"
 #include "fs/AllocatedPath.hxx"
 #include "Stats.hxx"
+#include "Metrics.hxx"
 #include "PlaylistFile.hxx"
 #include "db/PlaylistVector.hxx"
 #include "client/Client.hxx"
@@ -361,8 +362,21 @@ handle_volume(Client &client, Request args, Response &r)
 }
 
 CommandResult
-handle_stats(Client &client, gcc_unused Request args, Response &r)
+handle_stats(Client &client, Request args, Response &r)
 {
+	if (!args.empty()) {
+		if (StringIsEqual(args.front(), "detail"))
+			metrics_print(r);
+		else if (StringIsEqual(args.front(), "memory"))
+			metrics_print_memory(r);
+		else {
+			r.Error(ACK_ERROR_ARG, "Unknown stats group");
+			return CommandResult::ERROR;
+		}
+
+		return CommandResult::OK;
+	}
+
 	stats_print(r, client.GetPartition());
 	return CommandResult::OK;
 }
@@ -101,8 +101,10 @@ handle_newpartition(Client &client, Request request, Response &response)
 					 // TODO: use real configuration
 					 16384,
 					 1024,
+					 25,
 					 AudioFormat::Undefined(),
-					 ReplayGainConfig());
+					 ReplayGainConfig(),
+					 0);
 	auto &partition = instance.partitions.back();
 	partition.outputs.AddNullOutput(instance.io_thread.GetEventLoop(),
 					ReplayGainConfig(),
@@ -55,20 +55,31 @@ handle_sticker_song(Response &r, Partition &partition, Request args)
 
 	const char *const cmd = args.front();
 
-	/* get song song_id key */
-	if (args.size == 4 && StringIsEqual(cmd, "get")) {
+	/* get song song_id key [key...] */
+	if (args.size >= 4 && StringIsEqual(cmd, "get")) {
 		const LightSong *song = db.GetSong(args[2]);
 		assert(song != nullptr);
 		AtScopeExit(&db, song) { db.ReturnSong(song); };
 
-		const auto value = sticker_song_get_value(*song, args[3]);
-		if (value.empty()) {
+		/* several names may be requested at once; values
+		   are printed for those which exist, and the command
+		   fails only if none was found */
+		unsigned n_found = 0;
+		for (size_t i = 3; i < args.size; ++i) {
+			const auto value = sticker_song_get_value(*song,
+								  args[i]);
+			if (value.empty())
+				continue;
+
+			sticker_print_value(r, args[i], value.c_str());
+			++n_found;
+		}
+
+		if (n_found == 0) {
 			r.Error(ACK_ERROR_NO_EXIST, "no such sticker");
 			return CommandResult::ERROR;
 		}
 
-		sticker_print_value(r, args[3], value.c_str());
-
 		return CommandResult::OK;
 	/* list song song_id */
 	} else if (args.size == 3 && StringIsEqual(cmd, "list")) {
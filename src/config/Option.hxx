@@ -76,9 +76,21 @@ enum class ConfigOption {
 	GAPLESS_MP3_PLAYBACK,
 	AUTO_UPDATE,
 	AUTO_UPDATE_DEPTH,
+	UPDATE_THREADS,
 	DESPOTIFY_USER,
 	DESPOTIFY_PASSWORD,
 	DESPOTIFY_HIGH_BITRATE,
+	PLAYER_THREAD_AFFINITY,
+	MIXRAMP_CACHE_FILE,
+	MIXRAMP_ANALYZER,
+	AUDIO_CHUNK_DURATION,
+	INPUT_MMAP,
+	UPDATE_SKIP_UNCHANGED,
+	LOG_ASYNC,
+	REMOTE_TAG_CACHE_SIZE,
+	ALBUM_ART_CACHE_SIZE,
+	IO_THREADS,
+	DECODER_WAKEUP_PERCENT,
 	MAX
 };
 
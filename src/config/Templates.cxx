@@ -71,9 +71,21 @@ const ConfigTemplate config_param_templates[] = {
 	{ "gapless_mp3_playback", false, true },
 	{ "auto_update" },
 	{ "auto_update_depth" },
+	{ "update_threads" },
 	{ "despotify_user", false, true },
 	{ "despotify_password", false, true },
 	{ "despotify_high_bitrate", false, true },
+	{ "player_thread_affinity" },
+	{ "mixramp_cache_file" },
+	{ "mixramp_analyzer" },
+	{ "audio_chunk_duration" },
+	{ "input_mmap" },
+	{ "update_skip_unchanged" },
+	{ "log_async" },
+	{ "remote_tag_cache_size" },
+	{ "album_art_cache_size" },
+	{ "io_threads" },
+	{ "decoder_wakeup_percent" },
 };
 
 static constexpr unsigned n_config_param_templates =
@@ -27,8 +27,10 @@
 #include "tag/VisitFallback.hxx"
 #include "TagPrint.hxx"
 
+#include <algorithm>
 #include <functional>
-#include <map>
+#include <unordered_map>
+#include <vector>
 
 struct SearchStats {
 	unsigned n_songs;
@@ -38,7 +40,12 @@ struct SearchStats {
 		:n_songs(0), total_duration(0) {}
 };
 
-class TagCountMap : public std::map<std::string, SearchStats> {
+/**
+ * Accumulates per-group totals in a hash table: one O(1) probe per
+ * song instead of a tree lookup with full string comparisons.  The
+ * output is sorted in Print(), once, at the end of the visit.
+ */
+class TagCountMap : public std::unordered_map<std::string, SearchStats> {
 };
 
 static void
@@ -57,9 +64,23 @@ Print(Response &r, TagType group, const TagCountMap &m) noexcept
 {
 	assert(unsigned(group) < TAG_NUM_OF_ITEM_TYPES);
 
-	for (const auto &i : m) {
-		tag_print(r, group, i.first.c_str());
-		PrintSearchStats(r, i.second);
+	/* sort the group values to keep the response ordering the
+	   clients are used to; the hash table itself is unordered */
+
+	std::vector<const TagCountMap::value_type *> entries;
+	entries.reserve(m.size());
+	for (const auto &i : m)
+		entries.push_back(&i);
+
+	std::sort(entries.begin(), entries.end(),
+		  [](const TagCountMap::value_type *a,
+		     const TagCountMap::value_type *b){
+			  return a->first < b->first;
+		  });
+
+	for (const auto *i : entries) {
+		tag_print(r, group, i->first.c_str());
+		PrintSearchStats(r, i->second);
 	}
 }
 
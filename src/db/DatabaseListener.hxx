@@ -20,6 +20,9 @@
 #ifndef MPD_DATABASE_CLIENT_HXX
 #define MPD_DATABASE_CLIENT_HXX
 
+#include <string>
+#include <vector>
+
 struct LightSong;
 
 /**
@@ -36,6 +39,19 @@ public:
 	 */
 	virtual void OnDatabaseModified() = 0;
 
+	/**
+	 * The database has been modified, and the given list of song
+	 * URIs is known to cover all added and updated songs.  Unlike
+	 * OnDatabaseModified(), this allows the implementation to
+	 * refresh only the affected songs.  The default
+	 * implementation falls back to OnDatabaseModified().
+	 */
+	virtual void OnDatabaseSongsChanged(std::vector<std::string> &&uris) {
+		(void)uris;
+
+		OnDatabaseModified();
+	}
+
 	/**
 	 * During database update, a song is about to be removed from
 	 * the database because the file has disappeared.
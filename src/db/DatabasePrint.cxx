@@ -18,6 +18,7 @@
  */
 
 #include "DatabasePrint.hxx"
+#include "ListCache.hxx"
 #include "Selection.hxx"
 #include "SongPrint.hxx"
 #include "TimePrint.hxx"
@@ -25,6 +26,7 @@
 #include "client/Response.hxx"
 #include "protocol/RangeArg.hxx"
 #include "Partition.hxx"
+#include "Instance.hxx"
 #include "song/DetachedSong.hxx"
 #include "song/Filter.hxx"
 #include "song/LightSong.hxx"
@@ -37,6 +39,7 @@
 #include "util/ChronoUtil.hxx"
 
 #include <functional>
+#include <vector>
 
 gcc_pure
 static const char *
@@ -150,17 +153,37 @@ db_selection_print(Response &r, Partition &partition,
 {
 	const Database &db = partition.GetDatabaseOrThrow();
 
+	if (selection.filter != nullptr) {
+		/* only songs are printed in this case; snapshot all
+		   matches as cheap copies while the database lock is
+		   held by Visit(), and do the expensive formatting
+		   afterwards, when other clients are no longer
+		   blocked by this visit */
+		std::vector<DetachedSong> songs;
+		VisitSong collect = [&songs](const LightSong &song){
+			songs.emplace_back(song);
+		};
+
+		db.Visit(selection, collect);
+
+		for (const auto &song : songs) {
+			const auto light = static_cast<LightSong>(song);
+			if (full)
+				PrintSongFull(r, base, light);
+			else
+				PrintSongBrief(r, base, light);
+		}
+
+		return;
+	}
+
 	using namespace std::placeholders;
-	const auto d = selection.filter == nullptr
-		? std::bind(full ? PrintDirectoryFull : PrintDirectoryBrief,
-			    std::ref(r), base, _1)
-		: VisitDirectory();
+	const auto d = std::bind(full ? PrintDirectoryFull : PrintDirectoryBrief,
+				 std::ref(r), base, _1);
 	VisitSong s = std::bind(full ? PrintSongFull : PrintSongBrief,
 				std::ref(r), base, _1);
-	const auto p = selection.filter == nullptr
-		? std::bind(full ? PrintPlaylistFull : PrintPlaylistBrief,
-			    std::ref(r), base, _1, _2)
-		: VisitPlaylist();
+	const auto p = std::bind(full ? PrintPlaylistFull : PrintPlaylistBrief,
+				 std::ref(r), base, _1, _2);
 
 	db.Visit(selection, d, s, p);
 }
@@ -222,6 +245,19 @@ PrintUniqueTags(Response &r, Partition &partition,
 
 	const DatabaseSelection selection("", true, filter);
 
-	PrintGroupedUniqueTags(r, type, group,
-			       db.CollectUniqueTags(selection, type, group));
+	/* check the per-instance result cache first; these queries
+	   tend to be repeated by clients polling after "idle" */
+
+	auto &cache = partition.instance.database_list_cache;
+	auto key = DatabaseListCache::MakeKey(type, group, selection);
+
+	if (const auto *cached = cache.Get(key)) {
+		PrintGroupedUniqueTags(r, type, group, *cached);
+		return;
+	}
+
+	const auto groups = db.CollectUniqueTags(selection, type, group);
+	PrintGroupedUniqueTags(r, type, group, groups);
+
+	cache.Put(std::move(key), groups);
 }
@@ -22,7 +22,9 @@
 #include "song/DetachedSong.hxx"
 #include "song/LightSong.hxx"
 #include "storage/StorageInterface.hxx"
+#include "fs/Traits.hxx"
 #include "util/ScopeExit.hxx"
+#include "util/UriUtil.hxx"
 
 #include <assert.h>
 
@@ -32,9 +34,19 @@ DatabaseDetachSong(const Storage *storage, const LightSong &song)
 	DetachedSong detached(song);
 	assert(detached.IsInDatabase());
 
-	if (!detached.HasRealURI() && storage != nullptr) {
-		const auto uri = song.GetURI();
-		detached.SetRealURI(storage->MapUTF8(uri.c_str()));
+	if (storage != nullptr) {
+		if (!detached.HasRealURI()) {
+			const auto uri = song.GetURI();
+			detached.SetRealURI(storage->MapUTF8(uri.c_str()));
+		} else {
+			/* the "target" of a virtual song (e.g. a
+			   CUE sheet track) is relative to the music
+			   directory */
+			const char *real_uri = detached.GetRealURI();
+			if (!uri_has_scheme(real_uri) &&
+			    !PathTraitsUTF8::IsAbsolute(real_uri))
+				detached.SetRealURI(storage->MapUTF8(real_uri));
+		}
 	}
 
 	return detached;
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "ListCache.hxx"
+#include "Selection.hxx"
+#include "song/Filter.hxx"
+
+std::string
+DatabaseListCache::MakeKey(TagType type, TagType group,
+			   const DatabaseSelection &selection) noexcept
+{
+	std::string key;
+	key.push_back((char)type);
+	key.push_back((char)group);
+	key.push_back(selection.recursive);
+	key += selection.uri;
+	key.push_back('\0');
+
+	if (selection.filter != nullptr)
+		key += selection.filter->ToExpression();
+
+	return key;
+}
+
+const std::map<std::string, std::set<std::string>> *
+DatabaseListCache::Get(const std::string &key) noexcept
+{
+	for (auto i = entries.begin(); i != entries.end(); ++i) {
+		if (i->key == key) {
+			/* move to the front of the LRU list */
+			entries.splice(entries.begin(), entries, i);
+			return &entries.front().groups;
+		}
+	}
+
+	return nullptr;
+}
+
+void
+DatabaseListCache::Put(std::string &&key,
+		       const std::map<std::string, std::set<std::string>> &groups) noexcept
+{
+	while (entries.size() >= MAX_ENTRIES)
+		entries.pop_back();
+
+	entries.emplace_front();
+	entries.front().key = std::move(key);
+	entries.front().groups = groups;
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_DB_LIST_CACHE_HXX
+#define MPD_DB_LIST_CACHE_HXX
+
+#include "tag/Type.h"
+
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+
+struct DatabaseSelection;
+
+/**
+ * A small LRU cache for Database::CollectUniqueTags() results, keyed
+ * by the #DatabaseSelection.  Clients which poll the same "list"
+ * query repeatedly (e.g. after each "idle" wakeup) get a cached
+ * answer instead of a full database visit.
+ *
+ * The cache must be flushed whenever the database is modified; see
+ * DatabaseListener::OnDatabaseModified().
+ *
+ * All methods must be called from the main thread.
+ */
+class DatabaseListCache {
+	static constexpr size_t MAX_ENTRIES = 32;
+
+	struct Entry {
+		std::string key;
+		std::map<std::string, std::set<std::string>> groups;
+	};
+
+	/**
+	 * All cached entries; the front is the most recently used
+	 * one.
+	 */
+	std::list<Entry> entries;
+
+public:
+	/**
+	 * Build the cache key for the given query.
+	 */
+	static std::string MakeKey(TagType type, TagType group,
+				   const DatabaseSelection &selection) noexcept;
+
+	/**
+	 * Look up a cached result.  Returns nullptr on cache miss.
+	 * The returned pointer is invalidated by the next non-const
+	 * method call.
+	 */
+	const std::map<std::string, std::set<std::string>> *Get(const std::string &key) noexcept;
+
+	/**
+	 * Store one query result, evicting the least recently used
+	 * entry if the cache is full.
+	 */
+	void Put(std::string &&key,
+		 const std::map<std::string, std::set<std::string>> &groups) noexcept;
+
+	void Flush() noexcept {
+		entries.clear();
+	}
+};
+
+#endif
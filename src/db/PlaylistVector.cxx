@@ -20,8 +20,6 @@
 #include "PlaylistVector.hxx"
 #include "db/DatabaseLock.hxx"
 
-#include <algorithm>
-
 #include <assert.h>
 
 PlaylistVector::iterator
@@ -30,8 +28,8 @@ PlaylistVector::find(const char *name) noexcept
 	assert(holding_db_lock());
 	assert(name != nullptr);
 
-	return std::find_if(begin(), end(),
-			    PlaylistInfo::CompareName(name));
+	auto i = by_name.find(name);
+	return i != by_name.end() ? i->second : end();
 }
 
 bool
@@ -45,8 +43,11 @@ PlaylistVector::UpdateOrInsert(PlaylistInfo &&pi) noexcept
 			return false;
 
 		i->mtime = pi.mtime;
-	} else
+	} else {
 		push_back(std::move(pi));
+		i = std::prev(end());
+		by_name.emplace(i->name, i);
+	}
 
 	return true;
 }
@@ -56,10 +57,20 @@ PlaylistVector::erase(const char *name) noexcept
 {
 	assert(holding_db_lock());
 
-	auto i = find(name);
-	if (i == end())
+	auto i = by_name.find(name);
+	if (i == by_name.end())
 		return false;
 
-	erase(i);
+	std::list<PlaylistInfo>::erase(i->second);
+	by_name.erase(i);
 	return true;
 }
+
+PlaylistVector::iterator
+PlaylistVector::erase(iterator i) noexcept
+{
+	assert(holding_db_lock());
+
+	by_name.erase(i->name);
+	return std::list<PlaylistInfo>::erase(i);
+}
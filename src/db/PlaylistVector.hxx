@@ -24,8 +24,18 @@
 #include "util/Compiler.h"
 
 #include <list>
+#include <string>
+#include <unordered_map>
 
 class PlaylistVector : protected std::list<PlaylistInfo> {
+	/**
+	 * Maps the playlist name to its position in the list,
+	 * replacing the old linear search.  std::list iterators stay
+	 * valid across all other modifications, so this index only
+	 * needs to be touched on insert and erase.
+	 */
+	std::unordered_map<std::string, iterator> by_name;
+
 protected:
 	/**
 	 * Caller must lock the #db_mutex.
@@ -37,8 +47,6 @@ public:
 	using std::list<PlaylistInfo>::empty;
 	using std::list<PlaylistInfo>::begin;
 	using std::list<PlaylistInfo>::end;
-	using std::list<PlaylistInfo>::push_back;
-	using std::list<PlaylistInfo>::erase;
 
 	/**
 	 * Caller must lock the #db_mutex.
@@ -51,6 +59,11 @@ public:
 	 * Caller must lock the #db_mutex.
 	 */
 	bool erase(const char *name) noexcept;
+
+	/**
+	 * Caller must lock the #db_mutex.
+	 */
+	iterator erase(iterator i) noexcept;
 };
 
 #endif /* SONGVEC_H */
@@ -21,6 +21,9 @@
 #include "song/LightSong.hxx"
 #include "song/Filter.hxx"
 
+#include <algorithm>
+#include <numeric>
+
 #include <assert.h>
 #include <stdlib.h>
 #include <string.h>
@@ -95,38 +98,54 @@ DatabaseVisitorHelper::Commit()
 
 	assert(original_visit_song);
 
-	/* sort the song collection */
 	const auto sort = selection.sort;
 	const auto descending = selection.descending;
 
-	if (sort == TagType(SORT_TAG_LAST_MODIFIED))
-		std::stable_sort(songs.begin(), songs.end(),
-				 [descending](const DetachedSong &a, const DetachedSong &b){
-					 return descending
-						 ? a.GetLastModified() > b.GetLastModified()
-						 : a.GetLastModified() < b.GetLastModified();
-				 });
-	else
-		std::stable_sort(songs.begin(), songs.end(),
-				 [sort, descending](const DetachedSong &a,
-						    const DetachedSong &b){
-					 return CompareTags(sort, descending,
-							    a.GetTag(),
-							    b.GetTag());
-				 });
-
-	/* apply the "window" */
-	if (selection.window.end < songs.size())
-		songs.erase(std::next(songs.begin(), selection.window.end),
-			    songs.end());
-
-	if (selection.window.start >= songs.size())
-		return;
+	const auto compare_songs = [sort, descending](const DetachedSong &a,
+						      const DetachedSong &b){
+		if (sort == TagType(SORT_TAG_LAST_MODIFIED))
+			return descending
+				? a.GetLastModified() > b.GetLastModified()
+				: a.GetLastModified() < b.GetLastModified();
+
+		return CompareTags(sort, descending, a.GetTag(), b.GetTag());
+	};
+
+	/* sort indices instead of the songs themselves, with the
+	   original position as tie breaker; this reproduces the
+	   ordering of std::stable_sort while allowing the partial
+	   sort below */
+	std::vector<unsigned> order(songs.size());
+	std::iota(order.begin(), order.end(), 0u);
+
+	const auto compare = [&songs_=songs, &compare_songs](unsigned a,
+							     unsigned b){
+		if (compare_songs(songs_[a], songs_[b]))
+			return true;
+		if (compare_songs(songs_[b], songs_[a]))
+			return false;
+		return a < b;
+	};
+
+	if (selection.window.end < order.size()) {
+		/* a window was given: move its songs to the front
+		   and sort only those, which is O(n + w log w)
+		   instead of O(n log n) for the whole result */
+		std::nth_element(order.begin(),
+				 std::next(order.begin(),
+					   selection.window.end),
+				 order.end(), compare);
+		order.resize(selection.window.end);
+	}
 
-	songs.erase(songs.begin(),
-		    std::next(songs.begin(), selection.window.start));
+	std::sort(order.begin(), order.end(), compare);
+
+	if (selection.window.start >= order.size())
+		return;
 
-	/* now pass all songs to the original visitor callback */
-	for (const auto &song : songs)
-		original_visit_song((LightSong)song);
+	/* now pass the windowed songs to the original visitor
+	   callback */
+	for (auto i = std::next(order.begin(), selection.window.start);
+	     i != order.end(); ++i)
+		original_visit_song((LightSong)songs[*i]);
 }
@@ -51,6 +51,8 @@
 #include <cassert>
 #include <string>
 #include <list>
+#include <map>
+#include <vector>
 
 class LibmpdclientError final : public std::runtime_error {
 	enum mpd_error code;
@@ -83,12 +85,55 @@ public:
 	}
 };
 
+class ProxyEntity {
+	struct mpd_entity *entity;
+
+public:
+	explicit ProxyEntity(struct mpd_entity *_entity) noexcept
+		:entity(_entity) {}
+
+	ProxyEntity(const ProxyEntity &other) = delete;
+
+	ProxyEntity(ProxyEntity &&other) noexcept
+		:entity(other.entity) {
+		other.entity = nullptr;
+	}
+
+	~ProxyEntity() noexcept {
+		if (entity != nullptr)
+			mpd_entity_free(entity);
+	}
+
+	ProxyEntity &operator=(const ProxyEntity &other) = delete;
+
+	operator const struct mpd_entity *() const noexcept {
+		return entity;
+	}
+};
+
+/**
+ * How long cached listings remain valid.  This is only a safety net;
+ * usually, the cache is invalidated by "database" idle events from
+ * the other MPD.
+ */
+static constexpr auto PROXY_LISTING_CACHE_TTL = std::chrono::minutes(1);
+
 class ProxyDatabase final : public Database, SocketMonitor, IdleMonitor {
 	DatabaseListener &listener;
 
 	const std::string host;
 	const std::string password;
 	const unsigned port;
+
+	/**
+	 * The connect timeout in milliseconds, passed to
+	 * libmpdclient.  Without it, a dead server (or a dead DNS
+	 * resolver) would stall the thread for libmpdclient's
+	 * 30 second default; reconnect attempts happen in the
+	 * command-processing thread, so keep this short.
+	 */
+	const unsigned timeout_ms;
+
 	const bool keepalive;
 
 	struct mpd_connection *connection;
@@ -108,6 +153,22 @@ class ProxyDatabase final : public Database, SocketMonitor, IdleMonitor {
 	 */
 	bool is_idle;
 
+	struct ListingCacheEntry {
+		std::chrono::steady_clock::time_point expires;
+		std::list<ProxyEntity> entities;
+	};
+
+	/**
+	 * A cache for "lsinfo" responses, indexed by URI.  It avoids
+	 * one blocking round trip to the other MPD per directory
+	 * level while a client is browsing.  Invalidated by
+	 * "database" idle events, by reconnecting and by
+	 * #PROXY_LISTING_CACHE_TTL.
+	 *
+	 * This is mutable because Visit() must be "const".
+	 */
+	mutable std::map<std::string, ListingCacheEntry> listing_cache;
+
 public:
 	ProxyDatabase(EventLoop &_loop, DatabaseListener &_listener,
 		      const ConfigBlock &block);
@@ -146,6 +207,14 @@ private:
 
 	void Disconnect() noexcept;
 
+	/**
+	 * Fetches the "lsinfo" response for the given URI, using the
+	 * #listing_cache if possible.
+	 *
+	 * Throws on error.
+	 */
+	const std::list<ProxyEntity> &LookupListing(const char *uri) const;
+
 	/* virtual methods from SocketMonitor */
 	bool OnSocketReady(unsigned flags) noexcept override;
 
@@ -436,6 +505,7 @@ ProxyDatabase::ProxyDatabase(EventLoop &_loop, DatabaseListener &_listener,
 	 host(block.GetBlockValue("host", "")),
 	 password(block.GetBlockValue("password", "")),
 	 port(block.GetBlockValue("port", 0u)),
+	 timeout_ms(block.GetBlockValue("timeout", 5u) * 1000u),
 	 keepalive(block.GetBlockValue("keepalive", false))
 {
 }
@@ -473,7 +543,7 @@ void
 ProxyDatabase::Connect()
 {
 	const char *_host = host.empty() ? nullptr : host.c_str();
-	connection = mpd_connection_new(_host, port, 0);
+	connection = mpd_connection_new(_host, port, timeout_ms);
 	if (connection == nullptr)
 		throw LibmpdclientError(MPD_ERROR_OOM, "Out of memory");
 
@@ -507,6 +577,10 @@ ProxyDatabase::Connect()
 	idle_received = ~0u;
 	is_idle = false;
 
+	/* this is a new connection; the old MPD may be gone, and
+	   cached listings may be stale already */
+	listing_cache.clear();
+
 	SocketMonitor::Open(SocketDescriptor(mpd_async_get_fd(mpd_connection_get_async(connection))));
 	IdleMonitor::Schedule();
 }
@@ -596,8 +670,10 @@ ProxyDatabase::OnIdle() noexcept
 
 	/* handle previous idle events */
 
-	if (idle_received & MPD_IDLE_DATABASE)
+	if (idle_received & MPD_IDLE_DATABASE) {
+		listing_cache.clear();
 		listener.OnDatabaseModified();
+	}
 
 	idle_received = 0;
 
@@ -658,18 +734,12 @@ ProxyDatabase::ReturnSong(const LightSong *_song) const noexcept
 }
 
 static void
-Visit(struct mpd_connection *connection, const char *uri,
-      bool recursive, const SongFilter *filter,
-      VisitDirectory visit_directory, VisitSong visit_song,
-      VisitPlaylist visit_playlist);
-
-static void
-Visit(struct mpd_connection *connection,
-      bool recursive, const SongFilter *filter,
-      const struct mpd_directory *directory,
-      VisitDirectory visit_directory, VisitSong visit_song,
-      VisitPlaylist visit_playlist)
+Visit(const struct mpd_directory *directory,
+      VisitDirectory visit_directory)
 {
+	if (!visit_directory)
+		return;
+
 	const char *path = mpd_directory_get_path(directory);
 
 	std::chrono::system_clock::time_point mtime =
@@ -678,12 +748,7 @@ Visit(struct mpd_connection *connection,
 	if (_mtime > 0)
 		mtime = std::chrono::system_clock::from_time_t(_mtime);
 
-	if (visit_directory)
-		visit_directory(LightDirectory(path, mtime));
-
-	if (recursive)
-		Visit(connection, path, recursive, filter,
-		      visit_directory, visit_song, visit_playlist);
+	visit_directory(LightDirectory(path, mtime));
 }
 
 gcc_pure
@@ -723,55 +788,104 @@ Visit(const struct mpd_playlist *playlist,
 	visit_playlist(p, LightDirectory::Root());
 }
 
-class ProxyEntity {
+static std::list<ProxyEntity>
+ReceiveEntities(struct mpd_connection *connection) noexcept
+{
+	std::list<ProxyEntity> entities;
 	struct mpd_entity *entity;
+	while ((entity = mpd_recv_entity(connection)) != nullptr)
+		entities.push_back(ProxyEntity(entity));
 
-public:
-	explicit ProxyEntity(struct mpd_entity *_entity) noexcept
-		:entity(_entity) {}
+	mpd_response_finish(connection);
+	return entities;
+}
 
-	ProxyEntity(const ProxyEntity &other) = delete;
+/**
+ * Fetches the listings of all given directories with a single command
+ * list, i.e. with one round trip to the other MPD.
+ */
+static std::list<std::list<ProxyEntity>>
+ReceiveListings(struct mpd_connection *connection,
+		const std::vector<const char *> &uris)
+{
+	assert(!uris.empty());
 
-	ProxyEntity(ProxyEntity &&other) noexcept
-		:entity(other.entity) {
-		other.entity = nullptr;
-	}
+	if (!mpd_command_list_begin(connection, true))
+		ThrowError(connection);
 
-	~ProxyEntity() noexcept {
-		if (entity != nullptr)
-			mpd_entity_free(entity);
-	}
+	for (const char *uri : uris)
+		if (!mpd_send_list_meta(connection, uri))
+			ThrowError(connection);
 
-	ProxyEntity &operator=(const ProxyEntity &other) = delete;
+	if (!mpd_command_list_end(connection))
+		ThrowError(connection);
 
-	operator const struct mpd_entity *() const noexcept {
-		return entity;
+	std::list<std::list<ProxyEntity>> listings;
+
+	for (size_t remaining = uris.size(); remaining > 0; --remaining) {
+		std::list<ProxyEntity> entities;
+		struct mpd_entity *entity;
+		while ((entity = mpd_recv_entity(connection)) != nullptr)
+			entities.push_back(ProxyEntity(entity));
+
+		CheckError(connection);
+
+		if (remaining > 1 && !mpd_response_next(connection))
+			ThrowError(connection);
+
+		listings.push_back(std::move(entities));
 	}
-};
 
-static std::list<ProxyEntity>
-ReceiveEntities(struct mpd_connection *connection) noexcept
+	if (!mpd_response_finish(connection))
+		ThrowError(connection);
+
+	return listings;
+}
+
+const std::list<ProxyEntity> &
+ProxyDatabase::LookupListing(const char *uri) const
 {
-	std::list<ProxyEntity> entities;
-	struct mpd_entity *entity;
-	while ((entity = mpd_recv_entity(connection)) != nullptr)
-		entities.push_back(ProxyEntity(entity));
+	const auto now = std::chrono::steady_clock::now();
 
-	mpd_response_finish(connection);
-	return entities;
+	auto i = listing_cache.find(uri);
+	if (i != listing_cache.end() && now < i->second.expires)
+		return i->second.entities;
+
+	if (!mpd_send_list_meta(connection, uri))
+		ThrowError(connection);
+
+	auto entities = ReceiveEntities(connection);
+	CheckError(connection);
+
+	auto &entry = listing_cache[uri];
+	entry.expires = now + PROXY_LISTING_CACHE_TTL;
+	entry.entities = std::move(entities);
+	return entry.entities;
 }
 
 static void
-Visit(struct mpd_connection *connection, const char *uri,
+Visit(struct mpd_connection *connection,
       bool recursive, const SongFilter *filter,
+      const std::list<ProxyEntity> &entities,
       VisitDirectory visit_directory, VisitSong visit_song,
       VisitPlaylist visit_playlist)
 {
-	if (!mpd_send_list_meta(connection, uri))
-		ThrowError(connection);
+	std::list<std::list<ProxyEntity>> listings;
+
+	if (recursive) {
+		/* instead of one blocking round trip per sub
+		   directory, fetch the listings of all sub
+		   directories with a single round trip */
+		std::vector<const char *> uris;
+		for (const auto &entity : entities)
+			if (mpd_entity_get_type(entity) == MPD_ENTITY_TYPE_DIRECTORY)
+				uris.push_back(mpd_directory_get_path(mpd_entity_get_directory(entity)));
+
+		if (!uris.empty())
+			listings = ReceiveListings(connection, uris);
+	}
 
-	std::list<ProxyEntity> entities(ReceiveEntities(connection));
-	CheckError(connection);
+	auto listing = listings.begin();
 
 	for (const auto &entity : entities) {
 		switch (mpd_entity_get_type(entity)) {
@@ -779,9 +893,16 @@ Visit(struct mpd_connection *connection, const char *uri,
 			break;
 
 		case MPD_ENTITY_TYPE_DIRECTORY:
-			Visit(connection, recursive, filter,
-			      mpd_entity_get_directory(entity),
-			      visit_directory, visit_song, visit_playlist);
+			Visit(mpd_entity_get_directory(entity),
+			      visit_directory);
+
+			if (recursive)
+				/* recurse into the prefetched
+				   listing */
+				Visit(connection, recursive, filter,
+				      *listing++,
+				      visit_directory, visit_song,
+				      visit_playlist);
 			break;
 
 		case MPD_ENTITY_TYPE_SONG:
@@ -974,8 +1095,8 @@ ProxyDatabase::Visit(const DatabaseSelection &selection,
 	}
 
 	/* fall back to recursive walk (slow!) */
-	::Visit(connection, selection.uri.c_str(),
-		selection.recursive, selection.filter,
+	::Visit(connection, selection.recursive, selection.filter,
+		LookupListing(selection.uri.c_str()),
 		visit_directory, visit_song, visit_playlist);
 
 	helper.Commit();
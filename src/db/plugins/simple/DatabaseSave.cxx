@@ -22,13 +22,26 @@
 #include "Directory.hxx"
 #include "DirectorySave.hxx"
 #include "fs/io/BufferedOutputStream.hxx"
-#include "fs/io/TextFile.hxx"
+#include "fs/io/LineReader.hxx"
 #include "tag/ParseName.hxx"
 #include "tag/Settings.hxx"
 #include "fs/Charset.hxx"
 #include "util/StringCompare.hxx"
 #include "util/RuntimeError.hxx"
 
+#ifndef _WIN32
+#include "fs/io/BufferLineReader.hxx"
+#include "fs/io/MmapLineReader.hxx"
+#include "thread/Mutex.hxx"
+#include "thread/Thread.hxx"
+#include "Log.hxx"
+
+#include <exception>
+#include <forward_list>
+#include <mutex>
+#include <vector>
+#endif
+
 #include <string.h>
 #include <stdlib.h>
 
@@ -39,7 +52,8 @@
 #define DIRECTORY_FS_CHARSET "fs_charset: "
 #define DB_TAG_PREFIX "tag: "
 
-static constexpr unsigned DB_FORMAT = 2;
+/* format 3 adds the song "Target" attribute */
+static constexpr unsigned DB_FORMAT = 3;
 
 /**
  * The oldest database format understood by this MPD version.
@@ -63,8 +77,13 @@ db_save_internal(BufferedOutputStream &os, const Directory &music_root)
 	directory_save(os, music_root);
 }
 
-void
-db_load_internal(TextFile &file, Directory &music_root)
+/**
+ * Parse and verify the "info" header of the database file.
+ *
+ * Throws #std::runtime_error on error.
+ */
+static void
+db_load_info(LineReader &file)
 {
 	char *line;
 	unsigned format = 0;
@@ -125,7 +144,223 @@ db_load_internal(TextFile &file, Directory &music_root)
 		if (IsTagEnabled(i) && !tags[i])
 			throw std::runtime_error("Tag list mismatch, "
 						 "discarding database file");
+}
+
+void
+db_load_internal(LineReader &file, Directory &music_root)
+{
+	db_load_info(file);
+
+	/* directory_load() takes the db_mutex around each tree
+	   mutation itself */
+	directory_load(file, music_root);
+}
+
+#ifndef _WIN32
+
+/**
+ * One top-level directory section of the database file, to be parsed
+ * by a worker thread.  The range [begin, end) covers everything
+ * after the "directory" line up to and including the matching "end"
+ * line.
+ */
+struct DatabaseSection {
+	Directory *directory;
+
+	char *begin, *end;
+};
+
+/**
+ * Distributes database sections over a pool of worker threads,
+ * mirroring #ParallelUpdateQueue in db/update/Walk.cxx.  Tree
+ * mutations take the global db_mutex (see directory_load()), but
+ * each worker builds its own disjoint subtree, so the lock is
+ * practically uncontended; the tag pool has its own internal
+ * sharded locks.
+ */
+class ParallelLoadQueue {
+	std::vector<DatabaseSection> sections;
+
+	/**
+	 * Protects #next and #error.
+	 */
+	Mutex mutex;
+
+	size_t next = 0;
+
+	/**
+	 * The first error thrown by a worker; makes the remaining
+	 * workers stop early.
+	 */
+	std::exception_ptr error;
+
+public:
+	void Push(Directory &directory, char *begin, char *end) noexcept {
+		sections.emplace_back(DatabaseSection{&directory, begin, end});
+	}
+
+	/**
+	 * Process all queued sections with up to the given number of
+	 * threads.  The calling thread participates as one of the
+	 * workers.  Rethrows the first worker error.
+	 */
+	void Run(unsigned n_threads);
+
+private:
+	void ThreadMain() noexcept;
+};
+
+void
+ParallelLoadQueue::ThreadMain() noexcept
+{
+	while (true) {
+		const DatabaseSection *section;
+
+		{
+			const std::lock_guard<Mutex> protect(mutex);
+			if (error || next >= sections.size())
+				break;
+
+			section = &sections[next++];
+		}
+
+		try {
+			BufferLineReader reader(section->begin, section->end);
+			directory_load_into(reader, *section->directory);
+		} catch (...) {
+			const std::lock_guard<Mutex> protect(mutex);
+			if (!error)
+				error = std::current_exception();
+			break;
+		}
+	}
+}
+
+void
+ParallelLoadQueue::Run(unsigned n_threads)
+{
+	if (n_threads > sections.size())
+		n_threads = sections.size();
+
+	std::forward_list<Thread> threads;
+
+	try {
+		for (unsigned i = 1; i < n_threads; ++i) {
+			threads.emplace_front(BIND_THIS_METHOD(ThreadMain));
+			threads.front().Start();
+		}
+	} catch (...) {
+		/* failure to start a thread is not fatal; the
+		   remaining workers will pick up the slack */
+		LogError(std::current_exception());
+
+		if (!threads.empty() && !threads.front().IsDefined())
+			threads.pop_front();
+	}
+
+	/* the calling thread participates, too */
+	ThreadMain();
+
+	for (auto &thread : threads)
+		thread.Join();
+
+	if (error)
+		std::rethrow_exception(error);
+}
+
+/**
+ * First phase of the parallel loader: split the remainder of the
+ * mapping at top-level directory boundaries, creating the top-level
+ * child directories and queueing one section per child.  The cursor
+ * of #file is left at the first line which does not belong to any
+ * section (usually the root's songs and playlists).
+ */
+static void
+db_index_sections(MmapLineReader &file, Directory &music_root,
+		  ParallelLoadQueue &queue)
+{
+	char *p = file.GetCursor();
+	char *const end = file.GetEnd();
 
-	const ScopeDatabaseLock protect;
+	while (p < end) {
+		char *newline = (char *)memchr(p, '\n', end - p);
+		if (newline == nullptr)
+			/* missing trailing newline: let the
+			   sequential loader deal with it */
+			break;
+
+		if (!StringStartsWith(p, DIRECTORY_DIR))
+			/* not a subdirectory: the root's songs and
+			   playlists follow; they are parsed
+			   sequentially by the caller */
+			break;
+
+		/* null-terminate the name in place; this line is
+		   consumed here and never seen by a worker */
+		char *name = p + strlen(DIRECTORY_DIR);
+		char *name_end = newline;
+		if (name_end > name && name_end[-1] == '\r')
+			--name_end;
+		*name_end = 0;
+
+		Directory *directory;
+		{
+			const ScopeDatabaseLock protect;
+
+			if (music_root.FindChild(name) != nullptr)
+				throw FormatRuntimeError("Duplicate subdirectory '%s'",
+							 name);
+
+			directory = music_root.CreateChild(name);
+		}
+
+		/* skip to the matching "end" line, counting nested
+		   begin/end pairs */
+		char *const body = newline + 1;
+		p = body;
+		unsigned depth = 0;
+
+		while (true) {
+			if (p >= end)
+				throw std::runtime_error("Unexpected end of file");
+
+			newline = (char *)memchr(p, '\n', end - p);
+			if (newline == nullptr)
+				throw std::runtime_error("Unexpected end of file");
+
+			if (StringStartsWith(p, DIRECTORY_BEGIN)) {
+				++depth;
+			} else if (StringStartsWith(p, DIRECTORY_END)) {
+				if (--depth == 0) {
+					p = newline + 1;
+					break;
+				}
+			}
+
+			p = newline + 1;
+		}
+
+		queue.Push(*directory, body, p);
+	}
+
+	file.Seek(p);
+}
+
+void
+db_load_internal(MmapLineReader &file, Directory &music_root,
+		 unsigned load_threads)
+{
+	db_load_info(file);
+
+	if (load_threads > 1) {
+		ParallelLoadQueue queue;
+		db_index_sections(file, music_root, queue);
+		queue.Run(load_threads);
+	}
+
+	/* the root's own songs and playlists - and everything else
+	   if the parallel phase was skipped */
 	directory_load(file, music_root);
 }
+
+#endif /* !_WIN32 */
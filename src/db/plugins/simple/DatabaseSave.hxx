@@ -22,7 +22,8 @@
 
 struct Directory;
 class BufferedOutputStream;
-class TextFile;
+class LineReader;
+class MmapLineReader;
 
 void
 db_save_internal(BufferedOutputStream &os, const Directory &root);
@@ -31,6 +32,21 @@ db_save_internal(BufferedOutputStream &os, const Directory &root);
  * Throws #std::runtime_error on error.
  */
 void
-db_load_internal(TextFile &file, Directory &root);
+db_load_internal(LineReader &file, Directory &root);
+
+#ifndef _WIN32
+
+/**
+ * Like db_load_internal(), but may split the file at top-level
+ * directory boundaries and parse the sections with the given number
+ * of threads.
+ *
+ * Throws #std::runtime_error on error.
+ */
+void
+db_load_internal(MmapLineReader &file, Directory &root,
+		 unsigned load_threads);
+
+#endif
 
 #endif
@@ -33,10 +33,36 @@
 #include "util/Alloc.hxx"
 #include "util/DeleteDisposer.hxx"
 
+#include <algorithm>
+
 #include <assert.h>
 #include <string.h>
 #include <stdlib.h>
 
+/**
+ * Find the insertion/lookup position of the given name in a
+ * name-sorted child index.
+ */
+gcc_pure
+static std::vector<Directory *>::const_iterator
+LowerBoundChild(const std::vector<Directory *> &v, const char *name) noexcept
+{
+	return std::lower_bound(v.begin(), v.end(), name,
+				[](const Directory *a, const char *b){
+					return strcmp(a->GetName(), b) < 0;
+				});
+}
+
+gcc_pure
+static std::vector<Song *>::const_iterator
+LowerBoundSong(const std::vector<Song *> &v, const char *name) noexcept
+{
+	return std::lower_bound(v.begin(), v.end(), name,
+				[](const Song *a, const char *b){
+					return strcmp(a->uri, b) < 0;
+				});
+}
+
 Directory::Directory(std::string &&_path_utf8, Directory *_parent) noexcept
 	:parent(_parent),
 	 path(std::move(_path_utf8))
@@ -60,6 +86,8 @@ Directory::Delete() noexcept
 	assert(holding_db_lock());
 	assert(parent != nullptr);
 
+	parent->children_by_name.erase(LowerBoundChild(parent->children_by_name,
+						       GetName()));
 	parent->children.erase_and_dispose(parent->children.iterator_to(*this),
 					   DeleteDisposer());
 }
@@ -85,6 +113,8 @@ Directory::CreateChild(const char *name_utf8) noexcept
 
 	Directory *child = new Directory(std::move(path_utf8), this);
 	children.push_back(*child);
+	children_by_name.insert(LowerBoundChild(children_by_name, name_utf8),
+				child);
 	return child;
 }
 
@@ -93,9 +123,10 @@ Directory::FindChild(const char *name) const noexcept
 {
 	assert(holding_db_lock());
 
-	for (const auto &child : children)
-		if (strcmp(child.GetName(), name) == 0)
-			return &child;
+	auto i = LowerBoundChild(children_by_name, name);
+	if (i != children_by_name.end() &&
+	    strcmp((*i)->GetName(), name) == 0)
+		return *i;
 
 	return nullptr;
 }
@@ -109,10 +140,12 @@ Directory::PruneEmpty() noexcept
 	     child != end;) {
 		child->PruneEmpty();
 
-		if (child->IsEmpty() && !child->IsMount())
+		if (child->IsEmpty() && !child->IsMount()) {
+			children_by_name.erase(LowerBoundChild(children_by_name,
+							       child->GetName()));
 			child = children.erase_and_dispose(child,
 							   DeleteDisposer());
-		else
+		} else
 			++child;
 	}
 }
@@ -170,6 +203,7 @@ Directory::AddSong(Song *song) noexcept
 	assert(song->parent == this);
 
 	songs.push_back(*song);
+	songs_by_name.insert(LowerBoundSong(songs_by_name, song->uri), song);
 }
 
 void
@@ -180,6 +214,14 @@ Directory::RemoveSong(Song *song) noexcept
 	assert(song->parent == this);
 
 	songs.erase(songs.iterator_to(*song));
+	songs_by_name.erase(LowerBoundSong(songs_by_name, song->uri));
+}
+
+void
+Directory::ClearSongs() noexcept
+{
+	songs_by_name.clear();
+	songs.clear_and_dispose(Song::Disposer());
 }
 
 const Song *
@@ -188,29 +230,40 @@ Directory::FindSong(const char *name_utf8) const noexcept
 	assert(holding_db_lock());
 	assert(name_utf8 != nullptr);
 
-	for (auto &song : songs) {
-		assert(song.parent == this);
-
-		if (strcmp(song.uri, name_utf8) == 0)
-			return &song;
+	auto i = LowerBoundSong(songs_by_name, name_utf8);
+	if (i != songs_by_name.end() &&
+	    strcmp((*i)->uri, name_utf8) == 0) {
+		assert((*i)->parent == this);
+		return *i;
 	}
 
 	return nullptr;
 }
 
-gcc_pure
-static bool
-directory_cmp(const Directory &a, const Directory &b) noexcept
-{
-	return IcuCollate(a.path.c_str(), b.path.c_str()) < 0;
-}
-
 void
 Directory::Sort() noexcept
 {
 	assert(holding_db_lock());
 
-	children.sort(directory_cmp);
+	/* precompute the collation keys and sort over them, instead
+	   of running the collation transform on every comparison */
+
+	std::vector<std::pair<std::string, Directory *>> keys;
+	keys.reserve(std::distance(children.begin(), children.end()));
+
+	for (auto &child : children)
+		keys.emplace_back(IcuCollateKey(child.path.c_str()), &child);
+
+	std::stable_sort(keys.begin(), keys.end(),
+			 [](const auto &a, const auto &b){
+				 return a.first < b.first;
+			 });
+
+	/* relink the intrusive list in sorted order */
+	children.clear();
+	for (const auto &key : keys)
+		children.push_back(*key.second);
+
 	song_list_sort(songs);
 
 	for (auto &child : children)
@@ -25,10 +25,12 @@
 #include "db/PlaylistVector.hxx"
 #include "db/Ptr.hxx"
 #include "Song.hxx"
+#include "TagItemArena.hxx"
 
 #include <boost/intrusive/list.hpp>
 
 #include <string>
+#include <vector>
 
 /**
  * Virtual directory that is really an archive file or a folder inside
@@ -81,6 +83,25 @@ struct Directory {
 	 */
 	SongList songs;
 
+	/**
+	 * All children sorted by their base name (strcmp), for
+	 * binary-search lookup in FindChild().  The linked list above
+	 * remains the canonical container (and determines the
+	 * iteration order); this index is maintained by CreateChild(),
+	 * Delete() and PruneEmpty().
+	 *
+	 * This attribute is protected with the global #db_mutex.
+	 */
+	std::vector<Directory *> children_by_name;
+
+	/**
+	 * All songs sorted by name (strcmp), for binary-search lookup
+	 * in FindSong().
+	 *
+	 * This attribute is protected with the global #db_mutex.
+	 */
+	std::vector<Song *> songs_by_name;
+
 	PlaylistVector playlists;
 
 	Directory *const parent;
@@ -98,6 +119,13 @@ struct Directory {
 	 */
 	DatabasePtr mounted_database;
 
+	/**
+	 * Arena for the #TagItem pointer arrays of all songs in this
+	 * directory tree.  Only the root directory's instance is used
+	 * (see GetRoot()).
+	 */
+	TagItemArena tag_item_arena;
+
 public:
 	Directory(std::string &&_path_utf8, Directory *_parent) noexcept;
 	~Directory() noexcept;
@@ -206,6 +234,17 @@ public:
 		return parent == nullptr;
 	}
 
+	/**
+	 * Returns the root directory of this directory tree.
+	 */
+	gcc_pure
+	Directory &GetRoot() noexcept {
+		Directory *directory = this;
+		while (directory->parent != nullptr)
+			directory = directory->parent;
+		return *directory;
+	}
+
 	template<typename T>
 	void ForEachChildSafe(T &&t) {
 		const auto end = children.end();
@@ -251,6 +290,11 @@ public:
 	 */
 	void RemoveSong(Song *song) noexcept;
 
+	/**
+	 * Remove and free all songs in this directory.
+	 */
+	void ClearSongs() noexcept;
+
 	/**
 	 * Caller must lock the #db_mutex.
 	 */
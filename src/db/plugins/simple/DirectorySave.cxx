@@ -18,12 +18,13 @@
  */
 
 #include "DirectorySave.hxx"
+#include "db/DatabaseLock.hxx"
 #include "Directory.hxx"
 #include "Song.hxx"
 #include "SongSave.hxx"
 #include "song/DetachedSong.hxx"
 #include "PlaylistDatabase.hxx"
-#include "fs/io/TextFile.hxx"
+#include "fs/io/LineReader.hxx"
 #include "fs/io/BufferedOutputStream.hxx"
 #include "util/ChronoUtil.hxx"
 #include "util/StringCompare.hxx"
@@ -32,11 +33,8 @@
 
 #include <string.h>
 
-#define DIRECTORY_DIR "directory: "
 #define DIRECTORY_TYPE "type: "
 #define DIRECTORY_MTIME "mtime: "
-#define DIRECTORY_BEGIN "begin: "
-#define DIRECTORY_END "end: "
 
 gcc_const
 static const char *
@@ -114,29 +112,43 @@ ParseLine(Directory &directory, const char *line)
 	return true;
 }
 
-static Directory *
-directory_load_subdir(TextFile &file, Directory &parent, const char *name)
+void
+directory_load_into(LineReader &file, Directory &directory)
 {
-	if (parent.FindChild(name) != nullptr)
-		throw FormatRuntimeError("Duplicate subdirectory '%s'", name);
+	while (true) {
+		const char *line = file.ReadLine();
+		if (line == nullptr)
+			throw std::runtime_error("Unexpected end of file");
 
-	Directory *directory = parent.CreateChild(name);
+		if (StringStartsWith(line, DIRECTORY_BEGIN))
+			break;
 
-	try {
-		while (true) {
-			const char *line = file.ReadLine();
-			if (line == nullptr)
-				throw std::runtime_error("Unexpected end of file");
+		if (!ParseLine(directory, line))
+			throw FormatRuntimeError("Malformed line: %s", line);
+	}
 
-			if (StringStartsWith(line, DIRECTORY_BEGIN))
-				break;
+	directory_load(file, directory);
+}
 
-			if (!ParseLine(*directory, line))
-				throw FormatRuntimeError("Malformed line: %s", line);
-		}
+static Directory *
+directory_load_subdir(LineReader &file, Directory &parent, const char *name)
+{
+	Directory *directory;
+
+	{
+		const ScopeDatabaseLock protect;
+
+		if (parent.FindChild(name) != nullptr)
+			throw FormatRuntimeError("Duplicate subdirectory '%s'",
+						 name);
+
+		directory = parent.CreateChild(name);
+	}
 
-		directory_load(file, *directory);
+	try {
+		directory_load_into(file, *directory);
 	} catch (...) {
+		const ScopeDatabaseLock protect;
 		directory->Delete();
 		throw;
 	}
@@ -144,8 +156,13 @@ directory_load_subdir(TextFile &file, Directory &parent, const char *name)
 	return directory;
 }
 
+/* the db_mutex is taken only around the actual tree mutations, not
+   for the whole load: parsing (the bulk of the work) stays outside,
+   which allows db_load_internal() to parse several independent
+   subtrees in parallel */
+
 void
-directory_load(TextFile &file, Directory &directory)
+directory_load(LineReader &file, Directory &directory)
 {
 	const char *line;
 
@@ -157,8 +174,12 @@ directory_load(TextFile &file, Directory &directory)
 		} else if ((p = StringAfterPrefix(line, SONG_BEGIN))) {
 			const char *name = p;
 
-			if (directory.FindSong(name) != nullptr)
-				throw FormatRuntimeError("Duplicate song '%s'", name);
+			{
+				const ScopeDatabaseLock protect;
+				if (directory.FindSong(name) != nullptr)
+					throw FormatRuntimeError("Duplicate song '%s'",
+								 name);
+			}
 
 			auto audio_format = AudioFormat::Undefined();
 			auto detached_song = song_load(file, name,
@@ -168,9 +189,12 @@ directory_load(TextFile &file, Directory &directory)
 						  directory);
 			song->audio_format = audio_format;
 
+			const ScopeDatabaseLock protect;
 			directory.AddSong(song);
 		} else if ((p = StringAfterPrefix(line, PLAYLIST_META_BEGIN))) {
 			const char *name = p;
+
+			const ScopeDatabaseLock protect;
 			playlist_metadata_load(file, directory.playlists, name);
 		} else {
 			throw FormatRuntimeError("Malformed line: %s", line);
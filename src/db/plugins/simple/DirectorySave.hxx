@@ -21,9 +21,13 @@
 #define MPD_DIRECTORY_SAVE_HXX
 
 struct Directory;
-class TextFile;
+class LineReader;
 class BufferedOutputStream;
 
+#define DIRECTORY_DIR "directory: "
+#define DIRECTORY_BEGIN "begin: "
+#define DIRECTORY_END "end: "
+
 void
 directory_save(BufferedOutputStream &os, const Directory &directory);
 
@@ -31,6 +35,16 @@ directory_save(BufferedOutputStream &os, const Directory &directory);
  * Throws #std::runtime_error on error.
  */
 void
-directory_load(TextFile &file, Directory &directory);
+directory_load(LineReader &file, Directory &directory);
+
+/**
+ * Load the attribute lines and the contents of an already-created
+ * directory, i.e. everything following its "directory" line,
+ * stopping after the matching "end" line.
+ *
+ * Throws #std::runtime_error on error.
+ */
+void
+directory_load_into(LineReader &file, Directory &directory);
 
 #endif
@@ -0,0 +1,244 @@
+/*
+ * Copyright 2003-2019 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "Journal.hxx"
+#include "Directory.hxx"
+#include "Song.hxx"
+#include "SongSave.hxx"
+#include "song/DetachedSong.hxx"
+#include "PlaylistDatabase.hxx"
+#include "db/DatabaseLock.hxx"
+#include "fs/io/LineReader.hxx"
+#include "fs/io/BufferedOutputStream.hxx"
+#include "fs/io/OutputStream.hxx"
+#include "util/ChronoUtil.hxx"
+#include "util/StringCompare.hxx"
+#include "util/NumberParser.hxx"
+#include "util/RuntimeError.hxx"
+
+#define JOURNAL_DIRECTORY "journal_directory: "
+#define JOURNAL_PURGE "journal_purge: "
+#define JOURNAL_END "journal_end"
+#define JOURNAL_MTIME "mtime: "
+#define JOURNAL_DEVICE "device: "
+
+/**
+ * An #OutputStream which discards the data and only calculates a
+ * FNV-1a (64 bit) hash over it.  Used to detect which directories
+ * have changed since the last save without keeping a second copy of
+ * the serialized form.
+ */
+class HashOutputStream final : public OutputStream {
+	uint64_t hash = 0xcbf29ce484222325;
+
+public:
+	uint64_t GetHash() const noexcept {
+		return hash;
+	}
+
+	/* virtual methods from class OutputStream */
+	void Write(const void *data, size_t size) override {
+		const uint8_t *p = (const uint8_t *)data;
+		for (size_t i = 0; i < size; ++i) {
+			hash ^= p[i];
+			hash *= 0x100000001b3;
+		}
+	}
+};
+
+/**
+ * Write the directory's own contents (but not its children, which
+ * have journal records of their own).  This defines both the journal
+ * record payload and the input of the content hash.
+ */
+static void
+WriteDirectoryContent(BufferedOutputStream &os, const Directory &directory)
+{
+	if (directory.device == DEVICE_INARCHIVE ||
+	    directory.device == DEVICE_CONTAINER)
+		os.Format(JOURNAL_DEVICE "%u\n", (unsigned)directory.device);
+
+	if (!IsNegative(directory.mtime))
+		os.Format(JOURNAL_MTIME "%lu\n",
+			  (unsigned long)std::chrono::system_clock::to_time_t(directory.mtime));
+
+	for (const auto &song : directory.songs)
+		song_save(os, song);
+
+	playlist_vector_save(os, directory.playlists);
+}
+
+static void
+CollectHashes(const Directory &directory,
+	      std::map<std::string, uint64_t> &hashes) noexcept
+{
+	HashOutputStream hos;
+
+	{
+		BufferedOutputStream bos(hos);
+		WriteDirectoryContent(bos, directory);
+		bos.Flush();
+	}
+
+	hashes.emplace(directory.GetPath(), hos.GetHash());
+
+	for (const auto &child : directory.children) {
+		if (child.IsMount())
+			continue;
+
+		CollectHashes(child, hashes);
+	}
+}
+
+void
+db_journal_collect_hashes(const Directory &root,
+			  std::map<std::string, uint64_t> &hashes) noexcept
+{
+	CollectHashes(root, hashes);
+}
+
+void
+db_journal_save_directory(BufferedOutputStream &os,
+			  const Directory &directory)
+{
+	os.Format(JOURNAL_DIRECTORY "%s\n", directory.GetPath());
+	WriteDirectoryContent(os, directory);
+	os.Format(JOURNAL_END "\n");
+}
+
+void
+db_journal_save_purge(BufferedOutputStream &os, const char *uri)
+{
+	os.Format(JOURNAL_PURGE "%s\n", uri);
+}
+
+/**
+ * Find the directory with the given URI, creating it (and its
+ * parents) if it does not exist yet.
+ *
+ * Caller must lock the #db_mutex.
+ */
+static Directory &
+MakeDirectoryForURI(Directory &root, const char *uri) noexcept
+{
+	if (*uri == 0)
+		return root;
+
+	auto r = root.LookupDirectory(uri);
+	Directory *directory = r.directory;
+	if (r.uri == nullptr)
+		return *directory;
+
+	const std::string remaining(r.uri);
+	for (size_t i = 0;;) {
+		const auto slash = remaining.find('/', i);
+		const std::string name = remaining.substr(i, slash == remaining.npos
+							  ? remaining.npos
+							  : slash - i);
+		directory = directory->MakeChild(name.c_str());
+
+		if (slash == remaining.npos)
+			break;
+
+		i = slash + 1;
+	}
+
+	return *directory;
+}
+
+/**
+ * Replay one directory replacement record: replace the directory's
+ * songs and playlists with the recorded ones.
+ */
+static void
+LoadJournalDirectory(LineReader &file, Directory &root, const char *uri)
+{
+	Directory &directory = MakeDirectoryForURI(root, uri);
+
+	directory.ClearSongs();
+
+	while (!directory.playlists.empty())
+		directory.playlists.erase(directory.playlists.begin());
+
+	const char *line;
+	while ((line = file.ReadLine()) != nullptr &&
+	       !StringIsEqual(line, JOURNAL_END)) {
+		const char *p;
+		if ((p = StringAfterPrefix(line, JOURNAL_MTIME))) {
+			const auto mtime = ParseUint64(p);
+			if (mtime > 0)
+				directory.mtime = std::chrono::system_clock::from_time_t(mtime);
+		} else if ((p = StringAfterPrefix(line, JOURNAL_DEVICE))) {
+			directory.device = (unsigned)ParseUint64(p);
+		} else if ((p = StringAfterPrefix(line, SONG_BEGIN))) {
+			const char *name = p;
+
+			if (directory.FindSong(name) != nullptr)
+				throw FormatRuntimeError("Duplicate song '%s'",
+							 name);
+
+			auto audio_format = AudioFormat::Undefined();
+			auto detached_song = song_load(file, name,
+						       &audio_format);
+
+			auto song = Song::NewFrom(std::move(*detached_song),
+						  directory);
+			song->audio_format = audio_format;
+
+			directory.AddSong(song);
+		} else if ((p = StringAfterPrefix(line, PLAYLIST_META_BEGIN))) {
+			const char *name = p;
+			playlist_metadata_load(file, directory.playlists,
+					       name);
+		} else {
+			throw FormatRuntimeError("Malformed journal line: %s",
+						 line);
+		}
+	}
+}
+
+static void
+PurgeJournalDirectory(Directory &root, const char *uri) noexcept
+{
+	auto r = root.LookupDirectory(uri);
+	if (r.uri != nullptr || r.directory == &root)
+		/* does not exist (anymore) - stale purge records are
+		   harmless */
+		return;
+
+	r.directory->Delete();
+}
+
+void
+db_journal_load(LineReader &file, Directory &root)
+{
+	const ScopeDatabaseLock protect;
+
+	const char *line;
+	while ((line = file.ReadLine()) != nullptr) {
+		const char *p;
+		if ((p = StringAfterPrefix(line, JOURNAL_DIRECTORY)))
+			LoadJournalDirectory(file, root, p);
+		else if ((p = StringAfterPrefix(line, JOURNAL_PURGE)))
+			PurgeJournalDirectory(root, p);
+		else
+			throw FormatRuntimeError("Malformed journal line: %s",
+						 line);
+	}
+}
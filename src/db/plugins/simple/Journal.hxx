@@ -0,0 +1,66 @@
+/*
+ * Copyright 2003-2019 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_DB_JOURNAL_HXX
+#define MPD_DB_JOURNAL_HXX
+
+#include <map>
+#include <string>
+
+#include <stdint.h>
+
+struct Directory;
+class BufferedOutputStream;
+class LineReader;
+
+/**
+ * Calculate a content hash for every directory in the given tree
+ * (excluding mount points) and store it in the given map, keyed by
+ * the directory URI (empty string for the root).  Comparing two such
+ * maps reveals which directories have changed since the last save.
+ */
+void
+db_journal_collect_hashes(const Directory &root,
+			  std::map<std::string, uint64_t> &hashes) noexcept;
+
+/**
+ * Append one directory replacement record to the journal.  On
+ * replay, the directory's songs and playlists are replaced with the
+ * recorded ones.
+ */
+void
+db_journal_save_directory(BufferedOutputStream &os,
+			  const Directory &directory);
+
+/**
+ * Append a purge record to the journal.  On replay, the given
+ * directory (and everything below it) is removed.
+ */
+void
+db_journal_save_purge(BufferedOutputStream &os, const char *uri);
+
+/**
+ * Replay a journal file on top of the given database tree.
+ *
+ * Throws #std::runtime_error on error.
+ */
+void
+db_journal_load(LineReader &file, Directory &root);
+
+#endif
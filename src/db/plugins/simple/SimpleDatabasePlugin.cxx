@@ -31,16 +31,22 @@
 #include "Directory.hxx"
 #include "Song.hxx"
 #include "DatabaseSave.hxx"
+#include "Journal.hxx"
 #include "db/DatabaseLock.hxx"
 #include "db/DatabaseError.hxx"
 #include "tag/Mask.hxx"
 #include "fs/io/TextFile.hxx"
+#ifndef _WIN32
+#include "fs/io/FileReader.hxx"
+#include "fs/io/MmapLineReader.hxx"
+#endif
 #include "fs/io/BufferedOutputStream.hxx"
 #include "fs/io/FileOutputStream.hxx"
 #include "fs/FileInfo.hxx"
 #include "config/Block.hxx"
 #include "fs/FileSystem.hxx"
 #include "util/CharUtil.hxx"
+#include "util/StringCompare.hxx"
 #include "util/Domain.hxx"
 #include "Log.hxx"
 
@@ -48,37 +54,81 @@
 #include "fs/io/GzipOutputStream.hxx"
 #endif
 
+#ifdef ENABLE_ZSTD
+#include "fs/io/ZstdOutputStream.hxx"
+#endif
+
+#include <algorithm>
 #include <memory>
 
 #include <errno.h>
 
 static constexpr Domain simple_db_domain("simple_db");
 
+static SimpleDatabase::Compression
+ParseCompression(const ConfigBlock &block)
+{
+	using Compression = SimpleDatabase::Compression;
+
+	const char *value = block.GetBlockValue("compress");
+	if (value != nullptr) {
+		if (StringIsEqual(value, "gzip")) {
+#ifdef ENABLE_ZLIB
+			return Compression::GZIP;
+#else
+			throw std::runtime_error("\"compress\" is set to \"gzip\", but zlib support is disabled");
+#endif
+		}
+
+		if (StringIsEqual(value, "zstd")) {
+#ifdef ENABLE_ZSTD
+			return Compression::ZSTD;
+#else
+			throw std::runtime_error("\"compress\" is set to \"zstd\", but zstd support is disabled");
+#endif
+		}
+	}
+
+	/* backwards compatibility: a boolean value selects gzip (if
+	   available) or no compression */
+	if (!block.GetBlockValue("compress", true))
+		return Compression::NONE;
+
+#ifdef ENABLE_ZLIB
+	return Compression::GZIP;
+#else
+	return Compression::NONE;
+#endif
+}
+
 inline SimpleDatabase::SimpleDatabase(const ConfigBlock &block)
 	:Database(simple_db_plugin),
 	 path(block.GetPath("path")),
-#ifdef ENABLE_ZLIB
-	 compress(block.GetBlockValue("compress", true)),
-#endif
+	 compress(ParseCompression(block)),
+	 journal(block.GetBlockValue("journal", false)),
+	 load_threads(block.GetPositiveValue("load_threads", 1u)),
+	 journal_path(nullptr),
 	 cache_path(block.GetPath("cache_directory"))
 {
 	if (path.IsNull())
 		throw std::runtime_error("No \"path\" parameter specified");
 
 	path_utf8 = path.ToUTF8();
+
+	if (journal)
+		journal_path = AllocatedPath::FromFS(PathTraitsFS::string(path.c_str()) +
+						     PATH_LITERAL(".journal"));
 }
 
 inline SimpleDatabase::SimpleDatabase(AllocatedPath &&_path,
-#ifndef ENABLE_ZLIB
-				      gcc_unused
-#endif
-				      bool _compress) noexcept
+				      Compression _compress) noexcept
 	:Database(simple_db_plugin),
 	 path(std::move(_path)),
 	 path_utf8(path.ToUTF8()),
-#ifdef ENABLE_ZLIB
 	 compress(_compress),
-#endif
+	 journal(false),
+	 load_threads(1),
+	 journal_path(nullptr),
 	 cache_path(nullptr),
 	 prefixed_light_song(nullptr) {
 }
@@ -144,21 +194,74 @@ SimpleDatabase::Check() const
 #endif
 }
 
+#ifndef _WIN32
+
+/**
+ * Does the file start with a gzip or zstd header?  Such a file
+ * cannot be parsed in place and needs to go through
+ * #AutoGunzipReader.
+ */
+static bool
+IsCompressedFile(Path path)
+{
+	FileReader file(path);
+
+	uint8_t magic[4];
+	if (file.Read(magic, sizeof(magic)) != sizeof(magic))
+		return false;
+
+	/* gzip */
+	if (magic[0] == 0x1f && magic[1] == 0x8b)
+		return true;
+
+	/* zstd */
+	return magic[0] == 0x28 && magic[1] == 0xb5 &&
+		magic[2] == 0x2f && magic[3] == 0xfd;
+}
+
+#endif
+
 void
 SimpleDatabase::Load()
 {
 	assert(!path.IsNull());
 	assert(root != nullptr);
 
-	TextFile file(path);
-
 	LogDebug(simple_db_domain, "reading DB");
 
-	db_load_internal(file, *root);
+#ifndef _WIN32
+	if (!IsCompressedFile(path)) {
+		/* map the file into the address space and parse it
+		   in place; this is much faster for large databases
+		   than reading it block-wise into a buffer */
+		MmapLineReader file(path);
+		db_load_internal(file, *root, load_threads);
+	} else {
+#else
+	{
+#endif
+		TextFile file(path);
+		db_load_internal(file, *root);
+	}
 
 	FileInfo fi;
 	if (GetFileInfo(path, fi))
 		mtime = fi.GetModificationTime();
+
+	if (journal) {
+		if (PathExists(journal_path)) {
+			LogDebug(simple_db_domain, "replaying DB journal");
+
+			TextFile file(journal_path);
+			db_journal_load(file, *root);
+
+			if (GetFileInfo(journal_path, fi))
+				mtime = fi.GetModificationTime();
+		}
+
+		saved_hashes.clear();
+		db_journal_collect_hashes(*root, saved_hashes);
+	}
 }
 
 void
@@ -333,18 +436,58 @@ std::map<std::string, std::set<std::string>>
 SimpleDatabase::CollectUniqueTags(const DatabaseSelection &selection,
 				  TagType tag_type, TagType group) const
 {
-	return ::CollectUniqueTags(*this, selection, tag_type, group);
+	if (!selection.uri.empty() || selection.filter != nullptr)
+		/* only whole-database queries are cached */
+		return ::CollectUniqueTags(*this, selection, tag_type, group);
+
+	const auto key = std::make_pair(tag_type, group);
+
+	{
+		const std::lock_guard<Mutex> protect(unique_tags_cache_mutex);
+		auto i = unique_tags_cache.find(key);
+		if (i != unique_tags_cache.end())
+			return i->second;
+	}
+
+	auto result = ::CollectUniqueTags(*this, selection, tag_type, group);
+
+	{
+		const std::lock_guard<Mutex> protect(unique_tags_cache_mutex);
+		unique_tags_cache.emplace(key, result);
+	}
+
+	return result;
 }
 
 DatabaseStats
 SimpleDatabase::GetStats(const DatabaseSelection &selection) const
 {
-	return ::GetStats(*this, selection);
+	if (!selection.uri.empty() || selection.filter != nullptr)
+		/* only whole-database stats are cached */
+		return ::GetStats(*this, selection);
+
+	{
+		const std::lock_guard<Mutex> protect(unique_tags_cache_mutex);
+		if (stats_cache_valid)
+			return stats_cache;
+	}
+
+	const auto stats = ::GetStats(*this, selection);
+
+	{
+		const std::lock_guard<Mutex> protect(unique_tags_cache_mutex);
+		stats_cache = stats;
+		stats_cache_valid = true;
+	}
+
+	return stats;
 }
 
 void
 SimpleDatabase::Save()
 {
+	FlushUniqueTagsCache();
+
 	{
 		const ScopeDatabaseLock protect;
 
@@ -355,6 +498,9 @@ SimpleDatabase::Save()
 		root->Sort();
 	}
 
+	if (TrySaveJournal())
+		return;
+
 	LogDebug(simple_db_domain, "writing DB");
 
 	FileOutputStream fos(path);
@@ -363,12 +509,20 @@ SimpleDatabase::Save()
 
 #ifdef ENABLE_ZLIB
 	std::unique_ptr<GzipOutputStream> gzip;
-	if (compress) {
+	if (compress == Compression::GZIP) {
 		gzip.reset(new GzipOutputStream(*os));
 		os = gzip.get();
 	}
 #endif
 
+#ifdef ENABLE_ZSTD
+	std::unique_ptr<ZstdOutputStream> zstd;
+	if (compress == Compression::ZSTD) {
+		zstd.reset(new ZstdOutputStream(*os));
+		os = zstd.get();
+	}
+#endif
+
 	BufferedOutputStream bos(*os);
 
 	db_save_internal(bos, *root);
@@ -382,13 +536,155 @@ SimpleDatabase::Save()
 	}
 #endif
 
+#ifdef ENABLE_ZSTD
+	if (zstd != nullptr) {
+		zstd->Flush();
+		zstd.reset();
+	}
+#endif
+
 	fos.Commit();
 
+	if (journal) {
+		/* the journal has been folded into the database
+		   file */
+		RemoveFile(journal_path);
+		journal_records = 0;
+
+		saved_hashes.clear();
+		db_journal_collect_hashes(*root, saved_hashes);
+	}
+
 	FileInfo fi;
 	if (GetFileInfo(path, fi))
 		mtime = fi.GetModificationTime();
 }
 
+/**
+ * Duplicate all contents of the directory #src into the freshly
+ * created directory #dest, allocating everything anew.  A mounted
+ * #Database is not copied; its ownership moves to the new tree.
+ *
+ * Caller must lock the #db_mutex.
+ */
+static void
+CopyDirectoryInto(Directory &src, Directory &dest) noexcept
+{
+	dest.mtime = src.mtime;
+	dest.inode = src.inode;
+	dest.device = src.device;
+	dest.mounted_database = std::move(src.mounted_database);
+
+	for (const auto &pi : src.playlists)
+		dest.playlists.UpdateOrInsert(PlaylistInfo(pi.name,
+							   pi.mtime));
+
+	for (const Song &song : src.songs)
+		dest.AddSong(Song::NewCopy(song, dest));
+
+	for (Directory &child : src.children)
+		CopyDirectoryInto(child, *dest.CreateChild(child.GetName()));
+}
+
+void
+SimpleDatabase::Compact()
+{
+	assert(root != nullptr);
+	assert(borrowed_song_count == 0);
+
+	Directory *fresh = Directory::NewRoot();
+
+	{
+		const ScopeDatabaseLock protect;
+
+		CopyDirectoryInto(*root, *fresh);
+		std::swap(root, fresh);
+	}
+
+	/* free the old, fragmented tree; tag pool entries are shared
+	   by reference count with the copy and survive, but all
+	   Directory/Song structures, name strings and TagItem
+	   pointer arenas have been reallocated compactly */
+	delete fresh;
+
+	FlushUniqueTagsCache();
+}
+
+inline bool
+SimpleDatabase::TrySaveJournal()
+{
+	if (!journal || saved_hashes.empty())
+		/* disabled, or no full save to base the journal on
+		   yet */
+		return false;
+
+	std::map<std::string, uint64_t> current;
+	db_journal_collect_hashes(*root, current);
+
+	unsigned n_changed = 0, n_purged = 0;
+
+	for (const auto &i : current) {
+		auto j = saved_hashes.find(i.first);
+		if (j == saved_hashes.end() || j->second != i.second)
+			++n_changed;
+	}
+
+	for (const auto &i : saved_hashes)
+		if (current.find(i.first) == current.end())
+			++n_purged;
+
+	if (n_changed + n_purged == 0)
+		/* nothing to do */
+		return true;
+
+	if (n_changed + n_purged > std::max<size_t>(16, current.size() / 10) ||
+	    journal_records + n_changed + n_purged > 65536)
+		/* the change set is large (or the journal has grown
+		   too long): compact by rewriting the whole database
+		   file */
+		return false;
+
+	LogDebug(simple_db_domain, "appending DB journal");
+
+	FileOutputStream fos(journal_path,
+			     FileOutputStream::Mode::APPEND_OR_CREATE);
+	BufferedOutputStream bos(fos);
+
+	{
+		const ScopeDatabaseLock protect;
+
+		for (const auto &i : saved_hashes)
+			if (current.find(i.first) == current.end())
+				db_journal_save_purge(bos, i.first.c_str());
+
+		for (const auto &i : current) {
+			auto j = saved_hashes.find(i.first);
+			if (j != saved_hashes.end() && j->second == i.second)
+				continue;
+
+			const auto r = root->LookupDirectory(i.first.c_str());
+			if (r.uri != nullptr)
+				/* should not happen - fall back to a
+				   full save */
+				return false;
+
+			db_journal_save_directory(bos, *r.directory);
+		}
+	}
+
+	bos.Flush();
+	fos.Commit();
+
+	journal_records += n_changed + n_purged;
+	saved_hashes = std::move(current);
+
+	FileInfo fi;
+	if (GetFileInfo(journal_path, fi))
+		mtime = fi.GetModificationTime();
+
+	return true;
+}
+
 void
 SimpleDatabase::Mount(const char *uri, DatabasePtr db)
 {
@@ -412,6 +708,8 @@ SimpleDatabase::Mount(const char *uri, DatabasePtr db)
 
 	Directory *mnt = r.directory->CreateChild(r.uri);
 	mnt->mounted_database = std::move(db);
+
+	FlushUniqueTagsCache();
 }
 
 static constexpr bool
@@ -438,9 +736,6 @@ SimpleDatabase::Mount(const char *local_uri, const char *storage_uri)
 
 	const auto name_fs = AllocatedPath::FromUTF8Throw(name.c_str());
 
-#ifndef ENABLE_ZLIB
-	constexpr bool compress = false;
-#endif
 	auto db = std::make_unique<SimpleDatabase>(cache_path / name_fs,
 						   compress);
 	db->Open();
@@ -478,6 +773,7 @@ SimpleDatabase::Unmount(const char *uri) noexcept
 		return false;
 
 	db->Close();
+	FlushUniqueTagsCache();
 	return true;
 }
 
@@ -22,13 +22,20 @@
 
 #include "db/Interface.hxx"
 #include "db/Ptr.hxx"
+#include "db/Stats.hxx"
 #include "fs/AllocatedPath.hxx"
 #include "song/LightSong.hxx"
+#include "thread/Mutex.hxx"
 #include "util/Manual.hxx"
 #include "util/Compiler.h"
 #include "config.h"
 
 #include <cassert>
+#include <map>
+#include <set>
+#include <utility>
+
+#include <stdint.h>
 
 struct ConfigBlock;
 struct Directory;
@@ -38,12 +45,42 @@ class DatabaseListener;
 class PrefixedLightSong;
 
 class SimpleDatabase : public Database {
+public:
+	/**
+	 * Which compression to apply when saving the database file?
+	 * Loading auto-detects the format by magic bytes, regardless
+	 * of this setting.
+	 */
+	enum class Compression : uint8_t {
+		NONE,
+		GZIP,
+		ZSTD,
+	};
+
+private:
 	AllocatedPath path;
 	std::string path_utf8;
 
-#ifdef ENABLE_ZLIB
-	bool compress;
-#endif
+	Compression compress;
+
+	/**
+	 * Append small updates to a journal file instead of
+	 * rewriting the whole database file?
+	 */
+	bool journal;
+
+	/**
+	 * The number of threads which parse the database file at
+	 * startup; values above 1 split the file at top-level
+	 * directory boundaries and parse the sections in parallel.
+	 */
+	unsigned load_threads;
+
+	/**
+	 * The journal file next to #path; only valid if #journal is
+	 * enabled.
+	 */
+	AllocatedPath journal_path;
 
 	/**
 	 * The path where cache files for Mount() are located.
@@ -69,9 +106,50 @@ class SimpleDatabase : public Database {
 	mutable unsigned borrowed_song_count;
 #endif
 
+	/**
+	 * Protects #unique_tags_cache against concurrent access by
+	 * multiple clients.
+	 */
+	mutable Mutex unique_tags_cache_mutex;
+
+	/**
+	 * An inverted index over the whole database, filled lazily by
+	 * CollectUniqueTags() and flushed whenever the database
+	 * contents change (Save(), Open(), Mount(), Unmount()).  It
+	 * turns repeated "list" queries into a single map lookup
+	 * instead of a full tree scan.
+	 */
+	mutable std::map<std::pair<TagType, TagType>,
+			 std::map<std::string, std::set<std::string>>> unique_tags_cache;
+
+	/**
+	 * The cached result of a whole-database GetStats() call,
+	 * protected by #unique_tags_cache_mutex and flushed together
+	 * with #unique_tags_cache.  Clients polling "stats" then cost
+	 * a copy of this struct instead of a full tree walk.
+	 */
+	mutable DatabaseStats stats_cache;
+
+	mutable bool stats_cache_valid = false;
+
+	/**
+	 * Per-directory content hashes as of the last successful
+	 * save; used by Save() to determine which directories need a
+	 * journal record.  Empty if #journal is disabled or no full
+	 * save has happened yet.
+	 */
+	std::map<std::string, uint64_t> saved_hashes;
+
+	/**
+	 * The number of records appended to the journal file since
+	 * the last full save; used to trigger compaction before the
+	 * journal grows unbounded.
+	 */
+	unsigned journal_records = 0;
+
 public:
 	SimpleDatabase(const ConfigBlock &block);
-	SimpleDatabase(AllocatedPath &&_path, bool _compress) noexcept;
+	SimpleDatabase(AllocatedPath &&_path, Compression _compress) noexcept;
 
 	static DatabasePtr Create(EventLoop &main_event_loop,
 				  EventLoop &io_event_loop,
@@ -87,6 +165,15 @@ public:
 
 	void Save();
 
+	/**
+	 * Rebuild the whole Directory/Song tree into freshly
+	 * allocated storage and discard the old one, reclaiming heap
+	 * fragmentation accumulated by months of incremental
+	 * updates.  Must not run while a database update is in
+	 * progress.
+	 */
+	void Compact();
+
 	/**
 	 * Returns true if there is a valid database file on the disk.
 	 */
@@ -142,6 +229,26 @@ private:
 	 */
 	void Load();
 
+	/**
+	 * Attempt to persist the current database state by appending
+	 * to the journal file instead of rewriting the whole
+	 * database file.  Returns false if a full save is required
+	 * (journaling disabled, no previous full save, or the change
+	 * set is too large).
+	 */
+	bool TrySaveJournal();
+
+	/**
+	 * Discard all cached CollectUniqueTags() and GetStats()
+	 * results; must be called whenever the database contents may
+	 * have changed.
+	 */
+	void FlushUniqueTagsCache() noexcept {
+		const std::lock_guard<Mutex> protect(unique_tags_cache_mutex);
+		unique_tags_cache.clear();
+		stats_cache_valid = false;
+	}
+
 	DatabasePtr LockUmountSteal(const char *uri) noexcept;
 };
 
@@ -56,9 +56,41 @@ Song::NewFrom(DetachedSong &&other, Directory &parent)
 {
 	Song *song = song_alloc(other.GetURI(), parent);
 	song->tag = std::move(other.WritableTag());
+
+	if (song->tag.num_items > 0)
+		/* move the TagItem pointers into the arena owned by
+		   the directory tree; this packs the tag metadata of
+		   all songs contiguously and saves one heap
+		   allocation per song */
+		song->tag.RelocateItems(parent.GetRoot().tag_item_arena
+					.Allocate(song->tag.num_items));
+
 	song->mtime = other.GetLastModified();
 	song->start_time = other.GetStartTime();
 	song->end_time = other.GetEndTime();
+
+	if (other.HasRealURI())
+		song->target = other.GetRealURI();
+
+	return song;
+}
+
+Song *
+Song::NewCopy(const Song &src, Directory &parent) noexcept
+{
+	Song *song = song_alloc(src.uri, parent);
+	song->tag = Tag(src.tag);
+
+	if (song->tag.num_items > 0)
+		song->tag.RelocateItems(parent.GetRoot().tag_item_arena
+					.Allocate(song->tag.num_items));
+
+	song->mtime = src.mtime;
+	song->start_time = src.start_time;
+	song->end_time = src.end_time;
+	song->audio_format = src.audio_format;
+	song->target = src.target;
+
 	return song;
 }
 
@@ -99,7 +131,7 @@ Song::Export() const noexcept
 	LightSong dest(uri, tag);
 	dest.directory = parent->IsRoot()
 		? nullptr : parent->GetPath();
-	dest.real_uri = nullptr;
+	dest.real_uri = target.empty() ? nullptr : target.c_str();
 	dest.mtime = mtime;
 	dest.start_time = start_time;
 	dest.end_time = end_time;
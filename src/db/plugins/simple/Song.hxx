@@ -95,6 +95,16 @@ struct Song {
 	 */
 	AudioFormat audio_format = AudioFormat::Undefined();
 
+	/**
+	 * The "real" URI of this song; empty for regular files
+	 * inside the music directory.  It is used for songs inside a
+	 * virtual directory created from a CUE sheet, where #uri is
+	 * just the track name and this attribute points to the audio
+	 * file.  A relative value is resolved against the music
+	 * directory.
+	 */
+	std::string target;
+
 	/**
 	 * The file name.
 	 */
@@ -106,6 +116,14 @@ struct Song {
 	gcc_malloc gcc_returns_nonnull
 	static Song *NewFrom(DetachedSong &&other, Directory &parent);
 
+	/**
+	 * Allocate a duplicate of the given song in (the tree of) the
+	 * given parent directory, with all attributes in freshly
+	 * allocated storage; used by SimpleDatabase::Compact().
+	 */
+	gcc_malloc gcc_returns_nonnull
+	static Song *NewCopy(const Song &src, Directory &parent) noexcept;
+
 	/** allocate a new song with a local file name */
 	gcc_malloc gcc_returns_nonnull
 	static Song *NewFile(const char *path_utf8, Directory &parent);
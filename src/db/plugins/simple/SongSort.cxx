@@ -22,85 +22,86 @@
 #include "tag/Tag.hxx"
 #include "lib/icu/Collate.hxx"
 
-#include <stdlib.h>
-
-static int
-compare_utf8_string(const char *a, const char *b) noexcept
-{
-	if (a == nullptr)
-		return b == nullptr ? 0 : -1;
+#include <algorithm>
+#include <string>
+#include <vector>
 
-	if (b == nullptr)
-		return 1;
-
-	return IcuCollate(a, b);
-}
+#include <stdlib.h>
 
 /**
- * Compare two string tag values, ignoring case.  Either one may be
- * nullptr.
+ * Convert a tag value which should contain an integer value
+ * (e.g. disc or track number); nullptr and non-positive values map to
+ * 0, so they sort first.
  */
-static int
-compare_string_tag_item(const Tag &a, const Tag &b, TagType type) noexcept
+static long
+number_string_value(const char *s) noexcept
 {
-	return compare_utf8_string(a.GetValue(type),
-				   b.GetValue(type));
+	long i = s == nullptr ? 0 : strtol(s, nullptr, 10);
+	return i > 0 ? i : 0;
 }
 
 /**
- * Compare two tag values which should contain an integer value
- * (e.g. disc or track number).  Either one may be nullptr.
+ * The precomputed sort attributes of one #Song.  The collation
+ * transform runs once per song when this struct is built, instead of
+ * once per comparison; the actual sort then only compares plain
+ * integers and collation key bytes.
  */
-static int
-compare_number_string(const char *a, const char *b) noexcept
-{
-	long ai = a == nullptr ? 0 : strtol(a, nullptr, 10);
-	long bi = b == nullptr ? 0 : strtol(b, nullptr, 10);
-
-	if (ai <= 0)
-		return bi <= 0 ? 0 : -1;
-
-	if (bi <= 0)
-		return 1;
-
-	return ai - bi;
-}
+struct SongSortKey {
+	Song *song;
+
+	/**
+	 * Collation key of the album tag, empty if there is none;
+	 * empty sorts first, like a nullptr tag did before.
+	 */
+	std::string album;
+
+	std::string uri;
+
+	long disc, track;
+
+	explicit SongSortKey(Song &_song) noexcept
+		:song(&_song),
+		 uri(IcuCollateKey(_song.uri)),
+		 disc(number_string_value(_song.tag.GetValue(TAG_DISC))),
+		 track(number_string_value(_song.tag.GetValue(TAG_TRACK)))
+	{
+		const char *value = _song.tag.GetValue(TAG_ALBUM);
+		if (value != nullptr)
+			album = IcuCollateKey(value);
+	}
+
+	gcc_pure
+	bool operator<(const SongSortKey &other) const noexcept {
+		/* first sort by album */
+		if (int ret = album.compare(other.album))
+			return ret < 0;
+
+		/* then sort by disc */
+		if (disc != other.disc)
+			return disc < other.disc;
+
+		/* then by track number */
+		if (track != other.track)
+			return track < other.track;
+
+		/* still no difference?  compare file name */
+		return uri < other.uri;
+	}
+};
 
-static int
-compare_tag_item(const Tag &a, const Tag &b, TagType type) noexcept
-{
-	return compare_number_string(a.GetValue(type),
-				     b.GetValue(type));
-}
-
-/* Only used for sorting/searchin a songvec, not general purpose compares */
-gcc_pure
-static bool
-song_cmp(const Song &a, const Song &b) noexcept
+void
+song_list_sort(SongList &songs) noexcept
 {
-	int ret;
-
-	/* first sort by album */
-	ret = compare_string_tag_item(a.tag, b.tag, TAG_ALBUM);
-	if (ret != 0)
-		return ret < 0;
+	std::vector<SongSortKey> keys;
+	keys.reserve(std::distance(songs.begin(), songs.end()));
 
-	/* then sort by disc */
-	ret = compare_tag_item(a.tag, b.tag, TAG_DISC);
-	if (ret != 0)
-		return ret < 0;
+	for (auto &song : songs)
+		keys.emplace_back(song);
 
-	/* then by track number */
-	ret = compare_tag_item(a.tag, b.tag, TAG_TRACK);
-	if (ret != 0)
-		return ret < 0;
+	std::stable_sort(keys.begin(), keys.end());
 
-	/* still no difference?  compare file name */
-	return IcuCollate(a.uri, b.uri) < 0;
-}
-
-void
-song_list_sort(SongList &songs) noexcept
-{
-	songs.sort(song_cmp);
+	/* relink the intrusive list in sorted order */
+	songs.clear();
+	for (const auto &key : keys)
+		songs.push_back(*key.song);
 }
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_TAG_ITEM_ARENA_HXX
+#define MPD_TAG_ITEM_ARENA_HXX
+
+#include <algorithm>
+#include <forward_list>
+#include <memory>
+
+#include <stddef.h>
+
+struct TagItem;
+
+/**
+ * A bump allocator for the #TagItem pointer arrays of all songs in a
+ * #Directory tree.  Packing these small arrays into large blocks
+ * gives better cache locality for database scans and avoids one heap
+ * allocation per song.
+ *
+ * Arrays are never returned individually; all memory is freed
+ * together with the tree.  Arrays of deleted songs are abandoned,
+ * which is acceptable because update churn is small compared to the
+ * database size.
+ *
+ * This class is not thread-safe; only the database load and the
+ * update thread allocate from it, and those never run concurrently.
+ */
+class TagItemArena {
+	std::forward_list<std::unique_ptr<TagItem *[]>> blocks;
+
+	/**
+	 * Number of unused pointers at #next.
+	 */
+	size_t n_remaining = 0;
+
+	/**
+	 * The first unused pointer in the newest block.
+	 */
+	TagItem **next = nullptr;
+
+	static constexpr size_t BLOCK_SIZE = 1024;
+
+public:
+	/**
+	 * Allocate room for n #TagItem pointers.  The memory is
+	 * uninitialized and owned by this object.
+	 */
+	TagItem **Allocate(size_t n) noexcept {
+		if (n > n_remaining) {
+			const size_t block_size = std::max(n, size_t(BLOCK_SIZE));
+			blocks.emplace_front(new TagItem *[block_size]);
+			next = blocks.front().get();
+			n_remaining = block_size;
+		}
+
+		TagItem **result = next;
+		next += n;
+		n_remaining -= n;
+		return result;
+	}
+};
+
+#endif
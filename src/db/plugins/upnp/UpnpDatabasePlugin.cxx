@@ -39,9 +39,13 @@
 #include "tag/Table.hxx"
 #include "tag/Mask.hxx"
 #include "fs/Traits.hxx"
+#include "thread/Mutex.hxx"
 #include "Log.hxx"
 #include "util/SplitString.hxx"
 
+#include <chrono>
+#include <list>
+#include <memory>
 #include <string>
 #include <set>
 
@@ -50,6 +54,41 @@
 
 static const char *const rootid = "0";
 
+/**
+ * How long a cached Browse result remains valid.  UPnP servers do not
+ * push change notifications for individual containers, so this is a
+ * compromise between freshness and network round trips.
+ */
+static constexpr std::chrono::steady_clock::duration UPNP_DIR_CACHE_TTL =
+	std::chrono::minutes(1);
+
+/**
+ * How many Browse results may be cached at a time.
+ */
+static constexpr size_t UPNP_DIR_CACHE_MAX = 128;
+
+/**
+ * A cached Browse result for one container, see
+ * UpnpDatabase::ReadDirCached().
+ */
+struct UpnpCachedDirectory {
+	/**
+	 * The server's friendly name and the ObjectID,
+	 * NUL-separated.
+	 */
+	std::string key;
+
+	std::chrono::steady_clock::time_point expires;
+
+	std::shared_ptr<const UPnPDirContent> content;
+
+	UpnpCachedDirectory(std::string &&_key,
+			    std::chrono::steady_clock::time_point _expires,
+			    std::shared_ptr<const UPnPDirContent> _content) noexcept
+		:key(std::move(_key)), expires(_expires),
+		 content(std::move(_content)) {}
+};
+
 class UpnpSongData {
 protected:
 	std::string uri;
@@ -77,6 +116,17 @@ class UpnpDatabase : public Database {
 	UpnpClient_Handle handle;
 	UPnPDeviceDirectory *discovery;
 
+	/**
+	 * Cached Browse results, most recently used first.  Listing
+	 * a remote container costs one round trip per slice, and
+	 * clients tend to issue bursts of queries which traverse the
+	 * same containers over and over again.  Protected by
+	 * #cache_mutex, because client threads may query
+	 * concurrently; "mutable", because Visit() is const.
+	 */
+	mutable Mutex cache_mutex;
+	mutable std::list<UpnpCachedDirectory> dir_cache;
+
 public:
 	explicit UpnpDatabase(EventLoop &_event_loop) noexcept
 		:Database(upnp_db_plugin),
@@ -131,6 +181,15 @@ private:
 	UPnPDirObject Namei(const ContentDirectoryService &server,
 			    std::forward_list<std::string> &&vpath) const;
 
+	/**
+	 * Like ContentDirectoryService::readDir(), but consults the
+	 * directory cache first, and stores the (shared, read-only)
+	 * result there.
+	 */
+	std::shared_ptr<const UPnPDirContent>
+	ReadDirCached(const ContentDirectoryService &server,
+		      const char *objid) const;
+
 	/**
 	 * Take server and objid, return metadata.
 	 */
@@ -408,6 +467,67 @@ UpnpDatabase::BuildPath(const ContentDirectoryService &server,
 				     path.c_str());
 }
 
+std::shared_ptr<const UPnPDirContent>
+UpnpDatabase::ReadDirCached(const ContentDirectoryService &server,
+			    const char *objid) const
+{
+	std::string key = server.getFriendlyName();
+	key.push_back('\0');
+	key += objid;
+
+	const auto now = std::chrono::steady_clock::now();
+
+	{
+		const std::lock_guard<Mutex> protect(cache_mutex);
+
+		for (auto i = dir_cache.begin(); i != dir_cache.end(); ++i) {
+			if (i->key != key)
+				continue;
+
+			if (i->expires <= now) {
+				dir_cache.erase(i);
+				break;
+			}
+
+			/* move to the front of the LRU list */
+			dir_cache.splice(dir_cache.begin(), dir_cache, i);
+			return dir_cache.front().content;
+		}
+	}
+
+	/* the Browse round trips run without the lock held, so other
+	   client threads can query concurrently */
+	auto content = std::make_shared<const UPnPDirContent>(server.readDir(handle,
+									     objid));
+
+	const std::lock_guard<Mutex> protect(cache_mutex);
+
+	if (dir_cache.size() >= UPNP_DIR_CACHE_MAX)
+		/* evict the least recently used entry */
+		dir_cache.pop_back();
+
+	dir_cache.emplace_front(std::move(key), now + UPNP_DIR_CACHE_TTL,
+				content);
+	return content;
+}
+
+/**
+ * Copy an object out of a shared (read-only) #UPnPDirContent.
+ */
+static UPnPDirObject
+CopyObject(const UPnPDirObject &src) noexcept
+{
+	UPnPDirObject dst;
+	dst.id = src.id;
+	dst.parent_id = src.parent_id;
+	dst.url = src.url;
+	dst.name = src.name;
+	dst.type = src.type;
+	dst.item_class = src.item_class;
+	dst.tag = Tag(src.tag);
+	return dst;
+}
+
 // Take server and internal title pathname and return objid and metadata.
 UPnPDirObject
 UpnpDatabase::Namei(const ContentDirectoryService &server,
@@ -421,23 +541,24 @@ UpnpDatabase::Namei(const ContentDirectoryService &server,
 
 	// Walk the path elements, read each directory and try to find the next one
 	while (true) {
-		auto dirbuf = server.readDir(handle, objid.c_str());
+		const auto dirbuf = ReadDirCached(server, objid.c_str());
 
 		// Look for the name in the sub-container list
-		UPnPDirObject *child = dirbuf.FindObject(vpath.front().c_str());
+		const UPnPDirObject *child =
+			dirbuf->FindObject(vpath.front().c_str());
 		if (child == nullptr)
 			throw DatabaseError(DatabaseErrorCode::NOT_FOUND,
 					    "No such object");
 
 		vpath.pop_front();
 		if (vpath.empty())
-			return std::move(*child);
+			return CopyObject(*child);
 
 		if (child->type != UPnPDirObject::Type::CONTAINER)
 			throw DatabaseError(DatabaseErrorCode::NOT_FOUND,
 					    "Not a container");
 
-		objid = std::move(child->id);
+		objid = child->id;
 	}
 }
 
@@ -567,7 +688,8 @@ UpnpDatabase::VisitServer(const ContentDirectoryService &server,
 	/* Target was a a container. Visit it. We could read slices
 	   and loop here, but it's not useful as mpd will only return
 	   data to the client when we're done anyway. */
-	for (const auto &dirent : server.readDir(handle, tdirent.id.c_str()).objects) {
+	const auto dirbuf = ReadDirCached(server, tdirent.id.c_str());
+	for (const auto &dirent : dirbuf->objects) {
 		const std::string uri = PathTraitsUTF8::Build(base_uri,
 							      dirent.name.c_str());
 		VisitObject(dirent, uri.c_str(),
@@ -28,6 +28,7 @@
 #include "archive/ArchiveList.hxx"
 #include "archive/ArchivePlugin.hxx"
 #include "archive/ArchiveFile.hxx"
+#include "archive/ArchiveCache.hxx"
 #include "archive/ArchiveVisitor.hxx"
 #include "util/StringCompare.hxx"
 #include "Log.hxx"
@@ -90,6 +91,7 @@ UpdateWalk::UpdateArchiveTree(ArchiveFile &archive, Directory &directory,
 				}
 
 				modified = true;
+				AddModifiedSong(directory, name);
 				FormatDefault(update_domain, "added %s/%s",
 					      directory.GetPath(), name);
 			}
@@ -99,7 +101,8 @@ UpdateWalk::UpdateArchiveTree(ArchiveFile &archive, Directory &directory,
 					    "deleting unrecognized file %s/%s",
 					    directory.GetPath(), name);
 				editor.LockDeleteSong(directory, song);
-			}
+			} else
+				AddModifiedSong(directory, name);
 		}
 	}
 }
@@ -148,10 +151,11 @@ UpdateWalk::UpdateArchiveFile(Directory &parent, const char *name,
 		   supports only local files */
 		return;
 
-	/* open archive */
-	std::unique_ptr<ArchiveFile> file;
+	/* open archive; using the cache seeds it for the songs about
+	   to be loaded from this archive */
+	std::shared_ptr<ArchiveFile> file;
 	try {
-		file = archive_file_open(&plugin, path_fs);
+		file = archive_cache_open(plugin, path_fs);
 	} catch (...) {
 		LogError(std::current_exception());
 		if (directory != nullptr)
@@ -34,4 +34,12 @@ UpdateConfig::UpdateConfig(const ConfigData &config)
 #else
 	(void)config;
 #endif
+
+	update_threads = config.GetPositive(ConfigOption::UPDATE_THREADS, 1);
+
+	mixramp_analyzer = config.GetBool(ConfigOption::MIXRAMP_ANALYZER,
+					  false);
+
+	skip_unchanged = config.GetBool(ConfigOption::UPDATE_SKIP_UNCHANGED,
+					false);
 }
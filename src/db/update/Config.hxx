@@ -31,6 +31,28 @@ struct UpdateConfig {
 	bool follow_outside_symlinks = DEFAULT_FOLLOW_OUTSIDE_SYMLINKS;
 #endif
 
+	/**
+	 * The number of threads which walk the music directory
+	 * concurrently during a database update.  The entries of the
+	 * walk root are distributed over this pool, and each worker
+	 * scans its subtree sequentially.
+	 */
+	unsigned update_threads = 1;
+
+	/**
+	 * Shall the update thread analyze songs without MixRamp tags
+	 * after the walk, filling the MixRamp cache?
+	 */
+	bool mixramp_analyzer = false;
+
+	/**
+	 * Shall "update" skip directories whose mtime is unchanged
+	 * since the last scan?  This avoids listing them and calling
+	 * stat on each file, but misses files which were modified in
+	 * place; "rescan" always performs a full walk.
+	 */
+	bool skip_unchanged = false;
+
 	explicit UpdateConfig(const ConfigData &config);
 };
 
@@ -75,6 +75,9 @@ UpdateWalk::UpdateContainerFile(Directory &directory,
 		return false;
 	const DecoderPlugin &plugin = *_plugin;
 
+	if (!decoder_plugin_ensure_initialized(plugin))
+		return false;
+
 	Directory *contdir;
 	{
 		const ScopeDatabaseLock protect;
@@ -117,6 +120,7 @@ UpdateWalk::UpdateContainerFile(Directory &directory,
 			}
 
 			modified = true;
+			AddModifiedSong(*contdir, song->uri);
 		}
 	} catch (...) {
 		LogError(std::current_exception());
@@ -41,10 +41,61 @@ inline void
 ExcludeList::ParseLine(char *line) noexcept
 {
 	char *p = Strip(line);
-	if (*p != 0 && *p != '#')
+	if (*p == 0 || *p == '#')
+		return;
+
+	/* sort each pattern into the cheapest matcher that can
+	   handle it, so Check() doesn't have to interpret wildcards
+	   for every file name */
+
+	const size_t length = strlen(p);
+	const size_t wildcards = strcspn(p, "*?[\\");
+
+	if (wildcards == length)
+		/* no wildcard at all */
+		literals.emplace_back(p);
+	else if (p[wildcards] == '*' && wildcards == length - 1)
+		/* a trailing asterisk is the only wildcard */
+		prefixes.emplace_back(p, length - 1);
+	else if (*p == '*' && strcspn(p + 1, "*?[\\") == length - 1)
+		/* a leading asterisk is the only wildcard */
+		suffixes.emplace_back(p + 1, length - 1);
+	else
 		patterns.emplace_front(p);
 }
 
+gcc_pure
+bool
+ExcludeList::CheckName(const char *name) const noexcept
+{
+	for (const auto &i : literals)
+		if (strcmp(name, i.c_str()) == 0)
+			return true;
+
+	const size_t length = strlen(name);
+
+	for (const auto &i : prefixes)
+		if (length >= i.length() &&
+		    memcmp(name, i.data(), i.length()) == 0)
+			return true;
+
+	for (const auto &i : suffixes)
+		if (length >= i.length() &&
+		    memcmp(name + length - i.length(),
+			   i.data(), i.length()) == 0)
+			return true;
+
+	for (const auto &i : patterns) {
+		try {
+			if (i.Check(name))
+				return true;
+		} catch (...) {
+		}
+	}
+
+	return false;
+}
+
 #endif
 
 bool
@@ -78,13 +129,7 @@ ExcludeList::Check(Path name_fs) const noexcept
 		}
 	}
 
-	for (const auto &i : patterns) {
-		try {
-			if (i.Check(NarrowPath(name_fs).c_str()))
-				return true;
-		} catch (...) {
-		}
-	}
+	return CheckName(NarrowPath(name_fs).c_str());
 #else
 	/* not implemented */
 	(void)name_fs;
@@ -32,6 +32,8 @@
 
 #ifdef HAVE_CLASS_GLOB
 #include <forward_list>
+#include <string>
+#include <vector>
 #endif
 
 class Path;
@@ -40,6 +42,29 @@ class ExcludeList {
 	const ExcludeList *const parent;
 
 #ifdef HAVE_CLASS_GLOB
+	/**
+	 * Patterns without any wildcard, matched by plain string
+	 * comparison.
+	 */
+	std::vector<std::string> literals;
+
+	/**
+	 * Patterns of the form "PREFIX*" (with no other wildcard),
+	 * matched by comparing the beginning of the file name.
+	 */
+	std::vector<std::string> prefixes;
+
+	/**
+	 * Patterns of the form "*SUFFIX" (with no other wildcard),
+	 * matched by comparing the end of the file name.  This is
+	 * the common case ("*.jpg", "*.log", ...).
+	 */
+	std::vector<std::string> suffixes;
+
+	/**
+	 * The remaining patterns which require full wildcard
+	 * matching.
+	 */
 	std::forward_list<Glob> patterns;
 #endif
 
@@ -53,7 +78,9 @@ public:
 	gcc_pure
 	bool IsEmpty() const noexcept {
 #ifdef HAVE_CLASS_GLOB
-		return ((parent == nullptr) || parent->IsEmpty()) && patterns.empty();
+		return ((parent == nullptr) || parent->IsEmpty()) &&
+			literals.empty() && prefixes.empty() &&
+			suffixes.empty() && patterns.empty();
 #else
 		/* not implemented */
 		return true;
@@ -73,6 +100,11 @@ public:
 
 private:
 	void ParseLine(char *line) noexcept;
+
+#ifdef HAVE_CLASS_GLOB
+	gcc_pure
+	bool CheckName(const char *name) const noexcept;
+#endif
 };
 
 
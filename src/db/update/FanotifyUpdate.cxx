@@ -0,0 +1,229 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "FanotifyUpdate.hxx"
+#include "InotifyQueue.hxx"
+#include "InotifyDomain.hxx"
+#include "event/SocketMonitor.hxx"
+#include "storage/StorageInterface.hxx"
+#include "fs/AllocatedPath.hxx"
+#include "system/Error.hxx"
+#include "system/FatalError.hxx"
+#include "util/ScopeExit.hxx"
+#include "util/StringFormat.hxx"
+#include "Log.hxx"
+
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/fanotify.h>
+#include <unistd.h>
+
+/**
+ * Watches the whole file system containing the music directory with a
+ * single FAN_MARK_FILESYSTEM mark and filters events against the
+ * music directory prefix.
+ *
+ * Only FAN_CLOSE_WRITE is requested: the classic (pre-FID) fanotify
+ * API delivers an open file descriptor per event, whose path can be
+ * resolved via /proc/self/fd, but it cannot report renames and
+ * deletions.  Those still require a manual (or periodic) update.
+ */
+class FanotifySource final : private SocketMonitor {
+	InotifyQueue &queue;
+
+	/**
+	 * The absolute path of the music directory, used to filter
+	 * events from elsewhere on the file system.
+	 */
+	const std::string root;
+
+public:
+	/**
+	 * Creates the fanotify group, marks the file system and
+	 * registers the descriptor in the #EventLoop.
+	 *
+	 * Throws #std::system_error if fanotify is unavailable
+	 * (kernel too old, missing CAP_SYS_ADMIN).
+	 */
+	FanotifySource(EventLoop &_loop, InotifyQueue &_queue,
+		       const AllocatedPath &_root);
+
+	~FanotifySource() {
+		Close();
+	}
+
+private:
+	void HandleEvent(const struct fanotify_event_metadata &event) noexcept;
+
+	bool OnSocketReady(unsigned flags) noexcept override;
+};
+
+static FileDescriptor
+FanotifyInit(const char *path_fs)
+{
+	FileDescriptor fd(fanotify_init(FAN_CLOEXEC|FAN_CLASS_NOTIF|FAN_NONBLOCK,
+					O_RDONLY|O_CLOEXEC|O_LARGEFILE|O_NOATIME));
+	if (!fd.IsDefined())
+		throw MakeErrno("fanotify_init() has failed");
+
+	if (fanotify_mark(fd.Get(), FAN_MARK_ADD|FAN_MARK_FILESYSTEM,
+			  FAN_CLOSE_WRITE, AT_FDCWD, path_fs) < 0) {
+		const int e = errno;
+		fd.Close();
+		throw MakeErrno(e, "fanotify_mark() has failed");
+	}
+
+	return fd;
+}
+
+FanotifySource::FanotifySource(EventLoop &_loop, InotifyQueue &_queue,
+			       const AllocatedPath &_root)
+	:SocketMonitor(SocketDescriptor::FromFileDescriptor(FanotifyInit(_root.c_str())),
+		       _loop),
+	 queue(_queue), root(_root.c_str())
+{
+	ScheduleRead();
+}
+
+inline void
+FanotifySource::HandleEvent(const struct fanotify_event_metadata &event) noexcept
+{
+	if (event.fd < 0) {
+		/* queue overflow (FAN_NOFD): force a full rescan to
+		   be safe */
+		queue.Enqueue("");
+		return;
+	}
+
+	AtScopeExit(&event) { close(event.fd); };
+
+	if (pid_t(event.pid) == getpid())
+		/* ignore events triggered by this process */
+		return;
+
+	/* resolve the event's file descriptor to a path */
+
+	char path[PATH_MAX];
+	const auto proc_path = StringFormat<64>("/proc/self/fd/%d", event.fd);
+	ssize_t nbytes = readlink(proc_path.c_str(),
+				  path, sizeof(path) - 1);
+	if (nbytes <= 0)
+		return;
+
+	path[nbytes] = 0;
+
+	/* the mark covers the whole file system: skip everything
+	   outside of the music directory */
+
+	const size_t root_length = root.length();
+	if (strncmp(path, root.c_str(), root_length) != 0 ||
+	    path[root_length] != '/')
+		return;
+
+	/* enqueue an update of the file's parent directory */
+
+	char *relative = path + root_length + 1;
+	char *slash = strrchr(relative, '/');
+	if (slash == nullptr) {
+		/* a file directly inside the music directory */
+		queue.Enqueue("");
+		return;
+	}
+
+	*slash = 0;
+
+	const auto uri_utf8 = Path::FromFS(relative).ToUTF8();
+	if (!uri_utf8.empty())
+		queue.Enqueue(uri_utf8.c_str());
+}
+
+bool
+FanotifySource::OnSocketReady(gcc_unused unsigned flags) noexcept
+{
+	uint8_t buffer[16384];
+
+	auto fd = GetSocket().ToFileDescriptor();
+	ssize_t nbytes = fd.Read(buffer, sizeof(buffer));
+	if (nbytes < 0)
+		FatalSystemError("Failed to read from fanotify");
+	if (nbytes == 0)
+		FatalError("end of file from fanotify");
+
+	const auto *event = (const struct fanotify_event_metadata *)buffer;
+	while (FAN_EVENT_OK(event, nbytes)) {
+		if (event->vers == FANOTIFY_METADATA_VERSION)
+			HandleEvent(*event);
+		else if (event->fd >= 0)
+			close(event->fd);
+
+		event = FAN_EVENT_NEXT(event, nbytes);
+	}
+
+	return true;
+}
+
+static FanotifySource *fanotify_source;
+static InotifyQueue *fanotify_queue;
+
+bool
+mpd_fanotify_init(EventLoop &loop, Storage &storage,
+		  UpdateService &update) noexcept
+{
+	LogDebug(inotify_domain, "initializing fanotify");
+
+	const auto path = storage.MapFS("");
+	if (path.IsNull()) {
+		LogDebug(inotify_domain, "no music directory configured");
+		return false;
+	}
+
+	fanotify_queue = new InotifyQueue(loop, update);
+
+	try {
+		fanotify_source = new FanotifySource(loop, *fanotify_queue,
+						     path);
+	} catch (...) {
+		LogError(std::current_exception(),
+			 "fanotify is unavailable, falling back to inotify");
+		delete fanotify_queue;
+		fanotify_queue = nullptr;
+		return false;
+	}
+
+	LogDebug(inotify_domain, "watching music directory (fanotify)");
+	return true;
+}
+
+void
+mpd_fanotify_finish() noexcept
+{
+	if (fanotify_source == nullptr)
+		return;
+
+	delete fanotify_source;
+	fanotify_source = nullptr;
+
+	delete fanotify_queue;
+	fanotify_queue = nullptr;
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_FANOTIFY_UPDATE_HXX
+#define MPD_FANOTIFY_UPDATE_HXX
+
+#include "util/Compiler.h"
+
+class EventLoop;
+class Storage;
+class UpdateService;
+
+/**
+ * Start watching the music directory with fanotify
+ * (FAN_MARK_FILESYSTEM): one kernel mark covers the whole file
+ * system, so setup cost and kernel memory usage do not grow with the
+ * number of directories, unlike the per-directory inotify watches.
+ *
+ * Requires Linux 4.20 and CAP_SYS_ADMIN.
+ *
+ * @return true on success; false if fanotify is unavailable and the
+ * caller should fall back to inotify
+ */
+bool
+mpd_fanotify_init(EventLoop &loop, Storage &storage,
+		  UpdateService &update) noexcept;
+
+void
+mpd_fanotify_finish() noexcept;
+
+#endif
@@ -24,6 +24,8 @@
 #include "protocol/Ack.hxx" // for class ProtocolError
 #include "util/StringCompare.hxx"
 
+#include <algorithm>
+
 /**
  * Wait this long after the last change before calling
  * UpdateService::Enqueue().  This increases the probability that
@@ -32,6 +34,13 @@
 static constexpr std::chrono::steady_clock::duration INOTIFY_UPDATE_DELAY =
 	std::chrono::seconds(5);
 
+/**
+ * If more paths than this are pending, collapse them all into their
+ * common ancestor directory, so a bulk import triggers one recursive
+ * update job instead of thousands of small ones.
+ */
+static constexpr size_t INOTIFY_MAX_QUEUED_PATHS = 64;
+
 void
 InotifyQueue::OnDelay() noexcept
 {
@@ -66,6 +75,42 @@ InotifyQueue::OnDelay() noexcept
 	}
 }
 
+/**
+ * Determine the deepest directory which contains both URIs.
+ */
+gcc_pure
+static std::string
+CommonUriAncestor(const std::string &a, const std::string &b) noexcept
+{
+	const size_t n = std::min(a.length(), b.length());
+
+	/* the length of the longest common prefix ending at a
+	   directory boundary */
+	size_t boundary = 0;
+
+	size_t i = 0;
+	for (; i < n; ++i) {
+		if (a[i] != b[i])
+			break;
+
+		if (a[i] == '/')
+			boundary = i;
+	}
+
+	if (i == n) {
+		if (a.length() == b.length())
+			return a;
+
+		const std::string &longer = a.length() > b.length() ? a : b;
+		if (longer[n] == '/')
+			/* the shorter URI is an ancestor of the
+			   longer one */
+			boundary = n;
+	}
+
+	return {a, 0, boundary};
+}
+
 gcc_pure
 static bool
 path_in(const char *path, const char *possible_parent) noexcept
@@ -100,4 +145,22 @@ InotifyQueue::Enqueue(const char *uri_utf8)
 	}
 
 	queue.emplace_back(uri_utf8);
+
+	if (queue.size() > INOTIFY_MAX_QUEUED_PATHS) {
+		/* too many pending paths - collapse them into their
+		   common ancestor (the empty string means the whole
+		   music directory) */
+		std::string ancestor = std::move(queue.front());
+		queue.pop_front();
+
+		for (const auto &i : queue)
+			ancestor = CommonUriAncestor(ancestor, i);
+
+		FormatDebug(inotify_domain,
+			    "collapsing %u pending paths into '%s'",
+			    unsigned(queue.size() + 1), ancestor.c_str());
+
+		queue.clear();
+		queue.emplace_back(std::move(ancestor));
+	}
 }
@@ -0,0 +1,306 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "Walk.hxx"
+#include "UpdateDomain.hxx"
+#include "MixRampCache.hxx"
+#include "MixRampInfo.hxx"
+#include "db/DatabaseLock.hxx"
+#include "db/plugins/simple/Directory.hxx"
+#include "db/plugins/simple/Song.hxx"
+#include "storage/StorageInterface.hxx"
+#include "decoder/Client.hxx"
+#include "decoder/DecoderList.hxx"
+#include "decoder/DecoderPlugin.hxx"
+#include "input/InputStream.hxx"
+#include "pcm/MixRampAnalyzer.hxx"
+#include "pcm/PcmConvert.hxx"
+#include "thread/Mutex.hxx"
+#include "util/ConstBuffer.hxx"
+#include "util/UriUtil.hxx"
+#include "Log.hxx"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * A #DecoderClient implementation which discards the decoded PCM
+ * data after feeding it to a #MixRampAnalyzer.
+ */
+class MixRampScanClient final : public DecoderClient {
+	const std::atomic_bool &cancel;
+
+	std::unique_ptr<MixRampAnalyzer> analyzer;
+
+	PcmConvert convert;
+	bool converting = false;
+
+	bool failed = false;
+
+	/**
+	 * MixRamp data submitted by the decoder plugin (i.e. the
+	 * song has real MixRamp tags); takes precedence over the
+	 * analyzer's result.
+	 */
+	MixRampInfo tag_info;
+
+public:
+	Mutex mutex;
+
+	explicit MixRampScanClient(const std::atomic_bool &_cancel) noexcept
+		:cancel(_cancel) {}
+
+	~MixRampScanClient() noexcept {
+		if (converting)
+			convert.Close();
+	}
+
+	MixRampInfo Finish() noexcept {
+		if (tag_info.IsDefined())
+			return std::move(tag_info);
+
+		if (failed || !analyzer)
+			return MixRampInfo();
+
+		return analyzer->Finish();
+	}
+
+	/* virtual methods from DecoderClient */
+	void Ready(AudioFormat audio_format,
+		   bool seekable, SignedSongTime duration) override;
+	DecoderCommand GetCommand() noexcept override;
+	void CommandFinished() override;
+	SongTime GetSeekTime() noexcept override;
+	uint64_t GetSeekFrame() noexcept override;
+	void SeekError() override;
+	InputStreamPtr OpenUri(const char *uri) override;
+	size_t Read(InputStream &is, void *buffer, size_t length) override;
+	void SubmitTimestamp(FloatDuration t) override;
+	DecoderCommand SubmitData(InputStream *is,
+				  const void *data, size_t length,
+				  uint16_t kbit_rate) override;
+	DecoderCommand SubmitTag(InputStream *is, Tag &&tag) override;
+	void SubmitReplayGain(const ReplayGainInfo *replay_gain_info) override;
+	void SubmitMixRamp(MixRampInfo &&mix_ramp) override;
+};
+
+void
+MixRampScanClient::Ready(const AudioFormat audio_format,
+			 gcc_unused bool seekable,
+			 gcc_unused SignedSongTime duration)
+{
+	AudioFormat analyze_format = audio_format;
+	analyze_format.format = SampleFormat::S16;
+
+	if (audio_format != analyze_format) {
+		try {
+			convert.Open(audio_format, analyze_format);
+			converting = true;
+		} catch (...) {
+			failed = true;
+			return;
+		}
+	}
+
+	analyzer = std::make_unique<MixRampAnalyzer>(analyze_format);
+}
+
+DecoderCommand
+MixRampScanClient::GetCommand() noexcept
+{
+	return cancel || failed
+		? DecoderCommand::STOP
+		: DecoderCommand::NONE;
+}
+
+void
+MixRampScanClient::CommandFinished()
+{
+}
+
+SongTime
+MixRampScanClient::GetSeekTime() noexcept
+{
+	return SongTime();
+}
+
+uint64_t
+MixRampScanClient::GetSeekFrame() noexcept
+{
+	return 1;
+}
+
+void
+MixRampScanClient::SeekError()
+{
+}
+
+InputStreamPtr
+MixRampScanClient::OpenUri(const char *uri)
+{
+	return InputStream::OpenReady(uri, mutex);
+}
+
+size_t
+MixRampScanClient::Read(InputStream &is, void *buffer, size_t length)
+{
+	try {
+		return is.LockRead(buffer, length);
+	} catch (...) {
+		return 0;
+	}
+}
+
+void
+MixRampScanClient::SubmitTimestamp(gcc_unused FloatDuration t)
+{
+}
+
+DecoderCommand
+MixRampScanClient::SubmitData(gcc_unused InputStream *is,
+			      const void *data, size_t length,
+			      gcc_unused uint16_t kbit_rate)
+{
+	if (analyzer && !failed) {
+		ConstBuffer<void> src(data, length);
+
+		if (converting) {
+			try {
+				src = convert.Convert(src);
+			} catch (...) {
+				failed = true;
+				return DecoderCommand::STOP;
+			}
+		}
+
+		analyzer->Process(ConstBuffer<int16_t>::FromVoid(src));
+	}
+
+	return GetCommand();
+}
+
+DecoderCommand
+MixRampScanClient::SubmitTag(gcc_unused InputStream *is,
+			     gcc_unused Tag &&tag)
+{
+	return GetCommand();
+}
+
+void
+MixRampScanClient::SubmitReplayGain(gcc_unused const ReplayGainInfo *replay_gain_info)
+{
+}
+
+void
+MixRampScanClient::SubmitMixRamp(MixRampInfo &&mix_ramp)
+{
+	tag_info = std::move(mix_ramp);
+}
+
+/**
+ * Decode the given song and compute its MixRamp data.  Returns an
+ * undefined #MixRampInfo if the song cannot be analyzed.
+ *
+ * Throws on I/O error.
+ */
+static MixRampInfo
+AnalyzeSong(Storage &storage, const char *uri,
+	    const std::atomic_bool &cancel)
+{
+	UriSuffixBuffer suffix_buffer;
+	const char *suffix = uri_get_suffix(uri, suffix_buffer);
+	if (suffix == nullptr)
+		return MixRampInfo();
+
+	const auto *plugin = decoder_plugins_find([suffix](const DecoderPlugin &p){
+			return p.stream_decode != nullptr &&
+				p.SupportsSuffix(suffix);
+		});
+	if (plugin == nullptr)
+		return MixRampInfo();
+
+	if (!decoder_plugin_ensure_initialized(*plugin))
+		return MixRampInfo();
+
+	MixRampScanClient client(cancel);
+	auto is = InputStream::OpenReady(storage.MapUTF8(uri).c_str(),
+					 client.mutex);
+	plugin->StreamDecode(client, *is);
+	return client.Finish();
+}
+
+/**
+ * Collect the URIs of all songs which have no MixRamp cache entry
+ * yet.  Caller must lock the #db_mutex.
+ */
+static void
+CollectMissing(const Directory &directory, std::vector<std::string> &uris) noexcept
+{
+	for (const Song &song : directory.songs) {
+		auto uri = song.GetURI();
+		if (!mixramp_cache_contains(uri.c_str()))
+			uris.emplace_back(std::move(uri));
+	}
+
+	for (const Directory &child : directory.children) {
+		if (child.IsMount())
+			/* mounted databases are updated (and
+			   analyzed) separately */
+			continue;
+
+		CollectMissing(child, uris);
+	}
+}
+
+void
+UpdateWalk::RunMixRampScan(Directory &root) noexcept
+{
+	if (!config.mixramp_analyzer || !mixramp_cache_enabled())
+		return;
+
+	std::vector<std::string> uris;
+
+	{
+		const ScopeDatabaseLock protect;
+		CollectMissing(root, uris);
+	}
+
+	if (uris.empty())
+		return;
+
+	FormatDebug(update_domain, "analyzing MixRamp data of %u songs",
+		    unsigned(uris.size()));
+
+	for (const auto &uri : uris) {
+		if (cancel)
+			break;
+
+		try {
+			auto info = AnalyzeSong(storage, uri.c_str(), cancel);
+			if (info.IsDefined())
+				mixramp_cache_put(uri.c_str(), info);
+		} catch (...) {
+			FormatError(std::current_exception(),
+				    "Failed to analyze '%s'", uri.c_str());
+		}
+	}
+
+	mixramp_cache_save();
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "Walk.hxx"
+#include "UpdateDomain.hxx"
+#include "song/DetachedSong.hxx"
+#include "db/DatabaseLock.hxx"
+#include "db/plugins/simple/Directory.hxx"
+#include "db/plugins/simple/Song.hxx"
+#include "storage/StorageInterface.hxx"
+#include "playlist/PlaylistStream.hxx"
+#include "playlist/SongEnumerator.hxx"
+#include "fs/AllocatedPath.hxx"
+#include "fs/Traits.hxx"
+#include "storage/FileInfo.hxx"
+#include "thread/Mutex.hxx"
+#include "util/StringFormat.hxx"
+#include "util/UriUtil.hxx"
+#include "Log.hxx"
+
+bool
+UpdateWalk::ExpandCueSheet(Directory &directory,
+			   const char *name,
+			   const StorageFileInfo &info) noexcept
+{
+	Directory *contdir;
+	{
+		const ScopeDatabaseLock protect;
+		contdir = MakeDirectoryIfModified(directory, name, info);
+		if (contdir == nullptr)
+			/* not modified */
+			return true;
+
+		contdir->device = DEVICE_CONTAINER;
+	}
+
+	const auto pathname = storage.MapFS(contdir->GetPath());
+	if (pathname.IsNull()) {
+		/* not a local file: skip, because the playlist API
+		   supports only local files */
+		editor.LockDeleteDirectory(contdir);
+		return false;
+	}
+
+	try {
+		Mutex mutex;
+		auto e = playlist_open_path(pathname, mutex);
+		if (e == nullptr) {
+			editor.LockDeleteDirectory(contdir);
+			return false;
+		}
+
+		unsigned track = 0;
+
+		std::unique_ptr<DetachedSong> vtrack;
+		while ((vtrack = e->NextSong()) != nullptr) {
+			/* the CUE sheet refers to the audio file
+			   relative to its own directory; remember
+			   that reference as the new song's "target"
+			   (relative to the music directory) and use a
+			   synthesized track name as its URI, because
+			   all tracks usually point to the same
+			   file */
+			const char *uri = vtrack->GetURI();
+			if (!uri_has_scheme(uri) &&
+			    !PathTraitsUTF8::IsAbsolute(uri) &&
+			    !directory.IsRoot())
+				vtrack->SetRealURI(PathTraitsUTF8::Build(directory.GetPath(),
+									 uri));
+			else
+				vtrack->SetRealURI(uri);
+
+			vtrack->SetURI(StringFormat<32>("track%04u",
+							++track).c_str());
+
+			Song *song = Song::NewFrom(std::move(*vtrack),
+						   *contdir);
+			song->mtime = info.mtime;
+
+			FormatDefault(update_domain, "added %s/%s",
+				      contdir->GetPath(), song->uri);
+
+			{
+				const ScopeDatabaseLock protect;
+				contdir->AddSong(song);
+			}
+
+			modified = true;
+			AddModifiedSong(*contdir, song->uri);
+		}
+
+		if (track == 0) {
+			editor.LockDeleteDirectory(contdir);
+			return false;
+		}
+	} catch (...) {
+		LogError(std::current_exception());
+		editor.LockDeleteDirectory(contdir);
+		return false;
+	}
+
+	return true;
+}
@@ -30,17 +30,6 @@ UpdateQueue::Push(SimpleDatabase &db, Storage &storage,
 	return true;
 }
 
-UpdateQueueItem
-UpdateQueue::Pop()
-{
-	if (update_queue.empty())
-		return UpdateQueueItem();
-
-	auto i = std::move(update_queue.front());
-	update_queue.pop_front();
-	return i;
-}
-
 void
 UpdateQueue::Erase(SimpleDatabase &db)
 {
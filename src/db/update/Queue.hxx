@@ -64,7 +64,24 @@ public:
 	bool Push(SimpleDatabase &db, Storage &storage,
 		  const char *path, bool discard, unsigned id);
 
-	UpdateQueueItem Pop();
+	/**
+	 * Remove and return the first item matching the given
+	 * predicate.  Returns an undefined item if there is none.
+	 */
+	template<typename P>
+	UpdateQueueItem Pop(P &&predicate) {
+		for (auto i = update_queue.begin(),
+			     end = update_queue.end();
+		     i != end; ++i) {
+			if (predicate(*i)) {
+				auto item = std::move(*i);
+				update_queue.erase(i);
+				return item;
+			}
+		}
+
+		return UpdateQueueItem();
+	}
 
 	void Clear() {
 		update_queue.clear();
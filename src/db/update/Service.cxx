@@ -38,6 +38,21 @@
 
 #include <assert.h>
 
+UpdateService::Job::Job(UpdateService &_service, UpdateQueueItem &&_item)
+	:service(_service), item(std::move(_item)),
+	 walk(new UpdateWalk(service.config, service.GetEventLoop(),
+			     service.listener, *item.storage)),
+	 thread(BIND_THIS_METHOD(Task))
+{
+}
+
+UpdateService::Job::~Job() noexcept
+{
+	assert(!thread.IsDefined());
+
+	delete walk;
+}
+
 UpdateService::UpdateService(const ConfigData &_config,
 			     EventLoop &_loop, SimpleDatabase &_db,
 			     CompositeStorage &_storage,
@@ -45,8 +60,7 @@ UpdateService::UpdateService(const ConfigData &_config,
 	:config(_config),
 	 defer(_loop, BIND_THIS_METHOD(RunDeferred)),
 	 db(_db), storage(_storage),
-	 listener(_listener),
-	 update_thread(BIND_THIS_METHOD(Task))
+	 listener(_listener)
 {
 }
 
@@ -54,10 +68,9 @@ UpdateService::~UpdateService()
 {
 	CancelAllAsync();
 
-	if (update_thread.IsDefined())
-		update_thread.Join();
-
-	delete walk;
+	for (auto &job : jobs)
+		if (job.thread.IsDefined())
+			job.thread.Join();
 }
 
 void
@@ -67,8 +80,8 @@ UpdateService::CancelAllAsync()
 
 	queue.Clear();
 
-	if (walk != nullptr)
-		walk->Cancel();
+	for (auto &job : jobs)
+		job.walk->Cancel();
 }
 
 void
@@ -86,77 +99,118 @@ UpdateService::CancelMount(const char *uri)
 	if (!lr.directory->IsMount())
 		return;
 
-	bool cancel_current = false;
-
 	Storage *storage2 = storage.GetMount(uri);
-	if (storage2 != nullptr) {
+	if (storage2 != nullptr)
 		queue.Erase(*storage2);
-		cancel_current = next.IsDefined() && next.storage == storage2;
-	}
 
-	if (auto *db2 = dynamic_cast<SimpleDatabase *>(lr.directory->mounted_database.get())) {
+	auto *db2 = dynamic_cast<SimpleDatabase *>(lr.directory->mounted_database.get());
+	if (db2 != nullptr)
 		queue.Erase(*db2);
-		cancel_current |= next.IsDefined() && next.db == db2;
-	}
 
-	if (cancel_current && walk != nullptr) {
-		walk->Cancel();
-
-		if (update_thread.IsDefined())
-			update_thread.Join();
+	for (auto i = jobs.begin(); i != jobs.end();) {
+		if ((storage2 != nullptr && i->item.storage == storage2) ||
+		    (db2 != nullptr && i->item.db == db2)) {
+			i->walk->Cancel();
+			i = RemoveJob(i);
+		} else
+			++i;
 	}
 }
 
 inline void
-UpdateService::Task()
+UpdateService::Job::Task() noexcept
 {
-	assert(walk != nullptr);
-
 	SetThreadName("update");
 
-	if (!next.path_utf8.empty())
+	if (!item.path_utf8.empty())
 		FormatDebug(update_domain, "starting: %s",
-			    next.path_utf8.c_str());
+			    item.path_utf8.c_str());
 	else
 		LogDebug(update_domain, "starting");
 
 	SetThreadIdlePriority();
 
-	modified = walk->Walk(next.db->GetRoot(), next.path_utf8.c_str(),
-			      next.discard);
+	modified = walk->Walk(item.db->GetRoot(), item.path_utf8.c_str(),
+			      item.discard);
 
-	if (modified || !next.db->FileExists()) {
+	if (modified) {
+		modified_uris = walk->TakeModifiedUris();
+		modified_uris_complete = !walk->HasModifiedUriOverflow();
+	}
+
+	if (modified || !item.db->FileExists()) {
 		try {
-			next.db->Save();
+			item.db->Save();
 		} catch (const std::exception &e) {
 			LogError(e, "Failed to save database");
 		}
 	}
 
-	if (!next.path_utf8.empty())
+	/* the update thread is idle now - run the (optional) MixRamp
+	   analyzer on songs which have no cached data yet */
+	walk->RunMixRampScan(item.db->GetRoot());
+
+	if (!item.path_utf8.empty())
 		FormatDebug(update_domain, "finished: %s",
-			    next.path_utf8.c_str());
+			    item.path_utf8.c_str());
 	else
 		LogDebug(update_domain, "finished");
 
-	defer.Schedule();
+	done = true;
+	service.defer.Schedule();
+}
+
+bool
+UpdateService::CanStartJob(const SimpleDatabase *db2,
+			   const Storage *storage2) const noexcept
+{
+	for (const auto &job : jobs)
+		if (job.item.db == db2 || job.item.storage == storage2)
+			return false;
+
+	return true;
 }
 
 void
 UpdateService::StartThread(UpdateQueueItem &&i)
 {
 	assert(GetEventLoop().IsInside());
-	assert(walk == nullptr);
-
-	modified = false;
+	assert(CanStartJob(i.db, i.storage));
 
-	next = std::move(i);
-	walk = new UpdateWalk(config, GetEventLoop(), listener, *next.storage);
+	jobs.emplace_back(*this, std::move(i));
 
-	update_thread.Start();
+	auto &job = jobs.back();
+	job.Start();
 
 	FormatDebug(update_domain,
-		    "spawned thread for update job id %i", next.id);
+		    "spawned thread for update job id %i", job.item.id);
+}
+
+std::list<UpdateService::Job>::iterator
+UpdateService::RemoveJob(std::list<Job>::iterator i) noexcept
+{
+	assert(GetEventLoop().IsInside());
+
+	if (i->thread.IsDefined())
+		i->thread.Join();
+
+	idle_add(IDLE_UPDATE);
+
+	if (i->modified) {
+		if (i->modified_uris_complete && i->item.db == &db)
+			/* the exact set of modified songs is known
+			   and its URIs are relative to the root
+			   database: deliver them, so listeners can
+			   refresh only the affected entries; mounted
+			   databases would require URI translation and
+			   take the generic path */
+			listener.OnDatabaseSongsChanged(std::move(i->modified_uris));
+		else
+			/* send "idle" events */
+			listener.OnDatabaseModified();
+	}
+
+	return jobs.erase(i);
 }
 
 unsigned
@@ -216,7 +270,9 @@ UpdateService::Enqueue(const char *path, bool discard)
 		   happen */
 		throw std::runtime_error("No storage at this path");
 
-	if (walk != nullptr) {
+	if (!CanStartJob(db2, storage2)) {
+		/* a job on the same database/storage is already
+		   running; queue this path behind it */
 		const unsigned id = GenerateId();
 		if (!queue.Push(*db2, *storage2, path, discard, id))
 			throw ProtocolError(ACK_ERROR_UPDATE_ALREADY,
@@ -235,33 +291,28 @@ UpdateService::Enqueue(const char *path, bool discard)
 }
 
 /**
- * Called in the main thread after the database update is finished.
+ * Called in the main thread after a database update has finished.
  */
 void
 UpdateService::RunDeferred() noexcept
 {
-	assert(next.IsDefined());
-	assert(walk != nullptr);
-
-	/* wait for thread to finish only if it wasn't cancelled by
-	   CancelMount() */
-	if (update_thread.IsDefined())
-		update_thread.Join();
-
-	delete walk;
-	walk = nullptr;
-
-	next.Clear();
-
-	idle_add(IDLE_UPDATE);
+	/* reap all jobs whose thread has finished */
+	for (auto i = jobs.begin(); i != jobs.end();) {
+		if (i->done)
+			i = RemoveJob(i);
+		else
+			++i;
+	}
 
-	if (modified)
-		/* send "idle" events */
-		listener.OnDatabaseModified();
+	/* schedule queued paths which no longer collide with a
+	   running job */
+	while (true) {
+		auto i = queue.Pop([this](const UpdateQueueItem &item){
+			return CanStartJob(item.db, item.storage);
+		});
+		if (!i.IsDefined())
+			break;
 
-	auto i = queue.Pop();
-	if (i.IsDefined()) {
-		/* schedule the next path */
 		StartThread(std::move(i));
 	}
 }
@@ -26,13 +26,18 @@
 #include "thread/Thread.hxx"
 #include "util/Compiler.h"
 
+#include <atomic>
+#include <list>
+#include <string>
+#include <vector>
+
 class SimpleDatabase;
 class DatabaseListener;
 class UpdateWalk;
 class CompositeStorage;
 
 /**
- * This class manages the update queue and runs the update thread.
+ * This class manages the update queue and runs the update threads.
  */
 class UpdateService final {
 	const UpdateConfig config;
@@ -44,19 +49,65 @@ class UpdateService final {
 
 	DatabaseListener &listener;
 
-	bool modified;
-
-	Thread update_thread;
-
 	static constexpr unsigned update_task_id_max = 1 << 15;
 
 	unsigned update_task_id = 0;
 
 	UpdateQueue queue;
 
-	UpdateQueueItem next;
+	/**
+	 * A running update job: one thread walking one storage.
+	 * Jobs on disjoint databases/storages (i.e. different mount
+	 * points) run concurrently; they synchronize only on the
+	 * global database lock.
+	 */
+	struct Job {
+		UpdateService &service;
+
+		const UpdateQueueItem item;
+
+		UpdateWalk *const walk;
+
+		Thread thread;
+
+		/**
+		 * Was the database modified by this job?
+		 */
+		bool modified = false;
+
+		/**
+		 * The database URIs of all songs added or updated by
+		 * this job, if that list is complete; see
+		 * UpdateWalk::TakeModifiedUris().
+		 */
+		std::vector<std::string> modified_uris;
+
+		/**
+		 * Is #modified_uris complete, i.e. did the walk track
+		 * every modified song?
+		 */
+		bool modified_uris_complete = false;
 
-	UpdateWalk *walk = nullptr;
+		/**
+		 * Set by the thread right before it exits; tells
+		 * RunDeferred() that this job may be joined and
+		 * removed.
+		 */
+		std::atomic_bool done{false};
+
+		Job(UpdateService &_service, UpdateQueueItem &&_item);
+		~Job() noexcept;
+
+		void Start() {
+			thread.Start();
+		}
+
+	private:
+		/* the update thread */
+		void Task() noexcept;
+	};
+
+	std::list<Job> jobs;
 
 public:
 	UpdateService(const ConfigData &_config,
@@ -72,10 +123,11 @@ public:
 
 	/**
 	 * Returns a non-zero job id when we are currently updating
-	 * the database.
+	 * the database.  With multiple concurrent jobs, the oldest
+	 * one is reported.
 	 */
 	unsigned GetId() const {
-		return next.id;
+		return jobs.empty() ? 0 : jobs.front().item.id;
 	}
 
 	/**
@@ -91,8 +143,8 @@ public:
 	unsigned Enqueue(const char *path, bool discard);
 
 	/**
-	 * Clear the queue and cancel the current update.  Does not
-	 * wait for the thread to exit.
+	 * Clear the queue and cancel all running updates.  Does not
+	 * wait for the threads to exit.
 	 */
 	void CancelAllAsync();
 
@@ -107,11 +159,25 @@ private:
 	/* DeferEvent callback */
 	void RunDeferred() noexcept;
 
-	/* the update thread */
-	void Task();
+	/**
+	 * May a job for the given database/storage start right now,
+	 * i.e. does it collide with no running job?
+	 */
+	gcc_pure
+	bool CanStartJob(const SimpleDatabase *db2,
+			 const Storage *storage2) const noexcept;
 
 	void StartThread(UpdateQueueItem &&i);
 
+	/**
+	 * Join the given job's thread, deliver its events and remove
+	 * it from the list.  Caller must be inside the #EventLoop
+	 * thread.
+	 *
+	 * @return the iterator following the removed job
+	 */
+	std::list<Job>::iterator RemoveJob(std::list<Job>::iterator i) noexcept;
+
 	unsigned GenerateId();
 };
 
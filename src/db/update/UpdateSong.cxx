@@ -75,6 +75,7 @@ UpdateWalk::UpdateSongFile2(Directory &directory,
 		}
 
 		modified = true;
+		AddModifiedSong(directory, name);
 		FormatDefault(update_domain, "added %s/%s",
 			      directory.GetPath(), name);
 	} else if (info.mtime != song->mtime || walk_discard) {
@@ -85,7 +86,8 @@ UpdateWalk::UpdateSongFile2(Directory &directory,
 				    "deleting unrecognized file %s/%s",
 				    directory.GetPath(), name);
 			editor.LockDeleteSong(directory, song);
-		}
+		} else
+			AddModifiedSong(directory, name);
 
 		modified = true;
 	}
@@ -36,12 +36,19 @@
 #include "input/InputStream.hxx"
 #include "input/Error.hxx"
 #include "util/Alloc.hxx"
+#include "util/ASCII.hxx"
 #include "util/StringCompare.hxx"
 #include "util/UriUtil.hxx"
+#include "thread/Mutex.hxx"
+#include "thread/Thread.hxx"
 #include "Log.hxx"
 
+#include <forward_list>
 #include <stdexcept>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include <assert.h>
 #include <string.h>
@@ -57,6 +64,35 @@ UpdateWalk::UpdateWalk(const UpdateConfig &_config,
 {
 }
 
+void
+UpdateWalk::AddModifiedSong(const Directory &parent,
+			    const char *name) noexcept
+{
+	const std::lock_guard<Mutex> protect(modified_uris_mutex);
+
+	if (modified_uris_overflow)
+		return;
+
+	if (modified_uris.size() >= MAX_MODIFIED_URIS) {
+		/* too many changes to track individually; consumers
+		   will fall back to a full refresh */
+		modified_uris.clear();
+		modified_uris_overflow = true;
+		return;
+	}
+
+	modified_uris.emplace_back(PathTraitsUTF8::Build(parent.GetPath(),
+							 name));
+}
+
+std::vector<std::string>
+UpdateWalk::TakeModifiedUris() noexcept
+{
+	const std::lock_guard<Mutex> protect(modified_uris_mutex);
+
+	return std::move(modified_uris);
+}
+
 static void
 directory_set_stat(Directory &dir, const StorageFileInfo &info)
 {
@@ -92,10 +128,23 @@ UpdateWalk::RemoveExcludedFromDirectory(Directory &directory,
 }
 
 inline void
-UpdateWalk::PurgeDeletedFromDirectory(Directory &directory) noexcept
+UpdateWalk::PurgeDeletedFromDirectory(Directory &directory,
+				      const std::set<std::string> &directories,
+				      const std::set<std::string> &files) noexcept
 {
 	directory.ForEachChildSafe([&](Directory &child){
-			if (child.IsMount() || DirectoryExists(storage, child))
+			if (child.IsMount())
+				return;
+
+			/* archive and container entries are backed
+			   by a regular file */
+			const auto &present =
+				child.device == DEVICE_INARCHIVE ||
+				child.device == DEVICE_CONTAINER
+				? files
+				: directories;
+
+			if (present.find(child.GetName()) != present.end())
 				return;
 
 			editor.LockDeleteDirectory(&child);
@@ -104,8 +153,7 @@ UpdateWalk::PurgeDeletedFromDirectory(Directory &directory) noexcept
 		});
 
 	directory.ForEachSongSafe([&](Song &song){
-			if (!directory_child_is_regular(storage, directory,
-							song.uri)) {
+			if (files.find(song.uri) == files.end()) {
 				editor.LockDeleteSong(directory, &song);
 
 				modified = true;
@@ -115,8 +163,7 @@ UpdateWalk::PurgeDeletedFromDirectory(Directory &directory) noexcept
 	for (auto i = directory.playlists.begin(),
 		     end = directory.playlists.end();
 	     i != end;) {
-		if (!directory_child_is_regular(storage, directory,
-						i->name.c_str())) {
+		if (files.find(i->name) == files.end()) {
 			const ScopeDatabaseLock protect;
 			i = directory.playlists.erase(i);
 		} else
@@ -185,9 +232,18 @@ UpdateWalk::UpdatePlaylistFile(Directory &directory,
 
 	PlaylistInfo pi(name, info.mtime);
 
-	const ScopeDatabaseLock protect;
-	if (directory.playlists.UpdateOrInsert(std::move(pi)))
-		modified = true;
+	{
+		const ScopeDatabaseLock protect;
+		if (directory.playlists.UpdateOrInsert(std::move(pi)))
+			modified = true;
+	}
+
+	if (StringEqualsCaseASCII(suffix, "cue"))
+		/* additionally expand the CUE sheet into the
+		   database, so its tracks can be used without
+		   parsing the sheet again at runtime */
+		ExpandCueSheet(directory, name, info);
+
 	return true;
 }
 
@@ -237,6 +293,96 @@ try {
 	LogError(std::current_exception());
 }
 
+/**
+ * Distributes the entries of one directory over a pool of worker
+ * threads.  Each worker pops one entry at a time and runs the regular
+ * sequential walk on it; mutations of the #Directory tree are
+ * serialized by the global db_mutex, just like in the sequential
+ * walk.
+ */
+class ParallelUpdateQueue {
+	UpdateWalk &walk;
+	Directory &directory;
+	const ExcludeList &exclude_list;
+
+	/**
+	 * Protects #next.
+	 */
+	Mutex mutex;
+
+	std::vector<std::pair<std::string, StorageFileInfo>> entries;
+	size_t next = 0;
+
+public:
+	ParallelUpdateQueue(UpdateWalk &_walk, Directory &_directory,
+			    const ExcludeList &_exclude_list) noexcept
+		:walk(_walk), directory(_directory),
+		 exclude_list(_exclude_list) {}
+
+	void Push(const char *name, const StorageFileInfo &info) noexcept {
+		entries.emplace_back(name, info);
+	}
+
+	/**
+	 * Process all queued entries with up to the given number of
+	 * threads.  The calling thread participates as one of the
+	 * workers.
+	 */
+	void Run(unsigned n_threads) noexcept;
+
+private:
+	void ThreadMain() noexcept;
+};
+
+void
+ParallelUpdateQueue::ThreadMain() noexcept
+{
+	while (!walk.cancel) {
+		const std::pair<std::string, StorageFileInfo> *entry;
+
+		{
+			const std::lock_guard<Mutex> protect(mutex);
+			if (next >= entries.size())
+				break;
+
+			entry = &entries[next++];
+		}
+
+		walk.UpdateDirectoryChild(directory, exclude_list,
+					  entry->first.c_str(),
+					  entry->second);
+	}
+}
+
+void
+ParallelUpdateQueue::Run(unsigned n_threads) noexcept
+{
+	if (n_threads > entries.size())
+		n_threads = entries.size();
+
+	std::forward_list<Thread> threads;
+
+	try {
+		for (unsigned i = 1; i < n_threads; ++i) {
+			threads.emplace_front(BIND_THIS_METHOD(ThreadMain));
+			threads.front().Start();
+		}
+	} catch (...) {
+		/* failure to start a thread is not fatal; the
+		   remaining workers will pick up the slack */
+		LogError(std::current_exception());
+
+		if (!threads.empty() && !threads.front().IsDefined())
+			threads.pop_front();
+	}
+
+	/* the calling thread participates, too */
+	ThreadMain();
+
+	for (auto &thread : threads)
+		thread.Join();
+}
+
 /* we don't look at "." / ".." nor files with newlines in their name */
 gcc_pure
 static bool
@@ -319,6 +465,34 @@ UpdateWalk::SkipSymlink(const Directory *directory,
 #endif
 }
 
+inline bool
+UpdateWalk::SkipUnchangedDirectory(Directory &directory,
+				   const ExcludeList &exclude_list,
+				   const StorageFileInfo &info) noexcept
+{
+	assert(info.IsDirectory());
+
+	directory_set_stat(directory, info);
+
+	directory.ForEachChildSafe([&](Directory &child){
+			if (cancel || child.IsMount())
+				return;
+
+			StorageFileInfo info2;
+			if (!GetInfo(storage, child.GetPath(), info2) ||
+			    !info2.IsDirectory()) {
+				editor.LockDeleteDirectory(&child);
+				modified = true;
+				return;
+			}
+
+			if (!UpdateDirectory(child, exclude_list, info2))
+				editor.LockDeleteDirectory(&child);
+		});
+
+	return true;
+}
+
 bool
 UpdateWalk::UpdateDirectory(Directory &directory,
 			    const ExcludeList &exclude_list,
@@ -326,6 +500,17 @@ UpdateWalk::UpdateDirectory(Directory &directory,
 {
 	assert(info.IsDirectory());
 
+	if (config.skip_unchanged && !walk_discard &&
+	    directory.mtime == info.mtime &&
+	    directory.mtime != std::chrono::system_clock::time_point::min())
+		/* mtime matches the previous complete scan, so no
+		   entry has been added or removed; note that files
+		   modified in place (e.g. retagged) do not bump the
+		   directory mtime, which is why this mode is opt-in
+		   and bypassed by "rescan" */
+		return SkipUnchangedDirectory(directory, exclude_list,
+					      info);
+
 	directory_set_stat(directory, info);
 
 	std::unique_ptr<StorageDirectoryReader> reader;
@@ -353,7 +538,10 @@ UpdateWalk::UpdateDirectory(Directory &directory,
 	if (!child_exclude_list.IsEmpty())
 		RemoveExcludedFromDirectory(directory, child_exclude_list);
 
-	PurgeDeletedFromDirectory(directory);
+	/* the names seen while enumerating this directory; the purge
+	   below deletes everything else, without re-checking each
+	   database entry in the storage */
+	std::set<std::string> seen_directories, seen_files;
 
 	const char *name_utf8;
 	while (!cancel && (name_utf8 = reader->Read()) != nullptr) {
@@ -366,20 +554,119 @@ UpdateWalk::UpdateDirectory(Directory &directory,
 				continue;
 		}
 
-		if (SkipSymlink(&directory, name_utf8)) {
-			modified |= editor.DeleteNameIn(directory, name_utf8);
+		if (reader->MaybeSymlink() &&
+		    SkipSymlink(&directory, name_utf8)) {
+			if (editor.DeleteNameIn(directory, name_utf8))
+				modified = true;
 			continue;
 		}
 
 		StorageFileInfo info2;
 		if (!GetInfo(*reader, info2)) {
-			modified |= editor.DeleteNameIn(directory, name_utf8);
+			if (editor.DeleteNameIn(directory, name_utf8))
+				modified = true;
 			continue;
 		}
 
+		if (info2.IsDirectory())
+			seen_directories.emplace(name_utf8);
+		else if (info2.IsRegular())
+			seen_files.emplace(name_utf8);
+
 		UpdateDirectoryChild(directory, child_exclude_list, name_utf8, info2);
 	}
 
+	if (!cancel)
+		/* if the walk was cancelled, the enumeration is
+		   incomplete and must not be used for purging */
+		PurgeDeletedFromDirectory(directory,
+					  seen_directories, seen_files);
+
+	directory.mtime = info.mtime;
+
+	return true;
+}
+
+bool
+UpdateWalk::UpdateDirectoryParallel(Directory &directory,
+				    const ExcludeList &exclude_list,
+				    const StorageFileInfo &info) noexcept
+{
+	assert(info.IsDirectory());
+
+	directory_set_stat(directory, info);
+
+	std::unique_ptr<StorageDirectoryReader> reader;
+
+	try {
+		reader = storage.OpenDirectory(directory.GetPath());
+	} catch (...) {
+		LogError(std::current_exception());
+		return false;
+	}
+
+	ExcludeList child_exclude_list(exclude_list);
+
+	try {
+		Mutex mutex;
+		auto is = InputStream::OpenReady(PathTraitsUTF8::Build(storage.MapUTF8(directory.GetPath()).c_str(),
+								       ".mpdignore").c_str(),
+						 mutex);
+		child_exclude_list.Load(std::move(is));
+	} catch (...) {
+		if (!IsFileNotFound(std::current_exception()))
+			LogError(std::current_exception());
+	}
+
+	if (!child_exclude_list.IsEmpty())
+		RemoveExcludedFromDirectory(directory, child_exclude_list);
+
+	/* unlike UpdateDirectory(), this method does not process
+	   entries right away; it queues them, and the worker threads
+	   pick them up */
+	ParallelUpdateQueue queue(*this, directory, child_exclude_list);
+
+	std::set<std::string> seen_directories, seen_files;
+
+	const char *name_utf8;
+	while (!cancel && (name_utf8 = reader->Read()) != nullptr) {
+		if (skip_path(name_utf8))
+			continue;
+
+		{
+			const auto name_fs = AllocatedPath::FromUTF8(name_utf8);
+			if (name_fs.IsNull() || child_exclude_list.Check(name_fs))
+				continue;
+		}
+
+		if (reader->MaybeSymlink() &&
+		    SkipSymlink(&directory, name_utf8)) {
+			if (editor.DeleteNameIn(directory, name_utf8))
+				modified = true;
+			continue;
+		}
+
+		StorageFileInfo info2;
+		if (!GetInfo(*reader, info2)) {
+			if (editor.DeleteNameIn(directory, name_utf8))
+				modified = true;
+			continue;
+		}
+
+		if (info2.IsDirectory())
+			seen_directories.emplace(name_utf8);
+		else if (info2.IsRegular())
+			seen_files.emplace(name_utf8);
+
+		queue.Push(name_utf8, info2);
+	}
+
+	if (!cancel)
+		PurgeDeletedFromDirectory(directory,
+					  seen_directories, seen_files);
+
+	queue.Run(config.update_threads);
+
 	directory.mtime = info.mtime;
 
 	return true;
@@ -463,13 +750,15 @@ try {
 	const char *name = PathTraitsUTF8::GetBase(uri);
 
 	if (SkipSymlink(parent, name)) {
-		modified |= editor.DeleteNameIn(*parent, name);
+		if (editor.DeleteNameIn(*parent, name))
+			modified = true;
 		return;
 	}
 
 	StorageFileInfo info;
 	if (!GetInfo(storage, uri, info)) {
-		modified |= editor.DeleteNameIn(*parent, name);
+		if (editor.DeleteNameIn(*parent, name))
+			modified = true;
 		return;
 	}
 
@@ -495,7 +784,10 @@ UpdateWalk::Walk(Directory &root, const char *path, bool discard) noexcept
 
 		ExcludeList exclude_list;
 
-		UpdateDirectory(root, exclude_list, info);
+		if (config.update_threads > 1)
+			UpdateDirectoryParallel(root, exclude_list, info);
+		else
+			UpdateDirectory(root, exclude_list, info);
 	}
 
 	return modified;
@@ -22,10 +22,14 @@
 
 #include "Config.hxx"
 #include "Editor.hxx"
+#include "thread/Mutex.hxx"
 #include "util/Compiler.h"
 #include "config.h"
 
 #include <atomic>
+#include <set>
+#include <string>
+#include <vector>
 
 struct StorageFileInfo;
 struct Directory;
@@ -39,10 +43,17 @@ class UpdateWalk final {
 	friend class UpdateArchiveVisitor;
 #endif
 
+	friend class ParallelUpdateQueue;
+
 	const UpdateConfig config;
 
 	bool walk_discard;
-	bool modified;
+
+	/**
+	 * Was the database modified?  This flag is set by all worker
+	 * threads, therefore it is atomic.
+	 */
+	std::atomic_bool modified;
 
 	/**
 	 * Set to true by the main thread when the update thread shall
@@ -55,6 +66,32 @@ class UpdateWalk final {
 
 	DatabaseEditor editor;
 
+	/**
+	 * Upper bound for #modified_uris; walks which touch more
+	 * songs are not tracked individually, and consumers must fall
+	 * back to a full refresh.
+	 */
+	static constexpr size_t MAX_MODIFIED_URIS = 4096;
+
+	/**
+	 * Protects #modified_uris and #modified_uris_overflow against
+	 * concurrent access by worker threads.
+	 */
+	Mutex modified_uris_mutex;
+
+	/**
+	 * The database URIs of all songs added or updated by this
+	 * walk.  Consumed by TakeModifiedUris() after Walk() has
+	 * finished.
+	 */
+	std::vector<std::string> modified_uris;
+
+	/**
+	 * Set when #modified_uris has reached #MAX_MODIFIED_URIS; the
+	 * collected list is incomplete then.
+	 */
+	bool modified_uris_overflow = false;
+
 public:
 	UpdateWalk(const UpdateConfig &_config,
 		   EventLoop &_loop, DatabaseListener &_listener,
@@ -73,7 +110,39 @@ public:
 	 */
 	bool Walk(Directory &root, const char *path, bool discard) noexcept;
 
+	/**
+	 * Decode all songs which have no MixRamp cache entry yet and
+	 * store their computed MixRamp data in the cache (see
+	 * MixRampCache.hxx).  Called after Walk(), while the update
+	 * thread would otherwise be idle; no-op unless enabled in
+	 * the configuration.
+	 */
+	void RunMixRampScan(Directory &root) noexcept;
+
+	/**
+	 * Obtain the URIs of all songs added or updated by the
+	 * previous Walk() call.  May only be called after the walk
+	 * has finished.
+	 */
+	std::vector<std::string> TakeModifiedUris() noexcept;
+
+	/**
+	 * Did the previous Walk() call modify more songs than
+	 * TakeModifiedUris() can report?
+	 */
+	bool HasModifiedUriOverflow() const noexcept {
+		return modified_uris_overflow;
+	}
+
 private:
+	/**
+	 * Record that the given song (which lives inside the walked
+	 * database) has been added or updated, so consumers can
+	 * refresh references to it without rescanning everything.
+	 */
+	void AddModifiedSong(const Directory &parent,
+			     const char *name) noexcept;
+
 	gcc_pure
 	bool SkipSymlink(const Directory *directory,
 			 const char *utf8_name) const noexcept;
@@ -81,7 +150,18 @@ private:
 	void RemoveExcludedFromDirectory(Directory &directory,
 					 const ExcludeList &exclude_list) noexcept;
 
-	void PurgeDeletedFromDirectory(Directory &directory) noexcept;
+	/**
+	 * Delete all database entries of the given directory which
+	 * the walk's own enumeration of that directory did not see -
+	 * a plain set difference, without one stat() call per
+	 * database entry.
+	 *
+	 * @param directories the names enumerated as directories
+	 * @param files the names enumerated as regular files
+	 */
+	void PurgeDeletedFromDirectory(Directory &directory,
+				       const std::set<std::string> &directories,
+				       const std::set<std::string> &files) noexcept;
 
 	void UpdateSongFile2(Directory &directory,
 			     const char *name, const char *suffix,
@@ -122,6 +202,15 @@ private:
 				const char *name, const char *suffix,
 				const StorageFileInfo &info) noexcept;
 
+	/**
+	 * Expand a CUE sheet into a virtual directory of songs, so
+	 * clients can browse and load the tracks without parsing the
+	 * sheet at runtime.  The result is cached in the database,
+	 * keyed on the file's modification time.
+	 */
+	bool ExpandCueSheet(Directory &directory, const char *name,
+			    const StorageFileInfo &info) noexcept;
+
 	bool UpdateRegularFile(Directory &directory,
 			       const char *name, const StorageFileInfo &info) noexcept;
 
@@ -134,6 +223,25 @@ private:
 			     const ExcludeList &exclude_list,
 			     const StorageFileInfo &info) noexcept;
 
+	/**
+	 * Fast path for a directory whose mtime has not changed since
+	 * the last complete scan: the entry set must be the same, so
+	 * skip listing it and calling stat on each file, and descend
+	 * only into the already known subdirectories.
+	 */
+	bool SkipUnchangedDirectory(Directory &directory,
+				    const ExcludeList &exclude_list,
+				    const StorageFileInfo &info) noexcept;
+
+	/**
+	 * Like UpdateDirectory(), but distribute the directory's
+	 * entries over a pool of worker threads (see
+	 * UpdateConfig::update_threads).
+	 */
+	bool UpdateDirectoryParallel(Directory &directory,
+				     const ExcludeList &exclude_list,
+				     const StorageFileInfo &info) noexcept;
+
 	/**
 	 * Create the specified directory object if it does not exist
 	 * already or if the #StorageFileInfo object indicates that it has been
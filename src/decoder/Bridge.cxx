@@ -28,6 +28,8 @@
 #include "MusicChunk.hxx"
 #include "pcm/PcmConvert.hxx"
 #include "tag/Tag.hxx"
+#include "MixRampCache.hxx"
+#include "Metrics.hxx"
 #include "Log.hxx"
 #include "input/InputStream.hxx"
 #include "util/ConstBuffer.hxx"
@@ -106,6 +108,11 @@ DecoderBridge::GetChunk() noexcept
 			return current_chunk.get();
 		}
 
+		/* the MusicBuffer is full; the decoder will have to
+		   wait for the player to consume chunks */
+		global_metrics.buffer_full.fetch_add(1,
+						     std::memory_order_relaxed);
+
 		cmd = LockNeedChunks(dc);
 	} while (cmd == DecoderCommand::NONE);
 
@@ -310,8 +317,9 @@ DecoderBridge::CommandFinished()
 		absolute_frame = dc.seek_time.ToScale<uint64_t>(dc.in_audio_format.sample_rate);
 	}
 
-	dc.command = DecoderCommand::NONE;
-	dc.client_cond.signal();
+	/* this also submits a superseding seek target if one has
+	   arrived while the finished command was being executed */
+	dc.CommandFinishedLocked();
 }
 
 SongTime
@@ -539,6 +547,93 @@ DecoderBridge::SubmitData(InputStream *is,
 	return cmd;
 }
 
+WritableBuffer<void>
+DecoderBridge::GetOutputBuffer(InputStream *is, size_t size,
+			       uint16_t kbit_rate)
+{
+	assert(dc.state == DecoderState::DECODE);
+	assert(dc.pipe != nullptr);
+
+	if (convert != nullptr)
+		/* the PCM conversion reads from the plugin's own
+		   buffer; nothing to be gained by decoding into the
+		   chunk */
+		return nullptr;
+
+	if (dc.end_time.IsPositive())
+		/* the SubmitData() fall-back implements the
+		   end-of-range truncation */
+		return nullptr;
+
+	if (LockGetVirtualCommand() != DecoderCommand::NONE)
+		/* let the fall-back path deal with the pending
+		   command */
+		return nullptr;
+
+	/* send stream tags */
+
+	if (UpdateStreamTag(is)) {
+		DecoderCommand cmd;
+		if (decoder_tag != nullptr)
+			/* merge with tag from decoder plugin */
+			cmd = DoSendTag(*Tag::Merge(*decoder_tag,
+						    *stream_tag));
+		else
+			/* send only the stream tag */
+			cmd = DoSendTag(*stream_tag);
+
+		if (cmd != DecoderCommand::NONE)
+			return nullptr;
+	}
+
+	const size_t frame_size = dc.out_audio_format.GetFrameSize();
+	if (size < frame_size)
+		size = frame_size;
+
+	while (true) {
+		auto *chunk = GetChunk();
+		if (chunk == nullptr)
+			return nullptr;
+
+		auto dest = chunk->Write(dc.out_audio_format,
+					 SongTime::Cast(timestamp) -
+					 dc.song->GetStartTime(),
+					 kbit_rate);
+
+		/* round down to whole frames; the plugin must not
+		   submit partial frames */
+		dest.size -= dest.size % frame_size;
+		if (dest.size > 0) {
+			if (dest.size > size)
+				dest.size = size;
+			return dest;
+		}
+
+		/* the chunk has no room for another frame, flush it
+		   and try again with an empty one */
+		FlushChunk();
+	}
+}
+
+DecoderCommand
+DecoderBridge::CommitOutputBuffer(size_t nbytes)
+{
+	assert(dc.state == DecoderState::DECODE);
+	assert(current_chunk != nullptr);
+	assert(nbytes % dc.out_audio_format.GetFrameSize() == 0);
+
+	/* expand the music pipe chunk */
+
+	if (current_chunk->Expand(dc.out_audio_format, nbytes))
+		/* the chunk is full, flush it */
+		FlushChunk();
+
+	timestamp += dc.out_audio_format.SizeToTime<FloatDuration>(nbytes);
+	absolute_frame += nbytes / dc.out_audio_format.GetFrameSize();
+
+	return LockGetVirtualCommand();
+}
+
 DecoderCommand
 DecoderBridge::SubmitTag(InputStream *is, Tag &&tag)
 {
@@ -610,5 +705,11 @@ DecoderBridge::SubmitReplayGain(const ReplayGainInfo *new_replay_gain_info)
 void
 DecoderBridge::SubmitMixRamp(MixRampInfo &&mix_ramp)
 {
+	if (dc.song != nullptr)
+		/* remember the song's MixRamp tags in the persistent
+		   cache, so the next crossfade into/out of this song
+		   does not depend on decode timing */
+		mixramp_cache_put(dc.song->GetURI(), mix_ramp);
+
 	dc.SetMixRamp(std::move(mix_ramp));
 }
@@ -152,6 +152,9 @@ public:
 	DecoderCommand SubmitData(InputStream *is,
 				  const void *data, size_t length,
 				  uint16_t kbit_rate) override;
+	WritableBuffer<void> GetOutputBuffer(InputStream *is, size_t size,
+					     uint16_t kbit_rate) override;
+	DecoderCommand CommitOutputBuffer(size_t nbytes) override;
 	DecoderCommand SubmitTag(InputStream *is, Tag &&tag) override ;
 	void SubmitReplayGain(const ReplayGainInfo *replay_gain_info) override;
 	void SubmitMixRamp(MixRampInfo &&mix_ramp) override;
@@ -24,6 +24,7 @@
 #include "Chrono.hxx"
 #include "input/Ptr.hxx"
 #include "util/Compiler.h"
+#include "util/WritableBuffer.hxx"
 
 #include <stdint.h>
 
@@ -137,6 +138,54 @@ public:
 		return SubmitData(&is, data, length, kbit_rate);
 	}
 
+	/**
+	 * Obtain a writable buffer which the decoder plugin may
+	 * decode directly into, avoiding the copy made by
+	 * SubmitData().  After filling the buffer, call
+	 * CommitOutputBuffer(); no other method of this object may be
+	 * called in between.
+	 *
+	 * This is an optional optimization: the returned buffer may
+	 * be smaller than requested, and the method may return
+	 * nullptr at any time (e.g. because a command is pending or
+	 * because the output needs further processing), in which case
+	 * the plugin must fall back to SubmitData().
+	 *
+	 * The default implementation returns nullptr.
+	 *
+	 * @param is an input stream which is buffering while we are
+	 * waiting for the player
+	 * @param size the desired buffer size in bytes
+	 * @param kbit_rate the current bit rate of the source file
+	 * @return a writable buffer whose size is a positive multiple
+	 * of the audio frame size, or nullptr
+	 */
+	virtual WritableBuffer<void> GetOutputBuffer(InputStream *,
+						     size_t, uint16_t) {
+		return nullptr;
+	}
+
+	WritableBuffer<void> GetOutputBuffer(InputStream &is, size_t size,
+					     uint16_t kbit_rate) {
+		return GetOutputBuffer(&is, size, kbit_rate);
+	}
+
+	/**
+	 * Submit data which was decoded into the buffer returned by
+	 * GetOutputBuffer().
+	 *
+	 * @param nbytes the number of bytes actually decoded; must
+	 * not be larger than the buffer and must be a multiple of the
+	 * audio frame size
+	 * @return the current command, or DecoderCommand::NONE if
+	 * there is no command pending
+	 */
+	virtual DecoderCommand CommitOutputBuffer(size_t) {
+		/* never called unless GetOutputBuffer() has returned
+		   a buffer */
+		gcc_unreachable();
+	}
+
 	/**
 	 * This function is called by the decoder plugin when it has
 	 * successfully decoded a tag.
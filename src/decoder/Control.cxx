@@ -103,12 +103,17 @@ DecoderControl::Start(std::unique_ptr<DetachedSong> _song,
 	pipe = std::move(_pipe);
 
 	ClearError();
+	seek_pending = false;
 	SynchronousCommandLocked(DecoderCommand::START);
 }
 
 void
 DecoderControl::Stop() noexcept
 {
+	/* a pending seek makes no sense anymore and must not be
+	   re-submitted after the STOP */
+	seek_pending = false;
+
 	if (command != DecoderCommand::NONE)
 		/* Attempt to cancel the current command.  If it's too
 		   late and the decoder thread is already executing
@@ -121,7 +126,7 @@ DecoderControl::Stop() noexcept
 }
 
 void
-DecoderControl::Seek(SongTime t)
+DecoderControl::SeekAsync(SongTime t)
 {
 	assert(state != DecoderState::START);
 	assert(state != DecoderState::ERROR);
@@ -143,12 +148,23 @@ DecoderControl::Seek(SongTime t)
 	if (!seekable)
 		throw std::runtime_error("Not seekable");
 
+	if (command != DecoderCommand::NONE) {
+		/* the decoder thread is still executing a command
+		   (almost always an older seek): remember the new
+		   target, superseding a previously pending one; it
+		   will be submitted by CommandFinishedLocked().
+		   #seek_time cannot be overwritten directly because
+		   the decoder plugin may be reading it concurrently
+		   without the lock */
+		pending_seek_time = t;
+		seek_pending = true;
+		return;
+	}
+
 	seek_time = t;
 	seek_error = false;
-	SynchronousCommandLocked(DecoderCommand::SEEK);
-
-	if (seek_error)
-		throw std::runtime_error("Decoder failed to seek");
+	command = DecoderCommand::SEEK;
+	Signal();
 }
 
 void
@@ -107,6 +107,16 @@ public:
 private:
 	bool quit;
 
+	/**
+	 * A superseding seek target, submitted by SeekAsync() while
+	 * the decoder thread was still executing an older command.
+	 * It will be forwarded to the decoder thread by
+	 * CommandFinishedLocked(); until then, a newer SeekAsync()
+	 * call may overwrite it.
+	 */
+	SongTime pending_seek_time;
+	bool seek_pending = false;
+
 public:
 	/**
 	 * Is the client currently waiting for the DecoderThread?  If
@@ -325,6 +335,16 @@ public:
 		return seekable && IsCurrentSong(_song);
 	}
 
+	/**
+	 * Is a seek currently being executed or waiting to be
+	 * submitted to the decoder thread?
+	 *
+	 * Caller must lock the object.
+	 */
+	bool IsSeeking() const noexcept {
+		return command == DecoderCommand::SEEK || seek_pending;
+	}
+
 private:
 	/**
 	 * Wait for the command to be finished by the decoder thread.
@@ -372,7 +392,9 @@ private:
 public:
 	/**
 	 * Marks the current command as "finished" and notifies the
-	 * client (= player thread).
+	 * client (= player thread).  If a superseding seek target has
+	 * been submitted meanwhile (see SeekAsync()), it is forwarded
+	 * to the decoder thread now.
 	 *
 	 * To be called from the decoder thread.  Caller must lock the
 	 * mutex.
@@ -380,8 +402,21 @@ public:
 	void CommandFinishedLocked() noexcept {
 		assert(command != DecoderCommand::NONE);
 
+		const auto old_command = command;
 		command = DecoderCommand::NONE;
 		client_cond.signal();
+
+		if (seek_pending && old_command == DecoderCommand::SEEK &&
+		    state == DecoderState::DECODE) {
+			/* a newer seek target arrived while the seek
+			   just finished was being executed: submit it
+			   now; this thread (the decoder thread) will
+			   pick it up in its next iteration */
+			seek_pending = false;
+			seek_time = pending_seek_time;
+			seek_error = false;
+			command = DecoderCommand::SEEK;
+		}
 	}
 
 	/**
@@ -407,11 +442,20 @@ public:
 	void Stop() noexcept;
 
 	/**
-	 * Throws #std::runtime_error on error.
+	 * Ask the decoder thread to seek, without waiting for it to
+	 * finish.  If an older seek is still being executed, the new
+	 * target supersedes it (and any previously pending target):
+	 * it will be submitted as soon as the old command finishes,
+	 * so rapid scrubbing costs only one decoder round trip to the
+	 * final position.
+	 *
+	 * Throws #std::runtime_error on error (dead decoder, not
+	 * seekable); errors from the seek itself are reported
+	 * asynchronously via #seek_error and are not thrown here.
 	 *
 	 * Caller must lock the object.
 	 */
-	void Seek(SongTime t);
+	void SeekAsync(SongTime t);
 
 	void Quit() noexcept;
 
@@ -44,7 +44,13 @@
 #include "plugins/MpcdecDecoderPlugin.hxx"
 #include "plugins/FluidsynthDecoderPlugin.hxx"
 #include "plugins/SidplayDecoderPlugin.hxx"
+#include "thread/Mutex.hxx"
+#include "util/CharUtil.hxx"
 #include "util/Macros.hxx"
+#include "Log.hxx"
+
+#include <string>
+#include <unordered_set>
 
 #include <string.h>
 
@@ -116,9 +122,51 @@ const struct DecoderPlugin *const decoder_plugins[] = {
 static constexpr unsigned num_decoder_plugins =
 	ARRAY_SIZE(decoder_plugins) - 1;
 
-/** which plugins have been initialized successfully? */
+/** which plugins are enabled (i.e. not disabled in mpd.conf)? */
 bool decoder_plugins_enabled[num_decoder_plugins];
 
+/**
+ * The lazy initialization state of each plugin.  Init() is deferred
+ * to the first actual use of a plugin (decoding or tag scanning);
+ * only the static suffix/MIME tables are available before that.
+ */
+enum class PluginInitState : uint8_t {
+	PENDING,
+	READY,
+	FAILED,
+};
+
+static PluginInitState decoder_plugin_init_state[num_decoder_plugins];
+
+static const ConfigBlock empty_config_block;
+
+/**
+ * The mpd.conf block of each enabled plugin, to be passed to the
+ * deferred Init() call.  Points into the global #ConfigData (or to
+ * #empty_config_block), which outlives all plugins.
+ */
+static const ConfigBlock *decoder_plugin_configs[num_decoder_plugins];
+
+/** protects #decoder_plugin_init_state */
+static Mutex decoder_plugins_init_mutex;
+
+/**
+ * The union of all enabled plugins' suffix tables, filled by
+ * decoder_plugin_init_all().  The database update walk probes this
+ * set once per file, which must not degenerate into a scan over
+ * every plugin's string list.
+ */
+static std::unordered_set<std::string> decoder_plugin_suffixes;
+
+static std::string
+FoldSuffix(const char *suffix) noexcept
+{
+	std::string result(suffix);
+	for (auto &ch : result)
+		ch = ToLowerASCII(ch);
+	return result;
+}
+
 const struct DecoderPlugin *
 decoder_plugin_from_name(const char *name) noexcept
 {
@@ -130,8 +178,6 @@ decoder_plugin_from_name(const char *name) noexcept
 void
 decoder_plugin_init_all(const ConfigData &config)
 {
-	ConfigBlock empty;
-
 	for (unsigned i = 0; decoder_plugins[i] != nullptr; ++i) {
 		const DecoderPlugin &plugin = *decoder_plugins[i];
 		const auto *param =
@@ -139,31 +185,65 @@ decoder_plugin_init_all(const ConfigData &config)
 					 plugin.name);
 
 		if (param == nullptr)
-			param = &empty;
+			param = &empty_config_block;
 		else if (!param->GetBlockValue("enabled", true))
 			/* the plugin is disabled in mpd.conf */
 			continue;
 
-		if (param != nullptr)
-			param->SetUsed();
+		param->SetUsed();
+
+		/* defer the (potentially expensive) Init() call to
+		   the first actual use of the plugin; until then,
+		   only the static suffix/MIME tables are consulted */
+		decoder_plugin_configs[i] = param;
+		decoder_plugins_enabled[i] = true;
 
-		if (plugin.Init(*param))
-			decoder_plugins_enabled[i] = true;
+		if (plugin.suffixes != nullptr)
+			for (auto i2 = plugin.suffixes; *i2 != nullptr; ++i2)
+				decoder_plugin_suffixes.emplace(FoldSuffix(*i2));
 	}
 }
 
+bool
+decoder_plugin_ensure_initialized(const DecoderPlugin &plugin) noexcept
+{
+	for (unsigned i = 0; decoder_plugins[i] != nullptr; ++i) {
+		if (decoder_plugins[i] != &plugin)
+			continue;
+
+		const std::lock_guard<Mutex> protect(decoder_plugins_init_mutex);
+
+		if (decoder_plugin_init_state[i] == PluginInitState::PENDING) {
+			bool success = false;
+
+			try {
+				success = plugin.Init(*decoder_plugin_configs[i]);
+			} catch (...) {
+				LogError(std::current_exception());
+			}
+
+			decoder_plugin_init_state[i] = success
+				? PluginInitState::READY
+				: PluginInitState::FAILED;
+		}
+
+		return decoder_plugin_init_state[i] == PluginInitState::READY;
+	}
+
+	return false;
+}
+
 void
 decoder_plugin_deinit_all() noexcept
 {
-	decoder_plugins_for_each_enabled([=](const DecoderPlugin &plugin){
-			plugin.Finish();
-		});
+	for (unsigned i = 0; decoder_plugins[i] != nullptr; ++i)
+		if (decoder_plugin_init_state[i] == PluginInitState::READY)
+			decoder_plugins[i]->Finish();
 }
 
 bool
 decoder_plugins_supports_suffix(const char *suffix) noexcept
 {
-	return decoder_plugins_try([suffix](const DecoderPlugin &plugin){
-			return plugin.SupportsSuffix(suffix);
-		});
+	return decoder_plugin_suffixes.find(FoldSuffix(suffix)) !=
+		decoder_plugin_suffixes.end();
 }
@@ -26,6 +26,13 @@ struct ConfigData;
 struct DecoderPlugin;
 
 extern const struct DecoderPlugin *const decoder_plugins[];
+
+/**
+ * Which plugins are enabled (i.e. not disabled in mpd.conf)?  Note
+ * that an enabled plugin may not have been initialized yet; callers
+ * which invoke more than the static suffix/MIME tables must call
+ * decoder_plugin_ensure_initialized() first.
+ */
 extern bool decoder_plugins_enabled[];
 
 /* interface for using plugins */
@@ -38,6 +45,15 @@ decoder_plugin_from_name(const char *name) noexcept;
 void
 decoder_plugin_init_all(const ConfigData &config);
 
+/**
+ * Perform the deferred Init() call of the given plugin, unless it has
+ * been initialized already (thread-safe "once" semantics).
+ *
+ * @return true if the plugin is ready for use
+ */
+bool
+decoder_plugin_ensure_initialized(const DecoderPlugin &plugin) noexcept;
+
 /* this is where we "unload" all the "plugins" */
 void
 decoder_plugin_deinit_all() noexcept;
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_DECODER_PCM_STAGING_BUFFER_HXX
+#define MPD_DECODER_PCM_STAGING_BUFFER_HXX
+
+#include "Client.hxx"
+
+#include <string.h>
+
+/**
+ * Accumulates small blocks of decoded PCM data and submits them to
+ * the #DecoderClient in larger batches.  Decoders which produce only
+ * a few kilobytes per packet (e.g. the Xiph codecs) would otherwise
+ * pay the DecoderClient::SubmitData() synchronization overhead for
+ * every packet.
+ *
+ * Note that SubmitData() is only invoked when the buffer is flushed;
+ * the caller must Flush() before submitting a timestamp (so it is
+ * applied at the right stream position) and at the end of the
+ * stream, and Clear() after seeking (the staged data is stale then).
+ */
+class PcmStagingBuffer {
+	static constexpr size_t CAPACITY = 16384;
+
+	size_t fill = 0;
+
+	uint8_t data[CAPACITY];
+
+public:
+	/**
+	 * Submit all staged data.  Returns
+	 * DecoderClient::SubmitData()'s command, or
+	 * #DecoderCommand::NONE if the buffer was empty.
+	 */
+	DecoderCommand Flush(DecoderClient &client, InputStream &is,
+			     uint16_t kbit_rate=0) {
+		if (fill == 0)
+			return DecoderCommand::NONE;
+
+		const size_t nbytes = fill;
+		fill = 0;
+		return client.SubmitData(is, data, nbytes, kbit_rate);
+	}
+
+	/**
+	 * Stage a block of PCM data, flushing the buffer first if it
+	 * would overflow.  Returns #DecoderCommand::NONE or a
+	 * pending command (the block is discarded then - after a
+	 * seek or stop, it is stale anyway).
+	 */
+	DecoderCommand Append(DecoderClient &client, InputStream &is,
+			      const void *src, size_t size,
+			      uint16_t kbit_rate=0) {
+		if (fill + size > CAPACITY) {
+			auto cmd = Flush(client, is, kbit_rate);
+			if (cmd != DecoderCommand::NONE)
+				return cmd;
+		}
+
+		if (size >= CAPACITY)
+			/* too large for the buffer (which is empty
+			   now) - submit directly */
+			return client.SubmitData(is, src, size, kbit_rate);
+
+		memcpy(data + fill, src, size);
+		fill += size;
+		return DecoderCommand::NONE;
+	}
+
+	/**
+	 * Discard all staged data (e.g. after seeking).
+	 */
+	void Clear() noexcept {
+		fill = 0;
+	}
+};
+
+#endif
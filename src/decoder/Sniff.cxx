@@ -0,0 +1,125 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "Sniff.hxx"
+#include "DecoderList.hxx"
+#include "DecoderPlugin.hxx"
+#include "input/InputStream.hxx"
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * The number of bytes needed to check all magics below; an Ogg page
+ * header is 28 bytes, followed by the first bytes of the first
+ * packet.
+ */
+static constexpr size_t SNIFF_SIZE = 36;
+
+/**
+ * Map the given magic bytes to a decoder plugin name.  Returns
+ * nullptr if the format was not recognized.
+ */
+gcc_pure
+static const char *
+SniffFormat(const uint8_t *data, size_t size) noexcept
+{
+	if (size >= SNIFF_SIZE && memcmp(data, "OggS", 4) == 0) {
+		/* Ogg container: identify the codec from the
+		   beginning of the first packet */
+		if (memcmp(data + 28, "\x01vorbis", 7) == 0)
+			return "vorbis";
+		if (memcmp(data + 28, "OpusHead", 8) == 0)
+			return "opus";
+		if (memcmp(data + 28, "\x7f" "FLAC", 5) == 0)
+			return "flac";
+		return nullptr;
+	}
+
+	if (size >= 4 && memcmp(data, "fLaC", 4) == 0)
+		return "flac";
+
+	if (size >= 3 && memcmp(data, "ID3", 3) == 0)
+		/* an ID3v2 header is almost always followed by MPEG
+		   audio */
+		return "mad";
+
+	if (size >= 4 && memcmp(data, "wvpk", 4) == 0)
+		return "wavpack";
+
+	if (size >= 4 && (memcmp(data, "MPCK", 4) == 0 ||
+			  memcmp(data, "MP+", 3) == 0))
+		return "mpcdec";
+
+	if (size >= 4 && memcmp(data, "ADIF", 4) == 0)
+		return "faad";
+
+	if (size >= 8 && memcmp(data + 4, "ftyp", 4) == 0)
+		/* MP4 container */
+		return "ffmpeg";
+
+	if (size >= 12 && memcmp(data, "RIFF", 4) == 0 &&
+	    memcmp(data + 8, "WAVE", 4) == 0)
+		return "ffmpeg";
+
+	if (size >= 2 && data[0] == 0xff) {
+		if ((data[1] & 0xf6) == 0xf0)
+			/* ADTS syncword with layer==0 */
+			return "faad";
+
+		if ((data[1] & 0xe0) == 0xe0)
+			/* MPEG audio syncword */
+			return "mad";
+	}
+
+	return nullptr;
+}
+
+const DecoderPlugin *
+SniffDecoderPlugin(InputStream &is) noexcept
+try {
+	uint8_t buffer[SNIFF_SIZE];
+	size_t nbytes = 0;
+
+	while (nbytes < sizeof(buffer)) {
+		size_t n = is.Read(buffer + nbytes, sizeof(buffer) - nbytes);
+		if (n == 0)
+			break;
+
+		nbytes += n;
+	}
+
+	is.Rewind();
+
+	const char *name = SniffFormat(buffer, nbytes);
+	if (name == nullptr)
+		return nullptr;
+
+	const auto *plugin = decoder_plugin_from_name(name);
+	return plugin != nullptr && plugin->stream_decode != nullptr
+		? plugin
+		: nullptr;
+} catch (...) {
+	try {
+		is.Rewind();
+	} catch (...) {
+	}
+
+	return nullptr;
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_DECODER_SNIFF_HXX
+#define MPD_DECODER_SNIFF_HXX
+
+struct DecoderPlugin;
+class InputStream;
+
+/**
+ * Inspect the first bytes of the stream and guess which decoder
+ * plugin can decode it from well-known magic bytes.  This saves
+ * probing several plugins serially on streams which have neither a
+ * suffix nor a useful Content-Type.
+ *
+ * The read position is rewound before returning.  The caller must
+ * hold the #InputStream mutex.
+ *
+ * @return the recognized (and enabled) plugin or nullptr if the
+ * format was not recognized
+ */
+const DecoderPlugin *
+SniffDecoderPlugin(InputStream &is) noexcept;
+
+#endif
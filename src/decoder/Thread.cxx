@@ -30,6 +30,7 @@
 #include "input/LocalOpen.hxx"
 #include "input/Registry.hxx"
 #include "DecoderList.hxx"
+#include "Sniff.hxx"
 #include "system/Error.hxx"
 #include "util/MimeType.hxx"
 #include "util/UriUtil.hxx"
@@ -119,6 +120,9 @@ decoder_stream_decode(const DecoderPlugin &plugin,
 	{
 		const ScopeUnlock unlock(bridge.dc.mutex);
 
+		if (!decoder_plugin_ensure_initialized(plugin))
+			return false;
+
 		FormatThreadName("decoder:%s", plugin.name);
 
 		plugin.StreamDecode(bridge, input_stream);
@@ -156,6 +160,9 @@ decoder_file_decode(const DecoderPlugin &plugin,
 	{
 		const ScopeUnlock unlock(bridge.dc.mutex);
 
+		if (!decoder_plugin_ensure_initialized(plugin))
+			return false;
+
 		FormatThreadName("decoder:%s", plugin.name);
 
 		plugin.FileDecode(bridge, path);
@@ -205,9 +212,11 @@ static bool
 decoder_run_stream_plugin(DecoderBridge &bridge, InputStream &is,
 			  const char *suffix,
 			  const DecoderPlugin &plugin,
+			  const DecoderPlugin *exclude,
 			  bool &tried_r)
 {
-	if (!decoder_check_plugin(plugin, is, suffix))
+	if (&plugin == exclude ||
+	    !decoder_check_plugin(plugin, is, suffix))
 		return false;
 
 	bridge.error = std::exception_ptr();
@@ -218,7 +227,8 @@ decoder_run_stream_plugin(DecoderBridge &bridge, InputStream &is,
 
 static bool
 decoder_run_stream_locked(DecoderBridge &bridge, InputStream &is,
-			  const char *uri, bool &tried_r)
+			  const char *uri, const DecoderPlugin *exclude,
+			  bool &tried_r)
 {
 	UriSuffixBuffer suffix_buffer;
 	const char *const suffix = uri_get_suffix(uri, suffix_buffer);
@@ -226,7 +236,7 @@ decoder_run_stream_locked(DecoderBridge &bridge, InputStream &is,
 	using namespace std::placeholders;
 	const auto f = std::bind(decoder_run_stream_plugin,
 				 std::ref(bridge), std::ref(is), suffix,
-				 _1, std::ref(tried_r));
+				 _1, exclude, std::ref(tried_r));
 	return decoder_plugins_try(f);
 }
 
@@ -234,7 +244,8 @@ decoder_run_stream_locked(DecoderBridge &bridge, InputStream &is,
  * Try decoding a stream, using the fallback plugin.
  */
 static bool
-decoder_run_stream_fallback(DecoderBridge &bridge, InputStream &is)
+decoder_run_stream_fallback(DecoderBridge &bridge, InputStream &is,
+			    const DecoderPlugin *exclude)
 {
 	const struct DecoderPlugin *plugin;
 
@@ -243,7 +254,8 @@ decoder_run_stream_fallback(DecoderBridge &bridge, InputStream &is)
 #else
 	plugin = decoder_plugin_from_name("mad");
 #endif
-	return plugin != nullptr && plugin->stream_decode != nullptr &&
+	return plugin != nullptr && plugin != exclude &&
+		plugin->stream_decode != nullptr &&
 		decoder_stream_decode(*plugin, bridge, is);
 }
 
@@ -293,14 +305,27 @@ decoder_run_stream(DecoderBridge &bridge, const char *uri)
 
 	const std::lock_guard<Mutex> protect(dc.mutex);
 
+	if (dc.command == DecoderCommand::STOP)
+		return true;
+
+	/* first let magic bytes select a plugin; this skips the
+	   serial probe misses on streams which have neither a suffix
+	   nor a useful Content-Type */
+	const DecoderPlugin *sniffed = SniffDecoderPlugin(*input_stream);
+	if (sniffed != nullptr) {
+		bridge.error = std::exception_ptr();
+		if (decoder_stream_decode(*sniffed, bridge, *input_stream))
+			return true;
+	}
+
 	bool tried = false;
-	return dc.command == DecoderCommand::STOP ||
-		decoder_run_stream_locked(bridge, *input_stream, uri,
-					  tried) ||
+	return decoder_run_stream_locked(bridge, *input_stream, uri,
+					 sniffed, tried) ||
 		/* fallback to mp3: this is needed for bastard streams
 		   that don't have a suffix or set the mimeType */
 		(!tried &&
-		 decoder_run_stream_fallback(bridge, *input_stream));
+		 decoder_run_stream_fallback(bridge, *input_stream,
+					     sniffed));
 }
 
 /**
@@ -181,13 +181,6 @@ dsf_read_metadata(DecoderClient *client, InputStream &is,
 	return true;
 }
 
-static void
-bit_reverse_buffer(uint8_t *p, uint8_t *end)
-{
-	for (; p < end; ++p)
-		*p = bit_reverse(*p);
-}
-
 static void
 InterleaveDsfBlockMono(uint8_t *gcc_restrict dest,
 		       const uint8_t *gcc_restrict src)
@@ -108,11 +108,15 @@ adts_find_frame(DecoderBuffer &buffer)
 	}
 }
 
+/**
+ * @param exact walk all frames for an exact duration; if false, stop
+ * early and extrapolate from the file size, which is much cheaper
+ */
 static SignedSongTime
-adts_song_duration(DecoderBuffer &buffer)
+adts_song_duration(DecoderBuffer &buffer, bool exact)
 {
 	const InputStream &is = buffer.GetStream();
-	const bool estimate = !is.CheapSeeking();
+	const bool estimate = !exact || !is.CheapSeeking();
 	if (estimate && !is.KnownSize())
 		return SignedSongTime::Negative();
 
@@ -138,11 +142,10 @@ adts_song_duration(DecoderBuffer &buffer)
 		buffer.Consume(frame_length);
 
 		if (estimate && frames == 128) {
-			/* if this is a remote file, don't slurp the
-			   whole file just for checking the song
-			   duration; instead, stop after some time and
-			   extrapolate the song duration from what we
-			   have until now */
+			/* don't slurp the whole file just for
+			   checking the song duration; instead, stop
+			   after some time and extrapolate the song
+			   duration from what we have until now */
 
 			const auto offset = is.GetOffset()
 				- buffer.GetAvailable();
@@ -163,7 +166,7 @@ adts_song_duration(DecoderBuffer &buffer)
 }
 
 static SignedSongTime
-faad_song_duration(DecoderBuffer &buffer, InputStream &is)
+faad_song_duration(DecoderBuffer &buffer, InputStream &is, bool exact)
 {
 	auto data = ConstBuffer<uint8_t>::FromVoid(buffer.Need(5));
 	if (data.IsNull())
@@ -192,7 +195,7 @@ faad_song_duration(DecoderBuffer &buffer, InputStream &is)
 		if (!is.IsSeekable())
 			return SignedSongTime::Negative();
 
-		auto song_length = adts_song_duration(buffer);
+		auto song_length = adts_song_duration(buffer, exact);
 
 		try {
 			is.LockSeek(tagsize);
@@ -303,7 +306,7 @@ faad_get_file_time(InputStream &is)
 {
 	DecoderBuffer buffer(nullptr, is,
 			     FAAD_MIN_STREAMSIZE * MAX_CHANNELS);
-	auto duration = faad_song_duration(buffer, is);
+	auto duration = faad_song_duration(buffer, is, true);
 	bool recognized = !duration.IsNegative();
 
 	if (!recognized) {
@@ -327,7 +330,11 @@ static void
 faad_stream_decode(DecoderClient &client, InputStream &is,
 		   DecoderBuffer &buffer, const NeAACDecHandle decoder)
 {
-	const auto total_time = faad_song_duration(buffer, is);
+	/* an estimated duration is good enough for playback; the
+	   exact value shown to clients comes from the database tag,
+	   and walking all ADTS frames of a big local file would delay
+	   the start of playback */
+	const auto total_time = faad_song_duration(buffer, is, false);
 
 	if (adts_find_frame(buffer) == 0)
 		return;
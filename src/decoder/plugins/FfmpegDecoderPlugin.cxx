@@ -39,6 +39,8 @@
 #include "CheckAudioFormat.hxx"
 #include "util/ScopeExit.hxx"
 #include "util/ConstBuffer.hxx"
+#include "util/RuntimeError.hxx"
+#include "util/StringAPI.hxx"
 #include "LogV.hxx"
 
 extern "C" {
@@ -57,6 +59,19 @@ extern "C" {
  */
 static AVDictionary *avformat_options = nullptr;
 
+/**
+ * The number of libavcodec worker threads ("threads" setting); 1
+ * means single-threaded decoding (the default), 0 lets libavcodec
+ * pick a value based on the number of CPUs.
+ */
+static int avcodec_thread_count = 1;
+
+/**
+ * The allowed threading methods ("thread_type" setting); libavcodec
+ * masks this with the codec's capabilities.
+ */
+static int avcodec_thread_type = FF_THREAD_FRAME|FF_THREAD_SLICE;
+
 static AVFormatContext *
 FfmpegOpenInput(AVIOContext *pb,
 		const char *filename,
@@ -95,6 +110,19 @@ ffmpeg_init(const ConfigBlock &block)
 			av_dict_set(&avformat_options, name, value, 0);
 	}
 
+	avcodec_thread_count = block.GetBlockValue("threads", 1u);
+
+	const char *thread_type = block.GetBlockValue("thread_type");
+	if (thread_type != nullptr) {
+		if (StringIsEqual(thread_type, "frame"))
+			avcodec_thread_type = FF_THREAD_FRAME;
+		else if (StringIsEqual(thread_type, "slice"))
+			avcodec_thread_type = FF_THREAD_SLICE;
+		else if (!StringIsEqual(thread_type, "frame+slice"))
+			throw FormatRuntimeError("Invalid thread_type: %s",
+						 thread_type);
+	}
+
 	return true;
 }
 
@@ -548,6 +576,17 @@ FfmpegDecode(DecoderClient &client, InputStream &input,
 
 	avcodec_parameters_to_context(codec_context, av_stream.codecpar);
 
+	if (avcodec_thread_count != 1) {
+		/* enable multi-threaded decoding for codecs which
+		   support it (needed for e.g. TrueHD on weak CPUs);
+		   this is safe for seeking: the frames buffered
+		   inside the worker threads are discarded by
+		   avcodec_flush_buffers(), and the "min_frame" check
+		   skips frames preceding the seek target */
+		codec_context->thread_count = avcodec_thread_count;
+		codec_context->thread_type = avcodec_thread_type;
+	}
+
 	const int open_result = avcodec_open2(codec_context, codec, nullptr);
 	if (open_result < 0) {
 		LogError(ffmpeg_domain, "Could not open codec");
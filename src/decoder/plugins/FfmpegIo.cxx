@@ -95,12 +95,23 @@ AvioStream::_Seek(void *opaque, int64_t pos, int whence)
 bool
 AvioStream::Open()
 {
-	constexpr size_t BUFFER_SIZE = 8192;
-	auto buffer = (unsigned char *)av_malloc(BUFFER_SIZE);
+	/* libavformat requires the buffer to be owned (and possibly
+	   reallocated) by the AVIOContext, so we cannot let it read
+	   from the InputStream's internal buffer directly; but we can
+	   size the copy buffer to match the source: for local files,
+	   a small buffer keeps the read-ahead cheap, while for remote
+	   streams, a large buffer drains many kilobytes from the
+	   underlying ring buffer with just one lock round trip per
+	   refill */
+	const size_t buffer_size = input.CheapSeeking()
+		? size_t(8192)
+		: size_t(65536);
+
+	auto buffer = (unsigned char *)av_malloc(buffer_size);
 	if (buffer == nullptr)
 		return false;
 
-	io = avio_alloc_context(buffer, BUFFER_SIZE,
+	io = avio_alloc_context(buffer, buffer_size,
 				false, this,
 				_Read, nullptr,
 				input.IsSeekable() ? _Seek : nullptr);
@@ -20,9 +20,14 @@
 #include "FlacPcm.hxx"
 #include "CheckAudioFormat.hxx"
 #include "lib/xiph/FlacAudioFormat.hxx"
+#include "pcm/Interleave.hxx"
 #include "util/RuntimeError.hxx"
 #include "util/ConstBuffer.hxx"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include <assert.h>
 
 void
@@ -47,6 +52,37 @@ FlacImportStereo(T *dest, const FLAC__int32 *const src[], size_t n_frames)
 	}
 }
 
+#ifdef __SSE2__
+
+/**
+ * Interleave two planar channels and narrow them to 16 bit in one
+ * SSE2 pass.  libFLAC already confines the values to the 16 bit
+ * range, so the saturating pack cannot alter them.
+ */
+static void
+FlacImportStereo(int16_t *dest, const FLAC__int32 *const src[],
+		 size_t n_frames)
+{
+	const FLAC__int32 *const src0 = src[0], *const src1 = src[1];
+
+	size_t i = 0;
+	for (; i + 4 <= n_frames; i += 4, dest += 8) {
+		const __m128i a = _mm_loadu_si128((const __m128i *)(src0 + i));
+		const __m128i b = _mm_loadu_si128((const __m128i *)(src1 + i));
+
+		_mm_storeu_si128((__m128i *)dest,
+				 _mm_packs_epi32(_mm_unpacklo_epi32(a, b),
+						 _mm_unpackhi_epi32(a, b)));
+	}
+
+	for (; i != n_frames; ++i) {
+		*dest++ = (int16_t)src0[i];
+		*dest++ = (int16_t)src1[i];
+	}
+}
+
+#endif
+
 template<typename T>
 static void
 FlacImportAny(T *dest, const FLAC__int32 *const src[], size_t n_frames,
@@ -89,9 +125,17 @@ FlacPcmImport::Import(const FLAC__int32 *const src[], size_t n_frames)
 					   audio_format.channels);
 
 	case SampleFormat::S24_P32:
-	case SampleFormat::S32:
-		return FlacImport<int32_t>(buffer, src, n_frames,
-					   audio_format.channels);
+	case SampleFormat::S32: {
+		/* no narrowing required: this is a plain
+		   planar-to-interleaved copy, which PcmInterleave32()
+		   vectorizes */
+		const unsigned n_channels = audio_format.channels;
+		const size_t dest_size = n_frames * n_channels *
+			sizeof(int32_t);
+		int32_t *dest = (int32_t *)buffer.Get(dest_size);
+		PcmInterleave32(dest, {src, n_channels}, n_frames);
+		return {dest, dest_size};
+	}
 
 	case SampleFormat::S8:
 		return FlacImport<int8_t>(buffer, src, n_frames,
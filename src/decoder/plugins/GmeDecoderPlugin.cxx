@@ -104,15 +104,22 @@ ParseContainerPath(Path path_fs)
 	return { path_fs.GetDirectoryName(), track - 1 };
 }
 
+/**
+ * Load the container and its optional M3U file.
+ *
+ * @param sample_rate pass #gme_info_only to parse only the metadata,
+ * without initializing the emulator; this is much cheaper when no
+ * audio will be played (e.g. tag scans)
+ */
 static Music_Emu*
-LoadGmeAndM3u(GmeContainerPath container) {
+LoadGmeAndM3u(GmeContainerPath container, long sample_rate=GME_SAMPLE_RATE) {
 
 	const char *path = container.path.c_str();
 	const char *suffix = uri_get_suffix(path);
 
 	Music_Emu *emu;
 	const char *gme_err =
-		gme_open_file(path, &emu, GME_SAMPLE_RATE);
+		gme_open_file(path, &emu, sample_rate);
 	if (gme_err != nullptr) {
 		LogWarning(gme_domain, gme_err);
 		return nullptr;
@@ -270,7 +277,7 @@ gme_scan_file(Path path_fs, TagHandler &handler) noexcept
 {
 	const auto container = ParseContainerPath(path_fs);
 
-	Music_Emu *emu = LoadGmeAndM3u(container);
+	Music_Emu *emu = LoadGmeAndM3u(container, gme_info_only);
 	if(emu == nullptr) {
 		return false;
 	}
@@ -286,7 +293,7 @@ gme_container_scan(Path path_fs)
 	std::forward_list<DetachedSong> list;
 	const auto container = ParseContainerPath(path_fs);
 
-	Music_Emu *emu = LoadGmeAndM3u(container);
+	Music_Emu *emu = LoadGmeAndM3u(container, gme_info_only);
 	if(emu == nullptr) {
 		return list;
 	}
@@ -35,6 +35,10 @@
 
 #include <mad.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #ifdef ENABLE_ID3TAG
 #include "tag/Id3Unique.hxx"
 #include <id3tag.h>
@@ -98,12 +102,71 @@ mad_fixed_to_24_sample(mad_fixed_t sample)
 	return sample >> (MAD_F_FRACBITS + 1 - bits);
 }
 
+#ifdef __SSE2__
+
+/**
+ * Like mad_fixed_to_24_sample(), but round/clip/quantize four
+ * samples at a time.
+ */
+static inline __m128i
+mad_fixed_to_24_sample4(__m128i sample) noexcept
+{
+	static constexpr unsigned bits = 24;
+
+	const __m128i round = _mm_set1_epi32(1L << (MAD_F_FRACBITS - bits));
+	const __m128i max = _mm_set1_epi32(MAD_F_ONE - 1);
+	const __m128i min = _mm_set1_epi32(-MAD_F_ONE);
+
+	sample = _mm_add_epi32(sample, round);
+
+	/* clip (SSE2 has no 32 bit min/max, so use compare+select) */
+	__m128i gt = _mm_cmpgt_epi32(sample, max);
+	sample = _mm_or_si128(_mm_and_si128(gt, max),
+			      _mm_andnot_si128(gt, sample));
+
+	__m128i lt = _mm_cmpgt_epi32(min, sample);
+	sample = _mm_or_si128(_mm_and_si128(lt, min),
+			      _mm_andnot_si128(lt, sample));
+
+	return _mm_srai_epi32(sample, MAD_F_FRACBITS + 1 - bits);
+}
+
+#endif
+
 static void
 mad_fixed_to_24_buffer(int32_t *dest, const struct mad_synth *synth,
 		       unsigned int start, unsigned int end,
 		       unsigned int num_channels)
 {
-	for (unsigned i = start; i < end; ++i)
+	unsigned i = start;
+
+#ifdef __SSE2__
+	if (num_channels == 1) {
+		const mad_fixed_t *src = synth->pcm.samples[0];
+
+		for (; i + 4 <= end; i += 4, dest += 4) {
+			auto v = _mm_loadu_si128((const __m128i *)(src + i));
+			_mm_storeu_si128((__m128i *)dest,
+					 mad_fixed_to_24_sample4(v));
+		}
+	} else if (num_channels == 2) {
+		const mad_fixed_t *left = synth->pcm.samples[0];
+		const mad_fixed_t *right = synth->pcm.samples[1];
+
+		for (; i + 4 <= end; i += 4, dest += 8) {
+			auto l = mad_fixed_to_24_sample4(_mm_loadu_si128((const __m128i *)(left + i)));
+			auto r = mad_fixed_to_24_sample4(_mm_loadu_si128((const __m128i *)(right + i)));
+
+			/* interleave the two channels */
+			_mm_storeu_si128((__m128i *)dest,
+					 _mm_unpacklo_epi32(l, r));
+			_mm_storeu_si128((__m128i *)(dest + 4),
+					 _mm_unpackhi_epi32(l, r));
+		}
+	}
+#endif
+
+	for (; i < end; ++i)
 		for (unsigned c = 0; c < num_channels; ++c)
 			*dest++ = mad_fixed_to_24_sample(synth->pcm.samples[c][i]);
 }
@@ -118,7 +181,9 @@ mp3_plugin_init(const ConfigBlock &block)
 
 struct MadDecoder {
 	static constexpr size_t READ_BUFFER_SIZE = 40960;
-	static constexpr size_t MP3_DATA_OUTPUT_BUFFER_SIZE = 2048;
+	/* large enough for a full 1152-sample stereo frame, so each
+	   frame is submitted with a single SubmitData() call */
+	static constexpr size_t MP3_DATA_OUTPUT_BUFFER_SIZE = 4096;
 
 	struct mad_stream stream;
 	struct mad_frame frame;
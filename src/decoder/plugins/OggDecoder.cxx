@@ -21,6 +21,7 @@
 #include "lib/xiph/OggFind.hxx"
 #include "input/InputStream.hxx"
 
+#include <algorithm>
 #include <exception>
 
 /**
@@ -70,18 +71,73 @@ OggDecoder::LoadEndGranulePos() const
 	return packet.granulepos;
 }
 
+void
+OggDecoder::OnOggPage(const ogg_page &page, uint64_t start_offset) noexcept
+{
+	const auto granulepos = ogg_page_granulepos(&page);
+	if (granulepos < 0)
+		/* no packet ends on this page */
+		return;
+
+	const long serialno = ogg_page_serialno(&page);
+	if (serialno != index_serialno) {
+		/* a chained stream has begun: its granule positions
+		   start over, the old index is useless */
+		seek_index.clear();
+		index_serialno = serialno;
+	}
+
+	if (!seek_index.empty()) {
+		const auto &last = seek_index.back();
+		if (granulepos <= last.granulepos ||
+		    start_offset < last.offset + INDEX_SPACING)
+			/* not monotonic (we have seeked backwards
+			   into an indexed region) or too close to the
+			   previous entry */
+			return;
+	}
+
+	seek_index.push_back({granulepos, start_offset});
+}
+
 void
 OggDecoder::SeekGranulePos(ogg_int64_t where_granulepos)
 {
 	assert(IsSeekable());
 
-	/* interpolate the file offset where we expect to find the
-	   given granule position */
-	/* TODO: implement binary search */
-	offset_type offset(where_granulepos * input_stream.GetSize()
-			   / end_granulepos);
+	/* the last index entry at or before the target, or the
+	   beginning of the stream */
+	uint64_t start = 0;
+	ogg_int64_t start_granulepos = 0;
+
+	const auto i = std::upper_bound(seek_index.begin(), seek_index.end(),
+					where_granulepos,
+					[](ogg_int64_t gp, const IndexEntry &e){
+						return gp < e.granulepos;
+					});
+	if (i != seek_index.begin()) {
+		const auto &e = *std::prev(i);
+		start = e.offset;
+		start_granulepos = e.granulepos;
+	}
+
+	offset_type offset;
+	if (i != seek_index.end() || end_granulepos <= start_granulepos)
+		/* the target lies in a region which has been decoded
+		   (and indexed) before: start at the preceding
+		   indexed page, which is at most one index spacing
+		   away */
+		offset = start;
+	else
+		/* beyond the index: interpolate the file offset where
+		   we expect to find the given granule position,
+		   within the unindexed remainder only */
+		offset = start +
+			offset_type(where_granulepos - start_granulepos)
+			* (input_stream.GetSize() - offset_type(start))
+			/ (end_granulepos - start_granulepos);
 
 	input_stream.LockSeek(offset);
-	PostSeek();
+	PostSeek(offset);
 }
 
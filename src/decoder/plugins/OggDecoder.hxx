@@ -23,9 +23,44 @@
 #include "lib/xiph/OggVisitor.hxx"
 #include "decoder/Reader.hxx"
 
+#include <vector>
+
+#include <stdint.h>
+
 class OggDecoder : public OggVisitor {
 	ogg_int64_t end_granulepos;
 
+	/**
+	 * One entry of the seek index: the page starting at #offset
+	 * ends at #granulepos.
+	 */
+	struct IndexEntry {
+		ogg_int64_t granulepos;
+		uint64_t offset;
+	};
+
+	/**
+	 * A sparse granulepos-to-byte-offset index, built
+	 * incrementally from the pages seen while decoding (sorted by
+	 * granule position).  Seeks into a region which has been
+	 * decoded before hit the index instead of interpolating the
+	 * file offset, which lands imprecisely and is expensive on
+	 * remote streams.
+	 */
+	std::vector<IndexEntry> seek_index;
+
+	/**
+	 * The page serial number #seek_index was built from; granule
+	 * positions start over in a chained stream.
+	 */
+	long index_serialno = -1;
+
+	/**
+	 * The minimum byte distance between two index entries, to
+	 * bound the index's memory usage.
+	 */
+	static constexpr uint64_t INDEX_SPACING = 16384;
+
 protected:
 	DecoderClient &client;
 	InputStream &input_stream;
@@ -56,6 +91,10 @@ protected:
 	}
 
 	void SeekGranulePos(ogg_int64_t where_granulepos);
+
+	/* virtual methods from class OggVisitor */
+	void OnOggPage(const ogg_page &page,
+		       uint64_t start_offset) noexcept override;
 };
 
 #endif
@@ -28,6 +28,7 @@
 #include "decoder/Reader.hxx"
 #include "input/Reader.hxx"
 #include "OggCodec.hxx"
+#include "../PcmStagingBuffer.hxx"
 #include "tag/Handler.hxx"
 #include "tag/Builder.hxx"
 #include "input/InputStream.hxx"
@@ -85,6 +86,12 @@ class MPDOpusDecoder final : public OggDecoder {
 
 	size_t frame_size;
 
+	/**
+	 * Batches the per-packet PCM blocks into larger SubmitData()
+	 * calls.
+	 */
+	PcmStagingBuffer staging;
+
 public:
 	explicit MPDOpusDecoder(DecoderReader &reader)
 		:OggDecoder(reader) {}
@@ -100,6 +107,16 @@ public:
 
 	bool Seek(uint64_t where_frame);
 
+	/**
+	 * Submit all PCM data still in the staging buffer; throws
+	 * #DecoderCommand if one is pending.
+	 */
+	void FlushPcm() {
+		auto cmd = staging.Flush(client, input_stream);
+		if (cmd != DecoderCommand::NONE)
+			throw cmd;
+	}
+
 private:
 	void HandleTags(const ogg_packet &packet);
 	void HandleAudio(const ogg_packet &packet);
@@ -188,6 +205,8 @@ MPDOpusDecoder::OnOggBeginning(const ogg_packet &packet)
 void
 MPDOpusDecoder::OnOggEnd()
 {
+	FlushPcm();
+
 	if (!IsSeekable() && IsInitialized()) {
 		/* allow chaining of (unseekable) streams */
 		assert(opus_decoder != nullptr);
@@ -235,15 +254,20 @@ MPDOpusDecoder::HandleAudio(const ogg_packet &packet)
 
 	if (nframes > 0) {
 		const size_t nbytes = nframes * frame_size;
-		auto cmd = client.SubmitData(input_stream,
-					     output_buffer, nbytes,
-					     0);
+		auto cmd = staging.Append(client, input_stream,
+					  output_buffer, nbytes,
+					  0);
 		if (cmd != DecoderCommand::NONE)
 			throw cmd;
 
-		if (packet.granulepos > 0)
+		if (packet.granulepos > 0) {
+			/* flush the staging buffer first, so the
+			   timestamp is applied at the right
+			   position */
+			FlushPcm();
 			client.SubmitTimestamp(FloatDuration(packet.granulepos)
 					       / opus_sample_rate);
+		}
 	}
 }
 
@@ -258,6 +282,7 @@ MPDOpusDecoder::Seek(uint64_t where_frame)
 
 	try {
 		SeekGranulePos(where_granulepos);
+		staging.Clear();
 		return true;
 	} catch (...) {
 		return false;
@@ -296,6 +321,13 @@ mpd_opus_stream_decode(DecoderClient &client,
 				break;
 		}
 	}
+
+	/* in case the stream ended without an EOS packet, submit the
+	   PCM data still in the staging buffer */
+	try {
+		d.FlushPcm();
+	} catch (DecoderCommand) {
+	}
 }
 
 static bool
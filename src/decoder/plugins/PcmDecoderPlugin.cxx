@@ -26,6 +26,7 @@
 #include "util/Domain.hxx"
 #include "util/ByteReverse.hxx"
 #include "util/StaticFifoBuffer.hxx"
+#include "util/WritableBuffer.hxx"
 #include "util/NumberParser.hxx"
 #include "util/MimeType.hxx"
 #include "Log.hxx"
@@ -160,33 +161,75 @@ pcm_stream_decode(DecoderClient &client, InputStream &is)
 
 	DecoderCommand cmd;
 	do {
-		if (!FillBuffer(client, is, buffer))
-			break;
-
-		auto r = buffer.Read();
-		/* round down to the nearest frame size, because we
-		   must not pass partial frames to
-		   DecoderClient::SubmitData() */
-		r.size -= r.size % in_frame_size;
-		buffer.Consume(r.size);
-
-		if (reverse_endian)
-			/* make sure we deliver samples in host byte order */
-			reverse_bytes_16((uint16_t *)r.data,
-					 (uint16_t *)r.data,
-					 (uint16_t *)(r.data + r.size));
-		else if (l24) {
-			/* convert big-endian packed 24 bit
-			   (audio/L24) to native-endian 24 bit (in 32
-			   bit integers) */
-			pcm_unpack_24be(unpack_buffer, r.begin(), r.end());
-			r.data = (uint8_t *)&unpack_buffer[0];
-			r.size = (r.size / 3) * 4;
-		}
+		WritableBuffer<void> w = nullptr;
+		if (!l24 && buffer.empty())
+			/* fast path: read directly into the output
+			   chunk, bypassing our FIFO buffer */
+			w = client.GetOutputBuffer(is, buffer.GetCapacity(),
+						   0);
+
+		if (!w.IsNull()) {
+			size_t nbytes = decoder_read(client, is,
+						     w.data, w.size);
+
+			/* top off the last frame, because we must not
+			   pass partial frames to
+			   DecoderClient::CommitOutputBuffer() */
+			while (nbytes % in_frame_size != 0) {
+				size_t n = decoder_read(client, is,
+							(uint8_t *)w.data + nbytes,
+							in_frame_size - nbytes % in_frame_size);
+				if (n == 0) {
+					/* discard the trailing
+					   partial frame */
+					nbytes -= nbytes % in_frame_size;
+					break;
+				}
+
+				nbytes += n;
+			}
 
-		cmd = !r.empty()
-			? client.SubmitData(is, r.data, r.size, 0)
-			: client.GetCommand();
+			if (nbytes == 0 && is.LockIsEOF())
+				break;
+
+			if (reverse_endian)
+				/* make sure we deliver samples in host byte order */
+				reverse_bytes_16((uint16_t *)w.data,
+						 (uint16_t *)w.data,
+						 (uint16_t *)((uint8_t *)w.data + nbytes));
+
+			cmd = nbytes > 0
+				? client.CommitOutputBuffer(nbytes)
+				: client.GetCommand();
+		} else {
+			if (!FillBuffer(client, is, buffer))
+				break;
+
+			auto r = buffer.Read();
+			/* round down to the nearest frame size, because we
+			   must not pass partial frames to
+			   DecoderClient::SubmitData() */
+			r.size -= r.size % in_frame_size;
+			buffer.Consume(r.size);
+
+			if (reverse_endian)
+				/* make sure we deliver samples in host byte order */
+				reverse_bytes_16((uint16_t *)r.data,
+						 (uint16_t *)r.data,
+						 (uint16_t *)(r.data + r.size));
+			else if (l24) {
+				/* convert big-endian packed 24 bit
+				   (audio/L24) to native-endian 24 bit (in 32
+				   bit integers) */
+				pcm_unpack_24be(unpack_buffer, r.begin(), r.end());
+				r.data = (uint8_t *)&unpack_buffer[0];
+				r.size = (r.size / 3) * 4;
+			}
+
+			cmd = !r.empty()
+				? client.SubmitData(is, r.data, r.size, 0)
+				: client.GetCommand();
+		}
 		if (cmd == DecoderCommand::SEEK) {
 			uint64_t frame = client.GetSeekFrame();
 			offset_type offset = frame * in_frame_size;
@@ -209,6 +209,30 @@ get_song_length(T &tune)
 	return SignedSongTime::FromS(length);
 }
 
+#ifdef HAVE_SIDPLAYFP
+
+/**
+ * Variant of get_song_length() which takes a pre-computed MD5 of the
+ * tune; SidDatabase::length(SidTune&) would hash the whole file again
+ * for every lookup, which adds up when a container with many subtunes
+ * is scanned.
+ */
+gcc_pure
+static SignedSongTime
+QuerySongLength(const char *md5sum, unsigned song_num) noexcept
+{
+	if (songlength_database == nullptr)
+		return SignedSongTime::Negative();
+
+	const auto length = songlength_database->length(md5sum, song_num);
+	if (length < 0)
+		return SignedSongTime::Negative();
+
+	return SignedSongTime::FromS(length);
+}
+
+#endif
+
 static void
 sidplay_file_decode(DecoderClient &client, Path path_fs)
 {
@@ -538,6 +562,18 @@ sidplay_container_scan(Path path_fs)
 	if(!all_files_are_containers && n_tracks < 2)
 		return list;
 
+#ifdef HAVE_SIDPLAYFP
+	/* hash the tune once up front instead of once per subtune */
+	char md5[SidTune::MD5_LENGTH + 1];
+	md5[0] = 0;
+	if (songlength_database != nullptr)
+#if LIBSIDPLAYFP_VERSION >= GCC_MAKE_VERSION(2,0,0)
+		tune.createMD5New(md5);
+#else
+		tune.createMD5(md5);
+#endif
+#endif
+
 	TagBuilder tag_builder;
 
 	auto tail = list.before_begin();
@@ -547,6 +583,14 @@ sidplay_container_scan(Path path_fs)
 		AddTagHandler h(tag_builder);
 		ScanSidTuneInfo(info, i, n_tracks, h);
 
+#ifdef HAVE_SIDPLAYFP
+		const auto duration = QuerySongLength(md5, i);
+#else
+		const auto duration = get_song_length(tune);
+#endif
+		if (!duration.IsNegative())
+			h.OnDuration(SongTime(duration));
+
 		char track_name[32];
 		/* Construct container/tune path names, eg.
 		   Delta.sid/tune_001.sid */
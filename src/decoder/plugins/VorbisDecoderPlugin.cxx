@@ -28,6 +28,7 @@
 #include "input/InputStream.hxx"
 #include "input/Reader.hxx"
 #include "OggCodec.hxx"
+#include "../PcmStagingBuffer.hxx"
 #include "pcm/Interleave.hxx"
 #include "util/Macros.hxx"
 #include "util/ScopeExit.hxx"
@@ -70,6 +71,12 @@ class VorbisDecoder final : public OggDecoder {
 
 	bool dsp_initialized = false;
 
+	/**
+	 * Batches the small vorbis_synthesis_pcmout() blocks into
+	 * larger SubmitData() calls.
+	 */
+	PcmStagingBuffer staging;
+
 public:
 	explicit VorbisDecoder(DecoderReader &reader)
 		:OggDecoder(reader) {
@@ -82,6 +89,16 @@ public:
 
 	bool Seek(uint64_t where_frame);
 
+	/**
+	 * Submit all PCM data still in the staging buffer; throws
+	 * #DecoderCommand if one is pending.
+	 */
+	void FlushPcm() {
+		auto cmd = staging.Flush(client, input_stream);
+		if (cmd != DecoderCommand::NONE)
+			throw cmd;
+	}
+
 	static AudioFormat CheckAudioFormat(const vorbis_info &vi) {
 		return ::CheckAudioFormat(vi.rate, sample_format, vi.channels);
 	}
@@ -136,6 +153,7 @@ VorbisDecoder::Seek(uint64_t where_frame)
 	try {
 		SeekGranulePos(where_granulepos);
 		vorbis_synthesis_restart(&dsp);
+		staging.Clear();
 		return true;
 	} catch (...) {
 		return false;
@@ -232,9 +250,9 @@ VorbisDecoder::SubmitSomePcm()
 	vorbis_synthesis_read(&dsp, n_frames);
 
 	const size_t nbytes = n_frames * frame_size;
-	auto cmd = client.SubmitData(input_stream,
-				     buffer, nbytes,
-				     0);
+	auto cmd = staging.Append(client, input_stream,
+				  buffer, nbytes,
+				  0);
 	if (cmd != DecoderCommand::NONE)
 		throw cmd;
 
@@ -297,8 +315,13 @@ VorbisDecoder::OnOggPacket(const ogg_packet &_packet)
 		SubmitPcm();
 
 #ifndef HAVE_TREMOR
-		if (packet.granulepos > 0)
+		if (packet.granulepos > 0) {
+			/* flush the staging buffer first, so the
+			   timestamp is applied at the right
+			   position */
+			FlushPcm();
 			client.SubmitTimestamp(FloatDuration(vorbis_granule_time(&dsp, packet.granulepos)));
+		}
 #endif
 	}
 }
@@ -306,6 +329,7 @@ VorbisDecoder::OnOggPacket(const ogg_packet &_packet)
 void
 VorbisDecoder::OnOggEnd()
 {
+	FlushPcm();
 }
 
 /* public */
@@ -350,6 +374,13 @@ vorbis_stream_decode(DecoderClient &client,
 				break;
 		}
 	}
+
+	/* in case the stream ended without an EOS packet, submit the
+	   PCM data still in the staging buffer */
+	try {
+		d.FlushPcm();
+	} catch (DecoderCommand) {
+	}
 }
 
 static void
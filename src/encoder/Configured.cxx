@@ -20,6 +20,7 @@
 #include "Configured.hxx"
 #include "EncoderList.hxx"
 #include "EncoderPlugin.hxx"
+#include "Threaded.hxx"
 #include "config/Block.hxx"
 #include "util/StringAPI.hxx"
 #include "util/RuntimeError.hxx"
@@ -51,6 +52,14 @@ GetConfiguredEncoderPlugin(const ConfigBlock &block, bool shout_legacy)
 PreparedEncoder *
 CreateConfiguredEncoder(const ConfigBlock &block, bool shout_legacy)
 {
-	return encoder_init(GetConfiguredEncoderPlugin(block, shout_legacy),
-			    block);
+	auto *e = encoder_init(GetConfiguredEncoderPlugin(block, shout_legacy),
+			       block);
+
+	if (block.GetBlockValue("encoder_thread", false))
+		/* off-load the encoder to a worker thread so heavy
+		   compression settings cannot delay the output
+		   thread */
+		e = NewThreadedEncoder(e);
+
+	return e;
 }
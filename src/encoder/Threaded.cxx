@@ -0,0 +1,348 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "Threaded.hxx"
+#include "EncoderInterface.hxx"
+#include "thread/Thread.hxx"
+#include "thread/Mutex.hxx"
+#include "thread/Cond.hxx"
+#include "thread/Name.hxx"
+#include "util/DynamicFifoBuffer.hxx"
+#include "util/StaticFifoBuffer.hxx"
+
+#include <exception>
+#include <memory>
+
+#include <string.h>
+
+class ThreadedEncoder final : public Encoder {
+	/**
+	 * The capacity of the PCM input ring buffer.  When it is
+	 * full, Write() blocks, applying back pressure to the caller.
+	 */
+	static constexpr size_t INPUT_BUFFER_SIZE = 256 * 1024;
+
+	enum class Command : uint8_t {
+		NONE,
+
+		/** invoke Encoder::End() */
+		END,
+
+		/** invoke Encoder::Flush() */
+		FLUSH,
+
+		/** invoke Encoder::PreTag() */
+		PRE_TAG,
+
+		/** invoke Encoder::SendTag() */
+		TAG,
+
+		/** exit the worker thread */
+		CLOSE,
+	};
+
+	const std::unique_ptr<Encoder> inner;
+
+	Thread thread;
+
+	Mutex mutex;
+
+	/**
+	 * Signalled when there is work for the worker thread.
+	 */
+	Cond wake_cond;
+
+	/**
+	 * Signalled towards callers: when encoded data becomes
+	 * available, when space in the input buffer becomes available
+	 * and when a command has completed.
+	 */
+	Cond client_cond;
+
+	/**
+	 * PCM samples on their way to the worker thread.
+	 */
+	StaticFifoBuffer<uint8_t, INPUT_BUFFER_SIZE> input;
+
+	/**
+	 * Encoded data on its way to Read().  May grow on demand;
+	 * encoded data is (usually) much smaller than the input.
+	 */
+	DynamicFifoBuffer<uint8_t> output{16384};
+
+	Command command = Command::NONE;
+
+	/**
+	 * The tag to be sent by the pending #Command::TAG.  Protected
+	 * by the barrier in RunCommand(): the caller blocks while the
+	 * worker uses it.
+	 */
+	const Tag *pending_tag;
+
+	/**
+	 * An error thrown by the inner encoder in the worker thread,
+	 * to be rethrown into the caller.
+	 */
+	std::exception_ptr error;
+
+public:
+	explicit ThreadedEncoder(Encoder *_inner);
+
+	~ThreadedEncoder() noexcept override;
+
+	/* virtual methods from class Encoder */
+	void End() override {
+		RunCommand(Command::END);
+	}
+
+	void Flush() override {
+		RunCommand(Command::FLUSH);
+	}
+
+	void PreTag() override {
+		RunCommand(Command::PRE_TAG);
+	}
+
+	void SendTag(const Tag &tag) override {
+		pending_tag = &tag;
+		RunCommand(Command::TAG);
+	}
+
+	void Write(const void *data, size_t length) override;
+	size_t Read(void *dest, size_t length) noexcept override;
+
+private:
+	/**
+	 * Post a command to the worker thread and wait until it has
+	 * drained all buffered PCM data and executed the command.
+	 *
+	 * Throws an error caught from the inner encoder.
+	 */
+	void RunCommand(Command cmd);
+
+	/**
+	 * Move everything the inner encoder has produced into the
+	 * output buffer.  Called by the worker thread without the
+	 * lock.
+	 */
+	void DrainInner() noexcept;
+
+	void Task() noexcept;
+};
+
+ThreadedEncoder::ThreadedEncoder(Encoder *_inner)
+	:Encoder(_inner->ImplementsTag()),
+	 inner(_inner),
+	 thread(BIND_THIS_METHOD(Task))
+{
+	/* make the stream header (produced by the inner plugin's
+	   Open()) available to the first Read() call */
+	DrainInner();
+
+	thread.Start();
+}
+
+ThreadedEncoder::~ThreadedEncoder() noexcept
+{
+	{
+		const std::lock_guard<Mutex> protect(mutex);
+		command = Command::CLOSE;
+		wake_cond.signal();
+	}
+
+	thread.Join();
+}
+
+void
+ThreadedEncoder::DrainInner() noexcept
+{
+	uint8_t buffer[8192];
+
+	size_t nbytes;
+	while ((nbytes = inner->Read(buffer, sizeof(buffer))) > 0) {
+		const std::lock_guard<Mutex> protect(mutex);
+		output.Append(buffer, nbytes);
+		client_cond.signal();
+	}
+}
+
+void
+ThreadedEncoder::Write(const void *data, size_t length)
+{
+	const uint8_t *p = (const uint8_t *)data;
+
+	const std::lock_guard<Mutex> protect(mutex);
+
+	while (length > 0) {
+		if (error)
+			std::rethrow_exception(std::exchange(error,
+							     std::exception_ptr()));
+
+		auto w = input.Write();
+		if (w.empty()) {
+			/* the ring is full: block until the worker
+			   has caught up */
+			client_cond.wait(mutex);
+			continue;
+		}
+
+		const size_t nbytes = std::min(length, w.size);
+		memcpy(w.data, p, nbytes);
+		input.Append(nbytes);
+
+		p += nbytes;
+		length -= nbytes;
+
+		wake_cond.signal();
+	}
+}
+
+size_t
+ThreadedEncoder::Read(void *dest, size_t length) noexcept
+{
+	const std::lock_guard<Mutex> protect(mutex);
+	return output.Read((uint8_t *)dest, length);
+}
+
+void
+ThreadedEncoder::RunCommand(Command cmd)
+{
+	const std::lock_guard<Mutex> protect(mutex);
+
+	command = cmd;
+	wake_cond.signal();
+
+	while (command != Command::NONE)
+		client_cond.wait(mutex);
+
+	if (error)
+		std::rethrow_exception(std::exchange(error,
+						     std::exception_ptr()));
+}
+
+inline void
+ThreadedEncoder::Task() noexcept
+{
+	SetThreadName("encoder");
+
+	uint8_t buffer[8192];
+
+	std::unique_lock<Mutex> lock(mutex);
+
+	while (true) {
+		const auto r = input.Read();
+		if (!r.empty()) {
+			/* move a chunk out of the ring so the lock
+			   can be released while the inner encoder
+			   works */
+			const size_t nbytes = std::min(r.size,
+						       sizeof(buffer));
+			memcpy(buffer, r.data, nbytes);
+			input.Consume(nbytes);
+			client_cond.signal();
+
+			lock.unlock();
+
+			try {
+				inner->Write(buffer, nbytes);
+				DrainInner();
+			} catch (...) {
+				lock.lock();
+				if (!error)
+					error = std::current_exception();
+				client_cond.signal();
+				continue;
+			}
+
+			lock.lock();
+			continue;
+		}
+
+		if (command == Command::NONE) {
+			wake_cond.wait(mutex);
+			continue;
+		}
+
+		const Command cmd = command;
+		if (cmd == Command::CLOSE)
+			break;
+
+		lock.unlock();
+
+		try {
+			switch (cmd) {
+			case Command::END:
+				inner->End();
+				break;
+
+			case Command::FLUSH:
+				inner->Flush();
+				break;
+
+			case Command::PRE_TAG:
+				inner->PreTag();
+				break;
+
+			case Command::TAG:
+				inner->SendTag(*pending_tag);
+				break;
+
+			case Command::NONE:
+			case Command::CLOSE:
+				break;
+			}
+
+			DrainInner();
+		} catch (...) {
+			lock.lock();
+			if (!error)
+				error = std::current_exception();
+			command = Command::NONE;
+			client_cond.signal();
+			continue;
+		}
+
+		lock.lock();
+		command = Command::NONE;
+		client_cond.signal();
+	}
+}
+
+class PreparedThreadedEncoder final : public PreparedEncoder {
+	const std::unique_ptr<PreparedEncoder> inner;
+
+public:
+	explicit PreparedThreadedEncoder(PreparedEncoder *_inner)
+		:inner(_inner) {}
+
+	/* virtual methods from class PreparedEncoder */
+	Encoder *Open(AudioFormat &audio_format) override {
+		return new ThreadedEncoder(inner->Open(audio_format));
+	}
+
+	const char *GetMimeType() const override {
+		return inner->GetMimeType();
+	}
+};
+
+PreparedEncoder *
+NewThreadedEncoder(PreparedEncoder *inner)
+{
+	return new PreparedThreadedEncoder(inner);
+}
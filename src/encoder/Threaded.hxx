@@ -0,0 +1,36 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_ENCODER_THREADED_HXX
+#define MPD_ENCODER_THREADED_HXX
+
+class PreparedEncoder;
+
+/**
+ * Wrap a #PreparedEncoder so that the actual encoding runs in a
+ * dedicated worker thread.  Encoder::Write() only copies the PCM data
+ * into a ring buffer and returns; an encode spike (e.g. FLAC -8) then
+ * delays only the worker, not the calling output thread's pacing.
+ *
+ * Takes ownership of the inner #PreparedEncoder.
+ */
+PreparedEncoder *
+NewThreadedEncoder(PreparedEncoder *inner);
+
+#endif
@@ -102,6 +102,36 @@ wave_encoder_init(gcc_unused const ConfigBlock &block)
 	return new PreparedWaveEncoder();
 }
 
+size_t
+wave_encoder_write_header(const AudioFormat &audio_format,
+			  void *dest) noexcept
+{
+	static_assert(sizeof(WaveHeader) == wave_encoder_header_size,
+		      "WaveHeader size mismatch");
+
+	unsigned bits;
+	switch (audio_format.format) {
+	case SampleFormat::S8:
+		bits = 8;
+		break;
+
+	case SampleFormat::S16:
+		bits = 16;
+		break;
+
+	default:
+		assert(audio_format.format == SampleFormat::S32);
+		bits = 32;
+		break;
+	}
+
+	fill_wave_header((WaveHeader *)dest,
+			 audio_format.channels, bits,
+			 audio_format.sample_rate,
+			 (bits / 8) * audio_format.channels);
+	return sizeof(WaveHeader);
+}
+
 WaveEncoder::WaveEncoder(AudioFormat &audio_format)
 	:Encoder(false),
 	 buffer(8192)
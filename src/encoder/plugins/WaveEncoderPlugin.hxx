@@ -20,6 +20,26 @@
 #ifndef MPD_ENCODER_WAVE_HXX
 #define MPD_ENCODER_WAVE_HXX
 
+#include <stddef.h>
+
+struct AudioFormat;
+
 extern const struct EncoderPlugin wave_encoder_plugin;
 
+/**
+ * The size of the header written by wave_encoder_write_header().
+ */
+static constexpr size_t wave_encoder_header_size = 44;
+
+/**
+ * Generate a RIFF/WAVE streaming header (with a bogus huge "data"
+ * chunk size) for the given audio format, without opening an
+ * encoder.  The sample format must be 8, 16 or 32 bit PCM.
+ *
+ * @return the number of bytes written (#wave_encoder_header_size)
+ */
+size_t
+wave_encoder_write_header(const AudioFormat &audio_format,
+			  void *dest) noexcept;
+
 #endif
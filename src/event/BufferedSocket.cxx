@@ -27,8 +27,13 @@ BufferedSocket::ssize_t
 BufferedSocket::DirectRead(void *data, size_t length) noexcept
 {
 	const auto nbytes = GetSocket().Read((char *)data, length);
-	if (gcc_likely(nbytes > 0))
+	if (gcc_likely(nbytes > 0)) {
+		if ((size_t)nbytes < length)
+			/* the kernel buffer is drained */
+			ClearReadyFlags(READ);
+
 		return nbytes;
+	}
 
 	if (nbytes == 0) {
 		OnSocketClosed();
@@ -36,8 +41,10 @@ BufferedSocket::DirectRead(void *data, size_t length) noexcept
 	}
 
 	const auto code = GetSocketError();
-	if (IsSocketErrorAgain(code))
+	if (IsSocketErrorAgain(code)) {
+		ClearReadyFlags(READ);
 		return 0;
+	}
 
 	if (IsSocketErrorClosed(code))
 		OnSocketClosed();
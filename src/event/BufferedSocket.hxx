@@ -34,11 +34,21 @@ class EventLoop;
  * A #SocketMonitor specialization that adds an input buffer.
  */
 class BufferedSocket : protected SocketMonitor {
-	StaticFifoBuffer<uint8_t, 8192> input;
+	/**
+	 * Large enough to hold thousands of pipelined protocol
+	 * command lines, so a bulk client is served with few receive
+	 * system calls per event-loop wakeup.
+	 */
+	StaticFifoBuffer<uint8_t, 32768> input;
 
 public:
 	BufferedSocket(SocketDescriptor _fd, EventLoop &_loop) noexcept
 		:SocketMonitor(_fd, _loop) {
+		/* persistent sockets toggle their event interest a
+		   lot; edge-triggered mode avoids one epoll_ctl()
+		   call per toggle */
+		EnableEdgeTriggered();
+
 		ScheduleRead();
 	}
 
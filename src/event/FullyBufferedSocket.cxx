@@ -20,48 +20,111 @@
 #include "FullyBufferedSocket.hxx"
 #include "net/SocketError.hxx"
 #include "util/Compiler.h"
+#include "util/WritableBuffer.hxx"
+
+#include <algorithm>
+
+#ifndef _WIN32
+#include <sys/uio.h>
+#endif
 
 #include <assert.h>
 #include <string.h>
 
+FullyBufferedSocket::ssize_t
+FullyBufferedSocket::HandleWriteError() noexcept
+{
+	const auto code = GetSocketError();
+	if (IsSocketErrorAgain(code)) {
+		ClearReadyFlags(WRITE);
+		return 0;
+	}
+
+	IdleMonitor::Cancel();
+	BufferedSocket::Cancel();
+
+	if (IsSocketErrorClosed(code))
+		OnSocketClosed();
+	else
+		OnSocketError(std::make_exception_ptr(MakeSocketError(code, "Failed to send to socket")));
+
+	return -1;
+}
+
 FullyBufferedSocket::ssize_t
 FullyBufferedSocket::DirectWrite(const void *data, size_t length) noexcept
 {
 	const auto nbytes = GetSocket().Write((const char *)data, length);
-	if (gcc_unlikely(nbytes < 0)) {
-		const auto code = GetSocketError();
-		if (IsSocketErrorAgain(code))
-			return 0;
+	if (gcc_unlikely(nbytes < 0))
+		return HandleWriteError();
 
-		IdleMonitor::Cancel();
-		BufferedSocket::Cancel();
+	if ((size_t)nbytes < length)
+		/* the kernel send buffer is full */
+		ClearReadyFlags(WRITE);
 
-		if (IsSocketErrorClosed(code))
-			OnSocketClosed();
-		else
-			OnSocketError(std::make_exception_ptr(MakeSocketError(code, "Failed to send to socket")));
-	}
+	return nbytes;
+}
+
+#ifndef _WIN32
+
+FullyBufferedSocket::ssize_t
+FullyBufferedSocket::DirectWriteV(const struct iovec *v, size_t n) noexcept
+{
+	const auto nbytes = GetSocket().WriteV(v, n);
+	if (gcc_unlikely(nbytes < 0))
+		return HandleWriteError();
+
+	size_t total = 0;
+	for (size_t i = 0; i < n; ++i)
+		total += v[i].iov_len;
+
+	if ((size_t)nbytes < total)
+		/* the kernel send buffer is full */
+		ClearReadyFlags(WRITE);
 
 	return nbytes;
 }
 
+#endif
+
 bool
 FullyBufferedSocket::Flush() noexcept
 {
 	assert(IsDefined());
 
-	const auto data = output.Read();
-	if (data.empty()) {
+	WritableBuffer<void> segments[2];
+	const size_t n_segments = output.Read(segments, 2);
+	if (n_segments == 0) {
 		IdleMonitor::Cancel();
 		CancelWrite();
 		return true;
 	}
 
-	auto nbytes = DirectWrite(data.data, data.size);
+	ssize_t nbytes;
+#ifndef _WIN32
+	if (n_segments > 1) {
+		/* send both the normal and the peak buffer with one
+		   system call */
+		struct iovec iov[2];
+		for (size_t i = 0; i < n_segments; ++i) {
+			iov[i].iov_base = segments[i].data;
+			iov[i].iov_len = segments[i].size;
+		}
+
+		nbytes = DirectWriteV(iov, n_segments);
+	} else
+#endif
+		nbytes = DirectWrite(segments[0].data, segments[0].size);
+
 	if (gcc_unlikely(nbytes <= 0))
 		return nbytes == 0;
 
-	output.Consume(nbytes);
+	for (size_t i = 0; nbytes > 0 && i < n_segments; ++i) {
+		const size_t consumed = std::min(size_t(nbytes),
+						 segments[i].size);
+		output.Consume(consumed);
+		nbytes -= consumed;
+	}
 
 	if (output.empty()) {
 		IdleMonitor::Cancel();
@@ -71,6 +134,14 @@ FullyBufferedSocket::Flush() noexcept
 	return true;
 }
 
+/**
+ * When this many bytes have accumulated in the output buffer while a
+ * response is being generated, attempt to drain it to the kernel
+ * right away, so huge responses (e.g. "listallinfo") do not balloon
+ * the buffer when the client keeps up reading.
+ */
+static constexpr size_t DIRECT_FLUSH_THRESHOLD = 64 * 1024;
+
 bool
 FullyBufferedSocket::Write(const void *data, size_t length) noexcept
 {
@@ -88,6 +159,15 @@ FullyBufferedSocket::Write(const void *data, size_t length) noexcept
 
 	if (was_empty)
 		IdleMonitor::Schedule();
+
+	if (output.GetAvailable() >= DIRECT_FLUSH_THRESHOLD) {
+		if (!Flush())
+			return false;
+
+		if (!output.empty())
+			ScheduleWrite();
+	}
+
 	return true;
 }
 
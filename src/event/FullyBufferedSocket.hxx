@@ -24,6 +24,8 @@
 #include "IdleMonitor.hxx"
 #include "util/PeakBuffer.hxx"
 
+struct iovec;
+
 /**
  * A #BufferedSocket specialization that adds an output buffer.
  */
@@ -32,9 +34,10 @@ class FullyBufferedSocket : protected BufferedSocket, private IdleMonitor {
 
 public:
 	FullyBufferedSocket(SocketDescriptor _fd, EventLoop &_loop,
-			    size_t normal_size, size_t peak_size=0) noexcept
+			    size_t normal_size, size_t peak_size=0,
+			    PeakBufferPool *pool=nullptr) noexcept
 		:BufferedSocket(_fd, _loop), IdleMonitor(_loop),
-		 output(normal_size, peak_size) {
+		 output(normal_size, peak_size, pool) {
 	}
 
 	using BufferedSocket::IsDefined;
@@ -45,8 +48,24 @@ public:
 	}
 
 private:
+	/**
+	 * Handle a send failure: cancel the monitors and report the
+	 * error (unless it was EAGAIN).
+	 *
+	 * @return 0 if the error was EAGAIN, -1 on "real" errors
+	 */
+	ssize_t HandleWriteError() noexcept;
+
 	ssize_t DirectWrite(const void *data, size_t length) noexcept;
 
+#ifndef _WIN32
+	/**
+	 * Like DirectWrite(), but send multiple buffers with one
+	 * system call.
+	 */
+	ssize_t DirectWriteV(const struct iovec *v, size_t n) noexcept;
+#endif
+
 protected:
 	/**
 	 * Send data from the output buffer to the socket.
@@ -21,6 +21,7 @@
 #include "SocketMonitor.hxx"
 #include "IdleMonitor.hxx"
 #include "DeferEvent.hxx"
+#include "Metrics.hxx"
 #include "util/ScopeExit.hxx"
 
 EventLoop::EventLoop(ThreadId _thread)
@@ -93,7 +94,13 @@ EventLoop::AddTimer(TimerEvent &t, std::chrono::steady_clock::duration d) noexce
 	assert(IsInside());
 
 	t.due = now + d;
-	timers.insert(t);
+
+	/* most timers use one of a few fixed durations (e.g. the
+	   per-client timeout), so the new timer is usually the last
+	   one to expire; with the end() hint, such inserts are
+	   amortized O(1) instead of O(log n) */
+	timers.insert(timers.end(), t);
+
 	again = true;
 }
 
@@ -178,6 +185,25 @@ EventLoop::Run() noexcept
 				return;
 		}
 
+		/* dispatch edge-triggered sockets which are still
+		   ready; take a snapshot of the list so that sockets
+		   which stay ready are deferred to the next
+		   iteration instead of monopolizing this one */
+
+		if (!ready_sockets.empty()) {
+			ReadySocketList tmp;
+			tmp.swap(ready_sockets);
+
+			while (!tmp.empty()) {
+				auto &m = tmp.front();
+				tmp.pop_front();
+				m.Dispatch(0);
+
+				if (quit)
+					return;
+			}
+		}
+
 		/* try to handle DeferEvents without WakeFD
 		   overhead */
 		{
@@ -192,9 +218,18 @@ EventLoop::Run() noexcept
 				continue;
 		}
 
-		/* wait for new event */
+		/* how long this iteration's dispatch phase took;
+		   long dispatches delay all other handlers in this
+		   thread */
+		global_metrics.event_dispatch_latency.Measure(std::chrono::steady_clock::now() - now);
+
+		/* wait for new event; don't sleep if edge-triggered
+		   sockets are still pending */
 
-		poll_group.ReadEvents(poll_result, ExportTimeoutMS(timeout));
+		poll_group.ReadEvents(poll_result,
+				      ready_sockets.empty()
+				      ? ExportTimeoutMS(timeout)
+				      : 0);
 
 		now = std::chrono::steady_clock::now();
 
@@ -74,6 +74,19 @@ class EventLoop final : SocketMonitor
 				       boost::intrusive::constant_time_size<false>> IdleList;
 	IdleList idle;
 
+	typedef boost::intrusive::list<SocketMonitor,
+				       boost::intrusive::member_hook<SocketMonitor,
+								     SocketMonitor::ReadyHook,
+								     &SocketMonitor::ready_hook>,
+				       boost::intrusive::constant_time_size<false>> ReadySocketList;
+
+	/**
+	 * Edge-triggered sockets which are believed to be still
+	 * ready and need to be dispatched again without waiting for
+	 * another kernel event.
+	 */
+	ReadySocketList ready_sockets;
+
 	Mutex mutex;
 
 	typedef boost::intrusive::list<DeferEvent,
@@ -164,6 +177,18 @@ public:
 
 	bool RemoveFD(int fd, SocketMonitor &m) noexcept;
 
+	/**
+	 * Add an edge-triggered socket to the list of sockets with
+	 * pending readiness; it will be dispatched again in the next
+	 * iteration, without going through the kernel.
+	 */
+	void AddReadySocket(SocketMonitor &m) noexcept {
+		assert(IsInside());
+
+		if (!m.ready_hook.is_linked())
+			ready_sockets.push_back(m);
+	}
+
 	void AddIdle(IdleMonitor &i) noexcept;
 	void RemoveIdle(IdleMonitor &i) noexcept;
 
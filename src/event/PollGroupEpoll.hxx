@@ -68,6 +68,9 @@ public:
 	static constexpr unsigned WRITE = EPOLLOUT;
 	static constexpr unsigned ERROR = EPOLLERR;
 	static constexpr unsigned HANGUP = EPOLLHUP;
+	static constexpr unsigned EDGE = EPOLLET;
+
+	static constexpr bool HAS_EDGE_TRIGGER = true;
 
 	PollGroupEpoll() = default;
 
@@ -46,6 +46,9 @@ public:
 	static constexpr unsigned WRITE = POLLOUT;
 	static constexpr unsigned ERROR = POLLERR;
 	static constexpr unsigned HANGUP = POLLHUP;
+	static constexpr unsigned EDGE = 0;
+
+	static constexpr bool HAS_EDGE_TRIGGER = false;
 
 	PollGroupPoll() noexcept;
 	~PollGroupPoll() noexcept;
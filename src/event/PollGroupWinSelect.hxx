@@ -113,6 +113,9 @@ public:
 	static constexpr unsigned WRITE = 2;
 	static constexpr unsigned ERROR = 0;
 	static constexpr unsigned HANGUP = 0;
+	static constexpr unsigned EDGE = 0;
+
+	static constexpr bool HAS_EDGE_TRIGGER = false;
 
 	PollGroupWinSelect() noexcept;
 	~PollGroupWinSelect() noexcept;
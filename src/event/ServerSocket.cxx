@@ -141,25 +141,36 @@ get_remote_uid(int fd)
 inline void
 ServerSocket::OneServerSocket::Accept() noexcept
 {
-	StaticSocketAddress peer_address;
-	UniqueSocketDescriptor peer_fd(GetSocket().AcceptNonBlock(peer_address));
-	if (!peer_fd.IsDefined()) {
-		const SocketErrorMessage msg;
-		FormatError(server_socket_domain,
-			    "accept() failed: %s", (const char *)msg);
-		return;
-	}
+	/* accept all pending connections in one go; after a mass
+	   reconnect, waking up the event loop once per connection
+	   would be much more expensive */
+
+	while (true) {
+		StaticSocketAddress peer_address;
+		UniqueSocketDescriptor peer_fd(GetSocket().AcceptNonBlock(peer_address));
+		if (!peer_fd.IsDefined()) {
+			const auto error = GetSocketError();
+			if (!IsSocketErrorAgain(error)) {
+				const SocketErrorMessage msg(error);
+				FormatError(server_socket_domain,
+					    "accept() failed: %s",
+					    (const char *)msg);
+			}
 
-	if (!peer_fd.SetKeepAlive()) {
-		const SocketErrorMessage msg;
-		FormatError(server_socket_domain,
-			    "Could not set TCP keepalive option: %s",
-			    (const char *)msg);
-	}
+			return;
+		}
 
-	const auto uid = get_remote_uid(peer_fd.Get());
+		if (!peer_fd.SetKeepAlive()) {
+			const SocketErrorMessage msg;
+			FormatError(server_socket_domain,
+				    "Could not set TCP keepalive option: %s",
+				    (const char *)msg);
+		}
+
+		const auto uid = get_remote_uid(peer_fd.Get());
 
-	parent.OnAccept(std::move(peer_fd), peer_address, uid);
+		parent.OnAccept(std::move(peer_fd), peer_address, uid);
+	}
 }
 
 bool
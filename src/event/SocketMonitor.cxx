@@ -31,7 +31,19 @@
 void
 SocketMonitor::Dispatch(unsigned flags) noexcept
 {
-	flags &= GetScheduledFlags();
+	if (edge) {
+		ready_flags |= flags;
+		flags = ready_flags & GetScheduledFlags();
+
+		if (flags != 0)
+			/* assume the socket stays ready until the
+			   handler sees EAGAIN and calls
+			   ClearReadyFlags() (or loses interest); the
+			   #EventLoop will dispatch this object again
+			   while it remains linked */
+			loop.AddReadySocket(*this);
+	} else
+		flags &= GetScheduledFlags();
 
 	if (flags != 0 && !OnSocketReady(flags) && IsDefined())
 		Cancel();
@@ -76,6 +88,36 @@ SocketMonitor::Schedule(unsigned flags) noexcept
 	if (flags == GetScheduledFlags())
 		return;
 
+	if (edge) {
+		/* edge-triggered mode: the socket is registered once
+		   with the full event mask, and interest changes
+		   only adjust the dispatch filter, without any
+		   epoll_ctl() traffic */
+		if (scheduled_flags == 0)
+			loop.AddFD(fd.Get(),
+				   READ|WRITE|ERROR|HANGUP|PollGroup::EDGE,
+				   *this);
+		else if (flags == 0) {
+			loop.RemoveFD(fd.Get(), *this);
+			ready_flags = 0;
+
+			if (ready_hook.is_linked())
+				ready_hook.unlink();
+		} else if ((ready_flags & flags & ~scheduled_flags) != 0)
+			/* interest was extended to an event which
+			   has already fired: dispatch it from the
+			   next EventLoop iteration */
+			loop.AddReadySocket(*this);
+
+		scheduled_flags = flags;
+
+		if ((ready_flags & scheduled_flags) == 0 &&
+		    ready_hook.is_linked())
+			ready_hook.unlink();
+
+		return;
+	}
+
 	if (scheduled_flags == 0)
 		loop.AddFD(fd.Get(), flags, *this);
 	else if (flags == 0)
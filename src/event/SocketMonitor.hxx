@@ -23,6 +23,8 @@
 #include "PollGroup.hxx"
 #include "net/SocketDescriptor.hxx"
 
+#include <boost/intrusive/list_hook.hpp>
+
 #include <type_traits>
 
 #include <assert.h>
@@ -44,6 +46,16 @@ class EventLoop;
  * as thread-safe.
  */
 class SocketMonitor {
+	friend class EventLoop;
+
+	typedef boost::intrusive::list_member_hook<boost::intrusive::link_mode<boost::intrusive::auto_unlink>> ReadyHook;
+
+	/**
+	 * A hook which links this object into the #EventLoop's list
+	 * of edge-triggered sockets with pending readiness.
+	 */
+	ReadyHook ready_hook;
+
 	SocketDescriptor fd = SocketDescriptor::Undefined();
 	EventLoop &loop;
 
@@ -52,6 +64,20 @@ class SocketMonitor {
 	 */
 	unsigned scheduled_flags = 0;
 
+	/**
+	 * In edge-triggered mode: a bit mask of events which the
+	 * kernel has reported and which have not been consumed (via
+	 * ClearReadyFlags()) yet.
+	 */
+	unsigned ready_flags = 0;
+
+	/**
+	 * Was this socket registered in edge-triggered mode?  Opt-in
+	 * via EnableEdgeTriggered(); always false if the poll
+	 * backend has no edge trigger support.
+	 */
+	bool edge = false;
+
 public:
 	static constexpr unsigned READ = PollGroup::READ;
 	static constexpr unsigned WRITE = PollGroup::WRITE;
@@ -120,7 +146,41 @@ public:
 		Schedule(GetScheduledFlags() & ~WRITE);
 	}
 
+	/**
+	 * Register this socket in edge-triggered mode: it is added
+	 * to the kernel poll set once with the full event mask, and
+	 * Schedule() merely adjusts the dispatch filter without any
+	 * epoll_ctl() traffic.  Useful for persistent sockets which
+	 * toggle their interest frequently (e.g. streaming clients).
+	 *
+	 * The caller's I/O code must call ClearReadyFlags() whenever
+	 * a socket operation fails with EAGAIN, or this object will
+	 * be dispatched in a busy loop.
+	 *
+	 * Must be called before the first Schedule() call.  No-op if
+	 * the poll backend does not support edge triggering.
+	 */
+	void EnableEdgeTriggered() noexcept {
+		assert(scheduled_flags == 0);
+
+		if (PollGroup::HAS_EDGE_TRIGGER)
+			edge = true;
+	}
+
 protected:
+	/**
+	 * In edge-triggered mode: the given events are not ready
+	 * anymore (i.e. the last operation returned EAGAIN); clear
+	 * them until the kernel reports the next edge.
+	 */
+	void ClearReadyFlags(unsigned flags) noexcept {
+		ready_flags &= ~flags;
+
+		if ((ready_flags & scheduled_flags) == 0 &&
+		    ready_hook.is_linked())
+			ready_hook.unlink();
+	}
+
 	/**
 	 * @return false if the socket has been closed
 	 */
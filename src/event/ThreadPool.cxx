@@ -0,0 +1,73 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "ThreadPool.hxx"
+
+#include <algorithm>
+
+#include <assert.h>
+
+void
+EventThreadPool::SetThreadCount(unsigned _thread_count) noexcept
+{
+	assert(threads.empty());
+
+	thread_count = std::max(1u, _thread_count);
+}
+
+void
+EventThreadPool::EnsureThreadsExist() noexcept
+{
+	if (!threads.empty())
+		return;
+
+	for (unsigned i = 0; i < thread_count; ++i)
+		threads.emplace_back();
+
+	next = threads.begin();
+}
+
+EventLoop &
+EventThreadPool::GetEventLoop() noexcept
+{
+	EnsureThreadsExist();
+
+	auto &result = next->GetEventLoop();
+
+	if (++next == threads.end())
+		next = threads.begin();
+
+	return result;
+}
+
+void
+EventThreadPool::Start()
+{
+	EnsureThreadsExist();
+
+	for (auto &i : threads)
+		i.Start();
+}
+
+void
+EventThreadPool::Stop() noexcept
+{
+	for (auto &i : threads)
+		i.Stop();
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_EVENT_THREAD_POOL_HXX
+#define MPD_EVENT_THREAD_POOL_HXX
+
+#include "Thread.hxx"
+
+#include <list>
+
+/**
+ * A small pool of #EventThread instances.  Each GetEventLoop() call
+ * returns the next thread's #EventLoop in round-robin order, which
+ * distributes independent backends (curl transfers, NFS connections,
+ * mounted storages, ...) over all threads: one busy callback no
+ * longer stalls every other backend.
+ *
+ * Objects bound to one of the returned #EventLoop instances stay on
+ * that loop for their whole life; only the assignment of new clients
+ * rotates.
+ *
+ * All methods may only be called from the thread which owns this
+ * object (usually the main thread).
+ */
+class EventThreadPool final {
+	std::list<EventThread> threads;
+
+	/**
+	 * The thread whose #EventLoop will be handed out by the next
+	 * GetEventLoop() call.
+	 */
+	std::list<EventThread>::iterator next;
+
+	/**
+	 * The configured pool size; see SetThreadCount().
+	 */
+	unsigned thread_count = 1;
+
+public:
+	/**
+	 * Configure the number of threads.  May only be called before
+	 * the first GetEventLoop() call.
+	 */
+	void SetThreadCount(unsigned _thread_count) noexcept;
+
+	/**
+	 * Pick an #EventLoop for a new client, advancing the
+	 * round-robin pointer.
+	 */
+	EventLoop &GetEventLoop() noexcept;
+
+	/**
+	 * Start all threads.
+	 */
+	void Start();
+
+	/**
+	 * Stop and join all threads.
+	 */
+	void Stop() noexcept;
+
+private:
+	/**
+	 * Create the #EventThread instances if that has not happened
+	 * yet.  Deferred until the pool is first used, so
+	 * SetThreadCount() can be called after construction.
+	 */
+	void EnsureThreadsExist() noexcept;
+};
+
+#endif
@@ -19,6 +19,13 @@
 
 #include "Filter.hxx"
 #include "util/ConstBuffer.hxx"
+#include "util/WritableBuffer.hxx"
+
+ConstBuffer<void>
+Filter::FilterInPlace(WritableBuffer<void> src)
+{
+	return FilterPCM(src);
+}
 
 ConstBuffer<void>
 Filter::Flush()
@@ -25,6 +25,7 @@
 #include <assert.h>
 
 template<typename T> struct ConstBuffer;
+template<typename T> struct WritableBuffer;
 
 class Filter {
 protected:
@@ -63,6 +64,21 @@ public:
 	 */
 	virtual ConstBuffer<void> FilterPCM(ConstBuffer<void> src) = 0;
 
+	/**
+	 * Like FilterPCM(), but the given buffer is writable, and the
+	 * implementation may modify it in place instead of copying
+	 * the data to its own buffer.  The caller guarantees that
+	 * nobody else will read the buffer again.  The default
+	 * implementation falls back to FilterPCM().
+	 *
+	 * Throws std::runtime_error on error.
+	 *
+	 * @param src the writable input buffer
+	 * @return the destination buffer on success (may be the given
+	 * buffer; invalidated like the FilterPCM() return value)
+	 */
+	virtual ConstBuffer<void> FilterInPlace(WritableBuffer<void> src);
+
 	/**
 	 * Flush pending data and return it.  This should be called
 	 * repepatedly until it returns nullptr.
@@ -21,6 +21,7 @@
 #include "Filter.hxx"
 #include "Prepared.hxx"
 #include "util/ConstBuffer.hxx"
+#include "util/WritableBuffer.hxx"
 
 #include <assert.h>
 
@@ -79,6 +80,10 @@ public:
 		return filter->FilterPCM(src);
 	}
 
+	ConstBuffer<void> FilterInPlace(WritableBuffer<void> src) override {
+		return filter->FilterInPlace(src);
+	}
+
 	ConstBuffer<void> Flush() override {
 		return filter->Flush();
 	}
@@ -25,6 +25,7 @@
 #include "filter/FilterRegistry.hxx"
 #include "AudioFormat.hxx"
 #include "util/ConstBuffer.hxx"
+#include "util/WritableBuffer.hxx"
 
 #include <memory>
 
@@ -56,6 +57,7 @@ public:
 	}
 
 	ConstBuffer<void> FilterPCM(ConstBuffer<void> src) override;
+	ConstBuffer<void> FilterInPlace(WritableBuffer<void> src) override;
 };
 
 class PreparedAutoConvertFilter final : public PreparedFilter {
@@ -98,12 +100,33 @@ PreparedAutoConvertFilter::Open(AudioFormat &in_audio_format)
 ConstBuffer<void>
 AutoConvertFilter::FilterPCM(ConstBuffer<void> src)
 {
-	if (convert != nullptr)
-		src = convert->FilterPCM(src);
+	if (convert != nullptr) {
+		auto dest = convert->FilterPCM(src);
+		if (dest.data != src.data)
+			/* the convert_filter has copied the data into
+			   a buffer it owns; the underlying filter may
+			   modify it in place */
+			return filter->FilterInPlace({const_cast<void *>(dest.data),
+						      dest.size});
+
+		src = dest;
+	}
 
 	return filter->FilterPCM(src);
 }
 
+ConstBuffer<void>
+AutoConvertFilter::FilterInPlace(WritableBuffer<void> src)
+{
+	if (convert != nullptr) {
+		auto dest = convert->FilterInPlace(src);
+		return filter->FilterInPlace({const_cast<void *>(dest.data),
+					      dest.size});
+	}
+
+	return filter->FilterInPlace(src);
+}
+
 std::unique_ptr<PreparedFilter>
 autoconvert_filter_new(std::unique_ptr<PreparedFilter> filter) noexcept
 {
@@ -22,6 +22,7 @@
 #include "filter/Prepared.hxx"
 #include "AudioFormat.hxx"
 #include "util/ConstBuffer.hxx"
+#include "util/WritableBuffer.hxx"
 #include "util/StringBuffer.hxx"
 #include "util/RuntimeError.hxx"
 
@@ -65,6 +66,7 @@ public:
 	/* virtual methods from class Filter */
 	void Reset() noexcept override;
 	ConstBuffer<void> FilterPCM(ConstBuffer<void> src) override;
+	ConstBuffer<void> FilterInPlace(WritableBuffer<void> src) override;
 	ConstBuffer<void> Flush() override;
 
 private:
@@ -137,14 +139,28 @@ ChainFilter::Reset() noexcept
 		child.filter->Reset();
 }
 
+/**
+ * @param writable is #src a writable buffer which the filters may
+ * modify in place?
+ */
 template<typename I>
 static ConstBuffer<void>
-ApplyFilterChain(I begin, I end, ConstBuffer<void> src)
+ApplyFilterChain(I begin, I end, ConstBuffer<void> src, bool writable)
 {
-	for (auto i = begin; i != end; ++i)
+	for (auto i = begin; i != end; ++i) {
 		/* feed the output of the previous filter as input
 		   into the current one */
-		src = i->filter->FilterPCM(src);
+		auto dest = writable
+			? i->filter->FilterInPlace({const_cast<void *>(src.data),
+						    src.size})
+			: i->filter->FilterPCM(src);
+
+		/* as soon as a filter has copied the data into a
+		   buffer it owns, the following filters may modify
+		   that buffer in place */
+		writable = writable || dest.data != src.data;
+		src = dest;
+	}
 
 	return src;
 }
@@ -154,8 +170,20 @@ ChainFilter::FilterPCM(ConstBuffer<void> src)
 {
 	RewindFlush();
 
-	/* return the output of the last filter */
-	return ApplyFilterChain(children.begin(), children.end(), src);
+	/* return the output of the last filter; the input buffer
+	   belongs to the caller and may be shared, so it must not be
+	   modified */
+	return ApplyFilterChain(children.begin(), children.end(), src,
+				false);
+}
+
+ConstBuffer<void>
+ChainFilter::FilterInPlace(WritableBuffer<void> src)
+{
+	RewindFlush();
+
+	return ApplyFilterChain(children.begin(), children.end(), src,
+				true);
 }
 
 ConstBuffer<void>
@@ -164,8 +192,11 @@ ChainFilter::Flush()
 	for (auto end = children.end(); flushing != end; ++flushing) {
 		auto data = flushing->filter->Flush();
 		if (!data.IsNull())
+			/* the flushed buffer is owned by the flushing
+			   filter, which will not read it back; the
+			   rest of the chain may modify it in place */
 			return ApplyFilterChain(std::next(flushing), end,
-						data);
+						data, true);
 	}
 
 	return nullptr;
@@ -24,27 +24,79 @@
 #include "filter/FilterRegistry.hxx"
 #include "pcm/PcmBuffer.hxx"
 #include "AudioFormat.hxx"
-#include "AudioCompress/compress.h"
 #include "util/ConstBuffer.hxx"
+#include "util/WritableBuffer.hxx"
 
+#include <algorithm>
+#include <array>
+
+#include <math.h>
 #include <string.h>
 
+/**
+ * An automatic gain control filter, a native reimplementation of the
+ * old AudioCompress code: a history of recent chunk peaks determines
+ * a smoothed make-up gain which is capped so the recorded peak cannot
+ * clip.
+ *
+ * It processes "float" samples natively, so normalization no longer
+ * forces a lossy round trip through S16.  The peak scan and the gain
+ * application are written as simple branch-free loops which the
+ * compiler can auto-vectorize.
+ */
 class NormalizeFilter final : public Filter {
-	Compressor *const compressor;
+	/**
+	 * The target peak level (full scale = 1.0; matches the old
+	 * TARGET=16384 on the 16 bit scale).
+	 */
+	static constexpr float TARGET = 16384.0f / 32768;
+
+	/**
+	 * The maximum make-up gain.
+	 */
+	static constexpr float MAX_GAIN = 32;
+
+	/**
+	 * Gain smoothing: the new chunk's target gain contributes
+	 * 2^-GAIN_SMOOTH to the effective gain.
+	 */
+	static constexpr unsigned GAIN_SMOOTH = 8;
+
+	/**
+	 * How many chunk peaks the history covers.
+	 */
+	static constexpr unsigned BUCKETS = 400;
+
+	/**
+	 * History of recent chunk peaks (absolute sample values).
+	 */
+	std::array<float, BUCKETS> peaks;
+
+	/**
+	 * The current position in the #peaks ring buffer.
+	 */
+	unsigned position = 0;
+
+	/**
+	 * The gain which was applied to the last sample of the
+	 * previous chunk.
+	 */
+	float current_gain = 1;
 
 	PcmBuffer buffer;
 
 public:
-	NormalizeFilter(const AudioFormat &audio_format)
-		:Filter(audio_format), compressor(Compressor_new(0)) {
-	}
-
-	~NormalizeFilter() {
-		Compressor_delete(compressor);
+	explicit NormalizeFilter(const AudioFormat &audio_format)
+		:Filter(audio_format) {
+		peaks.fill(0);
 	}
 
 	/* virtual methods from class Filter */
 	ConstBuffer<void> FilterPCM(ConstBuffer<void> src) override;
+	ConstBuffer<void> FilterInPlace(WritableBuffer<void> src) override;
+
+private:
+	void Process(float *data, size_t n) noexcept;
 };
 
 class PreparedNormalizeFilter final : public PreparedFilter {
@@ -62,21 +114,101 @@ normalize_filter_init(gcc_unused const ConfigBlock &block)
 std::unique_ptr<Filter>
 PreparedNormalizeFilter::Open(AudioFormat &audio_format)
 {
-	audio_format.format = SampleFormat::S16;
+	audio_format.format = SampleFormat::FLOAT;
 
 	return std::make_unique<NormalizeFilter>(audio_format);
 }
 
+inline void
+NormalizeFilter::Process(float *data, size_t n) noexcept
+{
+	if (n == 0)
+		return;
+
+	/* determine this chunk's peak; a pure "max" reduction which
+	   auto-vectorizes */
+
+	float chunk_peak = 0;
+	for (size_t i = 0; i < n; ++i)
+		chunk_peak = std::max(chunk_peak, fabsf(data[i]));
+
+	position = (position + 1) % BUCKETS;
+	peaks[position] = chunk_peak;
+
+	float peak = 1.0f / 32768;
+	for (const float p : peaks)
+		peak = std::max(peak, p);
+
+	/* the new target gain, smoothed with inertia from the
+	   previous chunks, limited to MAX_GAIN and at least unity */
+
+	float new_gain = TARGET / peak;
+
+	new_gain = (current_gain * ((1 << GAIN_SMOOTH) - 1) + new_gain)
+		/ (1 << GAIN_SMOOTH);
+
+	new_gain = std::min(new_gain, MAX_GAIN);
+	new_gain = std::max(new_gain, 1.0f);
+
+	/* make sure the recorded peak cannot clip: the new gain must
+	   be effective before the peak sample plays */
+
+	size_t ramp = n;
+	if (peak * new_gain > 1) {
+		new_gain = 1 / peak;
+
+		/* locating the peak is only needed in this rare case,
+		   which keeps the hot scan above trivial */
+		ramp = 0;
+		for (size_t i = 0; i < n; ++i)
+			if (fabsf(data[i]) >= chunk_peak) {
+				ramp = i;
+				break;
+			}
+	}
+
+	/* ramp linearly from the previous gain to the new one, then
+	   apply the constant new gain; both loops are branch-free
+	   multiply-and-clamp bodies */
+
+	const float delta = ramp > 0
+		? (new_gain - current_gain) / ramp
+		: 0;
+
+	for (size_t i = 0; i < ramp; ++i) {
+		float sample = data[i] * (current_gain + delta * i);
+		sample = std::min(sample, 1.0f);
+		sample = std::max(sample, -1.0f);
+		data[i] = sample;
+	}
+
+	for (size_t i = ramp; i < n; ++i) {
+		float sample = data[i] * new_gain;
+		sample = std::min(sample, 1.0f);
+		sample = std::max(sample, -1.0f);
+		data[i] = sample;
+	}
+
+	current_gain = new_gain;
+}
+
 ConstBuffer<void>
 NormalizeFilter::FilterPCM(ConstBuffer<void> src)
 {
-	int16_t *dest = (int16_t *)buffer.Get(src.size);
+	float *dest = (float *)buffer.Get(src.size);
 	memcpy(dest, src.data, src.size);
 
-	Compressor_Process_int16(compressor, dest, src.size / 2);
+	Process(dest, src.size / sizeof(float));
 	return { (const void *)dest, src.size };
 }
 
+ConstBuffer<void>
+NormalizeFilter::FilterInPlace(WritableBuffer<void> src)
+{
+	Process((float *)src.data, src.size / sizeof(float));
+	return src;
+}
+
 const FilterPlugin normalize_filter_plugin = {
 	"normalize",
 	normalize_filter_init,
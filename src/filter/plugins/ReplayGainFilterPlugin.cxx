@@ -26,6 +26,7 @@
 #include "mixer/MixerControl.hxx"
 #include "pcm/Volume.hxx"
 #include "util/ConstBuffer.hxx"
+#include "util/WritableBuffer.hxx"
 #include "util/Domain.hxx"
 #include "Log.hxx"
 
@@ -109,6 +110,7 @@ public:
 
 	/* virtual methods from class Filter */
 	ConstBuffer<void> FilterPCM(ConstBuffer<void> src) override;
+	ConstBuffer<void> FilterInPlace(WritableBuffer<void> src) override;
 };
 
 class PreparedReplayGainFilter final : public PreparedFilter {
@@ -191,6 +193,15 @@ ReplayGainFilter::FilterPCM(ConstBuffer<void> src)
 		: pv.Apply(src);
 }
 
+ConstBuffer<void>
+ReplayGainFilter::FilterInPlace(WritableBuffer<void> src)
+{
+	if (mixer == nullptr)
+		pv.ApplyInPlace(src);
+
+	return src;
+}
+
 void
 replay_gain_filter_set_mixer(PreparedFilter &_filter, Mixer *mixer,
 			     unsigned base)
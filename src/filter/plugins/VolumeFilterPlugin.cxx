@@ -23,6 +23,7 @@
 #include "pcm/Volume.hxx"
 #include "AudioFormat.hxx"
 #include "util/ConstBuffer.hxx"
+#include "util/WritableBuffer.hxx"
 
 #include <stdexcept>
 
@@ -45,6 +46,7 @@ public:
 
 	/* virtual methods from class Filter */
 	ConstBuffer<void> FilterPCM(ConstBuffer<void> src) override;
+	ConstBuffer<void> FilterInPlace(WritableBuffer<void> src) override;
 };
 
 class PreparedVolumeFilter final : public PreparedFilter {
@@ -65,6 +67,13 @@ VolumeFilter::FilterPCM(ConstBuffer<void> src)
 	return pv.Apply(src);
 }
 
+ConstBuffer<void>
+VolumeFilter::FilterInPlace(WritableBuffer<void> src)
+{
+	pv.ApplyInPlace(src);
+	return src;
+}
+
 std::unique_ptr<PreparedFilter>
 volume_filter_prepare() noexcept
 {
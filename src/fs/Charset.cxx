@@ -22,6 +22,9 @@
 #include "Log.hxx"
 #include "lib/icu/Converter.hxx"
 #include "util/AllocatedString.hxx"
+#include "util/ASCII.hxx"
+#include "util/RuntimeError.hxx"
+#include "util/UTF8.hxx"
 #include "config.h"
 
 #ifdef _WIN32
@@ -29,6 +32,12 @@
 #include <windows.h>
 #endif
 
+#ifdef HAVE_FS_CHARSET
+#include "thread/Mutex.hxx"
+
+#include <list>
+#endif
+
 #include <algorithm>
 #include <stdexcept>
 
@@ -41,14 +50,74 @@ static std::string fs_charset;
 
 static IcuConverter *fs_converter;
 
+/**
+ * A small LRU cache for charset conversion results.  During database
+ * update, the same directory prefixes are converted over and over;
+ * caching them eliminates most of the converter overhead from the
+ * scan path.  It is consulted from several threads and therefore
+ * protected by a mutex.
+ */
+class CharsetCache {
+	static constexpr size_t MAX_SIZE = 16;
+
+	Mutex mutex;
+
+	std::list<std::pair<std::string, std::string>> entries;
+
+public:
+	bool Lookup(const char *src, std::string &result) noexcept {
+		const std::lock_guard<Mutex> protect(mutex);
+
+		for (auto i = entries.begin(); i != entries.end(); ++i) {
+			if (i->first == src) {
+				result = i->second;
+				entries.splice(entries.begin(), entries, i);
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void Store(const char *src, const std::string &result) noexcept {
+		const std::lock_guard<Mutex> protect(mutex);
+
+		while (entries.size() >= MAX_SIZE)
+			entries.pop_back();
+
+		entries.emplace_front(src, result);
+	}
+
+	void Clear() noexcept {
+		const std::lock_guard<Mutex> protect(mutex);
+		entries.clear();
+	}
+};
+
+static CharsetCache to_utf8_cache, from_utf8_cache;
+
+gcc_pure
+static bool
+IsUTF8Charset(const char *charset) noexcept
+{
+	return StringEqualsCaseASCII(charset, "UTF-8") ||
+		StringEqualsCaseASCII(charset, "UTF8");
+}
+
 void
 SetFSCharset(const char *charset)
 {
 	assert(charset != nullptr);
 	assert(fs_converter == nullptr);
 
-	fs_converter = IcuConverter::Create(charset);
-	assert(fs_converter != nullptr);
+	fs_charset = charset;
+
+	if (!IsUTF8Charset(charset)) {
+		fs_converter = IcuConverter::Create(charset);
+		assert(fs_converter != nullptr);
+	}
+	/* else: no converter needed, the fast path in PathToUTF8()
+	   and PathFromUTF8() merely validates */
 
 	FormatDebug(path_domain,
 		    "SetFSCharset: fs charset is: %s", fs_charset.c_str());
@@ -63,6 +132,12 @@ DeinitFSCharset() noexcept
 	delete fs_converter;
 	fs_converter = nullptr;
 #endif
+
+#ifdef HAVE_FS_CHARSET
+	fs_charset.clear();
+	to_utf8_cache.Clear();
+	from_utf8_cache.Clear();
+#endif
 }
 
 const char *
@@ -105,13 +180,26 @@ PathToUTF8(PathTraitsFS::const_pointer_type path_fs)
 	return FixSeparators(PathTraitsUTF8::string(buffer.c_str()));
 #else
 #ifdef HAVE_FS_CHARSET
-	if (fs_converter == nullptr)
+	if (fs_converter == nullptr) {
+		if (!fs_charset.empty() && !ValidateUTF8(path_fs))
+			/* the configured charset is UTF-8: no
+			   conversion needed, but malformed input must
+			   still be rejected */
+			throw FormatRuntimeError("Invalid UTF-8 path: %s",
+						 path_fs);
 #endif
 		return FixSeparators(path_fs);
 #ifdef HAVE_FS_CHARSET
+	}
+
+	std::string result;
+	if (to_utf8_cache.Lookup(path_fs, result))
+		return FixSeparators(std::move(result));
 
 	const auto buffer = fs_converter->ToUTF8(path_fs);
-	return FixSeparators(PathTraitsUTF8::string(buffer.c_str()));
+	result = buffer.c_str();
+	to_utf8_cache.Store(path_fs, result);
+	return FixSeparators(std::move(result));
 #endif
 #endif
 }
@@ -130,11 +218,22 @@ PathFromUTF8(PathTraitsUTF8::const_pointer_type path_utf8)
 	const auto buffer = MultiByteToWideChar(CP_UTF8, path_utf8);
 	return PathTraitsFS::string(buffer.c_str());
 #else
-	if (fs_converter == nullptr)
+	if (fs_converter == nullptr) {
+		if (!fs_charset.empty() && !ValidateUTF8(path_utf8))
+			throw FormatRuntimeError("Invalid UTF-8 path: %s",
+						 path_utf8);
+
 		return path_utf8;
+	}
+
+	std::string result;
+	if (from_utf8_cache.Lookup(path_utf8, result))
+		return result;
 
 	const auto buffer = fs_converter->FromUTF8(path_utf8);
-	return PathTraitsFS::string(buffer.c_str());
+	result = buffer.c_str();
+	from_utf8_cache.Store(path_utf8, result);
+	return result;
 #endif
 }
 
@@ -93,6 +93,15 @@ public:
 	Path GetEntry() const {
 		return Path::FromFS(data.cFileName);
 	}
+
+	/**
+	 * May the current entry be a symbolic link?  Returns false
+	 * only if it is known for sure that it is not one.
+	 */
+	bool MaybeSymlink() const {
+		return (data.dwFileAttributes &
+			FILE_ATTRIBUTE_REPARSE_POINT) != 0;
+	}
 };
 
 #else
@@ -146,6 +155,22 @@ public:
 		assert(HasEntry());
 		return Path::FromFS(ent->d_name);
 	}
+
+	/**
+	 * May the current entry be a symbolic link?  Returns false
+	 * only if the file system has filled in the "d_type" field
+	 * and it is not #DT_LNK, which allows callers to elide a
+	 * readlink() system call.
+	 */
+	bool MaybeSymlink() const {
+		assert(HasEntry());
+
+#ifdef _DIRENT_HAVE_D_TYPE
+		return ent->d_type == DT_LNK || ent->d_type == DT_UNKNOWN;
+#else
+		return true;
+#endif
+	}
 };
 
 #endif
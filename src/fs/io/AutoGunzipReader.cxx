@@ -18,13 +18,28 @@
  */
 
 #include "AutoGunzipReader.hxx"
+
+#ifdef ENABLE_ZLIB
 #include "GunzipReader.hxx"
+#endif
+
+#ifdef ENABLE_ZSTD
+#include "ZstdReader.hxx"
+#endif
 
 AutoGunzipReader::~AutoGunzipReader()
 {
+#ifdef ENABLE_ZLIB
 	delete gunzip;
+#endif
+
+#ifdef ENABLE_ZSTD
+	delete zstd;
+#endif
 }
 
+#ifdef ENABLE_ZLIB
+
 gcc_pure
 static bool
 IsGzip(const uint8_t data[4]) noexcept
@@ -33,6 +48,20 @@ IsGzip(const uint8_t data[4]) noexcept
 		(data[3] & 0xe0) == 0;
 }
 
+#endif
+
+#ifdef ENABLE_ZSTD
+
+gcc_pure
+static bool
+IsZstd(const uint8_t data[4]) noexcept
+{
+	return data[0] == 0x28 && data[1] == 0xb5 &&
+		data[2] == 0x2f && data[3] == 0xfd;
+}
+
+#endif
+
 inline void
 AutoGunzipReader::Detect()
 {
@@ -42,10 +71,21 @@ AutoGunzipReader::Detect()
 		return;
 	}
 
-	if (IsGzip(data))
+#ifdef ENABLE_ZLIB
+	if (IsGzip(data)) {
 		next = gunzip = new GunzipReader(peek);
-	else
-		next = &peek;
+		return;
+	}
+#endif
+
+#ifdef ENABLE_ZSTD
+	if (IsZstd(data)) {
+		next = zstd = new ZstdReader(peek);
+		return;
+	}
+#endif
+
+	next = &peek;
 }
 
 size_t
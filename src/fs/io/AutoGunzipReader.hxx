@@ -20,19 +20,28 @@
 #ifndef MPD_AUTO_GUNZIP_READER_HXX
 #define MPD_AUTO_GUNZIP_READER_HXX
 
+#include "config.h"
 #include "PeekReader.hxx"
 #include "util/Compiler.h"
 
 class GunzipReader;
+class ZstdReader;
 
 /**
- * A filter that detects gzip compression and optionally inserts a
- * #GunzipReader.
+ * A filter that detects gzip or zstd compression and optionally
+ * inserts the matching decompressor.
  */
 class AutoGunzipReader final : public Reader {
 	Reader *next = nullptr;
 	PeekReader peek;
+
+#ifdef ENABLE_ZLIB
 	GunzipReader *gunzip = nullptr;
+#endif
+
+#ifdef ENABLE_ZSTD
+	ZstdReader *zstd = nullptr;
+#endif
 
 public:
 	explicit AutoGunzipReader(Reader &_next)
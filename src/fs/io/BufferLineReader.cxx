@@ -0,0 +1,51 @@
+/*
+ * Copyright 2003-2019 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "BufferLineReader.hxx"
+
+#include <assert.h>
+#include <string.h>
+
+BufferLineReader::BufferLineReader(char *begin, char *_end) noexcept
+	:cursor(begin), end(_end)
+{
+	assert(begin <= end);
+	assert(begin == end || end[-1] == '\n');
+}
+
+char *
+BufferLineReader::ReadLine()
+{
+	if (cursor >= end)
+		return nullptr;
+
+	char *line = cursor;
+
+	/* the buffer ends with a newline, so this cannot fail */
+	char *newline = (char *)memchr(cursor, '\n', end - cursor);
+	assert(newline != nullptr);
+
+	cursor = newline + 1;
+
+	if (newline > line && newline[-1] == '\r')
+		--newline;
+	*newline = 0;
+
+	return line;
+}
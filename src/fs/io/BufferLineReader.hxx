@@ -0,0 +1,46 @@
+/*
+ * Copyright 2003-2019 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_BUFFER_LINE_READER_HXX
+#define MPD_BUFFER_LINE_READER_HXX
+
+#include "LineReader.hxx"
+
+/**
+ * A #LineReader implementation over a writable in-memory buffer
+ * which parses lines in place, like #MmapLineReader does for a whole
+ * file.  The buffer must end with a newline character, because the
+ * null terminators are written over the newline (or preceding
+ * carriage return) bytes.
+ */
+class BufferLineReader final : public LineReader {
+	char *cursor;
+	char *const end;
+
+public:
+	BufferLineReader(char *begin, char *_end) noexcept;
+
+	BufferLineReader(const BufferLineReader &) = delete;
+	BufferLineReader &operator=(const BufferLineReader &) = delete;
+
+	/* virtual methods from class LineReader */
+	char *ReadLine() override;
+};
+
+#endif
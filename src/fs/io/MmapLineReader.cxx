@@ -0,0 +1,93 @@
+/*
+ * Copyright 2003-2019 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "MmapLineReader.hxx"
+#include "fs/Path.hxx"
+#include "system/Error.hxx"
+#include "system/UniqueFileDescriptor.hxx"
+
+#include <sys/mman.h>
+
+#include <string.h>
+
+MmapLineReader::MmapLineReader(Path path_fs)
+	:data(nullptr), size(0), cursor(nullptr), end(nullptr)
+{
+	UniqueFileDescriptor fd;
+	if (!fd.OpenReadOnly(path_fs.c_str()))
+		throw FormatErrno("Failed to open %s", path_fs.c_str());
+
+	size = fd.GetSize();
+	if (size == 0)
+		/* empty file: nothing to map, ReadLine() will return
+		   end-of-file right away */
+		return;
+
+	/* MAP_PRIVATE because ReadLine() writes null terminators
+	   into the mapping; only the touched pages are copied */
+	data = mmap(nullptr, size, PROT_READ|PROT_WRITE, MAP_PRIVATE,
+		    fd.Get(), 0);
+	if (data == MAP_FAILED) {
+		data = nullptr;
+		throw FormatErrno("Failed to map %s", path_fs.c_str());
+	}
+
+	madvise(data, size, MADV_SEQUENTIAL|MADV_WILLNEED);
+
+	cursor = (char *)data;
+	end = cursor + size;
+}
+
+MmapLineReader::~MmapLineReader() noexcept
+{
+	if (data != nullptr)
+		munmap(data, size);
+}
+
+char *
+MmapLineReader::ReadLine()
+{
+	if (cursor >= end)
+		return nullptr;
+
+	char *line = cursor;
+
+	char *newline = (char *)memchr(cursor, '\n', end - cursor);
+	if (newline == nullptr) {
+		/* the file does not end with a newline: the mapping
+		   is padded with zero bytes up to the next page
+		   boundary, but if the size is page-aligned, there is
+		   no room for a null terminator; strip one byte in
+		   that case */
+		if (end == (char *)data + size && size % 4096 == 0)
+			end[-1] = 0;
+		else
+			*end = 0;
+
+		cursor = end;
+	} else {
+		cursor = newline + 1;
+
+		if (newline > line && newline[-1] == '\r')
+			--newline;
+		*newline = 0;
+	}
+
+	return line;
+}
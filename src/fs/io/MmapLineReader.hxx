@@ -0,0 +1,83 @@
+/*
+ * Copyright 2003-2019 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_MMAP_LINE_READER_HXX
+#define MPD_MMAP_LINE_READER_HXX
+
+#include "LineReader.hxx"
+
+#include <assert.h>
+#include <stddef.h>
+
+class Path;
+
+/**
+ * A #LineReader implementation which maps the whole file into the
+ * address space and parses lines in place, without any read() system
+ * calls and without copying data into an intermediate buffer.  The
+ * kernel pages the file in on demand, which makes this considerably
+ * faster than #TextFile for large files such as the database.
+ *
+ * Not available on Windows.
+ */
+class MmapLineReader final : public LineReader {
+	void *data;
+	size_t size;
+
+	char *cursor, *end;
+
+public:
+	explicit MmapLineReader(Path path_fs);
+
+	MmapLineReader(const MmapLineReader &) = delete;
+	MmapLineReader &operator=(const MmapLineReader &) = delete;
+
+	~MmapLineReader() noexcept;
+
+	/**
+	 * Returns the start of the not-yet-consumed part of the
+	 * mapping.  The caller may inspect (and modify) it directly
+	 * and resume reading lines after calling Seek().
+	 */
+	char *GetCursor() noexcept {
+		return cursor;
+	}
+
+	/**
+	 * Returns the end of the mapping.
+	 */
+	char *GetEnd() noexcept {
+		return end;
+	}
+
+	/**
+	 * Skip ahead to the given position inside the mapping.
+	 */
+	void Seek(char *new_cursor) noexcept {
+		assert(new_cursor >= cursor);
+		assert(new_cursor <= end);
+
+		cursor = new_cursor;
+	}
+
+	/* virtual methods from class LineReader */
+	char *ReadLine() override;
+};
+
+#endif
@@ -27,11 +27,11 @@
 
 TextFile::TextFile(Path path_fs)
 	:file_reader(new FileReader(path_fs)),
-#ifdef ENABLE_ZLIB
+#if defined(ENABLE_ZLIB) || defined(ENABLE_ZSTD)
 	 gunzip_reader(new AutoGunzipReader(*file_reader)),
 #endif
 	 buffered_reader(new BufferedReader(*
-#ifdef ENABLE_ZLIB
+#if defined(ENABLE_ZLIB) || defined(ENABLE_ZSTD)
 					    gunzip_reader
 #else
 					    file_reader
@@ -43,7 +43,7 @@ TextFile::TextFile(Path path_fs)
 TextFile::~TextFile()
 {
 	delete buffered_reader;
-#ifdef ENABLE_ZLIB
+#if defined(ENABLE_ZLIB) || defined(ENABLE_ZSTD)
 	delete gunzip_reader;
 #endif
 	delete file_reader;
@@ -20,6 +20,7 @@
 #ifndef MPD_TEXT_FILE_HXX
 #define MPD_TEXT_FILE_HXX
 
+#include "LineReader.hxx"
 #include "util/Compiler.h"
 #include "config.h"
 
@@ -28,10 +29,10 @@ class FileReader;
 class AutoGunzipReader;
 class BufferedReader;
 
-class TextFile {
+class TextFile final : public LineReader {
 	FileReader *const file_reader;
 
-#ifdef ENABLE_ZLIB
+#if defined(ENABLE_ZLIB) || defined(ENABLE_ZSTD)
 	AutoGunzipReader *const gunzip_reader;
 #endif
 
@@ -51,7 +52,7 @@ public:
 	 *
 	 * @return a pointer to the line, or nullptr on end-of-file
 	 */
-	char *ReadLine();
+	char *ReadLine() override;
 };
 
 #endif
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "ZstdOutputStream.hxx"
+#include "lib/zstd/Error.hxx"
+
+#include <new>
+
+#include <stdint.h>
+
+ZstdOutputStream::ZstdOutputStream(OutputStream &_next)
+	:next(_next), cs(ZSTD_createCStream())
+{
+	if (cs == nullptr)
+		throw std::bad_alloc();
+
+	/* level 0 selects zstd's default compression level */
+	const size_t result = ZSTD_initCStream(cs, 0);
+	if (ZSTD_isError(result)) {
+		ZSTD_freeCStream(cs);
+		throw ZstdError(result);
+	}
+}
+
+ZstdOutputStream::~ZstdOutputStream()
+{
+	ZSTD_freeCStream(cs);
+}
+
+void
+ZstdOutputStream::Flush()
+{
+	while (true) {
+		uint8_t output[4096];
+		ZSTD_outBuffer out;
+		out.dst = output;
+		out.size = sizeof(output);
+		out.pos = 0;
+
+		const size_t result = ZSTD_endStream(cs, &out);
+		if (ZSTD_isError(result))
+			throw ZstdError(result);
+
+		if (out.pos > 0)
+			next.Write(output, out.pos);
+
+		if (result == 0)
+			break;
+	}
+}
+
+void
+ZstdOutputStream::Write(const void *data, size_t size)
+{
+	ZSTD_inBuffer in;
+	in.src = data;
+	in.size = size;
+	in.pos = 0;
+
+	while (in.pos < in.size) {
+		uint8_t output[4096];
+		ZSTD_outBuffer out;
+		out.dst = output;
+		out.size = sizeof(output);
+		out.pos = 0;
+
+		const size_t result = ZSTD_compressStream(cs, &out, &in);
+		if (ZSTD_isError(result))
+			throw ZstdError(result);
+
+		if (out.pos > 0)
+			next.Write(output, out.pos);
+	}
+}
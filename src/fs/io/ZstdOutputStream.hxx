@@ -0,0 +1,55 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_ZSTD_OUTPUT_STREAM_HXX
+#define MPD_ZSTD_OUTPUT_STREAM_HXX
+
+#include "OutputStream.hxx"
+#include "util/Compiler.h"
+
+#include <zstd.h>
+
+/**
+ * A filter that compresses data written to it using zstd.
+ *
+ * Don't forget to call Flush() before destructing this object.
+ */
+class ZstdOutputStream final : public OutputStream {
+	OutputStream &next;
+
+	ZSTD_CStream *const cs;
+
+public:
+	/**
+	 * Construct the filter.
+	 */
+	explicit ZstdOutputStream(OutputStream &_next);
+	~ZstdOutputStream();
+
+	/**
+	 * Finish the frame and write all data remaining in zstd's
+	 * output buffer.
+	 */
+	void Flush();
+
+	/* virtual methods from class OutputStream */
+	void Write(const void *data, size_t size) override;
+};
+
+#endif
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "ZstdReader.hxx"
+#include "lib/zstd/Error.hxx"
+
+#include <stdexcept>
+
+#include <assert.h>
+
+ZstdReader::ZstdReader(Reader &_next)
+	:next(_next), ds(ZSTD_createDStream())
+{
+	if (ds == nullptr)
+		throw std::bad_alloc();
+
+	const size_t result = ZSTD_initDStream(ds);
+	if (ZSTD_isError(result)) {
+		ZSTD_freeDStream(ds);
+		throw ZstdError(result);
+	}
+}
+
+inline bool
+ZstdReader::FillBuffer()
+{
+	auto w = buffer.Write();
+	assert(!w.empty());
+
+	size_t nbytes = next.Read(w.data, w.size);
+	if (nbytes == 0)
+		return false;
+
+	buffer.Append(nbytes);
+	return true;
+}
+
+size_t
+ZstdReader::Read(void *data, size_t size)
+{
+	if (eof)
+		return 0;
+
+	ZSTD_outBuffer out;
+	out.dst = data;
+	out.size = size;
+	out.pos = 0;
+
+	while (true) {
+		auto r = buffer.Read();
+		if (r.empty()) {
+			if (FillBuffer())
+				r = buffer.Read();
+			else
+				throw std::runtime_error("Premature end of zstd stream");
+		}
+
+		ZSTD_inBuffer in;
+		in.src = r.data;
+		in.size = r.size;
+		in.pos = 0;
+
+		const size_t result = ZSTD_decompressStream(ds, &out, &in);
+		if (ZSTD_isError(result))
+			throw ZstdError(result);
+
+		buffer.Consume(in.pos);
+
+		if (result == 0) {
+			/* the frame is complete */
+			eof = true;
+			return out.pos;
+		}
+
+		if (out.pos > 0)
+			return out.pos;
+	}
+}
@@ -21,8 +21,24 @@
 #include "thread/Cond.hxx"
 #include "thread/Name.hxx"
 
+#include <atomic>
+
 #include <string.h>
 
+/**
+ * The buffer capacity reserved by all live #BufferedInputStream
+ * instances.  This is address space, not necessarily resident
+ * memory: the #SparseBuffer pages are populated lazily as the input
+ * is read.
+ */
+static std::atomic<size_t> buffered_input_bytes;
+
+size_t
+buffered_input_stream_get_memory_usage() noexcept
+{
+	return buffered_input_bytes.load(std::memory_order_relaxed);
+}
+
 BufferedInputStream::BufferedInputStream(InputStreamPtr _input)
 	:InputStream(_input->GetURI(), _input->mutex),
 	 input(std::move(_input)),
@@ -40,6 +56,8 @@ BufferedInputStream::BufferedInputStream(InputStreamPtr _input)
 	seekable = input->IsSeekable();
 	offset = input->GetOffset();
 
+	buffered_input_bytes.fetch_add(size, std::memory_order_relaxed);
+
 	SetReady();
 
 	thread.Start();
@@ -54,6 +72,8 @@ BufferedInputStream::~BufferedInputStream() noexcept
 	}
 
 	thread.Join();
+
+	buffered_input_bytes.fetch_sub(size, std::memory_order_relaxed);
 }
 
 void
@@ -31,6 +31,14 @@
 
 #include <assert.h>
 
+/**
+ * The buffer capacity reserved by all live #BufferedInputStream
+ * instances in this process, for memory accounting.
+ */
+gcc_pure
+size_t
+buffered_input_stream_get_memory_usage() noexcept;
+
 /**
  * A "huge" buffer which remembers the (partial) contents of an
  * #InputStream.  This works only if the #InputStream is a "file", not
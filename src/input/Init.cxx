@@ -20,6 +20,13 @@
 #include "Init.hxx"
 #include "Registry.hxx"
 #include "InputPlugin.hxx"
+#include "ThreadInputStream.hxx"
+#ifdef ENABLE_INPUT_MMAP
+#include "plugins/MmapInputPlugin.hxx"
+#endif
+#ifdef ENABLE_URING
+#include "plugins/UringInputPlugin.hxx"
+#endif
 #include "config/Data.hxx"
 #include "config/Option.hxx"
 #include "config/Block.hxx"
@@ -36,6 +43,14 @@ input_stream_global_init(const ConfigData &config, EventLoop &event_loop)
 {
 	const ConfigBlock empty;
 
+#ifdef ENABLE_INPUT_MMAP
+	InitMmapInputPlugin(config.GetBool(ConfigOption::INPUT_MMAP, false));
+#endif
+
+#ifdef ENABLE_URING
+	InitUringInputPlugin(event_loop);
+#endif
+
 	for (unsigned i = 0; input_plugins[i] != nullptr; ++i) {
 		const InputPlugin *plugin = input_plugins[i];
 
@@ -76,4 +91,6 @@ input_stream_global_finish() noexcept
 	input_plugins_for_each_enabled(plugin)
 		if (plugin->finish != nullptr)
 			plugin->finish();
+
+	thread_input_stream_finish();
 }
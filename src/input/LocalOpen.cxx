@@ -22,6 +22,14 @@
 #include "plugins/FileInputPlugin.hxx"
 #include "config.h"
 
+#ifdef ENABLE_INPUT_MMAP
+#include "plugins/MmapInputPlugin.hxx"
+#endif
+
+#ifdef ENABLE_URING
+#include "plugins/UringInputPlugin.hxx"
+#endif
+
 #ifdef ENABLE_ARCHIVE
 #include "plugins/ArchiveInputPlugin.hxx"
 #endif
@@ -39,7 +47,15 @@ OpenLocalInputStream(Path path, Mutex &mutex)
 #ifdef ENABLE_ARCHIVE
 	try {
 #endif
-		is = OpenFileInputStream(path, mutex);
+#ifdef ENABLE_INPUT_MMAP
+		is = OpenMmapInputStream(path, mutex);
+		if (is == nullptr)
+#endif
+#ifdef ENABLE_URING
+		is = OpenUringInputStream(path, mutex);
+		if (is == nullptr)
+#endif
+			is = OpenFileInputStream(path, mutex);
 #ifdef ENABLE_ARCHIVE
 	} catch (const std::system_error &e) {
 		if (IsPathNotFound(e)) {
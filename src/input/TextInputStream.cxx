@@ -62,9 +62,13 @@ TextInputStream::ReadLine()
 
 		buffer.Append(nbytes);
 
-		line = ReadBufferedLine(buffer);
-		if (line != nullptr)
+		/* the buffered data has already been searched; only
+		   the newly read block can contain the newline */
+		if (memchr(dest.data, '\n', nbytes) != nullptr) {
+			line = ReadBufferedLine(buffer);
+			assert(line != nullptr);
 			return line;
+		}
 
 		if (nbytes == 0) {
 			/* end of file: see if there's an unterminated
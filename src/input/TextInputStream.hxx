@@ -25,7 +25,12 @@
 
 class TextInputStream {
 	InputStreamPtr is;
-	StaticFifoBuffer<char, 4096> buffer;
+
+	/**
+	 * The read block size; large enough to hold many lines of a
+	 * big playlist per underlying read.
+	 */
+	StaticFifoBuffer<char, 32768> buffer;
 
 public:
 	/**
@@ -19,18 +19,198 @@
 
 #include "ThreadInputStream.hxx"
 #include "CondHandler.hxx"
+#include "thread/Cond.hxx"
 #include "thread/Name.hxx"
+#include "thread/Thread.hxx"
+
+#include <forward_list>
+#include <list>
 
 #include <assert.h>
 #include <string.h>
 
-ThreadInputStream::ThreadInputStream(const char *_plugin,
+/**
+ * A small shared pool of worker threads serving all
+ * #ThreadInputStream instances.  Workers are started on demand up to
+ * a fixed limit and live until thread_input_stream_finish().
+ *
+ * A blocking ThreadRead() occupies one worker for its duration, so
+ * the limit bounds how many stalled streams can delay each other;
+ * streams whose buffer is full do not occupy a worker at all.
+ */
+class InputWorkerPool {
+	/**
+	 * Protects the queue, the thread counters and the
+	 * queued/busy/again flags of all streams.
+	 */
+	Mutex mutex;
+
+	/**
+	 * Signalled when a stream is appended to the queue and when
+	 * #shutdown is set.
+	 */
+	Cond wake_cond;
+
+	/**
+	 * Signalled whenever a worker has finished a Step() call;
+	 * Remove() waits for it.
+	 */
+	Cond drain_cond;
+
+	std::list<ThreadInputStream *> queue;
+
+	std::forward_list<Thread> threads;
+
+	unsigned n_threads = 0, n_idle = 0;
+
+	bool shutdown = false;
+
+	static constexpr unsigned MAX_THREADS = 8;
+
+public:
+	/**
+	 * Schedule a stream to be served by a worker.  No-op if it is
+	 * already queued; if a worker is currently busy with it, it
+	 * will be requeued as soon as that worker is done.
+	 *
+	 * Throws on error (if a new worker thread cannot be spawned).
+	 */
+	void Schedule(ThreadInputStream &tis);
+
+	/**
+	 * Remove a stream from the pool: dequeue it and wait until no
+	 * worker is inside its Step() anymore.
+	 */
+	void Remove(ThreadInputStream &tis) noexcept;
+
+	/**
+	 * Join all worker threads.  All streams must have been
+	 * removed already.
+	 */
+	void Finish() noexcept;
+
+private:
+	void Run() noexcept;
+};
+
+static InputWorkerPool input_worker_pool;
+
+void
+InputWorkerPool::Schedule(ThreadInputStream &tis)
+{
+	const std::lock_guard<Mutex> lock(mutex);
+
+	assert(!shutdown);
+
+	if (tis.busy) {
+		/* the worker may have decided already that there is
+		   nothing left to do; make sure the stream gets
+		   another chance after that */
+		tis.again = true;
+		return;
+	}
+
+	if (tis.queued)
+		return;
+
+	tis.queued = true;
+	queue.push_back(&tis);
+
+	if (n_idle > 0)
+		wake_cond.signal();
+	else if (n_threads < MAX_THREADS) {
+		threads.emplace_front(BIND_THIS_METHOD(Run));
+		threads.front().Start();
+		++n_threads;
+	}
+}
+
+void
+InputWorkerPool::Remove(ThreadInputStream &tis) noexcept
+{
+	const std::lock_guard<Mutex> lock(mutex);
+
+	if (tis.queued) {
+		queue.remove(&tis);
+		tis.queued = false;
+	}
+
+	tis.again = false;
+
+	while (tis.busy)
+		drain_cond.wait(mutex);
+}
+
+void
+InputWorkerPool::Finish() noexcept
+{
+	{
+		const std::lock_guard<Mutex> lock(mutex);
+		assert(queue.empty());
+
+		shutdown = true;
+		wake_cond.broadcast();
+	}
+
+	for (auto &i : threads)
+		i.Join();
+
+	threads.clear();
+	n_threads = 0;
+	shutdown = false;
+}
+
+inline void
+InputWorkerPool::Run() noexcept
+{
+	SetThreadName("input");
+
+	const std::lock_guard<Mutex> lock(mutex);
+
+	while (true) {
+		if (queue.empty()) {
+			if (shutdown)
+				break;
+
+			++n_idle;
+			wake_cond.wait(mutex);
+			--n_idle;
+			continue;
+		}
+
+		auto *tis = queue.front();
+		queue.pop_front();
+		tis->queued = false;
+		tis->busy = true;
+
+		{
+			const ScopeUnlock unlock(mutex);
+			tis->Step();
+		}
+
+		tis->busy = false;
+
+		if (tis->again) {
+			tis->again = false;
+			tis->queued = true;
+			queue.push_back(tis);
+		}
+
+		drain_cond.broadcast();
+	}
+}
+
+void
+thread_input_stream_finish() noexcept
+{
+	input_worker_pool.Finish();
+}
+
+ThreadInputStream::ThreadInputStream(gcc_unused const char *_plugin,
 				     const char *_uri,
 				     Mutex &_mutex,
 				     size_t _buffer_size) noexcept
 	:InputStream(_uri, _mutex),
-	 plugin(_plugin),
-	 thread(BIND_THIS_METHOD(ThreadFunc)),
 	 allocation(_buffer_size),
 	 buffer(&allocation.front(), allocation.size())
 {
@@ -40,83 +220,106 @@ ThreadInputStream::ThreadInputStream(const char *_plugin,
 void
 ThreadInputStream::Stop() noexcept
 {
-	if (!thread.IsDefined())
+	if (!started)
 		return;
 
 	{
 		const std::lock_guard<Mutex> lock(mutex);
 		close = true;
-		wake_cond.signal();
 	}
 
 	Cancel();
 
-	thread.Join();
+	input_worker_pool.Remove(*this);
+
+	/* no worker is touching this stream anymore */
+
+	{
+		const std::lock_guard<Mutex> lock(mutex);
+
+		if (opened && !closed) {
+			closed = true;
+			Close();
+		}
+	}
 
+	started = false;
 	buffer.Clear();
 }
 
 void
 ThreadInputStream::Start()
 {
-	thread.Start();
+	assert(!started);
+
+	started = true;
+	input_worker_pool.Schedule(*this);
 }
 
 inline void
-ThreadInputStream::ThreadFunc() noexcept
+ThreadInputStream::Step() noexcept
 {
-	FormatThreadName("input:%s", plugin);
-
 	const std::lock_guard<Mutex> lock(mutex);
 
-	try {
-		Open();
-	} catch (...) {
-		postponed_exception = std::current_exception();
-		SetReady();
+	if (close || closed || eof || postponed_exception)
 		return;
-	}
 
-	/* we're ready, tell it to our client */
-	SetReady();
+	if (!opened) {
+		try {
+			Open();
+		} catch (...) {
+			postponed_exception = std::current_exception();
+			SetReady();
+			return;
+		}
+
+		opened = true;
+
+		/* we're ready, tell it to our client */
+		SetReady();
+	}
 
 	while (!close) {
 		assert(!postponed_exception);
 
 		auto w = buffer.Write();
-		if (w.empty()) {
-			wake_cond.wait(mutex);
-		} else {
-			size_t nbytes;
-
-			try {
-				const ScopeUnlock unlock(mutex);
-				nbytes = ThreadRead(w.data, w.size);
-			} catch (...) {
-				postponed_exception = std::current_exception();
-				InvokeOnAvailable();
-				break;
-			}
-
+		if (w.empty())
+			/* buffer full; we will be rescheduled as
+			   soon as the client has consumed something */
+			return;
+
+		size_t nbytes;
+
+		try {
+			const ScopeUnlock unlock(mutex);
+			nbytes = ThreadRead(w.data, w.size);
+		} catch (...) {
+			postponed_exception = std::current_exception();
 			InvokeOnAvailable();
+			break;
+		}
 
-			if (nbytes == 0) {
-				eof = true;
-				break;
-			}
+		InvokeOnAvailable();
 
-			buffer.Append(nbytes);
+		if (nbytes == 0) {
+			eof = true;
+			break;
 		}
+
+		buffer.Append(nbytes);
 	}
 
-	Close();
+	/* terminal state reached: release the backend library right
+	   away instead of waiting for Stop() */
+	if (opened && !closed) {
+		closed = true;
+		Close();
+	}
 }
 
 void
 ThreadInputStream::Check()
 {
-	assert(!thread.IsInside());
-
 	if (postponed_exception)
 		std::rethrow_exception(postponed_exception);
 }
@@ -124,16 +327,12 @@ ThreadInputStream::Check()
 bool
 ThreadInputStream::IsAvailable() noexcept
 {
-	assert(!thread.IsInside());
-
 	return !buffer.empty() || eof || postponed_exception;
 }
 
 inline size_t
 ThreadInputStream::Read(void *ptr, size_t read_size)
 {
-	assert(!thread.IsInside());
-
 	CondInputStreamHandler cond_handler;
 
 	while (true) {
@@ -145,7 +344,12 @@ ThreadInputStream::Read(void *ptr, size_t read_size)
 			size_t nbytes = std::min(read_size, r.size);
 			memcpy(ptr, r.data, nbytes);
 			buffer.Consume(nbytes);
-			wake_cond.broadcast();
+
+			if (!eof)
+				/* there is buffer space to fill
+				   again */
+				input_worker_pool.Schedule(*this);
+
 			offset += nbytes;
 			return nbytes;
 		}
@@ -161,7 +365,5 @@ ThreadInputStream::Read(void *ptr, size_t read_size)
 bool
 ThreadInputStream::IsEOF() noexcept
 {
-	assert(!thread.IsInside());
-
 	return eof;
 }
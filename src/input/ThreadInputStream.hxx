@@ -21,8 +21,6 @@
 #define MPD_THREAD_INPUT_STREAM_HXX
 
 #include "InputStream.hxx"
-#include "thread/Thread.hxx"
-#include "thread/Cond.hxx"
 #include "util/HugeAllocator.hxx"
 #include "util/CircularBuffer.hxx"
 
@@ -32,30 +30,28 @@
 #include <stdint.h>
 
 /**
- * Helper class for moving InputStream implementations with blocking
- * backend library implementation to a dedicated thread.  Data is
- * being read into a ring buffer, and that buffer is then consumed by
- * another thread using the regular #InputStream API.  This class
- * manages the thread and the buffer.
+ * Helper class for InputStream implementations with a blocking
+ * backend library.  Data is being read into a ring buffer, and that
+ * buffer is then consumed by another thread using the regular
+ * #InputStream API.
+ *
+ * Despite the name, an instance does not own a dedicated thread: all
+ * instances are served by a small shared pool of worker threads
+ * (#InputWorkerPool), so the number of open streams does not dictate
+ * the number of threads.  Each stream is a state machine
+ * (open/fill/eof/closed) which gets scheduled on the pool whenever
+ * there is buffer space to fill.
  *
  * This works only for "streams": unknown length, no seeking, no tags.
  *
  * The implementation must call Stop() before its destruction
  * completes.  This cannot be done in ~ThreadInputStream() because at
  * this point, the class has been morphed back to #ThreadInputStream
- * and the still-running thread will crash due to pure method call.
+ * and a worker still inside the plugin methods would crash due to
+ * pure method call.
  */
 class ThreadInputStream : public InputStream {
-	const char *const plugin;
-
-	Thread thread;
-
-	/**
-	 * Signalled when the thread shall be woken up: when data from
-	 * the buffer has been consumed and when the stream shall be
-	 * closed.
-	 */
-	Cond wake_cond;
+	friend class InputWorkerPool;
 
 	std::exception_ptr postponed_exception;
 
@@ -63,16 +59,51 @@ class ThreadInputStream : public InputStream {
 
 	CircularBuffer<uint8_t> buffer;
 
+	/**
+	 * Has Start() been called (and Stop() not yet)?
+	 */
+	bool started = false;
+
+	/**
+	 * Has Open() completed successfully?
+	 */
+	bool opened = false;
+
+	/**
+	 * Has Close() been called?
+	 */
+	bool closed = false;
+
 	/**
 	 * Shall the stream be closed?
 	 */
 	bool close = false;
 
 	/**
-	 * Has the end of the stream been seen by the thread?
+	 * Has the end of the stream been seen?
 	 */
 	bool eof = false;
 
+	/* the following attributes are protected by the
+	   #InputWorkerPool mutex, not by InputStream::mutex */
+
+	/**
+	 * Is this stream currently in the pool's run queue?
+	 */
+	bool queued = false;
+
+	/**
+	 * Is a worker currently inside this stream's Step()?
+	 */
+	bool busy = false;
+
+	/**
+	 * Shall the stream be scheduled once more as soon as the
+	 * current Step() has finished?  Set when the client consumes
+	 * data while a worker is busy with this stream.
+	 */
+	bool again = false;
+
 public:
 	ThreadInputStream(const char *_plugin,
 			  const char *_uri, Mutex &_mutex,
@@ -81,12 +112,12 @@ public:
 #ifndef NDEBUG
 	~ThreadInputStream() override {
 		/* Stop() must have been called already */
-		assert(!thread.IsDefined());
+		assert(!started);
 	}
 #endif
 
 	/**
-	 * Initialize the object and start the thread.
+	 * Initialize the object and schedule it on the worker pool.
 	 */
 	void Start();
 
@@ -98,23 +129,20 @@ public:
 
 protected:
 	/**
-	 * Stop the thread and free the buffer.  This must be called
-	 * before destruction of this object completes.
+	 * Deregister from the worker pool and free the buffer.  This
+	 * must be called before destruction of this object completes.
 	 */
 	void Stop() noexcept;
 
 	void SetMimeType(const char *_mime) noexcept {
-		assert(thread.IsInside());
-
 		InputStream::SetMimeType(_mime);
 	}
 
 	/* to be implemented by the plugin */
 
 	/**
-	 * Optional initialization after entering the thread.  After
-	 * this returns with success, the InputStream::ready flag is
-	 * set.
+	 * Optional initialization inside a worker thread.  After this
+	 * returns with success, the InputStream::ready flag is set.
 	 *
 	 * The #InputStream is locked.  Unlock/relock it if you do a
 	 * blocking operation.
@@ -125,7 +153,9 @@ protected:
 	}
 
 	/**
-	 * Read from the stream.
+	 * Read from the stream.  Called from a worker thread; it may
+	 * block, and for the duration of the call, it occupies one of
+	 * the pool's workers.
 	 *
 	 * The #InputStream is not locked.
 	 *
@@ -136,22 +166,36 @@ protected:
 	virtual size_t ThreadRead(void *ptr, size_t size) = 0;
 
 	/**
-	 * Optional deinitialization before leaving the thread.
+	 * Optional deinitialization.  Called from a worker thread as
+	 * soon as a terminal state (end-of-file, error, Stop()) is
+	 * reached, or from Stop() itself.
 	 *
-	 * The #InputStream is not locked.
+	 * The #InputStream is locked.
 	 */
 	virtual void Close() noexcept {}
 
 	/**
-	 * Called from the client thread to cancel a Read() inside the
-	 * thread.
+	 * Called from the client thread to cancel a ThreadRead()
+	 * inside a worker thread.
 	 *
 	 * The #InputStream is not locked.
 	 */
 	virtual void Cancel() noexcept {}
 
 private:
-	void ThreadFunc() noexcept;
+	/**
+	 * Run this stream's state machine: open the backend if
+	 * necessary, then fill the buffer until it is full or a
+	 * terminal state is reached.  Called by a pool worker.
+	 */
+	void Step() noexcept;
 };
 
+/**
+ * Join all #ThreadInputStream worker threads.  Called by
+ * input_stream_global_finish() after all streams have been closed.
+ */
+void
+thread_input_stream_finish() noexcept;
+
 #endif
@@ -71,6 +71,12 @@ class AlsaInputStream final
 
 	DeferEvent defer_invalidate_sockets;
 
+	/**
+	 * The number of capture overruns seen so far; logged on each
+	 * occurrence for diagnosing a too-slow consumer.
+	 */
+	unsigned overruns = 0;
+
 public:
 	AlsaInputStream(EventLoop &_loop,
 			const char *_uri, Mutex &_mutex,
@@ -188,29 +194,37 @@ AlsaInputStream::DispatchSockets() noexcept
 
 	const std::lock_guard<Mutex> protect(mutex);
 
-	auto w = PrepareWriteBuffer();
-	const snd_pcm_uframes_t w_frames = w.size / frame_size;
-	if (w_frames == 0) {
-		/* buffer is full */
-		Pause();
-		return;
-	}
-
-	snd_pcm_sframes_t n_frames;
-	while ((n_frames = snd_pcm_readi(capture_handle,
-					 w.data, w_frames)) < 0) {
-		if (n_frames == -EAGAIN)
+	/* drain everything the device has accumulated, so one wakeup
+	   can consume several periods */
+	while (true) {
+		auto w = PrepareWriteBuffer();
+		const snd_pcm_uframes_t w_frames = w.size / frame_size;
+		if (w_frames == 0) {
+			/* buffer is full */
+			Pause();
 			return;
+		}
 
-		if (Recover(n_frames) < 0) {
-			postponed_exception = std::make_exception_ptr(std::runtime_error("PCM error - stream aborted"));
-			InvokeOnAvailable();
-			return;
+		snd_pcm_sframes_t n_frames;
+		while ((n_frames = snd_pcm_readi(capture_handle,
+						 w.data, w_frames)) < 0) {
+			if (n_frames == -EAGAIN)
+				return;
+
+			if (Recover(n_frames) < 0) {
+				postponed_exception = std::make_exception_ptr(std::runtime_error("PCM error - stream aborted"));
+				InvokeOnAvailable();
+				return;
+			}
 		}
-	}
 
-	size_t nbytes = n_frames * frame_size;
-	CommitWriteBuffer(nbytes);
+		size_t nbytes = n_frames * frame_size;
+		CommitWriteBuffer(nbytes);
+
+		if ((snd_pcm_uframes_t)n_frames < w_frames)
+			/* the device has no more data */
+			break;
+	}
 }
 
 inline int
@@ -218,9 +232,10 @@ AlsaInputStream::Recover(int err)
 {
 	switch(err) {
 	case -EPIPE:
-		FormatDebug(alsa_input_domain,
-			    "Overrun on ALSA capture device \"%s\"",
-			    device.c_str());
+		++overruns;
+		FormatWarning(alsa_input_domain,
+			      "Overrun #%u on ALSA capture device \"%s\"",
+			      overruns, device.c_str());
 		break;
 
 	case -ESTRPIPE:
@@ -363,6 +378,14 @@ ConfigureCapture(snd_pcm_t *capture_handle,
 
 	snd_pcm_sw_params_current(capture_handle, sw_params);
 
+	/* wake us up only when at least one whole period is ready,
+	   instead of after every few frames; this batches the reads
+	   and keeps the wakeup rate low */
+	if ((err = snd_pcm_sw_params_set_avail_min(capture_handle, sw_params,
+						   alsa_period_size)) < 0)
+		throw FormatRuntimeError("unable to set avail min (%s)",
+					 snd_strerror(err));
+
 	if ((err = snd_pcm_sw_params(capture_handle, sw_params)) < 0)
 		throw FormatRuntimeError("unable to install sw params (%s)",
 					 snd_strerror(err));
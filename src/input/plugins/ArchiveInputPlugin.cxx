@@ -23,8 +23,10 @@
 #include "archive/ArchiveList.hxx"
 #include "archive/ArchivePlugin.hxx"
 #include "archive/ArchiveFile.hxx"
+#include "archive/ArchiveCache.hxx"
 #include "../InputPlugin.hxx"
 #include "../InputStream.hxx"
+#include "../ProxyInputStream.hxx"
 #include "fs/Path.hxx"
 #include "Log.hxx"
 #include "util/ScopeExit.hxx"
@@ -33,6 +35,28 @@
 
 #include <stdlib.h>
 
+/**
+ * An #InputStream within an archive.  It forwards everything to the
+ * plugin's stream implementation, and additionally owns a reference
+ * to the (shared) #ArchiveFile handle, which marks the handle "busy"
+ * in the archive cache for as long as this stream exists.
+ */
+class ArchiveInputStream final : public ProxyInputStream {
+	std::shared_ptr<ArchiveFile> archive;
+
+public:
+	ArchiveInputStream(std::shared_ptr<ArchiveFile> _archive,
+			   InputStreamPtr _input) noexcept
+		:ProxyInputStream(std::move(_input)),
+		 archive(std::move(_archive)) {
+		/* the plugin's stream is ready from the start; make
+		   this object ready, too, because our callers are
+		   not prepared to wait */
+		const std::lock_guard<Mutex> protect(mutex);
+		CopyAttributes();
+	}
+};
+
 InputStreamPtr
 OpenArchiveInputStream(Path path, Mutex &mutex)
 {
@@ -59,6 +83,8 @@ OpenArchiveInputStream(Path path, Mutex &mutex)
 		return nullptr;
 	}
 
-	return archive_file_open(arplug, Path::FromFS(archive))
-		->OpenStream(filename, mutex);
+	auto file = archive_cache_open(*arplug, Path::FromFS(archive));
+	auto is = file->OpenStream(filename, mutex);
+	return std::make_unique<ArchiveInputStream>(std::move(file),
+						    std::move(is));
 }
@@ -26,6 +26,7 @@
 #include "lib/cdio/Paranoia.hxx"
 #include "../InputStream.hxx"
 #include "../InputPlugin.hxx"
+#include "../BufferedInputStream.hxx"
 #include "util/TruncateString.hxx"
 #include "util/StringCompare.hxx"
 #include "util/RuntimeError.hxx"
@@ -248,10 +249,21 @@ input_cdio_open(const char *uri,
 		lsn_to = cdio_get_disc_last_lsn(cdio);
 	}
 
-	return std::make_unique<CdioParanoiaInputStream>(uri, mutex,
-							 drv, cdio,
-							 reverse_endian,
-							 lsn_from, lsn_to);
+	InputStreamPtr is =
+		std::make_unique<CdioParanoiaInputStream>(uri, mutex,
+							  drv, cdio,
+							  reverse_endian,
+							  lsn_from, lsn_to);
+
+	/* the paranoia library can block for a long time while it
+	   retries a damaged sector; read ahead in a background
+	   thread so playback can ride through such stalls (a whole
+	   disc may exceed the buffer limit and is played
+	   unbuffered) */
+	if (BufferedInputStream::IsEligible(*is))
+		is = std::make_unique<BufferedInputStream>(std::move(is));
+
+	return is;
 }
 
 void
@@ -58,15 +58,27 @@
 /**
  * Do not buffer more than this number of bytes.  It should be a
  * reasonable limit that doesn't make low-end machines suffer too
- * much, but doesn't cause stuttering on high-latency lines.
+ * much, but doesn't cause stuttering on high-latency lines.  This is
+ * only the default; it can be overridden with the "max_buffered"
+ * configuration setting, e.g. for high-bitrate streams which would
+ * otherwise oscillate between pause and resume.
  */
 static const size_t CURL_MAX_BUFFERED = 512 * 1024;
 
 /**
  * Resume the stream at this number of bytes after it has been paused.
+ * This is only the default; it can be overridden with the
+ * "resume_at" configuration setting.
  */
 static const size_t CURL_RESUME_AT = 384 * 1024;
 
+/**
+ * The configured buffer size and resume threshold; see
+ * #CURL_MAX_BUFFERED and #CURL_RESUME_AT.
+ */
+static size_t curl_max_buffered = CURL_MAX_BUFFERED;
+static size_t curl_resume_at = CURL_RESUME_AT;
+
 class CurlInputStream final : public AsyncInputStream, CurlResponseHandler {
 	/* some buffers which were passed to libcurl, which we have
 	   too free */
@@ -328,6 +340,13 @@ input_curl_init(EventLoop &event_loop, const ConfigBlock &block)
 
 	verify_peer = block.GetBlockValue("verify_peer", true);
 	verify_host = block.GetBlockValue("verify_host", true);
+
+	curl_max_buffered = block.GetPositiveValue("max_buffered",
+						   unsigned(CURL_MAX_BUFFERED));
+	curl_resume_at = block.GetPositiveValue("resume_at",
+						unsigned(CURL_RESUME_AT));
+	if (curl_resume_at >= curl_max_buffered)
+		throw std::runtime_error("resume_at must be smaller than max_buffered");
 }
 
 static void
@@ -346,8 +365,8 @@ CurlInputStream::CurlInputStream(EventLoop &event_loop, const char *_url,
 				 I &&_icy,
 				 Mutex &_mutex)
 	:AsyncInputStream(event_loop, _url, _mutex,
-			  CURL_MAX_BUFFERED,
-			  CURL_RESUME_AT),
+			  curl_max_buffered,
+			  curl_resume_at),
 	 icy(std::forward<I>(_icy))
 {
 	request_headers.Append("Icy-Metadata: 1");
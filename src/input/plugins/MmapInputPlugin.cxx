@@ -0,0 +1,122 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "MmapInputPlugin.hxx"
+#include "../InputStream.hxx"
+#include "fs/Path.hxx"
+#include "fs/FileInfo.hxx"
+#include "fs/io/FileReader.hxx"
+#include "system/FileDescriptor.hxx"
+
+#include <limits>
+
+#include <string.h>
+#include <sys/mman.h>
+
+static bool mmap_input_enabled = false;
+
+void
+InitMmapInputPlugin(bool enabled) noexcept
+{
+	mmap_input_enabled = enabled;
+}
+
+class MmapInputStream final : public InputStream {
+	uint8_t *const map;
+	const size_t map_size;
+
+public:
+	MmapInputStream(const char *path, void *_map, size_t _size,
+			Mutex &_mutex) noexcept
+		:InputStream(path, _mutex),
+		 map((uint8_t *)_map), map_size(_size) {
+		size = _size;
+		seekable = true;
+		SetReady();
+	}
+
+	~MmapInputStream() noexcept override {
+		munmap(map, map_size);
+	}
+
+	/* virtual methods from InputStream */
+
+	bool IsEOF() noexcept override {
+		return GetOffset() >= GetSize();
+	}
+
+	size_t Read(void *ptr, size_t read_size) override {
+		if (offset >= (offset_type)map_size)
+			/* Seek() allows positions beyond the end of
+			   the file (just like the "file" plugin);
+			   return 0 instead of reading past the end of
+			   the mapping */
+			return 0;
+
+		size_t remaining = map_size - (size_t)offset;
+		if (read_size > remaining)
+			read_size = remaining;
+
+		memcpy(ptr, map + offset, read_size);
+		offset += read_size;
+		return read_size;
+	}
+
+	void Seek(offset_type new_offset) override {
+		offset = new_offset;
+	}
+};
+
+InputStreamPtr
+OpenMmapInputStream(Path path, Mutex &mutex)
+{
+	if (!mmap_input_enabled)
+		return nullptr;
+
+	FileReader reader(path);
+
+	const FileInfo info = reader.GetFileInfo();
+
+	if (!info.IsRegular() || info.GetSize() <= 0 ||
+	    uint64_t(info.GetSize()) > std::numeric_limits<size_t>::max() / 2)
+		/* empty, oversized or special files are left to the
+		   regular "file" plugin */
+		return nullptr;
+
+	const size_t map_size = info.GetSize();
+
+	void *map = mmap(nullptr, map_size, PROT_READ, MAP_SHARED,
+			 reader.GetFD().Get(), 0);
+	if (map == MAP_FAILED)
+		/* e.g. a file system which does not support mmap;
+		   fall back to read() */
+		return nullptr;
+
+	/* start asynchronous readahead; unlike MAP_POPULATE, this
+	   does not block until all pages are resident */
+	madvise(map, map_size, MADV_SEQUENTIAL);
+	madvise(map, map_size, MADV_WILLNEED);
+
+	/* the mapping survives closing the file descriptor
+	   (~FileReader) */
+
+	return std::make_unique<MmapInputStream>(path.ToUTF8Throw().c_str(),
+						 map, map_size,
+						 mutex);
+}
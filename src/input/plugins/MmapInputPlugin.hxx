@@ -0,0 +1,52 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_INPUT_MMAP_HXX
+#define MPD_INPUT_MMAP_HXX
+
+#include "input/Ptr.hxx"
+
+class Path;
+class Mutex;
+
+/**
+ * Enable or disable the mmap input plugin (config option
+ * "input_mmap", disabled by default).  Until it is enabled,
+ * OpenMmapInputStream() always returns nullptr.
+ */
+void
+InitMmapInputPlugin(bool enabled) noexcept;
+
+/**
+ * Open a local file by mapping it into the address space instead of
+ * copying it through read() buffers.  The pages are shared with the
+ * kernel page cache (and with other streams playing the same file),
+ * and the kernel is advised to read them ahead asynchronously, so
+ * opening is instant.
+ *
+ * Returns nullptr if the plugin is disabled or the file cannot be
+ * mapped; the caller should then fall back to the regular "file"
+ * input plugin.
+ *
+ * Throws on error.
+ */
+InputStreamPtr
+OpenMmapInputStream(Path path, Mutex &mutex);
+
+#endif
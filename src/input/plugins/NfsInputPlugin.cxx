@@ -24,6 +24,8 @@
 #include "lib/nfs/FileReader.hxx"
 #include "util/ASCII.hxx"
 
+#include <algorithm>
+
 /**
  * Do not buffer more than this number of bytes.  It should be a
  * reasonable limit that doesn't make low-end machines suffer too
@@ -36,9 +38,28 @@ static const size_t NFS_MAX_BUFFERED = 512 * 1024;
  */
 static const size_t NFS_RESUME_AT = 384 * 1024;
 
+/**
+ * The initial read size.  The adaptive read window starts here and
+ * grows while the consumer keeps draining the buffer (i.e. the
+ * stream is not fast enough) and shrinks back when the buffer fills
+ * up.
+ */
+static const size_t NFS_MIN_READ = 32 * 1024;
+
+/**
+ * Do not read more than this number of bytes at a time.
+ */
+static const size_t NFS_MAX_READ = 256 * 1024;
+
 class NfsInputStream final : NfsFileReader, public AsyncInputStream {
 	uint64_t next_offset;
 
+	/**
+	 * The current adaptive read window
+	 * [#NFS_MIN_READ..#NFS_MAX_READ].
+	 */
+	size_t read_size = NFS_MIN_READ;
+
 	bool reconnect_on_resume = false, reconnecting = false;
 
 public:
@@ -84,11 +105,16 @@ NfsInputStream::DoRead()
 
 	const size_t buffer_space = GetBufferSpace();
 	if (buffer_space == 0) {
+		/* the consumer is slower than this stream; shrink
+		   the read window */
+		read_size = std::max(read_size / 2, NFS_MIN_READ);
+
 		Pause();
 		return;
 	}
 
-	size_t nbytes = std::min<size_t>(std::min<uint64_t>(remaining, 32768),
+	size_t nbytes = std::min<size_t>(std::min<uint64_t>(remaining,
+							    read_size),
 					 buffer_space);
 
 	try {
@@ -166,6 +192,13 @@ NfsInputStream::OnNfsFileRead(const void *data, size_t data_size) noexcept
 
 	next_offset += data_size;
 
+	if (GetBufferSpace() > NFS_MAX_BUFFERED / 2)
+		/* the buffer is running low even though we have just
+		   added data - the consumer is faster than this
+		   stream; grow the read window to reduce round
+		   trips */
+		read_size = std::min(read_size * 2, NFS_MAX_READ);
+
 	DoRead();
 }
 
@@ -21,6 +21,7 @@
 #include "QobuzClient.hxx"
 #include "QobuzTrackRequest.hxx"
 #include "QobuzTagScanner.hxx"
+#include "TrackUrlCache.hxx"
 #include "CurlInputPlugin.hxx"
 #include "PluginUnavailable.hxx"
 #include "input/ProxyInputStream.hxx"
@@ -38,6 +39,17 @@
 
 static QobuzClient *qobuz_client;
 
+/**
+ * Remember resolved file URLs so opening several tracks of the same
+ * album (e.g. a freshly loaded queue) does not fire one HTTPS round
+ * trip per song.  Qobuz file URLs are signed with a limited lifetime;
+ * stay well below it.
+ */
+static TrackUrlCache qobuz_url_cache;
+
+static constexpr std::chrono::steady_clock::duration QOBUZ_URL_TTL =
+	std::chrono::minutes(10);
+
 class QobuzInputStream final
 	: public ProxyInputStream, QobuzSessionHandler, QobuzTrackHandler {
 
@@ -53,6 +65,20 @@ public:
 		:ProxyInputStream(_uri, _mutex),
 		 track_id(_track_id)
 	{
+		auto cached = qobuz_url_cache.Get(track_id.c_str());
+		if (!cached.empty()) {
+			/* we already know the file URL: skip the
+			   track request round trip */
+			const std::lock_guard<Mutex> protect(mutex);
+
+			try {
+				SetInput(OpenCurlInputStream(cached.c_str(),
+							     {}, mutex));
+				return;
+			} catch (...) {
+			}
+		}
+
 		qobuz_client->AddLoginHandler(*this);
 	}
 
@@ -103,6 +129,8 @@ QobuzInputStream::OnQobuzSession() noexcept
 void
 QobuzInputStream::OnQobuzTrackSuccess(std::string url) noexcept
 {
+	qobuz_url_cache.Put(track_id.c_str(), url, QOBUZ_URL_TTL);
+
 	const std::lock_guard<Mutex> protect(mutex);
 	track_request.reset();
 
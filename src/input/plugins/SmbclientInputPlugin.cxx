@@ -19,7 +19,7 @@
 
 #include "SmbclientInputPlugin.hxx"
 #include "lib/smbclient/Init.hxx"
-#include "lib/smbclient/Mutex.hxx"
+#include "lib/smbclient/Context.hxx"
 #include "../InputStream.hxx"
 #include "../InputPlugin.hxx"
 #include "PluginUnavailable.hxx"
@@ -31,25 +31,23 @@
 #include <stdexcept>
 
 class SmbclientInputStream final : public InputStream {
-	SMBCCTX *ctx;
-	int fd;
+	std::unique_ptr<SmbclientContext> ctx;
+	SMBCFILE *const file;
 
 public:
 	SmbclientInputStream(const char *_uri,
 			     Mutex &_mutex,
-			     SMBCCTX *_ctx, int _fd, const struct stat &st)
+			     std::unique_ptr<SmbclientContext> _ctx,
+			     SMBCFILE *_file, const struct stat &st)
 		:InputStream(_uri, _mutex),
-		 ctx(_ctx), fd(_fd) {
+		 ctx(std::move(_ctx)), file(_file) {
 		seekable = true;
 		size = st.st_size;
 		SetReady();
 	}
 
 	~SmbclientInputStream() {
-		smbclient_mutex.lock();
-		smbc_close(fd);
-		smbc_free_context(ctx, 1);
-		smbclient_mutex.unlock();
+		ctx->Close(file);
 	}
 
 	/* virtual methods from InputStream */
@@ -86,37 +84,22 @@ static InputStreamPtr
 input_smbclient_open(const char *uri,
 		     Mutex &mutex)
 {
-	const std::lock_guard<Mutex> protect(smbclient_mutex);
+	auto ctx = SmbclientContext::New();
 
-	SMBCCTX *ctx = smbc_new_context();
-	if (ctx == nullptr)
-		throw MakeErrno("smbc_new_context() failed");
-
-	SMBCCTX *ctx2 = smbc_init_context(ctx);
-	if (ctx2 == nullptr) {
-		int e = errno;
-		smbc_free_context(ctx, 1);
-		throw MakeErrno(e, "smbc_init_context() failed");
-	}
-
-	ctx = ctx2;
-
-	int fd = smbc_open(uri, O_RDONLY, 0);
-	if (fd < 0) {
-		int e = errno;
-		smbc_free_context(ctx, 1);
-		throw MakeErrno(e, "smbc_open() failed");
-	}
+	SMBCFILE *file = ctx->OpenReadOnly(uri);
+	if (file == nullptr)
+		throw MakeErrno("smbc_open() failed");
 
 	struct stat st;
-	if (smbc_fstat(fd, &st) < 0) {
+	if (ctx->Stat(file, st) < 0) {
 		int e = errno;
-		smbc_free_context(ctx, 1);
+		ctx->Close(file);
 		throw MakeErrno(e, "smbc_fstat() failed");
 	}
 
 	return std::make_unique<SmbclientInputStream>(uri, mutex,
-						      ctx, fd, st);
+						      std::move(ctx),
+						      file, st);
 }
 
 size_t
@@ -126,8 +109,7 @@ SmbclientInputStream::Read(void *ptr, size_t read_size)
 
 	{
 		const ScopeUnlock unlock(mutex);
-		const std::lock_guard<Mutex> lock(smbclient_mutex);
-		nbytes = smbc_read(fd, ptr, read_size);
+		nbytes = ctx->Read(file, ptr, read_size);
 	}
 
 	if (nbytes < 0)
@@ -144,8 +126,7 @@ SmbclientInputStream::Seek(offset_type new_offset)
 
 	{
 		const ScopeUnlock unlock(mutex);
-		const std::lock_guard<Mutex> lock(smbclient_mutex);
-		result = smbc_lseek(fd, new_offset, SEEK_SET);
+		result = ctx->Seek(file, new_offset);
 	}
 
 	if (result < 0)
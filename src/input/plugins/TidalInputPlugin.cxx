@@ -22,6 +22,7 @@
 #include "TidalTrackRequest.hxx"
 #include "TidalTagScanner.hxx"
 #include "TidalError.hxx"
+#include "TrackUrlCache.hxx"
 #include "CurlInputPlugin.hxx"
 #include "PluginUnavailable.hxx"
 #include "input/ProxyInputStream.hxx"
@@ -42,6 +43,17 @@ static constexpr Domain tidal_domain("tidal");
 static TidalSessionManager *tidal_session;
 static const char *tidal_audioquality;
 
+/**
+ * Remember resolved stream URLs so opening several tracks of the same
+ * album (e.g. a freshly loaded queue) does not fire one HTTPS round
+ * trip per song.  Tidal stream URLs expire; stay well below their
+ * lifetime.
+ */
+static TrackUrlCache tidal_url_cache;
+
+static constexpr std::chrono::steady_clock::duration TIDAL_URL_TTL =
+	std::chrono::minutes(10);
+
 class TidalInputStream final
 	: public ProxyInputStream, TidalSessionHandler, TidalTrackHandler {
 
@@ -63,6 +75,20 @@ public:
 		:ProxyInputStream(_uri, _mutex),
 		 track_id(_track_id)
 	{
+		auto cached = tidal_url_cache.Get(track_id.c_str());
+		if (!cached.empty()) {
+			/* we already know the stream URL: skip the
+			   track request round trip */
+			const std::lock_guard<Mutex> protect(mutex);
+
+			try {
+				SetInput(OpenCurlInputStream(cached.c_str(),
+							     {}, mutex));
+				return;
+			} catch (...) {
+			}
+		}
+
 		tidal_session->AddLoginHandler(*this);
 	}
 
@@ -117,6 +143,8 @@ TidalInputStream::OnTidalTrackSuccess(std::string url) noexcept
 	FormatDebug(tidal_domain, "Tidal track '%s' resolves to %s",
 		    track_id.c_str(), url.c_str());
 
+	tidal_url_cache.Put(track_id.c_str(), url, TIDAL_URL_TTL);
+
 	const std::lock_guard<Mutex> protect(mutex);
 
 	track_request.reset();
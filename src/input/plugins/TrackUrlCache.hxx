@@ -0,0 +1,107 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_TRACK_URL_CACHE_HXX
+#define MPD_TRACK_URL_CACHE_HXX
+
+#include "thread/Mutex.hxx"
+
+#include <chrono>
+#include <map>
+#include <string>
+
+/**
+ * A small cache mapping track ids of a streaming service to resolved
+ * stream URLs.  Since those URLs are usually signed and expire after
+ * a while, each entry carries a deadline after which it is ignored.
+ *
+ * This avoids one HTTPS round trip per open while a queued album is
+ * being played.
+ */
+class TrackUrlCache {
+	static constexpr size_t MAX_SIZE = 64;
+
+	struct Entry {
+		std::string url;
+		std::chrono::steady_clock::time_point expires;
+	};
+
+	mutable Mutex mutex;
+
+	std::map<std::string, Entry> entries;
+
+public:
+	/**
+	 * Look up a track id.  Returns the cached URL or an empty
+	 * string if there is no (valid) cache entry.
+	 */
+	std::string Get(const char *track_id) noexcept {
+		const std::lock_guard<Mutex> protect(mutex);
+
+		auto i = entries.find(track_id);
+		if (i == entries.end())
+			return {};
+
+		if (std::chrono::steady_clock::now() >= i->second.expires) {
+			entries.erase(i);
+			return {};
+		}
+
+		return i->second.url;
+	}
+
+	void Put(const char *track_id, std::string url,
+		 std::chrono::steady_clock::duration ttl) noexcept {
+		const auto now = std::chrono::steady_clock::now();
+
+		const std::lock_guard<Mutex> protect(mutex);
+
+		if (entries.size() >= MAX_SIZE)
+			Evict(now);
+
+		entries[track_id] = {std::move(url), now + ttl};
+	}
+
+private:
+	/**
+	 * Caller must lock the mutex.
+	 */
+	void Evict(std::chrono::steady_clock::time_point now) noexcept {
+		/* drop all expired entries ... */
+		for (auto i = entries.begin(); i != entries.end();) {
+			if (now >= i->second.expires)
+				i = entries.erase(i);
+			else
+				++i;
+		}
+
+		/* ... and if that freed nothing, the entry which
+		   expires soonest */
+		if (entries.size() < MAX_SIZE)
+			return;
+
+		auto victim = entries.begin();
+		for (auto i = std::next(victim); i != entries.end(); ++i)
+			if (i->second.expires < victim->second.expires)
+				victim = i;
+		entries.erase(victim);
+	}
+};
+
+#endif
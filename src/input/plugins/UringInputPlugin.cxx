@@ -0,0 +1,663 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "UringInputPlugin.hxx"
+#include "../AsyncInputStream.hxx"
+#include "event/SocketMonitor.hxx"
+#include "event/DeferEvent.hxx"
+#include "event/Call.hxx"
+#include "event/Loop.hxx"
+#include "fs/Path.hxx"
+#include "fs/FileInfo.hxx"
+#include "fs/io/FileReader.hxx"
+#include "system/Error.hxx"
+#include "util/RuntimeError.hxx"
+
+#include <array>
+#include <algorithm>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * Do not buffer more than this number of bytes.
+ */
+static constexpr size_t URING_MAX_BUFFERED = 512 * 1024;
+
+/**
+ * Resume the stream at this number of bytes after it has been paused.
+ */
+static constexpr size_t URING_RESUME_AT = 384 * 1024;
+
+/**
+ * The size of one read request.
+ */
+static constexpr size_t URING_SLOT_SIZE = 32768;
+
+/**
+ * The number of read requests kept in flight.  Multiple outstanding
+ * reads allow the kernel to keep rotational disks busy while the
+ * first completion is already being consumed.
+ */
+static constexpr unsigned URING_SLOTS = 4;
+
+static EventLoop *uring_input_event_loop;
+
+/**
+ * A minimal io_uring wrapper using raw system calls, just big enough
+ * for submitting read requests and polling for their completions via
+ * the ring file descriptor.
+ */
+class UringQueue {
+	int ring_fd = -1;
+
+	struct io_uring_params params;
+
+	void *sq_ring_ptr = nullptr, *cq_ring_ptr = nullptr;
+	size_t sq_ring_size, cq_ring_size;
+
+	struct io_uring_sqe *sqes = nullptr;
+	size_t sqes_size;
+
+	unsigned *sq_head, *sq_tail, *sq_array;
+	unsigned sq_mask;
+
+	unsigned *cq_head, *cq_tail;
+	unsigned cq_mask;
+
+	struct io_uring_cqe *cqes;
+
+	/**
+	 * The number of submission queue entries which have been
+	 * prepared with PushRead() but not yet passed to the kernel
+	 * with Submit().
+	 */
+	unsigned to_submit = 0;
+
+public:
+	explicit UringQueue(unsigned entries);
+
+	~UringQueue() noexcept {
+		Destroy();
+	}
+
+	UringQueue(const UringQueue &) = delete;
+	UringQueue &operator=(const UringQueue &) = delete;
+
+	int GetFileDescriptor() const noexcept {
+		return ring_fd;
+	}
+
+	/**
+	 * Prepare one read request.  The caller must ensure that no
+	 * more than the configured number of entries is in flight,
+	 * and must eventually call Submit().
+	 */
+	void PushRead(int fd, const struct iovec *iov,
+		      uint64_t file_offset, uint64_t user_data) noexcept;
+
+	/**
+	 * Pass all prepared requests to the kernel.
+	 *
+	 * Throws on error.
+	 */
+	void Submit();
+
+	/**
+	 * Peek at the oldest unseen completion; returns nullptr if
+	 * there is none.  Call PopCompletion() to consume it.
+	 */
+	const struct io_uring_cqe *PeekCompletion() noexcept;
+	void PopCompletion() noexcept;
+
+	/**
+	 * Block until at least one completion is available.
+	 *
+	 * @return false on error
+	 */
+	bool WaitCompletion() noexcept;
+
+private:
+	void Destroy() noexcept;
+};
+
+UringQueue::UringQueue(unsigned entries)
+{
+	memset(&params, 0, sizeof(params));
+
+	ring_fd = syscall(__NR_io_uring_setup, entries, &params);
+	if (ring_fd < 0)
+		throw MakeErrno("io_uring_setup() failed");
+
+	sq_ring_size = params.sq_off.array +
+		params.sq_entries * sizeof(unsigned);
+	cq_ring_size = params.cq_off.cqes +
+		params.cq_entries * sizeof(struct io_uring_cqe);
+
+#ifdef IORING_FEAT_SINGLE_MMAP
+	if (params.features & IORING_FEAT_SINGLE_MMAP)
+		sq_ring_size = cq_ring_size =
+			std::max(sq_ring_size, cq_ring_size);
+#endif
+
+	try {
+		sq_ring_ptr = mmap(nullptr, sq_ring_size,
+				   PROT_READ|PROT_WRITE,
+				   MAP_SHARED|MAP_POPULATE,
+				   ring_fd, IORING_OFF_SQ_RING);
+		if (sq_ring_ptr == MAP_FAILED) {
+			sq_ring_ptr = nullptr;
+			throw MakeErrno("Failed to map io_uring submission queue");
+		}
+
+#ifdef IORING_FEAT_SINGLE_MMAP
+		if (params.features & IORING_FEAT_SINGLE_MMAP)
+			cq_ring_ptr = sq_ring_ptr;
+		else
+#endif
+		{
+			cq_ring_ptr = mmap(nullptr, cq_ring_size,
+					   PROT_READ|PROT_WRITE,
+					   MAP_SHARED|MAP_POPULATE,
+					   ring_fd, IORING_OFF_CQ_RING);
+			if (cq_ring_ptr == MAP_FAILED) {
+				cq_ring_ptr = nullptr;
+				throw MakeErrno("Failed to map io_uring completion queue");
+			}
+		}
+
+		sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+		sqes = (struct io_uring_sqe *)
+			mmap(nullptr, sqes_size,
+			     PROT_READ|PROT_WRITE,
+			     MAP_SHARED|MAP_POPULATE,
+			     ring_fd, IORING_OFF_SQES);
+		if (sqes == MAP_FAILED) {
+			sqes = nullptr;
+			throw MakeErrno("Failed to map io_uring submission entries");
+		}
+	} catch (...) {
+		Destroy();
+		throw;
+	}
+
+	auto *sq = (uint8_t *)sq_ring_ptr;
+	sq_head = (unsigned *)(sq + params.sq_off.head);
+	sq_tail = (unsigned *)(sq + params.sq_off.tail);
+	sq_mask = *(const unsigned *)(sq + params.sq_off.ring_mask);
+	sq_array = (unsigned *)(sq + params.sq_off.array);
+
+	auto *cq = (uint8_t *)cq_ring_ptr;
+	cq_head = (unsigned *)(cq + params.cq_off.head);
+	cq_tail = (unsigned *)(cq + params.cq_off.tail);
+	cq_mask = *(const unsigned *)(cq + params.cq_off.ring_mask);
+	cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+}
+
+void
+UringQueue::Destroy() noexcept
+{
+	if (sqes != nullptr)
+		munmap(sqes, sqes_size);
+
+	if (cq_ring_ptr != nullptr && cq_ring_ptr != sq_ring_ptr)
+		munmap(cq_ring_ptr, cq_ring_size);
+
+	if (sq_ring_ptr != nullptr)
+		munmap(sq_ring_ptr, sq_ring_size);
+
+	sqes = nullptr;
+	sq_ring_ptr = cq_ring_ptr = nullptr;
+
+	if (ring_fd >= 0) {
+		/* note that closing the ring does not synchronize
+		   with in-flight requests (ring teardown is
+		   asynchronous since kernel 5.9); the caller must
+		   wait for all of them before destructing this
+		   object, or the kernel may still write to the read
+		   buffers afterwards */
+		close(ring_fd);
+		ring_fd = -1;
+	}
+}
+
+void
+UringQueue::PushRead(int fd, const struct iovec *iov,
+		     uint64_t file_offset, uint64_t user_data) noexcept
+{
+	const unsigned tail = *sq_tail;
+	const unsigned idx = tail & sq_mask;
+
+	auto &sqe = sqes[idx];
+	memset(&sqe, 0, sizeof(sqe));
+	sqe.opcode = IORING_OP_READV;
+	sqe.fd = fd;
+	sqe.addr = (uintptr_t)iov;
+	sqe.len = 1;
+	sqe.off = file_offset;
+	sqe.user_data = user_data;
+
+	sq_array[idx] = idx;
+	__atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+	++to_submit;
+}
+
+void
+UringQueue::Submit()
+{
+	if (to_submit == 0)
+		return;
+
+	int ret = syscall(__NR_io_uring_enter, ring_fd, to_submit,
+			  0, 0, nullptr, 0);
+	if (ret < 0)
+		throw MakeErrno("io_uring_enter() failed");
+
+	to_submit = 0;
+}
+
+const struct io_uring_cqe *
+UringQueue::PeekCompletion() noexcept
+{
+	const unsigned head = *cq_head;
+	if (head == __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE))
+		return nullptr;
+
+	return &cqes[head & cq_mask];
+}
+
+void
+UringQueue::PopCompletion() noexcept
+{
+	__atomic_store_n(cq_head, *cq_head + 1, __ATOMIC_RELEASE);
+}
+
+bool
+UringQueue::WaitCompletion() noexcept
+{
+	while (true) {
+		int ret = syscall(__NR_io_uring_enter, ring_fd, 0, 1,
+				  IORING_ENTER_GETEVENTS, nullptr, 0);
+		if (ret >= 0)
+			return true;
+
+		if (errno != EINTR)
+			return false;
+	}
+}
+
+class UringInputStream final : SocketMonitor, public AsyncInputStream {
+	FileReader reader;
+
+	struct ReadSlot {
+		enum class State : uint8_t {
+			FREE, PENDING, DONE,
+		} state = State::FREE;
+
+		/**
+		 * Copy of #generation at submission time; stale
+		 * completions (from before a seek) are discarded.
+		 */
+		unsigned generation;
+
+		offset_type file_offset;
+		size_t requested, result;
+
+		struct iovec iov;
+		uint8_t buffer[URING_SLOT_SIZE];
+	};
+
+	std::array<ReadSlot, URING_SLOTS> slots;
+
+	/**
+	 * Incremented by each seek to invalidate read requests which
+	 * are still in flight.
+	 */
+	unsigned generation = 0;
+
+	/**
+	 * The file offset of the next read to be submitted.
+	 */
+	offset_type next_submit_offset = 0;
+
+	/**
+	 * The file offset at the end of the data which has been
+	 * appended to the buffer.  Completions are appended strictly
+	 * in this order, even if the kernel finishes them out of
+	 * order.
+	 */
+	offset_type next_append_offset = 0;
+
+	/**
+	 * The total number of bytes requested by reads of the current
+	 * generation which have not been appended to the buffer yet.
+	 * Used to reserve buffer space for in-flight requests.
+	 */
+	size_t in_flight_bytes = 0;
+
+	DeferEvent deferred_start;
+
+	UringQueue queue;
+
+public:
+	UringInputStream(EventLoop &event_loop, const char *uri,
+			 FileReader &&_reader, offset_type _size,
+			 Mutex &_mutex)
+		:SocketMonitor(event_loop),
+		 AsyncInputStream(event_loop, uri, _mutex,
+				  URING_MAX_BUFFERED, URING_RESUME_AT),
+		 reader(std::move(_reader)),
+		 deferred_start(event_loop, BIND_THIS_METHOD(DeferredStart)),
+		 queue(URING_SLOTS)
+	{
+		size = _size;
+		seekable = true;
+		SetReady();
+
+		deferred_start.Schedule();
+	}
+
+	~UringInputStream() noexcept override {
+		BlockingCall(SocketMonitor::GetEventLoop(), [this](){
+				deferred_start.Cancel();
+				SocketMonitor::Cancel();
+				SocketMonitor::Steal();
+
+				DrainPendingSlots();
+			});
+	}
+
+private:
+	ReadSlot *FindFreeSlot() noexcept {
+		for (auto &slot : slots)
+			if (slot.state == ReadSlot::State::FREE)
+				return &slot;
+
+		return nullptr;
+	}
+
+	void SubmitReads();
+	void OnReadCompleted(uint64_t user_data, int res);
+	void DrainDoneSlots() noexcept;
+	void DrainPendingSlots() noexcept;
+	void BumpGeneration() noexcept;
+
+	void DeferredStart() noexcept;
+
+protected:
+	/* virtual methods from AsyncInputStream */
+	void DoResume() override;
+	void DoSeek(offset_type new_offset) override;
+
+	/* virtual methods from SocketMonitor */
+	bool OnSocketReady(unsigned flags) noexcept override;
+};
+
+void
+UringInputStream::SubmitReads()
+{
+	assert(SocketMonitor::GetEventLoop().IsInside());
+
+	while (next_submit_offset < (offset_type)size) {
+		auto *slot = FindFreeSlot();
+		if (slot == nullptr)
+			break;
+
+		const size_t nbytes =
+			std::min<offset_type>(size - next_submit_offset,
+					      URING_SLOT_SIZE);
+
+		if (GetBufferSpace() < in_flight_bytes + nbytes) {
+			Pause();
+			break;
+		}
+
+		slot->state = ReadSlot::State::PENDING;
+		slot->generation = generation;
+		slot->file_offset = next_submit_offset;
+		slot->requested = nbytes;
+		slot->iov.iov_base = slot->buffer;
+		slot->iov.iov_len = nbytes;
+
+		queue.PushRead(reader.GetFD().Get(), &slot->iov,
+			       next_submit_offset,
+			       slot - slots.data());
+
+		in_flight_bytes += nbytes;
+		next_submit_offset += nbytes;
+	}
+
+	queue.Submit();
+}
+
+void
+UringInputStream::BumpGeneration() noexcept
+{
+	++generation;
+	in_flight_bytes = 0;
+
+	/* discard stale results; stale PENDING slots remain occupied
+	   because the kernel still owns their buffers, and will be
+	   freed when their completions arrive */
+	for (auto &slot : slots)
+		if (slot.state == ReadSlot::State::DONE)
+			slot.state = ReadSlot::State::FREE;
+}
+
+void
+UringInputStream::OnReadCompleted(uint64_t user_data, int res)
+{
+	assert(user_data < slots.size());
+	auto &slot = slots[user_data];
+	assert(slot.state == ReadSlot::State::PENDING);
+
+	if (slot.generation != generation) {
+		/* a leftover from before a seek */
+		slot.state = ReadSlot::State::FREE;
+		return;
+	}
+
+	if (res < 0) {
+		slot.state = ReadSlot::State::FREE;
+		in_flight_bytes -= slot.requested;
+		throw MakeErrno(-res, "Failed to read from file");
+	}
+
+	slot.state = ReadSlot::State::DONE;
+	slot.result = res;
+}
+
+void
+UringInputStream::DrainDoneSlots() noexcept
+{
+	bool again = true;
+	while (again) {
+		again = false;
+
+		for (auto &slot : slots) {
+			if (slot.state != ReadSlot::State::DONE ||
+			    slot.generation != generation ||
+			    slot.file_offset != next_append_offset)
+				continue;
+
+			if (slot.result > 0)
+				AppendToBuffer(slot.buffer, slot.result);
+
+			in_flight_bytes -= slot.requested;
+			next_append_offset += slot.result;
+
+			if (slot.result < slot.requested) {
+				/* premature end of file - the file
+				   must have been truncated since it
+				   was opened */
+				BumpGeneration();
+				next_submit_offset = next_append_offset;
+				size = next_append_offset;
+			}
+
+			slot.state = ReadSlot::State::FREE;
+			again = true;
+		}
+	}
+}
+
+/**
+ * Wait for all in-flight read requests to complete before the object
+ * (and with it, the slot buffers the kernel writes into) is
+ * destroyed.  Closing the ring does not synchronize with in-flight
+ * requests - ring teardown on close is asynchronous since kernel
+ * 5.9.
+ */
+void
+UringInputStream::DrainPendingSlots() noexcept
+{
+	try {
+		/* flush requests which were prepared but whose
+		   submission failed earlier; without this, the loop
+		   below would wait for completions the kernel has
+		   never seen */
+		queue.Submit();
+	} catch (...) {
+		/* ignore - the loop below still needs to await the
+		   requests which were submitted successfully */
+	}
+
+	while (true) {
+		/* consume all completions which have arrived
+		   already */
+		while (const auto *cqe = queue.PeekCompletion()) {
+			const uint64_t user_data = cqe->user_data;
+			queue.PopCompletion();
+
+			assert(user_data < slots.size());
+			slots[user_data].state = ReadSlot::State::FREE;
+		}
+
+		bool pending = false;
+		for (const auto &slot : slots)
+			if (slot.state == ReadSlot::State::PENDING)
+				pending = true;
+
+		if (!pending)
+			break;
+
+		if (!queue.WaitCompletion())
+			/* waiting failed; this should not happen,
+			   and there is nothing better we can do
+			   here */
+			break;
+	}
+}
+
+void
+UringInputStream::DeferredStart() noexcept
+{
+	const std::lock_guard<Mutex> protect(mutex);
+
+	SocketMonitor::Open(SocketDescriptor(queue.GetFileDescriptor()));
+	SocketMonitor::ScheduleRead();
+
+	try {
+		SubmitReads();
+	} catch (...) {
+		postponed_exception = std::current_exception();
+		InvokeOnAvailable();
+	}
+}
+
+void
+UringInputStream::DoResume()
+{
+	SubmitReads();
+}
+
+void
+UringInputStream::DoSeek(offset_type new_offset)
+{
+	BumpGeneration();
+	next_submit_offset = next_append_offset = new_offset;
+
+	SubmitReads();
+	SeekDone();
+}
+
+bool
+UringInputStream::OnSocketReady(gcc_unused unsigned flags) noexcept
+{
+	const std::lock_guard<Mutex> protect(mutex);
+
+	try {
+		while (const auto *cqe = queue.PeekCompletion()) {
+			const uint64_t user_data = cqe->user_data;
+			const int res = cqe->res;
+			queue.PopCompletion();
+
+			OnReadCompleted(user_data, res);
+		}
+
+		DrainDoneSlots();
+		SubmitReads();
+	} catch (...) {
+		postponed_exception = std::current_exception();
+		InvokeOnAvailable();
+	}
+
+	return true;
+}
+
+void
+InitUringInputPlugin(EventLoop &event_loop) noexcept
+{
+	uring_input_event_loop = &event_loop;
+}
+
+InputStreamPtr
+OpenUringInputStream(Path path, Mutex &mutex)
+{
+	if (uring_input_event_loop == nullptr)
+		return nullptr;
+
+	FileReader reader(path);
+
+	const FileInfo info = reader.GetFileInfo();
+
+	if (!info.IsRegular())
+		/* let the "file" input plugin generate the error
+		   message for special files */
+		return nullptr;
+
+	try {
+		return std::make_unique<UringInputStream>(*uring_input_event_loop,
+							  path.ToUTF8Throw().c_str(),
+							  std::move(reader),
+							  info.GetSize(),
+							  mutex);
+	} catch (const std::system_error &) {
+		/* io_uring is not available (old kernel or
+		   resource limits) - fall back to the "file"
+		   input plugin */
+		return nullptr;
+	}
+}
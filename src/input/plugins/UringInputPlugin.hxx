@@ -0,0 +1,47 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_INPUT_URING_HXX
+#define MPD_INPUT_URING_HXX
+
+#include "input/Ptr.hxx"
+
+class EventLoop;
+class Path;
+class Mutex;
+
+/**
+ * Announce the #EventLoop which shall be used by io_uring streams.
+ * Until this is called, OpenUringInputStream() always returns
+ * nullptr.
+ */
+void
+InitUringInputPlugin(EventLoop &event_loop) noexcept;
+
+/**
+ * Open a local file for asynchronous reading via io_uring.  Returns
+ * nullptr if io_uring is not available (or was not initialized); the
+ * caller should then fall back to the regular "file" input plugin.
+ *
+ * Throws on error.
+ */
+InputStreamPtr
+OpenUringInputStream(Path path, Mutex &mutex);
+
+#endif
@@ -177,7 +177,7 @@ SetupSampleFormat(snd_pcm_t *pcm, snd_pcm_hw_params_t *hwparams,
 }
 
 HwResult
-SetupHw(snd_pcm_t *pcm,
+SetupHw(snd_pcm_t *pcm, bool mmap,
 	unsigned buffer_time, unsigned period_time,
 	AudioFormat &audio_format, PcmExport::Params &params)
 {
@@ -193,11 +193,28 @@ SetupHw(snd_pcm_t *pcm,
 		throw FormatRuntimeError("snd_pcm_hw_params_any() failed: %s",
 					 snd_strerror(-err));
 
-	err = snd_pcm_hw_params_set_access(pcm, hwparams,
-					   SND_PCM_ACCESS_RW_INTERLEAVED);
-	if (err < 0)
-		throw FormatRuntimeError("snd_pcm_hw_params_set_access() failed: %s",
-					 snd_strerror(-err));
+	snd_pcm_access_t access = SND_PCM_ACCESS_RW_INTERLEAVED;
+
+	if (mmap) {
+		/* write directly into the DMA area, avoiding one
+		   copy of every audio byte */
+		err = snd_pcm_hw_params_set_access(pcm, hwparams,
+						   SND_PCM_ACCESS_MMAP_INTERLEAVED);
+		if (err == 0)
+			access = SND_PCM_ACCESS_MMAP_INTERLEAVED;
+		else
+			FormatDebug(alsa_output_domain,
+				    "mmap access not supported: %s",
+				    snd_strerror(-err));
+	}
+
+	if (access == SND_PCM_ACCESS_RW_INTERLEAVED) {
+		err = snd_pcm_hw_params_set_access(pcm, hwparams,
+						   SND_PCM_ACCESS_RW_INTERLEAVED);
+		if (err < 0)
+			throw FormatRuntimeError("snd_pcm_hw_params_set_access() failed: %s",
+						 snd_strerror(-err));
+	}
 
 	err = SetupSampleFormat(pcm, hwparams,
 				audio_format.format, params);
@@ -290,6 +307,7 @@ SetupHw(snd_pcm_t *pcm,
 					 snd_strerror(-err));
 
 	HwResult result;
+	result.access = access;
 
 	err = snd_pcm_hw_params_get_format(hwparams, &result.format);
 	if (err < 0)
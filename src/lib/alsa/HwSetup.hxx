@@ -29,6 +29,7 @@ struct AudioFormat;
 namespace Alsa {
 
 struct HwResult {
+	snd_pcm_access_t access;
 	snd_pcm_format_t format;
 	snd_pcm_uframes_t buffer_size, period_size;
 };
@@ -36,6 +37,9 @@ struct HwResult {
 /**
  * Wrapper for snd_pcm_hw_params().
  *
+ * @param mmap attempt to use SND_PCM_ACCESS_MMAP_INTERLEAVED, falling
+ * back to SND_PCM_ACCESS_RW_INTERLEAVED if the device does not
+ * support it; the caller must check HwResult::access
  * @param buffer_time the configured buffer time, or 0 if not configured
  * @param period_time the configured period time, or 0 if not configured
  * @param audio_format an #AudioFormat to be configured (or modified)
@@ -43,7 +47,7 @@ struct HwResult {
  * @param params to be modified by this function
  */
 HwResult
-SetupHw(snd_pcm_t *pcm,
+SetupHw(snd_pcm_t *pcm, bool mmap,
 	unsigned buffer_time, unsigned period_time,
 	AudioFormat &audio_format, PcmExport::Params &params);
 
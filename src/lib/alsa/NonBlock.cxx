@@ -21,6 +21,8 @@
 #include "event/MultiSocketMonitor.hxx"
 #include "util/RuntimeError.hxx"
 
+#include <algorithm>
+
 std::chrono::steady_clock::duration
 AlsaNonBlockPcm::PrepareSockets(MultiSocketMonitor &m, snd_pcm_t *pcm)
 {
@@ -80,6 +82,7 @@ AlsaNonBlockMixer::PrepareSockets(MultiSocketMonitor &m, snd_mixer_t *mixer) noe
 {
 	int count = snd_mixer_poll_descriptors_count(mixer);
 	if (count <= 0) {
+		last_pfds.clear();
 		m.ClearSocketList();
 		return std::chrono::steady_clock::duration(-1);
 	}
@@ -90,6 +93,16 @@ AlsaNonBlockMixer::PrepareSockets(MultiSocketMonitor &m, snd_mixer_t *mixer) noe
 	if (count < 0)
 		count = 0;
 
+	if (size_t(count) == last_pfds.size() &&
+	    std::equal(pfds, pfds + count, last_pfds.begin(),
+		       [](const pollfd &a, const pollfd &b){
+			       return a.fd == b.fd && a.events == b.events;
+		       }))
+		/* unchanged: keep the registered socket list */
+		return std::chrono::steady_clock::duration(-1);
+
+	last_pfds.assign(pfds, pfds + count);
+
 	m.ReplaceSocketList(pfds, count);
 	return std::chrono::steady_clock::duration(-1);
 }
@@ -25,6 +25,7 @@
 #include <alsa/asoundlib.h>
 
 #include <chrono>
+#include <vector>
 
 class MultiSocketMonitor;
 
@@ -58,6 +59,15 @@ public:
 class AlsaNonBlockMixer {
 	ReusableArray<pollfd> pfd_buffer;
 
+	/**
+	 * A copy of the last pollfd set passed to
+	 * MultiSocketMonitor::ReplaceSocketList().  A mixer's
+	 * descriptor set rarely changes, but PrepareSockets() is
+	 * called on every event loop iteration; as long as the set is
+	 * unchanged, the registered socket list is left alone.
+	 */
+	std::vector<pollfd> last_pfds;
+
 public:
 	std::chrono::steady_clock::duration PrepareSockets(MultiSocketMonitor &m,
 							   snd_mixer_t *mixer) noexcept;
@@ -104,6 +104,41 @@ CurlGlobal::CurlGlobal(EventLoop &_loop)
 
 	multi.SetOption(CURLMOPT_TIMERFUNCTION, TimerFunction);
 	multi.SetOption(CURLMOPT_TIMERDATA, this);
+
+#if LIBCURL_VERSION_NUM >= 0x072b00
+	/* with HTTP/2, multiple transfers to the same server are
+	   multiplexed over one connection */
+	multi.SetOption(CURLMOPT_PIPELINING, (long)CURLPIPE_MULTIPLEX);
+#endif
+
+	/* keep a few idle connections cached even while no easy
+	   handle is registered, so the next request to the same
+	   server (e.g. the following track on a gapless transition)
+	   reuses the warm connection */
+	multi.SetOption(CURLMOPT_MAXCONNECTS, 4l);
+
+	share.SetOption(CURLSHOPT_LOCKFUNC, LockFunction);
+	share.SetOption(CURLSHOPT_UNLOCKFUNC, UnlockFunction);
+	share.SetOption(CURLSHOPT_USERDATA, this);
+	share.SetOption(CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+	share.SetOption(CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+}
+
+void
+CurlGlobal::LockFunction(gcc_unused CURL *easy, curl_lock_data data,
+			 gcc_unused curl_lock_access access,
+			 void *userptr) noexcept
+{
+	auto &global = *(CurlGlobal *)userptr;
+	global.share_mutexes[data].lock();
+}
+
+void
+CurlGlobal::UnlockFunction(gcc_unused CURL *easy, curl_lock_data data,
+			   void *userptr) noexcept
+{
+	auto &global = *(CurlGlobal *)userptr;
+	global.share_mutexes[data].unlock();
 }
 
 int
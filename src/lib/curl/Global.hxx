@@ -31,8 +31,10 @@
 #define CURL_GLOBAL_HXX
 
 #include "Multi.hxx"
+#include "Share.hxx"
 #include "event/TimerEvent.hxx"
 #include "event/DeferEvent.hxx"
+#include "thread/Mutex.hxx"
 
 class CurlSocket;
 class CurlRequest;
@@ -43,6 +45,20 @@ class CurlRequest;
 class CurlGlobal final {
 	CurlMulti multi;
 
+	/**
+	 * Caches shared between all easy handles: TLS sessions and
+	 * resolver results, so a new connection to a recently used
+	 * server skips the full TLS handshake and the DNS lookup.
+	 */
+	CurlShare share;
+
+	/**
+	 * Serializes access to #share, one mutex per data kind;
+	 * libcurl requires lock callbacks on a share handle even
+	 * though all our requests run in the I/O thread.
+	 */
+	Mutex share_mutexes[CURL_LOCK_DATA_LAST];
+
 	DeferEvent defer_read_info;
 
 	TimerEvent timeout_event;
@@ -54,6 +70,14 @@ public:
 		return timeout_event.GetEventLoop();
 	}
 
+	/**
+	 * The #CURLSH handle to be set on all easy handles
+	 * (CURLOPT_SHARE); see #share.
+	 */
+	CURLSH *GetShare() noexcept {
+		return share.Get();
+	}
+
 	void Add(CURL *easy, CurlRequest &request);
 	void Remove(CURL *easy) noexcept;
 
@@ -85,6 +109,13 @@ public:
 	}
 
 private:
+	/* callbacks for CURLSHOPT_LOCKFUNC/CURLSHOPT_UNLOCKFUNC */
+	static void LockFunction(CURL *easy, curl_lock_data data,
+				 curl_lock_access access,
+				 void *userptr) noexcept;
+	static void UnlockFunction(CURL *easy, curl_lock_data data,
+				   void *userptr) noexcept;
+
 	void UpdateTimeout(long timeout_ms) noexcept;
 	static int TimerFunction(CURLM *global, long timeout_ms,
 				 void *userp) noexcept;
@@ -65,6 +65,15 @@ CurlRequest::CurlRequest(CurlGlobal &_global,
 	easy.SetOption(CURLOPT_NOSIGNAL, 1l);
 	easy.SetOption(CURLOPT_CONNECTTIMEOUT, 10l);
 	easy.SetOption(CURLOPT_HTTPAUTH, (long) CURLAUTH_ANY);
+
+	/* use the global TLS session and DNS caches */
+	easy.SetOption(CURLOPT_SHARE, global.GetShare());
+
+#if LIBCURL_VERSION_NUM >= 0x072b00
+	/* prefer waiting for a multiplexed stream on an existing
+	   HTTP/2 connection over opening another connection */
+	easy.SetOption(CURLOPT_PIPEWAIT, 1l);
+#endif
 }
 
 CurlRequest::~CurlRequest() noexcept
@@ -23,6 +23,7 @@
 
 #ifdef HAVE_ICU
 #include "Util.hxx"
+#include "util/AllocatedArray.hxx"
 #include "util/RuntimeError.hxx"
 
 #include <unicode/ucol.h>
@@ -124,3 +125,65 @@ IcuCollate(const char *a, const char *b) noexcept
 	return strcoll(a, b);
 #endif
 }
+
+std::string
+IcuCollateKey(const char *s) noexcept
+{
+#if !CLANG_CHECK_VERSION(3,6)
+	/* disabled on clang due to -Wtautological-pointer-compare */
+	assert(s != nullptr);
+#endif
+
+#ifdef HAVE_ICU
+	assert(collator != nullptr);
+
+	try {
+		const auto u = UCharFromUTF8(s);
+
+		const int32_t size =
+			ucol_getSortKey(collator, u.begin(), u.size(),
+					nullptr, 0);
+		if (size <= 0)
+			return {};
+
+		std::string key;
+		key.resize(size);
+		ucol_getSortKey(collator, u.begin(), u.size(),
+				(uint8_t *)&key.front(), size);
+		return key;
+	} catch (...) {
+		return {};
+	}
+#elif defined(_WIN32)
+	try {
+		const auto w = MultiByteToWideChar(CP_UTF8, s);
+
+		const int size = LCMapStringEx(LOCALE_NAME_INVARIANT,
+					       LCMAP_SORTKEY|LINGUISTIC_IGNORECASE,
+					       w.c_str(), -1,
+					       nullptr, 0,
+					       nullptr, nullptr, 0);
+		if (size <= 0)
+			return {};
+
+		std::string key;
+		key.resize(size);
+		LCMapStringEx(LOCALE_NAME_INVARIANT,
+			      LCMAP_SORTKEY|LINGUISTIC_IGNORECASE,
+			      w.c_str(), -1,
+			      (LPWSTR)&key.front(), size,
+			      nullptr, nullptr, 0);
+		return key;
+	} catch (...) {
+		return {};
+	}
+#else
+	const size_t size = strxfrm(nullptr, s, 0);
+
+	std::string key;
+	key.resize(size + 1);
+	strxfrm(&key.front(), s, size + 1);
+	key.resize(size);
+	return key;
+#endif
+}
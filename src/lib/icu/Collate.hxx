@@ -22,6 +22,8 @@
 
 #include "util/Compiler.h"
 
+#include <string>
+
 /**
  * Throws #std::runtime_error on error.
  */
@@ -35,4 +37,17 @@ gcc_pure gcc_nonnull_all
 int
 IcuCollate(const char *a, const char *b) noexcept;
 
+/**
+ * Compute a collation sort key for the given UTF-8 string.  Two keys
+ * compare (as raw bytes, e.g. with memcmp() or std::string ordering)
+ * in the same order as IcuCollate() compares the original strings.
+ * Computing the key once and sorting over keys avoids running the
+ * collation transform on every comparison.
+ *
+ * Returns an empty string if no key could be computed.
+ */
+gcc_pure gcc_nonnull_all
+std::string
+IcuCollateKey(const char *s) noexcept;
+
 #endif
@@ -64,3 +64,25 @@ IcuCompare::IsIn(const char *haystack) const noexcept
 	return false;
 #endif
 }
+
+bool
+IcuCompare::EqualsFolded(const char *haystack) const noexcept
+{
+#ifdef HAVE_ICU_CASE_FOLD
+	return StringIsEqual(haystack, needle.c_str());
+#else
+	/* without a case folding implementation, there are no
+	   pre-folded strings */
+	return *this == haystack;
+#endif
+}
+
+bool
+IcuCompare::IsInFolded(const char *haystack) const noexcept
+{
+#ifdef HAVE_ICU_CASE_FOLD
+	return StringFind(haystack, needle.c_str()) != nullptr;
+#else
+	return IsIn(haystack);
+#endif
+}
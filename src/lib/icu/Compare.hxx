@@ -61,6 +61,20 @@ public:
 
 	gcc_pure
 	bool IsIn(const char *haystack) const noexcept;
+
+	/**
+	 * Like operator==(), but the haystack has already been
+	 * case-folded by the caller (see IcuCaseFold()), reducing the
+	 * comparison to a plain string comparison.
+	 */
+	gcc_pure
+	bool EqualsFolded(const char *folded_haystack) const noexcept;
+
+	/**
+	 * Like IsIn(), but with a pre-folded haystack.
+	 */
+	gcc_pure
+	bool IsInFolded(const char *folded_haystack) const noexcept;
 };
 
 #endif
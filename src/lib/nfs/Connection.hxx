@@ -175,6 +175,16 @@ public:
 	void AddLease(NfsLease &lease) noexcept;
 	void RemoveLease(NfsLease &lease) noexcept;
 
+	/**
+	 * The number of registered leases, i.e. a rough measure of
+	 * this connection's load.  Must be called from the
+	 * #EventLoop's thread.
+	 */
+	gcc_pure
+	size_t GetLeaseCount() const noexcept {
+		return new_leases.size() + active_leases.size();
+	}
+
 	void Stat(const char *path, NfsCallback &callback);
 	void Lstat(const char *path, NfsCallback &callback);
 
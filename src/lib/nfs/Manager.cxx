@@ -24,6 +24,14 @@
 
 #include <string.h>
 
+/**
+ * How many connections shall be opened per server/export pair (at
+ * most)?  One libnfs context serializes all requests over one TCP
+ * connection; a pool of connections allows concurrent streams to
+ * utilize more of the server's throughput.
+ */
+static constexpr size_t NFS_MAX_CONNECTIONS = 4;
+
 void
 NfsManager::ManagedConnection::OnNfsConnectionError(std::exception_ptr &&e) noexcept
 {
@@ -87,17 +95,31 @@ NfsManager::GetConnection(const char *server, const char *export_name) noexcept
 	assert(export_name != nullptr);
 	assert(GetEventLoop().IsInside());
 
-	Map::insert_commit_data hint;
-	auto result = connections.insert_check(LookupKey{server, export_name},
-					       Compare(), hint);
-	if (result.second) {
-		auto c = new ManagedConnection(*this, GetEventLoop(),
-					       server, export_name);
-		connections.insert_commit(*c, hint);
-		return *c;
-	} else {
-		return *result.first;
+	/* find the least loaded connection for this server/export
+	   pair */
+	ManagedConnection *best = nullptr;
+	size_t n = 0;
+
+	const auto range =
+		connections.equal_range(LookupKey{server, export_name},
+					Compare());
+	for (auto i = range.first; i != range.second; ++i) {
+		++n;
+		if (best == nullptr ||
+		    i->GetLeaseCount() < best->GetLeaseCount())
+			best = &*i;
 	}
+
+	if (best != nullptr &&
+	    (best->GetLeaseCount() == 0 || n >= NFS_MAX_CONNECTIONS))
+		return *best;
+
+	/* all existing connections are busy - spread the load over
+	   one more connection */
+	auto c = new ManagedConnection(*this, GetEventLoop(),
+				       server, export_name);
+	connections.insert(*c);
+	return *c;
 }
 
 void
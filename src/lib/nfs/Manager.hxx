@@ -70,11 +70,14 @@ class NfsManager final : IdleMonitor {
 	};
 
 	/**
-	 * Maps server and export_name to #ManagedConnection.
+	 * Maps server and export_name to #ManagedConnection.  There
+	 * may be more than one connection per server/export pair, to
+	 * spread concurrent streams over multiple NFS sessions (see
+	 * GetConnection()).
 	 */
-	typedef boost::intrusive::set<ManagedConnection,
-				      boost::intrusive::compare<Compare>,
-				      boost::intrusive::constant_time_size<false>> Map;
+	typedef boost::intrusive::multiset<ManagedConnection,
+					   boost::intrusive::compare<Compare>,
+					   boost::intrusive::constant_time_size<false>> Map;
 
 	Map connections;
 
@@ -98,7 +101,12 @@ public:
 
 	using IdleMonitor::GetEventLoop;
 
-	gcc_pure
+	/**
+	 * Obtain a connection to the given server/export.  Returns
+	 * the least loaded existing connection; if all of them are
+	 * busy, a new connection is created, up to a fixed limit per
+	 * server/export pair.
+	 */
 	NfsConnection &GetConnection(const char *server,
 				     const char *export_name) noexcept;
 
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_SMBCLIENT_CONTEXT_HXX
+#define MPD_SMBCLIENT_CONTEXT_HXX
+
+#include "thread/Mutex.hxx"
+
+#include <libsmbclient.h>
+
+#include <memory>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+/**
+ * Wrapper for a #SMBCCTX, one libsmbclient connection context.
+ *
+ * Each instance has its own #Mutex, because libsmbclient contexts
+ * are not thread-safe.  Unlike the global #smbclient_mutex, which
+ * used to serialize all SMB I/O byte-for-byte, this only serializes
+ * users of one connection; streams and update walks on different
+ * servers proceed in parallel.
+ */
+class SmbclientContext {
+	/**
+	 * Protects all operations on this context.  The global
+	 * #smbclient_mutex is only held while creating and
+	 * destroying contexts, because only those functions touch
+	 * libsmbclient global state.
+	 */
+	Mutex mutex;
+
+	SMBCCTX *const ctx;
+
+	explicit SmbclientContext(SMBCCTX *_ctx) noexcept
+		:ctx(_ctx) {}
+
+public:
+	~SmbclientContext() noexcept;
+
+	SmbclientContext(const SmbclientContext &) = delete;
+	SmbclientContext &operator=(const SmbclientContext &) = delete;
+
+	/**
+	 * Create a new connection context.
+	 *
+	 * Throws on error.
+	 */
+	static std::unique_ptr<SmbclientContext> New();
+
+	SMBCFILE *OpenReadOnly(const char *path) noexcept {
+		const std::lock_guard<Mutex> protect(mutex);
+		return smbc_getFunctionOpen(ctx)(ctx, path, O_RDONLY, 0);
+	}
+
+	ssize_t Read(SMBCFILE *file, void *buffer, size_t size) noexcept {
+		const std::lock_guard<Mutex> protect(mutex);
+		return smbc_getFunctionRead(ctx)(ctx, file, buffer, size);
+	}
+
+	off_t Seek(SMBCFILE *file, off_t offset, int whence=SEEK_SET) noexcept {
+		const std::lock_guard<Mutex> protect(mutex);
+		return smbc_getFunctionLseek(ctx)(ctx, file, offset, whence);
+	}
+
+	int Stat(SMBCFILE *file, struct stat &st) noexcept {
+		const std::lock_guard<Mutex> protect(mutex);
+		return smbc_getFunctionFstat(ctx)(ctx, file, &st);
+	}
+
+	int Stat(const char *path, struct stat &st) noexcept {
+		const std::lock_guard<Mutex> protect(mutex);
+		return smbc_getFunctionStat(ctx)(ctx, path, &st);
+	}
+
+	void Close(SMBCFILE *file) noexcept {
+		const std::lock_guard<Mutex> protect(mutex);
+		smbc_getFunctionClose(ctx)(ctx, file);
+	}
+
+	SMBCFILE *OpenDirectory(const char *path) noexcept {
+		const std::lock_guard<Mutex> protect(mutex);
+		return smbc_getFunctionOpendir(ctx)(ctx, path);
+	}
+
+	void CloseDirectory(SMBCFILE *dir) noexcept {
+		const std::lock_guard<Mutex> protect(mutex);
+		smbc_getFunctionClosedir(ctx)(ctx, dir);
+	}
+
+	const struct smbc_dirent *ReadDirectory(SMBCFILE *dir) noexcept {
+		const std::lock_guard<Mutex> protect(mutex);
+		return smbc_getFunctionReaddir(ctx)(ctx, dir);
+	}
+};
+
+#endif
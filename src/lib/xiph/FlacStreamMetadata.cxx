@@ -103,11 +103,13 @@ flac_scan_comment(const FLAC__StreamMetadata_VorbisComment_Entry *entry,
 	}
 
 	for (const struct tag_table *i = xiph_tags; i->name != nullptr; ++i)
-		if (flac_copy_comment(entry, i->name, i->type, handler))
+		if (handler.WantTag(i->type) &&
+		    flac_copy_comment(entry, i->name, i->type, handler))
 			return;
 
 	for (unsigned i = 0; i < TAG_NUM_OF_ITEM_TYPES; ++i)
-		if (flac_copy_comment(entry,
+		if (handler.WantTag((TagType)i) &&
+		    flac_copy_comment(entry,
 				      tag_item_names[i], (TagType)i,
 				      handler))
 			return;
@@ -40,8 +40,14 @@ OggSyncState::ExpectPage(ogg_page &page)
 {
 	while (true) {
 		int r = ogg_sync_pageout(&oy, &page);
-		if (r != 0)
+		if (r != 0) {
+			if (r > 0) {
+				start_offset = offset;
+				offset += page.header_len + page.body_len;
+			}
+
 			return r > 0;
+		}
 
 		if (!Feed(1024))
 			return false;
@@ -66,12 +72,16 @@ OggSyncState::ExpectPageSeek(ogg_page &page)
 
 	while (true) {
 		int r = ogg_sync_pageseek(&oy, &page);
-		if (r > 0)
+		if (r > 0) {
+			start_offset = offset;
+			offset += r;
 			return true;
+		}
 
 		if (r < 0) {
 			/* skipped -r bytes */
 			size_t nbytes = -r;
+			offset += nbytes;
 			if (nbytes > remaining_skipped)
 				/* still no ogg page - we lost our
 				   patience, abort */
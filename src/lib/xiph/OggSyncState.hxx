@@ -23,6 +23,7 @@
 #include <ogg/ogg.h>
 
 #include <stddef.h>
+#include <stdint.h>
 
 class Reader;
 
@@ -34,9 +35,21 @@ class OggSyncState {
 
 	Reader &reader;
 
+	/**
+	 * The #Reader offset of the first byte not yet consumed by
+	 * ogg_sync_pageout()/ogg_sync_pageseek(), i.e. the offset
+	 * where the next returned page will start.
+	 */
+	uint64_t offset;
+
+	/**
+	 * The #Reader offset where the last returned page started.
+	 */
+	uint64_t start_offset = 0;
+
 public:
-	explicit OggSyncState(Reader &_reader)
-		:reader(_reader) {
+	explicit OggSyncState(Reader &_reader, uint64_t _offset=0)
+		:reader(_reader), offset(_offset) {
 		ogg_sync_init(&oy);
 	}
 
@@ -51,6 +64,18 @@ public:
 		ogg_sync_reset(&oy);
 	}
 
+	/**
+	 * Announce the new #Reader offset after the caller has seeked
+	 * the underlying stream (and before calling Reset()).
+	 */
+	void SetOffset(uint64_t _offset) noexcept {
+		offset = _offset;
+	}
+
+	uint64_t GetStartOffset() const noexcept {
+		return start_offset;
+	}
+
 	bool Feed(size_t size);
 
 	bool ExpectPage(ogg_page &page);
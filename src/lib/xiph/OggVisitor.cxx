@@ -44,6 +44,8 @@ OggVisitor::ReadNextPage()
 		stream.Reinitialize(page_serialno);
 	}
 
+	OnOggPage(page, sync.GetStartOffset());
+
 	stream.PageIn(page);
 	return true;
 }
@@ -87,8 +89,9 @@ OggVisitor::Visit()
 }
 
 void
-OggVisitor::PostSeek()
+OggVisitor::PostSeek(uint64_t offset)
 {
+	sync.SetOffset(offset);
 	sync.Reset();
 
 	/* reset the stream to clear any previous partial packet
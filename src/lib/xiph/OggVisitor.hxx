@@ -22,10 +22,12 @@
 
 #include "OggSyncState.hxx"
 #include "OggStreamState.hxx"
+#include "util/Compiler.h"
 
 #include <ogg/ogg.h>
 
 #include <stddef.h>
+#include <stdint.h>
 
 class Reader;
 
@@ -51,8 +53,10 @@ public:
 
 	/**
 	 * Call this method after seeking the #Reader.
+	 *
+	 * @param offset the current #Reader offset
 	 */
-	void PostSeek();
+	void PostSeek(uint64_t offset);
 
 private:
 	void EndStream();
@@ -61,6 +65,15 @@ private:
 	void HandlePackets();
 
 protected:
+	/**
+	 * Called for each Ogg page before its packets are submitted,
+	 * e.g. to build a seek index from page granule positions.
+	 *
+	 * @param start_offset the #Reader offset where the page starts
+	 */
+	virtual void OnOggPage(gcc_unused const ogg_page &page,
+			       gcc_unused uint64_t start_offset) noexcept {}
+
 	virtual void OnOggBeginning(const ogg_packet &packet) = 0;
 	virtual void OnOggPacket(const ogg_packet &packet) = 0;
 	virtual void OnOggEnd() = 0;
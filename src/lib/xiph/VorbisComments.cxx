@@ -75,12 +75,14 @@ vorbis_scan_comment(const char *comment, TagHandler &handler) noexcept
 	}
 
 	for (const struct tag_table *i = xiph_tags; i->name != nullptr; ++i)
-		if (vorbis_copy_comment(comment, i->name, i->type,
+		if (handler.WantTag(i->type) &&
+		    vorbis_copy_comment(comment, i->name, i->type,
 					handler))
 			return;
 
 	for (unsigned i = 0; i < TAG_NUM_OF_ITEM_TYPES; ++i)
-		if (vorbis_copy_comment(comment,
+		if (handler.WantTag(TagType(i)) &&
+		    vorbis_copy_comment(comment,
 					tag_item_names[i], TagType(i),
 					handler))
 			return;
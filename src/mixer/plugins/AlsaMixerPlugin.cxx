@@ -41,19 +41,24 @@ extern "C" {
 #define VOLUME_MIXER_ALSA_CONTROL_DEFAULT	"PCM"
 static constexpr unsigned VOLUME_MIXER_ALSA_INDEX_DEFAULT = 0;
 
+class AlsaMixer;
+
 class AlsaMixerMonitor final : MultiSocketMonitor {
 	DeferEvent defer_invalidate_sockets;
 
 	snd_mixer_t *mixer;
 
+	AlsaMixer &mixer_object;
+
 	AlsaNonBlockMixer non_block;
 
 public:
-	AlsaMixerMonitor(EventLoop &_loop, snd_mixer_t *_mixer)
+	AlsaMixerMonitor(EventLoop &_loop, snd_mixer_t *_mixer,
+			 AlsaMixer &_mixer_object)
 		:MultiSocketMonitor(_loop),
 		 defer_invalidate_sockets(_loop,
 					  BIND_THIS_METHOD(InvalidateSockets)),
-		 mixer(_mixer) {
+		 mixer(_mixer), mixer_object(_mixer_object) {
 		defer_invalidate_sockets.Schedule();
 	}
 
@@ -81,6 +86,15 @@ class AlsaMixer final : public Mixer {
 
 	AlsaMixerMonitor *monitor;
 
+	/**
+	 * Set by the libasound element callback when the volume has
+	 * changed; hardware volume knobs generate dozens of element
+	 * events per turn, so the actual volume read and the idle
+	 * broadcast are deferred until the whole event burst has been
+	 * processed (see FlushVolumeChange()).
+	 */
+	bool volume_change_pending = false;
+
 public:
 	AlsaMixer(EventLoop &_event_loop, MixerListener &_listener)
 		:Mixer(alsa_mixer_plugin, _listener),
@@ -91,6 +105,22 @@ public:
 	void Configure(const ConfigBlock &block);
 	void Setup();
 
+	/**
+	 * Schedule a deferred volume read; called by the libasound
+	 * element callback.
+	 */
+	void DeferVolumeChange() noexcept {
+		volume_change_pending = true;
+	}
+
+	/**
+	 * If a volume change is pending, read the new volume once and
+	 * notify the #MixerListener; called after
+	 * snd_mixer_handle_events() has dispatched all queued element
+	 * events.
+	 */
+	void FlushVolumeChange() noexcept;
+
 	/* virtual methods from class Mixer */
 	void Open() override;
 	void Close() noexcept override;
@@ -132,6 +162,10 @@ AlsaMixerMonitor::DispatchSockets() noexcept
 			return;
 		}
 	}
+
+	/* all queued element events have been dispatched: emit at
+	   most one volume change notification for the whole burst */
+	mixer_object.FlushVolumeChange();
 }
 
 /*
@@ -145,17 +179,26 @@ alsa_mixer_elem_callback(snd_mixer_elem_t *elem, unsigned mask)
 	AlsaMixer &mixer = *(AlsaMixer *)
 		snd_mixer_elem_get_callback_private(elem);
 
-	if (mask & SND_CTL_EVENT_MASK_VALUE) {
-		try {
-			int volume = mixer.GetVolume();
-			mixer.listener.OnMixerVolumeChanged(mixer, volume);
-		} catch (...) {
-		}
-	}
+	if (mask & SND_CTL_EVENT_MASK_VALUE)
+		mixer.DeferVolumeChange();
 
 	return 0;
 }
 
+void
+AlsaMixer::FlushVolumeChange() noexcept
+{
+	if (!volume_change_pending)
+		return;
+
+	volume_change_pending = false;
+
+	try {
+		listener.OnMixerVolumeChanged(*this, GetVolume());
+	} catch (...) {
+	}
+}
+
 /*
  * mixer_plugin methods
  *
@@ -230,7 +273,7 @@ AlsaMixer::Setup()
 	snd_mixer_elem_set_callback_private(elem, this);
 	snd_mixer_elem_set_callback(elem, alsa_mixer_elem_callback);
 
-	monitor = new AlsaMixerMonitor(event_loop, handle);
+	monitor = new AlsaMixerMonitor(event_loop, handle, *this);
 }
 
 void
@@ -39,10 +39,15 @@
 #include <ws2tcpip.h>
 #else
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #endif
 
+#ifdef __linux__
+#include <linux/errqueue.h>
+#endif
+
 #include <errno.h>
 #include <string.h>
 
@@ -444,6 +449,94 @@ SocketDescriptor::Write(const void *buffer, size_t length) noexcept
 	return ::send(Get(), (const char *)buffer, length, flags);
 }
 
+#ifndef _WIN32
+
+ssize_t
+SocketDescriptor::WriteV(const struct iovec *v, size_t n) noexcept
+{
+	struct msghdr m;
+	memset(&m, 0, sizeof(m));
+	m.msg_iov = const_cast<struct iovec *>(v);
+	m.msg_iovlen = n;
+
+	int flags = 0;
+#ifdef __linux__
+	flags |= MSG_NOSIGNAL;
+#endif
+
+	return ::sendmsg(Get(), &m, flags);
+}
+
+#endif
+
+#ifdef __linux__
+
+bool
+SocketDescriptor::SetZeroCopy(bool value) noexcept
+{
+#ifdef SO_ZEROCOPY
+	return SetBoolOption(SOL_SOCKET, SO_ZEROCOPY, value);
+#else
+	/* not supported by the build environment's kernel headers */
+	(void)value;
+	return false;
+#endif
+}
+
+ssize_t
+SocketDescriptor::WriteVZeroCopy(const struct iovec *v, size_t n) noexcept
+{
+#ifdef MSG_ZEROCOPY
+	struct msghdr m;
+	memset(&m, 0, sizeof(m));
+	m.msg_iov = const_cast<struct iovec *>(v);
+	m.msg_iovlen = n;
+
+	return ::sendmsg(Get(), &m, MSG_NOSIGNAL|MSG_ZEROCOPY);
+#else
+	return WriteV(v, n);
+#endif
+}
+
+bool
+SocketDescriptor::ReadZeroCopyCompletion(uint32_t &lo, uint32_t &hi) noexcept
+{
+#ifdef SO_EE_ORIGIN_ZEROCOPY
+	struct msghdr m;
+	char control[64];
+	memset(&m, 0, sizeof(m));
+	m.msg_control = control;
+	m.msg_controllen = sizeof(control);
+
+	if (::recvmsg(Get(), &m, MSG_ERRQUEUE|MSG_DONTWAIT) < 0)
+		return false;
+
+	for (auto *cmsg = CMSG_FIRSTHDR(&m); cmsg != nullptr;
+	     cmsg = CMSG_NXTHDR(&m, cmsg)) {
+		if ((cmsg->cmsg_level == SOL_IP &&
+		     cmsg->cmsg_type == IP_RECVERR) ||
+		    (cmsg->cmsg_level == SOL_IPV6 &&
+		     cmsg->cmsg_type == IPV6_RECVERR)) {
+			const auto *ee = (const struct sock_extended_err *)
+				CMSG_DATA(cmsg);
+			if (ee->ee_origin == SO_EE_ORIGIN_ZEROCOPY) {
+				lo = ee->ee_info;
+				hi = ee->ee_data;
+				return true;
+			}
+		}
+	}
+
+	return false;
+#else
+	(void)lo;
+	(void)hi;
+	return false;
+#endif
+}
+
+#endif
+
 #ifdef _WIN32
 
 int
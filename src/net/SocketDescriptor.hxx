@@ -35,10 +35,13 @@
 
 #include <type_traits>
 
+#include <stdint.h>
+
 class SocketAddress;
 class StaticSocketAddress;
 class IPv4Address;
 class IPv6Address;
+struct iovec;
 
 /**
  * An OO wrapper for a UNIX socket descriptor.
@@ -228,6 +231,49 @@ public:
 	ssize_t Read(void *buffer, size_t length) noexcept;
 	ssize_t Write(const void *buffer, size_t length) noexcept;
 
+#ifndef _WIN32
+	/**
+	 * Send multiple buffers with one system call (scatter-gather
+	 * I/O).
+	 */
+	ssize_t WriteV(const struct iovec *v, size_t n) noexcept;
+#endif
+
+#ifdef __linux__
+	/**
+	 * Enable SO_ZEROCOPY on this socket, which allows sending
+	 * with WriteVZeroCopy().
+	 *
+	 * @return true on success, false if the kernel does not
+	 * support zerocopy sends on this socket
+	 */
+	bool SetZeroCopy(bool value=true) noexcept;
+
+	/**
+	 * Like WriteV(), but with MSG_ZEROCOPY: the kernel transmits
+	 * directly from the caller's buffers instead of copying them.
+	 * The caller must keep the buffers alive and unmodified until
+	 * the kernel reports completion on the socket's error queue;
+	 * each successful call is assigned the next sequence number,
+	 * starting with 0.
+	 *
+	 * May only be used after SetZeroCopy() has succeeded.
+	 *
+	 * @see ReadZeroCopyCompletion()
+	 */
+	ssize_t WriteVZeroCopy(const struct iovec *v, size_t n) noexcept;
+
+	/**
+	 * Read one MSG_ZEROCOPY completion notification from the
+	 * socket's error queue (non-blocking).  On success, the range
+	 * of completed send sequence numbers [lo, hi] is returned,
+	 * and the caller may release the corresponding buffers.
+	 *
+	 * @return true if a notification was read
+	 */
+	bool ReadZeroCopyCompletion(uint32_t &lo, uint32_t &hi) noexcept;
+#endif
+
 #ifdef _WIN32
 	int WaitReadable(int timeout_ms) const noexcept;
 	int WaitWritable(int timeout_ms) const noexcept;
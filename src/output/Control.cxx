@@ -23,6 +23,7 @@
 #include "mixer/MixerControl.hxx"
 #include "filter/plugins/ReplayGainFilterPlugin.hxx"
 #include "config/Block.hxx"
+#include "thread/Util.hxx"
 #include "Log.hxx"
 
 #include <stdexcept>
@@ -52,6 +53,10 @@ AudioOutputControl::Configure(const ConfigBlock &block)
 	tags = block.GetBlockValue("tags", true);
 	always_on = block.GetBlockValue("always_on", false);
 	enabled = block.GetBlockValue("enabled", true);
+
+	const char *p = block.GetBlockValue("thread_affinity");
+	if (p != nullptr)
+		thread_affinity = ParseCpuAffinity(p);
 }
 
 const char *
@@ -233,6 +238,39 @@ AudioOutputControl::Open(const AudioFormat audio_format,
 	return open2;
 }
 
+inline void
+AudioOutputControl::OpenAsync(const AudioFormat audio_format,
+			      const MusicPipe &mp) noexcept
+{
+	assert(allow_play);
+	assert(audio_format.IsValid());
+
+	fail_timer.Reset();
+
+	if (open && audio_format == request.audio_format) {
+		assert(request.pipe == &mp || (always_on && pause));
+
+		if (!pause)
+			/* already open, already the right parameters
+			   - nothing needs to be done */
+			return;
+	}
+
+	request.audio_format = audio_format;
+	request.pipe = &mp;
+
+	if (!thread.IsDefined()) {
+		try {
+			StartThread();
+		} catch (...) {
+			LogError(std::current_exception());
+			return;
+		}
+	}
+
+	CommandAsync(Command::OPEN);
+}
+
 void
 AudioOutputControl::CloseWait() noexcept
 {
@@ -249,6 +287,22 @@ AudioOutputControl::CloseWait() noexcept
 		fail_timer.Reset();
 }
 
+inline void
+AudioOutputControl::CloseAsync() noexcept
+{
+	assert(allow_play);
+
+	if (output->mixer != nullptr)
+		mixer_auto_close(output->mixer);
+
+	assert(!open || !fail_timer.IsDefined());
+
+	if (open)
+		CommandAsync(Command::CLOSE);
+	else
+		fail_timer.Reset();
+}
+
 bool
 AudioOutputControl::LockUpdate(const AudioFormat audio_format,
 			       const MusicPipe &mp,
@@ -267,6 +321,41 @@ AudioOutputControl::LockUpdate(const AudioFormat audio_format,
 	return false;
 }
 
+void
+AudioOutputControl::LockUpdateAsync(const AudioFormat audio_format,
+				    const MusicPipe &mp,
+				    bool force) noexcept
+{
+	const std::lock_guard<Mutex> protect(mutex);
+
+	if (enabled && really_enabled) {
+		if (force || !fail_timer.IsDefined() ||
+		    fail_timer.Check(REOPEN_AFTER * 1000))
+			OpenAsync(audio_format, mp);
+	} else if (IsOpen())
+		CloseAsync();
+}
+
+void
+AudioOutputControl::LockFinishUpdate() noexcept
+{
+	const std::lock_guard<Mutex> protect(mutex);
+
+	WaitForCommand();
+
+	if (open && output->mixer != nullptr) {
+		/* idempotent if the mixer is already open */
+		const ScopeUnlock unlock(mutex);
+		try {
+			mixer_open(output->mixer);
+		} catch (...) {
+			FormatError(std::current_exception(),
+				    "Failed to open mixer for '%s'",
+				    GetName());
+		}
+	}
+}
+
 bool
 AudioOutputControl::IsChunkConsumed(const MusicChunk &chunk) const noexcept
 {
@@ -364,6 +453,27 @@ AudioOutputControl::LockRelease() noexcept
 		fail_timer.Reset();
 }
 
+void
+AudioOutputControl::LockReleaseAsync() noexcept
+{
+	if (output->mixer != nullptr &&
+	    (!always_on || !output->SupportsPause()))
+		/* the device has no pause mode: close the mixer,
+		   unless its "global" flag is set (checked by
+		   mixer_auto_close()) */
+		mixer_auto_close(output->mixer);
+
+	const std::lock_guard<Mutex> protect(mutex);
+
+	assert(!open || !fail_timer.IsDefined());
+	assert(allow_play);
+
+	if (IsOpen())
+		CommandAsync(Command::RELEASE);
+	else
+		fail_timer.Reset();
+}
+
 void
 AudioOutputControl::LockCloseWait() noexcept
 {
@@ -373,6 +483,15 @@ AudioOutputControl::LockCloseWait() noexcept
 	CloseWait();
 }
 
+void
+AudioOutputControl::LockCloseAsync() noexcept
+{
+	assert(!open || !fail_timer.IsDefined());
+
+	const std::lock_guard<Mutex> protect(mutex);
+	CloseAsync();
+}
+
 void
 AudioOutputControl::BeginDestroy() noexcept
 {
@@ -160,6 +160,12 @@ class AudioOutputControl {
 	 */
 	bool always_on;
 
+	/**
+	 * The CPU affinity mask for the output thread (see
+	 * SetThreadAffinity()), or 0 if no affinity was configured.
+	 */
+	uint64_t thread_affinity = 0;
+
 	/**
 	 * Has the user enabled this device?
 	 */
@@ -360,12 +366,26 @@ public:
 	void CloseWait() noexcept;
 	void LockCloseWait() noexcept;
 
+	/**
+	 * Like LockCloseWait(), but only queue the CLOSE command
+	 * without waiting for completion; caller shall wait with
+	 * WaitForCommand().
+	 */
+	void LockCloseAsync() noexcept;
+
 	/**
 	 * Closes the audio output, but if the "always_on" flag is set, put it
 	 * into pause mode instead.
 	 */
 	void LockRelease() noexcept;
 
+	/**
+	 * Like LockRelease(), but only queue the RELEASE command
+	 * without waiting for completion; caller shall wait with
+	 * WaitForCommand().
+	 */
+	void LockReleaseAsync() noexcept;
+
 	void SetReplayGainMode(ReplayGainMode _mode) noexcept {
 		source.SetReplayGainMode(_mode);
 	}
@@ -382,6 +402,23 @@ public:
 	 */
 	bool Open(AudioFormat audio_format, const MusicPipe &mp) noexcept;
 
+	/**
+	 * Like Open(), but only queue the OPEN command without
+	 * waiting for completion.
+	 *
+	 * Caller must lock the mutex.
+	 */
+	void OpenAsync(AudioFormat audio_format,
+		       const MusicPipe &mp) noexcept;
+
+	/**
+	 * Like CloseWait(), but only queue the CLOSE command without
+	 * waiting for completion.
+	 *
+	 * Caller must lock the mutex.
+	 */
+	void CloseAsync() noexcept;
+
 	/**
 	 * Opens or closes the device, depending on the "enabled"
 	 * flag.
@@ -393,6 +430,23 @@ public:
 			const MusicPipe &mp,
 			bool force) noexcept;
 
+	/**
+	 * Like LockUpdate(), but only queue the command without
+	 * waiting for completion.  Waiting and opening the mixer is
+	 * done by LockFinishUpdate(); issuing the commands to all
+	 * outputs before waiting makes the total latency the maximum
+	 * of the devices instead of the sum.
+	 */
+	void LockUpdateAsync(const AudioFormat audio_format,
+			     const MusicPipe &mp,
+			     bool force) noexcept;
+
+	/**
+	 * Wait for a command queued by LockUpdateAsync() and open the
+	 * mixer if the device is now open.
+	 */
+	void LockFinishUpdate() noexcept;
+
 	/**
 	 * Did we already consumed this chunk?
 	 *
@@ -124,6 +124,16 @@ public:
 	 */
 	FilterObserver convert_filter;
 
+	/**
+	 * May this output share filtered chunk data with other
+	 * outputs?  True if the filter chain contains nothing but
+	 * replay gain and the convert filter, i.e. no configured
+	 * filters, no normalization and no software mixer (whose
+	 * volume may diverge between outputs).  See
+	 * AudioOutputSource::FilterChunk().
+	 */
+	bool can_share_filter = false;
+
 	/**
 	 * Throws #std::runtime_error on error.
 	 */
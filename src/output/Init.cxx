@@ -141,6 +141,10 @@ audio_output_load_mixer(EventLoop &event_loop, FilteredAudioOutput &ao,
 
 		filter_chain_append(filter_chain, "software_mixer",
 				    ao.volume_filter.Set(volume_filter_prepare()));
+
+		/* the software volume may diverge between outputs */
+		ao.can_share_filter = false;
+
 		return mixer;
 	}
 
@@ -176,6 +180,14 @@ FilteredAudioOutput::Configure(const ConfigBlock &block,
 	prepared_filter = filter_chain_new();
 	assert(prepared_filter != nullptr);
 
+	/* with no configured filters and no normalization, the chain
+	   is a pure function of the audio formats and replay gain
+	   parameters, and its results may be shared with equivalent
+	   outputs (unless a software mixer is added later) */
+	can_share_filter = !defaults.normalize &&
+		(filter_factory == nullptr ||
+		 *block.GetBlockValue(AUDIO_FILTERS, "") == 0);
+
 	/* create the normalization filter (if configured) */
 
 	if (defaults.normalize) {
@@ -241,6 +253,11 @@ FilteredAudioOutput::Setup(EventLoop &event_loop,
 	/* use the hardware mixer for replay gain? */
 
 	if (strcmp(replay_gain_handler, "mixer") == 0) {
+		/* the replay gain filter manipulates this output's
+		   hardware mixer; its PCM output is specific to this
+		   output */
+		can_share_filter = false;
+
 		if (mixer != nullptr)
 			replay_gain_filter_set_mixer(*prepared_replay_gain_filter,
 						     mixer, 100);
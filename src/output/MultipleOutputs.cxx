@@ -240,7 +240,16 @@ MultipleOutputs::Open(const AudioFormat audio_format)
 	input_audio_format = audio_format;
 
 	EnableDisable();
-	Update(true);
+
+	/* parallel open: queue the OPEN commands to all outputs,
+	   then wait for them as a group, so the total latency is the
+	   slowest device instead of the sum of all devices */
+
+	for (auto *ao : outputs)
+		ao->LockUpdateAsync(input_audio_format, *pipe, true);
+
+	for (auto *ao : outputs)
+		ao->LockFinishUpdate();
 
 	std::exception_ptr first_error;
 
@@ -400,8 +409,12 @@ MultipleOutputs::Cancel() noexcept
 void
 MultipleOutputs::Close() noexcept
 {
+	/* parallel execution */
+
 	for (auto *ao : outputs)
-		ao->LockCloseWait();
+		ao->LockCloseAsync();
+
+	WaitAll();
 
 	pipe.reset();
 
@@ -413,8 +426,12 @@ MultipleOutputs::Close() noexcept
 void
 MultipleOutputs::Release() noexcept
 {
+	/* parallel execution */
+
 	for (auto *ao : outputs)
-		ao->LockRelease();
+		ao->LockReleaseAsync();
+
+	WaitAll();
 
 	pipe.reset();
 
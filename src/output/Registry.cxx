@@ -20,6 +20,7 @@
 #include "config.h"
 #include "Registry.hxx"
 #include "OutputPlugin.hxx"
+#include "plugins/AAudioOutputPlugin.hxx"
 #include "plugins/AlsaOutputPlugin.hxx"
 #include "plugins/AoOutputPlugin.hxx"
 #include "plugins/FifoOutputPlugin.hxx"
@@ -34,9 +35,11 @@
 #include "plugins/PipeOutputPlugin.hxx"
 #include "plugins/PulseOutputPlugin.hxx"
 #include "plugins/RecorderOutputPlugin.hxx"
+#include "plugins/ShmOutputPlugin.hxx"
 #include "plugins/ShoutOutputPlugin.hxx"
 #include "plugins/sles/SlesOutputPlugin.hxx"
 #include "plugins/SolarisOutputPlugin.hxx"
+#include "plugins/WasapiOutputPlugin.hxx"
 #include "plugins/WinmmOutputPlugin.hxx"
 
 #include <string.h>
@@ -47,6 +50,9 @@ const AudioOutputPlugin *const audio_output_plugins[] = {
 #endif
 	&null_output_plugin,
 #ifdef ANDROID
+	/* probed before "sles": on API 26+ the AAudio library is
+	   available and preferred, older devices fall back */
+	&aaudio_output_plugin,
 	&sles_output_plugin,
 #endif
 #ifdef HAVE_FIFO
@@ -61,6 +67,9 @@ const AudioOutputPlugin *const audio_output_plugins[] = {
 #ifdef ENABLE_PIPE_OUTPUT
 	&pipe_output_plugin,
 #endif
+#ifdef ENABLE_SHM_OUTPUT
+	&shm_output_plugin,
+#endif
 #ifdef ENABLE_ALSA
 	&alsa_output_plugin,
 #endif
@@ -91,6 +100,9 @@ const AudioOutputPlugin *const audio_output_plugins[] = {
 #ifdef ENABLE_RECORDER_OUTPUT
 	&recorder_output_plugin,
 #endif
+#ifdef ENABLE_WASAPI_OUTPUT
+	&wasapi_output_plugin,
+#endif
 #ifdef ENABLE_WINMM_OUTPUT
 	&winmm_output_plugin,
 #endif
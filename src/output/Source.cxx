@@ -19,12 +19,15 @@
 
 #include "Source.hxx"
 #include "MusicChunk.hxx"
+#include "Probes.hxx"
 #include "filter/Filter.hxx"
 #include "filter/Prepared.hxx"
 #include "filter/plugins/ReplayGainFilterPlugin.hxx"
 #include "pcm/PcmMix.hxx"
+#include "pcm/Silence.hxx"
 #include "thread/Mutex.hxx"
 #include "util/ConstBuffer.hxx"
+#include "util/WritableBuffer.hxx"
 #include "util/RuntimeError.hxx"
 
 #include <string.h>
@@ -155,9 +158,93 @@ AudioOutputSource::GetChunkData(const MusicChunk &chunk,
 	return data;
 }
 
+uint64_t
+AudioOutputSource::CalculateShareSignature(const MusicChunk &chunk) const noexcept
+{
+	/* mix all parameters which determine the filter chain's
+	   output for a chunk; outputs whose values all match produce
+	   bit-identical PCM data */
+	const auto out_audio_format = filter->GetOutAudioFormat();
+
+	uint64_t h = in_audio_format.sample_rate;
+	h = h * 31 + unsigned(in_audio_format.format);
+	h = h * 31 + in_audio_format.channels;
+	h = h * 31 + out_audio_format.sample_rate;
+	h = h * 31 + unsigned(out_audio_format.format);
+	h = h * 31 + out_audio_format.channels;
+	h = h * 31 + (replay_gain_filter != nullptr);
+	h = h * 31 + unsigned(replay_gain_mode);
+	h = h * 31 + chunk.replay_gain_serial;
+
+	/* reserve the value 0 for "cache empty" */
+	return h | (uint64_t(1) << 63);
+}
+
 ConstBuffer<void>
 AudioOutputSource::FilterChunk(const MusicChunk &chunk)
 {
+	if (!shareable_filter || chunk.other != nullptr || chunk.silence)
+		/* cross-fading involves per-output filter state, and
+		   silent chunks take a cheap shortcut anyway */
+		return FilterChunk2(chunk);
+
+	const uint64_t signature = CalculateShareSignature(chunk);
+
+	{
+		const std::lock_guard<Mutex> protect(chunk.filtered_mutex);
+		if (chunk.filtered_signature == signature)
+			/* another output with an equivalent filter
+			   chain has already done the work; the cache
+			   is never replaced, so the pointer stays
+			   valid after unlocking */
+			return { chunk.filtered_data.data(),
+				chunk.filtered_data.size() };
+	}
+
+	const auto result = FilterChunk2(chunk);
+
+	const std::lock_guard<Mutex> protect(chunk.filtered_mutex);
+	if (chunk.filtered_signature == 0) {
+		const auto *begin = (const uint8_t *)result.data;
+		chunk.filtered_data.assign(begin, begin + result.size);
+		chunk.filtered_signature = signature;
+	}
+
+	return result;
+}
+
+ConstBuffer<void>
+AudioOutputSource::FilterChunk2(const MusicChunk &chunk)
+{
+	if (chunk.silence && chunk.length > 0 && chunk.other == nullptr) {
+		/* the chunk contains only silence: instead of running
+		   the filter chain (ReplayGain, software volume, ...
+		   all of which map silence to silence), emit the
+		   equivalent amount of silence in the filter's output
+		   format; not possible while resampling, because then
+		   the frame count would change */
+		const auto out_audio_format = filter->GetOutAudioFormat();
+		if (out_audio_format.sample_rate ==
+		    in_audio_format.sample_rate) {
+			const size_t out_size = (chunk.length / in_audio_format.GetFrameSize())
+				* out_audio_format.GetFrameSize();
+			WritableBuffer<void> dest(silence_buffer.Get(out_size),
+						  out_size);
+
+			if (out_audio_format.format != silence_format ||
+			    out_size > silence_size) {
+				/* (re)generate the pattern; Get() may
+				   have discarded the old contents
+				   while growing the buffer */
+				PcmSilence(dest, out_audio_format.format);
+				silence_format = out_audio_format.format;
+				silence_size = out_size;
+			}
+
+			return dest;
+		}
+	}
+
 	auto data = GetChunkData(chunk, replay_gain_filter.get(),
 				 &replay_gain_serial);
 	if (data.empty())
@@ -197,12 +284,23 @@ AudioOutputSource::FilterChunk(const MusicChunk &chunk)
 			throw FormatRuntimeError("Cannot cross-fade format %s",
 						 sample_format_to_string(in_audio_format.format));
 
-		data.data = dest;
-		data.size = other_data.size;
+		/* the mix buffer is owned by this object, and nobody
+		   else reads it: the filter chain may modify it in
+		   place */
+		return filter->FilterInPlace({dest, other_data.size});
 	}
 
 	/* apply filter chain */
 
+	if (data.data != chunk.data)
+		/* the replay gain filter has written the scaled
+		   samples into its own buffer, which nobody else
+		   reads: the filter chain may modify it in place,
+		   fusing replay gain and filtering into one pass over
+		   the data */
+		return filter->FilterInPlace({const_cast<void *>(data.data),
+					      data.size});
+
 	return filter->FilterPCM(data);
 }
 
@@ -220,6 +318,9 @@ AudioOutputSource::Fill(Mutex &mutex)
 	if (current_chunk == nullptr)
 		return false;
 
+	MPD_PROBE2(music_chunk_fill, current_chunk,
+		   current_chunk->time.ToMS());
+
 	pending_tag = current_chunk->tag.get();
 
 	try {
@@ -241,8 +342,12 @@ AudioOutputSource::ConsumeData(size_t nbytes) noexcept
 {
 	pending_data.skip_front(nbytes);
 
-	if (pending_data.empty())
+	if (pending_data.empty()) {
+		MPD_PROBE2(music_chunk_play, current_chunk,
+			   current_chunk->time.ToMS());
+
 		pipe.Consume(*std::exchange(current_chunk, nullptr));
+	}
 }
 
 ConstBuffer<void>
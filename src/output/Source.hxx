@@ -95,6 +95,24 @@ class AudioOutputSource {
 	 */
 	PcmDither cross_fade_dither;
 
+	/**
+	 * The buffer used to generate silence in the filter's output
+	 * format for chunks flagged as silent, bypassing the filter
+	 * chain (see FilterChunk()).
+	 */
+	PcmBuffer silence_buffer;
+
+	/**
+	 * The number of bytes at the start of #silence_buffer which
+	 * already hold the silence pattern of #silence_format.  The
+	 * pattern is immutable once written, so long silent passages
+	 * reuse it instead of rewriting zeros for every chunk.
+	 */
+	size_t silence_size = 0;
+
+	/** the sample format of the pattern in #silence_buffer */
+	SampleFormat silence_format = SampleFormat::UNDEFINED;
+
 	/**
 	 * The filter object of this audio output.  This is an
 	 * instance of chain_filter_plugin.
@@ -118,6 +136,15 @@ class AudioOutputSource {
 	 */
 	ConstBuffer<uint8_t> pending_data;
 
+	/**
+	 * Is this output allowed to share filtered chunk data with
+	 * other outputs?  Only set if the filter chain is a pure
+	 * per-chunk function of the audio formats and replay gain
+	 * parameters (i.e. no configured filters, no software mixer);
+	 * see FilterChunk().
+	 */
+	bool shareable_filter = false;
+
 public:
 	AudioOutputSource() noexcept;
 	~AudioOutputSource() noexcept;
@@ -126,6 +153,10 @@ public:
 		replay_gain_mode = _mode;
 	}
 
+	void SetShareable(bool _shareable) noexcept {
+		shareable_filter = _shareable;
+	}
+
 	bool IsOpen() const {
 		return in_audio_format.IsDefined();
 	}
@@ -211,7 +242,21 @@ private:
 				       Filter *replay_gain_filter,
 				       unsigned *replay_gain_serial_p);
 
+	/**
+	 * Calculate the signature under which this output's filtered
+	 * result for the given chunk may be shared with other
+	 * outputs; never returns 0.
+	 */
+	gcc_pure
+	uint64_t CalculateShareSignature(const MusicChunk &chunk) const noexcept;
+
 	ConstBuffer<void> FilterChunk(const MusicChunk &chunk);
+
+	/**
+	 * Run the filter chain on the given chunk (the non-shared
+	 * part of FilterChunk()).
+	 */
+	ConstBuffer<void> FilterChunk2(const MusicChunk &chunk);
 };
 
 #endif
@@ -28,6 +28,7 @@
 #include "util/StringBuffer.hxx"
 #include "util/ScopeExit.hxx"
 #include "util/RuntimeError.hxx"
+#include "Metrics.hxx"
 #include "Log.hxx"
 
 #include <assert.h>
@@ -139,6 +140,8 @@ AudioOutputControl::InternalOpen(const AudioFormat in_audio_format,
 
 	AudioFormat f;
 
+	source.SetShareable(output->can_share_filter);
+
 	try {
 		try {
 			f = source.Open(in_audio_format, pipe,
@@ -263,7 +266,9 @@ AudioOutputControl::PlayChunk() noexcept
 
 		try {
 			const ScopeUnlock unlock(mutex);
+			const auto start = std::chrono::steady_clock::now();
 			nbytes = output->Play(data.data, data.size);
+			global_metrics.output_play_latency.Measure(std::chrono::steady_clock::now() - start);
 			assert(nbytes > 0);
 			assert(nbytes <= data.size);
 		} catch (...) {
@@ -410,6 +415,15 @@ AudioOutputControl::Task() noexcept
 			 "OutputThread could not get realtime scheduling, continuing anyway");
 	}
 
+	if (thread_affinity != 0) {
+		try {
+			SetThreadAffinity(thread_affinity);
+		} catch (...) {
+			LogError(std::current_exception(),
+				 "OutputThread could not set CPU affinity, continuing anyway");
+		}
+	}
+
 	SetThreadTimerSlackUS(100);
 
 	const std::lock_guard<Mutex> lock(mutex);
@@ -24,6 +24,8 @@
 
 #include <assert.h>
 
+constexpr Timer::Time Timer::MAX_BURST;
+
 Timer::Timer(const AudioFormat af)
 	:rate(af.sample_rate * af.GetFrameSize())
 {
@@ -56,7 +58,10 @@ Timer::GetDelay() const
 	assert(started);
 
 	const auto delay = time - Now();
-	if (delay < Time::zero())
+	if (delay < MAX_BURST)
+		/* not far enough ahead of real time yet: play more
+		   chunks right away instead of sleeping after each
+		   one */
 		return Time::zero();
 
 	return std::chrono::duration_cast<std::chrono::steady_clock::duration>(delay);
@@ -27,6 +27,14 @@ struct AudioFormat;
 class Timer {
 	typedef std::chrono::microseconds Time;
 
+	/**
+	 * How far the caller may run ahead of real time before
+	 * GetDelay() asks it to sleep.  Writing in bursts of this
+	 * duration limits the output thread to roughly ten wakeups
+	 * per second, instead of one wakeup per chunk.
+	 */
+	static constexpr Time MAX_BURST = std::chrono::milliseconds(100);
+
 	Time time;
 	bool started = false;
 	const int rate;
@@ -41,7 +49,10 @@ public:
 	void Add(size_t size);
 
 	/**
-	 * Returns the duration to sleep to get back to sync.
+	 * Returns the duration to sleep to get back to sync.  Zero
+	 * is returned until the caller has run ahead of real time by
+	 * #MAX_BURST, so consecutive chunks are played in one burst,
+	 * followed by one long sleep which drains the burst.
 	 */
 	std::chrono::steady_clock::duration GetDelay() const;
 
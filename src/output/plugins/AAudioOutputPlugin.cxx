@@ -0,0 +1,343 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * AAudio output for Android O (API 26) and newer.  AAudio grants the
+ * MMAP low-latency path when available, writing samples directly into
+ * the HAL's shared buffer without the triple-buffer copy of the
+ * OpenSL/ES plugin.  libaaudio is loaded with dlopen(), so the same
+ * binary still runs on older devices, which keep using the "sles"
+ * plugin (this plugin is probed first, see output/Registry.cxx).
+ */
+
+#include "AAudioOutputPlugin.hxx"
+#include "../OutputAPI.hxx"
+#include "util/Domain.hxx"
+#include "util/RuntimeError.hxx"
+#include "Log.hxx"
+
+#include <stdexcept>
+
+#include <dlfcn.h>
+#include <stdint.h>
+
+static constexpr Domain aaudio_domain("aaudio");
+
+/* minimal subset of <aaudio/AAudio.h>, so the plugin builds with NDK
+   headers older than API 26 */
+
+struct AAudioStreamBuilder;
+struct AAudioStream;
+
+typedef int32_t aaudio_result_t;
+
+static constexpr aaudio_result_t AAUDIO_OK = 0;
+
+static constexpr int32_t AAUDIO_FORMAT_PCM_I16 = 1;
+static constexpr int32_t AAUDIO_FORMAT_PCM_FLOAT = 2;
+
+static constexpr int32_t AAUDIO_SHARING_MODE_EXCLUSIVE = 0;
+static constexpr int32_t AAUDIO_SHARING_MODE_SHARED = 1;
+
+static constexpr int32_t AAUDIO_PERFORMANCE_MODE_LOW_LATENCY = 12;
+
+/**
+ * Function pointers resolved from libaaudio.so at runtime.
+ */
+static struct {
+	aaudio_result_t (*create_builder)(AAudioStreamBuilder **);
+	aaudio_result_t (*delete_builder)(AAudioStreamBuilder *);
+	void (*set_sample_rate)(AAudioStreamBuilder *, int32_t);
+	void (*set_channel_count)(AAudioStreamBuilder *, int32_t);
+	void (*set_format)(AAudioStreamBuilder *, int32_t);
+	void (*set_sharing_mode)(AAudioStreamBuilder *, int32_t);
+	void (*set_performance_mode)(AAudioStreamBuilder *, int32_t);
+	aaudio_result_t (*open_stream)(AAudioStreamBuilder *,
+				       AAudioStream **);
+
+	aaudio_result_t (*close)(AAudioStream *);
+	aaudio_result_t (*request_start)(AAudioStream *);
+	aaudio_result_t (*request_pause)(AAudioStream *);
+	aaudio_result_t (*request_flush)(AAudioStream *);
+	aaudio_result_t (*request_stop)(AAudioStream *);
+	aaudio_result_t (*write)(AAudioStream *, const void *,
+				 int32_t, int64_t);
+	int32_t (*get_sample_rate)(AAudioStream *);
+	int32_t (*get_channel_count)(AAudioStream *);
+	int32_t (*get_frames_per_burst)(AAudioStream *);
+	aaudio_result_t (*set_buffer_size)(AAudioStream *, int32_t);
+	int32_t (*get_buffer_size)(AAudioStream *);
+	int32_t (*get_performance_mode)(AAudioStream *);
+	const char *(*result_to_text)(aaudio_result_t);
+} aaudio;
+
+static void *aaudio_so;
+
+template<typename F>
+static bool
+AAudioSymbol(F &f, const char *name) noexcept
+{
+	f = (F)dlsym(aaudio_so, name);
+	return f != nullptr;
+}
+
+/**
+ * Load libaaudio.so and resolve all entry points.  Returns false on
+ * devices older than API 26, where the library does not exist.
+ */
+static bool
+LoadAAudio() noexcept
+{
+	if (aaudio_so != nullptr)
+		return true;
+
+	aaudio_so = dlopen("libaaudio.so", RTLD_NOW);
+	if (aaudio_so == nullptr)
+		return false;
+
+	if (AAudioSymbol(aaudio.create_builder, "AAudio_createStreamBuilder") &&
+	    AAudioSymbol(aaudio.delete_builder, "AAudioStreamBuilder_delete") &&
+	    AAudioSymbol(aaudio.set_sample_rate, "AAudioStreamBuilder_setSampleRate") &&
+	    AAudioSymbol(aaudio.set_channel_count, "AAudioStreamBuilder_setChannelCount") &&
+	    AAudioSymbol(aaudio.set_format, "AAudioStreamBuilder_setFormat") &&
+	    AAudioSymbol(aaudio.set_sharing_mode, "AAudioStreamBuilder_setSharingMode") &&
+	    AAudioSymbol(aaudio.set_performance_mode, "AAudioStreamBuilder_setPerformanceMode") &&
+	    AAudioSymbol(aaudio.open_stream, "AAudioStreamBuilder_openStream") &&
+	    AAudioSymbol(aaudio.close, "AAudioStream_close") &&
+	    AAudioSymbol(aaudio.request_start, "AAudioStream_requestStart") &&
+	    AAudioSymbol(aaudio.request_pause, "AAudioStream_requestPause") &&
+	    AAudioSymbol(aaudio.request_flush, "AAudioStream_requestFlush") &&
+	    AAudioSymbol(aaudio.request_stop, "AAudioStream_requestStop") &&
+	    AAudioSymbol(aaudio.write, "AAudioStream_write") &&
+	    AAudioSymbol(aaudio.get_sample_rate, "AAudioStream_getSampleRate") &&
+	    AAudioSymbol(aaudio.get_channel_count, "AAudioStream_getChannelCount") &&
+	    AAudioSymbol(aaudio.get_frames_per_burst, "AAudioStream_getFramesPerBurst") &&
+	    AAudioSymbol(aaudio.set_buffer_size, "AAudioStream_setBufferSizeInFrames") &&
+	    AAudioSymbol(aaudio.get_buffer_size, "AAudioStream_getBufferSizeInFrames") &&
+	    AAudioSymbol(aaudio.get_performance_mode, "AAudioStream_getPerformanceMode") &&
+	    AAudioSymbol(aaudio.result_to_text, "AAudio_convertResultToText"))
+		return true;
+
+	dlclose(aaudio_so);
+	aaudio_so = nullptr;
+	return false;
+}
+
+static std::runtime_error
+MakeAAudioError(aaudio_result_t result, const char *prefix)
+{
+	return FormatRuntimeError("%s: %s", prefix,
+				  aaudio.result_to_text(result));
+}
+
+class AAudioOutput final : AudioOutput {
+	AAudioStream *stream = nullptr;
+
+	size_t frame_size;
+
+	bool started, paused;
+
+public:
+	explicit AAudioOutput(const ConfigBlock &)
+		:AudioOutput(FLAG_PAUSE) {}
+
+	static AudioOutput *Create(EventLoop &, const ConfigBlock &block) {
+		if (!LoadAAudio())
+			throw std::runtime_error("libaaudio.so is not available");
+
+		return new AAudioOutput(block);
+	}
+
+private:
+	void Open(AudioFormat &audio_format) override;
+	void Close() noexcept override;
+
+	std::chrono::steady_clock::duration Delay() const noexcept override;
+	size_t Play(const void *chunk, size_t size) override;
+	void Drain() override;
+	void Cancel() noexcept override;
+	bool Pause() override;
+
+	void Start();
+};
+
+void
+AAudioOutput::Open(AudioFormat &audio_format)
+{
+	int32_t format;
+	switch (audio_format.format) {
+	case SampleFormat::S16:
+		format = AAUDIO_FORMAT_PCM_I16;
+		break;
+
+	case SampleFormat::FLOAT:
+		format = AAUDIO_FORMAT_PCM_FLOAT;
+		break;
+
+	default:
+		/* AAudio knows only 16 bit PCM and float */
+		audio_format.format = SampleFormat::FLOAT;
+		format = AAUDIO_FORMAT_PCM_FLOAT;
+		break;
+	}
+
+	AAudioStreamBuilder *builder;
+	aaudio_result_t result = aaudio.create_builder(&builder);
+	if (result != AAUDIO_OK)
+		throw MakeAAudioError(result,
+				      "AAudio_createStreamBuilder() failed");
+
+	aaudio.set_sample_rate(builder, audio_format.sample_rate);
+	aaudio.set_channel_count(builder, audio_format.channels);
+	aaudio.set_format(builder, format);
+	aaudio.set_performance_mode(builder,
+				    AAUDIO_PERFORMANCE_MODE_LOW_LATENCY);
+
+	/* ask for the MMAP exclusive path first; AAudio falls back to
+	   shared MMAP or the legacy path by itself, but some vendor
+	   HALs reject the request outright, so retry explicitly */
+	aaudio.set_sharing_mode(builder, AAUDIO_SHARING_MODE_EXCLUSIVE);
+	result = aaudio.open_stream(builder, &stream);
+	if (result != AAUDIO_OK) {
+		aaudio.set_sharing_mode(builder, AAUDIO_SHARING_MODE_SHARED);
+		result = aaudio.open_stream(builder, &stream);
+	}
+
+	aaudio.delete_builder(builder);
+
+	if (result != AAUDIO_OK)
+		throw MakeAAudioError(result, "Failed to open AAudio stream");
+
+	/* the granted stream parameters may differ from the request;
+	   let MPD's converter deal with it */
+	audio_format.sample_rate = aaudio.get_sample_rate(stream);
+	audio_format.channels = aaudio.get_channel_count(stream);
+
+	frame_size = audio_format.GetFrameSize();
+
+	/* double the burst size is the sweet spot between underruns
+	   and latency */
+	aaudio.set_buffer_size(stream,
+			       2 * aaudio.get_frames_per_burst(stream));
+
+	if (aaudio.get_performance_mode(stream) !=
+	    AAUDIO_PERFORMANCE_MODE_LOW_LATENCY)
+		LogWarning(aaudio_domain,
+			   "low-latency mode not granted, "
+			   "falling back to the legacy path");
+
+	started = false;
+	paused = false;
+}
+
+void
+AAudioOutput::Close() noexcept
+{
+	aaudio.request_stop(stream);
+	aaudio.close(stream);
+	stream = nullptr;
+}
+
+void
+AAudioOutput::Start()
+{
+	if (started)
+		return;
+
+	aaudio_result_t result = aaudio.request_start(stream);
+	if (result != AAUDIO_OK)
+		throw MakeAAudioError(result,
+				      "AAudioStream_requestStart() failed");
+
+	started = true;
+	paused = false;
+}
+
+std::chrono::steady_clock::duration
+AAudioOutput::Delay() const noexcept
+{
+	/* AAudioStream_write() blocks when the buffer is full; only
+	   back off while paused so the pause loop does not spin */
+	return paused
+		? std::chrono::milliseconds(50)
+		: std::chrono::steady_clock::duration::zero();
+}
+
+size_t
+AAudioOutput::Play(const void *chunk, size_t size)
+{
+	Start();
+
+	constexpr int64_t timeout_nanos = int64_t(1000000000);
+
+	const aaudio_result_t result =
+		aaudio.write(stream, chunk, size / frame_size,
+			     timeout_nanos);
+	if (result < 0)
+		throw MakeAAudioError(result, "AAudioStream_write() failed");
+
+	return size_t(result) * frame_size;
+}
+
+void
+AAudioOutput::Drain()
+{
+	if (!started)
+		return;
+
+	/* requestStop() plays all queued data before stopping; the
+	   stream is restarted lazily by the next Play() */
+	aaudio.request_stop(stream);
+	started = false;
+}
+
+void
+AAudioOutput::Cancel() noexcept
+{
+	/* flushing is only allowed while paused */
+	aaudio.request_pause(stream);
+	aaudio.request_flush(stream);
+	started = false;
+	paused = false;
+}
+
+bool
+AAudioOutput::Pause()
+{
+	if (started) {
+		aaudio.request_pause(stream);
+		started = false;
+	}
+
+	paused = true;
+	return true;
+}
+
+static bool
+aaudio_output_test_default_device()
+{
+	return LoadAAudio();
+}
+
+const struct AudioOutputPlugin aaudio_output_plugin = {
+	"aaudio",
+	aaudio_output_test_default_device,
+	AAudioOutput::Create,
+	nullptr,
+};
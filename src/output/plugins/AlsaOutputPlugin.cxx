@@ -79,6 +79,19 @@ class AlsaOutput final
 	/** libasound's period_time setting (in microseconds) */
 	const unsigned period_time;
 
+	/**
+	 * Attempt to use SND_PCM_ACCESS_MMAP_INTERLEAVED?  Configured
+	 * with "mmap yes".
+	 */
+	const bool mmap_setting;
+
+	/**
+	 * Is the PCM device currently opened in mmap mode?  If so,
+	 * WriteFromPeriodBuffer() writes directly into the DMA area
+	 * with snd_pcm_mmap_writei().
+	 */
+	bool use_mmap;
+
 	/** the mode flags passed to snd_pcm_open */
 	int mode = 0;
 
@@ -313,8 +326,13 @@ private:
 	snd_pcm_sframes_t WriteFromPeriodBuffer() noexcept {
 		assert(!period_buffer.IsEmpty());
 
-		auto frames_written = snd_pcm_writei(pcm, period_buffer.GetHead(),
-						     period_buffer.GetFrames(out_frame_size));
+		const auto n_frames =
+			period_buffer.GetFrames(out_frame_size);
+		auto frames_written = use_mmap
+			? snd_pcm_mmap_writei(pcm, period_buffer.GetHead(),
+					      n_frames)
+			: snd_pcm_writei(pcm, period_buffer.GetHead(),
+					 n_frames);
 		if (frames_written > 0) {
 			written = true;
 			period_buffer.ConsumeFrames(frames_written,
@@ -352,7 +370,8 @@ AlsaOutput::AlsaOutput(EventLoop &_loop, const ConfigBlock &block)
 #endif
 	 buffer_time(block.GetPositiveValue("buffer_time",
 					    MPD_ALSA_BUFFER_TIME_US)),
-	 period_time(block.GetPositiveValue("period_time", 0u))
+	 period_time(block.GetPositiveValue("period_time", 0u)),
+	 mmap_setting(block.GetBlockValue("mmap", false))
 {
 #ifdef SND_PCM_NO_AUTO_RESAMPLE
 	if (!block.GetBlockValue("auto_resample", true))
@@ -475,10 +494,14 @@ inline void
 AlsaOutput::Setup(AudioFormat &audio_format,
 		  PcmExport::Params &params)
 {
-	const auto hw_result = Alsa::SetupHw(pcm,
+	const auto hw_result = Alsa::SetupHw(pcm, mmap_setting,
 					     buffer_time, period_time,
 					     audio_format, params);
 
+	use_mmap = hw_result.access == SND_PCM_ACCESS_MMAP_INTERLEAVED;
+	if (use_mmap)
+		LogDebug(alsa_output_domain, "using mmap access");
+
 	FormatDebug(alsa_output_domain, "format=%s (%s)",
 		    snd_pcm_format_name(hw_result.format),
 		    snd_pcm_format_description(hw_result.format));
@@ -34,6 +34,10 @@
 #include <jack/types.h>
 #include <jack/ringbuffer.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include <unistd.h> /* for usleep() */
 #include <stdlib.h>
 
@@ -210,7 +214,8 @@ JackOutput::JackOutput(const ConfigBlock &block)
 			      num_source_ports, num_destination_ports,
 			      block.line);
 
-	ringbuffer_size = block.GetPositiveValue("ringbuffer_size", 32768u);
+	/* 0 means "calculate from the JACK period size in Start()" */
+	ringbuffer_size = block.GetPositiveValue("ringbuffer_size", 0u);
 }
 
 inline jack_nframes_t
@@ -477,6 +482,13 @@ JackOutput::Start()
 	assert(client != nullptr);
 	assert(audio_format.channels <= num_source_ports);
 
+	size_t size = ringbuffer_size;
+	if (size == 0)
+		/* not configured explicitly: hold four JACK periods
+		   per channel, which gives the process callback
+		   enough slack without adding needless latency */
+		size = 4 * jack_get_buffer_size(client) * jack_sample_size;
+
 	/* allocate the ring buffers on the first open(); these
 	   persist until MPD exits.  It's too unsafe to delete them
 	   because we can never know when mpd_jack_process() gets
@@ -484,7 +496,7 @@ JackOutput::Start()
 	for (unsigned i = 0; i < num_source_ports; ++i) {
 		if (ringbuffer[i] == nullptr)
 			ringbuffer[i] =
-				jack_ringbuffer_create(ringbuffer_size);
+				jack_ringbuffer_create(size);
 
 		/* clear the ring buffer to be sure that data from
 		   previous playbacks are gone */
@@ -623,6 +635,29 @@ JackOutput::WriteSamples(const float *src, size_t n_frames)
 
 	const size_t result = n_frames = std::min(space, n_frames);
 
+#ifdef __SSE2__
+	if (n_channels == 2) {
+		/* deinterleave four stereo frames per iteration,
+		   straight into the ring buffer */
+		while (n_frames >= 4) {
+			const __m128 a = _mm_loadu_ps(src);
+			const __m128 b = _mm_loadu_ps(src + 4);
+
+			_mm_storeu_ps(dest[0],
+				      _mm_shuffle_ps(a, b,
+						     _MM_SHUFFLE(2, 0, 2, 0)));
+			_mm_storeu_ps(dest[1],
+				      _mm_shuffle_ps(a, b,
+						     _MM_SHUFFLE(3, 1, 3, 1)));
+
+			dest[0] += 4;
+			dest[1] += 4;
+			src += 8;
+			n_frames -= 4;
+		}
+	}
+#endif
+
 	while (n_frames-- > 0)
 		for (unsigned i = 0; i < n_channels; ++i)
 			*dest[i]++ = *src++;
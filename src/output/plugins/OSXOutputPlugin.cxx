@@ -38,12 +38,131 @@
 #include <AudioUnit/AudioUnit.h>
 #include <AudioToolbox/AudioToolbox.h>
 #include <CoreServices/CoreServices.h>
-#include <boost/lockfree/spsc_queue.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 
+#include <string.h>
+
 static constexpr unsigned MPD_OSX_BUFFER_TIME_MS = 100;
 
+/**
+ * A lock-free single-producer single-consumer byte ring buffer.
+ * Unlike boost::lockfree::spsc_queue, it exposes the contiguous
+ * readable region (Peek()/Consume()), which allows the render
+ * callback to hand ring storage directly to CoreAudio instead of
+ * copying it into the #AudioBufferList.
+ */
+class OSXRingBuffer {
+	const size_t capacity;
+
+	const std::unique_ptr<uint8_t[]> data;
+
+	/**
+	 * The read/write positions; only the consumer advances
+	 * #head, only the producer advances #tail.  One byte is
+	 * always left unused to distinguish "full" from "empty".
+	 */
+	std::atomic<size_t> head{0}, tail{0};
+
+	static size_t Next(size_t i, size_t n, size_t capacity) noexcept {
+		i += n;
+		return i >= capacity ? i - capacity : i;
+	}
+
+public:
+	explicit OSXRingBuffer(size_t size) noexcept
+		:capacity(size + 1), data(new uint8_t[capacity]) {}
+
+	gcc_pure
+	size_t WriteAvailable() const noexcept {
+		const size_t h = head.load(std::memory_order_acquire);
+		const size_t t = tail.load(std::memory_order_relaxed);
+		return (h > t ? 0 : capacity) + h - t - 1;
+	}
+
+	/**
+	 * Copy data into the ring (producer side).
+	 *
+	 * @return the number of bytes copied (may be less than #n if
+	 * the ring is full)
+	 */
+	size_t Push(const uint8_t *src, size_t n) noexcept {
+		const size_t h = head.load(std::memory_order_acquire);
+		const size_t t = tail.load(std::memory_order_relaxed);
+
+		size_t space = (h > t ? 0 : capacity) + h - t - 1;
+		if (n > space)
+			n = space;
+
+		const size_t contiguous = capacity - t;
+		if (n <= contiguous)
+			memcpy(&data[t], src, n);
+		else {
+			memcpy(&data[t], src, contiguous);
+			memcpy(&data[0], src + contiguous, n - contiguous);
+		}
+
+		tail.store(Next(t, n, capacity), std::memory_order_release);
+		return n;
+	}
+
+	/**
+	 * The contiguous readable region (consumer side).  It
+	 * remains valid until Consume() advances past it.
+	 */
+	gcc_pure
+	ConstBuffer<uint8_t> Peek() const noexcept {
+		const size_t h = head.load(std::memory_order_relaxed);
+		const size_t t = tail.load(std::memory_order_acquire);
+
+		return {&data[h],
+			(t >= h ? t : capacity) - h};
+	}
+
+	/**
+	 * Mark bytes returned by Peek() as consumed (consumer side).
+	 */
+	void Consume(size_t n) noexcept {
+		const size_t h = head.load(std::memory_order_relaxed);
+		head.store(Next(h, n, capacity), std::memory_order_release);
+	}
+
+	/**
+	 * Copy data out of the ring (consumer side).
+	 *
+	 * @return the number of bytes copied
+	 */
+	size_t Pop(uint8_t *dest, size_t n) noexcept {
+		size_t total = 0;
+
+		while (n > 0) {
+			const auto r = Peek();
+			if (r.empty())
+				break;
+
+			const size_t nbytes = std::min(n, r.size);
+			memcpy(dest + total, r.data, nbytes);
+			Consume(nbytes);
+
+			total += nbytes;
+			n -= nbytes;
+		}
+
+		return total;
+	}
+
+	/**
+	 * Discard everything.  May only be called while the consumer
+	 * is suspended.
+	 */
+	void Reset() noexcept {
+		head.store(0, std::memory_order_relaxed);
+		tail.store(0, std::memory_order_relaxed);
+	}
+};
+
 static StringBuffer<64>
 StreamDescriptionToString(const AudioStreamBasicDescription desc) {
 	// Only convert the lpcm formats (nothing else supported / used by MPD)
@@ -79,11 +198,25 @@ struct OSXOutput final : AudioOutput {
 	Manual<PcmExport> pcm_export;
 #endif
 
+	/**
+	 * How much audio to keep in the ring buffer, in
+	 * milliseconds; configurable via "buffer_time".
+	 */
+	unsigned buffer_time_ms;
+
 	AudioDeviceID dev_id;
 	AudioComponentInstance au;
 	AudioStreamBasicDescription asbd;
 
-	boost::lockfree::spsc_queue<uint8_t> *ring_buffer;
+	OSXRingBuffer *ring_buffer;
+
+	/**
+	 * The number of bytes handed to CoreAudio (as a pointer into
+	 * the ring buffer) by the previous render callback; they are
+	 * consumed at the beginning of the next one, when CoreAudio
+	 * is done with them.
+	 */
+	size_t render_consumed;
 
 	OSXOutput(const ConfigBlock &block);
 
@@ -149,6 +282,8 @@ OSXOutput::OSXOutput(const ConfigBlock &block)
 
 	channel_map = block.GetBlockValue("channel_map");
 	hog_device = block.GetBlockValue("hog_device", false);
+	buffer_time_ms = block.GetPositiveValue("buffer_time",
+						MPD_OSX_BUFFER_TIME_MS);
 #ifdef ENABLE_DSD
 	dop_setting = block.GetBlockValue("dop", false);
 #endif
@@ -679,11 +814,29 @@ osx_render(void *vdata,
 	   AudioBufferList *buffer_list)
 {
 	OSXOutput *od = (OSXOutput *) vdata;
+	AudioBuffer &buffer = buffer_list->mBuffers[0];
+
+	/* consume the region CoreAudio finished reading during the
+	   previous callback; deferring this is what makes pointing
+	   mData into the ring safe */
+	od->ring_buffer->Consume(od->render_consumed);
+	od->render_consumed = 0;
+
+	const size_t count = in_number_frames * od->asbd.mBytesPerFrame;
+
+	const auto r = od->ring_buffer->Peek();
+	if (r.size >= count) {
+		/* hand the ring's contiguous region to CoreAudio
+		   without copying */
+		buffer.mData = const_cast<uint8_t *>(r.data);
+		buffer.mDataByteSize = count;
+		od->render_consumed = count;
+	} else
+		/* the readable region wraps around (or is short):
+		   fall back to copying into the provided buffer */
+		buffer.mDataByteSize =
+			od->ring_buffer->Pop((uint8_t *)buffer.mData, count);
 
-	int count = in_number_frames * od->asbd.mBytesPerFrame;
-	buffer_list->mBuffers[0].mDataByteSize =
-		od->ring_buffer->pop((uint8_t *)buffer_list->mBuffers[0].mData,
-				     count);
  	return noErr;
 }
 
@@ -843,16 +996,17 @@ OSXOutput::Open(AudioFormat &audio_format)
 	}
 
 	size_t ring_buffer_size = std::max<size_t>(buffer_frame_size,
-						   MPD_OSX_BUFFER_TIME_MS * audio_format.GetFrameSize() * audio_format.sample_rate / 1000);
+						   (size_t)buffer_time_ms * audio_format.GetFrameSize() * audio_format.sample_rate / 1000);
 
 #ifdef ENABLE_DSD
         if (dop_enabled) {
 		pcm_export->Open(audio_format.format, audio_format.channels, params);
 		ring_buffer_size = std::max<size_t>(buffer_frame_size,
-						   MPD_OSX_BUFFER_TIME_MS * pcm_export->GetFrameSize(audio_format) * asbd.mSampleRate / 1000);
+						   (size_t)buffer_time_ms * pcm_export->GetFrameSize(audio_format) * asbd.mSampleRate / 1000);
 	}
 #endif
-	ring_buffer = new boost::lockfree::spsc_queue<uint8_t>(ring_buffer_size);
+	ring_buffer = new OSXRingBuffer(ring_buffer_size);
+	render_consumed = 0;
 
 	status = AudioOutputUnitStart(au);
 	if (status != 0) {
@@ -888,19 +1042,19 @@ OSXOutput::Play(const void *chunk, size_t size)
 		if (e.size == 0)
 			return size;
 
-		size_t bytes_written = ring_buffer->push((const uint8_t *)e.data, e.size);
+		size_t bytes_written = ring_buffer->Push((const uint8_t *)e.data, e.size);
 		return pcm_export->CalcSourceSize(bytes_written);
 	}
 #endif
-	return ring_buffer->push((const uint8_t *)chunk, size);
+	return ring_buffer->Push((const uint8_t *)chunk, size);
 }
 
 std::chrono::steady_clock::duration
 OSXOutput::Delay() const noexcept
 {
-	return ring_buffer->write_available() && !pause
+	return ring_buffer->WriteAvailable() && !pause
 		? std::chrono::steady_clock::duration::zero()
-		: std::chrono::milliseconds(MPD_OSX_BUFFER_TIME_MS / 4);
+		: std::chrono::milliseconds(buffer_time_ms / 4);
 }
 	
 bool OSXOutput::Pause() {
@@ -915,7 +1069,10 @@ void
 OSXOutput::Cancel() noexcept
 {
 	AudioOutputUnitStop(au);
-	ring_buffer->reset();
+	/* the render callback is not running anymore: it is safe to
+	   reset the ring and forget the region it handed out */
+	render_consumed = 0;
+	ring_buffer->Reset();
 #ifdef ENABLE_DSD
 	pcm_export->Reset();
 #endif
@@ -40,6 +40,7 @@
 #include <assert.h>
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define MPD_PULSE_NAME "Music Player Daemon"
 
@@ -58,6 +59,14 @@ class PulseOutput final : AudioOutput {
 
 	bool pause;
 
+	/**
+	 * Is Play() currently waiting for buffer space?  Only then
+	 * does OnStreamWrite() need to wake up the output thread;
+	 * suppressing all other signals avoids one mainloop lock
+	 * round trip per request callback.
+	 */
+	bool want_write;
+
 	explicit PulseOutput(const ConfigBlock &block);
 
 public:
@@ -562,7 +571,11 @@ PulseOutput::OnStreamWrite(size_t nbytes)
 	assert(mainloop != nullptr);
 
 	writable = nbytes;
-	Signal();
+
+	if (want_write) {
+		want_write = false;
+		Signal();
+	}
 }
 
 static void
@@ -669,6 +682,7 @@ PulseOutput::Open(AudioFormat &audio_format)
 	}
 
 	pause = false;
+	want_write = false;
 }
 
 void
@@ -776,6 +790,7 @@ PulseOutput::Play(const void *chunk, size_t size)
 		if (pa_stream_is_suspended(stream))
 			throw std::runtime_error("suspended");
 
+		want_write = true;
 		pa_threaded_mainloop_wait(mainloop);
 
 		if (pa_stream_get_state(stream) != PA_STREAM_READY)
@@ -788,9 +803,24 @@ PulseOutput::Play(const void *chunk, size_t size)
 		/* don't send more than possible */
 		size = writable;
 
+	/* acquire a buffer from the server's shared memory pool
+	   instead of having pa_stream_write() allocate and copy
+	   one */
+
+	void *buffer;
+	size_t nbytes = size;
+	if (pa_stream_begin_write(stream, &buffer, &nbytes) < 0 ||
+	    buffer == nullptr)
+		throw MakePulseError(context,
+				     "pa_stream_begin_write() failed");
+
+	if (size > nbytes)
+		size = nbytes;
+
+	memcpy(buffer, chunk, size);
 	writable -= size;
 
-	int result = pa_stream_write(stream, chunk, size, nullptr,
+	int result = pa_stream_write(stream, buffer, size, nullptr,
 				     0, PA_SEEK_RELATIVE);
 	if (result < 0)
 		throw MakePulseError(context, "pa_stream_write() failed");
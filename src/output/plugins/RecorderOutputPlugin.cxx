@@ -28,17 +28,257 @@
 #include "Log.hxx"
 #include "fs/AllocatedPath.hxx"
 #include "fs/io/FileOutputStream.hxx"
+#include "thread/Thread.hxx"
+#include "thread/Mutex.hxx"
+#include "thread/Cond.hxx"
+#include "thread/Name.hxx"
 #include "util/Domain.hxx"
 #include "util/ScopeExit.hxx"
 
 #include <stdexcept>
+#include <list>
 #include <memory>
+#include <vector>
 
 #include <assert.h>
 #include <stdlib.h>
 
 static constexpr Domain recorder_domain("recorder");
 
+/**
+ * A writer thread which performs all file I/O for #RecorderOutput, so
+ * neither plain writes nor the per-song rotation
+ * (close/fsync/rename in FileOutputStream::Commit()) can stall the
+ * output thread.  Encoded data is handed over through a bounded byte
+ * queue; ownership of a #FileOutputStream passes to this thread with
+ * the final COMMIT (or DISPOSE) item.
+ */
+class RecorderWriter {
+	struct Item {
+		enum class Type {
+			/**
+			 * Write #data to #file.
+			 */
+			WRITE,
+
+			/**
+			 * All data for #file has been queued: commit
+			 * and delete it.
+			 */
+			COMMIT,
+
+			/**
+			 * Delete #file without committing (error
+			 * case).
+			 */
+			DISPOSE,
+		} type;
+
+		FileOutputStream *file;
+
+		std::vector<uint8_t> data;
+
+		Item(Type _type, FileOutputStream &_file) noexcept
+			:type(_type), file(&_file) {}
+
+		Item(FileOutputStream &_file,
+		     const void *_data, size_t size) noexcept
+			:type(Type::WRITE), file(&_file),
+			 data((const uint8_t *)_data,
+			      (const uint8_t *)_data + size) {}
+	};
+
+	Mutex mutex;
+
+	/**
+	 * Signalled when an item is appended to the queue and on
+	 * Stop().
+	 */
+	Cond wake_cond;
+
+	/**
+	 * Signalled when queue space becomes available again;
+	 * EnqueueWrite() waits for it.
+	 */
+	Cond space_cond;
+
+	Thread thread{BIND_THIS_METHOD(RunThread)};
+
+	std::list<Item> queue;
+
+	/**
+	 * Sum of all queued WRITE payloads; bounded by
+	 * #MAX_QUEUED_BYTES.
+	 */
+	size_t queued_bytes = 0;
+
+	/**
+	 * An error caught in the writer thread, to be rethrown into
+	 * the output thread by Check().
+	 */
+	std::exception_ptr error;
+
+	bool stop = false;
+
+	/**
+	 * If the queue grows beyond this, the output thread blocks
+	 * until the writer has caught up; this keeps memory usage
+	 * bounded when the destination file system stalls for longer.
+	 */
+	static constexpr size_t MAX_QUEUED_BYTES = 4 * 1024 * 1024;
+
+public:
+	void Start() {
+		thread.Start();
+	}
+
+	/**
+	 * Drain the queue (committing all pending files) and join the
+	 * thread.
+	 */
+	void Stop() noexcept {
+		if (!thread.IsDefined())
+			return;
+
+		{
+			const std::lock_guard<Mutex> lock(mutex);
+			stop = true;
+			wake_cond.signal();
+		}
+
+		thread.Join();
+		stop = false;
+	}
+
+	/**
+	 * Rethrow a pending writer thread error into the caller.
+	 */
+	void Check() {
+		const std::lock_guard<Mutex> lock(mutex);
+		if (error) {
+			auto e = error;
+			error = nullptr;
+			std::rethrow_exception(e);
+		}
+	}
+
+	/**
+	 * Queue encoded data to be written to the given file.  Blocks
+	 * if the queue is full.
+	 */
+	void EnqueueWrite(FileOutputStream &file,
+			  const void *data, size_t size) {
+		const std::lock_guard<Mutex> lock(mutex);
+
+		while (queued_bytes + size > MAX_QUEUED_BYTES && !error)
+			space_cond.wait(mutex);
+
+		if (error) {
+			auto e = error;
+			error = nullptr;
+			std::rethrow_exception(e);
+		}
+
+		queue.emplace_back(file, data, size);
+		queued_bytes += size;
+		wake_cond.signal();
+	}
+
+	/**
+	 * Hand the file over to the writer thread, to be committed
+	 * (or just deleted) after all queued data has been written.
+	 */
+	void EnqueueFinish(FileOutputStream &file, bool commit) {
+		const std::lock_guard<Mutex> lock(mutex);
+
+		queue.emplace_back(commit
+				   ? Item::Type::COMMIT
+				   : Item::Type::DISPOSE,
+				   file);
+		wake_cond.signal();
+	}
+
+private:
+	void RunThread() noexcept;
+};
+
+void
+RecorderWriter::RunThread() noexcept
+{
+	SetThreadName("recorder");
+
+	const std::lock_guard<Mutex> lock(mutex);
+
+	while (true) {
+		if (queue.empty()) {
+			if (stop)
+				break;
+
+			wake_cond.wait(mutex);
+			continue;
+		}
+
+		Item item = std::move(queue.front());
+		queue.pop_front();
+
+		if (!item.data.empty()) {
+			queued_bytes -= item.data.size();
+			space_cond.broadcast();
+		}
+
+		std::exception_ptr e;
+
+		{
+			const ScopeUnlock unlock(mutex);
+
+			try {
+				switch (item.type) {
+				case Item::Type::WRITE:
+					item.file->Write(item.data.data(),
+							 item.data.size());
+					break;
+
+				case Item::Type::COMMIT:
+					item.file->Commit();
+					break;
+
+				case Item::Type::DISPOSE:
+					break;
+				}
+			} catch (...) {
+				e = std::current_exception();
+			}
+
+			if (item.type != Item::Type::WRITE)
+				delete item.file;
+		}
+
+		if (e && !error)
+			/* keep only the first error; it will be
+			   rethrown into the output thread */
+			error = e;
+	}
+}
+
+/**
+ * An #OutputStream adapter which forwards everything to
+ * RecorderWriter::EnqueueWrite().
+ */
+class RecorderWriterStream final : public OutputStream {
+	RecorderWriter &writer;
+	FileOutputStream &file;
+
+public:
+	RecorderWriterStream(RecorderWriter &_writer,
+			     FileOutputStream &_file) noexcept
+		:writer(_writer), file(_file) {}
+
+	/* virtual methods from class OutputStream */
+	void Write(const void *data, size_t size) override {
+		writer.EnqueueWrite(file, data, size);
+	}
+};
+
 class RecorderOutput final : AudioOutput {
 	/**
 	 * The configured encoder plugin.
@@ -64,10 +304,17 @@ class RecorderOutput final : AudioOutput {
 	AudioFormat effective_audio_format;
 
 	/**
-	 * The destination file.
+	 * The destination file.  Owned by this object until it is
+	 * handed over to the #RecorderWriter by Commit().
 	 */
 	FileOutputStream *file;
 
+	/**
+	 * The thread which performs all file I/O, including the
+	 * commit (fsync/rename) of finished files.
+	 */
+	RecorderWriter writer;
+
 	RecorderOutput(const ConfigBlock &block);
 
 public:
@@ -129,18 +376,31 @@ RecorderOutput::EncoderToFile()
 {
 	assert(file != nullptr);
 
-	EncoderToOutputStream(*file, *encoder);
+	/* rethrow any error the writer thread has caught meanwhile */
+	writer.Check();
+
+	RecorderWriterStream stream(writer, *file);
+	EncoderToOutputStream(stream, *encoder);
 }
 
 void
 RecorderOutput::Open(AudioFormat &audio_format)
 {
+	/* start the writer thread which performs all file I/O */
+
+	writer.Start();
+
 	/* create the output file */
 
 	if (!HasDynamicPath()) {
 		assert(!path.IsNull());
 
-		file = new FileOutputStream(path);
+		try {
+			file = new FileOutputStream(path);
+		} catch (...) {
+			writer.Stop();
+			throw;
+		}
 	} else {
 		/* don't open the file just yet; wait until we have
 		   a tag that we can use to build the path */
@@ -155,6 +415,7 @@ RecorderOutput::Open(AudioFormat &audio_format)
 		encoder = prepared_encoder->Open(audio_format);
 	} catch (...) {
 		delete file;
+		writer.Stop();
 		throw;
 	}
 
@@ -163,6 +424,8 @@ RecorderOutput::Open(AudioFormat &audio_format)
 			EncoderToFile();
 		} catch (...) {
 			delete encoder;
+			writer.EnqueueFinish(*file, false);
+			writer.Stop();
 			throw;
 		}
 	} else {
@@ -180,28 +443,25 @@ RecorderOutput::Commit()
 {
 	assert(!path.IsNull());
 
-	/* flush the encoder and write the rest to the file */
+	/* flush the encoder and queue the rest for the writer
+	   thread */
 
 	try {
 		encoder->End();
 		EncoderToFile();
 	} catch (...) {
 		delete encoder;
+		writer.EnqueueFinish(*file, false);
 		throw;
 	}
 
-	/* now really close everything */
-
 	delete encoder;
 
-	try {
-		file->Commit();
-	} catch (...) {
-		delete file;
-		throw;
-	}
+	/* the writer thread will commit and delete the file after
+	   writing all queued data; this keeps the (potentially slow)
+	   fsync/rename out of the output thread */
 
-	delete file;
+	writer.EnqueueFinish(*file, true);
 }
 
 void
@@ -212,6 +472,7 @@ RecorderOutput::Close() noexcept
 		   be done now */
 		assert(HasDynamicPath());
 		assert(path.IsNull());
+		writer.Stop();
 		return;
 	}
 
@@ -221,6 +482,19 @@ RecorderOutput::Close() noexcept
 		LogError(std::current_exception());
 	}
 
+	/* drain the queue, committing all pending files */
+	writer.Stop();
+
+	try {
+		/* report errors the writer thread caught while
+		   draining (e.g. a failed FileOutputStream::Commit()) */
+		writer.Check();
+	} catch (...) {
+		LogError(std::current_exception());
+	}
+
+	file = nullptr;
+
 	if (HasDynamicPath()) {
 		assert(!path.IsNull());
 		path.SetNull();
@@ -268,10 +542,13 @@ RecorderOutput::ReopenFormat(AllocatedPath &&new_path)
 	assert(new_audio_format == effective_audio_format);
 
 	try {
-		EncoderToOutputStream(*new_file, *encoder);
+		RecorderWriterStream stream(writer, *new_file);
+		EncoderToOutputStream(stream, *encoder);
 	} catch (...) {
 		delete encoder;
-		delete new_file;
+		/* the writer may hold queued references to the file;
+		   let it delete the file after those are gone */
+		writer.EnqueueFinish(*new_file, false);
 		throw;
 	}
 
@@ -0,0 +1,225 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "ShmOutputPlugin.hxx"
+#include "../OutputAPI.hxx"
+#include "../Timer.hxx"
+#include "fs/AllocatedPath.hxx"
+#include "fs/FileSystem.hxx"
+#include "util/Domain.hxx"
+#include "util/RuntimeError.hxx"
+#include "system/Error.hxx"
+#include "Log.hxx"
+#include "open.h"
+
+#include <algorithm>
+#include <new>
+
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+class ShmOutput final : AudioOutput {
+	const AllocatedPath path;
+	std::string path_utf8;
+
+	const size_t buffer_size;
+
+	int fd = -1;
+	bool created = false;
+
+	ShmRingHeader *header = nullptr;
+
+	/**
+	 * The PCM ring buffer, following the header in the mapping.
+	 */
+	uint8_t *buffer = nullptr;
+
+	Timer *timer;
+
+public:
+	ShmOutput(const ConfigBlock &block);
+
+	~ShmOutput() {
+		CloseShm();
+	}
+
+	static AudioOutput *Create(EventLoop &,
+				   const ConfigBlock &block) {
+		return new ShmOutput(block);
+	}
+
+private:
+	void OpenShm();
+	void CloseShm();
+
+	void Open(AudioFormat &audio_format) override;
+	void Close() noexcept override;
+
+	std::chrono::steady_clock::duration Delay() const noexcept override;
+	size_t Play(const void *chunk, size_t size) override;
+};
+
+static constexpr Domain shm_output_domain("shm_output");
+
+ShmOutput::ShmOutput(const ConfigBlock &block)
+	:AudioOutput(0),
+	 path(block.GetPath("path")),
+	 buffer_size(block.GetPositiveValue("buffer_size", 262144u))
+{
+	if (path.IsNull())
+		throw std::runtime_error("No \"path\" parameter specified");
+
+	path_utf8 = path.ToUTF8();
+
+	if (buffer_size < 65536)
+		throw std::runtime_error("\"buffer_size\" is too small");
+
+	OpenShm();
+}
+
+inline void
+ShmOutput::OpenShm()
+try {
+	const size_t map_size = sizeof(*header) + buffer_size;
+
+	fd = OpenFile(path, O_CREAT|O_RDWR|O_BINARY, 0666).Steal();
+	if (fd < 0)
+		throw FormatErrno("Could not create shm file \"%s\"",
+				  path_utf8.c_str());
+
+	created = true;
+
+	if (ftruncate(fd, map_size) < 0)
+		throw FormatErrno("Could not resize shm file \"%s\"",
+				  path_utf8.c_str());
+
+	void *p = mmap(nullptr, map_size, PROT_READ|PROT_WRITE,
+		       MAP_SHARED, fd, 0);
+	if (p == MAP_FAILED)
+		throw FormatErrno("Could not map shm file \"%s\"",
+				  path_utf8.c_str());
+
+	header = new(p) ShmRingHeader();
+	buffer = (uint8_t *)p + sizeof(*header);
+
+	header->buffer_size = buffer_size;
+	header->write_position.store(0, std::memory_order_relaxed);
+
+	if (sem_init(&header->sem, 1, 0) < 0)
+		throw MakeErrno("sem_init() failed");
+
+	/* publish the magic last, so consumers never see a
+	   half-initialized header */
+	header->version = ShmRingHeader::VERSION;
+	header->magic = ShmRingHeader::MAGIC;
+} catch (...) {
+	CloseShm();
+	throw;
+}
+
+void
+ShmOutput::CloseShm()
+{
+	if (header != nullptr) {
+		header->magic = 0;
+		sem_destroy(&header->sem);
+		munmap(header, sizeof(*header) + buffer_size);
+		header = nullptr;
+		buffer = nullptr;
+	}
+
+	if (fd >= 0) {
+		close(fd);
+		fd = -1;
+	}
+
+	if (created) {
+		try {
+			RemoveFile(path);
+		} catch (...) {
+			LogError(std::current_exception(),
+				 "Could not remove shm file");
+		}
+
+		created = false;
+	}
+}
+
+void
+ShmOutput::Open(AudioFormat &audio_format)
+{
+	timer = new Timer(audio_format);
+
+	header->sample_rate = audio_format.sample_rate;
+	header->channels = audio_format.channels;
+	header->sample_format = uint8_t(audio_format.format);
+	header->frame_size = audio_format.GetFrameSize();
+}
+
+void
+ShmOutput::Close() noexcept
+{
+	delete timer;
+}
+
+std::chrono::steady_clock::duration
+ShmOutput::Delay() const noexcept
+{
+	return timer->IsStarted()
+		? timer->GetDelay()
+		: std::chrono::steady_clock::duration::zero();
+}
+
+size_t
+ShmOutput::Play(const void *chunk, size_t size)
+{
+	if (!timer->IsStarted())
+		timer->Start();
+	timer->Add(size);
+
+	/* a chunk is always much smaller than the ring, but better
+	   safe than sorry */
+	size = std::min(size, buffer_size);
+
+	const uint64_t wp =
+		header->write_position.load(std::memory_order_relaxed);
+	const size_t offset = wp % buffer_size;
+	const size_t n = std::min(size, buffer_size - offset);
+
+	memcpy(buffer + offset, chunk, n);
+	if (n < size)
+		memcpy(buffer, (const uint8_t *)chunk + n, size - n);
+
+	/* release order: the samples must be visible before the new
+	   position; a consumer which falls behind by more than
+	   buffer_size has lost samples and must resynchronize */
+	header->write_position.store(wp + size, std::memory_order_release);
+
+	sem_post(&header->sem);
+
+	return size;
+}
+
+const struct AudioOutputPlugin shm_output_plugin = {
+	"shm",
+	nullptr,
+	&ShmOutput::Create,
+	nullptr,
+};
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_SHM_OUTPUT_PLUGIN_HXX
+#define MPD_SHM_OUTPUT_PLUGIN_HXX
+
+#ifndef _WIN32
+
+#include <atomic>
+
+#include <semaphore.h>
+#include <stdint.h>
+
+/**
+ * The header of the shared-memory segment created by the "shm"
+ * output plugin.  The PCM ring buffer follows immediately after this
+ * struct; external consumers map the same file (put it on tmpfs for
+ * real shared memory) and read the samples in place, without a pipe
+ * copy.
+ *
+ * #write_position is a free-running byte counter advanced only by
+ * MPD (with release ordering, after the samples are in place);
+ * consumers keep their own cursor and read at cursor%buffer_size.
+ * MPD never blocks on a slow consumer: a consumer whose cursor falls
+ * more than #buffer_size behind #write_position has lost samples and
+ * should resynchronize to the current position.  #sem is posted once
+ * per chunk, so a consumer can sleep in sem_wait() instead of
+ * polling.
+ */
+struct ShmRingHeader {
+	static constexpr uint32_t MAGIC = 0x4d504452; /* "MPDR" */
+	static constexpr uint32_t VERSION = 1;
+
+	uint32_t magic;
+	uint32_t version;
+
+	/**
+	 * The capacity of the PCM ring buffer following this header,
+	 * in bytes.
+	 */
+	uint32_t buffer_size;
+
+	/**
+	 * Attributes of the PCM data; set each time the output is
+	 * opened.  #sample_format is the raw value of MPD's
+	 * #SampleFormat enum.
+	 */
+	uint32_t sample_rate;
+	uint8_t channels;
+	uint8_t sample_format;
+	uint8_t frame_size;
+	uint8_t reserved;
+
+	/**
+	 * Posted by MPD after each chunk; process-shared, so external
+	 * consumers can block on it.
+	 */
+	sem_t sem;
+
+	/**
+	 * On its own cache line so the consumer's polling does not
+	 * bounce the producer's stores.
+	 */
+	alignas(64) std::atomic<uint64_t> write_position;
+};
+
+#endif /* !_WIN32 */
+
+extern const struct AudioOutputPlugin shm_output_plugin;
+
+#endif
@@ -23,6 +23,7 @@
 #include "encoder/Configured.hxx"
 #include "util/RuntimeError.hxx"
 #include "util/Domain.hxx"
+#include "util/DynamicFifoBuffer.hxx"
 #include "util/ScopeExit.hxx"
 #include "util/StringAPI.hxx"
 #include "util/StringFormat.hxx"
@@ -30,8 +31,11 @@
 
 #include <shout/shout.h>
 
+#include <algorithm>
+#include <chrono>
 #include <stdexcept>
 #include <memory>
+#include <thread>
 
 #include <assert.h>
 #include <stdlib.h>
@@ -48,6 +52,32 @@ struct ShoutOutput final : AudioOutput {
 
 	int timeout = DEFAULT_CONN_TIMEOUT;
 
+	/**
+	 * The maximum number of encoded bytes buffered while the
+	 * server does not accept data, configured with "buffer_size".
+	 */
+	size_t max_pending;
+
+	/**
+	 * Encoded data which the server has not accepted yet.  It is
+	 * drained by SendPending() and replayed after a reconnect,
+	 * bounded by #max_pending; when it overflows during a longer
+	 * outage, the oldest data is dropped.
+	 */
+	DynamicFifoBuffer<uint8_t> pending;
+
+	/**
+	 * Is the connection to the server currently established?
+	 */
+	bool connected = false;
+
+	/**
+	 * Do not attempt to reconnect before this time stamp, to
+	 * avoid hammering an unreachable server once per page.
+	 */
+	std::chrono::steady_clock::time_point next_reconnect =
+		std::chrono::steady_clock::time_point::min();
+
 	uint8_t buffer[32768];
 
 	explicit ShoutOutput(const ConfigBlock &block);
@@ -66,6 +96,20 @@ struct ShoutOutput final : AudioOutput {
 	bool Pause() override;
 
 private:
+	/**
+	 * Move all encoded data from the encoder into #pending,
+	 * dropping the oldest data if the buffer would overflow.
+	 */
+	void EnqueueEncoder() noexcept;
+
+	/**
+	 * Send as much of #pending as the server accepts right now,
+	 * reconnecting (rate-limited) if the connection was lost.
+	 */
+	void SendPending() noexcept;
+
+	void TryReconnect() noexcept;
+
 	void WritePage();
 };
 
@@ -97,7 +141,9 @@ ShoutSetAudioInfo(shout_t *shout_conn, const AudioFormat &audio_format)
 ShoutOutput::ShoutOutput(const ConfigBlock &block)
 	:AudioOutput(FLAG_PAUSE|FLAG_NEED_FULLY_DEFINED_AUDIO_FORMAT),
 	 shout_conn(shout_new()),
-	 prepared_encoder(CreateConfiguredEncoder(block, true))
+	 prepared_encoder(CreateConfiguredEncoder(block, true)),
+	 max_pending(block.GetPositiveValue("buffer_size", 512 * 1024u)),
+	 pending(32768)
 {
 	const char *host = require_block_string(block, "host");
 	const char *mount = require_block_string(block, "mount");
@@ -175,7 +221,10 @@ ShoutOutput::ShoutOutput(const ConfigBlock &block)
 #ifdef SHOUT_TLS
 	    shout_set_tls(shout_conn, tls) != SHOUTERR_SUCCESS ||
 #endif
-	    shout_set_agent(shout_conn, "MPD") != SHOUTERR_SUCCESS)
+	    shout_set_agent(shout_conn, "MPD") != SHOUTERR_SUCCESS ||
+	    /* non-blocking mode: shout_send() must never stall the
+	       output thread when the server hiccups */
+	    shout_set_nonblocking(shout_conn, 1) != SHOUTERR_SUCCESS)
 		throw std::runtime_error(shout_get_error(shout_conn));
 
 	/* optional paramters */
@@ -224,47 +273,154 @@ ShoutOutput::Create(EventLoop &, const ConfigBlock &block)
 }
 
 static void
-HandleShoutError(shout_t *shout_conn, int err)
+ShoutOpen(shout_t *shout_conn, int timeout)
 {
-	switch (err) {
+	switch (shout_open(shout_conn)) {
 	case SHOUTERR_SUCCESS:
-		break;
+	case SHOUTERR_CONNECTED:
+		return;
 
-	case SHOUTERR_UNCONNECTED:
-	case SHOUTERR_SOCKET:
-		throw FormatRuntimeError("Lost shout connection to %s:%i: %s",
-					 shout_get_host(shout_conn),
-					 shout_get_port(shout_conn),
-					 shout_get_error(shout_conn));
+	case SHOUTERR_BUSY:
+		/* the non-blocking connect is still in progress */
+		break;
 
 	default:
-		throw FormatRuntimeError("connection to %s:%i error: %s",
+		throw FormatRuntimeError("problem opening connection to shout server %s:%i: %s",
 					 shout_get_host(shout_conn),
 					 shout_get_port(shout_conn),
 					 shout_get_error(shout_conn));
 	}
+
+	/* wait for the handshake to finish, but not longer than the
+	   configured timeout */
+
+	const auto deadline = std::chrono::steady_clock::now() +
+		std::chrono::seconds(timeout);
+
+	while (true) {
+		switch (shout_get_connected(shout_conn)) {
+		case SHOUTERR_SUCCESS:
+		case SHOUTERR_CONNECTED:
+			return;
+
+		case SHOUTERR_BUSY:
+			break;
+
+		default:
+			throw FormatRuntimeError("problem opening connection to shout server %s:%i: %s",
+						 shout_get_host(shout_conn),
+						 shout_get_port(shout_conn),
+						 shout_get_error(shout_conn));
+		}
+
+		if (std::chrono::steady_clock::now() >= deadline) {
+			shout_close(shout_conn);
+			throw FormatRuntimeError("timeout connecting to shout server %s:%i",
+						 shout_get_host(shout_conn),
+						 shout_get_port(shout_conn));
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
 }
 
-static void
-EncoderToShout(shout_t *shout_conn, Encoder &encoder,
-	       unsigned char *buffer, size_t buffer_size)
+void
+ShoutOutput::EnqueueEncoder() noexcept
 {
+	assert(encoder != nullptr);
+
 	while (true) {
-		size_t nbytes = encoder.Read(buffer, buffer_size);
+		size_t nbytes = encoder->Read(buffer, sizeof(buffer));
 		if (nbytes == 0)
 			return;
 
-		int err = shout_send(shout_conn, buffer, nbytes);
-		HandleShoutError(shout_conn, err);
+		size_t in_use = pending.GetAvailable();
+		if (in_use + nbytes > max_pending) {
+			/* the server has not accepted data for a
+			   while; sacrifice the oldest data so the
+			   audio path never blocks */
+			pending.Consume(std::min(in_use,
+						 in_use + nbytes - max_pending));
+			FormatWarning(shout_output_domain,
+				      "buffer full, dropping oldest data for %s:%i",
+				      shout_get_host(shout_conn),
+				      shout_get_port(shout_conn));
+		}
+
+		pending.Append(buffer, nbytes);
 	}
 }
 
 void
-ShoutOutput::WritePage()
+ShoutOutput::TryReconnect() noexcept
 {
-	assert(encoder != nullptr);
+	assert(!connected);
+
+	const auto now = std::chrono::steady_clock::now();
+	if (now < next_reconnect)
+		return;
+
+	try {
+		ShoutOpen(shout_conn, timeout);
+	} catch (...) {
+		next_reconnect = now + std::chrono::seconds(5);
+		LogError(std::current_exception());
+		return;
+	}
+
+	connected = true;
+	FormatDefault(shout_output_domain, "reconnected to %s:%i",
+		      shout_get_host(shout_conn),
+		      shout_get_port(shout_conn));
+}
+
+void
+ShoutOutput::SendPending() noexcept
+{
+	while (!pending.empty()) {
+		if (!connected) {
+			TryReconnect();
+			if (!connected)
+				return;
+		}
+
+		if (shout_queuelen(shout_conn) > 0)
+			/* the kernel socket buffer is full; leave the
+			   rest in #pending instead of growing
+			   libshout's unbounded internal queue */
+			return;
 
-	EncoderToShout(shout_conn, *encoder, buffer, sizeof(buffer));
+		auto r = pending.Read();
+		int err = shout_send(shout_conn, r.data, r.size);
+		switch (err) {
+		case SHOUTERR_SUCCESS:
+			pending.Consume(r.size);
+			break;
+
+		case SHOUTERR_BUSY:
+			/* would block; try again on the next page */
+			return;
+
+		default:
+			/* the connection died; reconnect and replay
+			   the buffered data */
+			FormatWarning(shout_output_domain,
+				      "lost connection to %s:%i: %s",
+				      shout_get_host(shout_conn),
+				      shout_get_port(shout_conn),
+				      shout_get_error(shout_conn));
+			shout_close(shout_conn);
+			connected = false;
+			break;
+		}
+	}
+}
+
+void
+ShoutOutput::WritePage()
+{
+	EnqueueEncoder();
+	SendPending();
 }
 
 void
@@ -279,34 +435,23 @@ ShoutOutput::Close() noexcept
 
 	delete encoder;
 
-	if (shout_get_connected(shout_conn) != SHOUTERR_UNCONNECTED &&
+	pending.Clear();
+
+	if (connected &&
 	    shout_close(shout_conn) != SHOUTERR_SUCCESS) {
 		FormatWarning(shout_output_domain,
 			      "problem closing connection to shout server: %s",
 			      shout_get_error(shout_conn));
 	}
+
+	connected = false;
 }
 
 void
 ShoutOutput::Cancel() noexcept
 {
-	/* needs to be implemented for shout */
-}
-
-static void
-ShoutOpen(shout_t *shout_conn)
-{
-	switch (shout_open(shout_conn)) {
-	case SHOUTERR_SUCCESS:
-	case SHOUTERR_CONNECTED:
-		break;
-
-	default:
-		throw FormatRuntimeError("problem opening connection to shout server %s:%i: %s",
-					 shout_get_host(shout_conn),
-					 shout_get_port(shout_conn),
-					 shout_get_error(shout_conn));
-	}
+	/* discard buffered data which has not been sent yet */
+	pending.Clear();
 }
 
 void
@@ -316,7 +461,9 @@ ShoutOutput::Open(AudioFormat &audio_format)
 
 	try {
 		ShoutSetAudioInfo(shout_conn, audio_format);
-		ShoutOpen(shout_conn);
+		ShoutOpen(shout_conn, timeout);
+		connected = true;
+		next_reconnect = std::chrono::steady_clock::time_point::min();
 		WritePage();
 	} catch (...) {
 		delete encoder;
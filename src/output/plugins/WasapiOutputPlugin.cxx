@@ -0,0 +1,662 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "WasapiOutputPlugin.hxx"
+#include "../OutputAPI.hxx"
+#include "util/RuntimeError.hxx"
+#include "util/ScopeExit.hxx"
+#include "util/StringCompare.hxx"
+
+#include <audioclient.h>
+#include <mmdeviceapi.h>
+#include <functiondiscoverykeys_devpkey.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * 100ns units per second (the unit of #REFERENCE_TIME).
+ */
+static constexpr REFERENCE_TIME REFTIME_PER_SEC = 10000000;
+
+static std::runtime_error
+MakeHResultError(HRESULT result, const char *prefix)
+{
+	return FormatRuntimeError("%s: 0x%lx", prefix, (unsigned long)result);
+}
+
+template<typename T>
+static void
+SafeRelease(T *&p) noexcept
+{
+	if (p != nullptr) {
+		p->Release();
+		p = nullptr;
+	}
+}
+
+class WasapiOutput final : AudioOutput {
+	/**
+	 * The "device" setting: an index or a prefix of the device's
+	 * friendly name, or empty for the default render endpoint.
+	 */
+	const std::string device_name;
+
+	/**
+	 * The "exclusive" setting: take over the endpoint for
+	 * bit-exact, low-latency output?  In shared mode, the stream
+	 * is converted to the engine's mix format instead.
+	 */
+	const bool exclusive;
+
+	IMMDeviceEnumerator *enumerator = nullptr;
+	IMMDevice *device = nullptr;
+	IAudioClient *client = nullptr;
+	IAudioRenderClient *render_client = nullptr;
+
+	/**
+	 * Signalled by WASAPI whenever a period of the endpoint
+	 * buffer has been consumed.
+	 */
+	HANDLE event = nullptr;
+
+	/**
+	 * The size of the endpoint buffer.  In exclusive event-driven
+	 * mode, this is exactly one period, and every submission must
+	 * fill it completely.
+	 */
+	UINT32 buffer_frames;
+
+	size_t frame_size;
+
+	/**
+	 * Accumulates incoming chunks until one full period is
+	 * available (exclusive mode only).
+	 */
+	uint8_t *period_buffer = nullptr;
+	size_t period_fill;
+
+	bool started;
+
+	/**
+	 * Is the stream suspended by Pause()?  Makes Delay() back
+	 * off, so the pause loop does not spin.
+	 */
+	bool paused;
+
+public:
+	explicit WasapiOutput(const ConfigBlock &block)
+		:AudioOutput(FLAG_ENABLE_DISABLE|FLAG_PAUSE),
+		 device_name(block.GetBlockValue("device", "")),
+		 exclusive(block.GetBlockValue("exclusive", true)) {}
+
+	static AudioOutput *Create(EventLoop &, const ConfigBlock &block) {
+		return new WasapiOutput(block);
+	}
+
+private:
+	void Enable() override;
+	void Disable() noexcept override;
+
+	void Open(AudioFormat &audio_format) override;
+	void Close() noexcept override;
+
+	std::chrono::steady_clock::duration Delay() const noexcept override;
+	size_t Play(const void *chunk, size_t size) override;
+	void Drain() override;
+	void Cancel() noexcept override;
+	bool Pause() override;
+
+	void FindDevice();
+	void SetupFormat(WAVEFORMATEXTENSIBLE &f,
+			 const AudioFormat &audio_format) const noexcept;
+	void OpenExclusive(AudioFormat &audio_format);
+	void OpenShared(AudioFormat &audio_format);
+
+	void Start();
+	void Stop() noexcept;
+
+	/**
+	 * Wait for a period to become consumable and submit exactly
+	 * #buffer_frames frames (exclusive mode).
+	 */
+	void SubmitPeriod(const uint8_t *data);
+};
+
+void
+WasapiOutput::Enable()
+{
+	HRESULT result = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+	if (FAILED(result))
+		throw MakeHResultError(result, "CoInitializeEx() failed");
+
+	result = CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr,
+				  CLSCTX_ALL, __uuidof(IMMDeviceEnumerator),
+				  (void **)&enumerator);
+	if (FAILED(result)) {
+		CoUninitialize();
+		throw MakeHResultError(result,
+				       "Failed to create device enumerator");
+	}
+}
+
+void
+WasapiOutput::Disable() noexcept
+{
+	SafeRelease(enumerator);
+	CoUninitialize();
+}
+
+void
+WasapiOutput::FindDevice()
+{
+	if (device_name.empty()) {
+		HRESULT result =
+			enumerator->GetDefaultAudioEndpoint(eRender, eMultimedia,
+							    &device);
+		if (FAILED(result))
+			throw MakeHResultError(result,
+					       "No default render endpoint");
+		return;
+	}
+
+	IMMDeviceCollection *collection;
+	HRESULT result = enumerator->EnumAudioEndpoints(eRender,
+							DEVICE_STATE_ACTIVE,
+							&collection);
+	if (FAILED(result))
+		throw MakeHResultError(result,
+				       "EnumAudioEndpoints() failed");
+
+	AtScopeExit(&collection) { collection->Release(); };
+
+	UINT count;
+	result = collection->GetCount(&count);
+	if (FAILED(result))
+		throw MakeHResultError(result, "GetCount() failed");
+
+	/* a plain number selects the device by index */
+	char *endptr;
+	const unsigned index = strtoul(device_name.c_str(), &endptr, 10);
+	if (endptr > device_name.c_str() && *endptr == 0) {
+		if (index >= count)
+			throw FormatRuntimeError("device \"%s\" is not found",
+						 device_name.c_str());
+
+		result = collection->Item(index, &device);
+		if (FAILED(result))
+			throw MakeHResultError(result, "Item() failed");
+		return;
+	}
+
+	for (UINT i = 0; i < count; ++i) {
+		IMMDevice *candidate;
+		if (FAILED(collection->Item(i, &candidate)))
+			continue;
+
+		IPropertyStore *properties;
+		if (FAILED(candidate->OpenPropertyStore(STGM_READ,
+							&properties))) {
+			candidate->Release();
+			continue;
+		}
+
+		PROPVARIANT name;
+		PropVariantInit(&name);
+		const bool have_name =
+			SUCCEEDED(properties->GetValue(PKEY_Device_FriendlyName,
+						       &name)) &&
+			name.vt == VT_LPWSTR;
+		properties->Release();
+
+		bool found = false;
+		if (have_name) {
+			char buffer[256];
+			if (WideCharToMultiByte(CP_UTF8, 0, name.pwszVal, -1,
+						buffer, sizeof(buffer),
+						nullptr, nullptr) > 0)
+				found = StringStartsWith(buffer,
+							 device_name.c_str());
+		}
+
+		PropVariantClear(&name);
+
+		if (found) {
+			device = candidate;
+			return;
+		}
+
+		candidate->Release();
+	}
+
+	throw FormatRuntimeError("device \"%s\" is not found",
+				 device_name.c_str());
+}
+
+void
+WasapiOutput::SetupFormat(WAVEFORMATEXTENSIBLE &f,
+			  const AudioFormat &audio_format) const noexcept
+{
+	memset(&f, 0, sizeof(f));
+	f.Format.wFormatTag = WAVE_FORMAT_EXTENSIBLE;
+	f.Format.nChannels = audio_format.channels;
+	f.Format.nSamplesPerSec = audio_format.sample_rate;
+	f.Format.cbSize = sizeof(f) - sizeof(f.Format);
+
+	switch (audio_format.format) {
+	case SampleFormat::S16:
+		f.Format.wBitsPerSample = 16;
+		f.Samples.wValidBitsPerSample = 16;
+		f.SubFormat = KSDATAFORMAT_SUBTYPE_PCM;
+		break;
+
+	case SampleFormat::S24_P32:
+		f.Format.wBitsPerSample = 32;
+		f.Samples.wValidBitsPerSample = 24;
+		f.SubFormat = KSDATAFORMAT_SUBTYPE_PCM;
+		break;
+
+	case SampleFormat::S32:
+		f.Format.wBitsPerSample = 32;
+		f.Samples.wValidBitsPerSample = 32;
+		f.SubFormat = KSDATAFORMAT_SUBTYPE_PCM;
+		break;
+
+	case SampleFormat::FLOAT:
+	default:
+		f.Format.wBitsPerSample = 32;
+		f.Samples.wValidBitsPerSample = 32;
+		f.SubFormat = KSDATAFORMAT_SUBTYPE_IEEE_FLOAT;
+		break;
+	}
+
+	f.Format.nBlockAlign = f.Format.nChannels
+		* f.Format.wBitsPerSample / 8;
+	f.Format.nAvgBytesPerSec = f.Format.nSamplesPerSec
+		* f.Format.nBlockAlign;
+	f.dwChannelMask = audio_format.channels == 1
+		? SPEAKER_FRONT_CENTER
+		: (1u << audio_format.channels) - 1;
+}
+
+void
+WasapiOutput::OpenExclusive(AudioFormat &audio_format)
+{
+	/* normalize formats WASAPI cannot express */
+	switch (audio_format.format) {
+	case SampleFormat::S8:
+		audio_format.format = SampleFormat::S16;
+		break;
+
+	case SampleFormat::DSD:
+		audio_format.format = SampleFormat::S32;
+		break;
+
+	default:
+		break;
+	}
+
+	WAVEFORMATEXTENSIBLE f;
+	SetupFormat(f, audio_format);
+
+	HRESULT result =
+		client->IsFormatSupported(AUDCLNT_SHAREMODE_EXCLUSIVE,
+					  &f.Format, nullptr);
+	if (result == AUDCLNT_E_UNSUPPORTED_FORMAT) {
+		/* fall back to plain 16 bit PCM, which every
+		   endpoint supports */
+		audio_format.format = SampleFormat::S16;
+		SetupFormat(f, audio_format);
+		result = client->IsFormatSupported(AUDCLNT_SHAREMODE_EXCLUSIVE,
+						   &f.Format, nullptr);
+	}
+
+	if (FAILED(result))
+		throw MakeHResultError(result, "Format not supported");
+
+	REFERENCE_TIME default_period, minimum_period;
+	result = client->GetDevicePeriod(&default_period, &minimum_period);
+	if (FAILED(result))
+		throw MakeHResultError(result, "GetDevicePeriod() failed");
+
+	result = client->Initialize(AUDCLNT_SHAREMODE_EXCLUSIVE,
+				    AUDCLNT_STREAMFLAGS_EVENTCALLBACK,
+				    default_period, default_period,
+				    &f.Format, nullptr);
+	if (result == AUDCLNT_E_BUFFER_SIZE_NOT_ALIGNED) {
+		/* the suggested period is not an integral number of
+		   frames for this device; recalculate an aligned one
+		   and reinitialize with a fresh client (required by
+		   the WASAPI documentation) */
+		UINT32 aligned_frames;
+		result = client->GetBufferSize(&aligned_frames);
+		if (FAILED(result))
+			throw MakeHResultError(result,
+					       "GetBufferSize() failed");
+
+		const auto aligned_period = (REFERENCE_TIME)
+			((uint64_t)aligned_frames * REFTIME_PER_SEC
+			 / f.Format.nSamplesPerSec);
+
+		SafeRelease(client);
+		result = device->Activate(__uuidof(IAudioClient), CLSCTX_ALL,
+					  nullptr, (void **)&client);
+		if (FAILED(result))
+			throw MakeHResultError(result,
+					       "IAudioClient reactivation failed");
+
+		result = client->Initialize(AUDCLNT_SHAREMODE_EXCLUSIVE,
+					    AUDCLNT_STREAMFLAGS_EVENTCALLBACK,
+					    aligned_period, aligned_period,
+					    &f.Format, nullptr);
+	}
+
+	if (FAILED(result))
+		throw MakeHResultError(result,
+				       "IAudioClient::Initialize() failed");
+}
+
+void
+WasapiOutput::OpenShared(AudioFormat &audio_format)
+{
+	/* in shared mode, the stream must match the engine's mix
+	   format; let MPD's converter do the work */
+
+	WAVEFORMATEX *mix_format;
+	HRESULT result = client->GetMixFormat(&mix_format);
+	if (FAILED(result))
+		throw MakeHResultError(result, "GetMixFormat() failed");
+
+	AtScopeExit(mix_format) { CoTaskMemFree(mix_format); };
+
+	audio_format.sample_rate = mix_format->nSamplesPerSec;
+	audio_format.channels = mix_format->nChannels;
+	audio_format.format = SampleFormat::FLOAT;
+
+	WAVEFORMATEXTENSIBLE f;
+	SetupFormat(f, audio_format);
+
+	result = client->Initialize(AUDCLNT_SHAREMODE_SHARED,
+				    AUDCLNT_STREAMFLAGS_EVENTCALLBACK,
+				    0, 0, &f.Format, nullptr);
+	if (FAILED(result))
+		throw MakeHResultError(result,
+				       "IAudioClient::Initialize() failed");
+}
+
+void
+WasapiOutput::Open(AudioFormat &audio_format)
+{
+	FindDevice();
+
+	try {
+		HRESULT result = device->Activate(__uuidof(IAudioClient),
+						  CLSCTX_ALL, nullptr,
+						  (void **)&client);
+		if (FAILED(result))
+			throw MakeHResultError(result,
+					       "IAudioClient activation failed");
+
+		if (exclusive)
+			OpenExclusive(audio_format);
+		else
+			OpenShared(audio_format);
+
+		event = CreateEvent(nullptr, false, false, nullptr);
+		if (event == nullptr)
+			throw std::runtime_error("CreateEvent() failed");
+
+		result = client->SetEventHandle(event);
+		if (FAILED(result))
+			throw MakeHResultError(result,
+					       "SetEventHandle() failed");
+
+		result = client->GetBufferSize(&buffer_frames);
+		if (FAILED(result))
+			throw MakeHResultError(result,
+					       "GetBufferSize() failed");
+
+		result = client->GetService(__uuidof(IAudioRenderClient),
+					    (void **)&render_client);
+		if (FAILED(result))
+			throw MakeHResultError(result,
+					       "IAudioRenderClient unavailable");
+	} catch (...) {
+		Close();
+		throw;
+	}
+
+	frame_size = audio_format.GetFrameSize();
+
+	if (exclusive) {
+		period_buffer = new uint8_t[(size_t)buffer_frames * frame_size];
+		period_fill = 0;
+	}
+
+	started = false;
+	paused = false;
+}
+
+void
+WasapiOutput::Close() noexcept
+{
+	if (client != nullptr)
+		client->Stop();
+
+	delete[] period_buffer;
+	period_buffer = nullptr;
+
+	SafeRelease(render_client);
+	SafeRelease(client);
+	SafeRelease(device);
+
+	if (event != nullptr) {
+		CloseHandle(event);
+		event = nullptr;
+	}
+}
+
+void
+WasapiOutput::Start()
+{
+	if (started)
+		return;
+
+	HRESULT result = client->Start();
+	if (FAILED(result) && result != AUDCLNT_E_NOT_STOPPED)
+		throw MakeHResultError(result, "IAudioClient::Start() failed");
+
+	started = true;
+}
+
+void
+WasapiOutput::Stop() noexcept
+{
+	client->Stop();
+	started = false;
+}
+
+std::chrono::steady_clock::duration
+WasapiOutput::Delay() const noexcept
+{
+	/* Play() blocks on the WASAPI event as soon as the endpoint
+	   buffer is full, which is throttling enough; while paused,
+	   back off so the pause loop does not spin */
+	return paused
+		? std::chrono::milliseconds(50)
+		: std::chrono::steady_clock::duration::zero();
+}
+
+void
+WasapiOutput::SubmitPeriod(const uint8_t *data)
+{
+	Start();
+
+	if (WaitForSingleObject(event, 2000) != WAIT_OBJECT_0)
+		throw std::runtime_error("WASAPI event timeout");
+
+	BYTE *dest;
+	HRESULT result = render_client->GetBuffer(buffer_frames, &dest);
+	if (FAILED(result))
+		throw MakeHResultError(result, "GetBuffer() failed");
+
+	memcpy(dest, data, (size_t)buffer_frames * frame_size);
+
+	result = render_client->ReleaseBuffer(buffer_frames, 0);
+	if (FAILED(result))
+		throw MakeHResultError(result, "ReleaseBuffer() failed");
+}
+
+size_t
+WasapiOutput::Play(const void *chunk, size_t size)
+{
+	paused = false;
+
+	if (exclusive) {
+		/* exclusive event-driven streams must submit exactly
+		   one period at a time; accumulate chunks until one
+		   is complete */
+
+		const size_t period_bytes =
+			(size_t)buffer_frames * frame_size;
+		size_t nbytes = std::min(size, period_bytes - period_fill);
+		memcpy(period_buffer + period_fill, chunk, nbytes);
+		period_fill += nbytes;
+
+		if (period_fill == period_bytes) {
+			SubmitPeriod(period_buffer);
+			period_fill = 0;
+		}
+
+		return nbytes;
+	}
+
+	Start();
+
+	while (true) {
+		UINT32 padding;
+		HRESULT result = client->GetCurrentPadding(&padding);
+		if (FAILED(result))
+			throw MakeHResultError(result,
+					       "GetCurrentPadding() failed");
+
+		const UINT32 writable = buffer_frames - padding;
+		if (writable == 0) {
+			if (WaitForSingleObject(event, 2000) != WAIT_OBJECT_0)
+				throw std::runtime_error("WASAPI event timeout");
+			continue;
+		}
+
+		const UINT32 frames =
+			std::min(writable, (UINT32)(size / frame_size));
+		if (frames == 0)
+			/* less than one frame remaining in the
+			   chunk; pretend it was consumed to avoid
+			   spinning */
+			return size;
+
+		BYTE *dest;
+		result = render_client->GetBuffer(frames, &dest);
+		if (FAILED(result))
+			throw MakeHResultError(result, "GetBuffer() failed");
+
+		memcpy(dest, chunk, (size_t)frames * frame_size);
+
+		result = render_client->ReleaseBuffer(frames, 0);
+		if (FAILED(result))
+			throw MakeHResultError(result,
+					       "ReleaseBuffer() failed");
+
+		return (size_t)frames * frame_size;
+	}
+}
+
+void
+WasapiOutput::Drain()
+{
+	if (exclusive) {
+		if (period_fill > 0) {
+			/* zero-pad the final partial period */
+			const size_t period_bytes =
+				(size_t)buffer_frames * frame_size;
+			memset(period_buffer + period_fill, 0,
+			       period_bytes - period_fill);
+			SubmitPeriod(period_buffer);
+			period_fill = 0;
+		}
+
+		/* wait for the endpoint to consume the last period */
+		if (started)
+			WaitForSingleObject(event, 2000);
+		return;
+	}
+
+	while (started) {
+		UINT32 padding;
+		if (FAILED(client->GetCurrentPadding(&padding)) ||
+		    padding == 0)
+			break;
+
+		if (WaitForSingleObject(event, 2000) != WAIT_OBJECT_0)
+			break;
+	}
+}
+
+void
+WasapiOutput::Cancel() noexcept
+{
+	if (started) {
+		Stop();
+		client->Reset();
+	}
+
+	period_fill = 0;
+}
+
+bool
+WasapiOutput::Pause()
+{
+	/* leave the buffered samples in place so playback resumes
+	   seamlessly, but stop the clock */
+	if (started)
+		Stop();
+
+	paused = true;
+	return true;
+}
+
+static bool
+wasapi_output_test_default_device()
+{
+	/* the default multimedia render endpoint is resolved at
+	   Open() time; optimistically claim one exists */
+	return true;
+}
+
+const struct AudioOutputPlugin wasapi_output_plugin = {
+	"wasapi",
+	wasapi_output_test_default_device,
+	WasapiOutput::Create,
+	nullptr,
+};
@@ -27,7 +27,14 @@
 #include "net/UniqueSocketDescriptor.hxx"
 #include "Log.hxx"
 
+#ifndef _WIN32
+#include <sys/uio.h>
+#endif
+
+#include <algorithm>
+
 #include <assert.h>
+#include <errno.h>
 #include <string.h>
 #include <stdio.h>
 
@@ -163,11 +170,16 @@ HttpdClient::SendResponse() noexcept
 
 HttpdClient::HttpdClient(HttpdOutput &_httpd, UniqueSocketDescriptor _fd,
 			 EventLoop &_loop,
-			 bool _metadata_supported)
+			 bool _metadata_supported,
+			 gcc_unused bool _zerocopy)
 	:BufferedSocket(_fd.Release(), _loop),
 	 httpd(_httpd),
 	 metadata_supported(_metadata_supported)
 {
+#ifdef __linux__
+	if (_zerocopy)
+		zerocopy_enabled = GetSocket().SetZeroCopy();
+#endif
 }
 
 void
@@ -182,7 +194,7 @@ HttpdClient::ClearQueue() noexcept
 		queue_size -= page->GetSize();
 #endif
 
-		pages.pop();
+		pages.pop_front();
 	}
 
 	assert(queue_size == 0);
@@ -228,6 +240,247 @@ HttpdClient::GetBytesTillMetaData() const noexcept
 	return -1;
 }
 
+#ifdef __linux__
+
+inline void
+HttpdClient::ZeroCopyPin(size_t n_pages) noexcept
+{
+	ZeroCopyInflight inflight;
+	inflight.seq = zerocopy_sequence++;
+	inflight.pages.reserve(n_pages);
+	inflight.pages.push_back(current_page);
+
+	for (const auto &page : pages) {
+		if (inflight.pages.size() >= n_pages)
+			break;
+
+		inflight.pages.push_back(page);
+	}
+
+	zerocopy_inflight.emplace_back(std::move(inflight));
+}
+
+bool
+HttpdClient::ReadZeroCopyCompletions() noexcept
+{
+	bool found = false;
+
+	uint32_t lo, hi;
+	while (GetSocket().ReadZeroCopyCompletion(lo, hi)) {
+		found = true;
+
+		/* release all pages whose sequence number lies in
+		   [lo, hi]; the subtractions handle sequence number
+		   wraparound */
+		zerocopy_inflight.remove_if([lo, hi](const ZeroCopyInflight &i){
+				return i.seq - lo <= hi - lo;
+			});
+	}
+
+	return found;
+}
+
+#endif
+
+#ifndef _WIN32
+
+bool
+HttpdClient::TryWritePages() noexcept
+{
+	assert(current_page != nullptr);
+	assert(!metadata_requested);
+
+	/* gather the rest of the current page and the queued pages
+	   into one writev() system call */
+
+	static constexpr size_t MAX_PAGES = 16;
+	struct iovec iov[MAX_PAGES];
+
+	iov[0].iov_base =
+		const_cast<uint8_t *>(current_page->GetData() + current_position);
+	iov[0].iov_len = current_page->GetSize() - current_position;
+	size_t n = 1, total = iov[0].iov_len;
+
+	for (const auto &page : pages) {
+		if (n == MAX_PAGES)
+			break;
+
+		iov[n].iov_base = const_cast<uint8_t *>(page->GetData());
+		iov[n].iov_len = page->GetSize();
+		total += page->GetSize();
+		++n;
+	}
+
+	ssize_t nbytes;
+
+#ifdef __linux__
+	if (zerocopy_enabled && !zerocopy_inflight.empty())
+		/* reap completed sends opportunistically, to keep the
+		   in-flight list short */
+		ReadZeroCopyCompletions();
+
+	if (zerocopy_enabled && total >= ZEROCOPY_THRESHOLD) {
+		nbytes = GetSocket().WriteVZeroCopy(iov, n);
+		if (nbytes > 0)
+			/* keep the pages alive until the kernel
+			   acknowledges the send */
+			ZeroCopyPin(n);
+		else if (nbytes < 0 && errno == ENOBUFS)
+			/* the per-user optmem limit is exhausted;
+			   fall back to a copying send */
+			nbytes = GetSocket().WriteV(iov, n);
+	} else
+#endif
+		nbytes = GetSocket().WriteV(iov, n);
+	if (nbytes < 0) {
+		auto e = GetSocketError();
+		if (IsSocketErrorAgain(e)) {
+			ClearReadyFlags(WRITE);
+			return true;
+		}
+
+		if (!IsSocketErrorClosed(e)) {
+			SocketErrorMessage msg(e);
+			FormatWarning(httpd_output_domain,
+				      "failed to write to client: %s",
+				      (const char *)msg);
+		}
+
+		Close();
+		return false;
+	}
+
+	if ((size_t)nbytes < total)
+		/* the kernel send buffer is full */
+		ClearReadyFlags(WRITE);
+
+	/* consume the written bytes, page by page */
+
+	size_t remaining = nbytes;
+	while (true) {
+		const size_t available =
+			current_page->GetSize() - current_position;
+		if (remaining < available) {
+			current_position += remaining;
+			break;
+		}
+
+		remaining -= available;
+		current_page.reset();
+
+		if (pages.empty()) {
+			assert(remaining == 0);
+
+			/* all pages are sent: remove the event
+			   source */
+			CancelWrite();
+			break;
+		}
+
+		current_page = pages.front();
+		pages.pop_front();
+		current_position = 0;
+
+		assert(queue_size >= current_page->GetSize());
+		queue_size -= current_page->GetSize();
+	}
+
+	return true;
+}
+
+#endif
+
+inline bool
+HttpdClient::TryWriteMetaData() noexcept
+{
+	assert(metadata_requested);
+	assert(current_page != nullptr);
+
+	/* the metadata block to interleave: the shared page built
+	   once per tag change, or a single zero byte if no new
+	   metadata is pending */
+
+	static constexpr uint8_t empty_data = 0;
+
+	const uint8_t *block;
+	size_t block_size;
+	if (!metadata_sent) {
+		block = metadata->GetData() + metadata_current_position;
+		block_size = metadata->GetSize() - metadata_current_position;
+	} else {
+		block = &empty_data;
+		block_size = 1;
+	}
+
+#ifndef _WIN32
+	/* coalesce the metadata block and the following payload (up
+	   to the next metadata boundary) into one system call */
+
+	struct iovec iov[2];
+	iov[0].iov_base = const_cast<uint8_t *>(block);
+	iov[0].iov_len = block_size;
+
+	iov[1].iov_base =
+		const_cast<uint8_t *>(current_page->GetData() + current_position);
+	iov[1].iov_len = std::min(size_t(metaint),
+				  current_page->GetSize() - current_position);
+
+	ssize_t nbytes = GetSocket().WriteV(iov, 2);
+#else
+	ssize_t nbytes = GetSocket().Write(block, block_size);
+#endif
+	if (nbytes < 0) {
+		auto e = GetSocketError();
+		if (IsSocketErrorAgain(e)) {
+			ClearReadyFlags(WRITE);
+			return true;
+		}
+
+		if (!IsSocketErrorClosed(e)) {
+			SocketErrorMessage msg(e);
+			FormatWarning(httpd_output_domain,
+				      "failed to write to client: %s",
+				      (const char *)msg);
+		}
+
+		Close();
+		return false;
+	}
+
+	if (size_t(nbytes) < block_size) {
+		/* the metadata block was sent partially */
+		if (!metadata_sent)
+			metadata_current_position += nbytes;
+		return true;
+	}
+
+	/* the metadata block is complete */
+
+	metadata_current_position = 0;
+	metadata_sent = true;
+	metadata_fill = 0;
+
+	/* account the payload which was sent along with it */
+
+	nbytes -= block_size;
+	if (nbytes > 0) {
+		current_position += nbytes;
+		metadata_fill += nbytes;
+		assert(current_position <= current_page->GetSize());
+
+		if (current_position >= current_page->GetSize()) {
+			current_page.reset();
+
+			if (pages.empty())
+				/* all pages are sent: remove the
+				   event source */
+				CancelWrite();
+		}
+	}
+
+	return true;
+}
+
 inline bool
 HttpdClient::TryWrite() noexcept
 {
@@ -245,7 +498,7 @@ HttpdClient::TryWrite() noexcept
 		}
 
 		current_page = pages.front();
-		pages.pop();
+		pages.pop_front();
 		current_position = 0;
 
 		assert(queue_size >= current_page->GetSize());
@@ -254,63 +507,22 @@ HttpdClient::TryWrite() noexcept
 
 	const ssize_t bytes_to_write = GetBytesTillMetaData();
 	if (bytes_to_write == 0) {
-		if (!metadata_sent) {
-			ssize_t nbytes = TryWritePage(*metadata,
-						      metadata_current_position);
-			if (nbytes < 0) {
-				auto e = GetSocketError();
-				if (IsSocketErrorAgain(e))
-					return true;
-
-				if (!IsSocketErrorClosed(e)) {
-					SocketErrorMessage msg(e);
-					FormatWarning(httpd_output_domain,
-						      "failed to write to client: %s",
-						      (const char *)msg);
-				}
-
-				Close();
-				return false;
-			}
-
-			metadata_current_position += nbytes;
-
-			if (metadata->GetSize() - metadata_current_position == 0) {
-				metadata_fill = 0;
-				metadata_current_position = 0;
-				metadata_sent = true;
-			}
-		} else {
-			char empty_data = 0;
-
-			ssize_t nbytes = GetSocket().Write(&empty_data, 1);
-			if (nbytes < 0) {
-				auto e = GetSocketError();
-				if (IsSocketErrorAgain(e))
-					return true;
-
-				if (!IsSocketErrorClosed(e)) {
-					SocketErrorMessage msg(e);
-					FormatWarning(httpd_output_domain,
-						      "failed to write to client: %s",
-						      (const char *)msg);
-				}
-
-				Close();
-				return false;
-			}
-
-			metadata_fill = 0;
-			metadata_current_position = 0;
-		}
+		return TryWriteMetaData();
 	} else {
+#ifndef _WIN32
+		if (!metadata_requested)
+			return TryWritePages();
+#endif
+
 		ssize_t nbytes =
 			TryWritePageN(*current_page, current_position,
 				      bytes_to_write);
 		if (nbytes < 0) {
 			auto e = GetSocketError();
-			if (IsSocketErrorAgain(e))
+			if (IsSocketErrorAgain(e)) {
+				ClearReadyFlags(WRITE);
 				return true;
+			}
 
 			if (!IsSocketErrorClosed(e)) {
 				SocketErrorMessage msg(e);
@@ -349,14 +561,23 @@ HttpdClient::PushPage(PagePtr page) noexcept
 		/* the client is still writing the HTTP request */
 		return;
 
-	if (queue_size > 256 * 1024) {
+	if (queue_size > httpd.client_backlog) {
 		FormatDebug(httpd_output_domain,
-			    "client is too slow, flushing its queue");
-		ClearQueue();
+			    "client is too slow, dropping oldest pages");
+
+		/* evict the oldest pages until half of the backlog is
+		   left, so the client resumes with the most recent
+		   data */
+		while (queue_size > httpd.client_backlog / 2) {
+			assert(!pages.empty());
+
+			queue_size -= pages.front()->GetSize();
+			pages.pop_front();
+		}
 	}
 
 	queue_size += page->GetSize();
-	pages.emplace(std::move(page));
+	pages.emplace_back(std::move(page));
 
 	ScheduleWrite();
 }
@@ -373,6 +594,19 @@ HttpdClient::PushMetaData(PagePtr page) noexcept
 bool
 HttpdClient::OnSocketReady(unsigned flags) noexcept
 {
+#ifdef __linux__
+	if ((flags & ERROR) && zerocopy_enabled) {
+		/* with SO_ZEROCOPY, EPOLLERR usually only announces
+		   completion notifications on the error queue, not a
+		   connection failure */
+		if (ReadZeroCopyCompletions())
+			flags &= ~ERROR;
+
+		if (flags == 0)
+			return true;
+	}
+#endif
+
 	if (!BufferedSocket::OnSocketReady(flags))
 		return false;
 
@@ -27,10 +27,11 @@
 #include <boost/intrusive/link_mode.hpp>
 #include <boost/intrusive/list_hook.hpp>
 
-#include <queue>
 #include <list>
+#include <vector>
 
 #include <stddef.h>
+#include <stdint.h>
 
 class UniqueSocketDescriptor;
 class HttpdOutput;
@@ -58,9 +59,11 @@ class HttpdClient final
 	} state = State::REQUEST;
 
 	/**
-	 * A queue of #Page objects to be sent to the client.
+	 * A queue of #Page objects to be sent to the client.  The
+	 * pages are shared (and immutable), only the references are
+	 * queued here.
 	 */
-	std::queue<PagePtr, std::list<PagePtr>> pages;
+	std::list<PagePtr> pages;
 
 	/**
 	 * The sum of all page sizes in #pages.
@@ -125,6 +128,41 @@ class HttpdClient final
 	 */
 	unsigned metadata_fill = 0;
 
+#ifdef __linux__
+	/* zerocopy */
+
+	/**
+	 * The minimum number of bytes for which a MSG_ZEROCOPY send
+	 * pays off; smaller sends are cheaper to copy than to pin and
+	 * complete.
+	 */
+	static constexpr size_t ZEROCOPY_THRESHOLD = 16384;
+
+	/**
+	 * Has SO_ZEROCOPY been enabled on this socket?  Requires the
+	 * "zerocopy" configuration setting and kernel support.
+	 */
+	bool zerocopy_enabled = false;
+
+	/**
+	 * The sequence number which the kernel will assign to the
+	 * next MSG_ZEROCOPY send on this socket.
+	 */
+	uint32_t zerocopy_sequence = 0;
+
+	/**
+	 * The pages pinned by one MSG_ZEROCOPY send; they are
+	 * released as soon as the kernel acknowledges the sequence
+	 * number on the socket's error queue.
+	 */
+	struct ZeroCopyInflight {
+		uint32_t seq;
+		std::vector<PagePtr> pages;
+	};
+
+	std::list<ZeroCopyInflight> zerocopy_inflight;
+#endif
+
 public:
 	/**
 	 * @param httpd the HTTP output device
@@ -132,7 +170,8 @@ public:
 	 */
 	HttpdClient(HttpdOutput &httpd, UniqueSocketDescriptor _fd,
 		    EventLoop &_loop,
-		    bool _metadata_supported);
+		    bool _metadata_supported,
+		    bool _zerocopy);
 
 	/**
 	 * Note: this does not remove the client from the
@@ -174,6 +213,23 @@ public:
 	ssize_t TryWritePageN(const Page &page,
 			      size_t position, ssize_t n) noexcept;
 
+#ifndef _WIN32
+	/**
+	 * Send the current page and the queued pages with one
+	 * writev() system call.  May only be used when no
+	 * Icy-Metadata needs to be interleaved.
+	 */
+	bool TryWritePages() noexcept;
+#endif
+
+	/**
+	 * Send the pending icy metadata block (the shared #metadata
+	 * page or a single zero byte) at a metadata boundary,
+	 * coalesced with the following payload in one system call
+	 * where the platform allows it.
+	 */
+	bool TryWriteMetaData() noexcept;
+
 	bool TryWrite() noexcept;
 
 	/**
@@ -189,6 +245,22 @@ public:
 private:
 	void ClearQueue() noexcept;
 
+#ifdef __linux__
+	/**
+	 * Pin the current page and the first n_pages-1 queued pages
+	 * for the MSG_ZEROCOPY send which was just issued.
+	 */
+	void ZeroCopyPin(size_t n_pages) noexcept;
+
+	/**
+	 * Drain all pending MSG_ZEROCOPY completion notifications
+	 * from the error queue and release the affected pages.
+	 *
+	 * @return true if at least one notification was consumed
+	 */
+	bool ReadZeroCopyCompletions() noexcept;
+#endif
+
 protected:
 	/* virtual methods from class SocketMonitor */
 	bool OnSocketReady(unsigned flags) noexcept override;
@@ -78,6 +78,13 @@ public:
 	 */
 	const char *content_type;
 
+	/**
+	 * The maximum number of bytes queued for one client; when a
+	 * slow client exceeds it, the oldest queued pages are
+	 * dropped.  Configured with "backlog_kbytes".
+	 */
+	size_t client_backlog;
+
 	/**
 	 * This mutex protects the listener socket and the client
 	 * list.
@@ -140,10 +147,9 @@ private:
 			       boost::intrusive::constant_time_size<true>> clients;
 
 	/**
-	 * A temporary buffer for the httpd_output_read_page()
-	 * function.
+	 * The capacity of the pages produced by ReadPage().
 	 */
-	char buffer[32768];
+	static constexpr size_t page_capacity = 32768;
 
 	/**
 	 * The maximum and current number of clients connected
@@ -151,6 +157,21 @@ private:
 	 */
 	unsigned clients_max;
 
+	/**
+	 * Shall clients attempt to send pages with MSG_ZEROCOPY
+	 * (Linux only)?  Configured with the "zerocopy" setting.
+	 */
+	bool zerocopy;
+
+	/**
+	 * Stream raw PCM without any encoder?  The #MusicChunk
+	 * payload is copied straight into a shared page, and a
+	 * RIFF/WAVE header is synthesized once per Open() and sent to
+	 * every client on connect.  Configured with the
+	 * "passthrough" setting.
+	 */
+	bool passthrough;
+
 public:
 	HttpdOutput(EventLoop &_loop, const ConfigBlock &block);
 
@@ -247,6 +268,12 @@ public:
 	 */
 	void EncodeAndPlay(const void *chunk, size_t size);
 
+	/**
+	 * Broadcasts a raw PCM chunk without passing it through an
+	 * encoder; see #passthrough.
+	 */
+	void PlayPassthrough(const void *chunk, size_t size) noexcept;
+
 	void SendTag(const Tag &tag) override;
 
 	size_t Play(const void *chunk, size_t size) override;
@@ -24,6 +24,8 @@
 #include "output/OutputAPI.hxx"
 #include "encoder/EncoderInterface.hxx"
 #include "encoder/Configured.hxx"
+#include "encoder/plugins/WaveEncoderPlugin.hxx"
+#include "system/ByteOrder.hxx"
 #include "net/UniqueSocketDescriptor.hxx"
 #include "net/SocketAddress.hxx"
 #include "net/ToString.hxx"
@@ -35,6 +37,8 @@
 #include "Log.hxx"
 #include "config/Net.hxx"
 
+#include <stdexcept>
+
 #include <assert.h>
 
 #include <string.h>
@@ -46,8 +50,11 @@ inline
 HttpdOutput::HttpdOutput(EventLoop &_loop, const ConfigBlock &block)
 	:AudioOutput(FLAG_ENABLE_DISABLE|FLAG_PAUSE),
 	 ServerSocket(_loop),
-	 prepared_encoder(CreateConfiguredEncoder(block)),
-	 defer_broadcast(_loop, BIND_THIS_METHOD(OnDeferredBroadcast))
+	 prepared_encoder(block.GetBlockValue("passthrough", false)
+			  ? nullptr
+			  : CreateConfiguredEncoder(block)),
+	 defer_broadcast(_loop, BIND_THIS_METHOD(OnDeferredBroadcast)),
+	 passthrough(prepared_encoder == nullptr)
 {
 	/* read configuration */
 	name = block.GetBlockValue("name", "Set name in config");
@@ -56,14 +63,29 @@ HttpdOutput::HttpdOutput(EventLoop &_loop, const ConfigBlock &block)
 
 	clients_max = block.GetBlockValue("max_clients", 0u);
 
+	client_backlog = (size_t)block.GetBlockValue("backlog_kbytes",
+						     256u) * 1024;
+
+	zerocopy = block.GetBlockValue("zerocopy", false);
+
 	/* set up bind_to_address */
 
 	ServerSocketAddGeneric(*this, block.GetBlockValue("bind_to_address"), block.GetBlockValue("port", 8000u));
 
 	/* determine content type */
-	content_type = prepared_encoder->GetMimeType();
-	if (content_type == nullptr)
-		content_type = "application/octet-stream";
+	if (passthrough) {
+		/* raw PCM wrapped in a synthesized RIFF/WAVE header;
+		   the samples are sent as-is, which is only valid on
+		   a little-endian host */
+		if (!IsLittleEndian())
+			throw std::runtime_error("httpd \"passthrough\" requires a little-endian host");
+
+		content_type = "audio/wav";
+	} else {
+		content_type = prepared_encoder->GetMimeType();
+		if (content_type == nullptr)
+			content_type = "application/octet-stream";
+	}
 }
 
 inline void
@@ -94,7 +116,9 @@ inline void
 HttpdOutput::AddClient(UniqueSocketDescriptor fd) noexcept
 {
 	auto *client = new HttpdClient(*this, std::move(fd), GetEventLoop(),
-				       !encoder->ImplementsTag());
+				       encoder == nullptr ||
+				       !encoder->ImplementsTag(),
+				       zerocopy);
 	clients.push_front(*client);
 
 	/* pass metadata to client */
@@ -153,22 +177,28 @@ HttpdOutput::ReadPage()
 		unflushed_input = 0;
 	}
 
+	/* read the encoder output directly into a pooled page,
+	   avoiding a temporary buffer and a copy */
+	auto page = AllocatePage(page_capacity);
+
 	size_t size = 0;
 	do {
-		size_t nbytes = encoder->Read(buffer + size,
-					      sizeof(buffer) - size);
+		size_t nbytes = encoder->Read(page->GetData() + size,
+					      page->GetCapacity() - size);
 		if (nbytes == 0)
 			break;
 
 		unflushed_input = 0;
 
 		size += nbytes;
-	} while (size < sizeof(buffer));
+	} while (size < page->GetCapacity());
 
 	if (size == 0)
+		/* the empty page returns to the pool */
 		return nullptr;
 
-	return std::make_shared<Page>(buffer, size);
+	page->SetSize(size);
+	return page;
 }
 
 inline void
@@ -192,7 +222,29 @@ HttpdOutput::Open(AudioFormat &audio_format)
 
 	const std::lock_guard<Mutex> protect(mutex);
 
-	OpenEncoder(audio_format);
+	if (passthrough) {
+		/* no encoder: coerce the audio format to one which
+		   can be described by a WAVE header and synthesize
+		   that header; it is sent to every client on
+		   connect */
+
+		switch (audio_format.format) {
+		case SampleFormat::S8:
+		case SampleFormat::S16:
+		case SampleFormat::S32:
+			break;
+
+		default:
+			audio_format.format = SampleFormat::S16;
+			break;
+		}
+
+		uint8_t buffer[wave_encoder_header_size];
+		size_t nbytes = wave_encoder_write_header(audio_format,
+							  buffer);
+		header = std::make_shared<Page>(buffer, nbytes);
+	} else
+		OpenEncoder(audio_format);
 
 	/* initialize other attributes */
 
@@ -305,13 +357,29 @@ HttpdOutput::EncodeAndPlay(const void *chunk, size_t size)
 	BroadcastFromEncoder();
 }
 
+void
+HttpdOutput::PlayPassthrough(const void *chunk, size_t size) noexcept
+{
+	/* no encoder round-trip: copy the PCM payload once into a
+	   pooled page which is shared by all clients */
+	auto page = AllocatePage(size);
+	memcpy(page->GetData(), chunk, size);
+	page->SetSize(size);
+
+	BroadcastPage(std::move(page));
+}
+
 size_t
 HttpdOutput::Play(const void *chunk, size_t size)
 {
 	pause = false;
 
-	if (LockHasClients())
-		EncodeAndPlay(chunk, size);
+	if (LockHasClients()) {
+		if (passthrough)
+			PlayPassthrough(chunk, size);
+		else
+			EncodeAndPlay(chunk, size);
+	}
 
 	if (!timer->IsStarted())
 		timer->Start();
@@ -336,7 +404,7 @@ HttpdOutput::Pause()
 void
 HttpdOutput::SendTag(const Tag &tag)
 {
-	if (encoder->ImplementsTag()) {
+	if (encoder != nullptr && encoder->ImplementsTag()) {
 		/* embed encoder tags */
 
 		/* flush the current stream, and end it */
@@ -18,11 +18,65 @@
  */
 
 #include "Page.hxx"
+#include "thread/Mutex.hxx"
+
+#include <forward_list>
 
 #include <string.h>
 
 Page::Page(const void *data, size_t size) noexcept
-	:buffer(size)
+	:buffer(size), fill(size)
 {
 	memcpy(&buffer.front(), data, size);
 }
+
+/**
+ * A global free list of unused pages.  Pages are produced by the
+ * output thread and released by the io thread, so it must be
+ * protected by a mutex.
+ */
+static struct PagePool {
+	/**
+	 * An upper bound for the number of retained pages.
+	 */
+	static constexpr unsigned MAX = 32;
+
+	Mutex mutex;
+
+	std::forward_list<std::unique_ptr<Page>> list;
+
+	/**
+	 * The current number of pages on the free list.
+	 */
+	unsigned n = 0;
+} page_pool;
+
+PagePtr
+AllocatePage(size_t capacity) noexcept
+{
+	std::unique_ptr<Page> page;
+
+	{
+		const std::lock_guard<Mutex> protect(page_pool.mutex);
+		if (!page_pool.list.empty() &&
+		    page_pool.list.front()->GetCapacity() >= capacity) {
+			page = std::move(page_pool.list.front());
+			page_pool.list.pop_front();
+			--page_pool.n;
+		}
+	}
+
+	if (!page)
+		page.reset(new Page(capacity));
+
+	page->SetSize(0);
+
+	return PagePtr(page.release(), [](Page *p){
+		std::unique_ptr<Page> p2(p);
+		const std::lock_guard<Mutex> protect(page_pool.mutex);
+		if (page_pool.n < page_pool.MAX) {
+			page_pool.list.emplace_front(std::move(p2));
+			++page_pool.n;
+		}
+	});
+}
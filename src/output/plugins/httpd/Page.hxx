@@ -35,22 +35,52 @@
 class Page {
 	AllocatedArray<uint8_t> buffer;
 
+	/**
+	 * The number of bytes which are actually used.  May be
+	 * smaller than the allocated buffer for pool-allocated pages
+	 * which are filled in place.
+	 */
+	size_t fill;
+
 public:
-	explicit Page(size_t _size) noexcept:buffer(_size) {}
+	explicit Page(size_t _size) noexcept:buffer(_size), fill(_size) {}
 	explicit Page(AllocatedArray<uint8_t> &&_buffer) noexcept
-		:buffer(std::move(_buffer)) {}
+		:buffer(std::move(_buffer)), fill(buffer.size()) {}
 
 	Page(const void *data, size_t size) noexcept;
 
 	size_t GetSize() const noexcept {
+		return fill;
+	}
+
+	size_t GetCapacity() const noexcept {
 		return buffer.size();
 	}
 
+	void SetSize(size_t _fill) noexcept {
+		assert(_fill <= buffer.size());
+		fill = _fill;
+	}
+
 	const uint8_t *GetData() const noexcept {
 		return &buffer.front();
 	}
+
+	uint8_t *GetData() noexcept {
+		return &buffer.front();
+	}
 };
 
 typedef std::shared_ptr<Page> PagePtr;
 
+/**
+ * Allocate a #Page with the given capacity from a global free list,
+ * to be filled in place (GetData()/SetSize()).  When the last
+ * reference is dropped, the page returns to the free list instead of
+ * being freed, removing per-page malloc/free from the streaming hot
+ * loop.
+ */
+PagePtr
+AllocatePage(size_t capacity) noexcept;
+
 #endif
@@ -18,8 +18,24 @@
  */
 
 #include "FallbackResampler.hxx"
+#include "Traits.hxx"
+
+#include <algorithm>
+#include <cmath>
 
 #include <assert.h>
+#include <string.h>
+
+gcc_const
+static double
+Sinc(double x) noexcept
+{
+	if (x == 0)
+		return 1;
+
+	x *= M_PI;
+	return std::sin(x) / x;
+}
 
 AudioFormat
 FallbackPcmResampler::Open(AudioFormat &af, unsigned new_sample_rate)
@@ -50,6 +66,47 @@ FallbackPcmResampler::Open(AudioFormat &af, unsigned new_sample_rate)
 	format = af;
 	out_rate = new_sample_rate;
 
+	step = (uint64_t(af.sample_rate) << 32) / new_sample_rate;
+	position = 0;
+
+	/* prime the history with silence so the first filter window
+	   is centered on the first input frame */
+	history.assign((TAPS / 2 - 1) * format.GetFrameSize(), 0);
+
+	/* generate the windowed-sinc filter bank; when downsampling,
+	   the cutoff is scaled below the destination Nyquist
+	   frequency for anti-aliasing, with a small margin for the
+	   transition band of the short filter */
+	const double cutoff = 0.95 *
+		std::min(1.0, double(new_sample_rate) / af.sample_rate);
+
+	filter_bank.resize(size_t(PHASES) * TAPS);
+	for (unsigned p = 0; p < PHASES; ++p) {
+		float *row = &filter_bank[size_t(p) * TAPS];
+		const double frac = double(p) / PHASES;
+
+		double sum = 0;
+		for (unsigned t = 0; t < TAPS; ++t) {
+			/* the distance from the interpolation
+			   point */
+			const double x = double(t) - (TAPS / 2 - 1) - frac;
+
+			/* Hann window */
+			const double w =
+				0.5 + 0.5 * std::cos(x * M_PI / (TAPS / 2));
+
+			const double c = w > 0
+				? cutoff * Sinc(cutoff * x) * w
+				: 0;
+			row[t] = float(c);
+			sum += c;
+		}
+
+		/* normalize the row for unity gain */
+		for (unsigned t = 0; t < TAPS; ++t)
+			row[t] = float(row[t] / sum);
+	}
+
 	AudioFormat result = af;
 	result.sample_rate = new_sample_rate;
 	return result;
@@ -60,57 +117,112 @@ FallbackPcmResampler::Close() noexcept
 {
 }
 
-template<typename T>
-static ConstBuffer<T>
-pcm_resample_fallback(PcmBuffer &buffer,
-		      unsigned channels,
-		      unsigned src_rate,
-		      ConstBuffer<T> src,
-		      unsigned dest_rate) noexcept
+void
+FallbackPcmResampler::Reset() noexcept
 {
-	unsigned dest_pos = 0;
-	unsigned src_frames = src.size / channels;
-	unsigned dest_frames =
-		(src_frames * dest_rate + src_rate - 1) / src_rate;
-	unsigned dest_samples = dest_frames * channels;
-	size_t dest_size = dest_samples * sizeof(*src.data);
-	T *dest_buffer = (T *)buffer.Get(dest_size);
-
-	assert((src.size % channels) == 0);
-
-	switch (channels) {
-	case 1:
-		while (dest_pos < dest_samples) {
-			unsigned src_pos = dest_pos * src_rate / dest_rate;
-
-			dest_buffer[dest_pos++] = src[src_pos];
-		}
-		break;
-	case 2:
-		while (dest_pos < dest_samples) {
-			unsigned src_pos = dest_pos * src_rate / dest_rate;
-			src_pos &= ~1;
+	position = 0;
+	history.assign((TAPS / 2 - 1) * format.GetFrameSize(), 0);
+}
 
-			dest_buffer[dest_pos++] = src[src_pos];
-			dest_buffer[dest_pos++] = src[src_pos + 1];
-		}
-		break;
+ConstBuffer<void>
+FallbackPcmResampler::Flush()
+{
+	/* pad with silence to drain the frames still covered by the
+	   filter window */
+	uint8_t silence[TAPS * sizeof(int32_t) * MAX_CHANNELS];
+	const size_t nbytes = size_t(TAPS) * format.GetFrameSize();
+	assert(nbytes <= sizeof(silence));
+	memset(silence, 0, nbytes);
+
+	return Resample({silence, nbytes});
+}
+
+/**
+ * Convert the filter output back to a sample value; integer samples
+ * may have overshot the value range and need to be clamped.
+ */
+template<SampleFormat F, class Traits=SampleTraits<F>>
+struct FallbackSampleConvert {
+	static typename Traits::value_type FromFloat(float x) noexcept {
+		double d = double(x);
+		if (d < double(Traits::MIN))
+			d = double(Traits::MIN);
+		else if (d > double(Traits::MAX))
+			d = double(Traits::MAX);
+		return typename Traits::value_type(std::lrint(d));
 	}
+};
 
-	return { dest_buffer, dest_samples };
-}
+template<>
+struct FallbackSampleConvert<SampleFormat::FLOAT> {
+	static float FromFloat(float x) noexcept {
+		return x;
+	}
+};
 
-template<typename T>
-static ConstBuffer<void>
-pcm_resample_fallback_void(PcmBuffer &buffer,
-			   unsigned channels,
-			   unsigned src_rate,
-			   ConstBuffer<void> src,
-			   unsigned dest_rate) noexcept
+template<SampleFormat F>
+ConstBuffer<void>
+FallbackPcmResampler::Resample2(ConstBuffer<void> _src) noexcept
 {
-	const auto typed_src = ConstBuffer<T>::FromVoid(src);
-	return pcm_resample_fallback(buffer, channels, src_rate, typed_src,
-				     dest_rate).ToVoid();
+	typedef typename SampleTraits<F>::value_type T;
+
+	const auto src = ConstBuffer<T>::FromVoid(_src);
+	const unsigned channels = format.channels;
+
+	assert(src.size % channels == 0);
+
+	/* prepend the frames carried over from the previous call */
+
+	const size_t history_samples = history.size() / sizeof(T);
+	const size_t total_samples = history_samples + src.size;
+	const size_t total_frames = total_samples / channels;
+
+	T *const work = (T *)work_buffer.Get(total_samples * sizeof(T));
+	memcpy(work, history.data(), history_samples * sizeof(T));
+	std::copy_n(src.data, src.size, work + history_samples);
+
+	/* how many output frames fit into this block? */
+
+	size_t out_frames = 0;
+	if (total_frames >= TAPS) {
+		const uint64_t avail = uint64_t(total_frames - TAPS + 1) << 32;
+		if (position < avail)
+			out_frames = size_t((avail - position + step - 1) / step);
+	}
+
+	T *const dest = (T *)buffer.Get(out_frames * channels * sizeof(T));
+	T *p = dest;
+
+	for (size_t i = 0; i < out_frames; ++i, position += step) {
+		const size_t idx = size_t(position >> 32);
+		const unsigned phase =
+			unsigned(position >> (32 - PHASE_BITS)) & (PHASES - 1);
+		const float *const coeff = &filter_bank[size_t(phase) * TAPS];
+		const T *const in = work + idx * channels;
+
+		for (unsigned c = 0; c < channels; ++c) {
+			const T *s = in + c;
+
+			float sum = 0;
+			for (unsigned t = 0; t < TAPS; ++t)
+				sum += coeff[t] * float(s[t * channels]);
+
+			*p++ = FallbackSampleConvert<F>::FromFloat(sum);
+		}
+	}
+
+	/* carry over the frames which the filter window of the next
+	   block still overlaps */
+
+	const size_t drop = std::min(size_t(position >> 32), total_frames);
+	position -= uint64_t(drop) << 32;
+
+	const size_t keep_samples = total_samples - drop * channels;
+	history.resize(keep_samples * sizeof(T));
+	memcpy(history.data(), work + drop * channels,
+	       keep_samples * sizeof(T));
+
+	return ConstBuffer<T>(dest, out_frames * channels).ToVoid();
 }
 
 ConstBuffer<void>
@@ -124,20 +236,16 @@ FallbackPcmResampler::Resample(ConstBuffer<void> src)
 		gcc_unreachable();
 
 	case SampleFormat::S16:
-		return pcm_resample_fallback_void<int16_t>(buffer,
-							   format.channels,
-							   format.sample_rate,
-							   src,
-							   out_rate);
+		return Resample2<SampleFormat::S16>(src);
 
-	case SampleFormat::FLOAT:
 	case SampleFormat::S24_P32:
+		return Resample2<SampleFormat::S24_P32>(src);
+
 	case SampleFormat::S32:
-		return pcm_resample_fallback_void<int32_t>(buffer,
-							   format.channels,
-							   format.sample_rate,
-							   src,
-							   out_rate);
+		return Resample2<SampleFormat::S32>(src);
+
+	case SampleFormat::FLOAT:
+		return Resample2<SampleFormat::FLOAT>(src);
 	}
 
 	assert(false);
@@ -23,22 +23,78 @@
 #include "Resampler.hxx"
 #include "PcmBuffer.hxx"
 #include "AudioFormat.hxx"
+#include "SampleFormat.hxx"
 #include "util/Compiler.h"
 
+#include <vector>
+
+#include <stdint.h>
+
 /**
- * A naive resampler that is used when no external library was found
- * (or when the user explicitly asks for bad quality).
+ * A built-in polyphase resampler that is used when no external
+ * library was found (or when the user explicitly asks for it).  It
+ * interpolates with a windowed-sinc filter bank generated in Open(),
+ * which is considerably better than the nearest-neighbor resampling
+ * this class used to do, while still being dependency-free.
  */
 class FallbackPcmResampler final : public PcmResampler {
+	/**
+	 * The number of filter taps per output sample.
+	 */
+	static constexpr unsigned TAPS = 16;
+
+	/**
+	 * The number of fractional-position bits used to select a
+	 * filter phase.
+	 */
+	static constexpr unsigned PHASE_BITS = 8;
+
+	/**
+	 * The number of precomputed filter phases.
+	 */
+	static constexpr unsigned PHASES = 1u << PHASE_BITS;
+
 	AudioFormat format;
 	unsigned out_rate;
 
-	PcmBuffer buffer;
+	/**
+	 * The windowed-sinc filter bank: #PHASES rows of #TAPS
+	 * coefficients, generated by Open() for the current rate
+	 * pair.
+	 */
+	std::vector<float> filter_bank;
+
+	/**
+	 * Input frames carried over from the previous Resample()
+	 * call, because the filter window still overlaps them (raw
+	 * sample bytes).
+	 */
+	std::vector<uint8_t> history;
+
+	/**
+	 * The current read position within #history plus the current
+	 * input block, in 32.32 fixed point frames.
+	 */
+	uint64_t position;
+
+	/**
+	 * The source position increment per output frame, in 32.32
+	 * fixed point frames.
+	 */
+	uint64_t step;
+
+	PcmBuffer buffer, work_buffer;
 
 public:
 	AudioFormat Open(AudioFormat &af, unsigned new_sample_rate) override;
 	void Close() noexcept override;
+	void Reset() noexcept override;
 	ConstBuffer<void> Resample(ConstBuffer<void> src) override;
+	ConstBuffer<void> Flush() override;
+
+private:
+	template<SampleFormat F>
+	ConstBuffer<void> Resample2(ConstBuffer<void> src) noexcept;
 };
 
 #endif
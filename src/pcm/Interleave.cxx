@@ -19,6 +19,10 @@
 
 #include "Interleave.hxx"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include <string.h>
 
 static void
@@ -35,6 +39,121 @@ GenericPcmInterleave(uint8_t *gcc_restrict dest,
 	}
 }
 
+#ifdef __SSE2__
+
+/**
+ * Interleave two planar 16 bit channels with SSE2 unpack
+ * instructions, 8 frames per iteration.
+ */
+static void
+PcmInterleaveStereo16Sse2(int16_t *gcc_restrict dest,
+			  const int16_t *gcc_restrict src1,
+			  const int16_t *gcc_restrict src2,
+			  size_t n_frames) noexcept
+{
+	for (; n_frames >= 8; n_frames -= 8, src1 += 8, src2 += 8, dest += 16) {
+		const __m128i a = _mm_loadu_si128((const __m128i *)src1);
+		const __m128i b = _mm_loadu_si128((const __m128i *)src2);
+
+		_mm_storeu_si128((__m128i *)dest,
+				 _mm_unpacklo_epi16(a, b));
+		_mm_storeu_si128((__m128i *)(dest + 8),
+				 _mm_unpackhi_epi16(a, b));
+	}
+
+	for (; n_frames > 0; --n_frames) {
+		*dest++ = *src1++;
+		*dest++ = *src2++;
+	}
+}
+
+/**
+ * Interleave two planar 32 bit channels with SSE2 unpack
+ * instructions, 4 frames per iteration.
+ */
+static void
+PcmInterleaveStereo32Sse2(int32_t *gcc_restrict dest,
+			  const int32_t *gcc_restrict src1,
+			  const int32_t *gcc_restrict src2,
+			  size_t n_frames) noexcept
+{
+	for (; n_frames >= 4; n_frames -= 4, src1 += 4, src2 += 4, dest += 8) {
+		const __m128i a = _mm_loadu_si128((const __m128i *)src1);
+		const __m128i b = _mm_loadu_si128((const __m128i *)src2);
+
+		_mm_storeu_si128((__m128i *)dest,
+				 _mm_unpacklo_epi32(a, b));
+		_mm_storeu_si128((__m128i *)(dest + 4),
+				 _mm_unpackhi_epi32(a, b));
+	}
+
+	for (; n_frames > 0; --n_frames) {
+		*dest++ = *src1++;
+		*dest++ = *src2++;
+	}
+}
+
+/**
+ * Interleave four or more planar 32 bit channels: each group of four
+ * channels is handled with 4x4 block transposes (three unpack levels)
+ * storing whole frames contiguously; leftover channels (e.g. the
+ * fifth and sixth of a 5.1 stream) fall back to strided copies.
+ */
+static void
+PcmInterleave32Sse2(int32_t *gcc_restrict dest,
+		    const ConstBuffer<const int32_t *> src,
+		    size_t n_frames) noexcept
+{
+	const size_t channels = src.size;
+	size_t c = 0;
+
+	for (; c + 4 <= channels; c += 4) {
+		const int32_t *const s0 = src[c], *const s1 = src[c + 1],
+			*const s2 = src[c + 2], *const s3 = src[c + 3];
+
+		size_t i = 0;
+		for (; i + 4 <= n_frames; i += 4) {
+			const __m128i a = _mm_loadu_si128((const __m128i *)(s0 + i));
+			const __m128i b = _mm_loadu_si128((const __m128i *)(s1 + i));
+			const __m128i e = _mm_loadu_si128((const __m128i *)(s2 + i));
+			const __m128i f = _mm_loadu_si128((const __m128i *)(s3 + i));
+
+			const __m128i t0 = _mm_unpacklo_epi32(a, b);
+			const __m128i t1 = _mm_unpacklo_epi32(e, f);
+			const __m128i t2 = _mm_unpackhi_epi32(a, b);
+			const __m128i t3 = _mm_unpackhi_epi32(e, f);
+
+			int32_t *const d = dest + i * channels + c;
+			_mm_storeu_si128((__m128i *)d,
+					 _mm_unpacklo_epi64(t0, t1));
+			_mm_storeu_si128((__m128i *)(d + channels),
+					 _mm_unpackhi_epi64(t0, t1));
+			_mm_storeu_si128((__m128i *)(d + 2 * channels),
+					 _mm_unpacklo_epi64(t2, t3));
+			_mm_storeu_si128((__m128i *)(d + 3 * channels),
+					 _mm_unpackhi_epi64(t2, t3));
+		}
+
+		for (; i < n_frames; ++i) {
+			int32_t *const d = dest + i * channels + c;
+			d[0] = s0[i];
+			d[1] = s1[i];
+			d[2] = s2[i];
+			d[3] = s3[i];
+		}
+	}
+
+	for (; c < channels; ++c) {
+		const int32_t *const s = src[c];
+		int32_t *d = dest + c;
+
+		for (size_t i = 0; i < n_frames; ++i, d += channels)
+			*d = s[i];
+	}
+}
+
+#endif
+
 template<typename T>
 static void
 PcmInterleaveStereo(T *gcc_restrict dest,
@@ -74,6 +193,13 @@ PcmInterleave16(int16_t *gcc_restrict dest,
 		const ConstBuffer<const int16_t *> src,
 		size_t n_frames) noexcept
 {
+#ifdef __SSE2__
+	if (src.size == 2) {
+		PcmInterleaveStereo16Sse2(dest, src[0], src[1], n_frames);
+		return;
+	}
+#endif
+
 	PcmInterleaveT(dest, src, n_frames);
 }
 
@@ -82,6 +208,18 @@ PcmInterleave32(int32_t *gcc_restrict dest,
 		const ConstBuffer<const int32_t *> src,
 		size_t n_frames) noexcept
 {
+#ifdef __SSE2__
+	if (src.size == 2) {
+		PcmInterleaveStereo32Sse2(dest, src[0], src[1], n_frames);
+		return;
+	}
+
+	if (src.size >= 4) {
+		PcmInterleave32Sse2(dest, src, n_frames);
+		return;
+	}
+#endif
+
 	PcmInterleaveT(dest, src, n_frames);
 }
 
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "MixRampAnalyzer.hxx"
+#include "MixRampInfo.hxx"
+#include "util/ConstBuffer.hxx"
+
+#include <cmath>
+
+#include <assert.h>
+#include <stdio.h>
+
+/**
+ * The duration of one analysis window.  MixRamp data does not need to
+ * be more precise than the crossfade granularity, which is one
+ * #MusicChunk.
+ */
+static constexpr double WINDOW_S = 0.02;
+
+/**
+ * The dB thresholds for which ramp points are emitted; must be
+ * monotonically increasing (see mixramp_interpolate() in
+ * CrossFade.cxx).  Resolution is finer near full scale, where typical
+ * "mixramp_db" settings live.
+ */
+static constexpr float mixramp_thresholds[] = {
+	-90, -80, -70, -60, -50, -40, -35, -30, -25,
+	-20, -17, -15, -12, -10, -8, -6, -4, -2, -1, 0,
+};
+
+/**
+ * The volume [dB] assigned to a silent window.
+ */
+static constexpr float SILENCE_DB = -100;
+
+MixRampAnalyzer::MixRampAnalyzer(AudioFormat _format) noexcept
+	:format(_format),
+	 window_samples(size_t(format.sample_rate * WINDOW_S) *
+			format.channels)
+{
+	assert(format.format == SampleFormat::S16);
+	assert(window_samples > 0);
+}
+
+gcc_pure
+static float
+WindowToDb(double sum, size_t n) noexcept
+{
+	const double mean_square = sum / double(n);
+	if (mean_square <= 0)
+		return SILENCE_DB;
+
+	constexpr double full_scale_square = 32768.0 * 32768.0;
+	return float(10 * std::log10(mean_square / full_scale_square));
+}
+
+void
+MixRampAnalyzer::Process(ConstBuffer<int16_t> src) noexcept
+{
+	for (const int16_t sample : src) {
+		window_sum += double(sample) * double(sample);
+
+		if (++window_fill == window_samples) {
+			window_db.push_back(WindowToDb(window_sum,
+						       window_fill));
+			window_sum = 0;
+			window_fill = 0;
+		}
+	}
+}
+
+static void
+AppendRampPoint(std::string &list, float db, double seconds) noexcept
+{
+	char buffer[64];
+	snprintf(buffer, sizeof(buffer), "%.2f %.2f", double(db), seconds);
+
+	if (!list.empty())
+		list.push_back(';');
+	list += buffer;
+}
+
+MixRampInfo
+MixRampAnalyzer::Finish() const noexcept
+{
+	MixRampInfo info;
+
+	const size_t n = window_db.size();
+	if (n == 0)
+		return info;
+
+	std::string start, end;
+
+	/* the ramp at the start of the song: for each threshold, the
+	   first window at least that loud */
+	size_t i = 0;
+	for (const float threshold : mixramp_thresholds) {
+		while (i < n && window_db[i] < threshold)
+			++i;
+		if (i == n)
+			break;
+
+		AppendRampPoint(start, threshold, i * WINDOW_S);
+	}
+
+	/* the ramp at the end of the song: for each threshold, how
+	   long before the end the volume last exceeded it */
+	size_t j = n;
+	for (const float threshold : mixramp_thresholds) {
+		while (j > 0 && window_db[j - 1] < threshold)
+			--j;
+		if (j == 0)
+			break;
+
+		AppendRampPoint(end, threshold, (n - j) * WINDOW_S);
+	}
+
+	if (!start.empty() && !end.empty()) {
+		info.SetStart(std::move(start));
+		info.SetEnd(std::move(end));
+	}
+
+	return info;
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_PCM_MIXRAMP_ANALYZER_HXX
+#define MPD_PCM_MIXRAMP_ANALYZER_HXX
+
+#include "AudioFormat.hxx"
+#include "util/Compiler.h"
+
+#include <vector>
+
+#include <stdint.h>
+#include <stddef.h>
+
+template<typename T> struct ConstBuffer;
+class MixRampInfo;
+
+/**
+ * Analyzes a PCM stream and computes MixRamp "volume ramp" data from
+ * it, in the same format as the "mixramp_start" and "mixramp_end"
+ * tags: a list of "dB seconds" pairs (separated by semicolons) with
+ * monotonically increasing dB values, describing how quickly the
+ * song's volume ramps up at its start and down at its end.
+ *
+ * Feed the whole song to Process() and then call Finish().  Only
+ * 16 bit signed PCM is supported; convert other formats first.
+ */
+class MixRampAnalyzer {
+	const AudioFormat format;
+
+	/**
+	 * The number of samples (not frames) per analysis window.
+	 * Each window is reduced to one average volume [dB].
+	 */
+	const size_t window_samples;
+
+	/**
+	 * Sum of squared samples in the current (incomplete) window.
+	 */
+	double window_sum = 0;
+
+	/**
+	 * Number of samples accumulated in #window_sum.
+	 */
+	size_t window_fill = 0;
+
+	/**
+	 * One volume value [dB] per completed window.
+	 */
+	std::vector<float> window_db;
+
+public:
+	explicit MixRampAnalyzer(AudioFormat _format) noexcept;
+
+	/**
+	 * Feed interleaved 16 bit samples to the analyzer.
+	 */
+	void Process(ConstBuffer<int16_t> src) noexcept;
+
+	/**
+	 * Calculate the ramps after the whole song was fed to
+	 * Process().  Returns an undefined #MixRampInfo if the song
+	 * was too short or too quiet to be analyzed.
+	 */
+	gcc_pure
+	MixRampInfo Finish() const noexcept;
+};
+
+#endif
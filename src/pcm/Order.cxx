@@ -21,6 +21,10 @@
 #include "PcmBuffer.hxx"
 #include "util/ConstBuffer.hxx"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 template<typename V>
 struct TwoPointers {
 	V *dest;
@@ -55,6 +59,53 @@ struct TwoPointers {
 	}
 };
 
+#ifdef __SSE2__
+
+/* SSE2 overloads of the scalar templates below; each rearranges a
+   whole frame with a few vector loads/stores instead of per-sample
+   copies */
+
+static void
+ToAlsaChannelOrder51(int32_t *dest, const int32_t *src, size_t n) noexcept
+{
+	for (; n > 0; --n, src += 6, dest += 6) {
+		const __m128i front = _mm_loadl_epi64((const __m128i *)src);
+		const __m128i mid = _mm_loadl_epi64((const __m128i *)(src + 2));
+		const __m128i rear = _mm_loadl_epi64((const __m128i *)(src + 4));
+
+		_mm_storeu_si128((__m128i *)dest,
+				 _mm_unpacklo_epi64(front, rear));
+		_mm_storel_epi64((__m128i *)(dest + 4), mid);
+	}
+}
+
+static void
+ToAlsaChannelOrder71(int32_t *dest, const int32_t *src, size_t n) noexcept
+{
+	for (; n > 0; --n, src += 8, dest += 8) {
+		const __m128i a = _mm_loadu_si128((const __m128i *)src);
+		const __m128i b = _mm_loadu_si128((const __m128i *)(src + 4));
+
+		_mm_storeu_si128((__m128i *)dest,
+				 _mm_unpacklo_epi64(a, b));
+		_mm_storeu_si128((__m128i *)(dest + 4),
+				 _mm_unpackhi_epi64(a, b));
+	}
+}
+
+static void
+ToAlsaChannelOrder71(int16_t *dest, const int16_t *src, size_t n) noexcept
+{
+	/* one 7.1/S16 frame is exactly one vector; swapping the two
+	   middle channel pairs is a 32 bit lane shuffle */
+	for (; n > 0; --n, src += 8, dest += 8)
+		_mm_storeu_si128((__m128i *)dest,
+				 _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)src),
+						   _MM_SHUFFLE(3, 1, 2, 0)));
+}
+
+#endif
+
 template<typename V>
 static void
 ToAlsaChannelOrder51(V *dest, const V *src, size_t n) noexcept
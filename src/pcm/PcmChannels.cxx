@@ -19,6 +19,7 @@
 
 #include "PcmChannels.hxx"
 #include "PcmBuffer.hxx"
+#include "Clamp.hxx"
 #include "Silence.hxx"
 #include "Traits.hxx"
 #include "AudioFormat.hxx"
@@ -27,6 +28,7 @@
 
 #include <array>
 #include <algorithm>
+#include <type_traits>
 
 #include <assert.h>
 
@@ -126,6 +128,99 @@ StereoToN(typename Traits::pointer_type dest,
 	return dest;
 }
 
+/**
+ * Attenuate a sample by -3dB (factor 0.707, the ITU-R BS.775 downmix
+ * coefficient); integer samples use a Q8 fixed-point approximation.
+ */
+template<typename T, bool is_fp=std::is_floating_point<T>::value>
+struct SurroundAttenuator {
+	static constexpr T Apply(T value) noexcept {
+		return (value * 181) >> 8;
+	}
+};
+
+template<typename T>
+struct SurroundAttenuator<T, true> {
+	static constexpr T Apply(T value) noexcept {
+		return value * T(0.707);
+	}
+};
+
+/**
+ * Convert the downmix sum back to a sample value.  Integer samples
+ * may have overflowed the value range and need to be clamped;
+ * floating point samples are passed through like in all other float
+ * conversions.
+ */
+template<SampleFormat F, class Traits=SampleTraits<F>,
+	 bool is_fp=std::is_floating_point<typename Traits::value_type>::value>
+struct SurroundFinisher {
+	static constexpr typename Traits::value_type
+	Apply(typename Traits::long_type value) noexcept {
+		return PcmClamp<F, Traits>(value);
+	}
+};
+
+template<SampleFormat F, class Traits>
+struct SurroundFinisher<F, Traits, true> {
+	static constexpr typename Traits::value_type
+	Apply(typename Traits::long_type value) noexcept {
+		return value;
+	}
+};
+
+/**
+ * Downmix surround to stereo.  The source channels are assumed to be
+ * in WAV/FLAC order: front left/right first, then the center channel
+ * (if any), the LFE (if any) and the surround pair last.  Center and
+ * surround are mixed into both output channels with the -3dB ITU-R
+ * BS.775 coefficient; the LFE is dropped.
+ *
+ * The loop body is branch-free multiply-add on consecutive samples,
+ * which compilers can auto-vectorize.
+ */
+template<SampleFormat F, class Traits=SampleTraits<F>>
+static typename Traits::pointer_type
+SurroundToStereo(typename Traits::pointer_type dest,
+		 unsigned src_channels,
+		 typename Traits::const_pointer_type src,
+		 typename Traits::const_pointer_type end) noexcept
+{
+	assert(src_channels >= 3 && src_channels <= 6);
+	assert((end - src) % src_channels == 0);
+
+	typedef typename Traits::long_type long_type;
+	typedef SurroundAttenuator<long_type> Attenuator;
+
+	/* 3.0 and 5.x layouts have a center channel; 5.1 has an LFE
+	   after it; quad has neither */
+	const bool has_center = src_channels != 4;
+	const bool has_surround = src_channels >= 4;
+	const unsigned surround = src_channels - 2;
+
+	while (src != end) {
+		long_type left = src[0], right = src[1];
+
+		if (has_center) {
+			const long_type center =
+				Attenuator::Apply(src[2]);
+			left += center;
+			right += center;
+		}
+
+		if (has_surround) {
+			left += Attenuator::Apply(src[surround]);
+			right += Attenuator::Apply(src[surround + 1]);
+		}
+
+		*dest++ = SurroundFinisher<F, Traits>::Apply(left);
+		*dest++ = SurroundFinisher<F, Traits>::Apply(right);
+		src += src_channels;
+	}
+
+	return dest;
+}
+
 template<SampleFormat F, class Traits=SampleTraits<F>>
 static typename Traits::pointer_type
 NToM(typename Traits::pointer_type dest,
@@ -167,6 +262,10 @@ ConvertChannels(PcmBuffer &buffer,
 		MonoToStereo(dest, src.begin(), src.end());
 	else if (src_channels == 2 && dest_channels == 1)
 		StereoToMono<F>(dest, src.begin(), src.end());
+	else if (dest_channels == 2 &&
+		 src_channels >= 3 && src_channels <= 6)
+		SurroundToStereo<F, Traits>(dest, src_channels,
+					    src.begin(), src.end());
 	else if (dest_channels == 2)
 		NToStereo<F>(dest, src_channels, src.begin(), src.end());
 	else if (src_channels == 2 && dest_channels > 2)
@@ -21,9 +21,24 @@
 #include "PcmPrng.hxx"
 #include "Traits.hxx"
 
+#include <algorithm>
+
 template<typename T, T MIN, T MAX, unsigned scale_bits>
 inline T
 PcmDither::Dither(T sample) noexcept
+{
+	constexpr T mask = (1 << scale_bits) - 1;
+
+	const T rnd = pcm_prng(random);
+	const T noise = (rnd & mask) - (random & mask);
+	random = rnd;
+
+	return DitherShaped<T, MIN, MAX, scale_bits>(sample, noise);
+}
+
+template<typename T, T MIN, T MAX, unsigned scale_bits>
+inline T
+PcmDither::DitherShaped(T sample, T noise) noexcept
 {
 	constexpr T round = 1 << (scale_bits - 1);
 	constexpr T mask = (1 << scale_bits) - 1;
@@ -34,12 +49,7 @@ PcmDither::Dither(T sample) noexcept
 	error[1] = error[0] / 2;
 
 	/* round */
-	T output = sample + round;
-
-	const T rnd = pcm_prng(random);
-	output += (rnd & mask) - (random & mask);
-
-	random = rnd;
+	T output = sample + round + noise;
 
 	/* clip */
 	if (output > MAX) {
@@ -61,6 +71,21 @@ PcmDither::Dither(T sample) noexcept
 	return output >> scale_bits;
 }
 
+template<typename T, unsigned scale_bits>
+inline void
+PcmDither::GenerateNoise(T *noise, size_t n) noexcept
+{
+	constexpr T mask = (1 << scale_bits) - 1;
+
+	for (size_t i = 0; i < n; i += NOISE_LANES)
+		for (unsigned lane = 0; lane < NOISE_LANES; ++lane) {
+			const uint32_t rnd = pcm_prng(lane_state[lane]);
+			noise[i + lane] = T(rnd & mask) -
+				T(lane_state[lane] & mask);
+			lane_state[lane] = rnd;
+		}
+}
+
 template<typename ST, unsigned SBITS, unsigned DBITS>
 inline ST
 PcmDither::DitherShift(ST sample) noexcept
@@ -75,26 +100,34 @@ PcmDither::DitherShift(ST sample) noexcept
 }
 
 template<typename ST, typename DT>
-inline typename DT::value_type
-PcmDither::DitherConvert(typename ST::value_type sample) noexcept
+inline void
+PcmDither::DitherConvert(typename DT::pointer_type dest,
+			 typename ST::const_pointer_type src,
+			 typename ST::const_pointer_type src_end) noexcept
 {
 	static_assert(ST::BITS > DT::BITS,
 		      "Sample formats cannot be dithered");
 
+	typedef typename ST::sum_type T;
 	constexpr unsigned scale_bits = ST::BITS - DT::BITS;
 
-	return Dither<typename ST::sum_type, ST::MIN, ST::MAX,
-		      scale_bits>(sample);
-}
+	/* generate the dither noise in blocks with the lane-parallel
+	   (vectorizable) PRNGs; this takes the generator out of the
+	   serial per-sample dependency chain, leaving only the short
+	   noise shaping feedback */
+	T noise[NOISE_CHUNK];
 
-template<typename ST, typename DT>
-inline void
-PcmDither::DitherConvert(typename DT::pointer_type dest,
-			 typename ST::const_pointer_type src,
-			 typename ST::const_pointer_type src_end) noexcept
-{
-	while (src < src_end)
-		*dest++ = DitherConvert<ST, DT>(*src++);
+	while (src < src_end) {
+		const size_t n = std::min(size_t(src_end - src),
+					  size_t(NOISE_CHUNK));
+		GenerateNoise<T, scale_bits>(noise, n);
+
+		for (size_t i = 0; i < n; ++i)
+			*dest++ = DitherShaped<T, ST::MIN, ST::MAX,
+					       scale_bits>(src[i], noise[i]);
+
+		src += n;
+	}
 }
 
 inline void
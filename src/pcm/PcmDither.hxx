@@ -20,17 +20,40 @@
 #ifndef MPD_PCM_DITHER_HXX
 #define MPD_PCM_DITHER_HXX
 
+#include <stddef.h>
 #include <stdint.h>
 
 enum class SampleFormat : uint8_t;
 
 class PcmDither {
+	/**
+	 * The number of independent PRNGs used by GenerateNoise().
+	 * One generator per lane removes the serial dependency
+	 * between neighbouring samples, which allows the compiler to
+	 * vectorize the noise loop.
+	 */
+	static constexpr unsigned NOISE_LANES = 8;
+
+	/**
+	 * The block size (in samples) used by the buffer-based
+	 * conversions; must be a multiple of #NOISE_LANES.
+	 */
+	static constexpr size_t NOISE_CHUNK = 256;
+
 	int32_t error[3];
 	int32_t random;
 
+	/**
+	 * The per-lane PRNG states for GenerateNoise().
+	 */
+	uint32_t lane_state[NOISE_LANES];
+
 public:
 	constexpr PcmDither() noexcept
-		:error{0, 0, 0}, random(0) {}
+		:error{0, 0, 0}, random(0),
+		 lane_state{0x9e3779b9, 0x3c6ef372, 0xdaa66d2b,
+			    0x78dde6e4, 0x1715609d, 0xb54cda56,
+			    0x5384540f, 0xf1bbcdc8} {}
 
 	/**
 	 * Shift the given sample by #SBITS-#DBITS to the right, and
@@ -65,16 +88,30 @@ private:
 	T Dither(T sample) noexcept;
 
 	/**
-	 * Convert the given sample from one sample format to another,
+	 * Like Dither(), but consume a precomputed triangular PDF
+	 * noise value instead of advancing the embedded PRNG; used by
+	 * the buffer-based conversions, which generate their noise in
+	 * blocks with GenerateNoise().
+	 */
+	template<typename T, T MIN, T MAX, unsigned scale_bits>
+	T DitherShaped(T sample, T noise) noexcept;
+
+	/**
+	 * Generate a block of triangular PDF noise values for the
+	 * given quantization step, #NOISE_LANES samples per
+	 * iteration.  May write up to #NOISE_LANES-1 values past n
+	 * (the caller's buffer must be padded accordingly).
+	 */
+	template<typename T, unsigned scale_bits>
+	void GenerateNoise(T *noise, size_t n) noexcept;
+
+	/**
+	 * Convert the given buffer from one sample format to another,
 	 * discarding bits.
 	 *
 	 * @param ST the input #SampleTraits class
-	 * @param ST the output #SampleTraits class
-	 * @param sample the input sample value
+	 * @param DT the output #SampleTraits class
 	 */
-	template<typename ST, typename DT>
-	typename DT::value_type DitherConvert(typename ST::value_type sample) noexcept;
-
 	template<typename ST, typename DT>
 	void DitherConvert(typename DT::pointer_type dest,
 			   typename ST::const_pointer_type src,
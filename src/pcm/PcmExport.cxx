@@ -72,15 +72,20 @@ PcmExport::Open(SampleFormat sample_format, unsigned _channels,
 
 	assert(!shift8 || !pack24);
 
+	pack24_reverse = false;
 	reverse_endian = 0;
 	if (params.reverse_endian) {
-		size_t sample_size = pack24
-			? 3
-			: sample_format_size(sample_format);
-		assert(sample_size <= 0xff);
-
-		if (sample_size > 1)
-			reverse_endian = sample_size;
+		if (pack24)
+			/* fold the byte swap into the packing
+			   pass */
+			pack24_reverse = true;
+		else {
+			size_t sample_size = sample_format_size(sample_format);
+			assert(sample_size <= 0xff);
+
+			if (sample_size > 1)
+				reverse_endian = sample_size;
+		}
 	}
 }
 
@@ -180,7 +185,10 @@ PcmExport::Export(ConstBuffer<void> data) noexcept
 		uint8_t *dest = (uint8_t *)pack_buffer.Get(dest_size);
 		assert(dest != nullptr);
 
-		pcm_pack_24(dest, src.begin(), src.end());
+		if (pack24_reverse)
+			pcm_pack_24_reverse(dest, src.begin(), src.end());
+		else
+			pcm_pack_24(dest, src.begin(), src.end());
 
 		data.data = dest;
 		data.size = dest_size;
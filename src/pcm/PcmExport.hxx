@@ -109,6 +109,13 @@ class PcmExport {
 	 */
 	bool pack24;
 
+	/**
+	 * Write the packed 24 bit samples in reversed byte order?
+	 * This folds the #reverse_endian pass into the packing pass.
+	 * Only possible if #pack24 is enabled.
+	 */
+	bool pack24_reverse;
+
 	/**
 	 * Export the samples in reverse byte order?  A non-zero value
 	 * means the option is enabled and represents the size of each
@@ -115,6 +115,16 @@ struct FloatToInteger<SampleFormat::S16, SampleTraits<SampleFormat::S16>>
 
 #endif
 
+#ifdef __SSE2__
+#include "Sse.hxx"
+
+template<>
+struct FloatToInteger<SampleFormat::S16, SampleTraits<SampleFormat::S16>>
+	: GlueOptimizedConvert<SseFloatTo16,
+			       PortableFloatToInteger<SampleFormat::S16>> {};
+
+#endif
+
 template<class C>
 static ConstBuffer<typename C::DstTraits::value_type>
 AllocateConvert(PcmBuffer &buffer, C convert,
@@ -329,9 +339,19 @@ pcm_convert_to_32(PcmBuffer &buffer,
 struct Convert8ToFloat
 	: PerSampleConvert<IntegerToFloatSampleConvert<SampleFormat::S8>> {};
 
+#ifdef __SSE2__
+
+struct Convert16ToFloat
+	: GlueOptimizedConvert<Sse16ToFloat,
+			       PerSampleConvert<IntegerToFloatSampleConvert<SampleFormat::S16>>> {};
+
+#else
+
 struct Convert16ToFloat
 	: PerSampleConvert<IntegerToFloatSampleConvert<SampleFormat::S16>> {};
 
+#endif
+
 struct Convert24ToFloat
 	: PerSampleConvert<IntegerToFloatSampleConvert<SampleFormat::S24_P32>> {};
 
@@ -25,6 +25,10 @@
 
 #include "PcmDither.cxx" // including the .cxx file to get inlined templates
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include <cmath>
 
 #include <assert.h>
@@ -71,6 +75,52 @@ PcmAddVolumeVoid(PcmDither &dither,
 				volume1, volume2);
 }
 
+#ifdef __SSE2__
+
+/**
+ * Mix two buffers of 16 bit samples using SSE2.  Uses
+ * round-to-nearest instead of dithering, like the SSE2 volume
+ * kernel.
+ */
+static void
+pcm_add_vol_16_sse2(int16_t *a, const int16_t *b, size_t n,
+		    int volume1, int volume2) noexcept
+{
+	const __m128i v1 = _mm_set1_epi16(volume1);
+	const __m128i v2 = _mm_set1_epi16(volume2);
+	const __m128i round = _mm_set1_epi32(1 << (PCM_VOLUME_BITS - 1));
+
+	for (; n >= 8; n -= 8, a += 8, b += 8) {
+		const __m128i sa = _mm_loadu_si128((const __m128i *)a);
+		const __m128i sb = _mm_loadu_si128((const __m128i *)b);
+
+		const __m128i alo16 = _mm_mullo_epi16(sa, v1);
+		const __m128i ahi16 = _mm_mulhi_epi16(sa, v1);
+		const __m128i blo16 = _mm_mullo_epi16(sb, v2);
+		const __m128i bhi16 = _mm_mulhi_epi16(sb, v2);
+
+		__m128i lo = _mm_add_epi32(_mm_unpacklo_epi16(alo16, ahi16),
+					   _mm_unpacklo_epi16(blo16, bhi16));
+		__m128i hi = _mm_add_epi32(_mm_unpackhi_epi16(alo16, ahi16),
+					   _mm_unpackhi_epi16(blo16, bhi16));
+
+		lo = _mm_srai_epi32(_mm_add_epi32(lo, round),
+				    PCM_VOLUME_BITS);
+		hi = _mm_srai_epi32(_mm_add_epi32(hi, round),
+				    PCM_VOLUME_BITS);
+
+		_mm_storeu_si128((__m128i *)a, _mm_packs_epi32(lo, hi));
+	}
+
+	for (; n > 0; --n, ++a, ++b) {
+		int c = *a * volume1 + *b * volume2;
+		c = (c + (1 << (PCM_VOLUME_BITS - 1))) >> PCM_VOLUME_BITS;
+		*a = PcmClamp<SampleFormat::S16>(c);
+	}
+}
+
+#endif
+
 static void
 pcm_add_vol_float(float *buffer1, const float *buffer2,
 		  unsigned num_samples, float volume1, float volume2) noexcept
@@ -103,9 +153,16 @@ pcm_add_vol(PcmDither &dither, void *buffer1, const void *buffer2, size_t size,
 		return true;
 
 	case SampleFormat::S16:
+#ifdef __SSE2__
+		pcm_add_vol_16_sse2((int16_t *)buffer1,
+				    (const int16_t *)buffer2,
+				    size / sizeof(int16_t),
+				    vol1, vol2);
+#else
 		PcmAddVolumeVoid<SampleFormat::S16>(dither,
 						    buffer1, buffer2, size,
 						    vol1, vol2);
+#endif
 		return true;
 
 	case SampleFormat::S24_P32:
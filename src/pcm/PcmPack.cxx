@@ -20,6 +20,52 @@
 #include "PcmPack.hxx"
 #include "system/ByteOrder.hxx"
 
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+#ifdef __SSSE3__
+
+/**
+ * Pack four padded samples into twelve bytes with one byte shuffle
+ * per vector.  Each store writes 16 bytes, the last four of which
+ * are garbage overwritten by the next iteration; the loop therefore
+ * stops while at least two more samples remain, which the caller's
+ * scalar loop picks up.  (SSSE3 implies x86, so the source samples
+ * are known to be little-endian; the byte order of the output is
+ * encoded in the shuffle mask.)
+ */
+static void
+pcm_pack_24_ssse3(uint8_t *&dest, const int32_t *&src,
+		  const int32_t *src_end, const __m128i shuffle) noexcept
+{
+	for (; src_end - src >= 6; src += 4, dest += 12)
+		_mm_storeu_si128((__m128i *)dest,
+				 _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)src),
+						  shuffle));
+}
+
+/**
+ * The counterpart of pcm_pack_24_ssse3(): shuffle twelve packed
+ * bytes into the low three bytes of four 32 bit lanes and
+ * sign-extend them with a shift pair.  Each load reads 16 bytes but
+ * consumes only twelve, so the loop leaves the last few samples to
+ * the caller's scalar loop.
+ */
+static void
+pcm_unpack_24_ssse3(int32_t *&dest, const uint8_t *&src,
+		    const uint8_t *src_end, const __m128i shuffle) noexcept
+{
+	for (; src_end - src >= 16; src += 12, dest += 4) {
+		__m128i v = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)src),
+					     shuffle);
+		v = _mm_srai_epi32(_mm_slli_epi32(v, 8), 8);
+		_mm_storeu_si128((__m128i *)dest, v);
+	}
+}
+
+#endif
+
 static void
 pack_sample(uint8_t *dest, const int32_t *src0) noexcept
 {
@@ -33,9 +79,28 @@ pack_sample(uint8_t *dest, const int32_t *src0) noexcept
 	*dest++ = *src++;
 }
 
+static void
+pack_sample_reverse(uint8_t *dest, const int32_t *src0) noexcept
+{
+	const uint8_t *src = (const uint8_t *)src0;
+
+	if (IsBigEndian())
+		++src;
+
+	*dest++ = src[2];
+	*dest++ = src[1];
+	*dest++ = src[0];
+}
+
 void
 pcm_pack_24(uint8_t *dest, const int32_t *src, const int32_t *src_end) noexcept
 {
+#ifdef __SSSE3__
+	pcm_pack_24_ssse3(dest, src, src_end,
+			  _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10,
+					12, 13, 14, -1, -1, -1, -1));
+#endif
+
 	/* duplicate loop to help the compiler's optimizer (constant
 	   parameter to the pack_sample() inline function) */
 
@@ -45,6 +110,22 @@ pcm_pack_24(uint8_t *dest, const int32_t *src, const int32_t *src_end) noexcept
 	}
 }
 
+void
+pcm_pack_24_reverse(uint8_t *dest,
+		    const int32_t *src, const int32_t *src_end) noexcept
+{
+#ifdef __SSSE3__
+	pcm_pack_24_ssse3(dest, src, src_end,
+			  _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8,
+					14, 13, 12, -1, -1, -1, -1));
+#endif
+
+	while (src < src_end) {
+		pack_sample_reverse(dest, src++);
+		dest += 3;
+	}
+}
+
 /**
  * Construct a signed 24 bit integer from three bytes into a int32_t.
  */
@@ -90,6 +171,12 @@ void
 pcm_unpack_24(int32_t *dest,
 	      const uint8_t *src, const uint8_t *src_end) noexcept
 {
+#ifdef __SSSE3__
+	pcm_unpack_24_ssse3(dest, src, src_end,
+			    _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1,
+					  6, 7, 8, -1, 9, 10, 11, -1));
+#endif
+
 	while (src < src_end) {
 		*dest++ = ReadS24(src);
 		src += 3;
@@ -100,6 +187,12 @@ void
 pcm_unpack_24be(int32_t *dest,
 		const uint8_t *src, const uint8_t *src_end) noexcept
 {
+#ifdef __SSSE3__
+	pcm_unpack_24_ssse3(dest, src, src_end,
+			    _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1,
+					  8, 7, 6, -1, 11, 10, 9, -1));
+#endif
+
 	while (src < src_end) {
 		*dest++ = ReadS24BE(src);
 		src += 3;
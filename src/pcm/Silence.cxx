@@ -20,16 +20,34 @@
 #include "Silence.hxx"
 #include "Traits.hxx"
 #include "SampleFormat.hxx"
+#include "util/ConstBuffer.hxx"
 #include "util/WritableBuffer.hxx"
 
 #include <string.h>
 
+static constexpr uint8_t
+SilencePattern(SampleFormat format) noexcept
+{
+	return format == SampleFormat::DSD
+		? SampleTraits<SampleFormat::DSD>::SILENCE
+		: 0;
+}
+
 void
 PcmSilence(WritableBuffer<void> dest, SampleFormat format) noexcept
 {
-	uint8_t pattern = 0;
-	if (format == SampleFormat::DSD)
-		pattern = SampleTraits<SampleFormat::DSD>::SILENCE;
+	memset(dest.data, SilencePattern(format), dest.size);
+}
+
+bool
+PcmCheckSilence(ConstBuffer<void> src, SampleFormat format) noexcept
+{
+	if (src.empty())
+		return true;
 
-	memset(dest.data, pattern, dest.size);
+	/* compare the first byte with the pattern, and all other
+	   bytes with their predecessor */
+	const uint8_t *data = (const uint8_t *)src.data;
+	return data[0] == SilencePattern(format) &&
+		memcmp(data, data + 1, src.size - 1) == 0;
 }
@@ -20,9 +20,12 @@
 #ifndef MPD_PCM_SILENCE_HXX
 #define MPD_PCM_SILENCE_HXX
 
+#include "util/Compiler.h"
+
 #include <stdint.h>
 
 template<typename T> struct WritableBuffer;
+template<typename T> struct ConstBuffer;
 enum class SampleFormat : uint8_t;
 
 /**
@@ -31,4 +34,12 @@ enum class SampleFormat : uint8_t;
 void
 PcmSilence(WritableBuffer<void> dest, SampleFormat format) noexcept;
 
+/**
+ * Check whether the given buffer contains only the format-specific
+ * silence pattern (i.e. what PcmSilence() would have written).
+ */
+gcc_pure
+bool
+PcmCheckSilence(ConstBuffer<void> src, SampleFormat format) noexcept;
+
 #endif
@@ -20,6 +20,7 @@
 #include "SoxrResampler.hxx"
 #include "AudioFormat.hxx"
 #include "config/Block.hxx"
+#include "thread/Mutex.hxx"
 #include "util/RuntimeError.hxx"
 #include "util/Domain.hxx"
 #include "Log.hxx"
@@ -31,6 +32,13 @@
 
 static constexpr Domain soxr_domain("soxr");
 
+#if SOXR_THIS_VERSION >= SOXR_VERSION(0,1,2)
+/* soxr_clear() is available: closed instances can be cached and
+   reused, which avoids re-deriving the filter coefficients on every
+   format change */
+#define ENABLE_SOXR_CACHE
+#endif
+
 static constexpr unsigned long SOXR_DEFAULT_RECIPE = SOXR_HQ;
 
 /**
@@ -79,6 +87,66 @@ soxr_parse_quality(const char *quality) noexcept
 	return SOXR_INVALID_RECIPE;
 }
 
+#ifdef ENABLE_SOXR_CACHE
+
+/**
+ * A small cache of idle soxr instances, so consecutive tracks
+ * flipping between the same sample rates reuse the warmed-up filter
+ * state instead of re-deriving the coefficients.  Instances live for
+ * the rest of the process.  Resamplers are opened from several
+ * threads (decoder, outputs), hence the #Mutex.
+ */
+struct SoxrCacheSlot {
+	soxr_t soxr = nullptr;
+	unsigned in_rate, out_rate, channels;
+};
+
+static Mutex soxr_cache_mutex;
+static SoxrCacheSlot soxr_cache[4];
+
+static soxr_t
+soxr_cache_get(unsigned in_rate, unsigned out_rate,
+	       unsigned channels) noexcept
+{
+	const std::lock_guard<Mutex> protect(soxr_cache_mutex);
+
+	for (auto &i : soxr_cache) {
+		if (i.soxr != nullptr && i.in_rate == in_rate &&
+		    i.out_rate == out_rate && i.channels == channels) {
+			soxr_t result = i.soxr;
+			i.soxr = nullptr;
+			return result;
+		}
+	}
+
+	return nullptr;
+}
+
+static void
+soxr_cache_put(soxr_t soxr, unsigned in_rate, unsigned out_rate,
+	       unsigned channels) noexcept
+{
+	{
+		const std::lock_guard<Mutex> protect(soxr_cache_mutex);
+
+		for (auto &i : soxr_cache) {
+			if (i.soxr == nullptr) {
+				i.soxr = soxr;
+				i.in_rate = in_rate;
+				i.out_rate = out_rate;
+				i.channels = channels;
+				return;
+			}
+		}
+	}
+
+	/* the cache is full - keep the (still warm) cached instances
+	   and discard this one */
+	soxr_delete(soxr);
+}
+
+#endif
+
 void
 pcm_resample_soxr_global_init(const ConfigBlock &block)
 {
@@ -107,16 +175,31 @@ SoxrPcmResampler::Open(AudioFormat &af, unsigned new_sample_rate)
 	assert(af.IsValid());
 	assert(audio_valid_sample_rate(new_sample_rate));
 
-	soxr_error_t e;
-	soxr = soxr_create(af.sample_rate, new_sample_rate,
-			   af.channels, &e,
-			   nullptr, &soxr_quality, &soxr_runtime);
-	if (soxr == nullptr)
-		throw FormatRuntimeError("soxr initialization has failed: %s",
-					 e);
+	soxr = nullptr;
+
+#ifdef ENABLE_SOXR_CACHE
+	soxr = soxr_cache_get(af.sample_rate, new_sample_rate,
+			      af.channels);
+	if (soxr != nullptr)
+		/* reusing a cached instance: reset the signal state,
+		   keep the filter coefficients */
+		soxr_clear(soxr);
+#endif
+
+	if (soxr == nullptr) {
+		soxr_error_t e;
+		soxr = soxr_create(af.sample_rate, new_sample_rate,
+				   af.channels, &e,
+				   nullptr, &soxr_quality, &soxr_runtime);
+		if (soxr == nullptr)
+			throw FormatRuntimeError("soxr initialization has failed: %s",
+						 e);
+	}
 
 	FormatDebug(soxr_domain, "soxr engine '%s'", soxr_engine(soxr));
 
+	in_rate = af.sample_rate;
+	out_rate = new_sample_rate;
 	channels = af.channels;
 
 	ratio = float(new_sample_rate) / float(af.sample_rate);
@@ -135,7 +218,11 @@ SoxrPcmResampler::Open(AudioFormat &af, unsigned new_sample_rate)
 void
 SoxrPcmResampler::Close() noexcept
 {
+#ifdef ENABLE_SOXR_CACHE
+	soxr_cache_put(soxr, in_rate, out_rate, channels);
+#else
 	soxr_delete(soxr);
+#endif
 }
 
 void
@@ -33,7 +33,7 @@ struct ConfigBlock;
 class SoxrPcmResampler final : public PcmResampler {
 	struct soxr *soxr;
 
-	unsigned channels;
+	unsigned in_rate, out_rate, channels;
 	float ratio;
 
 	PcmBuffer buffer;
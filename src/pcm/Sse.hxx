@@ -0,0 +1,114 @@
+/*
+ * Copyright 2003-2019 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_PCM_SSE_HXX
+#define MPD_PCM_SSE_HXX
+
+#include "Traits.hxx"
+
+#include <emmintrin.h>
+
+/**
+ * Convert floating point samples to 16 bit signed integer using SSE2.
+ */
+struct SseFloatTo16 {
+	static constexpr SampleFormat src_format = SampleFormat::FLOAT;
+	static constexpr SampleFormat dst_format = SampleFormat::S16;
+	typedef SampleTraits<src_format> SrcTraits;
+	typedef SampleTraits<dst_format> DstTraits;
+
+	typedef typename SrcTraits::value_type SV;
+	typedef typename DstTraits::value_type DV;
+
+	static constexpr size_t BLOCK_SIZE = 8;
+
+	void Convert(int16_t *dst, const float *src,
+		     const size_t n) const noexcept {
+		const __m128 factor =
+			_mm_set1_ps(1 << (DstTraits::BITS - 1));
+
+		/* clamp before the conversion to avoid integer
+		   overflow for out-of-range samples; the packing
+		   instruction saturates only within the 32 bit
+		   range */
+		const __m128 lower = _mm_set1_ps(DstTraits::MIN);
+		const __m128 upper = _mm_set1_ps(DstTraits::MAX);
+
+		for (size_t i = 0; i < n / BLOCK_SIZE;
+		     ++i, src += BLOCK_SIZE, dst += BLOCK_SIZE) {
+			__m128 a = _mm_mul_ps(_mm_loadu_ps(src), factor);
+			__m128 b = _mm_mul_ps(_mm_loadu_ps(src + 4), factor);
+
+			a = _mm_min_ps(_mm_max_ps(a, lower), upper);
+			b = _mm_min_ps(_mm_max_ps(b, lower), upper);
+
+			/* convert to 32 bit integer (rounding to
+			   nearest), then pack to 16 bit with
+			   saturation */
+			const __m128i result =
+				_mm_packs_epi32(_mm_cvtps_epi32(a),
+						_mm_cvtps_epi32(b));
+			_mm_storeu_si128((__m128i *)dst, result);
+		}
+	}
+};
+
+/**
+ * Convert 16 bit signed integer samples to floating point using SSE2.
+ */
+struct Sse16ToFloat {
+	static constexpr SampleFormat src_format = SampleFormat::S16;
+	static constexpr SampleFormat dst_format = SampleFormat::FLOAT;
+	typedef SampleTraits<src_format> SrcTraits;
+	typedef SampleTraits<dst_format> DstTraits;
+
+	typedef typename SrcTraits::value_type SV;
+	typedef typename DstTraits::value_type DV;
+
+	static constexpr size_t BLOCK_SIZE = 8;
+
+	void Convert(float *dst, const int16_t *src,
+		     const size_t n) const noexcept {
+		const __m128 factor =
+			_mm_set1_ps(1.0f / (1 << (SrcTraits::BITS - 1)));
+
+		for (size_t i = 0; i < n / BLOCK_SIZE;
+		     ++i, src += BLOCK_SIZE, dst += BLOCK_SIZE) {
+			const __m128i value =
+				_mm_loadu_si128((const __m128i *)src);
+
+			/* sign-extend the 16 bit samples to 32 bit by
+			   moving them into the high half and shifting
+			   back arithmetically */
+			const __m128i lo =
+				_mm_srai_epi32(_mm_unpacklo_epi16(value, value),
+					       16);
+			const __m128i hi =
+				_mm_srai_epi32(_mm_unpackhi_epi16(value, value),
+					       16);
+
+			_mm_storeu_ps(dst,
+				      _mm_mul_ps(_mm_cvtepi32_ps(lo), factor));
+			_mm_storeu_ps(dst + 4,
+				      _mm_mul_ps(_mm_cvtepi32_ps(hi), factor));
+		}
+	}
+};
+
+#endif
@@ -26,6 +26,10 @@
 
 #include "PcmDither.cxx" // including the .cxx file to get inlined templates
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include <assert.h>
 #include <stdint.h>
 #include <string.h>
@@ -55,6 +59,42 @@ pcm_volume_change(PcmDither &dither,
 		dest[i] = pcm_volume_sample<F, Traits>(dither, src[i], volume);
 }
 
+/**
+ * Like pcm_volume_change(), but interpolate the gain linearly from
+ * #volume0 to #volume1 over the buffer.  The gain is carried in a
+ * 16 bit fixed-point fraction on top of the #PCM_VOLUME_BITS, which
+ * keeps the rounding error of the per-sample increment negligible
+ * even for very large buffers.
+ */
+template<SampleFormat F, class Traits=SampleTraits<F>>
+static void
+pcm_volume_ramp(PcmDither &dither,
+		typename Traits::pointer_type dest,
+		typename Traits::const_pointer_type src,
+		size_t n,
+		int volume0, int volume1) noexcept
+{
+	int64_t acc = int64_t(volume0) << 16;
+	const int64_t step = n > 0
+		? ((int64_t(volume1) - int64_t(volume0)) << 16) / int64_t(n)
+		: 0;
+
+	for (size_t i = 0; i != n; ++i, acc += step)
+		dest[i] = pcm_volume_sample<F, Traits>(dither, src[i],
+						       int(acc >> 16));
+}
+
+static void
+pcm_volume_ramp_float(float *dest, const float *src, size_t n,
+		      float volume0, float volume1) noexcept
+{
+	const float step = n > 0 ? (volume1 - volume0) / n : 0;
+	float v = volume0;
+
+	for (size_t i = 0; i != n; ++i, v += step)
+		dest[i] = src[i] * v;
+}
+
 static void
 pcm_volume_change_8(PcmDither &dither,
 		    int8_t *dest, const int8_t *src, size_t n,
@@ -63,12 +103,116 @@ pcm_volume_change_8(PcmDither &dither,
 	pcm_volume_change<SampleFormat::S8>(dither, dest, src, n, volume);
 }
 
+#ifdef __SSE2__
+
+/**
+ * Apply software volume to a buffer of 16 bit samples using SSE2.
+ * Uses round-to-nearest instead of dithering; the rounding error is
+ * well below the dither noise this replaces.
+ */
+static void
+pcm_volume_change_16_sse2(int16_t *dest, const int16_t *src, size_t n,
+			  int volume) noexcept
+{
+	const __m128i v = _mm_set1_epi16(volume);
+	const __m128i round = _mm_set1_epi32(1 << (PCM_VOLUME_BITS - 1));
+
+	for (; n >= 8; n -= 8, src += 8, dest += 8) {
+		const __m128i s = _mm_loadu_si128((const __m128i *)src);
+
+		/* assemble the 32 bit products from the low/high
+		   halves of the 16x16 multiplication */
+		const __m128i lo16 = _mm_mullo_epi16(s, v);
+		const __m128i hi16 = _mm_mulhi_epi16(s, v);
+
+		__m128i lo = _mm_unpacklo_epi16(lo16, hi16);
+		__m128i hi = _mm_unpackhi_epi16(lo16, hi16);
+
+		lo = _mm_srai_epi32(_mm_add_epi32(lo, round),
+				    PCM_VOLUME_BITS);
+		hi = _mm_srai_epi32(_mm_add_epi32(hi, round),
+				    PCM_VOLUME_BITS);
+
+		_mm_storeu_si128((__m128i *)dest,
+				 _mm_packs_epi32(lo, hi));
+	}
+
+	/* scalar tail with the same rounding */
+	for (; n > 0; --n)
+		*dest++ = (*src++ * volume +
+			   (1 << (PCM_VOLUME_BITS - 1))) >> PCM_VOLUME_BITS;
+}
+
+/**
+ * Apply software volume to a buffer of 32 bit samples (S32 or
+ * S24_P32) using SSE2.  The caller must ensure volume<=PCM_VOLUME_1,
+ * so the scaled samples cannot overflow.  Like the 16 bit kernel,
+ * this uses round-to-nearest instead of dithering; at this sample
+ * depth, dither noise is far below audibility anyway.
+ */
+static void
+pcm_volume_change_32_sse2(int32_t *dest, const int32_t *src, size_t n,
+			  int volume) noexcept
+{
+	const __m128i v_lo = _mm_set_epi32(0, volume, 0, volume);
+	const __m128i v_hi = _mm_set_epi32(volume, 0, volume, 0);
+	const __m128i round = _mm_set_epi32(0, 1 << (PCM_VOLUME_BITS - 1),
+					    0, 1 << (PCM_VOLUME_BITS - 1));
+
+	for (; n >= 4; n -= 4, src += 4, dest += 4) {
+		const __m128i s = _mm_loadu_si128((const __m128i *)src);
+
+		/* unsigned 32x32->64 products of the even and odd
+		   lanes */
+		__m128i even = _mm_mul_epu32(s, v_lo);
+		__m128i odd = _mm_mul_epu32(_mm_srli_si128(s, 4), v_lo);
+
+		/* the unsigned product of a negative sample is off
+		   by volume<<32: subtract that from the high
+		   dwords */
+		const __m128i sign = _mm_srai_epi32(s, 31);
+		even = _mm_sub_epi64(even,
+				     _mm_and_si128(_mm_shuffle_epi32(sign, _MM_SHUFFLE(2, 2, 0, 0)),
+						   v_hi));
+		odd = _mm_sub_epi64(odd,
+				    _mm_and_si128(_mm_shuffle_epi32(sign, _MM_SHUFFLE(3, 3, 1, 1)),
+						  v_hi));
+
+		/* round and shift; a logical shift is enough,
+		   because only the low 32 bits of each lane are
+		   used */
+		even = _mm_srli_epi64(_mm_add_epi64(even, round),
+				      PCM_VOLUME_BITS);
+		odd = _mm_srli_epi64(_mm_add_epi64(odd, round),
+				     PCM_VOLUME_BITS);
+
+		/* compact the results back into four 32 bit lanes */
+		even = _mm_shuffle_epi32(even, _MM_SHUFFLE(3, 3, 2, 0));
+		odd = _mm_shuffle_epi32(odd, _MM_SHUFFLE(3, 3, 2, 0));
+
+		_mm_storeu_si128((__m128i *)dest,
+				 _mm_unpacklo_epi32(even, odd));
+	}
+
+	/* scalar tail with the same rounding */
+	for (; n > 0; --n)
+		*dest++ = (int64_t(*src++) * volume +
+			   (1 << (PCM_VOLUME_BITS - 1))) >> PCM_VOLUME_BITS;
+}
+
+#endif
+
 static void
 pcm_volume_change_16(PcmDither &dither,
 		     int16_t *dest, const int16_t *src, size_t n,
 		     int volume) noexcept
 {
+#ifdef __SSE2__
+	(void)dither;
+	pcm_volume_change_16_sse2(dest, src, n, volume);
+#else
 	pcm_volume_change<SampleFormat::S16>(dither, dest, src, n, volume);
+#endif
 }
 
 static void
@@ -76,6 +220,13 @@ pcm_volume_change_24(PcmDither &dither,
 		     int32_t *dest, const int32_t *src, size_t n,
 		     int volume) noexcept
 {
+#ifdef __SSE2__
+	if (volume <= PCM_VOLUME_1S) {
+		pcm_volume_change_32_sse2(dest, src, n, volume);
+		return;
+	}
+#endif
+
 	pcm_volume_change<SampleFormat::S24_P32>(dither, dest, src, n,
 						 volume);
 }
@@ -85,6 +236,13 @@ pcm_volume_change_32(PcmDither &dither,
 		     int32_t *dest, const int32_t *src, size_t n,
 		     int volume) noexcept
 {
+#ifdef __SSE2__
+	if (volume <= PCM_VOLUME_1S) {
+		pcm_volume_change_32_sse2(dest, src, n, volume);
+		return;
+	}
+#endif
+
 	pcm_volume_change<SampleFormat::S32>(dither, dest, src, n, volume);
 }
 
@@ -119,66 +277,156 @@ PcmVolume::Open(SampleFormat _format)
 	}
 
 	format = _format;
+
+	/* no ramp across Open(): start at the configured volume */
+	ramp_volume = volume;
 }
 
-ConstBuffer<void>
-PcmVolume::Apply(ConstBuffer<void> src) noexcept
+inline void
+PcmVolume::ApplyRamp(void *dest, const void *src, size_t size) noexcept
 {
-	if (volume == PCM_VOLUME_1)
-		return src;
+	assert(ramp_volume != volume);
 
-	void *data = buffer.Get(src.size);
+	const int volume0 = ramp_volume, volume1 = volume;
+	ramp_volume = volume;
 
-	if (volume == 0) {
-		/* optimized special case: 0% volume = memset(0) */
-		PcmSilence({data, src.size}, format);
-		return { data, src.size };
+	switch (format) {
+	case SampleFormat::UNDEFINED:
+	case SampleFormat::DSD:
+		assert(false);
+		gcc_unreachable();
+
+	case SampleFormat::S8:
+		pcm_volume_ramp<SampleFormat::S8>(dither, (int8_t *)dest,
+						  (const int8_t *)src,
+						  size / sizeof(int8_t),
+						  volume0, volume1);
+		break;
+
+	case SampleFormat::S16:
+		pcm_volume_ramp<SampleFormat::S16>(dither, (int16_t *)dest,
+						   (const int16_t *)src,
+						   size / sizeof(int16_t),
+						   volume0, volume1);
+		break;
+
+	case SampleFormat::S24_P32:
+		pcm_volume_ramp<SampleFormat::S24_P32>(dither, (int32_t *)dest,
+						       (const int32_t *)src,
+						       size / sizeof(int32_t),
+						       volume0, volume1);
+		break;
+
+	case SampleFormat::S32:
+		pcm_volume_ramp<SampleFormat::S32>(dither, (int32_t *)dest,
+						   (const int32_t *)src,
+						   size / sizeof(int32_t),
+						   volume0, volume1);
+		break;
+
+	case SampleFormat::FLOAT:
+		pcm_volume_ramp_float((float *)dest, (const float *)src,
+				      size / sizeof(float),
+				      pcm_volume_to_float(volume0),
+				      pcm_volume_to_float(volume1));
+		break;
+	}
+}
+
+inline void
+PcmVolume::ApplySamples(void *dest, const void *src, size_t size) noexcept
+{
+	if (ramp_volume != volume) {
+		/* the volume has changed since the previous buffer:
+		   fade to the new gain in this same pass */
+		ApplyRamp(dest, src, size);
+		return;
 	}
 
 	switch (format) {
 	case SampleFormat::UNDEFINED:
+	case SampleFormat::DSD:
 		assert(false);
 		gcc_unreachable();
 
 	case SampleFormat::S8:
-		pcm_volume_change_8(dither, (int8_t *)data,
-				    (const int8_t *)src.data,
-				    src.size / sizeof(int8_t),
+		pcm_volume_change_8(dither, (int8_t *)dest,
+				    (const int8_t *)src,
+				    size / sizeof(int8_t),
 				    volume);
 		break;
 
 	case SampleFormat::S16:
-		pcm_volume_change_16(dither, (int16_t *)data,
-				     (const int16_t *)src.data,
-				     src.size / sizeof(int16_t),
+		pcm_volume_change_16(dither, (int16_t *)dest,
+				     (const int16_t *)src,
+				     size / sizeof(int16_t),
 				     volume);
 		break;
 
 	case SampleFormat::S24_P32:
-		pcm_volume_change_24(dither, (int32_t *)data,
-				     (const int32_t *)src.data,
-				     src.size / sizeof(int32_t),
+		pcm_volume_change_24(dither, (int32_t *)dest,
+				     (const int32_t *)src,
+				     size / sizeof(int32_t),
 				     volume);
 		break;
 
 	case SampleFormat::S32:
-		pcm_volume_change_32(dither, (int32_t *)data,
-				     (const int32_t *)src.data,
-				     src.size / sizeof(int32_t),
+		pcm_volume_change_32(dither, (int32_t *)dest,
+				     (const int32_t *)src,
+				     size / sizeof(int32_t),
 				     volume);
 		break;
 
 	case SampleFormat::FLOAT:
-		pcm_volume_change_float((float *)data,
-					(const float *)src.data,
-					src.size / sizeof(float),
+		pcm_volume_change_float((float *)dest,
+					(const float *)src,
+					size / sizeof(float),
 					pcm_volume_to_float(volume));
 		break;
+	}
+}
 
-	case SampleFormat::DSD:
+ConstBuffer<void>
+PcmVolume::Apply(ConstBuffer<void> src) noexcept
+{
+	if (volume == PCM_VOLUME_1 && ramp_volume == volume)
+		return src;
+
+	void *data = buffer.Get(src.size);
+
+	if (volume == 0 && ramp_volume == volume) {
+		/* optimized special case: 0% volume = memset(0) */
+		PcmSilence({data, src.size}, format);
+		return { data, src.size };
+	}
+
+	if (format == SampleFormat::DSD) {
 		// TODO: implement this; currently, it's a no-op
+		ramp_volume = volume;
 		return src;
 	}
 
+	ApplySamples(data, src.data, src.size);
 	return { data, src.size };
 }
+
+void
+PcmVolume::ApplyInPlace(WritableBuffer<void> dest) noexcept
+{
+	if (volume == PCM_VOLUME_1 && ramp_volume == volume)
+		return;
+
+	if (volume == 0 && ramp_volume == volume) {
+		/* optimized special case: 0% volume = memset(0) */
+		PcmSilence(dest, format);
+		return;
+	}
+
+	if (format == SampleFormat::DSD) {
+		// TODO: implement this; currently, it's a no-op
+		ramp_volume = volume;
+		return;
+	}
+
+	ApplySamples(dest.data, dest.data, dest.size);
+}
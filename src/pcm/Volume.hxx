@@ -29,6 +29,7 @@
 #endif
 
 template<typename T> struct ConstBuffer;
+template<typename T> struct WritableBuffer;
 
 /**
  * Number of fractional bits for a fixed-point volume value.
@@ -65,12 +66,21 @@ class PcmVolume {
 
 	unsigned volume;
 
+	/**
+	 * The gain which was applied to the end of the previous
+	 * buffer.  After SetVolume() has changed #volume, the next
+	 * buffer interpolates linearly from this value to #volume
+	 * instead of jumping, which avoids audible clicks ("zipper
+	 * noise").
+	 */
+	unsigned ramp_volume;
+
 	PcmBuffer buffer;
 	PcmDither dither;
 
 public:
 	PcmVolume() noexcept
-		:volume(PCM_VOLUME_1) {
+		:volume(PCM_VOLUME_1), ramp_volume(PCM_VOLUME_1) {
 #ifndef NDEBUG
 		format = SampleFormat::UNDEFINED;
 #endif
@@ -113,6 +123,26 @@ public:
 	 */
 	gcc_pure
 	ConstBuffer<void> Apply(ConstBuffer<void> src) noexcept;
+
+	/**
+	 * Apply the volume level, modifying the given buffer in
+	 * place.
+	 */
+	void ApplyInPlace(WritableBuffer<void> dest) noexcept;
+
+private:
+	/**
+	 * Scale the samples; #dest and #src may be the same buffer.
+	 */
+	void ApplySamples(void *dest, const void *src,
+			  size_t size) noexcept;
+
+	/**
+	 * Like ApplySamples(), but interpolate the gain linearly from
+	 * #ramp_volume to #volume over the buffer.
+	 */
+	void ApplyRamp(void *dest, const void *src,
+		       size_t size) noexcept;
 };
 
 #endif
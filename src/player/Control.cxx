@@ -29,10 +29,14 @@
 PlayerControl::PlayerControl(PlayerListener &_listener,
 			     PlayerOutputs &_outputs,
 			     unsigned _buffer_chunks,
+			     unsigned _decoder_wakeup_percent,
 			     AudioFormat _configured_audio_format,
-			     const ReplayGainConfig &_replay_gain_config) noexcept
+			     const ReplayGainConfig &_replay_gain_config,
+			     uint64_t _thread_affinity) noexcept
 	:listener(_listener), outputs(_outputs),
 	 buffer_chunks(_buffer_chunks),
+	 decoder_wakeup_percent(_decoder_wakeup_percent),
+	 thread_affinity(_thread_affinity),
 	 configured_audio_format(_configured_audio_format),
 	 thread(BIND_THIS_METHOD(RunThread)),
 	 replay_gain_config(_replay_gain_config)
@@ -118,6 +118,21 @@ class PlayerControl final : public AudioOutputClient {
 
 	const unsigned buffer_chunks;
 
+	/**
+	 * The "decoder_wakeup_percent" setting: how much of the
+	 * #MusicBuffer must be free before the player wakes up the
+	 * decoder thread again.  Larger values mean fewer, bigger
+	 * decode batches and thus fewer context switches.
+	 */
+	const unsigned decoder_wakeup_percent;
+
+	/**
+	 * The "player_thread_affinity" setting: a CPU affinity mask
+	 * for the player thread (and, by inheritance, the decoder
+	 * thread), or 0 if no affinity was configured.
+	 */
+	const uint64_t thread_affinity;
+
 	/**
 	 * The "audio_output_format" setting.
 	 */
@@ -235,8 +250,10 @@ public:
 	PlayerControl(PlayerListener &_listener,
 		      PlayerOutputs &_outputs,
 		      unsigned buffer_chunks,
+		      unsigned _decoder_wakeup_percent,
 		      AudioFormat _configured_audio_format,
-		      const ReplayGainConfig &_replay_gain_config) noexcept;
+		      const ReplayGainConfig &_replay_gain_config,
+		      uint64_t _thread_affinity) noexcept;
 	~PlayerControl() noexcept;
 
 	void Kill() noexcept;
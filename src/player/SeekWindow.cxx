@@ -0,0 +1,132 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "SeekWindow.hxx"
+#include "MusicBuffer.hxx"
+#include "MusicPipe.hxx"
+
+#include <vector>
+
+#include <string.h>
+
+void
+SeekWindow::Push(const MusicChunk &chunk, AudioFormat af) noexcept
+{
+	if (af != format) {
+		Clear();
+		format = af;
+	}
+
+	if (chunk.time.IsNegative() || chunk.length == 0) {
+		/* no usable time stamp - we cannot know where this
+		   data belongs */
+		Clear();
+		return;
+	}
+
+	while (fragments.size() >= MAX_SIZE / sizeof(Fragment))
+		fragments.pop_front();
+
+	fragments.emplace_back();
+	auto &fragment = fragments.back();
+	fragment.time = SongTime(chunk.time);
+	fragment.length = chunk.length;
+	fragment.bit_rate = chunk.bit_rate;
+	memcpy(fragment.data, chunk.data, chunk.length);
+}
+
+bool
+SeekWindow::Contains(SongTime t) const noexcept
+{
+	if (fragments.empty())
+		return false;
+
+	const auto &back = fragments.back();
+	const SongTime end = back.time +
+		format.SizeToTime<SongTime>(back.length);
+
+	return t >= fragments.front().time && t < end;
+}
+
+bool
+SeekWindow::Restore(SongTime t, AudioFormat af,
+		    MusicBuffer &buffer, MusicPipe &pipe) noexcept
+{
+	if (af != format || !Contains(t))
+		return false;
+
+	/* find the first fragment which covers the given time
+	   stamp */
+
+	auto begin = fragments.begin();
+	while (begin != fragments.end() &&
+	       begin->time + format.SizeToTime<SongTime>(begin->length) <= t)
+		++begin;
+
+	/* copy the fragments into freshly allocated chunks; only
+	   after all allocations have succeeded may the pipe be
+	   touched, so a full buffer cannot leave it half-restored */
+
+	std::vector<MusicChunkPtr> chunks;
+	chunks.reserve(std::distance(begin, fragments.end()));
+
+	for (auto i = begin; i != fragments.end(); ++i) {
+		const uint8_t *data = i->data;
+		size_t length = i->length;
+		SongTime time = i->time;
+
+		if (i == begin && t > time) {
+			/* trim the first fragment to start at the
+			   requested time (frame-aligned) */
+			size_t skip = format.TimeToSize(t - time);
+			skip -= skip % format.GetFrameSize();
+			data += skip;
+			length -= skip;
+			time += format.SizeToTime<SongTime>(skip);
+		}
+
+		if (length == 0)
+			continue;
+
+		auto chunk = buffer.Allocate();
+		if (chunk == nullptr)
+			return false;
+
+		auto w = chunk->Write(format, time, i->bit_rate);
+		if (w.size < length)
+			return false;
+
+		memcpy(w.data, data, length);
+		chunk->Expand(format, length);
+
+		chunks.emplace_back(std::move(chunk));
+	}
+
+	if (chunks.empty())
+		return false;
+
+	for (auto i = chunks.rbegin(); i != chunks.rend(); ++i)
+		pipe.Unshift(std::move(*i));
+
+	/* the retained data is now owned by the pipe; it will be
+	   re-recorded while it plays again */
+	Clear();
+
+	return true;
+}
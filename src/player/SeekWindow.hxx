@@ -0,0 +1,94 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_PLAYER_SEEK_WINDOW_HXX
+#define MPD_PLAYER_SEEK_WINDOW_HXX
+
+#include "MusicChunk.hxx"
+#include "AudioFormat.hxx"
+#include "Chrono.hxx"
+
+#include <deque>
+
+class MusicBuffer;
+class MusicPipe;
+
+/**
+ * A sliding window of recently played PCM data, kept by the player
+ * thread.  Short backward seeks within this window are served by
+ * copying the retained data back into the #MusicPipe, without
+ * bothering the decoder (no input stream repositioning, no resync).
+ */
+class SeekWindow {
+	/**
+	 * An upper bound for the amount of retained PCM data.  At
+	 * CD quality, this is roughly 20 seconds.
+	 */
+	static constexpr size_t MAX_SIZE = 4 * 1024 * 1024;
+
+	struct Fragment {
+		SongTime time;
+		uint16_t length;
+		uint16_t bit_rate;
+		uint8_t data[sizeof(MusicChunk::data)];
+	};
+
+	std::deque<Fragment> fragments;
+
+	/**
+	 * The format of the retained data.  A format change discards
+	 * the window.
+	 */
+	AudioFormat format = AudioFormat::Undefined();
+
+public:
+	void Clear() noexcept {
+		fragments.clear();
+	}
+
+	/**
+	 * Append a copy of the given chunk's PCM data, evicting the
+	 * oldest fragments if the window is full.  Chunks without a
+	 * usable time stamp discard the window, because continuity
+	 * can no longer be tracked.
+	 */
+	void Push(const MusicChunk &chunk, AudioFormat af) noexcept;
+
+	/**
+	 * Does the retained window cover the given time stamp?
+	 */
+	gcc_pure
+	bool Contains(SongTime t) const noexcept;
+
+	/**
+	 * Serve a backward seek from the window: allocate chunks from
+	 * the buffer, fill them with the retained PCM data starting
+	 * at the given time stamp and push them to the head of the
+	 * pipe.  On success, the window is discarded (the data will
+	 * be re-recorded while it plays again).
+	 *
+	 * @return true if the pipe now starts at (approximately) the
+	 * requested time, false if the seek cannot be served from the
+	 * window
+	 */
+	bool Restore(SongTime t, AudioFormat af,
+		     MusicBuffer &buffer, MusicPipe &pipe) noexcept;
+};
+
+#endif
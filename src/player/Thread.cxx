@@ -44,12 +44,26 @@
 #include "MusicChunk.hxx"
 #include "song/DetachedSong.hxx"
 #include "CrossFade.hxx"
+#include "SeekWindow.hxx"
+#include "MixRampCache.hxx"
+#include "MixRampInfo.hxx"
 #include "tag/Tag.hxx"
 #include "Idle.hxx"
+#include "Metrics.hxx"
 #include "util/Domain.hxx"
 #include "thread/Name.hxx"
+#include "thread/Util.hxx"
 #include "Log.hxx"
 
+#ifndef _WIN32
+#include "fs/AllocatedPath.hxx"
+#include "fs/Traits.hxx"
+#include "system/UniqueFileDescriptor.hxx"
+
+#include <fcntl.h>
+#endif
+
+#include <algorithm>
 #include <exception>
 #include <memory>
 
@@ -57,6 +71,35 @@
 
 static constexpr Domain player_domain("player");
 
+#ifndef _WIN32
+
+/**
+ * Ask the kernel to read ahead the file of the queued song, so the
+ * decoder does not have to wait for storage (e.g. a cold NFS server)
+ * when it reaches the end of the current song.  This is only a hint;
+ * errors are ignored.
+ */
+static void
+PrefetchSong(const char *uri) noexcept
+{
+	if (!PathTraitsUTF8::IsAbsolute(uri))
+		/* not a local file - the input plugin will do its own
+		   buffering */
+		return;
+
+	const auto path = AllocatedPath::FromUTF8(uri);
+	if (path.IsNull())
+		return;
+
+	UniqueFileDescriptor fd;
+	if (!fd.OpenReadOnly(path.c_str()))
+		return;
+
+	posix_fadvise(fd.Get(), 0, 0, POSIX_FADV_WILLNEED);
+}
+
+#endif
+
 /**
  * Start playback as soon as enough data for this duration has been
  * pushed to the decoder pipe.
@@ -91,13 +134,28 @@ class Player {
 	 */
 	unsigned buffer_before_play;
 
+	/**
+	 * The time when the current prebuffering measurement started,
+	 * or a default-constructed value if none is running.  Used by
+	 * IsBufferingComplete() to estimate the decoder pipe's fill
+	 * rate.
+	 */
+	std::chrono::steady_clock::time_point buffering_start;
+
+	/**
+	 * The pipe size (in chunks) when #buffering_start was taken.
+	 */
+	unsigned buffering_base;
+
 	/**
 	 * If the decoder pipe gets consumed below this threshold,
 	 * it's time to wake up the decoder.
 	 *
 	 * It is calculated in a way which should prevent a wakeup
 	 * after each single consumed chunk; it is more efficient to
-	 * make the decoder decode a larger block at a time.
+	 * make the decoder decode a larger block at a time.  The
+	 * batch size is derived from the "decoder_wakeup_percent"
+	 * setting (see PlayerControl::decoder_wakeup_percent).
 	 */
 	const unsigned decoder_wakeup_threshold;
 
@@ -184,6 +242,12 @@ class Player {
 	 */
 	SongTime elapsed_time = SongTime::zero();
 
+	/**
+	 * Recently played PCM data, for serving short backward seeks
+	 * without the decoder.
+	 */
+	SeekWindow seek_window;
+
 	/**
 	 * If this is positive, then we need to ask the decoder to
 	 * seek after it has completed startup.  This is needed if the
@@ -198,7 +262,10 @@ public:
 	Player(PlayerControl &_pc, DecoderControl &_dc,
 	       MusicBuffer &_buffer) noexcept
 		:pc(_pc), dc(_dc), buffer(_buffer),
-		 decoder_wakeup_threshold(buffer.GetSize() * 3 / 4)
+		 decoder_wakeup_threshold(std::max(buffer.GetSize()
+						   * (100 - _pc.decoder_wakeup_percent)
+						   / 100,
+						   1u))
 	{
 	}
 
@@ -237,6 +304,15 @@ private:
 	 */
 	bool CheckDecoderStartup() noexcept;
 
+	/**
+	 * Has enough data been prebuffered to start playback?
+	 * Adapts to the observed source throughput: fast sources
+	 * (local files) may start well before
+	 * #buffer_before_play_duration, while sources which barely
+	 * keep up with the play rate buffer additional headroom.
+	 */
+	bool IsBufferingComplete() noexcept;
+
 	/**
 	 * Stop the decoder and clears (and frees) its music pipe.
 	 *
@@ -277,6 +353,18 @@ private:
 	 */
 	bool SeekDecoder(SongTime seek_time) noexcept;
 
+	/**
+	 * Try to serve a seek from already-decoded data: backward
+	 * seeks from the #SeekWindow, forward seeks by discarding
+	 * chunks from the pipe.  On success, the decoder is not
+	 * involved at all.
+	 *
+	 * Caller must lock the mutex.
+	 *
+	 * @return true if the seek has been served
+	 */
+	bool SeekInWindow(SongTime seek_time) noexcept;
+
 	/**
 	 * This is the handler for the #PlayerCommand::SEEK command.
 	 *
@@ -425,6 +513,9 @@ Player::ActivateDecoder() noexcept
 
 	elapsed_time = pc.seek_time;
 
+	/* the retained seek window belongs to the previous song */
+	seek_window.Clear();
+
 	/* set the "starting" flag, which will be cleared by
 	   CheckDecoderStartup() */
 	decoder_starting = true;
@@ -568,6 +659,56 @@ Player::CheckDecoderStartup() noexcept
 	}
 }
 
+inline bool
+Player::IsBufferingComplete() noexcept
+{
+	const unsigned size = pipe->GetSize();
+
+	if (buffering_start == std::chrono::steady_clock::time_point()) {
+		/* begin a new measurement */
+		buffering_start = std::chrono::steady_clock::now();
+		buffering_base = size;
+		return false;
+	}
+
+	const std::chrono::duration<double> elapsed =
+		std::chrono::steady_clock::now() - buffering_start;
+	if (elapsed.count() < 0.1)
+		/* the measurement window is too short to give a
+		   meaningful rate */
+		return size >= buffer_before_play;
+
+	/* the observed fill rate versus the rate at which playback
+	   will consume the pipe, both in chunks per second */
+	const double production =
+		(size - buffering_base) / elapsed.count();
+	const double consumption =
+		double(play_audio_format.TimeToSize(std::chrono::seconds(1)))
+		/ sizeof(MusicChunk::data);
+
+	if (production >= 2 * consumption &&
+	    size >= std::max(1u, buffer_before_play / 4))
+		/* the source delivers much faster than real-time
+		   (e.g. a local file): start early, the pipe will
+		   keep growing during playback */
+		return true;
+
+	if (size < buffer_before_play)
+		return false;
+
+	if (production >= consumption)
+		/* the default amount is buffered and the source
+		   sustains the play rate */
+		return true;
+
+	/* the source is slower than real-time: buffer additional
+	   headroom, bounded by a fraction of the whole music
+	   buffer */
+	const unsigned limit = std::min(buffer_before_play * 4,
+					buffer.GetSize() / 2);
+	return size >= limit;
+}
+
 bool
 Player::SeekDecoder(SongTime seek_time) noexcept
 {
@@ -580,20 +721,93 @@ Player::SeekDecoder(SongTime seek_time) noexcept
 			seek_time = total_time;
 	}
 
-	try {
-		const PlayerControl::ScopeOccupied occupied(pc);
+	if (SeekInWindow(seek_time))
+		/* served from already-decoded data; the decoder just
+		   keeps going */
+		return true;
 
-		dc.Seek(song->GetStartTime() + seek_time);
+	try {
+		dc.SeekAsync(song->GetStartTime() + seek_time);
 	} catch (...) {
 		/* decoder failure */
 		pc.SetError(PlayerError::DECODER, std::current_exception());
 		return false;
 	}
 
+	/* the seek is asynchronous: discard the chunks decoded from
+	   the old position right away so they cannot be played; the
+	   decoder thread clears the pipe again (catching chunks still
+	   in flight) when it executes the seek */
+	pipe->Clear();
+
 	elapsed_time = seek_time;
 	return true;
 }
 
+bool
+Player::SeekInWindow(SongTime seek_time) noexcept
+{
+	if (xfade_state == CrossFadeState::ACTIVE)
+		return false;
+
+	const SongTime target = song->GetStartTime() + seek_time;
+
+	/* backward: prepend retained PCM data to the pipe */
+
+	if (seek_window.Restore(target, play_audio_format,
+				buffer, *pipe)) {
+		elapsed_time = seek_time;
+		return true;
+	}
+
+	/* forward: discard decoded chunks up to the target */
+
+	const MusicChunk *head = pipe->Peek();
+	if (head == nullptr || head->time.IsNegative() ||
+	    target < SongTime(head->time))
+		return false;
+
+	while ((head = pipe->Peek()) != nullptr &&
+	       !head->time.IsNegative()) {
+		if (head->tag != nullptr)
+			/* discarding this chunk would lose a tag
+			   update; let the decoder seek instead */
+			return false;
+
+		const SongTime chunk_end = SongTime(head->time)
+			+ play_audio_format.SizeToTime<SongTime>(head->length);
+		if (target >= chunk_end) {
+			/* retain the skipped chunk so the backward
+			   window stays contiguous */
+			auto skipped = pipe->Shift();
+			seek_window.Push(*skipped, play_audio_format);
+			continue;
+		}
+
+		if (target > SongTime(head->time)) {
+			/* trim the partially skipped chunk
+			   (frame-aligned) */
+			auto chunk = pipe->Shift();
+			size_t skip = play_audio_format.TimeToSize(target - SongTime(chunk->time));
+			skip -= skip % play_audio_format.GetFrameSize();
+			if (skip > 0 && skip < chunk->length) {
+				memmove(chunk->data, chunk->data + skip,
+					chunk->length - skip);
+				chunk->length -= skip;
+				chunk->time = SignedSongTime(SongTime(chunk->time) + play_audio_format.SizeToTime<SongTime>(skip));
+			}
+			pipe->Unshift(std::move(chunk));
+		}
+
+		elapsed_time = seek_time;
+		return true;
+	}
+
+	/* the pipe ran out before the target was reached; fall back
+	   to a decoder seek (which will clear the pipe anyway) */
+	return false;
+}
+
 inline bool
 Player::SeekDecoder() noexcept
 {
@@ -698,6 +912,17 @@ Player::ProcessCommand() noexcept
 
 		if (dc.IsIdle())
 			StartDecoder(std::make_shared<MusicPipe>());
+#ifndef _WIN32
+		else {
+			/* the decoder is still busy with the current
+			   song; meanwhile, start reading ahead the
+			   queued song so the song change won't block
+			   on storage latency */
+			const std::string uri = pc.next_song->GetRealURI();
+			const ScopeUnlock unlock(pc.mutex);
+			PrefetchSong(uri.c_str());
+		}
+#endif
 
 		break;
 
@@ -894,6 +1119,15 @@ Player::PlayNextChunk() noexcept
 		cross_fade_tag = nullptr;
 	}
 
+	/* remember the chunk's PCM data for serving short backward
+	   seeks without the decoder */
+
+	if (chunk->other != nullptr)
+		/* cross-faded chunks are not pure song data */
+		seek_window.Clear();
+	else
+		seek_window.Push(*chunk, play_audio_format);
+
 	/* play the current chunk */
 
 	try {
@@ -984,7 +1218,7 @@ Player::Run() noexcept
 			   until the buffer is large enough, to
 			   prevent stuttering on slow machines */
 
-			if (pipe->GetSize() < buffer_before_play &&
+			if (!IsBufferingComplete() &&
 			    !dc.IsIdle() && !buffer.IsFull()) {
 				/* not enough decoded buffer space yet */
 
@@ -993,6 +1227,7 @@ Player::Run() noexcept
 			} else {
 				/* buffering is complete */
 				buffering = false;
+				buffering_start = {};
 			}
 		}
 
@@ -1014,12 +1249,28 @@ Player::Run() noexcept
 			/* enable cross fading in this song?  if yes,
 			   calculate how many chunks will be required
 			   for it */
+			const char *mixramp_start = dc.GetMixRampStart();
+			const char *mixramp_prev_end = dc.GetMixRampPreviousEnd();
+
+			/* if the songs have no MixRamp tags, fall
+			   back to the persistent MixRamp cache */
+			MixRampInfo cached_next, cached_prev;
+			if (mixramp_start == nullptr && dc.song != nullptr) {
+				cached_next = mixramp_cache_get(dc.song->GetURI());
+				mixramp_start = cached_next.GetStart();
+			}
+
+			if (mixramp_prev_end == nullptr && song != nullptr) {
+				cached_prev = mixramp_cache_get(song->GetURI());
+				mixramp_prev_end = cached_prev.GetEnd();
+			}
+
 			cross_fade_chunks =
 				pc.cross_fade.Calculate(dc.total_time,
 							dc.replay_gain_db,
 							dc.replay_gain_prev_db,
-							dc.GetMixRampStart(),
-							dc.GetMixRampPreviousEnd(),
+							mixramp_start,
+							mixramp_prev_end,
 							dc.out_audio_format,
 							play_audio_format,
 							buffer.GetSize() -
@@ -1035,9 +1286,12 @@ Player::Run() noexcept
 		if (paused) {
 			if (pc.command == PlayerCommand::NONE)
 				pc.Wait();
-		} else if (!pipe->IsEmpty()) {
+		} else if (!pipe->IsEmpty() &&
+			   !(dc.IsSeeking() && dc.pipe == pipe)) {
 			/* at least one music chunk is ready - send it
-			   to the audio output */
+			   to the audio output (unless a seek is in
+			   flight: then the chunks may still be from
+			   the old position and must not be played) */
 
 			const ScopeUnlock unlock(pc.mutex);
 			PlayNextChunk();
@@ -1073,6 +1327,9 @@ Player::Run() noexcept
 			   new PCM data in time: wait for the
 			   decoder */
 
+			global_metrics.decoder_slow.fetch_add(1,
+							      std::memory_order_relaxed);
+
 			/* wake up the decoder (just in case it's
 			   waiting for space in the MusicBuffer) and
 			   wait for it */
@@ -1118,6 +1375,17 @@ PlayerControl::RunThread() noexcept
 try {
 	SetThreadName("player");
 
+	if (thread_affinity != 0) {
+		try {
+			/* the decoder thread started below inherits
+			   this mask */
+			SetThreadAffinity(thread_affinity);
+		} catch (...) {
+			LogError(std::current_exception(),
+				 "PlayerThread could not set CPU affinity, continuing anyway");
+		}
+	}
+
 	DecoderControl dc(mutex, cond,
 			  configured_audio_format,
 			  replay_gain_config);
@@ -32,6 +32,8 @@
 #include "plugins/CuePlaylistPlugin.hxx"
 #include "plugins/EmbeddedCuePlaylistPlugin.hxx"
 #include "input/InputStream.hxx"
+#include "thread/Mutex.hxx"
+#include "util/CharUtil.hxx"
 #include "util/MimeType.hxx"
 #include "util/UriUtil.hxx"
 #include "util/StringUtil.hxx"
@@ -39,6 +41,9 @@
 #include "config/Data.hxx"
 #include "config/Block.hxx"
 
+#include <string>
+#include <unordered_map>
+
 #include <assert.h>
 #include <string.h>
 
@@ -67,9 +72,60 @@ const struct playlist_plugin *const playlist_plugins[] = {
 static constexpr unsigned n_playlist_plugins =
 	ARRAY_SIZE(playlist_plugins) - 1;
 
-/** which plugins have been initialized successfully? */
+/** which plugins are enabled (i.e. not disabled in mpd.conf)? */
 static bool playlist_plugins_enabled[n_playlist_plugins];
 
+/**
+ * The lazy initialization state of each plugin; see
+ * decoder_plugin_init_state in DecoderList.cxx for the rationale.
+ */
+enum class PluginInitState : uint8_t {
+	PENDING,
+	READY,
+	FAILED,
+};
+
+static PluginInitState playlist_plugin_init_state[n_playlist_plugins];
+
+static const ConfigBlock playlist_empty_config_block;
+
+/**
+ * The mpd.conf block of each enabled plugin, to be passed to the
+ * deferred init() call.  Points into the global #ConfigData (or to
+ * #playlist_empty_config_block), which outlives all plugins.
+ */
+static const ConfigBlock *playlist_plugin_configs[n_playlist_plugins];
+
+/** protects #playlist_plugin_init_state */
+static Mutex playlist_plugins_init_mutex;
+
+/**
+ * Dispatch tables built by playlist_list_global_init(): a
+ * lower-cased suffix/MIME type maps to the bit mask of enabled
+ * plugins announcing it.  More than one plugin may claim the same
+ * suffix (e.g. "m3u"), hence a mask instead of a single index.
+ */
+static std::unordered_map<std::string, unsigned> playlist_suffix_masks,
+	playlist_mime_masks;
+
+static std::string
+FoldCase(const char *s) noexcept
+{
+	std::string result(s);
+	for (auto &ch : result)
+		ch = ToLowerASCII(ch);
+	return result;
+}
+
+gcc_pure
+static unsigned
+LookupMask(const std::unordered_map<std::string, unsigned> &map,
+	   const char *key) noexcept
+{
+	const auto i = map.find(FoldCase(key));
+	return i != map.end() ? i->second : 0;
+}
+
 #define playlist_plugins_for_each_enabled(plugin) \
 	playlist_plugins_for_each(plugin) \
 		if (playlist_plugins_enabled[playlist_plugin_iterator - playlist_plugins])
@@ -77,32 +133,63 @@ static bool playlist_plugins_enabled[n_playlist_plugins];
 void
 playlist_list_global_init(const ConfigData &config)
 {
-	const ConfigBlock empty;
-
 	for (unsigned i = 0; playlist_plugins[i] != nullptr; ++i) {
 		const struct playlist_plugin *plugin = playlist_plugins[i];
 		const auto *param =
 			config.FindBlock(ConfigBlockOption::PLAYLIST_PLUGIN,
 					 "name", plugin->name);
 		if (param == nullptr)
-			param = &empty;
+			param = &playlist_empty_config_block;
 		else if (!param->GetBlockValue("enabled", true))
 			/* the plugin is disabled in mpd.conf */
 			continue;
 
-		if (param != nullptr)
-			param->SetUsed();
+		param->SetUsed();
+
+		/* defer the init() call to the first actual use of
+		   the plugin; until then, only the static
+		   scheme/suffix/MIME tables are consulted */
+		playlist_plugin_configs[i] = param;
+		playlist_plugins_enabled[i] = true;
+
+		if (plugin->suffixes != nullptr)
+			for (auto s = plugin->suffixes; *s != nullptr; ++s)
+				playlist_suffix_masks[FoldCase(*s)] |= 1u << i;
 
-		playlist_plugins_enabled[i] =
-			playlist_plugin_init(playlist_plugins[i], *param);
+		if (plugin->mime_types != nullptr)
+			for (auto s = plugin->mime_types; *s != nullptr; ++s)
+				playlist_mime_masks[FoldCase(*s)] |= 1u << i;
 	}
 }
 
+/**
+ * Perform the deferred init() call of the plugin with the given
+ * index, unless it has been initialized already (thread-safe "once"
+ * semantics).
+ *
+ * @return true if the plugin is ready for use
+ */
+static bool
+playlist_plugin_ensure_initialized(unsigned i) noexcept
+{
+	const std::lock_guard<Mutex> protect(playlist_plugins_init_mutex);
+
+	if (playlist_plugin_init_state[i] == PluginInitState::PENDING)
+		playlist_plugin_init_state[i] =
+			playlist_plugin_init(playlist_plugins[i],
+					     *playlist_plugin_configs[i])
+			? PluginInitState::READY
+			: PluginInitState::FAILED;
+
+	return playlist_plugin_init_state[i] == PluginInitState::READY;
+}
+
 void
 playlist_list_global_finish() noexcept
 {
-	playlist_plugins_for_each_enabled(plugin)
-		playlist_plugin_finish(plugin);
+	for (unsigned i = 0; playlist_plugins[i] != nullptr; ++i)
+		if (playlist_plugin_init_state[i] == PluginInitState::READY)
+			playlist_plugin_finish(playlist_plugins[i]);
 }
 
 static std::unique_ptr<SongEnumerator>
@@ -123,6 +210,9 @@ playlist_list_open_uri_scheme(const char *uri, Mutex &mutex,
 		if (playlist_plugins_enabled[i] && plugin->open_uri != nullptr &&
 		    plugin->schemes != nullptr &&
 		    StringArrayContainsCase(plugin->schemes, scheme.c_str())) {
+			if (!playlist_plugin_ensure_initialized(i))
+				continue;
+
 			auto playlist = plugin->open_uri(uri, mutex);
 			if (playlist)
 				return playlist;
@@ -145,12 +235,17 @@ playlist_list_open_uri_suffix(const char *uri, Mutex &mutex,
 	if (suffix == nullptr)
 		return nullptr;
 
-	for (unsigned i = 0; playlist_plugins[i] != nullptr; ++i) {
+	unsigned mask = LookupMask(playlist_suffix_masks, suffix);
+	for (unsigned i = 0; mask != 0; ++i, mask >>= 1) {
+		if (!(mask & 1))
+			continue;
+
 		const struct playlist_plugin *plugin = playlist_plugins[i];
 
-		if (playlist_plugins_enabled[i] && !tried[i] &&
-		    plugin->open_uri != nullptr && plugin->suffixes != nullptr &&
-		    StringArrayContainsCase(plugin->suffixes, suffix)) {
+		if (!tried[i] && plugin->open_uri != nullptr) {
+			if (!playlist_plugin_ensure_initialized(i))
+				continue;
+
 			auto playlist = plugin->open_uri(uri, mutex);
 			if (playlist != nullptr)
 				return playlist;
@@ -184,10 +279,17 @@ playlist_list_open_stream_mime2(InputStreamPtr &&is, const char *mime)
 {
 	assert(mime != nullptr);
 
-	playlist_plugins_for_each_enabled(plugin) {
-		if (plugin->open_stream != nullptr &&
-		    plugin->mime_types != nullptr &&
-		    StringArrayContainsCase(plugin->mime_types, mime)) {
+	unsigned mask = LookupMask(playlist_mime_masks, mime);
+	for (unsigned i = 0; mask != 0; ++i, mask >>= 1) {
+		if (!(mask & 1))
+			continue;
+
+		const struct playlist_plugin *plugin = playlist_plugins[i];
+
+		if (plugin->open_stream != nullptr) {
+			if (!playlist_plugin_ensure_initialized(i))
+				continue;
+
 			/* rewind the stream, so each plugin gets a
 			   fresh start */
 			try {
@@ -227,10 +329,17 @@ playlist_list_open_stream_suffix(InputStreamPtr &&is, const char *suffix)
 {
 	assert(suffix != nullptr);
 
-	playlist_plugins_for_each_enabled(plugin) {
-		if (plugin->open_stream != nullptr &&
-		    plugin->suffixes != nullptr &&
-		    StringArrayContainsCase(plugin->suffixes, suffix)) {
+	unsigned mask = LookupMask(playlist_suffix_masks, suffix);
+	for (unsigned i = 0; mask != 0; ++i, mask >>= 1) {
+		if (!(mask & 1))
+			continue;
+
+		const struct playlist_plugin *plugin = playlist_plugins[i];
+
+		if (plugin->open_stream != nullptr) {
+			if (!playlist_plugin_ensure_initialized(i))
+				continue;
+
 			/* rewind the stream, so each plugin gets a
 			   fresh start */
 			try {
@@ -279,11 +388,5 @@ playlist_suffix_supported(const char *suffix) noexcept
 {
 	assert(suffix != nullptr);
 
-	playlist_plugins_for_each_enabled(plugin) {
-		if (plugin->suffixes != nullptr &&
-		    StringArrayContainsCase(plugin->suffixes, suffix))
-			return true;
-	}
-
-	return false;
+	return LookupMask(playlist_suffix_masks, suffix) != 0;
 }
@@ -19,12 +19,12 @@
 
 #include "SoundCloudPlaylistPlugin.hxx"
 #include "../PlaylistPlugin.hxx"
-#include "../MemorySongEnumerator.hxx"
+#include "../SongEnumerator.hxx"
 #include "lib/yajl/Handle.hxx"
 #include "lib/yajl/Callbacks.hxx"
-#include "lib/yajl/ParseInputStream.hxx"
 #include "config/Block.hxx"
 #include "input/InputStream.hxx"
+#include "song/DetachedSong.hxx"
 #include "tag/Builder.hxx"
 #include "util/ASCII.hxx"
 #include "util/StringCompare.hxx"
@@ -33,6 +33,7 @@
 #include "util/ScopeExit.hxx"
 #include "Log.hxx"
 
+#include <forward_list>
 #include <string>
 
 #include <string.h>
@@ -109,8 +110,19 @@ struct SoundCloudJsonData {
 	std::string title;
 	int got_url = 0; /* nesting level of last stream_url */
 
+	/**
+	 * Songs parsed so far which have not yet been consumed by
+	 * SoundCloudSongEnumerator::NextSong().
+	 */
 	std::forward_list<DetachedSong> songs;
 
+	/**
+	 * The last element of #songs (or before_begin() if it is
+	 * empty); new songs are appended here to preserve the
+	 * playlist order.
+	 */
+	std::forward_list<DetachedSong>::iterator tail = songs.before_begin();
+
 	bool Integer(long long value) noexcept;
 	bool String(StringView value) noexcept;
 	bool StartMap() noexcept;
@@ -194,7 +206,7 @@ SoundCloudJsonData::EndMap() noexcept
 	if (!title.empty())
 		tag.AddItem(TAG_NAME, title.c_str());
 
-	songs.emplace_front(u.c_str(), tag.Commit());
+	tail = songs.emplace_after(tail, u.c_str(), tag.Commit());
 
 	return true;
 }
@@ -215,16 +227,54 @@ static constexpr yajl_callbacks parse_callbacks = {
 };
 
 /**
- * Read JSON data and parse it using the given YAJL parser.
- * @param url URL of the JSON data.
- * @param handle YAJL parser handle.
+ * A #SongEnumerator which parses the JSON reply incrementally: each
+ * NextSong() call reads only as much data as needed to complete the
+ * next track object, instead of downloading and parsing the whole
+ * playlist up front.
  */
-static void
-soundcloud_parse_json(const char *url, Yajl::Handle &handle,
-		      Mutex &mutex)
+class SoundCloudSongEnumerator final : public SongEnumerator {
+	InputStreamPtr input_stream;
+
+	SoundCloudJsonData data;
+	Yajl::Handle handle;
+
+	bool done = false;
+
+public:
+	explicit SoundCloudSongEnumerator(InputStreamPtr &&_input_stream) noexcept
+		:input_stream(std::move(_input_stream)),
+		 handle(&parse_callbacks, nullptr, &data) {}
+
+	std::unique_ptr<DetachedSong> NextSong() override;
+};
+
+std::unique_ptr<DetachedSong>
+SoundCloudSongEnumerator::NextSong()
 {
-	auto input_stream = InputStream::OpenReady(url, mutex);
-	Yajl::ParseInputStream(handle, *input_stream);
+	while (data.songs.empty() && !done) {
+		unsigned char buffer[4096];
+		const size_t nbytes =
+			input_stream->LockRead(buffer, sizeof(buffer));
+		if (nbytes == 0) {
+			handle.CompleteParse();
+			done = true;
+			break;
+		}
+
+		handle.Parse(buffer, nbytes);
+	}
+
+	if (data.songs.empty())
+		return nullptr;
+
+	auto song = std::make_unique<DetachedSong>(std::move(data.songs.front()));
+	data.songs.pop_front();
+	if (data.songs.empty())
+		/* the tail iterator pointed to the element we have
+		   just removed */
+		data.tail = data.songs.before_begin();
+
+	return song;
 }
 
 /**
@@ -275,12 +325,8 @@ soundcloud_open_uri(const char *uri, Mutex &mutex)
 		return nullptr;
 	}
 
-	SoundCloudJsonData data;
-	Yajl::Handle handle(&parse_callbacks, nullptr, &data);
-	soundcloud_parse_json(u, handle, mutex);
-
-	data.songs.reverse();
-	return std::make_unique<MemorySongEnumerator>(std::move(data.songs));
+	auto input_stream = InputStream::OpenReady(u, mutex);
+	return std::make_unique<SoundCloudSongEnumerator>(std::move(input_stream));
 }
 
 static const char *const soundcloud_schemes[] = {
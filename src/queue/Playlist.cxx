@@ -49,7 +49,7 @@ playlist::TagModified(const char *uri, const Tag &tag) noexcept
 	bool modified = false;
 
 	for (unsigned i = 0; i < queue.length; ++i) {
-		auto &song = *queue.items[i].song;
+		auto &song = queue.Get(i);
 		if (song.IsURI(uri)) {
 			song.SetTag(tag);
 			queue.ModifyAtPosition(i);
@@ -56,17 +56,28 @@ struct playlist {
 	bool stop_on_error;
 
 	/**
-	 * If true, then a bulk edit has been initiated by
-	 * BeginBulk(), and UpdateQueuedSong() and OnModified() will
-	 * be postponed until CommitBulk()
+	 * The nesting depth of bulk edits initiated by BeginBulk();
+	 * while it is non-zero, UpdateQueuedSong() and OnModified()
+	 * will be postponed until the outermost CommitBulk().  Bulk
+	 * edits nest so a whole command list can be wrapped in one
+	 * while the individual commands use their own.
 	 */
-	bool bulk_edit;
+	unsigned bulk_edit;
 
 	/**
 	 * Has the queue been modified during bulk edit mode?
 	 */
 	bool bulk_modified;
 
+	/**
+	 * The first order number of the songs appended during bulk
+	 * edit mode, or -1 if there are none.  Instead of shuffling
+	 * each song individually (which is quadratic), AppendSong()
+	 * postpones the shuffle in random mode, and CommitBulk()
+	 * shuffles the whole appended range in one pass.
+	 */
+	int bulk_shuffle_start;
+
 	/**
 	 * Number of errors since playback was started.  If this
 	 * number exceeds the length of the playlist, MPD gives up,
@@ -96,7 +107,7 @@ struct playlist {
 		:queue(max_length),
 		 listener(_listener),
 		 playing(false),
-		 bulk_edit(false),
+		 bulk_edit(0),
 		 current(-1), queued(-1) {
 	}
 
@@ -208,6 +219,15 @@ public:
 	 * The database has been modified.  Pull all updates.
 	 */
 	void DatabaseModified(const Database &db);
+
+	/**
+	 * Like DatabaseModified(), but the given song URIs are known
+	 * to cover all modifications: instead of re-resolving every
+	 * queued song against the database, only queue entries
+	 * matching one of the URIs are refreshed.
+	 */
+	void DatabaseSongsChanged(const Database &db,
+				  const std::vector<std::string> &uris);
 #endif
 
 	/**
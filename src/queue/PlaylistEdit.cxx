@@ -62,21 +62,35 @@ playlist::Clear(PlayerControl &pc)
 void
 playlist::BeginBulk()
 {
-	assert(!bulk_edit);
+	if (bulk_edit++ > 0)
+		/* already in bulk edit mode (e.g. an "add" command
+		   inside a command list which is itself one big bulk
+		   edit) */
+		return;
 
-	bulk_edit = true;
 	bulk_modified = false;
+	bulk_shuffle_start = -1;
 }
 
 void
 playlist::CommitBulk(PlayerControl &pc)
 {
-	assert(bulk_edit);
+	assert(bulk_edit > 0);
+
+	if (--bulk_edit > 0)
+		/* still inside the outer bulk edit */
+		return;
 
-	bulk_edit = false;
 	if (!bulk_modified)
 		return;
 
+	if (bulk_shuffle_start >= 0 &&
+	    (unsigned)bulk_shuffle_start < queue.GetLength())
+		/* do the shuffle postponed by AppendSong(): one pass
+		   over the whole appended range */
+		queue.ShuffleOrderRangeWithPriority(bulk_shuffle_start,
+						    queue.GetLength());
+
 	if (queued < 0)
 		/* if no song was queued, UpdateQueuedSong() is being
 		   ignored in "bulk" edit mode; now that we have
@@ -110,7 +124,15 @@ playlist::AppendSong(PlayerControl &pc, DetachedSong &&song)
 			start = queued + 1;
 		else
 			start = current + 1;
-		if (start < queue.GetLength())
+
+		if (bulk_edit) {
+			/* postponed to CommitBulk(): shuffling each
+			   song individually scans the whole order
+			   list and would make a bulk load
+			   quadratic */
+			if (bulk_shuffle_start < 0)
+				bulk_shuffle_start = start;
+		} else if (start < queue.GetLength())
 			queue.ShuffleOrderLastWithPriority(start, queue.GetLength());
 	}
 
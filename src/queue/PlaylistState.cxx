@@ -59,7 +59,7 @@
 
 void
 playlist_state_save(BufferedOutputStream &os, const struct playlist &playlist,
-		    PlayerControl &pc)
+		    PlayerControl &pc, bool save_queue)
 {
 	const auto player_status = pc.LockGetStatus();
 
@@ -95,9 +95,11 @@ playlist_state_save(BufferedOutputStream &os, const struct playlist &playlist,
 	os.Format(PLAYLIST_STATE_FILE_MIXRAMPDB "%f\n", pc.GetMixRampDb());
 	os.Format(PLAYLIST_STATE_FILE_MIXRAMPDELAY "%f\n",
 		  pc.GetMixRampDelay().count());
-	os.Write(PLAYLIST_STATE_FILE_PLAYLIST_BEGIN "\n");
-	queue_save(os, playlist.queue);
-	os.Write(PLAYLIST_STATE_FILE_PLAYLIST_END "\n");
+	if (save_queue) {
+		os.Write(PLAYLIST_STATE_FILE_PLAYLIST_BEGIN "\n");
+		queue_save(os, playlist.queue);
+		os.Write(PLAYLIST_STATE_FILE_PLAYLIST_END "\n");
+	}
 }
 
 static void
@@ -32,9 +32,13 @@ class TextFile;
 class BufferedOutputStream;
 class SongLoader;
 
+/**
+ * @param save_queue save the queue contents inline?  Pass false if
+ * the queue is saved to a separate file (see StateFile::WriteQueue())
+ */
 void
 playlist_state_save(BufferedOutputStream &os, const playlist &playlist,
-		    PlayerControl &pc);
+		    PlayerControl &pc, bool save_queue=true);
 
 bool
 playlist_state_restore(const StateFileConfig &config,
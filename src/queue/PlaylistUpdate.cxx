@@ -70,3 +70,21 @@ playlist::DatabaseModified(const Database &db)
 	if (modified)
 		OnModified();
 }
+
+void
+playlist::DatabaseSongsChanged(const Database &db,
+			       const std::vector<std::string> &uris)
+{
+	bool modified = false;
+
+	for (const auto &uri : uris)
+		queue.ForEachPositionByUri(uri.c_str(), [&](unsigned position){
+				if (UpdatePlaylistSong(db, queue.Get(position))) {
+					queue.ModifyAtPosition(position);
+					modified = true;
+				}
+			});
+
+	if (modified)
+		OnModified();
+}
@@ -20,6 +20,9 @@
 #include "Queue.hxx"
 #include "song/DetachedSong.hxx"
 
+#include <algorithm>
+#include <memory>
+
 Queue::Queue(unsigned _max_length) noexcept
 	:max_length(_max_length),
 	 items(new Item[max_length]),
@@ -62,10 +65,44 @@ Queue::IncrementVersion() noexcept
 
 	if (version >= max) {
 		for (unsigned i = 0; i < length; i++)
-			items[i].version = 0;
+			ItemAtPosition(i).version = 0;
 
 		version = 1;
+
+		/* the change log cannot represent the version reset
+		   (all items are "modified" now, forever); disable it
+		   until the queue is cleared */
+		change_log_n = 0;
+		change_log_head = 0;
+		change_log_since = UINT32_MAX;
+	}
+}
+
+bool
+Queue::CollectChangesSince(uint32_t since,
+			   std::vector<unsigned> &positions) const noexcept
+{
+	if (since == 0 || since > version || since < change_log_since)
+		/* not covered by the change log - the caller must
+		   scan the whole queue */
+		return false;
+
+	for (size_t i = 0; i < change_log_n; ++i) {
+		const auto &e = change_log[(change_log_head + i)
+					   % CHANGE_LOG_SIZE];
+		if (e.version >= since && IsValidPosition(e.position) &&
+		    IsNewerAtPosition(e.position, since))
+			/* verify with IsNewerAtPosition() because the
+			   entry may be stale, e.g. the position may
+			   meanwhile be occupied by an unmodified
+			   item */
+			positions.push_back(e.position);
 	}
+
+	std::sort(positions.begin(), positions.end());
+	positions.erase(std::unique(positions.begin(), positions.end()),
+			positions.end());
+	return true;
 }
 
 void
@@ -82,39 +119,80 @@ Queue::Append(DetachedSong &&song, uint8_t priority) noexcept
 {
 	assert(!IsFull());
 
+	if (length + gap_size >= max_length) {
+		/* no free slot left after the last item - close the
+		   gap to make room at the end */
+		MoveGapTo(length);
+		gap_size = 0;
+	}
+
 	const unsigned position = length++;
-	const unsigned id = id_table.Insert(position);
+	const unsigned physical = PhysicalPosition(position);
+	const unsigned id = id_table.Insert(physical);
 
-	auto &item = items[position];
+	auto &item = items[physical];
 	item.song = new DetachedSong(std::move(song));
 	item.id = id;
 	item.version = version;
 	item.priority = priority;
+	LogModification(position);
+
+	uri_index.emplace(item.song->GetURI(), id);
 
 	order[position] = position;
 
 	return id;
 }
 
+void
+Queue::MoveGapTo(unsigned position) noexcept
+{
+	assert(position <= length);
+
+	if (gap_size == 0) {
+		gap_start = position;
+		return;
+	}
+
+	while (gap_start < position) {
+		/* shift the item just after the gap down into it */
+		Item &item = items[gap_start];
+		item = items[gap_start + gap_size];
+		id_table.Move(item.id, gap_start);
+		++gap_start;
+	}
+
+	while (gap_start > position) {
+		/* shift the item just before the gap up behind it */
+		--gap_start;
+		Item &item = items[gap_start + gap_size];
+		item = items[gap_start];
+		id_table.Move(item.id, gap_start + gap_size);
+	}
+}
+
 void
 Queue::SwapPositions(unsigned position1, unsigned position2) noexcept
 {
-	unsigned id1 = items[position1].id;
-	unsigned id2 = items[position2].id;
+	const unsigned physical1 = PhysicalPosition(position1);
+	const unsigned physical2 = PhysicalPosition(position2);
+
+	unsigned id1 = items[physical1].id;
+	unsigned id2 = items[physical2].id;
 
-	std::swap(items[position1], items[position2]);
+	std::swap(items[physical1], items[physical2]);
 
-	items[position1].version = version;
-	items[position2].version = version;
+	ModifyAtPosition(position1);
+	ModifyAtPosition(position2);
 
-	id_table.Move(id1, position2);
-	id_table.Move(id2, position1);
+	id_table.Move(id1, physical2);
+	id_table.Move(id2, physical1);
 }
 
 void
 Queue::MovePostion(unsigned from, unsigned to) noexcept
 {
-	const Item tmp = items[from];
+	const Item tmp = ItemAtPosition(from);
 
 	/* move songs to one less in from->to */
 
@@ -128,9 +206,9 @@ Queue::MovePostion(unsigned from, unsigned to) noexcept
 
 	/* put song at _to_ */
 
-	id_table.Move(tmp.id, to);
-	items[to] = tmp;
-	items[to].version = version;
+	id_table.Move(tmp.id, PhysicalPosition(to));
+	ItemAtPosition(to) = tmp;
+	ModifyAtPosition(to);
 
 	/* now deal with order */
 
@@ -153,7 +231,7 @@ Queue::MoveRange(unsigned start, unsigned end, unsigned to) noexcept
 	Item tmp[end - start];
 	// Copy the original block [start,end-1]
 	for (unsigned i = start; i < end; i++)
-		tmp[i - start] = items[i];
+		tmp[i - start] = ItemAtPosition(i);
 
 	// If to > start, we need to move to-start items to start, starting from end
 	for (unsigned i = end; i < end + to - start; i++)
@@ -168,9 +246,10 @@ Queue::MoveRange(unsigned start, unsigned end, unsigned to) noexcept
 	// Copy the original block back in, starting at to.
 	for (unsigned i = start; i< end; i++)
 	{
-		id_table.Move(tmp[i - start].id, to + i - start);
-		items[to + i - start] = tmp[i-start];
-		items[to + i - start].version = version;
+		id_table.Move(tmp[i - start].id,
+			      PhysicalPosition(to + i - start));
+		ItemAtPosition(to + i - start) = tmp[i-start];
+		ModifyAtPosition(to + i - start);
 	}
 
 	if (random) {
@@ -232,21 +311,41 @@ Queue::DeletePosition(unsigned position) noexcept
 {
 	assert(position < length);
 
-	delete items[position].song;
+	/* remove the entry from the URI index; other ids may be
+	   mapped to the same URI */
+
+	{
+		const auto r = uri_index.equal_range(ItemAtPosition(position).song->GetURI());
+		for (auto i = r.first; i != r.second; ++i)
+			if (i->second == ItemAtPosition(position).id) {
+				uri_index.erase(i);
+				break;
+			}
+	}
+
+	delete ItemAtPosition(position).song;
 
 	const unsigned id = PositionToId(position);
 	const unsigned _order = PositionToOrder(position);
 
+	/* instead of shifting the whole songs array, grow the gap
+	   over the deleted slot; the items behind it keep their
+	   physical slots and id table entries */
+
+	MoveGapTo(position);
+	++gap_size;
 	--length;
 
-	/* release the song id */
+	/* release the song id (only after MoveGapTo(), which may
+	   have moved the slot physically) */
 
 	id_table.Erase(id);
 
-	/* delete song from songs array */
+	/* the logical positions of all following items have shifted
+	   down by one; this must still be recorded for "plchanges" */
 
 	for (unsigned i = position; i < length; i++)
-		MoveItemTo(i + 1, i);
+		ModifyAtPosition(i);
 
 	/* delete the entry from the order array */
 
@@ -264,14 +363,25 @@ void
 Queue::Clear() noexcept
 {
 	for (unsigned i = 0; i < length; i++) {
-		Item *item = &items[i];
+		Item *item = &ItemAtPosition(i);
 
 		delete item->song;
 
 		id_table.Erase(item->id);
 	}
 
+	uri_index.clear();
+
 	length = 0;
+	gap_start = 0;
+	gap_size = 0;
+
+	/* with the queue empty, every future modification will be
+	   recorded, so the change log is now complete for all
+	   versions */
+	change_log_n = 0;
+	change_log_head = 0;
+	change_log_since = 1;
 }
 
 static void
@@ -283,14 +393,53 @@ queue_sort_order_by_priority(Queue *queue,
 	assert(start <= end);
 	assert(end <= queue->length);
 
-	auto cmp = [queue](unsigned a_pos, unsigned b_pos){
-		const Queue::Item &a = queue->items[a_pos];
-		const Queue::Item &b = queue->items[b_pos];
+	const unsigned n = end - start;
+
+	if (n < 64) {
+		/* not worth the bucket setup overhead */
+
+		auto cmp = [queue](unsigned a_pos, unsigned b_pos){
+			const Queue::Item &a = queue->ItemAtPosition(a_pos);
+			const Queue::Item &b = queue->ItemAtPosition(b_pos);
+
+			return a.priority > b.priority;
+		};
 
-		return a.priority > b.priority;
-	};
+		std::stable_sort(queue->order + start, queue->order + end,
+				 cmp);
+		return;
+	}
+
+	/* a stable counting sort: since the sort key is only 8 bits
+	   wide, grouping by priority needs just two linear passes
+	   over the range instead of a O(n log n) comparison sort */
+
+	constexpr unsigned N_PRIORITIES = 256;
+	unsigned counts[N_PRIORITIES]{};
+
+	for (unsigned i = start; i != end; ++i)
+		++counts[queue->ItemAtPosition(queue->order[i]).priority];
+
+	/* turn the counts into output offsets; higher priorities
+	   sort first */
 
-	std::stable_sort(queue->order + start, queue->order + end, cmp);
+	unsigned offset = 0;
+	for (unsigned p = N_PRIORITIES; p > 0;) {
+		--p;
+
+		const unsigned count = counts[p];
+		counts[p] = offset;
+		offset += count;
+	}
+
+	const std::unique_ptr<unsigned[]> tmp(new unsigned[n]);
+	for (unsigned i = start; i != end; ++i) {
+		const unsigned position = queue->order[i];
+		const uint8_t priority = queue->ItemAtPosition(position).priority;
+		tmp[counts[priority]++] = position;
+	}
+
+	std::copy_n(tmp.get(), n, queue->order + start);
 }
 
 void
@@ -366,8 +515,8 @@ Queue::ShuffleOrderLastWithPriority(unsigned start, unsigned end) noexcept
 	/* skip all items at the start which have a higher priority,
 	   because the last item shall only be shuffled within its
 	   priority group */
-	const auto last_priority = items[OrderToPosition(end - 1)].priority;
-	while (items[OrderToPosition(start)].priority != last_priority) {
+	const auto last_priority = GetOrderPriority(end - 1);
+	while (GetOrderPriority(start) != last_priority) {
 		++start;
 		assert(start < end);
 	}
@@ -403,7 +552,7 @@ Queue::FindPriorityOrder(unsigned start_order, uint8_t priority,
 
 	for (unsigned i = start_order; i < length; ++i) {
 		const unsigned position = OrderToPosition(i);
-		const Item *item = &items[position];
+		const Item *item = &ItemAtPosition(position);
 		if (item->priority <= priority && i != exclude_order)
 			return i;
 	}
@@ -419,7 +568,7 @@ Queue::CountSamePriority(unsigned start_order, uint8_t priority) const noexcept
 
 	for (unsigned i = start_order; i < length; ++i) {
 		const unsigned position = OrderToPosition(i);
-		const Item *item = &items[position];
+		const Item *item = &ItemAtPosition(position);
 		if (item->priority != priority)
 			return i - start_order;
 	}
@@ -433,12 +582,12 @@ Queue::SetPriority(unsigned position, uint8_t priority, int after_order,
 {
 	assert(position < length);
 
-	Item *item = &items[position];
+	Item *item = &ItemAtPosition(position);
 	uint8_t old_priority = item->priority;
 	if (old_priority == priority)
 		return false;
 
-	item->version = version;
+	ModifyAtPosition(position);
 	item->priority = priority;
 
 	if (!random || !reorder)
@@ -460,7 +609,7 @@ Queue::SetPriority(unsigned position, uint8_t priority, int after_order,
 			const unsigned after_position =
 				OrderToPosition(after_order);
 			const Item *after_item =
-				&items[after_position];
+				&ItemAtPosition(after_position);
 			if (priority <= old_priority ||
 			    priority <= after_item->priority)
 				/* priority hasn't become bigger */
@@ -26,6 +26,9 @@
 #include "util/LazyRandomEngine.hxx"
 
 #include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <assert.h>
 #include <stdint.h>
@@ -82,12 +85,39 @@ struct Queue {
 	/** all songs in "position" order */
 	Item *const items;
 
+	/**
+	 * The #items array is a gap buffer: the physical slots
+	 * [gap_start, gap_start + gap_size) are unused, and items at
+	 * positions >= #gap_start live #gap_size slots further up.
+	 * Deleting an item only needs to move the gap next to it and
+	 * grow it over the slot, instead of shifting the whole array
+	 * and rewriting the #IdTable entry of every shifted item;
+	 * repeated deletes from the head (the "consume" pattern) thus
+	 * touch only one item each.
+	 *
+	 * This is the physical index of the first free slot;
+	 * invariant: gap_start <= length.
+	 */
+	unsigned gap_start = 0;
+
+	/** the number of free slots in the gap */
+	unsigned gap_size = 0;
+
 	/** map order numbers to positions */
 	unsigned *const order;
 
 	/** map song ids to positions */
 	IdTable id_table;
 
+	/**
+	 * Maps each song's URI to its queue id (ids are used instead
+	 * of positions because they are stable across moves and
+	 * shuffles).  This allows refreshing only the affected
+	 * entries after a database update, instead of scanning the
+	 * whole queue; see ForEachPositionByUri().
+	 */
+	std::unordered_multimap<std::string, unsigned> uri_index;
+
 	/** repeat playback when the end of the queue has been
 	    reached? */
 	bool repeat = false;
@@ -104,6 +134,37 @@ struct Queue {
 	/** random number generator for shuffle and random mode */
 	LazyRandomEngine rand;
 
+	/**
+	 * An entry of #change_log.
+	 */
+	struct ChangeLogEntry {
+		uint32_t version;
+		uint32_t position;
+	};
+
+	static constexpr size_t CHANGE_LOG_SIZE = 1024;
+
+	/**
+	 * A ring buffer of recently modified positions in
+	 * chronological order.  It allows answering "plchanges"
+	 * requests in O(changes) instead of scanning the whole queue;
+	 * see CollectChangesSince().
+	 */
+	ChangeLogEntry change_log[CHANGE_LOG_SIZE];
+
+	/** the index of the oldest entry in #change_log */
+	size_t change_log_head = 0;
+
+	/** the number of entries in #change_log */
+	size_t change_log_n = 0;
+
+	/**
+	 * The oldest "since" version which #change_log covers
+	 * completely.  Requests for older versions must fall back to
+	 * a full queue scan.
+	 */
+	uint32_t change_log_since = 1;
+
 	explicit Queue(unsigned max_length) noexcept;
 
 	/**
@@ -151,14 +212,52 @@ struct Queue {
 		return _order < length;
 	}
 
+	/**
+	 * Translate a queue position to its physical index in the
+	 * #items gap buffer.
+	 */
+	gcc_pure
+	unsigned PhysicalPosition(unsigned position) const noexcept {
+		assert(position < length);
+
+		return position < gap_start
+			? position
+			: position + gap_size;
+	}
+
+	/**
+	 * Translate a physical #items index back to the queue
+	 * position.
+	 */
+	gcc_pure
+	unsigned LogicalPosition(unsigned physical) const noexcept {
+		assert(physical < gap_start ||
+		       physical >= gap_start + gap_size);
+
+		return physical < gap_start
+			? physical
+			: physical - gap_size;
+	}
+
+	Item &ItemAtPosition(unsigned position) noexcept {
+		return items[PhysicalPosition(position)];
+	}
+
+	const Item &ItemAtPosition(unsigned position) const noexcept {
+		return items[PhysicalPosition(position)];
+	}
+
 	int IdToPosition(unsigned id) const noexcept {
-		return id_table.IdToPosition(id);
+		int physical = id_table.IdToPosition(id);
+		return physical >= 0
+			? int(LogicalPosition(physical))
+			: -1;
 	}
 
 	int PositionToId(unsigned position) const noexcept {
 		assert(position < length);
 
-		return items[position].id;
+		return ItemAtPosition(position).id;
 	}
 
 	gcc_pure
@@ -184,13 +283,13 @@ struct Queue {
 	uint8_t GetPriorityAtPosition(unsigned position) const noexcept {
 		assert(position < length);
 
-		return items[position].priority;
+		return ItemAtPosition(position).priority;
 	}
 
 	const Item &GetOrderItem(unsigned i) const noexcept {
 		assert(IsValidOrder(i));
 
-		return items[OrderToPosition(i)];
+		return ItemAtPosition(OrderToPosition(i));
 	}
 
 	uint8_t GetOrderPriority(unsigned i) const noexcept {
@@ -203,7 +302,7 @@ struct Queue {
 	DetachedSong &Get(unsigned position) const noexcept {
 		assert(position < length);
 
-		return *items[position].song;
+		return *ItemAtPosition(position).song;
 	}
 
 	/**
@@ -221,9 +320,10 @@ struct Queue {
 			       uint32_t _version) const noexcept {
 		assert(position < length);
 
+		const Item &item = ItemAtPosition(position);
 		return _version > version ||
-			items[position].version >= _version ||
-			items[position].version == 0;
+			item.version >= _version ||
+			item.version == 0;
 	}
 
 	/**
@@ -241,6 +341,64 @@ struct Queue {
 	 */
 	void IncrementVersion() noexcept;
 
+	/**
+	 * Record a modification of the specified position in
+	 * #change_log.
+	 */
+	void LogModification(unsigned position) noexcept {
+		if (change_log_n > 0) {
+			const auto &last = change_log[(change_log_head + change_log_n - 1)
+						      % CHANGE_LOG_SIZE];
+			if (last.version == version &&
+			    last.position == position)
+				/* duplicate of the newest entry */
+				return;
+		}
+
+		if (change_log_n == CHANGE_LOG_SIZE) {
+			/* the ring is full: drop the oldest entry;
+			   the log now only covers versions after
+			   it */
+			change_log_since =
+				change_log[change_log_head].version + 1;
+			change_log_head = (change_log_head + 1)
+				% CHANGE_LOG_SIZE;
+			--change_log_n;
+		}
+
+		auto &e = change_log[(change_log_head + change_log_n)
+				     % CHANGE_LOG_SIZE];
+		e.version = version;
+		e.position = position;
+		++change_log_n;
+	}
+
+	/**
+	 * Collect all positions which have been modified since the
+	 * given version from #change_log, sorted and deduplicated.
+	 *
+	 * @return true on success, false if the log does not cover
+	 * the given version and the caller must fall back to a full
+	 * queue scan
+	 */
+	bool CollectChangesSince(uint32_t since,
+				 std::vector<unsigned> &positions) const noexcept;
+
+	/**
+	 * Invoke the given function for the position of each item
+	 * whose song has the specified URI.
+	 */
+	template<typename F>
+	void ForEachPositionByUri(const char *uri, F &&f) const {
+		const auto r = uri_index.equal_range(uri);
+		for (auto i = r.first; i != r.second; ++i) {
+			int position = IdToPosition(i->second);
+			assert(position >= 0);
+
+			f(unsigned(position));
+		}
+	}
+
 	/**
 	 * Marks the specified song as "modified".  Call
 	 * IncrementVersion() after all modifications have been made.
@@ -249,7 +407,8 @@ struct Queue {
 	void ModifyAtPosition(unsigned position) noexcept {
 		assert(position < length);
 
-		items[position].version = version;
+		ItemAtPosition(position).version = version;
+		LogModification(position);
 	}
 
 	/**
@@ -379,13 +538,21 @@ struct Queue {
 
 private:
 	void MoveItemTo(unsigned from, unsigned to) noexcept {
-		unsigned from_id = items[from].id;
+		unsigned from_id = ItemAtPosition(from).id;
 
-		items[to] = items[from];
-		items[to].version = version;
-		id_table.Move(from_id, to);
+		ItemAtPosition(to) = ItemAtPosition(from);
+		ModifyAtPosition(to);
+		id_table.Move(from_id, PhysicalPosition(to));
 	}
 
+	/**
+	 * Move the gap of the #items buffer right before the given
+	 * position.  The cost is proportional to the distance from
+	 * the gap's current place; positions and versions are not
+	 * affected.
+	 */
+	void MoveGapTo(unsigned position) noexcept;
+
 	/**
 	 * Find the first item that has this specified priority or
 	 * higher.
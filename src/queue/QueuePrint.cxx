@@ -25,6 +25,8 @@
 #include "song/LightSong.hxx"
 #include "client/Response.hxx"
 
+#include <vector>
+
 /**
  * Send detailed information about a range of songs in the queue to a
  * client.
@@ -38,12 +40,12 @@ queue_print_song_info(Response &r, const Queue &queue,
 		      unsigned position)
 {
 	song_print_info(r, queue.Get(position));
-	r.Format("Pos: %u\nId: %u\n",
-		 position, queue.PositionToId(position));
+	r.WritePair("Pos", position);
+	r.WritePair("Id", queue.PositionToId(position));
 
 	uint8_t priority = queue.GetPriorityAtPosition(position);
 	if (priority != 0)
-		r.Format("Prio: %u\n", priority);
+		r.WritePair("Prio", unsigned(priority));
 }
 
 void
@@ -83,6 +85,14 @@ queue_print_changes_info(Response &r, const Queue &queue,
 	if (end > queue.GetLength())
 		end = queue.GetLength();
 
+	std::vector<unsigned> positions;
+	if (queue.CollectChangesSince(version, positions)) {
+		for (unsigned i : positions)
+			if (i >= start && i < end)
+				queue_print_song_info(r, queue, i);
+		return;
+	}
+
 	for (unsigned i = start; i < end; i++)
 		if (queue.IsNewerAtPosition(i, version))
 			queue_print_song_info(r, queue, i);
@@ -101,10 +111,21 @@ queue_print_changes_position(Response &r, const Queue &queue,
 	if (end > queue.GetLength())
 		end = queue.GetLength();
 
+	std::vector<unsigned> positions;
+	if (queue.CollectChangesSince(version, positions)) {
+		for (unsigned i : positions)
+			if (i >= start && i < end) {
+				r.WritePair("cpos", i);
+				r.WritePair("Id", queue.PositionToId(i));
+			}
+		return;
+	}
+
 	for (unsigned i = start; i < end; i++)
-		if (queue.IsNewerAtPosition(i, version))
-			r.Format("cpos: %i\nId: %i\n",
-				 i, queue.PositionToId(i));
+		if (queue.IsNewerAtPosition(i, version)) {
+			r.WritePair("cpos", i);
+			r.WritePair("Id", queue.PositionToId(i));
+		}
 }
 
 void
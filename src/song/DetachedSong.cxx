@@ -25,14 +25,35 @@
 DetachedSong::DetachedSong(const LightSong &other)
 	:uri(other.GetURI()),
 	 real_uri(other.real_uri != nullptr ? other.real_uri : ""),
-	 tag(other.tag),
+	 tag(std::make_shared<Tag>(other.tag)),
 	 mtime(other.mtime),
 	 start_time(other.start_time),
 	 end_time(other.end_time) {}
 
+static const Tag empty_tag;
+
+const Tag &
+DetachedSong::GetTag() const noexcept
+{
+	return tag != nullptr ? *tag : empty_tag;
+}
+
+Tag &
+DetachedSong::WritableTag()
+{
+	if (tag == nullptr)
+		tag = std::make_shared<Tag>();
+	else if (tag.use_count() > 1)
+		/* shared with other copies of this song: clone the
+		   payload before modifying it */
+		tag = std::make_shared<Tag>(*tag);
+
+	return *tag;
+}
+
 DetachedSong::operator LightSong() const noexcept
 {
-	LightSong result(uri.c_str(), tag);
+	LightSong result(uri.c_str(), GetTag());
 	result.directory = nullptr;
 	result.real_uri = real_uri.empty() ? nullptr : real_uri.c_str();
 	result.mtime = mtime;
@@ -68,10 +89,11 @@ DetachedSong::GetDuration() const noexcept
 {
 	SongTime a = start_time, b = end_time;
 	if (!b.IsPositive()) {
-		if (tag.duration.IsNegative())
-			return tag.duration;
+		const auto &duration = GetTag().duration;
+		if (duration.IsNegative())
+			return duration;
 
-		b = SongTime(tag.duration);
+		b = SongTime(duration);
 	}
 
 	return SignedSongTime(b - a);
@@ -25,6 +25,7 @@
 #include "util/Compiler.h"
 
 #include <chrono>
+#include <memory>
 #include <string>
 #include <utility>
 
@@ -59,7 +60,16 @@ class DetachedSong {
 	 */
 	std::string real_uri;
 
-	Tag tag;
+	/**
+	 * The song metadata.  This is a refcounted payload which is
+	 * shared by all copies of a song (e.g. the queue item, the
+	 * player's "next song" and the tag cache); it is cloned
+	 * lazily by WritableTag() before the first modification
+	 * (copy-on-write).  The tag strings themselves are interned
+	 * in the #tag_pool, i.e. they are shared with the song
+	 * database as well.  nullptr means the song has no tag.
+	 */
+	std::shared_ptr<Tag> tag;
 
 	/**
 	 * The time stamp of the last file modification.  A negative
@@ -92,7 +102,7 @@ public:
 	template<typename U>
 	DetachedSong(U &&_uri, Tag &&_tag)
 		:uri(std::forward<U>(_uri)),
-		 tag(std::move(_tag)) {}
+		 tag(std::make_shared<Tag>(std::move(_tag))) {}
 
 	/**
 	 * Copy data from a #LightSong instance.  Usually, you should
@@ -176,20 +186,23 @@ public:
 	gcc_pure
 	bool IsInDatabase() const noexcept;
 
-	const Tag &GetTag() const noexcept {
-		return tag;
-	}
+	gcc_pure
+	const Tag &GetTag() const noexcept;
 
-	Tag &WritableTag() noexcept {
-		return tag;
-	}
+	/**
+	 * Returns a writable reference to the tag.  If the payload is
+	 * shared with other copies of this song, it is cloned first,
+	 * so the modifications do not affect the other copies
+	 * (copy-on-write).
+	 */
+	Tag &WritableTag();
 
 	void SetTag(const Tag &_tag) {
-		tag = Tag(_tag);
+		tag = std::make_shared<Tag>(_tag);
 	}
 
 	void SetTag(Tag &&_tag) {
-		tag = std::move(_tag);
+		tag = std::make_shared<Tag>(std::move(_tag));
 	}
 
 	void MoveTagFrom(DetachedSong &&other) {
@@ -201,7 +214,7 @@ public:
 	 * array.
 	 */
 	void MoveTagItemsFrom(DetachedSong &&other) {
-		tag.MoveItemsFrom(std::move(other.tag));
+		WritableTag().MoveItemsFrom(std::move(other.WritableTag()));
 	}
 
 	std::chrono::system_clock::time_point GetLastModified() const {
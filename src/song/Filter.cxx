@@ -396,6 +396,9 @@ SongFilter::Parse(ConstBuffer<const char *> args, bool fold_case)
 	if (args.empty())
 		throw std::runtime_error("Incorrect number of filter arguments");
 
+	/* adding clauses invalidates the compiled program */
+	program.clear();
+
 	do {
 		if (*args.front() == '(') {
 			const char *s = args.shift();
@@ -421,11 +424,28 @@ void
 SongFilter::Optimize() noexcept
 {
 	OptimizeSongFilter(and_filter);
+
+	/* "compile" the optimized tree: flatten the clauses into a
+	   contiguous array which Match() can evaluate in a tight
+	   loop */
+	program.clear();
+	program.reserve(std::distance(and_filter.GetItems().begin(),
+				      and_filter.GetItems().end()));
+	for (const auto &i : and_filter.GetItems())
+		program.push_back(i.get());
 }
 
 bool
 SongFilter::Match(const LightSong &song) const noexcept
 {
+	if (!program.empty()) {
+		for (const auto *i : program)
+			if (!i->Match(song))
+				return false;
+
+		return true;
+	}
+
 	return and_filter.Match(song);
 }
 
@@ -497,5 +517,6 @@ SongFilter::WithoutBasePrefix(const char *_prefix) const noexcept
 		result.and_filter.AddItem(i->Clone());
 	}
 
+	result.Optimize();
 	return result;
 }
@@ -24,6 +24,7 @@
 #include "util/Compiler.h"
 
 #include <string>
+#include <vector>
 
 #include <stdint.h>
 
@@ -39,6 +40,16 @@ struct LightSong;
 class SongFilter {
 	AndSongFilter and_filter;
 
+	/**
+	 * The "compiled" form of #and_filter: a contiguous array of
+	 * pointers to its clauses (which remain owned by
+	 * #and_filter), rebuilt by Optimize().  Match() evaluates it
+	 * in a tight loop instead of walking the std::list.  Empty
+	 * if Optimize() has not been called or if the filter was
+	 * modified afterwards.
+	 */
+	std::vector<const ISongFilter *> program;
+
 public:
 	SongFilter() = default;
 
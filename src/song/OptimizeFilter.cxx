@@ -19,9 +19,41 @@
 
 #include "OptimizeFilter.hxx"
 #include "AndSongFilter.hxx"
+#include "AudioFormatSongFilter.hxx"
+#include "BaseSongFilter.hxx"
+#include "ModifiedSinceSongFilter.hxx"
 #include "NotSongFilter.hxx"
 #include "TagSongFilter.hxx"
 #include "UriSongFilter.hxx"
+#include "tag/Type.h"
+
+/**
+ * Estimate how expensive it is to evaluate the given filter for one
+ * song.  This is used to sort the clauses of an #AndSongFilter so
+ * the cheap ones run (and hopefully mismatch) first.
+ */
+gcc_pure
+static unsigned
+SongFilterCost(const ISongFilter &f) noexcept
+{
+	if (dynamic_cast<const ModifiedSinceSongFilter *>(&f) != nullptr ||
+	    dynamic_cast<const AudioFormatSongFilter *>(&f) != nullptr)
+		/* a plain comparison */
+		return 0;
+
+	if (dynamic_cast<const UriSongFilter *>(&f) != nullptr ||
+	    dynamic_cast<const BaseSongFilter *>(&f) != nullptr)
+		/* one string comparison */
+		return 1;
+
+	if (const auto *tf = dynamic_cast<const TagSongFilter *>(&f))
+		/* scans all tag items; matching "any" tag is the
+		   most expensive */
+		return tf->GetTagType() != TAG_NUM_OF_ITEM_TYPES ? 2 : 3;
+
+	/* unknown (e.g. #NotSongFilter) */
+	return 4;
+}
 
 void
 OptimizeSongFilter(AndSongFilter &af) noexcept
@@ -37,6 +69,12 @@ OptimizeSongFilter(AndSongFilter &af) noexcept
 			++i;
 		}
 	}
+
+	/* evaluate cheap clauses first; "and" is commutative, and
+	   all matches are pure, so this does not change the result */
+	af.items.sort([](const ISongFilterPtr &a, const ISongFilterPtr &b){
+		return SongFilterCost(*a) < SongFilterCost(*b);
+	});
 }
 
 ISongFilterPtr
@@ -46,8 +46,40 @@ StringFilter::MatchWithoutNegation(const char *s) const noexcept
 	}
 }
 
+inline bool
+StringFilter::MatchWithoutNegation(const char *s,
+				   const char *folded) const noexcept
+{
+#if !CLANG_CHECK_VERSION(3,6)
+	/* disabled on clang due to -Wtautological-pointer-compare */
+	assert(s != nullptr);
+	assert(folded != nullptr);
+#endif
+
+#ifdef HAVE_PCRE
+	if (regex)
+		return regex->Match(s);
+#endif
+
+	if (fold_case) {
+		return substring
+			? fold_case.IsInFolded(folded)
+			: fold_case.EqualsFolded(folded);
+	} else {
+		return substring
+			? StringFind(s, value.c_str()) != nullptr
+			: value == s;
+	}
+}
+
 bool
 StringFilter::Match(const char *s) const noexcept
 {
 	return MatchWithoutNegation(s) != negated;
 }
+
+bool
+StringFilter::Match(const char *s, const char *folded) const noexcept
+{
+	return MatchWithoutNegation(s, folded) != negated;
+}
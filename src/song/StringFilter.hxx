@@ -105,9 +105,22 @@ public:
 	gcc_pure
 	bool Match(const char *s) const noexcept;
 
+	/**
+	 * Like Match(), but with a pre-computed case-folded copy of
+	 * #s (e.g. the shadow stored by the tag pool, see
+	 * tag_item_folded_value()), so case-insensitive matching does
+	 * not need to fold the candidate again.
+	 */
+	gcc_pure
+	bool Match(const char *s, const char *folded) const noexcept;
+
 private:
 	gcc_pure
 	bool MatchWithoutNegation(const char *s) const noexcept;
+
+	gcc_pure
+	bool MatchWithoutNegation(const char *s,
+				  const char *folded) const noexcept;
 };
 
 #endif
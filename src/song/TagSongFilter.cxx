@@ -22,6 +22,7 @@
 #include "LightSong.hxx"
 #include "tag/Tag.hxx"
 #include "tag/Fallback.hxx"
+#include "tag/Pool.hxx"
 
 std::string
 TagSongFilter::ToExpression() const noexcept
@@ -38,7 +39,7 @@ bool
 TagSongFilter::MatchNN(const TagItem &item) const noexcept
 {
 	return (type == TAG_NUM_OF_ITEM_TYPES || item.type == type) &&
-		filter.Match(item.value);
+		filter.Match(item.value, tag_item_folded_value(&item));
 }
 
 bool
@@ -63,7 +64,8 @@ TagSongFilter::MatchNN(const Tag &tag) const noexcept
 
 			     for (const auto &item : tag) {
 				     if (item.type == tag2 &&
-					 filter.Match(item.value)) {
+					 filter.Match(item.value,
+						      tag_item_folded_value(&item))) {
 					     result = true;
 					     break;
 				     }
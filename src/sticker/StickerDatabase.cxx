@@ -27,6 +27,7 @@
 
 #include <string>
 #include <map>
+#include <unordered_map>
 
 #include <assert.h>
 
@@ -34,11 +35,67 @@ struct Sticker {
 	std::map<std::string, std::string> table;
 };
 
+/**
+ * A write-through cache of single sticker values, so that repeated
+ * sticker_load_value() calls for the same object (e.g. event scripts
+ * polling a play counter) do not query SQLite each time.  The key is
+ * type, uri and name joined by null bytes; negative results are
+ * cached as empty strings, which is exactly what the lookup returns
+ * anyway.
+ *
+ * Like the rest of this library, the cache is not thread-safe; all
+ * sticker calls happen in the main thread.
+ */
+static std::unordered_map<std::string, std::string> sticker_cache;
+
+/**
+ * When the cache grows this large, it is discarded completely; a
+ * crude but sufficient bound, because a working set of hot stickers
+ * is much smaller.
+ */
+static constexpr size_t STICKER_CACHE_MAX = 8192;
+
+static std::string
+sticker_cache_key(const char *type, const char *uri,
+		  const char *name) noexcept
+{
+	std::string key(type);
+	key.push_back('\0');
+	key.append(uri);
+	key.push_back('\0');
+	key.append(name);
+	return key;
+}
+
+static void
+sticker_cache_put(std::string &&key, const char *value) noexcept
+{
+	if (sticker_cache.size() >= STICKER_CACHE_MAX)
+		sticker_cache.clear();
+
+	sticker_cache[std::move(key)] = value;
+}
+
+/**
+ * Removes all cached values of one object, i.e. all names of the
+ * given type/uri pair.
+ */
+static void
+sticker_cache_erase_object(const char *type, const char *uri) noexcept
+{
+	const std::string prefix = sticker_cache_key(type, uri, "");
+
+	for (auto i = sticker_cache.begin(); i != sticker_cache.end();)
+		if (i->first.compare(0, prefix.length(), prefix) == 0)
+			i = sticker_cache.erase(i);
+		else
+			++i;
+}
+
 enum sticker_sql {
 	STICKER_SQL_GET,
 	STICKER_SQL_LIST,
-	STICKER_SQL_UPDATE,
-	STICKER_SQL_INSERT,
+	STICKER_SQL_REPLACE,
 	STICKER_SQL_DELETE,
 	STICKER_SQL_DELETE_VALUE,
 	STICKER_SQL_FIND,
@@ -52,10 +109,8 @@ static const char *const sticker_sql[] = {
 	"SELECT value FROM sticker WHERE type=? AND uri=? AND name=?",
 	//[STICKER_SQL_LIST] =
 	"SELECT name,value FROM sticker WHERE type=? AND uri=?",
-	//[STICKER_SQL_UPDATE] =
-	"UPDATE sticker SET value=? WHERE type=? AND uri=? AND name=?",
-	//[STICKER_SQL_INSERT] =
-	"INSERT INTO sticker(type,uri,name,value) VALUES(?, ?, ?, ?)",
+	//[STICKER_SQL_REPLACE] =
+	"INSERT OR REPLACE INTO sticker(type,uri,name,value) VALUES(?, ?, ?, ?)",
 	//[STICKER_SQL_DELETE] =
 	"DELETE FROM sticker WHERE type=? AND uri=?",
 	//[STICKER_SQL_DELETE_VALUE] =
@@ -116,6 +171,17 @@ sticker_global_init(Path path)
 				   utf8 + "'").c_str());
 	}
 
+	/* write-ahead logging keeps readers and the writer from
+	   blocking each other, and with synchronous=NORMAL, a commit
+	   no longer waits for fsync(); failure to enable it (e.g. on
+	   a network file system) is not fatal, SQLite then keeps the
+	   default rollback journal */
+
+	sqlite3_exec(sticker_db,
+		     "PRAGMA journal_mode=WAL;"
+		     "PRAGMA synchronous=NORMAL;",
+		     nullptr, nullptr, nullptr);
+
 	/* create the table and index */
 
 	ret = sqlite3_exec(sticker_db, sticker_sql_create,
@@ -147,6 +213,8 @@ sticker_global_finish()
 	}
 
 	sqlite3_close(sticker_db);
+
+	sticker_cache.clear();
 }
 
 bool
@@ -168,6 +236,11 @@ sticker_load_value(const char *type, const char *uri, const char *name)
 	if (StringIsEmpty(name))
 		return std::string();
 
+	auto key = sticker_cache_key(type, uri, name);
+	auto cached = sticker_cache.find(key);
+	if (cached != sticker_cache.end())
+		return cached->second;
+
 	BindAll(stmt, type, uri, name);
 
 	AtScopeExit(stmt) {
@@ -179,6 +252,8 @@ sticker_load_value(const char *type, const char *uri, const char *name)
 	if (ExecuteRow(stmt))
 		value = (const char*)sqlite3_column_text(stmt, 0);
 
+	sticker_cache_put(std::move(key), value.c_str());
+
 	return value;
 }
 
@@ -206,47 +281,20 @@ sticker_list_values(std::map<std::string, std::string> &table,
 		});
 }
 
-static bool
-sticker_update_value(const char *type, const char *uri,
-		     const char *name, const char *value)
+void
+sticker_store_value(const char *type, const char *uri,
+		    const char *name, const char *value)
 {
-	sqlite3_stmt *const stmt = sticker_stmt[STICKER_SQL_UPDATE];
-
-	assert(type != nullptr);
-	assert(uri != nullptr);
-	assert(name != nullptr);
-	assert(*name != 0);
-	assert(value != nullptr);
+	sqlite3_stmt *const stmt = sticker_stmt[STICKER_SQL_REPLACE];
 
 	assert(sticker_enabled());
-
-	BindAll(stmt, value, type, uri, name);
-
-	AtScopeExit(stmt) {
-		sqlite3_reset(stmt);
-		sqlite3_clear_bindings(stmt);
-	};
-
-	bool modified = ExecuteModified(stmt);
-
-	if (modified)
-		idle_add(IDLE_STICKER);
-	return modified;
-}
-
-static void
-sticker_insert_value(const char *type, const char *uri,
-		     const char *name, const char *value)
-{
-	sqlite3_stmt *const stmt = sticker_stmt[STICKER_SQL_INSERT];
-
 	assert(type != nullptr);
 	assert(uri != nullptr);
 	assert(name != nullptr);
-	assert(*name != 0);
 	assert(value != nullptr);
 
-	assert(sticker_enabled());
+	if (StringIsEmpty(name))
+		return;
 
 	BindAll(stmt, type, uri, name, value);
 
@@ -256,26 +304,10 @@ sticker_insert_value(const char *type, const char *uri,
 	};
 
 	ExecuteCommand(stmt);
+	sticker_cache_put(sticker_cache_key(type, uri, name), value);
 	idle_add(IDLE_STICKER);
 }
 
-void
-sticker_store_value(const char *type, const char *uri,
-		    const char *name, const char *value)
-{
-	assert(sticker_enabled());
-	assert(type != nullptr);
-	assert(uri != nullptr);
-	assert(name != nullptr);
-	assert(value != nullptr);
-
-	if (StringIsEmpty(name))
-		return;
-
-	if (!sticker_update_value(type, uri, name, value))
-		sticker_insert_value(type, uri, name, value);
-}
-
 bool
 sticker_delete(const char *type, const char *uri)
 {
@@ -293,8 +325,10 @@ sticker_delete(const char *type, const char *uri)
 	};
 
 	bool modified = ExecuteModified(stmt);
-	if (modified)
+	if (modified) {
+		sticker_cache_erase_object(type, uri);
 		idle_add(IDLE_STICKER);
+	}
 	return modified;
 }
 
@@ -315,6 +349,11 @@ sticker_delete_value(const char *type, const char *uri, const char *name)
 	};
 
 	bool modified = ExecuteModified(stmt);
+
+	/* whether the row was deleted just now or did not exist in
+	   the first place, the value is gone */
+	sticker_cache_put(sticker_cache_key(type, uri, name), "");
+
 	if (modified)
 		idle_add(IDLE_STICKER);
 	return modified;
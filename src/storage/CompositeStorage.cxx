@@ -22,6 +22,7 @@
 #include "fs/AllocatedPath.hxx"
 #include "util/StringCompare.hxx"
 
+#include <algorithm>
 #include <set>
 #include <stdexcept>
 
@@ -207,6 +208,8 @@ CompositeStorage::Mount(const char *uri, std::unique_ptr<Storage> storage)
 
 	Directory &directory = root.Make(uri);
 	directory.storage = std::move(storage);
+
+	UpdateMountCache();
 }
 
 bool
@@ -214,28 +217,62 @@ CompositeStorage::Unmount(const char *uri)
 {
 	const std::lock_guard<Mutex> protect(mutex);
 
-	return root.Unmount(uri);
+	bool result = root.Unmount(uri);
+	if (result)
+		UpdateMountCache();
+
+	return result;
 }
 
-CompositeStorage::FindResult
-CompositeStorage::FindStorage(const char *uri) const noexcept
+void
+CompositeStorage::CollectMounts(std::vector<MountCacheEntry> &cache,
+				const Directory &directory,
+				std::string &&prefix) noexcept
 {
-	FindResult result{&root, uri};
-
-	const Directory *directory = &root;
-	while (*uri != 0) {
-		const std::string name = NextSegment(uri);
+	if (directory.storage != nullptr)
+		cache.emplace_back(MountCacheEntry{prefix, &directory});
+
+	for (const auto &i : directory.children) {
+		std::string child_prefix = prefix.empty()
+			? i.first
+			: prefix + "/" + i.first;
+		CollectMounts(cache, i.second, std::move(child_prefix));
+	}
+}
 
-		auto i = directory->children.find(name);
-		if (i == directory->children.end())
-			break;
+void
+CompositeStorage::UpdateMountCache() noexcept
+{
+	mount_cache.clear();
+	CollectMounts(mount_cache, root, std::string());
+
+	/* longest prefix first, so FindStorage() finds the deepest
+	   mount on the path */
+	std::sort(mount_cache.begin(), mount_cache.end(),
+		  [](const MountCacheEntry &a, const MountCacheEntry &b){
+			  return a.prefix.length() > b.prefix.length();
+		  });
+}
 
-		directory = &i->second;
-		if (directory->storage != nullptr)
-			result = FindResult{directory, uri};
+CompositeStorage::FindResult
+CompositeStorage::FindStorage(const char *uri) const noexcept
+{
+	for (const auto &i : mount_cache) {
+		const size_t length = i.prefix.length();
+		if (length == 0)
+			/* the root mount matches everything */
+			return {i.directory, uri};
+
+		if (strncmp(uri, i.prefix.c_str(), length) == 0) {
+			if (uri[length] == '/')
+				return {i.directory, uri + length + 1};
+
+			if (uri[length] == 0)
+				return {i.directory, uri + length};
+		}
 	}
 
-	return result;
+	return {&root, uri};
 }
 
 StorageFileInfo
@@ -27,6 +27,7 @@
 #include <memory>
 #include <string>
 #include <map>
+#include <vector>
 
 /**
  * A #Storage implementation that combines multiple other #Storage
@@ -74,6 +75,15 @@ class CompositeStorage final : public Storage {
 		const char *uri;
 	};
 
+	/**
+	 * One mount point, flattened for FindStorage(): the full URI
+	 * prefix and the #Directory holding the #Storage.
+	 */
+	struct MountCacheEntry {
+		std::string prefix;
+		const Directory *directory;
+	};
+
 	/**
 	 * Protects the virtual #Directory tree.
 	 *
@@ -83,6 +93,16 @@ class CompositeStorage final : public Storage {
 
 	Directory root;
 
+	/**
+	 * All mount points, sorted by descending prefix length, so
+	 * FindStorage() resolves the longest matching prefix with
+	 * plain string comparisons instead of walking the #Directory
+	 * tree and allocating one std::string per path segment.
+	 * Rebuilt by UpdateMountCache() whenever the mount tree
+	 * changes; protected by #mutex.
+	 */
+	std::vector<MountCacheEntry> mount_cache;
+
 	mutable std::string relative_buffer;
 
 public:
@@ -157,6 +177,16 @@ private:
 	gcc_pure
 	FindResult FindStorage(const char *uri) const noexcept;
 
+	static void CollectMounts(std::vector<MountCacheEntry> &cache,
+				  const Directory &directory,
+				  std::string &&prefix) noexcept;
+
+	/**
+	 * Rebuild #mount_cache from the #Directory tree.  Caller
+	 * must lock #mutex.
+	 */
+	void UpdateMountCache() noexcept;
+
 	const char *MapToRelativeUTF8(const Directory &directory,
 				      const char *uri) const;
 };
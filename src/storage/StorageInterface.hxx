@@ -36,6 +36,16 @@ public:
 
 	virtual const char *Read() noexcept = 0;
 
+	/**
+	 * May the current entry be a symbolic link?  Returns false
+	 * only if the implementation knows for sure (e.g. from the
+	 * readdir() entry type) that it is not one, which allows
+	 * callers to elide a readlink() system call.
+	 */
+	virtual bool MaybeSymlink() const noexcept {
+		return true;
+	}
+
 	/**
 	 * Throws #std::runtime_error on error.
 	 */
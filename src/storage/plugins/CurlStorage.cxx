@@ -43,22 +43,68 @@
 #include "util/UriUtil.hxx"
 
 #include <algorithm>
+#include <forward_list>
+#include <map>
 #include <memory>
 #include <string>
 #include <list>
 
 #include <assert.h>
 
+class HttpListDirectoryOperation;
+
 class CurlStorage final : public Storage {
 	const std::string base;
 
 	CurlInit curl;
 
+	/**
+	 * Directory listings which were requested speculatively
+	 * after their parent's listing was delivered.  The update
+	 * walk descends into these shortly afterwards, and by then,
+	 * the PROPFIND responses may already have arrived, hiding
+	 * the request round trips.
+	 *
+	 * Only accessed from the thread which runs the update walk.
+	 */
+	std::map<std::string,
+		 std::unique_ptr<HttpListDirectoryOperation>> prefetch;
+
+	/**
+	 * The maximum number of speculative PROPFIND requests kept
+	 * in flight at any time.
+	 */
+	static constexpr size_t MAX_PREFETCH = 8;
+
+	/**
+	 * A directory listing retained from a previous walk, keyed by
+	 * the collection's "getetag" property.  On the next walk, the
+	 * ETag is sent as "If-None-Match", and a "304 Not Modified"
+	 * reply serves the listing from this cache without
+	 * transferring the XML body again.
+	 */
+	struct ListingCacheEntry {
+		std::string etag;
+
+		MemoryStorageDirectoryReader::List entries;
+
+		std::forward_list<std::string> collections;
+	};
+
+	/**
+	 * ETag-validated listings of all collections seen so far,
+	 * keyed by collection URI.  Like #prefetch, only accessed
+	 * from the thread which runs the update walk.
+	 */
+	std::map<std::string, ListingCacheEntry> listing_cache;
+
 public:
 	CurlStorage(EventLoop &_loop, const char *_base)
 		:base(_base),
 		 curl(_loop) {}
 
+	~CurlStorage() noexcept override;
+
 	/* virtual methods from class Storage */
 	StorageFileInfo GetInfo(const char *uri_utf8, bool follow) override;
 
@@ -67,6 +113,13 @@ public:
 	std::string MapUTF8(const char *uri_utf8) const noexcept override;
 
 	const char *MapToRelativeUTF8(const char *uri_utf8) const noexcept override;
+
+private:
+	/**
+	 * Issue speculative (conditional) PROPFIND requests for the
+	 * given collection URIs.
+	 */
+	void PrefetchCollections(const std::forward_list<std::string> &collections);
 };
 
 std::string
@@ -123,6 +176,17 @@ public:
 		defer_start.Schedule();
 	}
 
+	~BlockingHttpRequest() noexcept {
+		defer_start.Cancel();
+
+		/* the transfer may still be in flight if this object
+		   is destroyed without Wait(), e.g. when a
+		   speculative request is discarded; unregister it
+		   from the IOThread before the #CurlRequest is
+		   destructed */
+		request.StopIndirect();
+	}
+
 	void Wait() {
 		const std::lock_guard<Mutex> lock(mutex);
 		while (!done)
@@ -173,6 +237,7 @@ struct DavResponse {
 	std::string href;
 	unsigned status = 0;
 	bool collection = false;
+	std::string etag;
 	std::chrono::system_clock::time_point mtime =
 		std::chrono::system_clock::time_point::min();
 	uint64_t length = 0;
@@ -259,19 +324,36 @@ class PropfindOperation : BlockingHttpRequest, CommonExpatParser {
 		TYPE,
 		MTIME,
 		LENGTH,
+		ETAG,
 	} state = State::ROOT;
 
 	DavResponse response;
 
+	/**
+	 * Is this a conditional request (with "If-None-Match")?
+	 */
+	const bool conditional;
+
+	/**
+	 * Did the server reply with "304 Not Modified"?
+	 */
+	bool not_modified = false;
+
 public:
-	PropfindOperation(CurlGlobal &_curl, const char *_uri, unsigned depth)
+	PropfindOperation(CurlGlobal &_curl, const char *_uri, unsigned depth,
+			  const char *if_none_match=nullptr)
 		:BlockingHttpRequest(_curl, _uri),
-		 CommonExpatParser(ExpatNamespaceSeparator{'|'})
+		 CommonExpatParser(ExpatNamespaceSeparator{'|'}),
+		 conditional(if_none_match != nullptr)
 	{
 		request.SetOption(CURLOPT_CUSTOMREQUEST, "PROPFIND");
 
 		request_headers.Append(StringFormat<40>("depth: %u", depth));
 
+		if (if_none_match != nullptr)
+			request_headers.Append((std::string("if-none-match: ") +
+						if_none_match).c_str());
+
 		request.SetOption(CURLOPT_HTTPHEADER, request_headers.Get());
 
 		request.SetOption(CURLOPT_POSTFIELDS,
@@ -279,6 +361,7 @@ public:
 				  "<a:propfind xmlns:a=\"DAV:\">"
 				  "<a:prop><a:getcontenttype/></a:prop>"
 				  "<a:prop><a:getcontentlength/></a:prop>"
+				  "<a:prop><a:getetag/></a:prop>"
 				  "</a:propfind>");
 
 		// TODO: send request body
@@ -286,6 +369,10 @@ public:
 
 	using BlockingHttpRequest::Wait;
 
+	bool IsNotModified() const noexcept {
+		return not_modified;
+	}
+
 protected:
 	virtual void OnDavResponse(DavResponse &&r) = 0;
 
@@ -299,6 +386,13 @@ private:
 	/* virtual methods from CurlResponseHandler */
 	void OnHeaders(unsigned status,
 		       std::multimap<std::string, std::string> &&headers) final {
+		if (conditional && status == 304) {
+			/* the collection has not been modified since
+			   we cached its listing */
+			not_modified = true;
+			return;
+		}
+
 		if (status != 207)
 			throw FormatRuntimeError("Status %d from WebDAV server; expected \"207 Multi-Status\"",
 						 status);
@@ -308,12 +402,18 @@ private:
 	}
 
 	void OnData(ConstBuffer<void> _data) final {
+		if (not_modified)
+			/* a "304 Not Modified" response has no useful
+			   body */
+			return;
+
 		const auto data = ConstBuffer<char>::FromVoid(_data);
 		Parse(data.data, data.size);
 	}
 
 	void OnEnd() final {
-		CompleteParse();
+		if (!not_modified)
+			CompleteParse();
 		LockSetDone();
 	}
 
@@ -337,6 +437,8 @@ private:
 				state = State::MTIME;
 			else if (strcmp(name, "DAV:|getcontentlength") == 0)
 				state = State::LENGTH;
+			else if (strcmp(name, "DAV:|getetag") == 0)
+				state = State::ETAG;
 			break;
 
 		case State::TYPE:
@@ -348,6 +450,7 @@ private:
 		case State::STATUS:
 		case State::LENGTH:
 		case State::MTIME:
+		case State::ETAG:
 			break;
 		}
 	}
@@ -389,6 +492,11 @@ private:
 			if (strcmp(name, "DAV:|getcontentlength") == 0)
 				state = State::RESPONSE;
 			break;
+
+		case State::ETAG:
+			if (strcmp(name, "DAV:|getetag") == 0)
+				state = State::RESPONSE;
+			break;
 		}
 	}
 
@@ -414,6 +522,10 @@ private:
 		case State::LENGTH:
 			response.length = ParseU64(s, len);
 			break;
+
+		case State::ETAG:
+			response.etag.assign(s, len);
+			break;
 		}
 	}
 };
@@ -474,25 +586,50 @@ UriPathOrSlash(const char *uri) noexcept
  * Obtain a directory listing using WebDAV PROPFIND.
  */
 class HttpListDirectoryOperation final : public PropfindOperation {
+	const std::string base_uri;
+
 	const std::string base_path;
 
 	MemoryStorageDirectoryReader::List entries;
 
+	/**
+	 * The URIs of all collections (i.e. subdirectories) found in
+	 * this listing; used to prefetch their listings.
+	 */
+	std::forward_list<std::string> collections;
+
+	/**
+	 * The "getetag" property of the collection itself, to be sent
+	 * as "If-None-Match" by the next walk; empty if the server
+	 * did not provide one.
+	 */
+	std::string collection_etag;
+
 public:
-	HttpListDirectoryOperation(CurlGlobal &curl, const char *uri)
-		:PropfindOperation(curl, uri, 1),
+	HttpListDirectoryOperation(CurlGlobal &curl, const char *uri,
+				   const char *if_none_match=nullptr)
+		:PropfindOperation(curl, uri, 1, if_none_match),
+		 base_uri(uri),
 		 base_path(UriPathOrSlash(uri)) {}
 
-	std::unique_ptr<StorageDirectoryReader> Perform() {
-		Wait();
-		return ToReader();
+	const std::forward_list<std::string> &GetCollections() const noexcept {
+		return collections;
+	}
+
+	const MemoryStorageDirectoryReader::List &GetEntries() const noexcept {
+		return entries;
+	}
+
+	const std::string &GetETag() const noexcept {
+		return collection_etag;
 	}
 
-private:
 	std::unique_ptr<StorageDirectoryReader> ToReader() {
 		return std::make_unique<MemoryStorageDirectoryReader>(std::move(entries));
 	}
 
+private:
+
 	/**
 	 * Convert a "href" attribute (which may be an absolute URI)
 	 * to the base file name.
@@ -526,8 +663,19 @@ protected:
 			return;
 
 		const auto escaped_name = HrefToEscapedName(r.href.c_str());
-		if (escaped_name.IsNull())
+		if (escaped_name.IsNull()) {
+			/* no name relative to the base: this may be
+			   the response for the collection itself */
+			const char *path = uri_get_path(r.href.c_str());
+			if (path != nullptr) {
+				path = StringAfterPrefix(path,
+							 base_path.c_str());
+				if (path != nullptr && *path == 0)
+					collection_etag = std::move(r.etag);
+			}
+
 			return;
+		}
 
 		// TODO: unescape
 		const auto name = escaped_name;
@@ -540,9 +688,39 @@ protected:
 				       : StorageFileInfo::Type::REGULAR);
 		info.size = r.length;
 		info.mtime = r.mtime;
+
+		if (r.collection)
+			collections.emplace_front(base_uri +
+						  std::string(name.data,
+							      name.size) +
+						  "/");
 	}
 };
 
+CurlStorage::~CurlStorage() noexcept = default;
+
+void
+CurlStorage::PrefetchCollections(const std::forward_list<std::string> &collections)
+{
+	for (const auto &child_uri : collections) {
+		if (prefetch.size() >= MAX_PREFETCH)
+			break;
+
+		if (prefetch.find(child_uri) != prefetch.end())
+			continue;
+
+		const auto c = listing_cache.find(child_uri);
+		const char *if_none_match = c != listing_cache.end()
+			? c->second.etag.c_str()
+			: nullptr;
+
+		prefetch.emplace(child_uri,
+				 std::make_unique<HttpListDirectoryOperation>(*curl,
+									      child_uri.c_str(),
+									      if_none_match));
+	}
+}
+
 std::unique_ptr<StorageDirectoryReader>
 CurlStorage::OpenDirectory(const char *uri_utf8)
 {
@@ -555,7 +733,61 @@ CurlStorage::OpenDirectory(const char *uri_utf8)
 	if (uri.back() != '/')
 		uri.push_back('/');
 
-	return HttpListDirectoryOperation(*curl, uri.c_str()).Perform();
+	const auto cache_i = listing_cache.find(uri);
+
+	std::unique_ptr<HttpListDirectoryOperation> op;
+
+	auto i = prefetch.find(uri);
+	if (i != prefetch.end()) {
+		/* this listing was requested speculatively and may
+		   already be finished */
+		op = std::move(i->second);
+		prefetch.erase(i);
+	} else {
+		const char *if_none_match = cache_i != listing_cache.end()
+			? cache_i->second.etag.c_str()
+			: nullptr;
+
+		op = std::make_unique<HttpListDirectoryOperation>(*curl,
+								  uri.c_str(),
+								  if_none_match);
+	}
+
+	op->Wait();
+
+	if (op->IsNotModified()) {
+		if (cache_i != listing_cache.end()) {
+			/* the collection is unchanged: serve the
+			   listing from the cache, without
+			   transferring the XML body */
+			PrefetchCollections(cache_i->second.collections);
+
+			auto entries = cache_i->second.entries;
+			return std::make_unique<MemoryStorageDirectoryReader>(std::move(entries));
+		}
+
+		/* "304 Not Modified", but the cached listing is gone:
+		   retry unconditionally */
+		op = std::make_unique<HttpListDirectoryOperation>(*curl,
+								  uri.c_str());
+		op->Wait();
+	}
+
+	/* remember the fresh listing for the next walk */
+	const std::string &etag = op->GetETag();
+	if (!etag.empty())
+		listing_cache[uri] = ListingCacheEntry{etag,
+						       op->GetEntries(),
+						       op->GetCollections()};
+	else if (cache_i != listing_cache.end())
+		listing_cache.erase(cache_i);
+
+	/* issue PROPFIND requests for the subdirectories found in
+	   this listing while the caller is still busy visiting the
+	   entries */
+	PrefetchCollections(op->GetCollections());
+
+	return op->ToReader();
 }
 
 static std::unique_ptr<Storage>
@@ -28,6 +28,14 @@
 
 #include <string>
 
+#ifndef _WIN32
+#include <sys/stat.h>
+#ifdef STATX_TYPE
+#include <fcntl.h>
+#include <sys/sysmacros.h>
+#endif
+#endif
+
 class LocalDirectoryReader final : public StorageDirectoryReader {
 	AllocatedPath base_fs;
 
@@ -41,6 +49,11 @@ public:
 
 	/* virtual methods from class StorageDirectoryReader */
 	const char *Read() noexcept override;
+
+	bool MaybeSymlink() const noexcept override {
+		return reader.MaybeSymlink();
+	}
+
 	StorageFileInfo GetInfo(bool follow) override;
 };
 
@@ -73,6 +86,36 @@ private:
 static StorageFileInfo
 Stat(Path path, bool follow)
 {
+#ifdef STATX_TYPE
+	/* request only the attributes we actually use; on network
+	   file systems, this may spare the server a costly full
+	   attribute refresh */
+	struct statx stx;
+	if (statx(AT_FDCWD, path.c_str(),
+		  follow ? 0 : AT_SYMLINK_NOFOLLOW,
+		  STATX_TYPE|STATX_SIZE|STATX_MTIME|STATX_INO,
+		  &stx) == 0) {
+		StorageFileInfo info;
+
+		if (S_ISREG(stx.stx_mode))
+			info.type = StorageFileInfo::Type::REGULAR;
+		else if (S_ISDIR(stx.stx_mode))
+			info.type = StorageFileInfo::Type::DIRECTORY;
+		else
+			info.type = StorageFileInfo::Type::OTHER;
+
+		info.size = stx.stx_size;
+		info.mtime = std::chrono::system_clock::from_time_t(stx.stx_mtime.tv_sec);
+		info.device = makedev(stx.stx_dev_major, stx.stx_dev_minor);
+		info.inode = stx.stx_ino;
+		return info;
+	}
+
+	/* on failure (e.g. ENOSYS from a pre-4.11 kernel), fall
+	   through to the classic stat() so the error gets reported
+	   consistently */
+#endif
+
 	const FileInfo src(path, follow);
 	StorageFileInfo info;
 
@@ -42,7 +42,9 @@ extern "C" {
 #include <nfsc/libnfs-raw-nfs.h>
 }
 
+#include <chrono>
 #include <string>
+#include <unordered_map>
 
 #include <assert.h>
 #include <sys/stat.h>
@@ -69,6 +71,43 @@ class NfsStorage final
 	State state = State::INITIAL;
 	std::exception_ptr last_exception;
 
+	/**
+	 * An entry of the attribute cache.  #follow distinguishes
+	 * Stat() from Lstat() results, which differ for symlinks.
+	 */
+	struct CacheEntry {
+		StorageFileInfo info;
+		std::chrono::steady_clock::time_point expires;
+		bool follow;
+	};
+
+	/**
+	 * How long a cached attribute remains valid.  Kept short so
+	 * external modifications become visible quickly, like the
+	 * kernel NFS client's attribute cache.
+	 */
+	static constexpr std::chrono::steady_clock::duration CACHE_TTL =
+		std::chrono::seconds(10);
+
+	/**
+	 * Maximum number of cached attributes; when the limit is
+	 * reached, the whole cache is flushed, which keeps the code
+	 * trivial and is good enough for the update walk's bursty
+	 * access pattern.
+	 */
+	static constexpr size_t CACHE_MAX_SIZE = 64 * 1024;
+
+	/**
+	 * Maps a UTF-8 URI relative to the storage root to cached
+	 * attributes.  This saves one stat round trip to the NFS
+	 * server each time the update walk revisits a path, and is
+	 * also populated from directory listings, which already carry
+	 * attributes for each entry.  Protected by #cache_mutex
+	 * because storage methods may be called from several threads.
+	 */
+	mutable Mutex cache_mutex;
+	std::unordered_map<std::string, CacheEntry> info_cache;
+
 public:
 	NfsStorage(EventLoop &_loop, const char *_base,
 		   std::string &&_server, std::string &&_export_name)
@@ -111,6 +150,8 @@ public:
 	void OnNfsConnectionDisconnected(std::exception_ptr e) noexcept final {
 		assert(state == State::READY);
 
+		ClearCache();
+
 		SetState(State::DELAY, std::move(e));
 		reconnect_timer.Schedule(std::chrono::seconds(5));
 	}
@@ -194,6 +235,8 @@ private:
 	void Disconnect() noexcept {
 		assert(!GetEventLoop().IsAlive() || GetEventLoop().IsInside());
 
+		ClearCache();
+
 		switch (state) {
 		case State::INITIAL:
 			defer_connect.Cancel();
@@ -211,8 +254,49 @@ private:
 			break;
 		}
 	}
+
+	/**
+	 * Look up cached attributes for the given URI.
+	 *
+	 * @return true if the #info parameter was filled
+	 */
+	bool CacheLookup(const char *uri_utf8, bool follow,
+			 StorageFileInfo &info) const noexcept {
+		const std::lock_guard<Mutex> protect(cache_mutex);
+
+		auto i = info_cache.find(uri_utf8);
+		if (i == info_cache.end() || i->second.follow != follow ||
+		    std::chrono::steady_clock::now() >= i->second.expires)
+			return false;
+
+		info = i->second.info;
+		return true;
+	}
+
+	void CachePut(std::string &&uri_utf8, bool follow,
+		      const StorageFileInfo &info) noexcept {
+		const auto expires = std::chrono::steady_clock::now()
+			+ CACHE_TTL;
+
+		const std::lock_guard<Mutex> protect(cache_mutex);
+
+		if (info_cache.size() >= CACHE_MAX_SIZE)
+			info_cache.clear();
+
+		auto &entry = info_cache[std::move(uri_utf8)];
+		entry.info = info;
+		entry.expires = expires;
+		entry.follow = follow;
+	}
+
+	void ClearCache() noexcept {
+		const std::lock_guard<Mutex> protect(cache_mutex);
+		info_cache.clear();
+	}
 };
 
+constexpr std::chrono::steady_clock::duration NfsStorage::CACHE_TTL;
+
 static std::string
 UriToNfsPath(const char *_uri_utf8)
 {
@@ -294,13 +378,20 @@ protected:
 StorageFileInfo
 NfsStorage::GetInfo(const char *uri_utf8, bool follow)
 {
+	StorageFileInfo info;
+	if (CacheLookup(uri_utf8, follow, info))
+		return info;
+
 	const std::string path = UriToNfsPath(uri_utf8);
 
 	WaitConnected();
 
 	NfsGetInfoOperation operation(*connection, path.c_str(), follow);
 	operation.Run();
-	return operation.GetInfo();
+
+	info = operation.GetInfo();
+	CachePut(uri_utf8, follow, info);
+	return info;
 }
 
 gcc_pure
@@ -345,6 +436,10 @@ public:
 				  const char *_path)
 		:BlockingNfsOperation(_connection), path(_path) {}
 
+	const MemoryStorageDirectoryReader::List &GetEntries() const {
+		return entries;
+	}
+
 	std::unique_ptr<StorageDirectoryReader> ToReader() {
 		return std::make_unique<MemoryStorageDirectoryReader>(std::move(entries));
 	}
@@ -404,6 +499,17 @@ NfsStorage::OpenDirectory(const char *uri_utf8)
 	NfsListDirectoryOperation operation(*connection, path.c_str());
 	operation.Run();
 
+	/* the NFS readdir reply already carries attributes for each
+	   entry; feed them into the attribute cache, so the update
+	   walk's following GetInfo() calls are answered without
+	   another stat round trip (symlinks are skipped because their
+	   dirent attributes describe the link, not its target) */
+	for (const auto &entry : operation.GetEntries())
+		if (entry.info.IsRegular() || entry.info.IsDirectory())
+			CachePut(PathTraitsUTF8::Build(uri_utf8,
+						       entry.name.c_str()),
+				 true, entry.info);
+
 	return operation.ToReader();
 }
 
@@ -22,7 +22,7 @@
 #include "storage/StorageInterface.hxx"
 #include "storage/FileInfo.hxx"
 #include "lib/smbclient/Init.hxx"
-#include "lib/smbclient/Mutex.hxx"
+#include "lib/smbclient/Context.hxx"
 #include "fs/Traits.hxx"
 #include "thread/Mutex.hxx"
 #include "system/Error.hxx"
@@ -33,14 +33,16 @@
 #include <libsmbclient.h>
 
 class SmbclientDirectoryReader final : public StorageDirectoryReader {
+	SmbclientContext &ctx;
 	const std::string base;
-	const unsigned handle;
+	SMBCFILE *const handle;
 
 	const char *name;
 
 public:
-	SmbclientDirectoryReader(std::string &&_base, unsigned _handle)
-		:base(std::move(_base)), handle(_handle) {}
+	SmbclientDirectoryReader(SmbclientContext &_ctx,
+				 std::string &&_base, SMBCFILE *_handle)
+		:ctx(_ctx), base(std::move(_base)), handle(_handle) {}
 
 	virtual ~SmbclientDirectoryReader();
 
@@ -52,17 +54,12 @@ public:
 class SmbclientStorage final : public Storage {
 	const std::string base;
 
-	SMBCCTX *const ctx;
+	const std::unique_ptr<SmbclientContext> ctx;
 
 public:
-	SmbclientStorage(const char *_base, SMBCCTX *_ctx)
-		:base(_base), ctx(_ctx) {}
-
-	virtual ~SmbclientStorage() {
-		smbclient_mutex.lock();
-		smbc_free_context(ctx, 1);
-		smbclient_mutex.unlock();
-	}
+	SmbclientStorage(const char *_base,
+			 std::unique_ptr<SmbclientContext> _ctx)
+		:base(_base), ctx(std::move(_ctx)) {}
 
 	/* virtual methods from class Storage */
 	StorageFileInfo GetInfo(const char *uri_utf8, bool follow) override;
@@ -92,15 +89,12 @@ SmbclientStorage::MapToRelativeUTF8(const char *uri_utf8) const noexcept
 }
 
 static StorageFileInfo
-GetInfo(const char *path)
+GetInfo(SmbclientContext &ctx, const char *path)
 {
 	struct stat st;
 
-	{
-		const std::lock_guard<Mutex> protect(smbclient_mutex);
-		if (smbc_stat(path, &st) != 0)
-			throw MakeErrno("Failed to access file");
-	}
+	if (ctx.Stat(path, st) != 0)
+		throw MakeErrno("Failed to access file");
 
 	StorageFileInfo info;
 	if (S_ISREG(st.st_mode))
@@ -121,7 +115,7 @@ StorageFileInfo
 SmbclientStorage::GetInfo(const char *uri_utf8, gcc_unused bool follow)
 {
 	const std::string mapped = MapUTF8(uri_utf8);
-	return ::GetInfo(mapped.c_str());
+	return ::GetInfo(*ctx, mapped.c_str());
 }
 
 std::unique_ptr<StorageDirectoryReader>
@@ -129,16 +123,12 @@ SmbclientStorage::OpenDirectory(const char *uri_utf8)
 {
 	std::string mapped = MapUTF8(uri_utf8);
 
-	int handle;
-
-	{
-		const std::lock_guard<Mutex> protect(smbclient_mutex);
-		handle = smbc_opendir(mapped.c_str());
-		if (handle < 0)
-			throw MakeErrno("Failed to open directory");
-	}
+	SMBCFILE *handle = ctx->OpenDirectory(mapped.c_str());
+	if (handle == nullptr)
+		throw MakeErrno("Failed to open directory");
 
-	return std::make_unique<SmbclientDirectoryReader>(std::move(mapped.c_str()),
+	return std::make_unique<SmbclientDirectoryReader>(*ctx,
+							  std::move(mapped),
 							  handle);
 }
 
@@ -153,18 +143,14 @@ SkipNameFS(const char *name) noexcept
 
 SmbclientDirectoryReader::~SmbclientDirectoryReader()
 {
-	smbclient_mutex.lock();
-	smbc_close(handle);
-	smbclient_mutex.unlock();
+	ctx.CloseDirectory(handle);
 }
 
 const char *
 SmbclientDirectoryReader::Read() noexcept
 {
-	const std::lock_guard<Mutex> protect(smbclient_mutex);
-
-	struct smbc_dirent *e;
-	while ((e = smbc_readdir(handle)) != nullptr) {
+	const struct smbc_dirent *e;
+	while ((e = ctx.ReadDirectory(handle)) != nullptr) {
 		name = e->name;
 		if (!SkipNameFS(name))
 			return name;
@@ -177,7 +163,7 @@ StorageFileInfo
 SmbclientDirectoryReader::GetInfo(gcc_unused bool follow)
 {
 	const std::string path = PathTraitsUTF8::Build(base.c_str(), name);
-	return ::GetInfo(path.c_str());
+	return ::GetInfo(ctx, path.c_str());
 }
 
 static std::unique_ptr<Storage>
@@ -188,18 +174,8 @@ CreateSmbclientStorageURI(gcc_unused EventLoop &event_loop, const char *base)
 
 	SmbclientInit();
 
-	const std::lock_guard<Mutex> protect(smbclient_mutex);
-	SMBCCTX *ctx = smbc_new_context();
-	if (ctx == nullptr)
-		throw MakeErrno("smbc_new_context() failed");
-
-	SMBCCTX *ctx2 = smbc_init_context(ctx);
-	if (ctx2 == nullptr) {
-		AtScopeExit(ctx) { smbc_free_context(ctx, 1); };
-		throw MakeErrno("smbc_new_context() failed");
-	}
-
-	return std::make_unique<SmbclientStorage>(base, ctx2);
+	return std::make_unique<SmbclientStorage>(base,
+						  SmbclientContext::New());
 }
 
 const StoragePlugin smbclient_storage_plugin = {
@@ -94,6 +94,12 @@ tag_ape_import_item(unsigned long flags,
 	if (type == TAG_NUM_OF_ITEM_TYPES)
 		return false;
 
+	if (!handler.WantTag(type))
+		/* the item was recognized, but the handler is not
+		   interested in this tag type; skip splitting and
+		   copying the values */
+		return true;
+
 	ForEachValue(begin, end, [&handler, type](const char *_value) {
 			handler.OnTag(type, _value);
 		});
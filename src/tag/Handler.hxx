@@ -22,6 +22,8 @@
 
 #include "Type.h"
 #include "Chrono.hxx"
+#include "Mask.hxx"
+#include "Settings.hxx"
 #include "util/Compiler.h"
 
 struct AudioFormat;
@@ -33,14 +35,23 @@ class TagBuilder;
 class TagHandler {
 	const unsigned want_mask;
 
+	/**
+	 * Which tag types does this handler want?  Scanners may skip
+	 * expensive parsing and charset conversion for tag types not
+	 * in this mask; they are however not required to filter, so
+	 * OnTag() implementations must not rely on it.
+	 */
+	const TagMask tag_mask;
+
 public:
 	static constexpr unsigned WANT_DURATION = 0x1;
 	static constexpr unsigned WANT_TAG = 0x2;
 	static constexpr unsigned WANT_PAIR = 0x4;
 	static constexpr unsigned WANT_AUDIO_FORMAT = 0x8;
 
-	explicit TagHandler(unsigned _want_mask) noexcept
-		:want_mask(_want_mask) {}
+	explicit TagHandler(unsigned _want_mask,
+			    TagMask _tag_mask=TagMask::All()) noexcept
+		:want_mask(_want_mask), tag_mask(_tag_mask) {}
 
 	TagHandler(const TagHandler &) = delete;
 	TagHandler &operator=(const TagHandler &) = delete;
@@ -53,6 +64,15 @@ public:
 		return want_mask & WANT_TAG;
 	}
 
+	/**
+	 * Like WantTag(), but also checks whether the given tag type
+	 * is wanted at all, allowing scanners to skip unwanted items
+	 * early.
+	 */
+	bool WantTag(TagType type) const noexcept {
+		return WantTag() && tag_mask.Test(type);
+	}
+
 	bool WantPair() const noexcept {
 		return want_mask & WANT_PAIR;
 	}
@@ -102,8 +122,9 @@ public:
 
 class NullTagHandler : public TagHandler {
 public:
-	explicit NullTagHandler(unsigned _want_mask) noexcept
-		:TagHandler(_want_mask) {}
+	explicit NullTagHandler(unsigned _want_mask,
+				TagMask _tag_mask=TagMask::All()) noexcept
+		:TagHandler(_want_mask, _tag_mask) {}
 
 	void OnDuration(gcc_unused SongTime duration) noexcept override {}
 	void OnTag(gcc_unused TagType type,
@@ -121,8 +142,15 @@ class AddTagHandler : public NullTagHandler {
 protected:
 	TagBuilder &tag;
 
+	/**
+	 * The #TagMask is initialized from #global_tag_mask, because
+	 * TagBuilder::AddItem() discards disabled tag types anyway;
+	 * announcing this to the scanner avoids parsing them in the
+	 * first place.
+	 */
 	AddTagHandler(unsigned _want_mask, TagBuilder &_builder) noexcept
-		:NullTagHandler(WANT_DURATION|WANT_TAG|_want_mask),
+		:NullTagHandler(WANT_DURATION|WANT_TAG|_want_mask,
+				global_tag_mask),
 		 tag(_builder) {}
 
 public:
@@ -26,9 +26,15 @@
 #include <id3tag.h>
 
 #include <algorithm>
+#include <vector>
+
+#include <string.h>
 
 static constexpr size_t ID3V1_SIZE = 128;
 
+static constexpr size_t ID3V2_HEADER_SIZE = 10;
+static constexpr size_t ID3V2_FRAME_HEADER_SIZE = 10;
+
 gcc_pure
 static inline bool
 tag_is_id3v1(struct id3_tag *tag) noexcept
@@ -48,6 +54,123 @@ try {
 	return 0;
 }
 
+gcc_pure
+static size_t
+ParseId3SyncSafe(const id3_byte_t *p) noexcept
+{
+	return (size_t(p[0] & 0x7f) << 21) | (size_t(p[1] & 0x7f) << 14) |
+		(size_t(p[2] & 0x7f) << 7) | size_t(p[3] & 0x7f);
+}
+
+gcc_pure
+static bool
+IsId3BinaryFrame(const id3_byte_t *id) noexcept
+{
+	return memcmp(id, "APIC", 4) == 0 ||
+		memcmp(id, "GEOB", 4) == 0 ||
+		memcmp(id, "PRIV", 4) == 0;
+}
+
+/**
+ * Read an ID3v2.3/v2.4 tag incrementally, frame by frame, seeking
+ * over the payload of large binary frames (APIC/GEOB/PRIV) which the
+ * tag scanner ignores anyway.  The remaining frames are reassembled
+ * into a small buffer which is handed to id3_tag_parse(); megabytes
+ * of embedded cover art are neither read nor copied.
+ *
+ * @param header the tag header (#ID3V2_HEADER_SIZE bytes) which has
+ * already been read from the stream
+ * @return the parsed tag, or nullptr if this tag cannot be filtered
+ * safely (unsupported version, unsynchronisation, extended header);
+ * the caller must then rewind and read the whole tag
+ */
+static UniqueId3Tag
+ReadId3TagFiltered(InputStream &is, const id3_byte_t *header,
+		   size_t tag_size)
+try {
+	const unsigned version = header[3];
+	const unsigned flags = header[5];
+
+	if (version < 3 || version > 4)
+		return nullptr;
+
+	if (flags & 0x80)
+		/* in v2.3, unsynchronisation applies to the whole
+		   tag, making frame boundaries unparseable without a
+		   full copy */
+		return nullptr;
+
+	if (flags & 0x40)
+		/* extended header: rare, and its size field is
+		   encoded differently in v2.3; not worth supporting
+		   here */
+		return nullptr;
+
+	size_t remaining = ParseId3SyncSafe(header + 6);
+	if (remaining + ID3V2_HEADER_SIZE > tag_size)
+		return nullptr;
+
+	std::vector<id3_byte_t> buffer;
+	buffer.reserve(std::min(remaining + ID3V2_HEADER_SIZE,
+				size_t(65536)));
+	buffer.insert(buffer.end(), header, header + ID3V2_HEADER_SIZE);
+
+	while (remaining >= ID3V2_FRAME_HEADER_SIZE) {
+		id3_byte_t frame_header[ID3V2_FRAME_HEADER_SIZE];
+		is.ReadFull(frame_header, sizeof(frame_header));
+		remaining -= sizeof(frame_header);
+
+		if (frame_header[0] == 0)
+			/* padding: the rest of the tag is empty */
+			break;
+
+		const size_t frame_size = version == 4
+			? ParseId3SyncSafe(frame_header + 4)
+			: ((size_t(frame_header[4]) << 24) |
+			   (size_t(frame_header[5]) << 16) |
+			   (size_t(frame_header[6]) << 8) |
+			   size_t(frame_header[7]));
+		if (frame_size > remaining)
+			/* corrupt frame header */
+			return nullptr;
+
+		if (IsId3BinaryFrame(frame_header)) {
+			/* seek over the payload without reading it */
+			is.Seek(is.GetOffset() + frame_size);
+		} else {
+			buffer.insert(buffer.end(), frame_header,
+				      frame_header + sizeof(frame_header));
+			const size_t old_size = buffer.size();
+			buffer.resize(old_size + frame_size);
+			is.ReadFull(&buffer[old_size], frame_size);
+		}
+
+		remaining -= frame_size;
+	}
+
+	/* leave the stream at the end of the tag, as if it had been
+	   read completely */
+	if (remaining > 0)
+		is.Seek(is.GetOffset() + remaining);
+
+	if (flags & 0x10)
+		/* skip the footer, which we do not copy */
+		is.Seek(is.GetOffset() + ID3V2_HEADER_SIZE);
+
+	/* patch the size field (and clear the footer flag) to match
+	   the reduced buffer */
+	const size_t new_size = buffer.size() - ID3V2_HEADER_SIZE;
+	buffer[5] &= ~0x10;
+	buffer[6] = (new_size >> 21) & 0x7f;
+	buffer[7] = (new_size >> 14) & 0x7f;
+	buffer[8] = (new_size >> 7) & 0x7f;
+	buffer[9] = new_size & 0x7f;
+
+	return UniqueId3Tag(id3_tag_parse(buffer.data(), buffer.size()));
+} catch (...) {
+	return nullptr;
+}
+
 static UniqueId3Tag
 ReadId3Tag(InputStream &is)
 try {
@@ -63,6 +186,18 @@ try {
 		/* we have enough data already */
 		return UniqueId3Tag(id3_tag_parse(query_buffer, tag_size));
 
+	if (is.CheapSeeking()) {
+		/* try the streaming scanner which skips embedded
+		   cover art */
+		const offset_type frames_start = is.GetOffset();
+		auto tag = ReadId3TagFiltered(is, query_buffer, tag_size);
+		if (tag)
+			return tag;
+
+		/* rewind and fall back to reading the whole tag */
+		is.Seek(frames_start);
+	}
+
 	std::unique_ptr<id3_byte_t[]> tag_buffer(new id3_byte_t[tag_size]);
 
 	/* copy the start of the tag we already have to the allocated
@@ -149,6 +149,9 @@ static void
 tag_id3_import_text(const struct id3_tag *tag, const char *id, TagType type,
 		    TagHandler &handler) noexcept
 {
+	if (!handler.WantTag(type))
+		return;
+
 	const struct id3_frame *frame;
 	for (unsigned i = 0;
 	     (frame = id3_tag_findframe(tag, id, i)) != nullptr; ++i)
@@ -198,6 +201,9 @@ static void
 tag_id3_import_comment(const struct id3_tag *tag, const char *id, TagType type,
 		       TagHandler &handler) noexcept
 {
+	if (!handler.WantTag(type))
+		return;
+
 	const struct id3_frame *frame;
 	for (unsigned i = 0;
 	     (frame = id3_tag_findframe(tag, id, i)) != nullptr; ++i)
@@ -245,7 +251,8 @@ tag_id3_import_musicbrainz(const struct id3_tag *id3_tag,
 
 		TagType type = tag_id3_parse_txxx_name((const char*)name);
 
-		if (type != TAG_NUM_OF_ITEM_TYPES)
+		if (type != TAG_NUM_OF_ITEM_TYPES &&
+		    handler.WantTag(type))
 			handler.OnTag(type, (const char*)value);
 	}
 }
@@ -257,6 +264,9 @@ static void
 tag_id3_import_ufid(const struct id3_tag *id3_tag,
 		    TagHandler &handler) noexcept
 {
+	if (!handler.WantTag(TAG_MUSICBRAINZ_TRACKID))
+		return;
+
 	for (unsigned i = 0;; ++i) {
 		const id3_frame *frame = id3_tag_findframe(id3_tag, "UFID", i);
 		if (frame == nullptr)
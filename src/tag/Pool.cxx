@@ -19,24 +19,51 @@
 
 #include "Pool.hxx"
 #include "Item.hxx"
+#include "lib/icu/CaseFold.hxx"
+#include "thread/Mutex.hxx"
+#include "util/AllocatedString.hxx"
 #include "util/Cast.hxx"
+#include "util/StringAPI.hxx"
 #include "util/VarSize.hxx"
 #include "util/StringView.hxx"
 
+#include <atomic>
 #include <limits>
+#include <mutex>
 
 #include <assert.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdint.h>
 
-Mutex tag_pool_lock;
+/**
+ * The number of independently locked hash table shards.  Must be a
+ * power of two.  Each shard has its own #Mutex, which spreads the
+ * contention of concurrent database update workers.
+ */
+static constexpr size_t NUM_SHARDS = 64;
 
-static constexpr size_t NUM_SLOTS = 4093;
+/**
+ * The initial number of buckets in each shard; the table grows
+ * automatically when the load factor exceeds 2.
+ */
+static constexpr size_t INITIAL_SLOTS_PER_SHARD = 64;
 
 struct TagPoolSlot {
 	TagPoolSlot *next;
 	uint8_t ref = 1;
+
+#ifdef HAVE_ICU_CASE_FOLD
+	/**
+	 * The case-folded representation of #item's value (see
+	 * IcuCaseFold()), or nullptr if folding is an identity
+	 * transformation, in which case #item's value doubles as its
+	 * own shadow.  Pre-computing this once at intern time makes
+	 * case-insensitive matching a plain string search.
+	 */
+	char *folded = nullptr;
+#endif
+
 	TagItem item;
 
 	static constexpr unsigned MAX_REF = std::numeric_limits<decltype(ref)>::max();
@@ -47,6 +74,31 @@ struct TagPoolSlot {
 		item.type = type;
 		memcpy(item.value, value.data, value.size);
 		item.value[value.size] = 0;
+
+#ifdef HAVE_ICU_CASE_FOLD
+		auto f = IcuCaseFold(item.value);
+		if (!StringIsEqual(f.c_str(), item.value))
+			folded = f.Steal();
+#endif
+	}
+
+#ifdef HAVE_ICU_CASE_FOLD
+	~TagPoolSlot() noexcept {
+		delete[] folded;
+	}
+#endif
+
+	/**
+	 * The number of bytes allocated for the case-folded shadow,
+	 * for memory accounting.
+	 */
+	gcc_pure
+	size_t GetFoldedSize() const noexcept {
+#ifdef HAVE_ICU_CASE_FOLD
+		if (folded != nullptr)
+			return strlen(folded) + 1;
+#endif
+		return 0;
 	}
 
 	static TagPoolSlot *Create(TagPoolSlot *_next, TagType type,
@@ -64,8 +116,6 @@ TagPoolSlot::Create(TagPoolSlot *_next, TagType type,
 				       value);
 }
 
-static TagPoolSlot *slots[NUM_SLOTS];
-
 static inline unsigned
 calc_hash(TagType type, StringView p) noexcept
 {
@@ -90,28 +140,108 @@ calc_hash(TagType type, const char *p) noexcept
 	return hash ^ type;
 }
 
+struct TagPoolShard {
+	Mutex mutex;
+
+	/**
+	 * The number of buckets in #slots; 0 as long as the shard is
+	 * unused.
+	 */
+	size_t n_slots = 0;
+
+	/**
+	 * The number of items stored in this shard.
+	 */
+	size_t n_items = 0;
+
+	TagPoolSlot **slots = nullptr;
+
+	TagPoolSlot **GetSlot(unsigned hash) noexcept {
+		/* the low bits select the shard; use the remaining
+		   bits for the bucket */
+		return &slots[(hash / NUM_SHARDS) % n_slots];
+	}
+
+	/**
+	 * Double the number of buckets when the load factor exceeds
+	 * 2, so chains stay short even with millions of distinct tag
+	 * strings.
+	 *
+	 * Caller must lock #mutex.
+	 */
+	void AutoGrow() noexcept;
+};
+
+static TagPoolShard shards[NUM_SHARDS];
+
+/**
+ * The total size of all live #TagPoolSlot allocations, maintained
+ * under the shard mutexes but read without; see
+ * tag_pool_get_memory_usage().
+ */
+static std::atomic<size_t> tag_pool_slot_bytes;
+
+static constexpr size_t
+tag_pool_slot_size(size_t value_size) noexcept
+{
+	return sizeof(TagPoolSlot) - sizeof(TagItem::value) +
+		value_size + 1;
+}
+
+void
+TagPoolShard::AutoGrow() noexcept
+{
+	if (n_items < n_slots * 2)
+		return;
+
+	const size_t new_n_slots = n_slots * 2;
+	auto **new_slots = new TagPoolSlot *[new_n_slots]();
+
+	for (size_t i = 0; i < n_slots; ++i) {
+		TagPoolSlot *slot = slots[i], *next;
+		for (; slot != nullptr; slot = next) {
+			next = slot->next;
+
+			const unsigned hash = calc_hash(slot->item.type,
+							slot->item.value);
+			auto **p = &new_slots[(hash / NUM_SHARDS) % new_n_slots];
+			slot->next = *p;
+			*p = slot;
+		}
+	}
+
+	delete[] slots;
+	slots = new_slots;
+	n_slots = new_n_slots;
+}
+
 static inline constexpr TagPoolSlot *
 tag_item_to_slot(TagItem *item) noexcept
 {
 	return &ContainerCast(*item, &TagPoolSlot::item);
 }
 
-static inline TagPoolSlot **
-tag_value_slot_p(TagType type, StringView value) noexcept
+static TagPoolShard &
+tag_value_shard(unsigned hash) noexcept
 {
-	return &slots[calc_hash(type, value) % NUM_SLOTS];
+	return shards[hash % NUM_SHARDS];
 }
 
-static inline TagPoolSlot **
-tag_value_slot_p(TagType type, const char *value) noexcept
+/**
+ * Find or create an item in the given shard.
+ *
+ * Caller must lock the shard.
+ */
+static TagItem *
+tag_pool_get_item_locked(TagPoolShard &shard, unsigned hash,
+			 TagType type, StringView value) noexcept
 {
-	return &slots[calc_hash(type, value) % NUM_SLOTS];
-}
+	if (shard.slots == nullptr) {
+		shard.n_slots = INITIAL_SLOTS_PER_SHARD;
+		shard.slots = new TagPoolSlot *[shard.n_slots]();
+	}
 
-TagItem *
-tag_pool_get_item(TagType type, StringView value) noexcept
-{
-	auto slot_p = tag_value_slot_p(type, value);
+	auto slot_p = shard.GetSlot(hash);
 	for (auto slot = *slot_p; slot != nullptr; slot = slot->next) {
 		if (slot->item.type == type &&
 		    value.Equals(slot->item.value) &&
@@ -124,14 +254,34 @@ tag_pool_get_item(TagType type, StringView value) noexcept
 
 	auto slot = TagPoolSlot::Create(*slot_p, type, value);
 	*slot_p = slot;
+	++shard.n_items;
+	tag_pool_slot_bytes.fetch_add(tag_pool_slot_size(value.size) +
+				      slot->GetFoldedSize(),
+				      std::memory_order_relaxed);
+	shard.AutoGrow();
 	return &slot->item;
 }
 
+TagItem *
+tag_pool_get_item(TagType type, StringView value) noexcept
+{
+	const unsigned hash = calc_hash(type, value);
+	auto &shard = tag_value_shard(hash);
+
+	const std::lock_guard<Mutex> protect(shard.mutex);
+	return tag_pool_get_item_locked(shard, hash, type, value);
+}
+
 TagItem *
 tag_pool_dup_item(TagItem *item) noexcept
 {
 	TagPoolSlot *slot = tag_item_to_slot(item);
 
+	const unsigned hash = calc_hash(item->type, item->value);
+	auto &shard = tag_value_shard(hash);
+
+	const std::lock_guard<Mutex> protect(shard.mutex);
+
 	assert(slot->ref > 0);
 
 	if (slot->ref < TagPoolSlot::MAX_REF) {
@@ -140,8 +290,10 @@ tag_pool_dup_item(TagItem *item) noexcept
 	} else {
 		/* the reference counter overflows above MAX_REF;
 		   obtain a reference to a different TagPoolSlot which
-		   isn't yet "full" */
-		return tag_pool_get_item(item->type, item->value);
+		   isn't yet "full"; note that the duplicate lives in
+		   the same shard, because it has the same hash */
+		return tag_pool_get_item_locked(shard, hash,
+						item->type, item->value);
 	}
 }
 
@@ -151,18 +303,51 @@ tag_pool_put_item(TagItem *item) noexcept
 	TagPoolSlot **slot_p, *slot;
 
 	slot = tag_item_to_slot(item);
+
+	const unsigned hash = calc_hash(item->type, item->value);
+	auto &shard = tag_value_shard(hash);
+
+	const std::lock_guard<Mutex> protect(shard.mutex);
+
 	assert(slot->ref > 0);
 	--slot->ref;
 
 	if (slot->ref > 0)
 		return;
 
-	for (slot_p = tag_value_slot_p(item->type, item->value);
+	for (slot_p = shard.GetSlot(hash);
 	     *slot_p != slot;
 	     slot_p = &(*slot_p)->next) {
 		assert(*slot_p != nullptr);
 	}
 
 	*slot_p = slot->next;
+	--shard.n_items;
+	tag_pool_slot_bytes.fetch_sub(tag_pool_slot_size(strlen(item->value)) +
+				      slot->GetFoldedSize(),
+				      std::memory_order_relaxed);
 	DeleteVarSize(slot);
 }
+
+const char *
+tag_item_folded_value(const TagItem *item) noexcept
+{
+#ifdef HAVE_ICU_CASE_FOLD
+	const auto *slot = tag_item_to_slot(const_cast<TagItem *>(item));
+	if (slot->folded != nullptr)
+		return slot->folded;
+#endif
+
+	return item->value;
+}
+
+size_t
+tag_pool_get_memory_usage() noexcept
+{
+	size_t result = tag_pool_slot_bytes.load(std::memory_order_relaxed);
+
+	for (const auto &shard : shards)
+		result += shard.n_slots * sizeof(TagPoolSlot *);
+
+	return result;
+}
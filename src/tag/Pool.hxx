@@ -21,13 +21,17 @@
 #define MPD_TAG_POOL_HXX
 
 #include "Type.h"
-#include "thread/Mutex.hxx"
+#include "util/Compiler.h"
 
-extern Mutex tag_pool_lock;
+#include <stddef.h>
 
 struct TagItem;
 struct StringView;
 
+/* the tag pool is internally synchronized; it is sharded into many
+   independently locked hash tables, and callers need no external
+   lock */
+
 TagItem *
 tag_pool_get_item(TagType type, StringView value) noexcept;
 
@@ -37,4 +41,24 @@ tag_pool_dup_item(TagItem *item) noexcept;
 void
 tag_pool_put_item(TagItem *item) noexcept;
 
+/**
+ * Returns the case-folded representation of an interned tag value
+ * (see IcuCaseFold()), pre-computed when the value was interned.  If
+ * folding the value is an identity transformation (or no case
+ * folding implementation is available), the original string is
+ * returned, sharing its storage.  The returned pointer is valid as
+ * long as the item's reference.
+ */
+gcc_pure
+const char *
+tag_item_folded_value(const TagItem *item) noexcept;
+
+/**
+ * An estimate of the number of bytes currently allocated by the tag
+ * pool (slots and bucket arrays), for memory accounting.  The value
+ * is read without locking and may be slightly stale.
+ */
+size_t
+tag_pool_get_memory_usage() noexcept;
+
 #endif
@@ -29,15 +29,25 @@ Tag::Clear() noexcept
 	duration = SignedSongTime::Negative();
 	has_playlist = false;
 
-	{
-		const std::lock_guard<Mutex> protect(tag_pool_lock);
-		for (unsigned i = 0; i < num_items; ++i)
-			tag_pool_put_item(items[i]);
-	}
+	for (unsigned i = 0; i < num_items; ++i)
+		tag_pool_put_item(items[i]);
 
-	delete[] items;
+	if (owns_items)
+		delete[] items;
 	items = nullptr;
 	num_items = 0;
+	owns_items = true;
+}
+
+void
+Tag::RelocateItems(TagItem **new_items) noexcept
+{
+	std::copy_n(items, num_items, new_items);
+
+	if (owns_items)
+		delete[] items;
+	items = new_items;
+	owns_items = false;
 }
 
 Tag::Tag(const Tag &other) noexcept
@@ -48,7 +58,6 @@ Tag::Tag(const Tag &other) noexcept
 	if (num_items > 0) {
 		items = new TagItem *[num_items];
 
-		const std::lock_guard<Mutex> protect(tag_pool_lock);
 		for (unsigned i = 0; i < num_items; i++)
 			items[i] = tag_pool_dup_item(other.items[i]);
 	}
@@ -48,6 +48,14 @@ struct Tag {
 	/** the total number of tag items in the #items array */
 	unsigned short num_items = 0;
 
+	/**
+	 * Is the #items array owned by this object?  If false, then
+	 * it lives in somebody else's memory (e.g. the database's
+	 * #TagItemArena) and will not be freed here.  The individual
+	 * items are reference-counted by the tag pool either way.
+	 */
+	bool owns_items = true;
+
 	/** an array of tag items */
 	TagItem **items = nullptr;
 
@@ -60,9 +68,11 @@ struct Tag {
 
 	Tag(Tag &&other) noexcept
 		:duration(other.duration), has_playlist(other.has_playlist),
-		 num_items(other.num_items), items(other.items) {
+		 num_items(other.num_items), owns_items(other.owns_items),
+		 items(other.items) {
 		other.items = nullptr;
 		other.num_items = 0;
+		other.owns_items = true;
 	}
 
 	/**
@@ -88,8 +98,17 @@ struct Tag {
 	void MoveItemsFrom(Tag &&other) noexcept {
 		std::swap(items, other.items);
 		std::swap(num_items, other.num_items);
+		std::swap(owns_items, other.owns_items);
 	}
 
+	/**
+	 * Move the #items array into the given buffer (which must
+	 * have room for #num_items pointers) and free the old one.
+	 * The buffer is owned by the caller, who must guarantee that
+	 * it lives at least as long as this object.
+	 */
+	void RelocateItems(TagItem **new_items) noexcept;
+
 	/**
 	 * Returns true if the tag contains no items.  This ignores
 	 * the "duration" attribute.
@@ -29,6 +29,9 @@
 
 #include "Util.hxx"
 #include "system/Error.hxx"
+#include "util/RuntimeError.hxx"
+
+#include <stdlib.h>
 
 #ifdef __linux__
 #include <sched.h>
@@ -112,3 +115,59 @@ SetThreadRealtime()
 		throw MakeErrno("sched_setscheduler failed");
 #endif	// __linux__
 };
+
+uint64_t
+ParseCpuAffinity(const char *s)
+{
+	const char *const begin = s;
+	uint64_t mask = 0;
+
+	while (true) {
+		char *endptr;
+		unsigned long first = strtoul(s, &endptr, 10);
+		if (endptr == s || first >= 64)
+			throw FormatRuntimeError("Malformed CPU list: %s",
+						 begin);
+
+		unsigned long last = first;
+		if (*endptr == '-') {
+			s = endptr + 1;
+			last = strtoul(s, &endptr, 10);
+			if (endptr == s || last >= 64 || last < first)
+				throw FormatRuntimeError("Malformed CPU list: %s",
+							 begin);
+		}
+
+		for (unsigned long i = first; i <= last; ++i)
+			mask |= uint64_t(1) << i;
+
+		if (*endptr == 0)
+			break;
+
+		if (*endptr != ',')
+			throw FormatRuntimeError("Malformed CPU list: %s",
+						 begin);
+
+		s = endptr + 1;
+	}
+
+	return mask;
+}
+
+void
+SetThreadAffinity(uint64_t cpu_mask)
+{
+#ifdef __linux__
+	cpu_set_t cpu_set;
+	CPU_ZERO(&cpu_set);
+
+	for (unsigned i = 0; i < 64; ++i)
+		if (cpu_mask & (uint64_t(1) << i))
+			CPU_SET(i, &cpu_set);
+
+	if (sched_setaffinity(0, sizeof(cpu_set), &cpu_set) < 0)
+		throw MakeErrno("sched_setaffinity failed");
+#else
+	(void)cpu_mask;
+#endif	// __linux__
+}
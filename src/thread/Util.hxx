@@ -30,6 +30,8 @@
 #ifndef THREAD_UTIL_HXX
 #define THREAD_UTIL_HXX
 
+#include <stdint.h>
+
 /**
  * Lower the current thread's priority to "idle" (very low).
  */
@@ -44,4 +46,24 @@ SetThreadIdlePriority() noexcept;
 void
 SetThreadRealtime();
 
+/**
+ * Parse a CPU list in Linux "cpulist" syntax (e.g. "0-3,8") into a
+ * bit mask suitable for SetThreadAffinity().  Only CPUs 0..63 can be
+ * specified.
+ *
+ * Throws std::runtime_error if the string is malformed.
+ */
+uint64_t
+ParseCpuAffinity(const char *s);
+
+/**
+ * Bind the current thread to the given set of CPUs (one bit per
+ * CPU).  Threads created afterwards by this thread inherit the mask.
+ * This is a no-op on systems other than Linux.
+ *
+ * Throws std::system_error on error.
+ */
+void
+SetThreadAffinity(uint64_t cpu_mask);
+
 #endif
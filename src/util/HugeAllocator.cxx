@@ -33,7 +33,6 @@
 
 #ifdef __linux__
 #include <sys/mman.h>
-#include <unistd.h>
 #else
 #include <stdlib.h>
 #endif
@@ -41,24 +40,26 @@
 #ifdef __linux__
 
 /**
- * Round up the parameter, make it page-aligned.
+ * The size of a "huge page" (2 MB on x86) assumed by this code.  The
+ * kernel can only back a region with transparent huge pages if it
+ * spans whole huge pages, so allocations are rounded up to this size.
+ */
+static constexpr size_t HUGE_PAGE_SIZE = 512 * 4096;
+
+/**
+ * Round up the parameter, make it huge-page-aligned.
  */
 gcc_const
 static size_t
-AlignToPageSize(size_t size) noexcept
+AlignToHugePageSize(size_t size) noexcept
 {
-	static const long page_size = sysconf(_SC_PAGESIZE);
-	if (page_size <= 0)
-		return size;
-
-	size_t ps(page_size);
-	return (size + ps - 1) / ps * ps;
+	return (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
 }
 
 WritableBuffer<void>
 HugeAllocate(size_t size)
 {
-	size = AlignToPageSize(size);
+	size = AlignToHugePageSize(size);
 
 	constexpr int flags = MAP_ANONYMOUS|MAP_PRIVATE|MAP_NORESERVE;
 	void *p = mmap(nullptr, size,
@@ -79,14 +80,14 @@ HugeAllocate(size_t size)
 void
 HugeFree(void *p, size_t size) noexcept
 {
-	munmap(p, AlignToPageSize(size));
+	munmap(p, AlignToHugePageSize(size));
 }
 
 void
 HugeForkCow(void *p, size_t size, bool enable) noexcept
 {
 #ifdef MADV_DONTFORK
-	madvise(p, AlignToPageSize(size),
+	madvise(p, AlignToHugePageSize(size),
 		enable ? MADV_DOFORK : MADV_DONTFORK);
 #endif
 }
@@ -95,7 +96,7 @@ void
 HugeDiscard(void *p, size_t size) noexcept
 {
 #ifdef MADV_DONTNEED
-	madvise(p, AlignToPageSize(size), MADV_DONTNEED);
+	madvise(p, AlignToHugePageSize(size), MADV_DONTNEED);
 #endif
 }
 
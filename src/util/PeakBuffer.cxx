@@ -18,17 +18,58 @@
  */
 
 #include "PeakBuffer.hxx"
+#include "PeakBufferPool.hxx"
 #include "DynamicFifoBuffer.hxx"
 
 #include <algorithm>
+#include <atomic>
 
 #include <assert.h>
 #include <string.h>
 
+/**
+ * The capacity of all buffers currently held by #PeakBuffer
+ * instances (process-wide); spare buffers recycled by a
+ * #PeakBufferPool are not included.
+ */
+static std::atomic<size_t> peak_buffer_bytes;
+
+size_t
+peak_buffer_get_memory_usage() noexcept
+{
+	return peak_buffer_bytes.load(std::memory_order_relaxed);
+}
+
+inline DynamicFifoBuffer<uint8_t> *
+PeakBuffer::AllocateBuffer(size_t size) noexcept
+{
+	auto *buffer = pool != nullptr
+		? pool->Allocate(size)
+		: new DynamicFifoBuffer<uint8_t>(size);
+	peak_buffer_bytes.fetch_add(buffer->GetCapacity(),
+				    std::memory_order_relaxed);
+	return buffer;
+}
+
+inline void
+PeakBuffer::ReleaseBuffer(DynamicFifoBuffer<uint8_t> *buffer) noexcept
+{
+	peak_buffer_bytes.fetch_sub(buffer->GetCapacity(),
+				    std::memory_order_relaxed);
+
+	if (pool != nullptr)
+		pool->Release(buffer);
+	else
+		delete buffer;
+}
+
 PeakBuffer::~PeakBuffer()
 {
-	delete normal_buffer;
-	delete peak_buffer;
+	if (normal_buffer != nullptr)
+		ReleaseBuffer(normal_buffer);
+
+	if (peak_buffer != nullptr)
+		ReleaseBuffer(peak_buffer);
 }
 
 bool
@@ -38,6 +79,20 @@ PeakBuffer::empty() const noexcept
 		(peak_buffer == nullptr || peak_buffer->empty());
 }
 
+size_t
+PeakBuffer::GetAvailable() const noexcept
+{
+	size_t result = 0;
+
+	if (normal_buffer != nullptr)
+		result += normal_buffer->GetAvailable();
+
+	if (peak_buffer != nullptr)
+		result += peak_buffer->GetAvailable();
+
+	return result;
+}
+
 WritableBuffer<void>
 PeakBuffer::Read() const noexcept
 {
@@ -56,6 +111,27 @@ PeakBuffer::Read() const noexcept
 	return nullptr;
 }
 
+size_t
+PeakBuffer::Read(WritableBuffer<void> *segments,
+		 size_t max_segments) const noexcept
+{
+	size_t n = 0;
+
+	if (normal_buffer != nullptr && n < max_segments) {
+		const auto p = normal_buffer->Read();
+		if (!p.empty())
+			segments[n++] = p.ToVoid();
+	}
+
+	if (peak_buffer != nullptr && n < max_segments) {
+		const auto p = peak_buffer->Read();
+		if (!p.empty())
+			segments[n++] = p.ToVoid();
+	}
+
+	return n;
+}
+
 void
 PeakBuffer::Consume(size_t length) noexcept
 {
@@ -67,7 +143,7 @@ PeakBuffer::Consume(size_t length) noexcept
 	if (peak_buffer != nullptr && !peak_buffer->empty()) {
 		peak_buffer->Consume(length);
 		if (peak_buffer->empty()) {
-			delete peak_buffer;
+			ReleaseBuffer(peak_buffer);
 			peak_buffer = nullptr;
 		}
 
@@ -113,7 +189,7 @@ PeakBuffer::Append(const void *data, size_t length)
 	}
 
 	if (normal_buffer == nullptr)
-		normal_buffer = new DynamicFifoBuffer<uint8_t>(normal_size);
+		normal_buffer = AllocateBuffer(normal_size);
 
 	size_t nbytes = AppendTo(*normal_buffer, data, length);
 	if (nbytes > 0) {
@@ -125,7 +201,7 @@ PeakBuffer::Append(const void *data, size_t length)
 
 	if (peak_buffer == nullptr) {
 		if (peak_size > 0)
-			peak_buffer = new DynamicFifoBuffer<uint8_t>(peak_size);
+			peak_buffer = AllocateBuffer(peak_size);
 		if (peak_buffer == nullptr)
 			return false;
 	}
@@ -27,24 +27,43 @@
 
 template<typename T> struct WritableBuffer;
 template<typename T> class DynamicFifoBuffer;
+class PeakBufferPool;
+
+/**
+ * The number of bytes currently held by all #PeakBuffer instances
+ * in this process, for memory accounting.
+ */
+gcc_pure
+size_t
+peak_buffer_get_memory_usage() noexcept;
 
 /**
  * A FIFO-like buffer that will allocate more memory on demand to
  * allow large peaks.  This second buffer will be given back to the
- * kernel when it has been consumed.
+ * kernel (or to the optional #PeakBufferPool) when it has been
+ * consumed.
  */
 class PeakBuffer {
 	size_t normal_size, peak_size;
 
+	/**
+	 * An optional pool which recycles buffers across #PeakBuffer
+	 * instances; may be nullptr.
+	 */
+	PeakBufferPool *pool;
+
 	DynamicFifoBuffer<uint8_t> *normal_buffer, *peak_buffer;
 
 public:
-	PeakBuffer(size_t _normal_size, size_t _peak_size)
+	PeakBuffer(size_t _normal_size, size_t _peak_size,
+		   PeakBufferPool *_pool=nullptr)
 		:normal_size(_normal_size), peak_size(_peak_size),
+		 pool(_pool),
 		 normal_buffer(nullptr), peak_buffer(nullptr) {}
 
 	PeakBuffer(PeakBuffer &&other)
 		:normal_size(other.normal_size), peak_size(other.peak_size),
+		 pool(other.pool),
 		 normal_buffer(other.normal_buffer),
 		 peak_buffer(other.peak_buffer) {
 		other.normal_buffer = nullptr;
@@ -59,12 +78,31 @@ public:
 	gcc_pure
 	bool empty() const noexcept;
 
+	/**
+	 * The total number of bytes stored in this buffer.
+	 */
+	gcc_pure
+	size_t GetAvailable() const noexcept;
+
 	gcc_pure
 	WritableBuffer<void> Read() const noexcept;
 
+	/**
+	 * Fill the given array with up to #max_segments contiguous
+	 * data segments (normal buffer first, then the peak buffer).
+	 *
+	 * @return the number of segments filled in
+	 */
+	size_t Read(WritableBuffer<void> *segments,
+		    size_t max_segments) const noexcept;
+
 	void Consume(size_t length) noexcept;
 
 	bool Append(const void *data, size_t length);
+
+private:
+	DynamicFifoBuffer<uint8_t> *AllocateBuffer(size_t size) noexcept;
+	void ReleaseBuffer(DynamicFifoBuffer<uint8_t> *buffer) noexcept;
 };
 
 #endif
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2003-2019 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "PeakBufferPool.hxx"
+#include "DynamicFifoBuffer.hxx"
+
+DynamicFifoBuffer<uint8_t> *
+PeakBufferPool::Allocate(size_t size) noexcept
+{
+	auto i = classes.find(size);
+	if (i != classes.end() && !i->second.empty()) {
+		auto *buffer = i->second.back();
+		i->second.pop_back();
+		return buffer;
+	}
+
+	return new DynamicFifoBuffer<uint8_t>(size);
+}
+
+void
+PeakBufferPool::Release(DynamicFifoBuffer<uint8_t> *buffer) noexcept
+{
+	auto &idle = classes[buffer->GetCapacity()];
+	if (idle.size() >= MAX_PER_CLASS) {
+		delete buffer;
+		return;
+	}
+
+	buffer->Clear();
+	idle.push_back(buffer);
+}
+
+void
+PeakBufferPool::Clear() noexcept
+{
+	for (auto &i : classes)
+		for (auto *buffer : i.second)
+			delete buffer;
+
+	classes.clear();
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2003-2019 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_PEAK_BUFFER_POOL_HXX
+#define MPD_PEAK_BUFFER_POOL_HXX
+
+#include <map>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+template<typename T> class DynamicFifoBuffer;
+
+/**
+ * A pool of recycled #DynamicFifoBuffer instances for #PeakBuffer,
+ * grouped into size classes.  Instead of freeing a (possibly large)
+ * peak buffer after each burst and allocating a fresh one for the
+ * next, a bounded number of buffers per size class is kept for reuse,
+ * avoiding allocator churn when many users (e.g. connected clients)
+ * produce bursty output.
+ *
+ * This class is not thread-safe; all buffers allocated from a pool
+ * must be allocated and released in the same thread.
+ */
+class PeakBufferPool {
+	/**
+	 * The maximum number of idle buffers kept per size class;
+	 * buffers released beyond this limit are freed immediately.
+	 */
+	static constexpr size_t MAX_PER_CLASS = 4;
+
+	std::map<size_t, std::vector<DynamicFifoBuffer<uint8_t> *>> classes;
+
+public:
+	PeakBufferPool() = default;
+
+	~PeakBufferPool() noexcept {
+		Clear();
+	}
+
+	PeakBufferPool(const PeakBufferPool &) = delete;
+	PeakBufferPool &operator=(const PeakBufferPool &) = delete;
+
+	/**
+	 * Obtain an empty buffer with the given capacity, reusing an
+	 * idle one if possible.
+	 */
+	DynamicFifoBuffer<uint8_t> *Allocate(size_t size) noexcept;
+
+	/**
+	 * Return a buffer to the pool.  Its contents are discarded.
+	 */
+	void Release(DynamicFifoBuffer<uint8_t> *buffer) noexcept;
+
+	/**
+	 * Free all idle buffers.
+	 */
+	void Clear() noexcept;
+};
+
+#endif
@@ -23,6 +23,7 @@
 #include "HugeAllocator.hxx"
 #include "Compiler.h"
 
+#include <atomic>
 #include <utility>
 #include <new>
 
@@ -32,6 +33,10 @@
 /**
  * This class pre-allocates a certain number of objects, and allows
  * callers to allocate and free these objects ("slices").
+ *
+ * This class is thread-safe without a mutex, under one restriction:
+ * Allocate() may only ever be called by one thread at a time, while
+ * Free() may be called concurrently by any number of threads.
  */
 template<typename T>
 class SliceBuffer {
@@ -47,18 +52,35 @@ class SliceBuffer {
 	 * The number of slices that are initialized.  This is used to
 	 * avoid page faulting on the new allocation, so the kernel
 	 * does not need to reserve physical memory pages.
+	 *
+	 * Modified only by the allocating thread (and by the thread
+	 * holding #discarding, which excludes the allocating thread);
+	 * atomic nevertheless so the discarding store is formally
+	 * data-race-free.
 	 */
-	unsigned n_initialized = 0;
+	std::atomic_uint n_initialized{0};
 
 	/**
 	 * The number of slices currently allocated.
 	 */
-	unsigned n_allocated = 0;
+	std::atomic_uint n_allocated{0};
 
 	/**
-	 * Pointer to the first free element in the chain.
+	 * The head of a Treiber stack of free elements.  Allocate()
+	 * pops, Free() pushes.  Since there is only a single popping
+	 * thread, the stack is immune to the ABA problem: a popped
+	 * slice can only reappear at the head after this very thread
+	 * has freed it again.
 	 */
-	Slice *available = nullptr;
+	std::atomic<Slice *> available{nullptr};
+
+	/**
+	 * Serializes the discard-on-empty in Free() against a
+	 * concurrent Allocate().  Uses sequentially consistent
+	 * operations because Allocate() must never miss the flag
+	 * after a freeing thread has missed its counter increment.
+	 */
+	std::atomic_bool discarding{false};
 
 public:
 	SliceBuffer(unsigned _count)
@@ -80,50 +102,63 @@ public:
 	}
 
 	bool empty() const noexcept {
-		return n_allocated == 0;
+		return n_allocated.load(std::memory_order_relaxed) == 0;
 	}
 
 	bool IsFull() const noexcept {
-		return n_allocated == buffer.size();
+		return n_allocated.load(std::memory_order_relaxed) == buffer.size();
 	}
 
+	/**
+	 * May only be called while no slices are allocated and no
+	 * other thread can call Allocate() or Free().
+	 */
 	void DiscardMemory() noexcept {
 		assert(empty());
 
-		n_initialized = 0;
+		n_initialized.store(0, std::memory_order_relaxed);
 		buffer.Discard();
-		available = nullptr;
+		available.store(nullptr, std::memory_order_relaxed);
 	}
 
 	template<typename... Args>
 	T *Allocate(Args&&... args) {
-		assert(n_initialized <= buffer.size());
-		assert(n_allocated <= n_initialized);
-
-		if (available == nullptr) {
-			if (n_initialized == buffer.size()) {
+		assert(n_initialized.load(std::memory_order_relaxed) <= buffer.size());
+
+		/* announce the allocation before touching the stack
+		   so a concurrent Free() cannot decide to discard the
+		   buffer under our feet */
+		n_allocated.fetch_add(1);
+
+		/* if a discard was already underway when we announced
+		   ourselves, wait for it to finish */
+		while (discarding.load()) {}
+
+		/* pop a slice off the free stack */
+		Slice *slice = available.load(std::memory_order_acquire);
+		while (slice != nullptr &&
+		       !available.compare_exchange_weak(slice, slice->next,
+							std::memory_order_acquire,
+							std::memory_order_acquire)) {}
+
+		if (slice == nullptr) {
+			unsigned i = n_initialized.load(std::memory_order_relaxed);
+			if (i == buffer.size()) {
 				/* out of (internal) memory, buffer is full */
-				assert(n_allocated == buffer.size());
+				n_allocated.fetch_sub(1);
 				return nullptr;
 			}
 
-			available = &buffer[n_initialized++];
-			available->next = nullptr;
+			slice = &buffer[i];
+			n_initialized.store(i + 1, std::memory_order_relaxed);
 		}
 
-		/* allocate a slice */
-		T *value = &available->value;
-		available = available->next;
-		++n_allocated;
-
 		/* construct the object */
-		return ::new((void *)value) T(std::forward<Args>(args)...);
+		return ::new((void *)&slice->value) T(std::forward<Args>(args)...);
 	}
 
 	void Free(T *value) noexcept {
-		assert(n_initialized <= buffer.size());
-		assert(n_allocated > 0);
-		assert(n_allocated <= n_initialized);
+		assert(n_initialized.load(std::memory_order_relaxed) <= buffer.size());
 
 		Slice *slice = reinterpret_cast<Slice *>(value);
 		assert(slice >= &buffer.front() && slice <= &buffer.back());
@@ -131,15 +166,28 @@ public:
 		/* destruct the object */
 		value->~T();
 
-		/* insert the slice in the "available" linked list */
-		slice->next = available;
-		available = slice;
-		--n_allocated;
+		/* push the slice onto the free stack */
+		Slice *head = available.load(std::memory_order_relaxed);
+		do {
+			slice->next = head;
+		} while (!available.compare_exchange_weak(head, slice,
+							  std::memory_order_release,
+							  std::memory_order_relaxed));
 
 		/* give memory back to the kernel when the last slice
-		   was freed */
-		if (n_allocated == 0) {
-			DiscardMemory();
+		   was freed; the flag blocks out a concurrent
+		   Allocate(), which spins until the discard is
+		   complete and then starts over on the fresh buffer */
+		if (n_allocated.fetch_sub(1) == 1 &&
+		    !discarding.exchange(true)) {
+			if (n_allocated.load() == 0) {
+				n_initialized.store(0, std::memory_order_relaxed);
+				buffer.Discard();
+				available.store(nullptr,
+						std::memory_order_relaxed);
+			}
+
+			discarding.store(false);
 		}
 	}
 };
@@ -22,7 +22,9 @@
 
 #include "Compiler.h"
 
+#include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 extern const uint8_t bit_reverse_table[256];
 
@@ -33,4 +35,32 @@ bit_reverse(uint8_t x)
 	return bit_reverse_table[x];
 }
 
+/**
+ * Reverse the bits of each byte in the given buffer.  The bulk of
+ * the buffer is processed one machine word at a time with three
+ * shift/mask steps (the masks keep all bits inside their byte, so
+ * this is endian-independent), which the compiler can vectorize;
+ * only the unaligned tail falls back to the table.
+ */
+static inline void
+bit_reverse_buffer(uint8_t *p, uint8_t *end)
+{
+	static const uint64_t m1 = 0x5555555555555555ULL;
+	static const uint64_t m2 = 0x3333333333333333ULL;
+	static const uint64_t m4 = 0x0f0f0f0f0f0f0f0fULL;
+
+	for (; (size_t)(end - p) >= sizeof(uint64_t);
+	     p += sizeof(uint64_t)) {
+		uint64_t x;
+		memcpy(&x, p, sizeof(x));
+		x = ((x >> 1) & m1) | ((x & m1) << 1);
+		x = ((x >> 2) & m2) | ((x & m2) << 2);
+		x = ((x >> 4) & m4) | ((x & m4) << 4);
+		memcpy(p, &x, sizeof(x));
+	}
+
+	for (; p != end; ++p)
+		*p = bit_reverse(*p);
+}
+
 #endif
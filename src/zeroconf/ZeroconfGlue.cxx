@@ -23,6 +23,7 @@
 #include "config/Data.hxx"
 #include "config/Option.hxx"
 #include "Listen.hxx"
+#include "event/Call.hxx"
 #include "util/Domain.hxx"
 #include "Log.hxx"
 #include "util/Compiler.h"
@@ -48,8 +49,15 @@ static constexpr Domain zeroconf_domain("zeroconf");
 
 static int zeroconfEnabled;
 
+/**
+ * The #EventLoop running the zeroconf implementation; it belongs to
+ * another thread, so all calls into the implementation are routed
+ * through BlockingCall().
+ */
+static EventLoop *zeroconf_event_loop;
+
 void
-ZeroconfInit(const ConfigData &config, gcc_unused EventLoop &loop)
+ZeroconfInit(const ConfigData &config, EventLoop &loop)
 {
 	const char *serviceName;
 
@@ -80,13 +88,17 @@ ZeroconfInit(const ConfigData &config, gcc_unused EventLoop &loop)
 		}
 	}
 
+	zeroconf_event_loop = &loop;
+
+	BlockingCall(loop, [&loop, serviceName](){
 #ifdef HAVE_AVAHI
-	AvahiInit(loop, serviceName);
+		AvahiInit(loop, serviceName);
 #endif
 
 #ifdef HAVE_BONJOUR
-	BonjourInit(loop, serviceName);
+		BonjourInit(loop, serviceName);
 #endif
+	});
 }
 
 void
@@ -95,11 +107,13 @@ ZeroconfDeinit()
 	if (!zeroconfEnabled)
 		return;
 
+	BlockingCall(*zeroconf_event_loop, [](){
 #ifdef HAVE_AVAHI
-	AvahiDeinit();
+		AvahiDeinit();
 #endif /* HAVE_AVAHI */
 
 #ifdef HAVE_BONJOUR
-	BonjourDeinit();
+		BonjourDeinit();
 #endif
+	});
 }
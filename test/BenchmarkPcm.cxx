@@ -0,0 +1,154 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Throughput benchmarks for the PCM kernels (volume, mix, format
+ * conversion), so regressions in these hot loops show up in numbers
+ * instead of in bug reports.
+ */
+
+#include "pcm/Volume.hxx"
+#include "pcm/PcmMix.hxx"
+#include "pcm/PcmConvert.hxx"
+#include "pcm/PcmDither.hxx"
+#include "AudioFormat.hxx"
+#include "util/ConstBuffer.hxx"
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+
+#include <stdint.h>
+
+static constexpr size_t N_SAMPLES = 4096;
+
+/**
+ * Fill the buffer with a deterministic pseudo-random signal.  The
+ * optional right shift confines the values to a smaller range
+ * (e.g. 8 for 24 bit samples in 32 bit integers).
+ */
+template<typename T>
+static void
+FillSignal(T *p, size_t n, unsigned shift) noexcept
+{
+	uint32_t seed = 42;
+	for (size_t i = 0; i < n; ++i) {
+		seed = seed * 1664525u + 1013904223u;
+		p[i] = T(int32_t(seed) >> shift);
+	}
+}
+
+static void
+FillSignal(float *p, size_t n, unsigned) noexcept
+{
+	uint32_t seed = 42;
+	for (size_t i = 0; i < n; ++i) {
+		seed = seed * 1664525u + 1013904223u;
+		p[i] = float(int32_t(seed)) / 2147483648.f;
+	}
+}
+
+template<SampleFormat F, typename T, unsigned shift=0>
+static void
+BenchmarkPcmVolume(benchmark::State &state)
+{
+	std::array<T, N_SAMPLES> src;
+	FillSignal(src.data(), src.size(), shift);
+
+	PcmVolume pv;
+	pv.Open(F);
+	pv.SetVolume(PCM_VOLUME_1 * 3 / 4);
+
+	for (auto _ : state) {
+		auto result = pv.Apply({src.data(), sizeof(src)});
+		benchmark::DoNotOptimize(result);
+	}
+
+	pv.Close();
+
+	state.SetBytesProcessed(int64_t(state.iterations()) * sizeof(src));
+}
+
+BENCHMARK_TEMPLATE(BenchmarkPcmVolume, SampleFormat::S8, int8_t);
+BENCHMARK_TEMPLATE(BenchmarkPcmVolume, SampleFormat::S16, int16_t);
+BENCHMARK_TEMPLATE(BenchmarkPcmVolume, SampleFormat::S24_P32, int32_t, 8);
+BENCHMARK_TEMPLATE(BenchmarkPcmVolume, SampleFormat::S32, int32_t);
+BENCHMARK_TEMPLATE(BenchmarkPcmVolume, SampleFormat::FLOAT, float);
+
+template<SampleFormat F, typename T, unsigned shift=0>
+static void
+BenchmarkPcmMix(benchmark::State &state)
+{
+	std::array<T, N_SAMPLES> a, b;
+	FillSignal(a.data(), a.size(), shift);
+	FillSignal(b.data(), b.size(), shift);
+
+	PcmDither dither;
+
+	for (auto _ : state) {
+		bool success = pcm_mix(dither, a.data(), b.data(), sizeof(a),
+				       F, 0.5f);
+		benchmark::DoNotOptimize(success);
+	}
+
+	state.SetBytesProcessed(int64_t(state.iterations()) * sizeof(a));
+}
+
+BENCHMARK_TEMPLATE(BenchmarkPcmMix, SampleFormat::S16, int16_t);
+BENCHMARK_TEMPLATE(BenchmarkPcmMix, SampleFormat::S24_P32, int32_t, 8);
+BENCHMARK_TEMPLATE(BenchmarkPcmMix, SampleFormat::S32, int32_t);
+BENCHMARK_TEMPLATE(BenchmarkPcmMix, SampleFormat::FLOAT, float);
+
+template<SampleFormat IN, typename T, unsigned shift, SampleFormat OUT>
+static void
+BenchmarkPcmConvert(benchmark::State &state)
+{
+	std::array<T, N_SAMPLES> src;
+	FillSignal(src.data(), src.size(), shift);
+
+	const AudioFormat in_audio_format(44100, IN, 2);
+	const AudioFormat out_audio_format(44100, OUT, 2);
+
+	PcmConvert convert;
+	convert.Open(in_audio_format, out_audio_format);
+
+	for (auto _ : state) {
+		auto result = convert.Convert({src.data(), sizeof(src)});
+		benchmark::DoNotOptimize(result);
+	}
+
+	convert.Close();
+
+	state.SetBytesProcessed(int64_t(state.iterations()) * sizeof(src));
+}
+
+BENCHMARK_TEMPLATE(BenchmarkPcmConvert, SampleFormat::S16, int16_t, 0,
+		   SampleFormat::S24_P32);
+BENCHMARK_TEMPLATE(BenchmarkPcmConvert, SampleFormat::S16, int16_t, 0,
+		   SampleFormat::FLOAT);
+BENCHMARK_TEMPLATE(BenchmarkPcmConvert, SampleFormat::S24_P32, int32_t, 8,
+		   SampleFormat::S16);
+BENCHMARK_TEMPLATE(BenchmarkPcmConvert, SampleFormat::S32, int32_t, 0,
+		   SampleFormat::S16);
+BENCHMARK_TEMPLATE(BenchmarkPcmConvert, SampleFormat::FLOAT, float, 0,
+		   SampleFormat::S16);
+BENCHMARK_TEMPLATE(BenchmarkPcmConvert, SampleFormat::FLOAT, float, 0,
+		   SampleFormat::S32);
+
+BENCHMARK_MAIN();
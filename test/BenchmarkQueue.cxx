@@ -0,0 +1,120 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Benchmarks for the play queue: shuffling and moving ranges, the
+ * operations whose cost grows with the queue length.
+ */
+
+#include "queue/Queue.hxx"
+#include "song/DetachedSong.hxx"
+
+#include <benchmark/benchmark.h>
+
+Tag::Tag(const Tag &) noexcept {}
+void Tag::Clear() noexcept {}
+
+static void
+FillQueue(Queue &queue, unsigned n)
+{
+	for (unsigned i = 0; i < n; ++i)
+		queue.Append(DetachedSong("dummy.ogg"), 0);
+}
+
+static void
+BenchmarkQueueShuffleOrder(benchmark::State &state)
+{
+	const unsigned n = state.range(0);
+
+	Queue queue(n);
+	FillQueue(queue, n);
+	queue.random = true;
+
+	for (auto _ : state)
+		queue.ShuffleOrder();
+
+	state.SetItemsProcessed(int64_t(state.iterations()) * n);
+}
+
+BENCHMARK(BenchmarkQueueShuffleOrder)->Arg(1024)->Arg(16384);
+
+static void
+BenchmarkQueueMoveRange(benchmark::State &state)
+{
+	const unsigned n = state.range(0);
+	constexpr unsigned block = 64;
+
+	Queue queue(n);
+	FillQueue(queue, n);
+
+	for (auto _ : state) {
+		/* move a block from the front to the back and back
+		   again, so the queue looks the same before every
+		   iteration */
+		queue.MoveRange(0, block, n - block);
+		queue.MoveRange(n - block, n, 0);
+	}
+
+	state.SetItemsProcessed(int64_t(state.iterations()) * n);
+}
+
+BENCHMARK(BenchmarkQueueMoveRange)->Arg(1024)->Arg(16384);
+
+static void
+BenchmarkQueueSwapPositions(benchmark::State &state)
+{
+	const unsigned n = state.range(0);
+
+	Queue queue(n);
+	FillQueue(queue, n);
+
+	unsigned i = 0;
+	for (auto _ : state) {
+		queue.SwapPositions(i, n - 1 - i);
+		i = (i + 1) % (n / 2);
+	}
+
+	state.SetItemsProcessed(int64_t(state.iterations()));
+}
+
+BENCHMARK(BenchmarkQueueSwapPositions)->Arg(16384);
+
+static void
+BenchmarkQueueDeleteHead(benchmark::State &state)
+{
+	const unsigned n = state.range(0);
+
+	/* twice the capacity, so the gap buffer can absorb deleted
+	   slots without compacting on every append */
+	Queue queue(2 * n);
+	FillQueue(queue, n);
+
+	for (auto _ : state) {
+		/* the auto-DJ pattern: consume from the head,
+		   replenish at the tail */
+		queue.DeletePosition(0);
+		queue.Append(DetachedSong("dummy.ogg"), 0);
+	}
+
+	state.SetItemsProcessed(int64_t(state.iterations()));
+}
+
+BENCHMARK(BenchmarkQueueDeleteHead)->Arg(16384);
+
+BENCHMARK_MAIN();
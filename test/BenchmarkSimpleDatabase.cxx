@@ -0,0 +1,172 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Benchmarks for saving and loading the "simple" database plugin's
+ * file format on synthetic song trees, approximating startup and
+ * shutdown cost of large libraries.
+ */
+
+#include "db/plugins/simple/Directory.hxx"
+#include "db/plugins/simple/Song.hxx"
+#include "db/plugins/simple/DatabaseSave.hxx"
+#include "db/DatabaseLock.hxx"
+#include "song/DetachedSong.hxx"
+#include "tag/Builder.hxx"
+#include "tag/Tag.hxx"
+#include "fs/io/BufferedOutputStream.hxx"
+#include "fs/io/OutputStream.hxx"
+#include "fs/io/LineReader.hxx"
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+
+#include <stdio.h>
+
+/**
+ * An #OutputStream which appends to a std::string.
+ */
+class StringOutputStream final : public OutputStream {
+	std::string value;
+
+public:
+	const std::string &GetValue() const noexcept {
+		return value;
+	}
+
+	void Write(const void *data, size_t size) override {
+		value.append((const char *)data, size);
+	}
+};
+
+/**
+ * A #LineReader which reads from a copy of a std::string.
+ */
+class StringLineReader final : public LineReader {
+	std::string value;
+	size_t position = 0;
+
+public:
+	explicit StringLineReader(const std::string &_value)
+		:value(_value) {}
+
+	char *ReadLine() override {
+		if (position >= value.size())
+			return nullptr;
+
+		char *line = &value[position];
+		auto n = value.find('\n', position);
+		if (n == std::string::npos) {
+			position = value.size();
+			return line;
+		}
+
+		value[n] = 0;
+		position = n + 1;
+		return line;
+	}
+};
+
+static constexpr unsigned SONGS_PER_DIRECTORY = 100;
+
+/**
+ * Build a synthetic song tree with one layer of directories and
+ * #SONGS_PER_DIRECTORY songs each.
+ */
+static std::unique_ptr<Directory>
+MakeTree(unsigned n_songs)
+{
+	std::unique_ptr<Directory> root(Directory::NewRoot());
+
+	const ScopeDatabaseLock protect;
+
+	char buffer[64];
+	Directory *directory = nullptr;
+
+	for (unsigned i = 0; i < n_songs; ++i) {
+		if (i % SONGS_PER_DIRECTORY == 0) {
+			sprintf(buffer, "artist%u",
+				i / SONGS_PER_DIRECTORY);
+			directory = root->CreateChild(buffer);
+		}
+
+		TagBuilder tag;
+		sprintf(buffer, "Artist %u", i / SONGS_PER_DIRECTORY);
+		tag.AddItem(TAG_ARTIST, buffer);
+		sprintf(buffer, "Title %u", i);
+		tag.AddItem(TAG_TITLE, buffer);
+
+		sprintf(buffer, "track%u.ogg", i % SONGS_PER_DIRECTORY);
+		directory->AddSong(Song::NewFrom(DetachedSong(buffer,
+							      tag.Commit()),
+						 *directory));
+	}
+
+	return root;
+}
+
+static std::string
+SaveTree(const Directory &root)
+{
+	StringOutputStream sos;
+	BufferedOutputStream bos(sos);
+	db_save_internal(bos, root);
+	bos.Flush();
+	return sos.GetValue();
+}
+
+static void
+BenchmarkDatabaseSave(benchmark::State &state)
+{
+	const auto root = MakeTree(state.range(0));
+
+	for (auto _ : state) {
+		const auto value = SaveTree(*root);
+		benchmark::DoNotOptimize(value.size());
+	}
+
+	state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(BenchmarkDatabaseSave)
+	->Arg(10000)->Arg(100000)->Arg(1000000)
+	->Unit(benchmark::kMillisecond);
+
+static void
+BenchmarkDatabaseLoad(benchmark::State &state)
+{
+	const auto saved = SaveTree(*MakeTree(state.range(0)));
+
+	for (auto _ : state) {
+		StringLineReader reader(saved);
+		std::unique_ptr<Directory> root(Directory::NewRoot());
+		db_load_internal(reader, *root);
+		benchmark::DoNotOptimize(root);
+	}
+
+	state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(BenchmarkDatabaseLoad)
+	->Arg(10000)->Arg(100000)->Arg(1000000)
+	->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
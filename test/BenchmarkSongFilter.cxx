@@ -0,0 +1,99 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Measures SongFilter::Match() throughput, the cost of evaluating a
+ * filter expression against every song of a (synthetic) library.
+ */
+
+#include "song/Filter.hxx"
+#include "song/LightSong.hxx"
+#include "tag/Tag.hxx"
+#include "tag/Builder.hxx"
+#include "util/ConstBuffer.hxx"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+
+static constexpr unsigned N_SONGS = 1024;
+
+static Tag
+MakeTag(unsigned i)
+{
+	char buffer[32];
+	TagBuilder b;
+
+	sprintf(buffer, "Artist %u", i % 100);
+	b.AddItem(TAG_ARTIST, buffer);
+
+	sprintf(buffer, "Album %u", i % 300);
+	b.AddItem(TAG_ALBUM, buffer);
+
+	sprintf(buffer, "Title %u", i);
+	b.AddItem(TAG_TITLE, buffer);
+
+	return b.Commit();
+}
+
+static void
+BenchmarkSongFilterMatch(benchmark::State &state, const char *expression)
+{
+	SongFilter filter;
+	const char *argv[] = { expression };
+	filter.Parse(ConstBuffer<const char *>(argv, 1));
+	filter.Optimize();
+
+	std::vector<std::string> uris;
+	std::vector<Tag> tags;
+	uris.reserve(N_SONGS);
+	tags.reserve(N_SONGS);
+	for (unsigned i = 0; i < N_SONGS; ++i) {
+		uris.emplace_back("music/dir" + std::to_string(i % 32) +
+				  "/song" + std::to_string(i) + ".ogg");
+		tags.emplace_back(MakeTag(i));
+	}
+
+	uint64_t n_matches = 0;
+	for (auto _ : state) {
+		for (unsigned i = 0; i < N_SONGS; ++i) {
+			const LightSong song(uris[i].c_str(), tags[i]);
+			n_matches += filter.Match(song);
+		}
+	}
+
+	benchmark::DoNotOptimize(n_matches);
+	state.SetItemsProcessed(int64_t(state.iterations()) * N_SONGS);
+}
+
+BENCHMARK_CAPTURE(BenchmarkSongFilterMatch, tag_equals,
+		  "(artist == \"Artist 7\")");
+BENCHMARK_CAPTURE(BenchmarkSongFilterMatch, tag_contains,
+		  "(album contains \"99\")");
+BENCHMARK_CAPTURE(BenchmarkSongFilterMatch, any_contains,
+		  "(any contains \"42\")");
+BENCHMARK_CAPTURE(BenchmarkSongFilterMatch, and_expression,
+		  "((artist == \"Artist 7\") AND (album contains \"1\"))");
+BENCHMARK_CAPTURE(BenchmarkSongFilterMatch, base_uri,
+		  "(base \"music/dir7\")");
+
+BENCHMARK_MAIN();
@@ -0,0 +1,321 @@
+/*
+ * Copyright 2003-2018 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * A load generator for the MPD protocol: opens many concurrent
+ * connections to a running server, replays a weighted command mix on
+ * each of them and reports latency percentiles and throughput.  It is
+ * meant to be pointed at a development server to catch client-path
+ * performance regressions; see run_protocol_load_500.sh for the
+ * standard scenario.
+ */
+
+#include "ShutdownHandler.hxx"
+#include "event/Loop.hxx"
+#include "event/BufferedSocket.hxx"
+#include "event/TimerEvent.hxx"
+#include "net/Resolver.hxx"
+#include "net/AddressInfo.hxx"
+#include "net/UniqueSocketDescriptor.hxx"
+#include "util/Compiler.h"
+#include "util/PrintException.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct MixEntry {
+	/** the name used in the mix specification */
+	const char *name;
+
+	/**
+	 * The protocol data sent for one request; may contain
+	 * several newline-separated commands (e.g. "idle" followed
+	 * by "noidle" to exercise subscription churn).
+	 */
+	const char *request;
+
+	/** relative weight; 0 = disabled */
+	unsigned weight;
+
+	/** number of completed requests */
+	uint64_t count = 0;
+};
+
+static MixEntry mix_table[] = {
+	{ "status", "status\n", 60 },
+	{ "currentsong", "currentsong\n", 0 },
+	{ "playlistinfo", "playlistinfo\n", 20 },
+	{ "search", "search any \"a\"\n", 5 },
+	{ "idle", "idle\nnoidle\n", 15 },
+};
+
+struct LoadStats {
+	/** latency of each completed request in microseconds */
+	std::vector<uint32_t> latencies;
+
+	uint64_t n_completed = 0, n_errors = 0;
+};
+
+class LoadClient final : BufferedSocket {
+	LoadStats &stats;
+
+	std::mt19937 rng;
+	std::discrete_distribution<unsigned> choose;
+
+	/**
+	 * The mix entry of the request in flight, or nullptr while
+	 * waiting for the server greeting.
+	 */
+	MixEntry *pending = nullptr;
+
+	std::chrono::steady_clock::time_point start;
+
+public:
+	LoadClient(EventLoop &_loop, UniqueSocketDescriptor _fd,
+		   LoadStats &_stats, unsigned seed,
+		   const std::vector<double> &weights) noexcept
+		:BufferedSocket(_fd.Release(), _loop),
+		 stats(_stats), rng(seed),
+		 choose(weights.begin(), weights.end()) {}
+
+	~LoadClient() noexcept {
+		if (IsDefined())
+			Close();
+	}
+
+private:
+	void SendNext() noexcept;
+
+	/* virtual methods from class BufferedSocket */
+	InputResult OnSocketInput(void *data, size_t length) noexcept override;
+	void OnSocketError(std::exception_ptr ep) noexcept override;
+	void OnSocketClosed() noexcept override;
+};
+
+void
+LoadClient::SendNext() noexcept
+{
+	pending = &mix_table[choose(rng)];
+	start = std::chrono::steady_clock::now();
+
+	const size_t length = strlen(pending->request);
+	if (GetSocket().Write(pending->request, length) != (ssize_t)length) {
+		/* short writes cannot happen with these tiny
+		   requests unless the connection is dead */
+		++stats.n_errors;
+		Close();
+	}
+}
+
+BufferedSocket::InputResult
+LoadClient::OnSocketInput(void *data, size_t length) noexcept
+{
+	char *p = (char *)data;
+
+	while (true) {
+		char *newline = (char *)memchr(p, '\n', length);
+		if (newline == nullptr)
+			return InputResult::MORE;
+
+		*newline = 0;
+
+		if (pending == nullptr) {
+			/* the greeting ("OK MPD ...") has arrived;
+			   start the request loop */
+			SendNext();
+			if (!IsDefined())
+				return InputResult::CLOSED;
+		} else if (strcmp(p, "OK") == 0 ||
+			   memcmp(p, "ACK ", 4) == 0) {
+			const auto latency = std::chrono::steady_clock::now() - start;
+			stats.latencies.push_back(std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+			++stats.n_completed;
+			++pending->count;
+
+			if (*p != 'O')
+				++stats.n_errors;
+
+			SendNext();
+			if (!IsDefined())
+				return InputResult::CLOSED;
+		}
+
+		/* all other lines are response payload and are not
+		   interesting here */
+
+		length -= newline + 1 - p;
+		ConsumeInput(newline + 1 - p);
+		p = newline + 1;
+	}
+}
+
+void
+LoadClient::OnSocketError(std::exception_ptr ep) noexcept
+{
+	PrintException(ep);
+	++stats.n_errors;
+	Close();
+}
+
+void
+LoadClient::OnSocketClosed() noexcept
+{
+	++stats.n_errors;
+	Close();
+}
+
+/**
+ * Parse a mix specification such as "status=60,playlistinfo=20" and
+ * apply the weights to #mix_table.
+ */
+static bool
+ParseMix(char *s)
+{
+	for (auto &i : mix_table)
+		i.weight = 0;
+
+	for (char *name = strtok(s, ","); name != nullptr;
+	     name = strtok(nullptr, ",")) {
+		char *eq = strchr(name, '=');
+		if (eq == nullptr)
+			return false;
+
+		*eq = 0;
+
+		MixEntry *entry = nullptr;
+		for (auto &i : mix_table)
+			if (strcmp(i.name, name) == 0)
+				entry = &i;
+
+		if (entry == nullptr) {
+			fprintf(stderr, "Unknown command '%s'\n", name);
+			return false;
+		}
+
+		entry->weight = strtoul(eq + 1, nullptr, 10);
+	}
+
+	return true;
+}
+
+gcc_pure
+static uint32_t
+Percentile(const std::vector<uint32_t> &sorted, unsigned p) noexcept
+{
+	return sorted[(sorted.size() - 1) * p / 100];
+}
+
+static UniqueSocketDescriptor
+ConnectTo(const AddressInfoList &ail)
+{
+	std::exception_ptr error;
+
+	for (const auto &i : ail) {
+		UniqueSocketDescriptor fd;
+		if (!fd.Create(i.GetFamily(), i.GetType(), i.GetProtocol()))
+			continue;
+
+		if (fd.Connect(i))
+			return fd;
+	}
+
+	throw std::runtime_error("Failed to connect");
+}
+
+int main(int argc, char **argv)
+try {
+	if (argc < 3 || argc > 6) {
+		fprintf(stderr, "Usage: run_protocol_load HOST PORT"
+			" [CLIENTS] [SECONDS] [MIX]\n"
+			"  MIX is e.g. 'status=60,playlistinfo=20,search=5,idle=15'\n");
+		return EXIT_FAILURE;
+	}
+
+	const char *host = argv[1];
+	const unsigned port = strtoul(argv[2], nullptr, 10);
+	const unsigned n_clients = argc > 3 ? strtoul(argv[3], nullptr, 10) : 50;
+	const unsigned seconds = argc > 4 ? strtoul(argv[4], nullptr, 10) : 10;
+
+	if (argc > 5 && !ParseMix(argv[5]))
+		return EXIT_FAILURE;
+
+	std::vector<double> weights;
+	for (const auto &i : mix_table)
+		weights.push_back(i.weight);
+
+	const auto ail = Resolve(host, port, 0, SOCK_STREAM);
+
+	EventLoop event_loop;
+	const ShutdownHandler shutdown_handler(event_loop);
+
+	LoadStats stats;
+
+	std::vector<std::unique_ptr<LoadClient>> clients;
+	clients.reserve(n_clients);
+	for (unsigned i = 0; i < n_clients; ++i)
+		clients.emplace_back(new LoadClient(event_loop, ConnectTo(ail),
+						    stats, i, weights));
+
+	TimerEvent stop_timer(event_loop,
+			      BIND_METHOD(event_loop, &EventLoop::Break));
+	stop_timer.Schedule(std::chrono::seconds(seconds));
+
+	const auto t0 = std::chrono::steady_clock::now();
+	event_loop.Run();
+	const auto elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(std::chrono::steady_clock::now() - t0).count();
+
+	clients.clear();
+
+	if (stats.latencies.empty()) {
+		fprintf(stderr, "No requests completed\n");
+		return EXIT_FAILURE;
+	}
+
+	std::sort(stats.latencies.begin(), stats.latencies.end());
+
+	printf("clients: %u\n", n_clients);
+	printf("commands: %llu (%.0f/s), errors: %llu\n",
+	       (unsigned long long)stats.n_completed,
+	       stats.n_completed / elapsed,
+	       (unsigned long long)stats.n_errors);
+	printf("latency: p50=%uus p90=%uus p99=%uus max=%uus\n",
+	       Percentile(stats.latencies, 50),
+	       Percentile(stats.latencies, 90),
+	       Percentile(stats.latencies, 99),
+	       stats.latencies.back());
+
+	for (const auto &i : mix_table)
+		if (i.count > 0)
+			printf("  %s: %llu\n",
+			       i.name, (unsigned long long)i.count);
+
+	return EXIT_SUCCESS;
+} catch (...) {
+	PrintException(std::current_exception());
+	return EXIT_FAILURE;
+}
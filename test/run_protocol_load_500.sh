@@ -0,0 +1,13 @@
+#!/bin/sh -e
+
+# Replays the standard 500-client profile against a development
+# server: mostly status polling, with playlist dumps, searches and
+# idle subscription churn mixed in.
+#
+# Usage: run_protocol_load_500.sh [HOST [PORT]]
+
+HOST="${1:-localhost}"
+PORT="${2:-6600}"
+
+./test/run_protocol_load "$HOST" "$PORT" 500 60 \
+	'status=70,playlistinfo=10,search=5,idle=15'
@@ -64,6 +64,30 @@ TEST(PcmTest, Channels16)
 		EXPECT_EQ(silence, dest[i * 6 + 4]);
 		EXPECT_EQ(silence, dest[i * 6 + 5]);
 	}
+
+	/* 5.1 to stereo */
+
+	const auto src6 = TestDataBuffer<int16_t, N * 6>();
+	dest = pcm_convert_channels_16(buffer, 2, 6, { src6, N * 6 });
+	EXPECT_FALSE(dest.IsNull());
+	EXPECT_EQ(N * 2, dest.size);
+	for (unsigned i = 0; i < N; ++i) {
+		/* center and surround scaled by the Q8 -3dB
+		   coefficient, LFE dropped */
+		const int center = (src6[i * 6 + 2] * 181) >> 8;
+		int left = src6[i * 6] + center +
+			((src6[i * 6 + 4] * 181) >> 8);
+		int right = src6[i * 6 + 1] + center +
+			((src6[i * 6 + 5] * 181) >> 8);
+
+		if (left < -32768) left = -32768;
+		else if (left > 32767) left = 32767;
+		if (right < -32768) right = -32768;
+		else if (right > 32767) right = 32767;
+
+		EXPECT_EQ(int16_t(left), dest[i * 2]);
+		EXPECT_EQ(int16_t(right), dest[i * 2 + 1]);
+	}
 }
 
 TEST(PcmTest, Channels32)
@@ -46,6 +46,29 @@ TEST(PcmTest, Pack24)
 	}
 }
 
+TEST(PcmTest, Pack24Reverse)
+{
+	constexpr unsigned N = 509;
+	const auto src = TestDataBuffer<int32_t, N>(RandomInt24());
+
+	uint8_t dest[N * 3];
+	pcm_pack_24_reverse(dest, src.begin(), src.end());
+
+	for (unsigned i = 0; i < N; ++i) {
+		int32_t d;
+		if (IsBigEndian())
+			d = (dest[i * 3 + 2] << 16) | (dest[i * 3 + 1] << 8)
+				| dest[i * 3];
+		else
+			d = (dest[i * 3] << 16) | (dest[i * 3 + 1] << 8)
+				| dest[i * 3 + 2];
+		if (d & 0x800000)
+			d |= 0xff000000;
+
+		EXPECT_EQ(d, src[i]);
+	}
+}
+
 TEST(PcmTest, Unpack24)
 {
 	constexpr unsigned N = 509;
@@ -0,0 +1,92 @@
+/*
+ * Unit tests for the gap buffer inside struct Queue: deleting and
+ * moving items must keep positions, ids and the order array
+ * consistent even while the items array contains a gap.
+ */
+
+#include "queue/Queue.hxx"
+#include "song/DetachedSong.hxx"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+Tag::Tag(const Tag &) noexcept {}
+void Tag::Clear() noexcept {}
+
+static void
+CheckConsistent(const Queue &queue)
+{
+	for (unsigned i = 0; i < queue.GetLength(); ++i) {
+		const int id = queue.PositionToId(i);
+		ASSERT_GE(id, 0);
+		ASSERT_EQ(queue.IdToPosition(id), int(i));
+		ASSERT_EQ(queue.OrderToPosition(queue.PositionToOrder(i)),
+			  i);
+	}
+}
+
+TEST(QueueGap, DeleteHead)
+{
+	Queue queue(32);
+
+	for (unsigned i = 0; i < 16; ++i)
+		queue.Append(DetachedSong(std::to_string(i).c_str()), 0);
+
+	/* repeatedly delete the first song; the remaining songs must
+	   shift down by one each time */
+
+	for (unsigned i = 0; i < 8; ++i) {
+		queue.DeletePosition(0);
+		ASSERT_EQ(queue.GetLength(), 15u - i);
+		ASSERT_STREQ(queue.Get(0).GetURI(),
+			     std::to_string(i + 1).c_str());
+		CheckConsistent(queue);
+	}
+}
+
+TEST(QueueGap, DeleteMiddleAndAppend)
+{
+	Queue queue(8);
+
+	for (unsigned i = 0; i < 8; ++i)
+		queue.Append(DetachedSong(std::to_string(i).c_str()), 0);
+
+	queue.DeletePosition(3);
+	queue.DeletePosition(5);
+	CheckConsistent(queue);
+
+	ASSERT_STREQ(queue.Get(3).GetURI(), "4");
+	ASSERT_STREQ(queue.Get(5).GetURI(), "7");
+
+	/* appending into a full physical array must reuse the gap */
+
+	queue.Append(DetachedSong("x"), 0);
+	queue.Append(DetachedSong("y"), 0);
+	ASSERT_EQ(queue.GetLength(), 8u);
+	ASSERT_STREQ(queue.Get(6).GetURI(), "x");
+	ASSERT_STREQ(queue.Get(7).GetURI(), "y");
+	CheckConsistent(queue);
+}
+
+TEST(QueueGap, MoveAcrossGap)
+{
+	Queue queue(16);
+
+	for (unsigned i = 0; i < 12; ++i)
+		queue.Append(DetachedSong(std::to_string(i).c_str()), 0);
+
+	queue.DeletePosition(5);
+	const int id = queue.PositionToId(2);
+
+	queue.MovePostion(2, 9);
+	ASSERT_EQ(queue.IdToPosition(id), 9);
+	ASSERT_STREQ(queue.Get(9).GetURI(), "2");
+	CheckConsistent(queue);
+
+	queue.MoveRange(7, 10, 1);
+	CheckConsistent(queue);
+
+	queue.Clear();
+	ASSERT_EQ(queue.GetLength(), 0u);
+}